@@ -0,0 +1,63 @@
+#include <memory>
+#include <string>
+
+#include <benchmark/benchmark.h>
+
+#include "LayerStack.hpp"
+
+namespace {
+  class NullLayer final : public kst::app::Layer {
+  public:
+    explicit NullLayer(int index) : Layer("NullLayer " + std::to_string(index)) {}
+
+    void onAttach() override {}
+    void onDetach() override {}
+    void onUpdate(float deltaTime) override { m_accumulated += deltaTime; }
+    void onRender(uint32_t currentFrame) override { m_frames += currentFrame; }
+    void onResize(uint32_t width, uint32_t height) override { m_frames += width + height; }
+    void onEvent(void* event) override { benchmark::DoNotOptimize(event); }
+
+  private:
+    float m_accumulated = 0.0f;
+    uint32_t m_frames   = 0;
+  };
+
+  // Half regular layers, half overlays, matching how the application pushes them
+  void fillStack(kst::app::LayerStack& stack, int64_t count) {
+    for (int64_t i = 0; i < count; ++i) {
+      auto layer = std::make_shared<NullLayer>(static_cast<int>(i));
+      if (i % 2 == 0) {
+        stack.pushLayer(layer);
+      } else {
+        stack.pushOverlay(layer);
+      }
+    }
+  }
+
+  void BM_LayerStackUpdate(benchmark::State& state) {
+    kst::app::LayerStack stack;
+    fillStack(stack, state.range(0));
+    for (auto _ : state) {
+      for (auto& layer : stack) {
+        layer->onUpdate(0.016f);
+      }
+      benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * state.range(0));
+  }
+  BENCHMARK(BM_LayerStackUpdate)->RangeMultiplier(4)->Range(1, 256);
+
+  // Events travel top to bottom
+  void BM_LayerStackEventPropagation(benchmark::State& state) {
+    kst::app::LayerStack stack;
+    fillStack(stack, state.range(0));
+    int event = 0;
+    for (auto _ : state) {
+      for (auto it = stack.rbegin(); it != stack.rend(); ++it) {
+        (*it)->onEvent(&event);
+      }
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * state.range(0));
+  }
+  BENCHMARK(BM_LayerStackEventPropagation)->RangeMultiplier(4)->Range(1, 256);
+} // namespace
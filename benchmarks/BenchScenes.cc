@@ -0,0 +1,935 @@
+#include "BenchScenes.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <span>
+#include <string>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "Foliage/FoliageScatter.hpp"
+#include "Terrain/HeightfieldSource.hpp"
+#include "Terrain/TerrainClipmap.hpp"
+#include "VulkanBackend/VulkanCore/Buffer.hpp"
+#include "VulkanBackend/VulkanCore/CachedCommands.hpp"
+#include "VulkanBackend/VulkanCore/DeviceGeneratedCommands.hpp"
+#include "VulkanBackend/VulkanCore/DynamicRendering.hpp"
+#include "VulkanBackend/VulkanCore/Pipeline.hpp"
+#include "VulkanBackend/VulkanCore/Sampler.hpp"
+#include "VulkanBackend/VulkanCore/ShaderModule.hpp"
+#include "VulkanBackend/VulkanCore/Texture.hpp"
+
+namespace kst::bench {
+  namespace {
+    // Fixed seed: every run, machine and driver draws the same scene
+    constexpr uint32_t kSceneSeed = 0x6b737421;
+
+    struct SceneParams {
+      glm::mat4 viewProjection;
+      glm::vec4 cameraPosition;
+      glm::uvec4 counts;
+    };
+    static_assert(sizeof(SceneParams) == 96, "SceneParams must match std140 layout");
+
+    struct SceneObject {
+      glm::vec4 positionScale;
+      glm::vec4 color;
+    };
+
+    struct SceneLight {
+      glm::vec4 positionRadius;
+      glm::vec4 color;
+    };
+
+    struct DrawParams {
+      uint32_t objectIndex;
+      uint32_t textureIndex;
+    };
+
+    struct HeavyComputeParams {
+      uint32_t count;
+      uint32_t iterations;
+      float time;
+    };
+
+    enum SceneBinding : uint32_t {
+      Params   = 0,
+      Objects  = 1,
+      Lights   = 2,
+      Textures = 3,
+    };
+
+    auto layoutBinding(
+        uint32_t index,
+        VkDescriptorType type,
+        VkShaderStageFlags stages,
+        uint32_t count = 1
+    ) -> VkDescriptorSetLayoutBinding {
+      return {
+          .binding         = index,
+          .descriptorType  = type,
+          .descriptorCount = count,
+          .stageFlags      = stages,
+      };
+    }
+
+    auto uploadStorageBuffer(
+        HeadlessContext& bench,
+        const void* data,
+        size_t size,
+        const std::string& name
+    ) -> std::shared_ptr<VulkanCore::Buffer> {
+      auto buffer = bench.context().createBuffer(
+          size,
+          VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+          VMA_MEMORY_USAGE_GPU_ONLY,
+          name
+      );
+      auto commandBuffer = bench.queue().getCmdBufferToBegin();
+      bench.context().uploadToGPUBuffer(
+          bench.queue(), commandBuffer, buffer.get(), data, static_cast<long>(size)
+      );
+      bench.submitAndWait(commandBuffer);
+      return buffer;
+    }
+
+    struct ForwardSceneDesc {
+      uint32_t objectCount  = 1;
+      float objectScale     = 1.0f;
+      uint32_t lightCount   = 1;
+      float lightRadius     = 10.0f;
+      uint32_t textureCount = 1;
+      uint32_t textureSize  = 256;
+      // Pipelines differing in raster and depth state, assigned round-robin
+      uint32_t materialCount = 1;
+      // Record the draws once per frame in flight and replay them
+      bool cachedRecording = false;
+    };
+
+    /**
+     * @brief Cubes scattered over a fixed volume, forward-lit by every light
+     *
+     * One vkCmdDraw per object with the object and texture index as push
+     * constants, so the draw count drives CPU recording cost and the light
+     * count and texture size drive GPU cost. With several materials the
+     * objects interleave pipelines and go through DeviceGeneratedDraws. The
+     * draws never change (the camera lives in the params buffer), so they can
+     * also be replayed from cached secondaries.
+     */
+    class ForwardScene final : public BenchScene {
+    public:
+      explicit ForwardScene(const ForwardSceneDesc& desc) : m_desc(desc) {}
+
+      void setup(HeadlessContext& bench, const SceneTargets& targets, uint32_t framesInFlight)
+          override {
+        m_targets = targets;
+        auto& context = bench.context();
+
+        constexpr float kHalfExtent = 50.0f;
+        std::mt19937 rng(kSceneSeed);
+        std::uniform_real_distribution<float> position(-kHalfExtent, kHalfExtent);
+        std::uniform_real_distribution<float> unit(0.2f, 1.0f);
+
+        std::vector<SceneObject> objects(m_desc.objectCount);
+        for (auto& object : objects) {
+          object.positionScale = {
+              position(rng), position(rng) * 0.1f, position(rng), m_desc.objectScale * unit(rng)
+          };
+          object.color = {unit(rng), unit(rng), unit(rng), 1.0f};
+        }
+        m_objectBuffer = uploadStorageBuffer(
+            bench, objects.data(), objects.size() * sizeof(SceneObject), "Scene objects"
+        );
+
+        std::vector<SceneLight> lights(std::max(m_desc.lightCount, 1u));
+        for (auto& light : lights) {
+          light.positionRadius = {position(rng), 2.0f, position(rng), m_desc.lightRadius};
+          light.color          = {unit(rng), unit(rng), unit(rng), 1.0f};
+        }
+        m_lightBuffer = uploadStorageBuffer(
+            bench, lights.data(), lights.size() * sizeof(SceneLight), "Scene lights"
+        );
+
+        createTextures(bench);
+
+        m_vertexShader = context.createShaderModule(
+            HeadlessContext::shaderPath("bench/scene.vert"),
+            VK_SHADER_STAGE_VERTEX_BIT,
+            "Scene vertex"
+        );
+        m_fragmentShader = context.createShaderModule(
+            HeadlessContext::shaderPath("bench/scene.frag"),
+            VK_SHADER_STAGE_FRAGMENT_BIT,
+            "Scene fragment"
+        );
+
+        constexpr VkShaderStageFlags vertex   = VK_SHADER_STAGE_VERTEX_BIT;
+        constexpr VkShaderStageFlags fragment = VK_SHADER_STAGE_FRAGMENT_BIT;
+        const VulkanCore::Pipeline::GraphicsPipelineDescriptor desc = {
+            .sets_ =
+                {
+                    {
+                        .set_ = 0,
+                        .bindings_ =
+                            {
+                                layoutBinding(
+                                    Params, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, vertex | fragment
+                                ),
+                                layoutBinding(Objects, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, vertex),
+                                layoutBinding(Lights, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, fragment),
+                                layoutBinding(
+                                    Textures,
+                                    VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+                                    fragment,
+                                    kMaxSceneTextures
+                                ),
+                            },
+                    },
+                },
+            .vertexShader_   = m_vertexShader,
+            .fragmentShader_ = m_fragmentShader,
+            .pushConstants_ =
+                {
+                    {.stageFlags = vertex | fragment, .offset = 0, .size = sizeof(DrawParams)},
+                },
+            .dynamicStates_       = {VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR},
+            .useDynamicRendering_ = true,
+            .colorTextureFormats  = {targets.color->vkFormat()},
+            .depthTextureFormat   = targets.depth->vkFormat(),
+            .viewport             = targets.extent,
+        };
+        if (m_desc.materialCount > 1) {
+          createMaterials(context, desc, framesInFlight);
+        } else {
+          m_pipeline = context.createGraphicsPipeline(desc, VK_NULL_HANDLE, "Scene forward");
+        }
+        m_pipeline->allocateDescriptors({{.set_ = 0, .count_ = framesInFlight, .name_ = "Scene"}});
+
+        // Scenes with fewer textures repeat them so every array element is valid
+        std::vector<std::shared_ptr<VulkanCore::Texture>> bound(kMaxSceneTextures);
+        for (uint32_t i = 0; i < kMaxSceneTextures; ++i) {
+          bound[i] = m_textures[i % m_textures.size()];
+        }
+
+        for (uint32_t slot = 0; slot < framesInFlight; ++slot) {
+          m_params.push_back(context.createPersistentBuffer(
+              sizeof(SceneParams),
+              VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
+              "Scene params " + std::to_string(slot)
+          ));
+          m_pipeline->bindResource(
+              0,
+              Params,
+              slot,
+              m_params[slot],
+              0,
+              sizeof(SceneParams),
+              VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER
+          );
+          m_pipeline->bindResource(
+              0,
+              Objects,
+              slot,
+              m_objectBuffer,
+              0,
+              static_cast<uint32_t>(m_objectBuffer->size()),
+              VK_DESCRIPTOR_TYPE_STORAGE_BUFFER
+          );
+          m_pipeline->bindResource(
+              0,
+              Lights,
+              slot,
+              m_lightBuffer,
+              0,
+              static_cast<uint32_t>(m_lightBuffer->size()),
+              VK_DESCRIPTOR_TYPE_STORAGE_BUFFER
+          );
+          m_pipeline->bindResource(0, Textures, slot, std::span(bound), m_sampler);
+        }
+        m_pipeline->updateDescriptorSets();
+
+        if (m_desc.cachedRecording) {
+          for (uint32_t slot = 0; slot < framesInFlight; ++slot) {
+            m_cached.push_back(std::make_unique<VulkanCore::CachedCommandBuffer>(
+                context,
+                bench.queue(),
+                VulkanCore::CachedPassDescriptor{
+                    .colorFormats = {targets.color->vkFormat()},
+                    .depthFormat  = targets.depth->vkFormat(),
+                    .record =
+                        [this, slot](
+                            VkCommandBuffer commandBuffer,
+                            VulkanCore::CachedPassDependencies& dependencies
+                        ) {
+                          dependencies.use(m_pipeline);
+                          dependencies.use(m_objectBuffer);
+                          dependencies.use(m_lightBuffer);
+                          dependencies.use(m_params[slot]);
+                          recordDraws(commandBuffer, slot);
+                        },
+                },
+                "Scene draws " + std::to_string(slot)
+            ));
+          }
+        }
+      }
+
+      void record(VkCommandBuffer commandBuffer, uint32_t slot, uint32_t frame) override {
+        // The camera orbits the volume so no frame is a repeat of the last one
+        const float angle   = static_cast<float>(frame) * 0.01f;
+        const glm::vec3 eye = {std::cos(angle) * 80.0f, 35.0f, std::sin(angle) * 80.0f};
+        const auto width     = static_cast<float>(m_targets.extent.width);
+        const auto height    = static_cast<float>(m_targets.extent.height);
+        glm::mat4 projection = glm::perspective(glm::radians(60.0f), width / height, 0.1f, 500.0f);
+        projection[1][1] *= -1.0f;
+
+        const SceneParams params = {
+            .viewProjection = projection * glm::lookAt(eye, glm::vec3(0.0f), glm::vec3(0, 1, 0)),
+            .cameraPosition = glm::vec4(eye, 1.0f),
+            .counts         = {m_desc.lightCount, 0, 0, 0},
+        };
+        m_params[slot]->copyDataToBuffer(&params, sizeof(params));
+
+        // Targets stay in attachment layouts; the runner's frame barrier orders
+        // this frame's clears after the previous frame's writes
+        const VulkanCore::DynamicRendering::AttachmentDescription color = {
+            .imageView         = m_targets.color->vkImageView(),
+            .imageLayout       = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+            .attachmentLoadOp  = VK_ATTACHMENT_LOAD_OP_CLEAR,
+            .attachmentStoreOp = VK_ATTACHMENT_STORE_OP_STORE,
+            .clearValue        = {.color = {.float32 = {0.0f, 0.0f, 0.0f, 1.0f}}},
+        };
+        const VulkanCore::DynamicRendering::AttachmentDescription depth = {
+            .imageView         = m_targets.depth->vkImageView(),
+            .imageLayout       = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL,
+            .attachmentLoadOp  = VK_ATTACHMENT_LOAD_OP_CLEAR,
+            .attachmentStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE,
+            .clearValue        = {.depthStencil = {.depth = 1.0f}},
+        };
+        const VkRect2D area = {.extent = m_targets.extent};
+        VulkanCore::DynamicRendering::beginRenderingCmd(
+            commandBuffer,
+            m_targets.color->vkImage(),
+            m_cached.empty() ? 0 : VK_RENDERING_CONTENTS_SECONDARY_COMMAND_BUFFERS_BIT,
+            area,
+            1,
+            0,
+            {color},
+            &depth,
+            nullptr,
+            VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+            VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL
+        );
+
+        if (m_cached.empty()) {
+          recordDraws(commandBuffer, slot);
+        } else {
+          m_cached[slot]->execute(commandBuffer);
+        }
+
+        VulkanCore::DynamicRendering::endRenderingCmd(
+            commandBuffer,
+            m_targets.color->vkImage(),
+            VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+            VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL
+        );
+      }
+
+    private:
+      // Everything inside the render pass; viewport and scissor included, as
+      // cached secondaries inherit no dynamic state
+      void recordDraws(VkCommandBuffer commandBuffer, uint32_t slot) {
+        const VkRect2D area       = {.extent = m_targets.extent};
+        const VkViewport viewport = {
+            .width    = static_cast<float>(area.extent.width),
+            .height   = static_cast<float>(area.extent.height),
+            .maxDepth = 1.0f,
+        };
+        vkCmdSetViewport(commandBuffer, 0, 1, &viewport);
+        vkCmdSetScissor(commandBuffer, 0, 1, &area);
+
+        m_pipeline->bind(commandBuffer);
+        m_pipeline->bindDescriptorSets(commandBuffer, {{.set = 0, .bindIdx = slot}});
+        if (m_draws) {
+          // The materials' layouts match, so the sets bound above stay valid
+          for (uint32_t object = 0; object < m_desc.objectCount; ++object) {
+            const DrawParams params = {
+                .objectIndex  = object,
+                .textureIndex = object % m_desc.textureCount,
+            };
+            const VulkanCore::GeneratedDraw draw = {
+                .pipeline = object % m_desc.materialCount,
+                .draw     = {.indexCount = 36, .instanceCount = 1},
+            };
+            m_draws->addDraw(draw, &params);
+          }
+          m_draws->record(commandBuffer, slot);
+        } else {
+          for (uint32_t object = 0; object < m_desc.objectCount; ++object) {
+            const DrawParams draw = {
+                .objectIndex  = object,
+                .textureIndex = object % m_desc.textureCount,
+            };
+            m_pipeline->updatePushConstant(
+                commandBuffer,
+                VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT,
+                sizeof(draw),
+                &draw
+            );
+            vkCmdDraw(commandBuffer, 36, 1, 0, 0);
+          }
+        }
+      }
+
+      // Every combination of cull mode, depth compare and depth writes gives a
+      // distinct pipeline; material 0 matches the single-material pipeline
+      void createMaterials(
+          VulkanCore::Context& context,
+          VulkanCore::Pipeline::GraphicsPipelineDescriptor desc,
+          uint32_t framesInFlight
+      ) {
+        desc.indirectBindable = true;
+        std::vector<std::shared_ptr<VulkanCore::Pipeline>> pipelines;
+        for (uint32_t material = 0; material < m_desc.materialCount; ++material) {
+          desc.cullMode              = (material & 1) ? VK_CULL_MODE_NONE : VK_CULL_MODE_BACK_BIT;
+          desc.depthCompareOperation = (material & 2) ? VK_COMPARE_OP_LESS_OR_EQUAL
+                                                      : VK_COMPARE_OP_LESS;
+          desc.depthWriteEnable      = (material & 4) == 0;
+          pipelines.push_back(context.createGraphicsPipeline(
+              desc, VK_NULL_HANDLE, "Scene material " + std::to_string(material)
+          ));
+        }
+        m_pipeline = pipelines.front();
+
+        m_draws = std::make_unique<VulkanCore::DeviceGeneratedDraws>(
+            context,
+            VulkanCore::GeneratedDrawsDescriptor{
+                .pipelines = std::move(pipelines),
+                .pushConstants =
+                    {
+                        .stageFlags = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT,
+                        .offset     = 0,
+                        .size       = sizeof(DrawParams),
+                    },
+                .maxSequences   = m_desc.objectCount,
+                .framesInFlight = framesInFlight,
+            },
+            "Scene materials"
+        );
+      }
+
+      // Full mip chains of a per-texture checker pattern, uploaded one at a
+      // time so the staging memory never holds more than a single texture
+      void createTextures(HeadlessContext& bench) {
+        auto& context     = bench.context();
+        const auto size   = m_desc.textureSize;
+        const auto texels = static_cast<size_t>(size) * size;
+        std::vector<uint32_t> pixels(texels);
+
+        for (uint32_t index = 0; index < m_desc.textureCount; ++index) {
+          auto texture = context.createTexture(
+              VK_IMAGE_TYPE_2D,
+              VK_FORMAT_R8G8B8A8_UNORM,
+              0,
+              VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT |
+                  VK_IMAGE_USAGE_TRANSFER_SRC_BIT,
+              {size, size, 1},
+              1,
+              1,
+              VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+              true,
+              VK_SAMPLE_COUNT_1_BIT,
+              "Scene texture " + std::to_string(index)
+          );
+
+          const uint32_t tint = 0xff000000u | (0x3f << (8 * (index % 3)));
+          for (uint32_t y = 0; y < size; ++y) {
+            for (uint32_t x = 0; x < size; ++x) {
+              const bool odd = ((x >> 5) ^ (y >> 5) ^ index) & 1;
+              pixels[size_t(y) * size + x] = odd ? 0xffffffffu : tint | ((x ^ y) & 0xff);
+            }
+          }
+
+          auto staging = context.createStagingBuffer(
+              texture->vkDeviceSize(), VK_BUFFER_USAGE_TRANSFER_SRC_BIT, "Scene texture staging"
+          );
+          auto commandBuffer = bench.queue().getCmdBufferToBegin();
+          texture->uploadAndGenMips(commandBuffer, staging.get(), pixels.data());
+          bench.submitAndWait(commandBuffer);
+          m_textures.push_back(std::move(texture));
+        }
+
+        m_sampler = context.createSampler(
+            VK_FILTER_LINEAR,
+            VK_FILTER_LINEAR,
+            VK_SAMPLER_ADDRESS_MODE_REPEAT,
+            VK_SAMPLER_ADDRESS_MODE_REPEAT,
+            VK_SAMPLER_ADDRESS_MODE_REPEAT,
+            static_cast<float>(m_textures.front()->numMipLevels()),
+            "Scene sampler"
+        );
+      }
+
+      ForwardSceneDesc m_desc;
+      SceneTargets m_targets;
+      std::shared_ptr<VulkanCore::ShaderModule> m_vertexShader;
+      std::shared_ptr<VulkanCore::ShaderModule> m_fragmentShader;
+      std::shared_ptr<VulkanCore::Pipeline> m_pipeline;
+      std::unique_ptr<VulkanCore::DeviceGeneratedDraws> m_draws;
+      std::vector<std::unique_ptr<VulkanCore::CachedCommandBuffer>> m_cached;
+      std::shared_ptr<VulkanCore::Buffer> m_objectBuffer;
+      std::shared_ptr<VulkanCore::Buffer> m_lightBuffer;
+      std::vector<std::shared_ptr<VulkanCore::Buffer>> m_params;
+      std::vector<std::shared_ptr<VulkanCore::Texture>> m_textures;
+      std::shared_ptr<VulkanCore::Sampler> m_sampler;
+    };
+
+    /**
+     * @brief Back-to-back dispatches of shaders/bench/heavy.comp over one buffer
+     */
+    class HeavyComputeScene final : public BenchScene {
+    public:
+      static constexpr uint32_t kElementCount = 1u << 20;
+      static constexpr uint32_t kIterations   = 128;
+      static constexpr uint32_t kPasses       = 4;
+      static constexpr uint32_t kGroupSize    = 64;
+
+      void setup(HeadlessContext& bench, const SceneTargets&, uint32_t) override {
+        auto& context = bench.context();
+
+        std::mt19937 rng(kSceneSeed);
+        std::uniform_real_distribution<float> value(-1.0f, 1.0f);
+        std::vector<glm::vec4> values(kElementCount);
+        for (auto& v : values) {
+          v = {value(rng), value(rng), value(rng), value(rng)};
+        }
+        m_values = uploadStorageBuffer(
+            bench, values.data(), values.size() * sizeof(glm::vec4), "Heavy compute values"
+        );
+
+        m_shader = context.createShaderModule(
+            HeadlessContext::shaderPath("bench/heavy.comp"),
+            VK_SHADER_STAGE_COMPUTE_BIT,
+            "Heavy compute"
+        );
+        const VulkanCore::Pipeline::ComputePipelineDescriptor desc = {
+            .sets_ =
+                {
+                    {
+                        .set_      = 0,
+                        .bindings_ = {layoutBinding(
+                            0, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT
+                        )},
+                    },
+                },
+            .computeShader_ = m_shader,
+            .pushConstants_ =
+                {
+                    {
+                        .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT,
+                        .offset     = 0,
+                        .size       = sizeof(HeavyComputeParams),
+                    },
+                },
+        };
+        m_pipeline = context.createComputePipeline(desc, "Heavy compute");
+        m_pipeline->allocateDescriptors({{.set_ = 0, .count_ = 1, .name_ = "Heavy compute"}});
+        m_pipeline->bindResource(
+            0,
+            0,
+            0,
+            m_values,
+            0,
+            static_cast<uint32_t>(m_values->size()),
+            VK_DESCRIPTOR_TYPE_STORAGE_BUFFER
+        );
+        m_pipeline->updateDescriptorSets();
+      }
+
+      void record(VkCommandBuffer commandBuffer, uint32_t, uint32_t frame) override {
+        m_pipeline->bind(commandBuffer);
+        m_pipeline->bindDescriptorSets(commandBuffer, {{.set = 0, .bindIdx = 0}});
+
+        for (uint32_t pass = 0; pass < kPasses; ++pass) {
+          if (pass > 0) {
+            const VkMemoryBarrier barrier = {
+                .sType         = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+                .srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT,
+                .dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT,
+            };
+            vkCmdPipelineBarrier(
+                commandBuffer,
+                VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                0,
+                1,
+                &barrier,
+                0,
+                nullptr,
+                0,
+                nullptr
+            );
+          }
+
+          const HeavyComputeParams params = {
+              .count      = kElementCount,
+              .iterations = kIterations,
+              .time       = static_cast<float>(frame * kPasses + pass) * 0.001f,
+          };
+          m_pipeline->updatePushConstant(
+              commandBuffer, VK_SHADER_STAGE_COMPUTE_BIT, sizeof(params), &params
+          );
+          vkCmdDispatch(commandBuffer, kElementCount / kGroupSize, 1, 1);
+        }
+      }
+
+      auto persistentBuffers() const
+          -> std::vector<std::shared_ptr<VulkanCore::Buffer>> override {
+        return {m_values};
+      }
+
+    private:
+      std::shared_ptr<VulkanCore::ShaderModule> m_shader;
+      std::shared_ptr<VulkanCore::Pipeline> m_pipeline;
+      std::shared_ptr<VulkanCore::Buffer> m_values;
+    };
+
+    /**
+     * @brief Terrain clipmap flown over at speed, so levels stream every frame
+     */
+    class TerrainScene final : public BenchScene {
+    public:
+      static constexpr uint32_t kFieldSize = 2048;
+
+      void setup(HeadlessContext& bench, const SceneTargets& targets, uint32_t framesInFlight)
+          override {
+        m_targets = targets;
+
+        // Sum of random sine octaves; cheap to generate and rough enough that
+        // every level has detail
+        std::mt19937 rng(kSceneSeed);
+        std::uniform_real_distribution<float> phase(0.0f, 6.2831853f);
+        std::vector<float> heights(size_t{kFieldSize} * kFieldSize, 0.0f);
+        for (uint32_t octave = 0; octave < 6; ++octave) {
+          const float frequency = 0.004f * static_cast<float>(1u << octave);
+          const float amplitude = 120.0f / static_cast<float>(1u << octave);
+          const float px        = phase(rng);
+          const float pz        = phase(rng);
+          for (uint32_t z = 0; z < kFieldSize; ++z) {
+            for (uint32_t x = 0; x < kFieldSize; ++x) {
+              heights[size_t{z} * kFieldSize + x] +=
+                  amplitude * std::sin(static_cast<float>(x) * frequency + px) *
+                  std::cos(static_cast<float>(z) * frequency * 1.3f + pz);
+            }
+          }
+        }
+        m_source = std::make_unique<renderer::HeightfieldSource>(
+            kFieldSize, kFieldSize, std::move(heights)
+        );
+
+        m_clipmap = std::make_unique<renderer::TerrainClipmap>(
+            bench.context(),
+            *m_source,
+            renderer::TerrainClipmap::Descriptor{
+                .minHeight      = -250.0f,
+                .maxHeight      = 250.0f,
+                .framesInFlight = framesInFlight,
+                .colorFormat    = targets.color->vkFormat(),
+                .depthFormat    = targets.depth->vkFormat(),
+                .name           = "bench terrain",
+            }
+        );
+        auto commandBuffer = bench.queue().getCmdBufferToBegin();
+        m_clipmap->initialize(bench.queue(), commandBuffer);
+        bench.submitAndWait(commandBuffer);
+      }
+
+      void record(VkCommandBuffer commandBuffer, uint32_t, uint32_t frame) override {
+        // Straight line across the field at ~4 texels of level 0 per frame
+        const float distance = 200.0f + static_cast<float>(frame) * 4.0f;
+        const glm::vec3 eye  = {distance, 260.0f, distance * 0.5f};
+        const auto width     = static_cast<float>(m_targets.extent.width);
+        const auto height    = static_cast<float>(m_targets.extent.height);
+        glm::mat4 projection =
+            glm::perspective(glm::radians(60.0f), width / height, 0.5f, 20000.0f);
+        projection[1][1] *= -1.0f;
+
+        m_clipmap->update(
+            commandBuffer,
+            {
+                .view           = glm::lookAt(eye, eye + glm::vec3(1.0f, -0.4f, 0.5f), {0, 1, 0}),
+                .projection     = projection,
+                .cameraPosition = eye,
+            }
+        );
+
+        const VulkanCore::DynamicRendering::AttachmentDescription color = {
+            .imageView         = m_targets.color->vkImageView(),
+            .imageLayout       = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+            .attachmentLoadOp  = VK_ATTACHMENT_LOAD_OP_CLEAR,
+            .attachmentStoreOp = VK_ATTACHMENT_STORE_OP_STORE,
+            .clearValue        = {.color = {.float32 = {0.5f, 0.6f, 0.8f, 1.0f}}},
+        };
+        const VulkanCore::DynamicRendering::AttachmentDescription depth = {
+            .imageView         = m_targets.depth->vkImageView(),
+            .imageLayout       = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL,
+            .attachmentLoadOp  = VK_ATTACHMENT_LOAD_OP_CLEAR,
+            .attachmentStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE,
+            .clearValue        = {.depthStencil = {.depth = 1.0f}},
+        };
+        const VkRect2D area = {.extent = m_targets.extent};
+        VulkanCore::DynamicRendering::beginRenderingCmd(
+            commandBuffer,
+            m_targets.color->vkImage(),
+            0,
+            area,
+            1,
+            0,
+            {color},
+            &depth,
+            nullptr,
+            VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+            VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL
+        );
+        m_clipmap->render(commandBuffer, m_targets.extent);
+        VulkanCore::DynamicRendering::endRenderingCmd(
+            commandBuffer,
+            m_targets.color->vkImage(),
+            VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+            VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL
+        );
+      }
+
+    private:
+      SceneTargets m_targets;
+      std::unique_ptr<renderer::HeightfieldSource> m_source;
+      std::unique_ptr<renderer::TerrainClipmap> m_clipmap;
+    };
+
+    /**
+     * @brief Grass scattered on the GPU around a camera walking across a meadow
+     */
+    class FoliageScene final : public BenchScene {
+    public:
+      static constexpr uint32_t kMapSize = 1024;
+
+      void setup(HeadlessContext& bench, const SceneTargets& targets, uint32_t framesInFlight)
+          override {
+        m_targets     = targets;
+        auto& context = bench.context();
+
+        // One RGBA8 map: R gentle rolling height, G density in patches
+        std::vector<uint32_t> pixels(size_t{kMapSize} * kMapSize);
+        for (uint32_t y = 0; y < kMapSize; ++y) {
+          for (uint32_t x = 0; x < kMapSize; ++x) {
+            const float fx     = static_cast<float>(x);
+            const float fy     = static_cast<float>(y);
+            const float height = 0.5f + 0.25f * std::sin(fx * 0.02f) * std::cos(fy * 0.017f);
+            const float patch  = 0.5f + 0.5f * std::sin(fx * 0.09f + std::sin(fy * 0.05f) * 3.0f);
+            const auto r       = static_cast<uint32_t>(height * 255.0f);
+            const auto g       = static_cast<uint32_t>(patch * 255.0f);
+            pixels[size_t{y} * kMapSize + x] = 0xff000000u | (g << 8) | r;
+          }
+        }
+        auto map = context.createTexture(
+            VK_IMAGE_TYPE_2D,
+            VK_FORMAT_R8G8B8A8_UNORM,
+            0,
+            VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT,
+            {kMapSize, kMapSize, 1},
+            1,
+            1,
+            VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+            false,
+            VK_SAMPLE_COUNT_1_BIT,
+            "Foliage map"
+        );
+        auto staging = context.createStagingBuffer(
+            map->vkDeviceSize(), VK_BUFFER_USAGE_TRANSFER_SRC_BIT, "Foliage map staging"
+        );
+        auto commandBuffer = bench.queue().getCmdBufferToBegin();
+        map->uploadAndGenMips(commandBuffer, staging.get(), pixels.data());
+
+        // Two crossed cards up close, one card further out
+        const auto card = [](float angle, renderer::FoliageLod& lod) {
+          const auto base = static_cast<uint32_t>(lod.vertices.size());
+          const glm::vec3 side(std::cos(angle) * 0.15f, 0.0f, std::sin(angle) * 0.15f);
+          const glm::vec3 up(0.0f, 0.6f, 0.0f);
+          const glm::vec3 normal = glm::normalize(glm::vec3(-side.z, 0.0f, side.x));
+          for (const glm::vec3& position : {-side, side, side + up, up - side}) {
+            lod.vertices.push_back({.position = position, .normal = normal});
+          }
+          lod.indices.insert(
+              lod.indices.end(), {base, base + 1, base + 2, base, base + 2, base + 3}
+          );
+        };
+        renderer::FoliageLod nearLod{.maxDistance = 20.0f};
+        card(0.0f, nearLod);
+        card(1.5707963f, nearLod);
+        renderer::FoliageLod farLod{.maxDistance = 60.0f};
+        card(0.0f, farLod);
+
+        m_foliage = std::make_unique<renderer::FoliageScatter>(
+            context,
+            renderer::FoliageScatter::Descriptor{
+                .lods           = {std::move(nearLod), std::move(farLod)},
+                .densityMap     = map,
+                .heightMap      = map,
+                .densityChannel = 1,
+                .mapSize        = {static_cast<float>(kMapSize), static_cast<float>(kMapSize)},
+                .heightScale    = 20.0f,
+                .cellSize       = 0.2f,
+                .seed           = kSceneSeed,
+                .doubleSided    = true,
+                .framesInFlight = framesInFlight,
+                .colorFormat    = targets.color->vkFormat(),
+                .depthFormat    = targets.depth->vkFormat(),
+                .name           = "bench grass",
+            }
+        );
+        m_foliage->initialize(bench.queue(), commandBuffer);
+        bench.submitAndWait(commandBuffer);
+      }
+
+      void record(VkCommandBuffer commandBuffer, uint32_t, uint32_t frame) override {
+        // Walking pace diagonally across the map, just above the highest ground
+        const float distance = 100.0f + static_cast<float>(frame) * 0.1f;
+        const glm::vec3 eye  = {distance, 17.0f, distance};
+        const auto width     = static_cast<float>(m_targets.extent.width);
+        const auto height    = static_cast<float>(m_targets.extent.height);
+        glm::mat4 projection =
+            glm::perspective(glm::radians(60.0f), width / height, 0.1f, 200.0f);
+        projection[1][1] *= -1.0f;
+
+        m_foliage->update(
+            commandBuffer,
+            {
+                .view           = glm::lookAt(eye, eye + glm::vec3(1.0f, -0.3f, 1.0f), {0, 1, 0}),
+                .projection     = projection,
+                .cameraPosition = eye,
+            }
+        );
+
+        const VulkanCore::DynamicRendering::AttachmentDescription color = {
+            .imageView         = m_targets.color->vkImageView(),
+            .imageLayout       = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+            .attachmentLoadOp  = VK_ATTACHMENT_LOAD_OP_CLEAR,
+            .attachmentStoreOp = VK_ATTACHMENT_STORE_OP_STORE,
+            .clearValue        = {.color = {.float32 = {0.5f, 0.6f, 0.8f, 1.0f}}},
+        };
+        const VulkanCore::DynamicRendering::AttachmentDescription depth = {
+            .imageView         = m_targets.depth->vkImageView(),
+            .imageLayout       = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL,
+            .attachmentLoadOp  = VK_ATTACHMENT_LOAD_OP_CLEAR,
+            .attachmentStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE,
+            .clearValue        = {.depthStencil = {.depth = 1.0f}},
+        };
+        const VkRect2D area = {.extent = m_targets.extent};
+        VulkanCore::DynamicRendering::beginRenderingCmd(
+            commandBuffer,
+            m_targets.color->vkImage(),
+            0,
+            area,
+            1,
+            0,
+            {color},
+            &depth,
+            nullptr,
+            VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+            VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL
+        );
+        m_foliage->render(commandBuffer, m_targets.extent);
+        VulkanCore::DynamicRendering::endRenderingCmd(
+            commandBuffer,
+            m_targets.color->vkImage(),
+            VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+            VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL
+        );
+      }
+
+    private:
+      SceneTargets m_targets;
+      std::unique_ptr<renderer::FoliageScatter> m_foliage;
+    };
+  } // namespace
+
+  auto benchSceneNames() -> const std::vector<std::string>& {
+    static const std::vector<std::string> names = {
+        "many-draws",
+        "many-materials",
+        "static-draws",
+        "many-lights",
+        "big-textures",
+        "heavy-compute",
+        "terrain",
+        "foliage",
+    };
+    return names;
+  }
+
+  auto createBenchScene(const std::string& name) -> std::unique_ptr<BenchScene> {
+    // Draw-call bound: tiny cubes, almost no shading
+    if (name == "many-draws") {
+      return std::make_unique<ForwardScene>(ForwardSceneDesc{
+          .objectCount = 20000,
+          .objectScale = 0.4f,
+          .lightCount  = 4,
+          .lightRadius = 60.0f,
+      });
+    }
+    // Pipeline-switch bound: the many-draws load spread over 8 interleaved pipelines
+    if (name == "many-materials") {
+      return std::make_unique<ForwardScene>(ForwardSceneDesc{
+          .objectCount   = 20000,
+          .objectScale   = 0.4f,
+          .lightCount    = 4,
+          .lightRadius   = 60.0f,
+          .materialCount = 8,
+      });
+    }
+    // The many-draws load replayed from cached secondaries instead of re-recorded
+    if (name == "static-draws") {
+      return std::make_unique<ForwardScene>(ForwardSceneDesc{
+          .objectCount     = 20000,
+          .objectScale     = 0.4f,
+          .lightCount      = 4,
+          .lightRadius     = 60.0f,
+          .cachedRecording = true,
+      });
+    }
+    // Fragment bound: few large cubes covering the target, hundreds of lights
+    if (name == "many-lights") {
+      return std::make_unique<ForwardScene>(ForwardSceneDesc{
+          .objectCount = 256,
+          .objectScale = 6.0f,
+          .lightCount  = 512,
+          .lightRadius = 12.0f,
+      });
+    }
+    // Memory bound: 4096^2 RGBA8 textures with full mip chains, ~85 MB each
+    if (name == "big-textures") {
+      return std::make_unique<ForwardScene>(ForwardSceneDesc{
+          .objectCount  = 512,
+          .objectScale  = 4.0f,
+          .lightCount   = 4,
+          .lightRadius  = 60.0f,
+          .textureCount = kMaxSceneTextures,
+          .textureSize  = 4096,
+      });
+    }
+    if (name == "heavy-compute") {
+      return std::make_unique<HeavyComputeScene>();
+    }
+    // Vertex bound: clipmap terrain, constant block count at any view distance
+    if (name == "terrain") {
+      return std::make_unique<TerrainScene>();
+    }
+    // Compute and vertex bound: ~360k candidate cells scattered every frame
+    if (name == "foliage") {
+      return std::make_unique<FoliageScene>();
+    }
+    return nullptr;
+  }
+} // namespace kst::bench
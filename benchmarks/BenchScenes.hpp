@@ -0,0 +1,61 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "HeadlessContext.hpp"
+
+namespace kst::bench {
+  // Must match BENCH_MAX_TEXTURES in shaders/bench/scene.glsl
+  constexpr uint32_t kMaxSceneTextures = 8;
+
+  /**
+   * @brief Offscreen targets every scene renders into
+   */
+  struct SceneTargets {
+    VkExtent2D extent = {1920, 1080};
+    std::shared_ptr<VulkanCore::Texture> color;
+    std::shared_ptr<VulkanCore::Texture> depth;
+  };
+
+  /**
+   * @brief Procedurally generated workload driven by konstrukt_scenes
+   *
+   * setup() creates and uploads everything the scene needs, synchronously
+   * through HeadlessContext::queue(). record() is called once per frame with
+   * the frame-in-flight slot whose previous submit has already retired, so
+   * per-slot resources can be rewritten without further synchronization.
+   */
+  class BenchScene {
+  public:
+    virtual ~BenchScene() = default;
+
+    virtual void setup(
+        HeadlessContext& bench,
+        const SceneTargets& targets,
+        uint32_t framesInFlight
+    ) = 0;
+
+    virtual void record(VkCommandBuffer commandBuffer, uint32_t slot, uint32_t frame) = 0;
+
+    /**
+     * @brief Buffers whose contents carry over between frames, for handing the scene to another
+     * queue family
+     */
+    virtual auto persistentBuffers() const -> std::vector<std::shared_ptr<VulkanCore::Buffer>> {
+      return {};
+    }
+  };
+
+  /**
+   * @brief Names accepted by createBenchScene(), in the order konstrukt_scenes runs them
+   */
+  auto benchSceneNames() -> const std::vector<std::string>&;
+
+  /**
+   * @brief nullptr for an unknown name
+   */
+  auto createBenchScene(const std::string& name) -> std::unique_ptr<BenchScene>;
+} // namespace kst::bench
@@ -0,0 +1,266 @@
+#include <algorithm>
+#include <cstddef>
+#include <filesystem>
+#include <span>
+#include <string>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+#include <spdlog/sinks/null_sink.h>
+
+#include "CVar.hpp"
+#include "Logger.hpp"
+#include "MemoryTracker.hpp"
+#include "Metrics.hpp"
+#include "Result.hpp"
+#include "StateArena.hpp"
+#include "VulkanBackend/VulkanCore/Utility.hpp"
+
+namespace {
+  using kst::core::Logger;
+  using kst::core::LogLevel;
+  using kst::core::Result;
+
+  // Routes both loggers into a null sink so the numbers measure the logging
+  // front end (level filtering, source-location trimming, formatting) rather
+  // than console or disk throughput
+  void initNullLogger(LogLevel level) {
+    static const bool initialized = [] {
+      const auto logFile = std::filesystem::temp_directory_path() / "konstrukt_bench.log";
+      Logger::init(logFile.string());
+      auto nullSink = std::make_shared<spdlog::sinks::null_sink_mt>();
+      for (auto* logger : {&Logger::getCoreLogger(), &Logger::getClientLogger()}) {
+        (*logger)->sinks().clear();
+        (*logger)->sinks().push_back(nullSink);
+      }
+      return true;
+    }();
+    benchmark::DoNotOptimize(initialized);
+    Logger::setLevel(level);
+  }
+
+  void BM_LoggerFilteredTrace(benchmark::State& state) {
+    initNullLogger(LogLevel::WARN);
+    int frame = 0;
+    for (auto _ : state) {
+      KST_CORE_TRACE("frame {} took {} ms", frame++, 16.6);
+    }
+  }
+  BENCHMARK(BM_LoggerFilteredTrace);
+
+  void BM_LoggerMessage(benchmark::State& state) {
+    initNullLogger(LogLevel::TRACE);
+    for (auto _ : state) {
+      KST_CORE_INFO("swapchain recreated");
+    }
+  }
+  BENCHMARK(BM_LoggerMessage);
+
+  void BM_LoggerFormatted(benchmark::State& state) {
+    initNullLogger(LogLevel::TRACE);
+    int frame = 0;
+    for (auto _ : state) {
+      KST_CORE_INFO("frame {} took {} ms on {}", frame++, 16.6, "graphics queue");
+    }
+  }
+  BENCHMARK(BM_LoggerFormatted);
+
+  auto parseExtent(int value) -> Result<int> {
+    if (value < 0) {
+      return Result<int>::error("negative extent: " + std::to_string(value));
+    }
+    return Result<int>::success(value);
+  }
+
+  auto alignExtent(int value) -> Result<int> { return Result<int>::success((value + 63) & ~63); }
+
+  auto checkLimit(int value) -> Result<int> {
+    if (value > 16384) {
+      return Result<int>::error("extent exceeds device limit");
+    }
+    return Result<int>::success(value);
+  }
+
+  // state.range(0) selects the path: 0 propagates a value through the whole
+  // chain, 1 fails at the first step and propagates the error string
+  void BM_ResultPropagation(benchmark::State& state) {
+    int input = state.range(0) == 0 ? 1920 : -1;
+    for (auto _ : state) {
+      benchmark::DoNotOptimize(input);
+      auto result = parseExtent(input)
+                        .andThen(alignExtent)
+                        .andThen(checkLimit)
+                        .map<int>([](const int& extent) { return extent / 64; });
+      benchmark::DoNotOptimize(result);
+    }
+  }
+  BENCHMARK(BM_ResultPropagation)->Arg(0)->Arg(1)->ArgNames({"error"});
+
+  void BM_FnvHash(benchmark::State& state) {
+    const std::vector<char> data(static_cast<size_t>(state.range(0)), 'k');
+    for (auto _ : state) {
+      benchmark::DoNotOptimize(util::fnv_hash(data.data(), static_cast<int>(data.size())));
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * state.range(0));
+  }
+  BENCHMARK(BM_FnvHash)->RangeMultiplier(8)->Range(8, 32 << 10);
+
+  void BM_HashCombine(benchmark::State& state) {
+    // Shape of a typical pipeline / sampler cache key
+    const uint32_t format = 37, usage = 0x17, width = 1920, height = 1080;
+    const std::string name = "bloom level 3";
+    for (auto _ : state) {
+      size_t seed = 0;
+      util::hash_combine(seed, format, usage, width, height, name);
+      benchmark::DoNotOptimize(seed);
+    }
+  }
+  BENCHMARK(BM_HashCombine);
+
+  // Compare a KST_MEMORY_TRACKING=ON build against a default one to read the
+  // tracker's per-allocation cost; the tagged variant also pays for the scope
+  void BM_NewDelete(benchmark::State& state) {
+    const auto size = static_cast<size_t>(state.range(0));
+    for (auto _ : state) {
+      auto* block = new std::byte[size];
+      benchmark::DoNotOptimize(block);
+      delete[] block;
+    }
+  }
+  BENCHMARK(BM_NewDelete)->Arg(16)->Arg(256)->Arg(4096);
+
+  void BM_NewDeleteTagged(benchmark::State& state) {
+    const auto size = static_cast<size_t>(state.range(0));
+    for (auto _ : state) {
+      KST_MEMORY_SCOPE(Assets);
+      auto* block = new std::byte[size];
+      benchmark::DoNotOptimize(block);
+      delete[] block;
+    }
+  }
+  BENCHMARK(BM_NewDeleteTagged)->Arg(16)->Arg(256)->Arg(4096);
+
+  // Every thread hits the same counter; sharding should keep the per-add cost
+  // flat as threads are added
+  void BM_MetricsCounterAdd(benchmark::State& state) {
+    static auto& counter = kst::core::MetricsRegistry::instance().counter(
+        "kst_bench_counter_total", "konstrukt_bench counter"
+    );
+    for (auto _ : state) {
+      counter.add();
+    }
+  }
+  BENCHMARK(BM_MetricsCounterAdd)->Threads(1)->Threads(4)->Threads(8);
+
+  void BM_MetricsHistogramRecord(benchmark::State& state) {
+    static auto& histogram = kst::core::MetricsRegistry::instance().histogram(
+        "kst_bench_histogram_seconds", "konstrukt_bench histogram", {}, 1e-9
+    );
+    // LCG spread over ~24 bits so samples land in many buckets
+    uint64_t seed = 1;
+    for (auto _ : state) {
+      seed = seed * 6364136223846793005ull + 1442695040888963407ull;
+      histogram.record(seed >> 40);
+    }
+  }
+  BENCHMARK(BM_MetricsHistogramRecord)->Threads(1)->Threads(4)->Threads(8);
+
+  // Rollback-style world: 100k 64-byte objects, state.range(0) percent of
+  // them moved per frame, spread evenly so most pages are touched
+  struct BenchObject {
+    float position[4];
+    float velocity[4];
+    uint32_t flags;
+    uint32_t padding[7];
+  };
+  static_assert(sizeof(BenchObject) == 64);
+  constexpr size_t kStateObjects = 100'000;
+
+  void moveObjects(kst::core::StateArena& arena, std::span<BenchObject> objects, int64_t percent) {
+    const size_t stride = std::max<size_t>(1, static_cast<size_t>(100 / percent));
+    for (size_t i = 0; i < objects.size(); i += stride) {
+      auto& object = arena.write(&objects[i]);
+      object.position[0] += object.velocity[0];
+      object.flags ^= 1;
+    }
+  }
+
+  void BM_StateArenaSnapshot(benchmark::State& state) {
+    kst::core::StateArena arena(kStateObjects * sizeof(BenchObject) + (1 << 20));
+    auto objects = arena.createArray<BenchObject>(kStateObjects);
+    for (auto& object : objects) {
+      object.velocity[0] = 1.0f;
+    }
+    arena.snapshot();
+    for (auto _ : state) {
+      state.PauseTiming();
+      moveObjects(arena, objects, state.range(0));
+      state.ResumeTiming();
+      benchmark::DoNotOptimize(arena.snapshot());
+    }
+    state.counters["ring_bytes"] = static_cast<double>(arena.snapshotBytes());
+  }
+  BENCHMARK(BM_StateArenaSnapshot)
+      ->Arg(1)
+      ->Arg(10)
+      ->Arg(100)
+      ->ArgNames({"percent_dirty"})
+      ->Unit(benchmark::kMicrosecond);
+
+  // Rolls back one frame of changes, then replays it so the next iteration
+  // has a snapshot to return to
+  void BM_StateArenaRestore(benchmark::State& state) {
+    kst::core::StateArena arena(kStateObjects * sizeof(BenchObject) + (1 << 20));
+    auto objects = arena.createArray<BenchObject>(kStateObjects);
+    for (auto& object : objects) {
+      object.velocity[0] = 1.0f;
+    }
+    const uint64_t base = arena.snapshot();
+    for (auto _ : state) {
+      state.PauseTiming();
+      moveObjects(arena, objects, state.range(0));
+      arena.snapshot();
+      state.ResumeTiming();
+      benchmark::DoNotOptimize(arena.restore(base));
+    }
+  }
+  BENCHMARK(BM_StateArenaRestore)
+      ->Arg(1)
+      ->Arg(10)
+      ->Arg(100)
+      ->ArgNames({"percent_dirty"})
+      ->Unit(benchmark::kMicrosecond);
+
+  void BM_StateArenaCapture(benchmark::State& state) {
+    kst::core::StateArena arena(kStateObjects * sizeof(BenchObject) + (1 << 20));
+    arena.createArray<BenchObject>(kStateObjects);
+    for (auto _ : state) {
+      auto capture = arena.capture();
+      arena.restore(capture);
+      benchmark::DoNotOptimize(capture.bytes.data());
+    }
+  }
+  BENCHMARK(BM_StateArenaCapture)->Unit(benchmark::kMicrosecond);
+
+  kst::core::CVar<uint32_t> benchReloadTarget(
+      "bench.reloadTarget",
+      1,
+      "Set from the console, then from config reloads, by BM_CVarConfigReload"
+  );
+
+  // A config hot reload repeating a key the console already set. The set has
+  // to be a no-op; the run fails if the reload overrode the console value.
+  void BM_CVarConfigReload(benchmark::State& state) {
+    auto& registry = kst::core::CVarRegistry::instance();
+    registry.set("bench.reloadTarget", "7", kst::core::CVarSource::Console);
+    for (auto _ : state) {
+      benchmark::DoNotOptimize(
+          registry.set("bench.reloadTarget", "3", kst::core::CVarSource::ConfigFile)
+      );
+    }
+    if (benchReloadTarget.get() != 7) {
+      state.SkipWithError("config reload overrode a console value");
+    }
+  }
+  BENCHMARK(BM_CVarConfigReload);
+} // namespace
@@ -0,0 +1,60 @@
+#include "HeadlessContext.hpp"
+
+namespace kst::bench {
+  auto HeadlessContext::get() -> HeadlessContext& {
+    static HeadlessContext instance;
+    return instance;
+  }
+
+  namespace {
+    bool s_validation = false;
+
+    auto createContext() -> std::unique_ptr<VulkanCore::Context> {
+      auto layers             = std::vector<std::string>{};
+      auto instanceExtensions = std::vector<std::string>{};
+      if (s_validation) {
+        layers.emplace_back("VK_LAYER_KHRONOS_validation");
+        instanceExtensions.emplace_back(VK_EXT_DEBUG_UTILS_EXTENSION_NAME);
+      }
+      return std::make_unique<VulkanCore::Context>(
+          nullptr,
+          layers,
+          instanceExtensions,
+          // Optional, filtered against what the device exposes
+          std::vector<std::string>{
+              VK_KHR_MAINTENANCE_5_EXTENSION_NAME,
+              VK_EXT_DEVICE_GENERATED_COMMANDS_EXTENSION_NAME,
+          },
+          VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT | VK_QUEUE_TRANSFER_BIT,
+          false,
+          false,
+          "konstrukt_bench"
+      );
+    }
+  } // namespace
+
+  // The queue is built in place from the factory's return value, never copied
+  HeadlessContext::HeadlessContext()
+      : m_context(createContext()),
+        m_queue(m_context->createGraphicsCommandQueue(1, 1, "konstrukt_bench")) {}
+
+  void HeadlessContext::requestValidation() {
+    s_validation = true;
+  }
+
+  void HeadlessContext::submitAndWait(VkCommandBuffer commandBuffer) {
+    m_queue.endCmdBuffer(commandBuffer);
+
+    const VkSubmitInfo submitInfo = {
+        .sType              = VK_STRUCTURE_TYPE_SUBMIT_INFO,
+        .commandBufferCount = 1,
+        .pCommandBuffers    = &commandBuffer,
+    };
+    m_queue.submit(&submitInfo);
+    m_queue.waitUntilSubmitIsComplete();
+  }
+
+  auto HeadlessContext::shaderPath(const std::string& shader) -> std::string {
+    return std::string(KST_SHADER_DIR) + "/" + shader + ".spv";
+  }
+} // namespace kst::bench
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <memory>
+#include <string>
+
+#include "VulkanBackend/VulkanCore/CommandQueueManager.hpp"
+#include "VulkanBackend/VulkanCore/Context.hpp"
+
+namespace kst::bench {
+  /**
+   * @brief Surface-less Vulkan context shared by all RHI benchmarks
+   *
+   * Created on first use and kept for the whole run so device creation is not
+   * part of any measurement. Select lavapipe on GPU-less machines through
+   * VK_DRIVER_FILES (see KST_BENCH_ICD in benchmarks/CMakeLists.txt).
+   */
+  class HeadlessContext {
+  public:
+    static auto get() -> HeadlessContext&;
+
+    /**
+     * @brief Turns on VK_LAYER_KHRONOS_validation for the context get() creates; call before get()
+     *
+     * Validation errors stop the process through the context's debug messenger.
+     */
+    static void requestValidation();
+
+    auto context() -> VulkanCore::Context& { return *m_context; }
+
+    auto queue() -> VulkanCore::CommandQueueManager& { return m_queue; }
+
+    /**
+     * @brief Submits the command buffer returned by queue().getCmdBufferToBegin() and waits for it
+     */
+    void submitAndWait(VkCommandBuffer commandBuffer);
+
+    /**
+     * @brief Path of a compiled shader from the shaders/ tree, e.g. "animation/skinning.comp"
+     */
+    static auto shaderPath(const std::string& shader) -> std::string;
+
+  private:
+    HeadlessContext();
+
+    std::unique_ptr<VulkanCore::Context> m_context;
+    // Declared after m_context so it is destroyed first
+    VulkanCore::CommandQueueManager m_queue;
+  };
+} // namespace kst::bench
@@ -0,0 +1,34 @@
+#include "MetricsReport.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+
+namespace kst::bench {
+  auto percentile(std::vector<double> samples, double p) -> double {
+    if (samples.empty()) {
+      return 0.0;
+    }
+    std::sort(samples.begin(), samples.end());
+    const auto rank = static_cast<size_t>(std::ceil(p / 100.0 * samples.size()));
+    return samples[std::clamp<size_t>(rank, 1, samples.size()) - 1];
+  }
+
+  auto writeMetricsJson(const std::string& path, const std::vector<Metric>& metrics) -> bool {
+    std::ofstream out(path);
+    if (!out) {
+      return false;
+    }
+
+    out.precision(9);
+    out << "{\n  \"metrics\": [";
+    for (size_t i = 0; i < metrics.size(); ++i) {
+      const auto& metric = metrics[i];
+      out << (i == 0 ? "\n" : ",\n") << "    {\"name\": \"" << metric.name
+          << "\", \"value\": " << metric.value << ", \"unit\": \"" << metric.unit
+          << "\", \"better\": \"" << (metric.higherIsBetter ? "higher" : "lower") << "\"}";
+    }
+    out << "\n  ]\n}\n";
+    return static_cast<bool>(out);
+  }
+} // namespace kst::bench
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+namespace kst::bench {
+  /**
+   * @brief One value reported by a metrics-producing tool (konstrukt_replay, ...)
+   */
+  struct Metric {
+    std::string name;
+    double value = 0.0;
+    std::string unit;
+    bool higherIsBetter = false;
+  };
+
+  /**
+   * @brief Nearest-rank percentile, p in [0, 100]; 0 for an empty sample set
+   */
+  auto percentile(std::vector<double> samples, double p) -> double;
+
+  /**
+   * @brief Writes {"metrics": [{"name", "value", "unit", "better"}]}, the format
+   * scripts/perf-regression.py reads from --suite commands
+   */
+  auto writeMetricsJson(const std::string& path, const std::vector<Metric>& metrics) -> bool;
+} // namespace kst::bench
@@ -0,0 +1,364 @@
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "HeadlessContext.hpp"
+#include "Mesh/GeometryPool.hpp"
+#include "VulkanBackend/VulkanCore/Buffer.hpp"
+#include "VulkanBackend/VulkanCore/DeletionQueue.hpp"
+#include "VulkanBackend/VulkanCore/Pipeline.hpp"
+#include "VulkanBackend/VulkanCore/ShaderModule.hpp"
+
+namespace {
+  using kst::bench::HeadlessContext;
+
+  constexpr uint32_t kStorageBindings = 4;
+
+  // Same interface as shaders/animation/skinning.comp: four storage buffers
+  // in set 0 and an 8-byte push constant block
+  auto skinningPipelineDescriptor(const std::shared_ptr<VulkanCore::ShaderModule>& shader)
+      -> VulkanCore::Pipeline::ComputePipelineDescriptor {
+    VulkanCore::Pipeline::SetDescriptor set = {.set_ = 0};
+    for (uint32_t binding = 0; binding < kStorageBindings; ++binding) {
+      set.bindings_.push_back({
+          .binding         = binding,
+          .descriptorType  = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+          .descriptorCount = 1,
+          .stageFlags      = VK_SHADER_STAGE_COMPUTE_BIT,
+      });
+    }
+    return {
+        .sets_          = {set},
+        .computeShader_ = shader,
+        .pushConstants_ =
+            {
+                {
+                    .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT,
+                    .offset     = 0,
+                    .size       = 2 * sizeof(uint32_t),
+                },
+            },
+    };
+  }
+
+  auto skinningShader() -> const std::shared_ptr<VulkanCore::ShaderModule>& {
+    static const auto shader = HeadlessContext::get().context().createShaderModule(
+        HeadlessContext::shaderPath("animation/skinning.comp"),
+        VK_SHADER_STAGE_COMPUTE_BIT,
+        "bench skinning"
+    );
+    return shader;
+  }
+
+  // Destruction goes through the deletion queue, so collect() is part of the
+  // measured cost, as it is once per frame in the renderer
+  void BM_BufferCreate(benchmark::State& state) {
+    auto& bench   = HeadlessContext::get();
+    const auto sz = static_cast<size_t>(state.range(0));
+    for (auto _ : state) {
+      auto buffer = bench.context().createBuffer(
+          sz,
+          VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+          VMA_MEMORY_USAGE_GPU_ONLY,
+          "bench buffer"
+      );
+      benchmark::DoNotOptimize(buffer->vkBuffer());
+      buffer.reset();
+      bench.context().deletionQueue().collect();
+    }
+  }
+  BENCHMARK(BM_BufferCreate)->RangeMultiplier(16)->Range(256, 16 << 20);
+
+  void BM_BufferUpload(benchmark::State& state) {
+    auto& bench   = HeadlessContext::get();
+    const auto sz = static_cast<size_t>(state.range(0));
+    const std::vector<uint8_t> data(sz, 0x5a);
+    auto buffer = bench.context().createBuffer(
+        sz,
+        VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+        VMA_MEMORY_USAGE_GPU_ONLY,
+        "bench upload target"
+    );
+    for (auto _ : state) {
+      auto commandBuffer = bench.queue().getCmdBufferToBegin();
+      bench.context().uploadToGPUBuffer(
+          bench.queue(), commandBuffer, buffer.get(), data.data(), static_cast<long>(sz)
+      );
+      bench.submitAndWait(commandBuffer);
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * state.range(0));
+  }
+  BENCHMARK(BM_BufferUpload)->RangeMultiplier(16)->Range(4 << 10, 16 << 20)->UseRealTime();
+
+  void BM_ComputePipelineCreate(benchmark::State& state) {
+    auto& bench     = HeadlessContext::get();
+    const auto desc = skinningPipelineDescriptor(skinningShader());
+    for (auto _ : state) {
+      auto pipeline = bench.context().createComputePipeline(desc, "bench pipeline");
+      benchmark::DoNotOptimize(pipeline->vkPipeline());
+      pipeline.reset();
+      bench.context().deletionQueue().collect();
+    }
+  }
+  BENCHMARK(BM_ComputePipelineCreate);
+
+  // Rewrites every binding of state.range(0) descriptor sets, the pattern used
+  // after resizes and when streaming resources swap buffers
+  void BM_DescriptorUpdate(benchmark::State& state) {
+    auto& bench         = HeadlessContext::get();
+    const auto setCount = static_cast<uint32_t>(state.range(0));
+    auto pipeline =
+        bench.context().createComputePipeline(skinningPipelineDescriptor(skinningShader()));
+    pipeline->allocateDescriptors({{.set_ = 0, .count_ = setCount, .name_ = "bench"}});
+
+    auto buffer = bench.context().createBuffer(
+        64 << 10, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VMA_MEMORY_USAGE_GPU_ONLY, "bench bindings"
+    );
+    for (auto _ : state) {
+      for (uint32_t index = 0; index < setCount; ++index) {
+        for (uint32_t binding = 0; binding < kStorageBindings; ++binding) {
+          pipeline->bindResource(
+              0,
+              binding,
+              index,
+              buffer,
+              binding * (16 << 10),
+              16 << 10,
+              VK_DESCRIPTOR_TYPE_STORAGE_BUFFER
+          );
+        }
+      }
+      pipeline->updateDescriptorSets();
+    }
+    state.SetItemsProcessed(
+        static_cast<int64_t>(state.iterations()) * setCount * kStorageBindings
+    );
+  }
+  BENCHMARK(BM_DescriptorUpdate)->RangeMultiplier(4)->Range(1, 64);
+
+  // CPU cost of recording state.range(0) bind + push constant + dispatch
+  // sequences; the command buffer is never submitted
+  void BM_CommandRecording(benchmark::State& state) {
+    auto& bench              = HeadlessContext::get();
+    const auto dispatchCount = static_cast<uint32_t>(state.range(0));
+    auto pipeline =
+        bench.context().createComputePipeline(skinningPipelineDescriptor(skinningShader()));
+    pipeline->allocateDescriptors({{.set_ = 0, .count_ = 1, .name_ = "bench"}});
+
+    for (auto _ : state) {
+      auto commandBuffer = bench.queue().getCmdBufferToBegin();
+      for (uint32_t i = 0; i < dispatchCount; ++i) {
+        const uint32_t pushConstants[2] = {1, i * 64};
+        pipeline->bind(commandBuffer);
+        pipeline->bindDescriptorSets(commandBuffer, {{.set = 0, .bindIdx = 0}});
+        pipeline->updatePushConstant(
+            commandBuffer, VK_SHADER_STAGE_COMPUTE_BIT, sizeof(pushConstants), pushConstants
+        );
+        vkCmdDispatch(commandBuffer, 1, 1, 1);
+      }
+      bench.queue().endCmdBuffer(commandBuffer);
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * dispatchCount);
+  }
+  BENCHMARK(BM_CommandRecording)->RangeMultiplier(8)->Range(8, 4096);
+
+  // Per-frame sync object churn: a fence and two semaphores created and
+  // destroyed, against the same objects taken from and returned to the pools
+  void BM_SyncObjectCreate(benchmark::State& state) {
+    const VkDevice device                     = HeadlessContext::get().context().device();
+    const VkFenceCreateInfo fenceInfo         = {.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO};
+    const VkSemaphoreCreateInfo semaphoreInfo = {.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO};
+    for (auto _ : state) {
+      VkFence fence                         = VK_NULL_HANDLE;
+      std::array<VkSemaphore, 2> semaphores = {};
+      VK_CHECK(vkCreateFence(device, &fenceInfo, nullptr, &fence));
+      for (auto& semaphore : semaphores) {
+        VK_CHECK(vkCreateSemaphore(device, &semaphoreInfo, nullptr, &semaphore));
+      }
+      benchmark::DoNotOptimize(fence);
+      vkDestroyFence(device, fence, nullptr);
+      for (const auto semaphore : semaphores) {
+        vkDestroySemaphore(device, semaphore, nullptr);
+      }
+    }
+  }
+  BENCHMARK(BM_SyncObjectCreate);
+
+  void BM_SyncObjectPooled(benchmark::State& state) {
+    auto& context = HeadlessContext::get().context();
+    for (auto _ : state) {
+      const auto fence                      = context.fencePool().acquire();
+      std::array<VkSemaphore, 2> semaphores = {};
+      for (auto& semaphore : semaphores) {
+        semaphore = context.semaphorePool().acquire();
+      }
+      benchmark::DoNotOptimize(fence);
+      context.fencePool().release(fence);
+      for (const auto semaphore : semaphores) {
+        context.semaphorePool().release(semaphore);
+      }
+    }
+    state.counters["fence_hit_rate"] = context.fencePool().stats().hitRate();
+  }
+  BENCHMARK(BM_SyncObjectPooled);
+
+  // Concurrent variants: every thread creates and releases its own objects
+  // against the shared context. Per-thread throughput should stay flat as the
+  // thread count grows; a drop points at a lock shared by all creators. Build
+  // with KST_SANITIZE_THREAD to run them as a race stress test.
+  void BM_BufferCreateConcurrent(benchmark::State& state) {
+    auto& bench = HeadlessContext::get();
+    for (auto _ : state) {
+      auto buffer = bench.context().createBuffer(
+          64 << 10,
+          VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+          VMA_MEMORY_USAGE_GPU_ONLY,
+          "bench concurrent buffer"
+      );
+      benchmark::DoNotOptimize(buffer->vkBuffer());
+      buffer.reset();
+      bench.context().deletionQueue().collect();
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()));
+  }
+  BENCHMARK(BM_BufferCreateConcurrent)->ThreadRange(1, 8)->UseRealTime();
+
+  void BM_ComputePipelineCreateConcurrent(benchmark::State& state) {
+    auto& bench     = HeadlessContext::get();
+    const auto desc = skinningPipelineDescriptor(skinningShader());
+    for (auto _ : state) {
+      auto pipeline = bench.context().createComputePipeline(desc, "bench concurrent pipeline");
+      benchmark::DoNotOptimize(pipeline->vkPipeline());
+      pipeline.reset();
+      bench.context().deletionQueue().collect();
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()));
+  }
+  BENCHMARK(BM_ComputePipelineCreateConcurrent)->ThreadRange(1, 8)->UseRealTime();
+
+  // Loader threads binding into one shared pipeline, each into its own
+  // descriptor sets, and flushing their writes
+  void BM_DescriptorBindConcurrent(benchmark::State& state) {
+    constexpr uint32_t kSetsPerThread = 8;
+    constexpr uint32_t kMaxThreads    = 8;
+
+    auto& bench           = HeadlessContext::get();
+    static const auto pipeline = [&] {
+      auto shared =
+          bench.context().createComputePipeline(skinningPipelineDescriptor(skinningShader()));
+      shared->allocateDescriptors(
+          {{.set_ = 0, .count_ = kSetsPerThread * kMaxThreads, .name_ = "bench concurrent"}}
+      );
+      return shared;
+    }();
+    static const auto buffer = bench.context().createBuffer(
+        64 << 10, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VMA_MEMORY_USAGE_GPU_ONLY, "bench bindings"
+    );
+
+    const auto firstSet = static_cast<uint32_t>(state.thread_index()) * kSetsPerThread;
+    for (auto _ : state) {
+      for (uint32_t index = firstSet; index < firstSet + kSetsPerThread; ++index) {
+        for (uint32_t binding = 0; binding < kStorageBindings; ++binding) {
+          pipeline->bindResource(
+              0,
+              binding,
+              index,
+              buffer,
+              binding * (16 << 10),
+              16 << 10,
+              VK_DESCRIPTOR_TYPE_STORAGE_BUFFER
+          );
+        }
+      }
+      pipeline->updateDescriptorSets();
+    }
+    state.SetItemsProcessed(
+        static_cast<int64_t>(state.iterations()) * kSetsPerThread * kStorageBindings
+    );
+  }
+  BENCHMARK(BM_DescriptorBindConcurrent)->ThreadRange(1, 8)->UseRealTime();
+
+  // Grid of quads x quads cells in the xz plane, the worst case for cluster
+  // packing: every vertex is shared by up to six triangles
+  void makeGrid(
+      uint32_t quads,
+      std::vector<kst::renderer::MeshVertex>& vertices,
+      std::vector<uint32_t>& indices
+  ) {
+    for (uint32_t z = 0; z <= quads; ++z) {
+      for (uint32_t x = 0; x <= quads; ++x) {
+        auto& vertex    = vertices.emplace_back();
+        vertex.position = {static_cast<float>(x), 0.0f, static_cast<float>(z)};
+      }
+    }
+    for (uint32_t z = 0; z < quads; ++z) {
+      for (uint32_t x = 0; x < quads; ++x) {
+        const uint32_t corner = z * (quads + 1) + x;
+        const uint32_t above  = corner + quads + 1;
+        indices.insert(indices.end(), {corner, corner + 1, above, corner + 1, above + 1, above});
+      }
+    }
+  }
+
+  void BM_GeometryPaginate(benchmark::State& state) {
+    std::vector<kst::renderer::MeshVertex> vertices;
+    std::vector<uint32_t> indices;
+    makeGrid(static_cast<uint32_t>(state.range(0)), vertices, indices);
+    const kst::renderer::GeometryLod lod = {.vertices = vertices, .indices = indices};
+    for (auto _ : state) {
+      auto pages = kst::renderer::GeometryPool::paginate({&lod, 1}, 64 << 10);
+      benchmark::DoNotOptimize(pages.data.data());
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * indices.size() / 3));
+  }
+  BENCHMARK(BM_GeometryPaginate)->RangeMultiplier(4)->Range(16, 256);
+
+  // Streams state.range(0) meshes through a pool a quarter of their size, one
+  // LOD request per mesh per frame, so every update() evicts and uploads
+  void BM_GeometryPoolUpdate(benchmark::State& state) {
+    auto& bench       = HeadlessContext::get();
+    const auto meshes = static_cast<uint32_t>(state.range(0));
+
+    std::vector<kst::renderer::MeshVertex> vertices;
+    std::vector<uint32_t> indices;
+    makeGrid(64, vertices, indices);
+    const kst::renderer::GeometryLod lod = {.vertices = vertices, .indices = indices};
+    const auto pagesPerMesh              = static_cast<uint32_t>(
+        kst::renderer::GeometryPool::paginate({&lod, 1}, 64 << 10).pages.size()
+    );
+
+    kst::renderer::GeometryPool pool(
+        bench.context(),
+        {
+            .physicalPages       = std::max(meshes * pagesPerMesh / 4, pagesPerMesh * 2),
+            .maxVirtualPages     = meshes * pagesPerMesh,
+            .maxClusters         = 1u << 16,
+            .uploadBytesPerFrame = 1ull << 20,
+            .name                = "bench geometry",
+        }
+    );
+    for (uint32_t mesh = 0; mesh < meshes; ++mesh) {
+      pool.addMesh({&lod, 1});
+    }
+
+    uint32_t frame   = 0;
+    uint64_t uploads = 0;
+    for (auto _ : state) {
+      pool.request(frame % meshes, 0);
+      auto commandBuffer = bench.queue().getCmdBufferToBegin();
+      pool.update(commandBuffer, frame % 2);
+      pool.recordFeedback(commandBuffer, frame % 2);
+      bench.submitAndWait(commandBuffer);
+      uploads += pool.stats().uploadedBytes;
+      ++frame;
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(uploads));
+    state.counters["resident_pages"] = pool.stats().residentPages;
+  }
+  BENCHMARK(BM_GeometryPoolUpdate)->Arg(16)->Arg(256)->UseRealTime();
+} // namespace
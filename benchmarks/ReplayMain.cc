@@ -0,0 +1,131 @@
+// konstrukt_replay: plays a capture recorded with Context::beginCommandCapture()
+// on a headless device and reports per-frame CPU submission and GPU time.
+//
+//   konstrukt_replay <capture> [--loops N] [--json <path>] [--quiet]
+//
+// With more than one loop the first one is a warm-up (object creation,
+// pipeline compilation, first-touch allocations) and is left out of the
+// summary and the JSON metrics.
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "HeadlessContext.hpp"
+#include "MetricsReport.hpp"
+#include "VulkanBackend/VulkanCore/CommandReplay.hpp"
+
+namespace {
+  struct Options {
+    std::string capture;
+    std::string json;
+    uint32_t loops = 1;
+    bool quiet     = false;
+  };
+
+  void printUsage(const char* argv0) {
+    std::fprintf(
+        stderr, "usage: %s <capture> [--loops N] [--json <path>] [--quiet]\n", argv0
+    );
+  }
+
+  auto parseOptions(int argc, char** argv, Options& options) -> bool {
+    for (int i = 1; i < argc; ++i) {
+      const std::string arg = argv[i];
+      if (arg == "--loops" && i + 1 < argc) {
+        options.loops = static_cast<uint32_t>(std::max(1, std::atoi(argv[++i])));
+      } else if (arg == "--json" && i + 1 < argc) {
+        options.json = argv[++i];
+      } else if (arg == "--quiet") {
+        options.quiet = true;
+      } else if (!arg.empty() && arg[0] != '-' && options.capture.empty()) {
+        options.capture = arg;
+      } else {
+        return false;
+      }
+    }
+    return !options.capture.empty();
+  }
+} // namespace
+
+auto main(int argc, char** argv) -> int {
+  Options options;
+  if (!parseOptions(argc, argv, options)) {
+    printUsage(argv[0]);
+    return 2;
+  }
+
+  // Same feature set the renderer's VulkanContext enables
+  VulkanCore::Context::enableDefaultFeatures();
+  VulkanCore::Context::enableScalarLayoutFeatures();
+  VulkanCore::Context::enableBufferDeviceAddressFeature();
+  VulkanCore::Context::enableDynamicRenderingFeature();
+  VulkanCore::Context::enableSynchronization2Feature();
+
+  auto& bench = kst::bench::HeadlessContext::get();
+  VulkanCore::CommandReplay replay(bench.context(), options.capture);
+  if (replay.frameCount() == 0) {
+    std::fprintf(stderr, "%s contains no frames\n", options.capture.c_str());
+    return 1;
+  }
+
+  std::vector<double> cpuMs;
+  std::vector<double> gpuMs;
+  double setupMs = 0.0;
+  for (uint32_t loop = 0; loop < options.loops; ++loop) {
+    const bool warmUp = options.loops > 1 && loop == 0;
+    for (size_t frame = 0; frame < replay.frameCount(); ++frame) {
+      const auto timing = replay.replayFrame(frame);
+      setupMs += timing.setupMs;
+      if (!options.quiet) {
+        std::printf(
+            "loop %3u frame %5zu  cpu %8.3f ms  gpu %8.3f ms  setup %8.3f ms  submits %u%s\n",
+            loop,
+            frame,
+            timing.cpuMs,
+            timing.gpuMs,
+            timing.setupMs,
+            timing.submits,
+            warmUp ? "  (warm-up)" : ""
+        );
+      }
+      if (!warmUp) {
+        cpuMs.push_back(timing.cpuMs);
+        gpuMs.push_back(timing.gpuMs);
+      }
+    }
+    bench.context().deletionQueue().collect();
+  }
+
+  using kst::bench::percentile;
+  std::printf(
+      "%zu frames x %u loops: cpu p50 %.3f / p95 %.3f / p99 %.3f ms, "
+      "gpu p50 %.3f / p95 %.3f / p99 %.3f ms, setup %.3f ms total\n",
+      replay.frameCount(),
+      options.loops,
+      percentile(cpuMs, 50),
+      percentile(cpuMs, 95),
+      percentile(cpuMs, 99),
+      percentile(gpuMs, 50),
+      percentile(gpuMs, 95),
+      percentile(gpuMs, 99),
+      setupMs
+  );
+
+  if (!options.json.empty()) {
+    const std::vector<kst::bench::Metric> metrics = {
+        {"cpu_submit_p50", percentile(cpuMs, 50), "ms"},
+        {"cpu_submit_p95", percentile(cpuMs, 95), "ms"},
+        {"gpu_p50", percentile(gpuMs, 50), "ms"},
+        {"gpu_p95", percentile(gpuMs, 95), "ms"},
+    };
+    if (!kst::bench::writeMetricsJson(options.json, metrics)) {
+      std::fprintf(stderr, "failed to write %s\n", options.json.c_str());
+      return 1;
+    }
+  }
+  return 0;
+}
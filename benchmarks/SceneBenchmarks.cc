@@ -0,0 +1,175 @@
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "SceneFile.hpp"
+#include "SceneWriter.hpp"
+#include "WorldStreamer.hpp"
+
+namespace {
+  using kst::scene::SceneBounds;
+  using kst::scene::SceneFile;
+
+  constexpr uint32_t kLargeSceneObjects = 1'000'000;
+  constexpr float kLargeSceneExtent     = 4096.0f;
+
+  // One million objects scattered over a 4 km square, sharing 256 meshes and
+  // 32 materials. Written once per process; the page cache keeps it warm, so
+  // the numbers are load cost rather than disk speed.
+  auto largeScenePath() -> const std::filesystem::path& {
+    static const auto path = [] {
+      auto file = std::filesystem::temp_directory_path() / "konstrukt_bench_1m.kscene";
+      kst::scene::SceneWriter writer;
+      std::vector<uint32_t> meshes;
+      for (int i = 0; i < 256; ++i) {
+        meshes.push_back(writer.addMesh("meshes/prop_" + std::to_string(i) + ".mesh"));
+      }
+      std::vector<uint32_t> materials;
+      for (int i = 0; i < 32; ++i) {
+        materials.push_back(writer.addMaterial("materials/surface_" + std::to_string(i)));
+      }
+
+      writer.reserve(kLargeSceneObjects);
+      uint64_t seed = 1;
+      const auto random = [&seed] {
+        seed = seed * 6364136223846793005ull + 1442695040888963407ull;
+        return static_cast<float>(seed >> 40) / static_cast<float>(1u << 24);
+      };
+      for (uint32_t i = 0; i < kLargeSceneObjects; ++i) {
+        const float x = random() * kLargeSceneExtent;
+        const float z = random() * kLargeSceneExtent;
+        const float y = random() * 16.0f;
+        writer.addObject({
+            .transform = {{x, y, z}, {0.0f, 0.0f, 0.0f, 1.0f}, {1.0f, 1.0f, 1.0f}},
+            .bounds    = {{x - 1.0f, y - 1.0f, z - 1.0f}, {x + 1.0f, y + 1.0f, z + 1.0f}},
+            .mesh      = meshes[i % meshes.size()],
+            .material  = materials[i % materials.size()],
+        });
+      }
+      const auto written = writer.write(file);
+      if (written.hasError()) {
+        std::fprintf(stderr, "%s\n", written.error().c_str());
+        std::abort();
+      }
+      return file;
+    }();
+    return path;
+  }
+
+  // What a level load costs before any object is used: map, validate the
+  // header and index, resolve the asset tables to handles
+  void BM_SceneOpen(benchmark::State& state) {
+    const auto& path = largeScenePath();
+    for (auto _ : state) {
+      auto scene = SceneFile::open(path);
+      auto meshHandles =
+          SceneFile::resolve<uint32_t>(scene.value()->meshes(), [](std::string_view name) {
+            return static_cast<uint32_t>(name.size());
+          });
+      benchmark::DoNotOptimize(meshHandles.data());
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * kLargeSceneObjects);
+  }
+  BENCHMARK(BM_SceneOpen)->Unit(benchmark::kMicrosecond);
+
+  // Open plus reading every transform and mesh reference once, i.e. the page
+  // faults of a full load on top of BM_SceneOpen
+  void BM_SceneOpenAndTouch(benchmark::State& state) {
+    const auto& path = largeScenePath();
+    for (auto _ : state) {
+      auto scene    = SceneFile::open(path);
+      float sum     = 0.0f;
+      uint64_t refs = 0;
+      for (const auto& transform : scene.value()->transforms()) {
+        sum += transform.position[0];
+      }
+      for (const uint32_t mesh : scene.value()->meshRefs()) {
+        refs += mesh;
+      }
+      benchmark::DoNotOptimize(sum);
+      benchmark::DoNotOptimize(refs);
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * kLargeSceneObjects);
+  }
+  BENCHMARK(BM_SceneOpenAndTouch)->Unit(benchmark::kMillisecond);
+
+  // Partial load: the chunks around a point and only their objects.
+  // state.range(0) is the region's edge in meters.
+  void BM_SceneLoadRegion(benchmark::State& state) {
+    const auto& path   = largeScenePath();
+    const float half   = static_cast<float>(state.range(0)) * 0.5f;
+    const float center = kLargeSceneExtent * 0.5f;
+    const SceneBounds region{
+        {center - half, -100.0f, center - half},
+        {center + half, 100.0f, center + half},
+    };
+    int64_t objects = 0;
+    for (auto _ : state) {
+      auto scene            = SceneFile::open(path);
+      float sum             = 0.0f;
+      const auto transforms = scene.value()->transforms();
+      for (const uint32_t index : scene.value()->chunksOverlapping(region)) {
+        const auto& chunk = scene.value()->chunks()[index];
+        for (const auto& transform : transforms.subspan(chunk.firstObject, chunk.objectCount)) {
+          sum += transform.position[0];
+        }
+        objects += chunk.objectCount;
+      }
+      benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(objects);
+  }
+  BENCHMARK(BM_SceneLoadRegion)->Arg(64)->Arg(256)->Unit(benchmark::kMicrosecond);
+
+  // Cells that read instantly and upload by counting, so the benchmark is the
+  // streamer's own per-frame cost
+  class SyntheticCells : public kst::scene::CellSource {
+  public:
+    auto read(kst::scene::CellCoord) -> kst::core::Result<std::unique_ptr<kst::scene::CellData>>
+        override {
+      auto data                = std::make_unique<kst::scene::CellData>();
+      data->residentBytes      = 4u << 20;
+      data->pendingUploadBytes = 2u << 20;
+      return kst::core::Result<std::unique_ptr<kst::scene::CellData>>::success(std::move(data));
+    }
+
+    auto upload(kst::scene::CellCoord, kst::scene::CellData& data, uint64_t budget)
+        -> uint64_t override {
+      const uint64_t bytes = std::min(budget, data.pendingUploadBytes);
+      data.pendingUploadBytes -= bytes;
+      return bytes;
+    }
+
+    void evict(kst::scene::CellCoord, kst::scene::CellData&) override {}
+  };
+
+  // One update() per iteration with the viewer driving across the world at
+  // 60 m/s and 60 Hz. state.range(0) is the load radius in meters.
+  void BM_WorldStreamerUpdate(benchmark::State& state) {
+    SyntheticCells cells;
+    kst::scene::WorldStreamer streamer(
+        cells,
+        {
+            .cellSize          = 64.0f,
+            .loadRadius        = static_cast<float>(state.range(0)),
+            .unloadRadius      = static_cast<float>(state.range(0)) + 64.0f,
+            .memoryBudgetBytes = 2ull << 30,
+        }
+    );
+    kst::scene::StreamingViewer viewer;
+    viewer.velocity[0] = 60.0f;
+    streamer.loadAround(viewer);
+    for (auto _ : state) {
+      viewer.position[0] += 1.0f;
+      streamer.update(viewer);
+    }
+    state.counters["resident"] = static_cast<double>(streamer.stats().resident);
+  }
+  BENCHMARK(BM_WorldStreamerUpdate)->Arg(256)->Arg(1024)->Unit(benchmark::kMicrosecond);
+} // namespace
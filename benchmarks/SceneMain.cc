@@ -0,0 +1,480 @@
+// konstrukt_scenes: renders the procedural scenes of BenchScenes.cc offscreen
+// for a fixed number of frames and reports CPU frame time, GPU time and peak
+// device-local memory per scene.
+//
+//   konstrukt_scenes [--scene <name>]... [--frames N] [--warmup N]
+//                    [--size WxH] [--json <path>] [--submission-thread]
+//                    [--async-compute] [--validation] [--list]
+//
+// CPU frame time covers waiting for the frame-in-flight slot, recording and
+// submitting, i.e. the frame pacing an application would see. GPU time comes
+// from timestamps around each frame's command buffer. --submission-thread
+// hands vkQueueSubmit to the context's submission thread, so the CPU time
+// no longer includes the driver's submit cost.
+//
+// --async-compute runs heavy-compute on the compute queue alongside every
+// scene through AsyncComputeScheduler and reports the GPU time of the compute
+// and graphics queues separately; timestamps from two queues can't be lined
+// up, so overlap shows as gpu_frame staying put next to a run without the
+// flag. Each frame then submits a small hand-off command buffer, the compute
+// work, and the scene.
+//
+// --validation runs under VK_LAYER_KHRONOS_validation (when the loader finds
+// it) and stops at the first error; the validate_konstrukt_scenes target runs
+// every scene that way for a few frames. Timings from such a run are not
+// representative.
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "BenchScenes.hpp"
+#include "HeadlessContext.hpp"
+#include "MetricsReport.hpp"
+#include "VulkanBackend/VulkanCore/AsyncCompute.hpp"
+#include "VulkanBackend/VulkanCore/QueueTimer.hpp"
+#include "VulkanBackend/VulkanCore/SubmissionThread.hpp"
+#include "VulkanBackend/VulkanCore/Texture.hpp"
+
+namespace {
+  using kst::bench::HeadlessContext;
+  using Clock = std::chrono::steady_clock;
+
+  constexpr uint32_t kFramesInFlight = 2;
+
+  struct Options {
+    std::vector<std::string> scenes;
+    std::string json;
+    uint32_t frames       = 300;
+    uint32_t warmup       = 30;
+    VkExtent2D extent     = {1920, 1080};
+    bool list             = false;
+    bool submissionThread = false;
+    bool asyncCompute     = false;
+    bool validation       = false;
+  };
+
+  struct SceneResult {
+    std::string name;
+    std::vector<double> cpuMs;
+    std::vector<double> gpuMs;
+    // --async-compute only
+    std::vector<double> computeMs;
+    std::vector<double> graphicsMs;
+    double setupMs         = 0.0;
+    uint64_t peakVramBytes = 0;
+  };
+
+  void printUsage(const char* argv0) {
+    std::fprintf(
+        stderr,
+        "usage: %s [--scene <name>]... [--frames N] [--warmup N] [--size WxH] [--json <path>] "
+        "[--submission-thread] [--async-compute] [--validation] [--list]\n",
+        argv0
+    );
+  }
+
+  auto parseOptions(int argc, char** argv, Options& options) -> bool {
+    for (int i = 1; i < argc; ++i) {
+      const std::string arg = argv[i];
+      if (arg == "--scene" && i + 1 < argc) {
+        options.scenes.emplace_back(argv[++i]);
+      } else if (arg == "--frames" && i + 1 < argc) {
+        options.frames = static_cast<uint32_t>(std::max(1, std::atoi(argv[++i])));
+      } else if (arg == "--warmup" && i + 1 < argc) {
+        options.warmup = static_cast<uint32_t>(std::max(0, std::atoi(argv[++i])));
+      } else if (arg == "--size" && i + 1 < argc) {
+        unsigned width = 0, height = 0;
+        if (std::sscanf(argv[++i], "%ux%u", &width, &height) != 2 || width == 0 || height == 0) {
+          return false;
+        }
+        options.extent = {width, height};
+      } else if (arg == "--json" && i + 1 < argc) {
+        options.json = argv[++i];
+      } else if (arg == "--submission-thread") {
+        options.submissionThread = true;
+      } else if (arg == "--async-compute") {
+        options.asyncCompute = true;
+      } else if (arg == "--validation") {
+        options.validation = true;
+      } else if (arg == "--list") {
+        options.list = true;
+      } else {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  auto elapsedMs(Clock::time_point start) -> double {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+  }
+
+  // VMA's view of device-local heap usage; driver-reported when the allocator
+  // was created with VK_EXT_memory_budget, otherwise VMA's own block bytes
+  auto deviceLocalUsage(VmaAllocator allocator) -> uint64_t {
+    const VkPhysicalDeviceMemoryProperties* memoryProperties = nullptr;
+    vmaGetMemoryProperties(allocator, &memoryProperties);
+
+    std::array<VmaBudget, VK_MAX_MEMORY_HEAPS> budgets = {};
+    vmaGetHeapBudgets(allocator, budgets.data());
+
+    uint64_t usage = 0;
+    for (uint32_t heap = 0; heap < memoryProperties->memoryHeapCount; ++heap) {
+      if (memoryProperties->memoryHeaps[heap].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT) {
+        usage += budgets[heap].usage;
+      }
+    }
+    return usage;
+  }
+
+  auto createTargets(HeadlessContext& bench, VkExtent2D extent) -> kst::bench::SceneTargets {
+    kst::bench::SceneTargets targets = {.extent = extent};
+
+    targets.color = bench.context().createTexture(
+        VK_IMAGE_TYPE_2D,
+        VK_FORMAT_R16G16B16A16_SFLOAT,
+        0,
+        VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT,
+        {extent.width, extent.height, 1},
+        1,
+        1,
+        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+        false,
+        VK_SAMPLE_COUNT_1_BIT,
+        "Scene color"
+    );
+    targets.depth = bench.context().createTexture(
+        VK_IMAGE_TYPE_2D,
+        VK_FORMAT_D32_SFLOAT,
+        0,
+        VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT,
+        {extent.width, extent.height, 1},
+        1,
+        1,
+        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+        false,
+        VK_SAMPLE_COUNT_1_BIT,
+        "Scene depth"
+    );
+
+    auto commandBuffer = bench.queue().getCmdBufferToBegin();
+    targets.color->transitionImageLayout(commandBuffer, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL);
+    targets.depth->transitionImageLayout(
+        commandBuffer, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL
+    );
+    bench.submitAndWait(commandBuffer);
+    return targets;
+  }
+
+  // Every frame rewrites the same targets and buffers as the one before it
+  void frameBarrier(VkCommandBuffer commandBuffer) {
+    const VkMemoryBarrier barrier = {
+        .sType         = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+        .srcAccessMask = VK_ACCESS_MEMORY_WRITE_BIT,
+        .dstAccessMask = VK_ACCESS_MEMORY_READ_BIT | VK_ACCESS_MEMORY_WRITE_BIT,
+    };
+    vkCmdPipelineBarrier(
+        commandBuffer,
+        VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
+        VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
+        0,
+        1,
+        &barrier,
+        0,
+        nullptr,
+        0,
+        nullptr
+    );
+  }
+
+  auto runScene(HeadlessContext& bench, const std::string& name, const Options& options)
+      -> SceneResult {
+    auto& context      = bench.context();
+    SceneResult result = {.name = name};
+
+    const auto setupStart = Clock::now();
+    auto targets          = createTargets(bench, options.extent);
+    auto scene            = kst::bench::createBenchScene(name);
+    scene->setup(bench, targets, kFramesInFlight);
+    result.setupMs       = elapsedMs(setupStart);
+    result.peakVramBytes = deviceLocalUsage(context.memoryAllocator());
+
+    // The async hand-off adds a second graphics submit per frame
+    const uint32_t submitsPerFrame = options.asyncCompute ? 2 : 1;
+    auto queue                     = std::make_unique<VulkanCore::CommandQueueManager>(
+        context.createGraphicsCommandQueue(
+            submitsPerFrame * kFramesInFlight, submitsPerFrame * kFramesInFlight, "konstrukt_scenes"
+        )
+    );
+
+    std::unique_ptr<kst::bench::BenchScene> asyncScene;
+    std::unique_ptr<VulkanCore::CommandQueueManager> computeQueue;
+    std::unique_ptr<VulkanCore::AsyncComputeScheduler> scheduler;
+    std::unique_ptr<VulkanCore::QueueTimer> graphicsTimer;
+    std::vector<VulkanCore::AsyncBufferUse> asyncBuffers;
+    if (options.asyncCompute) {
+      asyncScene = kst::bench::createBenchScene("heavy-compute");
+      asyncScene->setup(bench, targets, kFramesInFlight);
+      // Graphics never touches these; waiting at the bottom of the pipe keeps
+      // the scene's commands from blocking on the compute queue
+      for (const auto& buffer : asyncScene->persistentBuffers()) {
+        asyncBuffers.push_back({
+            .buffer         = buffer,
+            .graphicsStage  = VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+            .graphicsAccess = 0,
+        });
+      }
+
+      computeQueue = std::make_unique<VulkanCore::CommandQueueManager>(
+          context.createComputeCommandQueue(kFramesInFlight, kFramesInFlight, "Async compute")
+      );
+      scheduler = std::make_unique<VulkanCore::AsyncComputeScheduler>(
+          context, *queue, *computeQueue, kFramesInFlight, "compute"
+      );
+      graphicsTimer = std::make_unique<VulkanCore::QueueTimer>(
+          context, queue->queueFamilyIndex(), kFramesInFlight, "graphics"
+      );
+    }
+    // Both timers advance once per frame, so their last intervals belong to
+    // the same frame
+    const auto collectQueueTimes = [&](uint32_t frame) {
+      const auto graphics = graphicsTimer->nextFrame();
+      const auto& compute = scheduler->computeTimer().lastInterval();
+      if (frame >= options.warmup + kFramesInFlight && graphics && compute) {
+        result.computeMs.push_back(compute->milliseconds());
+        result.graphicsMs.push_back(graphics->milliseconds());
+      }
+    };
+
+    VkQueryPool queryPool                     = VK_NULL_HANDLE;
+    const VkQueryPoolCreateInfo queryPoolInfo = {
+        .sType      = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO,
+        .queryType  = VK_QUERY_TYPE_TIMESTAMP,
+        .queryCount = 2 * kFramesInFlight,
+    };
+    VK_CHECK(vkCreateQueryPool(context.device(), &queryPoolInfo, nullptr, &queryPool));
+    const double timestampPeriod =
+        context.physicalDevice().properties().properties.limits.timestampPeriod;
+
+    // Frame whose timestamps each slot holds, -1 once read
+    std::array<int64_t, kFramesInFlight> pending;
+    pending.fill(-1);
+    const auto collectGpuTime = [&](uint32_t slot) {
+      if (pending[slot] >= static_cast<int64_t>(options.warmup)) {
+        std::array<uint64_t, 2> timestamps = {};
+        VK_CHECK(vkGetQueryPoolResults(
+            context.device(),
+            queryPool,
+            2 * slot,
+            2,
+            sizeof(timestamps),
+            timestamps.data(),
+            sizeof(uint64_t),
+            VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WAIT_BIT
+        ));
+        result.gpuMs.push_back(double(timestamps[1] - timestamps[0]) * timestampPeriod * 1e-6);
+      }
+      pending[slot] = -1;
+    };
+
+    const uint32_t frameCount = options.warmup + options.frames;
+    for (uint32_t frame = 0; frame < frameCount; ++frame) {
+      const uint32_t slot  = frame % kFramesInFlight;
+      const uint32_t query = 2 * slot;
+      const auto start     = Clock::now();
+
+      if (scheduler) {
+        scheduler->enqueue({
+            .name    = "heavy-compute",
+            .buffers = asyncBuffers,
+            .record =
+                [&](VkCommandBuffer computeCommandBuffer) {
+                  frameBarrier(computeCommandBuffer);
+                  asyncScene->record(computeCommandBuffer, slot, frame);
+                },
+        });
+
+        auto handOff                = queue->getCmdBufferToBegin();
+        const VkSemaphore toCompute = scheduler->releaseToCompute(handOff);
+        queue->endCmdBuffer(handOff);
+        const VkSubmitInfo handOffInfo = {
+            .sType                = VK_STRUCTURE_TYPE_SUBMIT_INFO,
+            .commandBufferCount   = 1,
+            .pCommandBuffers      = &handOff,
+            .signalSemaphoreCount = 1,
+            .pSignalSemaphores    = &toCompute,
+        };
+        queue->submit(&handOffInfo);
+        queue->goToNextCmdBuffer();
+        scheduler->submit();
+      }
+
+      // Blocks until the slot's previous frame retired, so its queries are ready
+      auto commandBuffer = queue->getCmdBufferToBegin();
+      collectGpuTime(slot);
+
+      VulkanCore::AsyncComputeWait asyncWait;
+      if (scheduler) {
+        asyncWait = scheduler->acquireFromCompute(commandBuffer);
+        collectQueueTimes(frame);
+        graphicsTimer->writeBegin(commandBuffer);
+      }
+
+      frameBarrier(commandBuffer);
+      vkCmdResetQueryPool(commandBuffer, queryPool, query, 2);
+      vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, queryPool, query);
+      scene->record(commandBuffer, slot, frame);
+      vkCmdWriteTimestamp(
+          commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, queryPool, query + 1
+      );
+      if (graphicsTimer) {
+        graphicsTimer->writeEnd(commandBuffer);
+      }
+      queue->endCmdBuffer(commandBuffer);
+
+      const bool waitsOnCompute     = asyncWait.semaphore != VK_NULL_HANDLE;
+      const VkSubmitInfo submitInfo = {
+          .sType              = VK_STRUCTURE_TYPE_SUBMIT_INFO,
+          .waitSemaphoreCount = waitsOnCompute ? 1u : 0u,
+          .pWaitSemaphores    = waitsOnCompute ? &asyncWait.semaphore : nullptr,
+          .pWaitDstStageMask  = waitsOnCompute ? &asyncWait.stage : nullptr,
+          .commandBufferCount = 1,
+          .pCommandBuffers    = &commandBuffer,
+      };
+      queue->submit(&submitInfo);
+      queue->goToNextCmdBuffer();
+      pending[slot] = frame;
+
+      if (frame >= options.warmup) {
+        result.cpuMs.push_back(elapsedMs(start));
+      }
+      result.peakVramBytes =
+          std::max(result.peakVramBytes, deviceLocalUsage(context.memoryAllocator()));
+    }
+
+    if (auto* submissionThread = context.submissionThread()) {
+      submissionThread->waitIdle();
+    }
+    VK_CHECK(vkDeviceWaitIdle(context.device()));
+    for (uint32_t slot = 0; slot < kFramesInFlight; ++slot) {
+      collectGpuTime(slot);
+      if (scheduler) {
+        scheduler->computeTimer().nextFrame();
+        collectQueueTimes(frameCount + slot);
+      }
+    }
+    vkDestroyQueryPool(context.device(), queryPool, nullptr);
+
+    graphicsTimer.reset();
+    scheduler.reset();
+    computeQueue.reset();
+    asyncScene.reset();
+    queue.reset();
+    scene.reset();
+    targets = {};
+    context.deletionQueue().collect();
+    return result;
+  }
+} // namespace
+
+auto main(int argc, char** argv) -> int {
+  Options options;
+  if (!parseOptions(argc, argv, options)) {
+    printUsage(argv[0]);
+    return 2;
+  }
+
+  const auto& names = kst::bench::benchSceneNames();
+  if (options.list) {
+    for (const auto& name : names) {
+      std::printf("%s\n", name.c_str());
+    }
+    return 0;
+  }
+  if (options.scenes.empty()) {
+    options.scenes = names;
+  }
+  for (const auto& scene : options.scenes) {
+    if (std::find(names.begin(), names.end(), scene) == names.end()) {
+      std::fprintf(stderr, "unknown scene %s (see --list)\n", scene.c_str());
+      return 2;
+    }
+  }
+
+  // Same feature set the renderer's VulkanContext enables, plus multi-draw
+  // indirect for DeviceGeneratedDraws' fallback and clip distances for the
+  // terrain scene
+  VulkanCore::Context::enableDefaultFeatures();
+  VulkanCore::Context::enableScalarLayoutFeatures();
+  VulkanCore::Context::enableBufferDeviceAddressFeature();
+  VulkanCore::Context::enableDynamicRenderingFeature();
+  VulkanCore::Context::enableSynchronization2Feature();
+  VulkanCore::Context::enableIndirectRenderingFeature();
+  VulkanCore::Context::enableDeviceGeneratedCommandsFeature();
+  VulkanCore::Context::enableClipDistanceFeature();
+
+  if (options.validation) {
+    HeadlessContext::requestValidation();
+  }
+  auto& bench = HeadlessContext::get();
+  if (options.submissionThread) {
+    bench.context().startSubmissionThread();
+  }
+
+  using kst::bench::Metric;
+  using kst::bench::percentile;
+  std::vector<Metric> metrics;
+  for (const auto& name : options.scenes) {
+    const auto result = runScene(bench, name, options);
+    const double vramMb = static_cast<double>(result.peakVramBytes) / (1024.0 * 1024.0);
+
+    std::printf(
+        "%-14s %u frames %ux%u: cpu p50 %.3f / p95 %.3f / p99 %.3f ms, "
+        "gpu p50 %.3f / p95 %.3f / p99 %.3f ms, peak vram %.1f MB, setup %.1f ms\n",
+        name.c_str(),
+        options.frames,
+        options.extent.width,
+        options.extent.height,
+        percentile(result.cpuMs, 50),
+        percentile(result.cpuMs, 95),
+        percentile(result.cpuMs, 99),
+        percentile(result.gpuMs, 50),
+        percentile(result.gpuMs, 95),
+        percentile(result.gpuMs, 99),
+        vramMb,
+        result.setupMs
+    );
+
+    for (const double p : {50.0, 95.0, 99.0}) {
+      const auto suffix = "_p" + std::to_string(static_cast<int>(p));
+      metrics.push_back({name + "/cpu_frame" + suffix, percentile(result.cpuMs, p), "ms"});
+      metrics.push_back({name + "/gpu_frame" + suffix, percentile(result.gpuMs, p), "ms"});
+    }
+    metrics.push_back({name + "/peak_vram", vramMb, "MB"});
+
+    if (options.asyncCompute) {
+      const double computeMs = percentile(result.computeMs, 50);
+      const double graphicsMs = percentile(result.graphicsMs, 50);
+      std::printf(
+          "%-14s async heavy-compute: compute queue p50 %.3f ms, graphics queue p50 %.3f ms\n",
+          "",
+          computeMs,
+          graphicsMs
+      );
+      metrics.push_back({name + "/async_compute_p50", computeMs, "ms"});
+      metrics.push_back({name + "/async_graphics_p50", graphicsMs, "ms"});
+    }
+  }
+
+  if (!options.json.empty() && !kst::bench::writeMetricsJson(options.json, metrics)) {
+    std::fprintf(stderr, "failed to write %s\n", options.json.c_str());
+    return 1;
+  }
+  return 0;
+}
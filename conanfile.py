@@ -37,3 +37,6 @@ class Konstrukt(ConanFile):
 
         # Unit Tests
         self.requires("gtest/1.16.0")
+
+        # Benchmarks
+        self.requires("benchmark/1.9.1")
@@ -1,75 +1,204 @@
+#include <cstdlib>
 #include <exception>
+#include <memory>
 #include <string>
 
 #define GLFW_INCLUDE_VULKAN
 #include <GLFW/glfw3.h>
 
+#include "core/CVar.hpp"
 #include "core/Logger.hpp"
+#include "core/MemoryTracker.hpp"
+#include "core/Metrics.hpp"
+#include "core/Startup.hpp"
 #include "renderer/RHI/GraphicsContext.hpp"
 
-auto main() -> int {
-  kst::core::Logger::init();
-
-  try {
-    if (!glfwInit()) {
-      KST_ERROR("Failed to initialize GLFW");
-      return -1;
-    }
-
-    glfwWindowHint(GLFW_CLIENT_API, GLFW_NO_API);
+namespace {
+  // Owns everything allocated while running, so all of it is destroyed on
+  // every exit path before main() reports leaks
+  auto run() -> int {
+    // Independent stages run concurrently; GLFW window calls stay on this thread.
+    // KST_STARTUP_TRACE writes the timeline as a Chrome trace, KST_SERIAL_STARTUP
+    // runs every stage on this thread for comparison.
+    kst::core::StartupGraph startup;
+
+    // KST_METRICS_FILE and/or KST_METRICS_SOCKET publish runtime metrics in the
+    // Prometheus text format for the lifetime of the process
+    std::unique_ptr<kst::core::MetricsExporter> metricsExporter;
+    startup.add("metrics", {}, [&] {
+      kst::core::MetricsExportOptions exportOptions;
+      if (const char* file = std::getenv("KST_METRICS_FILE")) {
+        exportOptions.file = file;
+      }
+      if (const char* socket = std::getenv("KST_METRICS_SOCKET")) {
+        exportOptions.socketPath = socket;
+      }
+      if (!exportOptions.file.empty() || !exportOptions.socketPath.empty()) {
+        auto exporter = kst::core::MetricsExporter::start(std::move(exportOptions));
+        if (exporter.hasError()) {
+          KST_WARN("Metrics export disabled: {}", exporter.error());
+        } else {
+          metricsExporter = std::move(exporter.value());
+        }
+      }
+      return kst::core::Result<void>::success();
+    });
+
+    // KST_CONFIG_FILE is a cvar file reloaded whenever it changes; KST_CVAR_SOCKET
+    // serves a console to get and set cvars while running
+    std::unique_ptr<kst::core::CVarServer> cvarServer;
+    startup.add("cvars", {}, [&] {
+      kst::core::CVarServerOptions serverOptions;
+      if (const char* file = std::getenv("KST_CONFIG_FILE")) {
+        serverOptions.configFile = file;
+      }
+      if (const char* socket = std::getenv("KST_CVAR_SOCKET")) {
+        serverOptions.socketPath = socket;
+      }
+      if (!serverOptions.configFile.empty() || !serverOptions.socketPath.empty()) {
+        auto server = kst::core::CVarServer::start(std::move(serverOptions));
+        if (server.hasError()) {
+          KST_WARN("CVar server disabled: {}", server.error());
+        } else {
+          cvarServer = std::move(server.value());
+        }
+      }
+      return kst::core::Result<void>::success();
+    });
 
     const uint32_t WIDTH  = 800;
     const uint32_t HEIGHT = 600;
-    GLFWwindow* window    = glfwCreateWindow(WIDTH, HEIGHT, "Konstrukt Engine", nullptr, nullptr);
-
-    if (!window) {
-      KST_ERROR("Failed to create GLFW window");
-      glfwTerminate();
-      return -1;
-    }
-
-    // Configure and create rendering context with window handle
-    kst::renderer::ContextOptions options;
-    options.enableValidation  = true;
-    options.printEnumerations = true;
-    options.window            = window;
-    options.width             = WIDTH;
-    options.height            = HEIGHT;
-
-    auto context = kst::renderer::GraphicsContext::create("vulkan", options);
-
-    if (!context) {
-      KST_ERROR("Failed to create rendering context");
+    GLFWwindow* window    = nullptr;
+    bool glfwInitialized  = false;
+    std::shared_ptr<kst::renderer::GraphicsContext> context;
+
+    startup.add(
+        "glfw",
+        {},
+        [&] {
+          if (!glfwInit()) {
+            return kst::core::Result<void>::error("Failed to initialize GLFW");
+          }
+          glfwInitialized = true;
+          return kst::core::Result<void>::success();
+        },
+        kst::core::StartupThread::Main
+    );
+
+    startup.add(
+        "window",
+        {"glfw"},
+        [&] {
+          glfwWindowHint(GLFW_CLIENT_API, GLFW_NO_API);
+          window = glfwCreateWindow(WIDTH, HEIGHT, "Konstrukt Engine", nullptr, nullptr);
+          if (!window) {
+            return kst::core::Result<void>::error("Failed to create GLFW window");
+          }
+          return kst::core::Result<void>::success();
+        },
+        kst::core::StartupThread::Main
+    );
+
+    // Loading the Vulkan loader and scanning drivers and layers doesn't need the window
+    startup.add("vulkan-loader", {}, [] {
+      kst::renderer::GraphicsContext::preload("vulkan");
+      return kst::core::Result<void>::success();
+    });
+
+    // After the config file so its cvars apply to device creation
+    startup.add("context", {"window", "vulkan-loader", "cvars"}, [&] {
+      // Configure and create rendering context with window handle
+      kst::renderer::ContextOptions options;
+      options.enableValidation  = true;
+      options.printEnumerations = true;
+      options.window            = window;
+      options.width             = WIDTH;
+      options.height            = HEIGHT;
+      // KST_SUBMISSION_THREAD moves vkQueueSubmit/vkQueuePresentKHR off the main thread
+      options.submissionThread = std::getenv("KST_SUBMISSION_THREAD") != nullptr;
+
+      context = kst::renderer::GraphicsContext::create("vulkan", options);
+      if (!context) {
+        return kst::core::Result<void>::error("Failed to create rendering context");
+      }
+      return kst::core::Result<void>::success();
+    });
+
+    startup.add("surface", {"context"}, [&] {
+      kst::renderer::SurfaceDescriptor surfaceDesc;
+      surfaceDesc.nativeWindowHandle = window;
+      surfaceDesc.width              = WIDTH;
+      surfaceDesc.height             = HEIGHT;
+
+      if (!context->createSurface(surfaceDesc)) {
+        return kst::core::Result<void>::error("Failed to create surface and swapchain");
+      }
+      return kst::core::Result<void>::success();
+    });
+
+    try {
+      KST_MEMORY_SCOPE(App);
+
+      const auto started = startup.run(
+          std::getenv("KST_SERIAL_STARTUP") ? 0 : kst::core::StartupGraph::kAutoWorkers
+      );
+      startup.timeline().log();
+      if (const char* trace = std::getenv("KST_STARTUP_TRACE")) {
+        auto written = startup.timeline().writeChromeTrace(trace);
+        if (written.hasError()) {
+          KST_WARN("{}", written.error());
+        }
+      }
+
+      if (started.hasError()) {
+        KST_ERROR("Startup failed: {}", started.error());
+        context.reset();
+        if (window) {
+          glfwDestroyWindow(window);
+        }
+        if (glfwInitialized) {
+          glfwTerminate();
+        }
+        return -1;
+      }
+
+      KST_INFO("Created {} rendering context with a surface", context->getImplementationName());
+      kst::core::CVarRegistry::instance().beginRuntime();
+
+      while (!glfwWindowShouldClose(window)) {
+        glfwPollEvents();
+        kst::core::MemoryTracker::endFrame();
+      }
+
+      context->waitIdle();
+      context.reset();
       glfwDestroyWindow(window);
       glfwTerminate();
-      return -1;
-    }
 
-    kst::renderer::SurfaceDescriptor surfaceDesc;
-    surfaceDesc.nativeWindowHandle = window;
-    surfaceDesc.width              = WIDTH;
-    surfaceDesc.height             = HEIGHT;
-
-    if (!context->createSurface(surfaceDesc)) {
-      KST_ERROR("Failed to create surface and swapchain");
-      glfwDestroyWindow(window);
+    } catch (const std::exception& e) {
+      KST_ERROR("Unhandled exception: {}", e.what());
+      context.reset();
       glfwTerminate();
       return -1;
     }
+    return 0;
+  }
+} // namespace
 
-    KST_INFO("Created {} rendering context with a surface", context->getImplementationName());
-
-    while (!glfwWindowShouldClose(window)) {
-      glfwPollEvents();
-    }
+auto main(int argc, char** argv) -> int {
+  // Before the logger so +log.level=... applies to its first message
+  auto& cvars     = kst::core::CVarRegistry::instance();
+  const auto args = cvars.applyCommandLine(argc, argv);
+  kst::core::Logger::init();
+  if (args.hasError()) {
+    KST_WARN("Bad command line cvar: {}", args.error());
+  }
 
-    context->waitIdle();
-    glfwDestroyWindow(window);
-    glfwTerminate();
+  const int status = run();
 
-  } catch (const std::exception& e) {
-    KST_ERROR("Unhandled exception: {}", e.what());
-    glfwTerminate();
-  }
-  return 0;
+  // The logger goes last so teardown is still logged; after it nothing
+  // tagged should be alive
+  kst::core::Logger::shutdown();
+  kst::core::MemoryTracker::reportLeaks();
+  return status;
 }
@@ -0,0 +1,287 @@
+#!/usr/bin/env python3
+"""Performance regression harness.
+
+Runs every benchmark / replay suite several times, reduces each metric to a
+median and a median absolute deviation (MAD) and compares the result against
+a stored baseline. Exits non-zero with a per-metric report when something
+regressed past its threshold. Baselines are machine-specific and none is
+checked in; without one the comparison is skipped with a warning.
+
+Two kinds of suites are understood:
+
+  --benchmark EXE     Google Benchmark executables (konstrukt_bench). Every
+                      non-aggregate entry contributes "<exe>/<name>" in ns.
+  --suite CMD         Any command that accepts "--json <path>" and writes
+                      {"metrics": [{"name", "value", "unit", "better"}]}
+                      (konstrukt_replay, konstrukt_scenes).
+
+A metric regresses when its median moved in the bad direction by more than
+its relative threshold *and* by more than --mad-factor times the combined MAD
+of baseline and current runs, so noisy metrics need a real shift to fail.
+
+Typical use, from the build directory (see the perf_regression and
+perf_baseline targets in benchmarks/CMakeLists.txt):
+
+  perf-regression.py --benchmark ./benchmarks/konstrukt_bench \\
+      --baseline ../benchmarks/baselines/lavapipe.json --update-baseline
+  perf-regression.py --benchmark ./benchmarks/konstrukt_bench \\
+      --baseline ../benchmarks/baselines/lavapipe.json
+"""
+
+import argparse
+import json
+import os
+import shlex
+import statistics
+import subprocess
+import sys
+import tempfile
+
+BASELINE_VERSION = 1
+
+USE_COLOR = sys.stdout.isatty()
+
+
+def color(code, text):
+    return f"\033[{code}m{text}\033[0m" if USE_COLOR else text
+
+
+def print_status(message):
+    print(f"{color('1;32', '[PERF]')} {message}")
+
+
+def print_warning(message):
+    print(f"{color('1;33', '[WARNING]')} {message}")
+
+
+def print_error(message):
+    print(f"{color('1;31', '[ERROR]')} {message}", file=sys.stderr)
+
+
+def median_and_mad(samples):
+    median = statistics.median(samples)
+    mad = statistics.median(abs(s - median) for s in samples)
+    return median, mad
+
+
+def run_checked(command, env):
+    result = subprocess.run(command, env=env, stdout=subprocess.PIPE,
+                            stderr=subprocess.STDOUT, text=True)
+    if result.returncode != 0:
+        print_error(f"'{shlex.join(command)}' exited with {result.returncode}")
+        print(result.stdout, file=sys.stderr)
+        sys.exit(2)
+
+
+def run_google_benchmark(executable, extra_args, env, samples):
+    """One process launch; appends real_time (ns) of every benchmark."""
+    suite = os.path.basename(executable)
+    with tempfile.TemporaryDirectory() as tmp:
+        out = os.path.join(tmp, "bench.json")
+        run_checked([executable, f"--benchmark_out={out}",
+                     "--benchmark_out_format=json", *extra_args], env)
+        with open(out) as f:
+            report = json.load(f)
+
+    scale = {"ns": 1.0, "us": 1e3, "ms": 1e6, "s": 1e9}
+    for entry in report.get("benchmarks", []):
+        if entry.get("run_type") == "aggregate" or entry.get("error_occurred"):
+            continue
+        name = f"{suite}/{entry['name']}"
+        value = entry["real_time"] * scale[entry.get("time_unit", "ns")]
+        metric = samples.setdefault(name, {"unit": "ns", "better": "lower", "values": []})
+        metric["values"].append(value)
+
+
+def run_metrics_suite(command, env, samples):
+    """One process launch of a konstrukt metrics producer."""
+    argv = shlex.split(command)
+    suite = os.path.basename(argv[0])
+    with tempfile.TemporaryDirectory() as tmp:
+        out = os.path.join(tmp, "metrics.json")
+        run_checked([*argv, "--json", out], env)
+        with open(out) as f:
+            report = json.load(f)
+
+    for entry in report.get("metrics", []):
+        name = f"{suite}/{entry['name']}"
+        metric = samples.setdefault(name, {
+            "unit": entry.get("unit", ""),
+            "better": entry.get("better", "lower"),
+            "values": [],
+        })
+        metric["values"].append(float(entry["value"]))
+
+
+def collect(args, env):
+    samples = {}
+    for run in range(args.runs):
+        print_status(f"run {run + 1}/{args.runs}")
+        for executable in args.benchmark:
+            run_google_benchmark(executable, args.benchmark_args, env, samples)
+        for command in args.suite:
+            run_metrics_suite(command, env, samples)
+
+    metrics = {}
+    for name, metric in sorted(samples.items()):
+        median, mad = median_and_mad(metric["values"])
+        metrics[name] = {
+            "median": median,
+            "mad": mad,
+            "unit": metric["unit"],
+            "better": metric["better"],
+            "runs": len(metric["values"]),
+        }
+    return metrics
+
+
+def compare(baseline, current, default_threshold, mad_factor):
+    """Returns (rows, regressions, missing) for the report."""
+    rows, regressions, missing = [], [], []
+    for name, base in sorted(baseline["metrics"].items()):
+        if name not in current:
+            missing.append(name)
+            continue
+        now = current[name]
+        threshold = base.get("threshold", default_threshold)
+
+        if base.get("better", "lower") == "higher":
+            delta = base["median"] - now["median"]
+        else:
+            delta = now["median"] - base["median"]
+        relative = delta / base["median"] if base["median"] else 0.0
+        noise = mad_factor * (base["mad"] + now["mad"])
+
+        if relative > threshold and delta > noise:
+            status = "REGRESSED"
+            regressions.append(name)
+        elif relative < -threshold and -delta > noise:
+            status = "improved"
+        else:
+            status = "ok"
+        rows.append((name, base, now, relative, threshold, status))
+    return rows, regressions, missing
+
+
+def format_value(value, unit):
+    if unit == "ns":
+        for scale, suffix in ((1e9, "s"), (1e6, "ms"), (1e3, "us")):
+            if abs(value) >= scale:
+                return f"{value / scale:.3f} {suffix}"
+        return f"{value:.1f} ns"
+    return f"{value:.3f} {unit}".rstrip()
+
+
+def print_report(rows, regressions, missing, new_metrics, verbose):
+    width = max([len(row[0]) for row in rows] + [len("metric")])
+    header = f"{'metric':<{width}}  {'baseline':>14}  {'current':>14}  {'change':>8}  {'limit':>6}  status"
+    print(header)
+    print("-" * len(header))
+    for name, base, now, relative, threshold, status in rows:
+        if status == "ok" and not verbose:
+            continue
+        line = (f"{name:<{width}}  "
+                f"{format_value(base['median'], base['unit']):>14}  "
+                f"{format_value(now['median'], now['unit']):>14}  "
+                f"{relative:>+7.1%}  {threshold:>6.0%}  {status}")
+        if status == "REGRESSED":
+            line = color("1;31", line)
+            line += (f"\n{'':<{width}}  mad {format_value(base['mad'], base['unit'])}"
+                     f" -> {format_value(now['mad'], now['unit'])}")
+        elif status == "improved":
+            line = color("1;32", line)
+        print(line)
+
+    for name in missing:
+        print_warning(f"{name}: in baseline but not produced by this run")
+    for name in new_metrics:
+        print_warning(f"{name}: not in baseline (run with --update-baseline to track it)")
+
+    checked = len(rows)
+    if regressions:
+        print_error(f"{len(regressions)} of {checked} metrics regressed")
+    else:
+        print_status(f"{checked} metrics within thresholds")
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--benchmark", action="append", default=[],
+                        help="Google Benchmark executable (repeatable)")
+    parser.add_argument("--benchmark-args", default="",
+                        help="extra arguments for every --benchmark, e.g. --benchmark_filter=BM_Buffer")
+    parser.add_argument("--suite", action="append", default=[],
+                        help="command writing konstrukt metrics JSON to --json <path> (repeatable)")
+    parser.add_argument("--baseline", required=True, help="baseline JSON file")
+    parser.add_argument("--runs", type=int, default=5, help="process launches per suite")
+    parser.add_argument("--threshold", type=float, default=0.10,
+                        help="default allowed relative regression (0.10 = 10%%)")
+    parser.add_argument("--mad-factor", type=float, default=3.0,
+                        help="a regression must also exceed this many combined MADs")
+    parser.add_argument("--icd", default="",
+                        help="Vulkan ICD manifest to force, e.g. lavapipe's lvp_icd.x86_64.json")
+    parser.add_argument("--update-baseline", action="store_true",
+                        help="write the measured medians as the new baseline instead of comparing")
+    parser.add_argument("--output", default="", help="also write the current results to this file")
+    parser.add_argument("--verbose", action="store_true", help="list metrics that are within limits")
+    args = parser.parse_args()
+    args.benchmark_args = shlex.split(args.benchmark_args)
+
+    if not args.benchmark and not args.suite:
+        parser.error("nothing to run: pass at least one --benchmark or --suite")
+    if args.runs < 3:
+        parser.error("--runs must be at least 3 for the MAD to mean anything")
+
+    # No baseline is checked in for a machine until someone records one there,
+    # so a fresh checkout skips the comparison instead of failing it
+    if not args.update_baseline and not os.path.exists(args.baseline):
+        print_warning(f"no baseline at {args.baseline}, skipping the regression check; "
+                      "record one on this machine with --update-baseline (perf_baseline target)")
+        return 0
+
+    env = dict(os.environ)
+    if args.icd:
+        env["VK_DRIVER_FILES"] = args.icd
+        env["VK_ICD_FILENAMES"] = args.icd
+
+    current = collect(args, env)
+
+    if args.output:
+        with open(args.output, "w") as f:
+            json.dump({"version": BASELINE_VERSION, "metrics": current}, f, indent=2)
+
+    if args.update_baseline:
+        # Keep hand-tuned per-metric thresholds across baseline refreshes
+        thresholds = {}
+        if os.path.exists(args.baseline):
+            with open(args.baseline) as f:
+                for name, metric in json.load(f).get("metrics", {}).items():
+                    if "threshold" in metric:
+                        thresholds[name] = metric["threshold"]
+        for name, threshold in thresholds.items():
+            if name in current:
+                current[name]["threshold"] = threshold
+
+        os.makedirs(os.path.dirname(os.path.abspath(args.baseline)), exist_ok=True)
+        with open(args.baseline, "w") as f:
+            json.dump({"version": BASELINE_VERSION, "metrics": current}, f, indent=2)
+            f.write("\n")
+        print_status(f"wrote {len(current)} metrics to {args.baseline}")
+        return 0
+
+    with open(args.baseline) as f:
+        baseline = json.load(f)
+    if baseline.get("version") != BASELINE_VERSION:
+        print_error(f"{args.baseline} has version {baseline.get('version')}, "
+                    f"expected {BASELINE_VERSION}; regenerate it with --update-baseline")
+        return 2
+
+    rows, regressions, missing = compare(baseline, current, args.threshold, args.mad_factor)
+    new_metrics = sorted(set(current) - set(baseline["metrics"]))
+    print_report(rows, regressions, missing, new_metrics, args.verbose)
+    return 1 if regressions else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
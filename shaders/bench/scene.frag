@@ -0,0 +1,36 @@
+#version 460
+#extension GL_GOOGLE_include_directive : require
+#extension GL_EXT_nonuniform_qualifier : require
+
+// Brute-force forward shading: every fragment loops over all lights, so the
+// many-lights scene scales with light count times covered pixels.
+
+#include "bench/scene.glsl"
+
+layout(location = 0) in vec3 inWorld;
+layout(location = 1) in vec3 inNormal;
+layout(location = 2) in vec2 inUV;
+layout(location = 3) in vec4 inColor;
+
+layout(location = 0) out vec4 outColor;
+
+void main() {
+  // The index is uniform per draw; nonuniformEXT only selects the descriptor
+  // indexing capability Context::enableDefaultFeatures() turns on.
+  const vec3 albedo = texture(textures[nonuniformEXT(draw.textureIndex)], inUV).rgb * inColor.rgb;
+  const vec3 normal = normalize(inNormal);
+
+  vec3 color = albedo * 0.03;
+  for (uint i = 0; i < scene.counts.x; ++i) {
+    const vec3 toLight   = lights[i].positionRadius.xyz - inWorld;
+    const float distSq   = dot(toLight, toLight);
+    const float radiusSq = lights[i].positionRadius.w * lights[i].positionRadius.w;
+    if (distSq >= radiusSq) {
+      continue;
+    }
+    const float falloff = 1.0 - distSq / radiusSq;
+    const float lambert = max(dot(normal, toLight * inversesqrt(distSq)), 0.0);
+    color += albedo * lights[i].color.rgb * lambert * falloff * falloff;
+  }
+  outColor = vec4(color, 1.0);
+}
@@ -0,0 +1,43 @@
+// Resources shared by the forward-lit konstrukt_scenes passes. Everything is
+// procedural: cubes are expanded from gl_VertexIndex, so no vertex buffers.
+
+#ifndef KST_BENCH_SCENE_GLSL
+#define KST_BENCH_SCENE_GLSL
+
+// Must match kst::bench::kMaxSceneTextures.
+#define BENCH_MAX_TEXTURES 8
+
+struct Object {
+  vec4 positionScale;  // xyz center, w half extent
+  vec4 color;
+};
+
+struct Light {
+  vec4 positionRadius;
+  vec4 color;
+};
+
+layout(set = 0, binding = 0) uniform SceneParams {
+  mat4 viewProjection;
+  vec4 cameraPosition;
+  uvec4 counts;  // x light count, yzw unused
+}
+scene;
+
+layout(std430, set = 0, binding = 1) readonly buffer ObjectBuffer {
+  Object objects[];
+};
+
+layout(std430, set = 0, binding = 2) readonly buffer LightBuffer {
+  Light lights[];
+};
+
+layout(set = 0, binding = 3) uniform sampler2D textures[BENCH_MAX_TEXTURES];
+
+layout(push_constant) uniform DrawParams {
+  uint objectIndex;
+  uint textureIndex;
+}
+draw;
+
+#endif
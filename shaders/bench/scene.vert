@@ -0,0 +1,34 @@
+#version 460
+#extension GL_GOOGLE_include_directive : require
+
+// One cube per vkCmdDraw(36, 1, 0, 0): face = vertex / 6, two triangles per
+// face wound counter-clockwise seen from outside.
+
+#include "bench/scene.glsl"
+
+layout(location = 0) out vec3 outWorld;
+layout(location = 1) out vec3 outNormal;
+layout(location = 2) out vec2 outUV;
+layout(location = 3) out vec4 outColor;
+
+const vec3 kNormals[6] = vec3[](vec3(1.0, 0.0, 0.0), vec3(-1.0, 0.0, 0.0), vec3(0.0, 1.0, 0.0),
+                                vec3(0.0, -1.0, 0.0), vec3(0.0, 0.0, 1.0), vec3(0.0, 0.0, -1.0));
+
+const vec2 kCorners[6] = vec2[](vec2(-1.0, -1.0), vec2(1.0, -1.0), vec2(1.0, 1.0),
+                                vec2(-1.0, -1.0), vec2(1.0, 1.0), vec2(-1.0, 1.0));
+
+void main() {
+  const Object object = objects[draw.objectIndex];
+
+  const vec3 normal    = kNormals[gl_VertexIndex / 6];
+  const vec2 corner    = kCorners[gl_VertexIndex % 6];
+  const vec3 tangent   = abs(normal.y) > 0.5 ? vec3(1.0, 0.0, 0.0) : vec3(0.0, 1.0, 0.0);
+  const vec3 bitangent = cross(normal, tangent);
+  const vec3 local     = normal + tangent * corner.x + bitangent * corner.y;
+
+  outWorld    = object.positionScale.xyz + local * object.positionScale.w;
+  outNormal   = normal;
+  outUV       = corner * 0.5 + 0.5;
+  outColor    = object.color;
+  gl_Position = scene.viewProjection * vec4(outWorld, 1.0);
+}
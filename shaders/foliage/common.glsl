@@ -0,0 +1,50 @@
+// Shared declarations for the foliage scatter passes. Mirrors FoliageParams
+// and FoliageInstance in source/renderer/Foliage/FoliageScatter.cc.
+
+#ifndef KST_FOLIAGE_COMMON_GLSL
+#define KST_FOLIAGE_COMMON_GLSL
+
+#define FOLIAGE_MAX_LODS 4
+#define FOLIAGE_GROUP_SIZE 8
+
+layout(set = 0, binding = 0) uniform FoliageParams {
+  mat4 viewProjection;
+  vec4 frustumPlanes[6];
+  vec4 cameraPosition; // xyz world-space camera position, w unused
+  vec4 sunDirection;   // xyz towards the sun, w ambient
+  vec4 color;          // rgb albedo, w 1 when double-sided
+  vec4 map;            // xy world origin of the maps, zw 1 / world size
+  vec4 placement;      // x cell size, y height scale, z height offset, w mesh bounding radius
+  vec4 scaleFade;      // x min scale, y max scale, z fade start distance, w max distance
+  vec4 lodDistances;   // max distance of each LOD
+  uvec4 lodFirst;      // first instance of each LOD's range
+  uvec4 lodCapacity;   // instances in each LOD's range
+  ivec4 grid;          // xy first cell, z cells per side, w LOD count
+  uvec4 seedChannel;   // x seed, y density channel, zw unused
+}
+params;
+
+struct FoliageInstance {
+  vec4 positionScale; // xyz world position, w uniform scale
+  vec4 rotationTint;  // xy cos and sin of the yaw, z albedo tint, w unused
+};
+
+layout(std430, set = 0, binding = 1) buffer InstanceBuffer {
+  FoliageInstance instances[];
+};
+
+uint foliageHash(uint x) {
+  x ^= x >> 16;
+  x *= 0x7feb352du;
+  x ^= x >> 15;
+  x *= 0x846ca68bu;
+  x ^= x >> 16;
+  return x;
+}
+
+float foliageRandom01(inout uint state) {
+  state = foliageHash(state);
+  return float(state >> 8) * (1.0 / 16777216.0);
+}
+
+#endif
@@ -0,0 +1,22 @@
+#version 460
+#extension GL_GOOGLE_include_directive : require
+
+#include "foliage/common.glsl"
+
+layout(location = 0) in vec3 inWorld;
+layout(location = 1) in vec3 inNormal;
+layout(location = 2) in float inTint;
+
+layout(location = 0) out vec4 outColor;
+
+void main() {
+  vec3 normal = normalize(inNormal);
+  // Double-sided cards are lit from whichever side faces the camera
+  if (params.color.w > 0.5 && !gl_FrontFacing) {
+    normal = -normal;
+  }
+
+  const float lambert = max(dot(normal, params.sunDirection.xyz), 0.0);
+  const vec3 albedo   = params.color.rgb * inTint;
+  outColor            = vec4(albedo * (lambert + params.sunDirection.w), 1.0);
+}
@@ -0,0 +1,40 @@
+#version 460
+#extension GL_GOOGLE_include_directive : require
+
+// Instanced foliage mesh, pulled from the vertex buffer with the LOD's
+// vertexOffset already added to gl_VertexIndex. Each LOD's draw starts at the
+// first instance of its range, so gl_InstanceIndex addresses the scattered
+// instance directly.
+
+#include "foliage/common.glsl"
+
+// MeshVertex: uv split across the w components; tangent and uv are unused
+struct Vertex {
+  vec4 positionUvX;
+  vec4 normalUvY;
+  vec4 tangent;
+};
+
+layout(std430, set = 0, binding = 2) readonly buffer VertexBuffer {
+  Vertex vertices[];
+};
+
+layout(location = 0) out vec3 outWorld;
+layout(location = 1) out vec3 outNormal;
+layout(location = 2) out float outTint;
+
+vec3 rotateYaw(vec3 v, vec2 cosSin) {
+  return vec3(v.x * cosSin.x + v.z * cosSin.y, v.y, v.z * cosSin.x - v.x * cosSin.y);
+}
+
+void main() {
+  const FoliageInstance instance = instances[gl_InstanceIndex];
+  const Vertex vertex            = vertices[gl_VertexIndex];
+  const vec2 cosSin              = instance.rotationTint.xy;
+  const vec3 local = rotateYaw(vertex.positionUvX.xyz, cosSin) * instance.positionScale.w;
+
+  outWorld    = instance.positionScale.xyz + local;
+  outNormal   = rotateYaw(vertex.normalUvY.xyz, cosSin);
+  outTint     = instance.rotationTint.z;
+  gl_Position = params.viewProjection * vec4(outWorld, 1.0);
+}
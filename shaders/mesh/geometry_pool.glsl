@@ -0,0 +1,108 @@
+// Access to a GeometryPool from any stage. Define KST_GEOMETRY_SET and
+// KST_GEOMETRY_BINDING before including to move the four bindings; they
+// match GeometryPool::pageBuffer(), clusterBuffer(), pageTableBuffer() and
+// feedbackBuffer() in that order.
+
+#ifndef KST_GEOMETRY_POOL_GLSL
+#define KST_GEOMETRY_POOL_GLSL
+
+#ifndef KST_GEOMETRY_SET
+#define KST_GEOMETRY_SET 0
+#endif
+#ifndef KST_GEOMETRY_BINDING
+#define KST_GEOMETRY_BINDING 0
+#endif
+
+#define KST_GEOMETRY_INVALID_PAGE 0xffffffffu
+
+struct GeometryCluster {
+  vec3 center;
+  float radius;
+  uint virtualPage;
+  uint pageOffset;  // bytes from the start of the page
+  uint counts;      // vertexCount | triangleCount << 8
+  float error;      // object-space error of the cluster's LOD
+};
+
+struct GeometryVertex {
+  vec3 position;
+  vec3 normal;
+  vec4 tangent;
+  vec2 uv;
+};
+
+layout(std430, set = KST_GEOMETRY_SET, binding = KST_GEOMETRY_BINDING + 0) readonly buffer GeometryPages {
+  uint geometryPageWords[];
+};
+
+layout(std430, set = KST_GEOMETRY_SET, binding = KST_GEOMETRY_BINDING + 1) readonly buffer GeometryClusters {
+  GeometryCluster geometryClusters[];
+};
+
+// First word of each virtual page's physical page, or KST_GEOMETRY_INVALID_PAGE
+layout(std430, set = KST_GEOMETRY_SET, binding = KST_GEOMETRY_BINDING + 2) readonly buffer GeometryPageTable {
+  uint geometryPageTable[];
+};
+
+layout(std430, set = KST_GEOMETRY_SET, binding = KST_GEOMETRY_BINDING + 3) buffer GeometryFeedback {
+  uint geometryFeedback[];
+};
+
+// Marks the page as wanted, resident or not, so the pool loads it or keeps
+// it; the read first avoids an atomic per lookup once the bit is set
+void geometryMarkPage(uint virtualPage) {
+  const uint word = virtualPage >> 5;
+  const uint bit  = 1u << (virtualPage & 31u);
+  if ((geometryFeedback[word] & bit) == 0u) {
+    atomicOr(geometryFeedback[word], bit);
+  }
+}
+
+// Word offset of the cluster's data, or KST_GEOMETRY_INVALID_PAGE while its
+// page isn't resident. Either way the page is marked in the feedback.
+uint geometryClusterBase(GeometryCluster cluster) {
+  geometryMarkPage(cluster.virtualPage);
+  const uint page = geometryPageTable[cluster.virtualPage];
+  return page == KST_GEOMETRY_INVALID_PAGE ? page : page + (cluster.pageOffset >> 2);
+}
+
+uint geometryVertexCount(GeometryCluster cluster) {
+  return cluster.counts & 0xffu;
+}
+
+uint geometryTriangleCount(GeometryCluster cluster) {
+  return cluster.counts >> 8;
+}
+
+vec4 geometryLoadVec4(uint word) {
+  return uintBitsToFloat(uvec4(geometryPageWords[word], geometryPageWords[word + 1],
+                               geometryPageWords[word + 2], geometryPageWords[word + 3]));
+}
+
+// Vertices are MeshVertex: 12 words each, uv split across the w components
+GeometryVertex geometryLoadVertex(uint base, uint vertex) {
+  const uint word        = base + vertex * 12u;
+  const vec4 positionUvX = geometryLoadVec4(word);
+  const vec4 normalUvY   = geometryLoadVec4(word + 4u);
+  GeometryVertex result;
+  result.position = positionUvX.xyz;
+  result.normal   = normalUvY.xyz;
+  result.tangent  = geometryLoadVec4(word + 8u);
+  result.uv       = vec2(positionUvX.w, normalUvY.w);
+  return result;
+}
+
+// Cluster-local vertex indices of a triangle, stored as bytes after the
+// vertices
+uvec3 geometryLoadTriangle(GeometryCluster cluster, uint base, uint triangle) {
+  const uint indexBase = base + geometryVertexCount(cluster) * 12u;
+  uvec3 result;
+  for (uint corner = 0u; corner < 3u; ++corner) {
+    const uint byteIndex = triangle * 3u + corner;
+    const uint word      = geometryPageWords[indexBase + (byteIndex >> 2)];
+    result[corner]       = (word >> ((byteIndex & 3u) * 8u)) & 0xffu;
+  }
+  return result;
+}
+
+#endif // KST_GEOMETRY_POOL_GLSL
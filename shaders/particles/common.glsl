@@ -0,0 +1,104 @@
+// Shared declarations for the GPU particle passes. Every compute pass uses the
+// same descriptor set layout so GPUParticleSystem can bind one set per frame.
+
+#ifndef KST_PARTICLES_COMMON_GLSL
+#define KST_PARTICLES_COMMON_GLSL
+
+#define PARTICLE_GROUP_SIZE 256
+#define SORT_GROUP_SIZE 256
+#define SORT_BLOCK_SIZE (SORT_GROUP_SIZE * 2)
+
+struct Particle {
+  vec4 positionLife;  // xyz position, w remaining life in seconds
+  vec4 velocityAge;   // xyz velocity, w age in seconds
+  vec4 color;
+  vec4 sizeSeed;      // x start size, y end size, z rotation, w random seed
+};
+
+layout(set = 0, binding = 0) uniform SimulationParams {
+  mat4 viewProjection;
+  mat4 inverseViewProjection;
+  mat4 view;
+  vec4 cameraPosition;         // xyz world-space camera position, w unused
+  vec4 emitterPositionRadius;  // xyz position, w spawn radius
+  vec4 emitterVelocitySpread;  // xyz initial velocity, w random spread
+  vec4 gravityDeltaTime;       // xyz gravity, w delta time
+  vec4 colorStart;
+  vec4 colorEnd;
+  vec4 lifeSize;               // x min life, y max life, z start size, w end size
+  vec4 noise;                  // x frequency, y strength, z time, w unused
+  vec4 collision;              // x restitution, y surface thickness, zw unused
+  uvec4 counts;                // x emit count, y max particles, z frame index, w collide
+}
+params;
+
+layout(std430, set = 0, binding = 1) buffer ParticleBuffer {
+  Particle particles[];
+};
+
+layout(std430, set = 0, binding = 2) buffer DeadListBuffer {
+  uint deadIndices[];
+};
+
+layout(std430, set = 0, binding = 3) buffer AliveCurrentBuffer {
+  uint aliveCurrent[];
+};
+
+layout(std430, set = 0, binding = 4) buffer AliveNextBuffer {
+  uint aliveNext[];
+};
+
+layout(std430, set = 0, binding = 5) buffer CounterBuffer {
+  uint aliveCount[2];
+  uint deadCount;
+  uint emitCount;
+}
+counters;
+
+// Layout mirrors VkDispatchIndirectCommand / VkDrawIndirectCommand, each
+// dispatch padded to 16 bytes so offsets stay simple on the CPU side.
+layout(std430, set = 0, binding = 6) buffer IndirectArgsBuffer {
+  uvec4 emitDispatch;
+  uvec4 simulateDispatch;
+  uvec4 sortDispatch;
+  uint drawVertexCount;
+  uint drawInstanceCount;
+  uint drawFirstVertex;
+  uint drawFirstInstance;
+}
+indirect;
+
+// x = sort key (sortable float bits of view distance), y = particle index
+layout(std430, set = 0, binding = 7) buffer SortBuffer {
+  uvec2 sortEntries[];
+};
+
+layout(set = 0, binding = 8) uniform sampler2D sceneDepth;
+
+layout(push_constant) uniform PushConstants {
+  uint currentList;
+  uint sortMode;
+  uint sortK;
+  uint sortJ;
+}
+pc;
+
+uint hash(uint x) {
+  x ^= x >> 16;
+  x *= 0x7feb352dU;
+  x ^= x >> 15;
+  x *= 0x846ca68bU;
+  x ^= x >> 16;
+  return x;
+}
+
+float random01(inout uint state) {
+  state = hash(state);
+  return float(state & 0x00ffffffU) / float(0x01000000U);
+}
+
+uint nextPowerOfTwo(uint value) {
+  return value <= 1u ? 1u : 1u << (findMSB(value - 1u) + 1);
+}
+
+#endif
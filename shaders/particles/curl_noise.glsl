@@ -0,0 +1,52 @@
+// Divergence-free turbulence: the curl of a vector potential built from three
+// decorrelated value-noise fields, differentiated with central differences.
+
+#ifndef KST_PARTICLES_CURL_NOISE_GLSL
+#define KST_PARTICLES_CURL_NOISE_GLSL
+
+float hash3(vec3 p) {
+  p = fract(p * 0.3183099 + 0.1);
+  p *= 17.0;
+  return fract(p.x * p.y * p.z * (p.x + p.y + p.z)) * 2.0 - 1.0;
+}
+
+float valueNoise(vec3 p) {
+  const vec3 cell = floor(p);
+  const vec3 f    = fract(p);
+  const vec3 u    = f * f * (3.0 - 2.0 * f);
+
+  return mix(
+      mix(mix(hash3(cell + vec3(0, 0, 0)), hash3(cell + vec3(1, 0, 0)), u.x),
+          mix(hash3(cell + vec3(0, 1, 0)), hash3(cell + vec3(1, 1, 0)), u.x), u.y),
+      mix(mix(hash3(cell + vec3(0, 0, 1)), hash3(cell + vec3(1, 0, 1)), u.x),
+          mix(hash3(cell + vec3(0, 1, 1)), hash3(cell + vec3(1, 1, 1)), u.x), u.y),
+      u.z);
+}
+
+vec3 noisePotential(vec3 p) {
+  return vec3(valueNoise(p),
+              valueNoise(p + vec3(31.416, -47.853, 12.793)),
+              valueNoise(p + vec3(-233.145, -113.408, -185.31)));
+}
+
+vec3 curlNoise(vec3 p) {
+  const float e = 0.1;
+  const vec3 dx = vec3(e, 0.0, 0.0);
+  const vec3 dy = vec3(0.0, e, 0.0);
+  const vec3 dz = vec3(0.0, 0.0, e);
+
+  const vec3 px0 = noisePotential(p - dx);
+  const vec3 px1 = noisePotential(p + dx);
+  const vec3 py0 = noisePotential(p - dy);
+  const vec3 py1 = noisePotential(p + dy);
+  const vec3 pz0 = noisePotential(p - dz);
+  const vec3 pz1 = noisePotential(p + dz);
+
+  const float x = (py1.z - py0.z) - (pz1.y - pz0.y);
+  const float y = (pz1.x - pz0.x) - (px1.z - px0.z);
+  const float z = (px1.y - px0.y) - (py1.x - py0.x);
+
+  return vec3(x, y, z) / (2.0 * e);
+}
+
+#endif
@@ -0,0 +1,14 @@
+#version 460
+
+layout(location = 0) in vec4 inColor;
+layout(location = 1) in vec2 inUV;
+
+layout(location = 0) out vec4 outColor;
+
+void main() {
+  const float falloff = 1.0 - smoothstep(0.6, 1.0, length(inUV * 2.0 - 1.0));
+  if (falloff <= 0.0) {
+    discard;
+  }
+  outColor = vec4(inColor.rgb, inColor.a * falloff);
+}
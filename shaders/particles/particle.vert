@@ -0,0 +1,53 @@
+#version 460
+
+// Camera-facing quads expanded from the sorted alive list. Drawn with
+// vkCmdDrawIndirect: 6 vertices per instance, instance count written by the
+// simulation pass.
+
+struct Particle {
+  vec4 positionLife;
+  vec4 velocityAge;
+  vec4 color;
+  vec4 sizeSeed;
+};
+
+layout(set = 0, binding = 0) uniform RenderParams {
+  mat4 viewProjection;
+  mat4 inverseViewProjection;
+  mat4 view;
+}
+params;
+
+layout(std430, set = 0, binding = 1) readonly buffer ParticleBuffer {
+  Particle particles[];
+};
+
+layout(std430, set = 0, binding = 2) readonly buffer SortBuffer {
+  uvec2 sortEntries[];
+};
+
+layout(location = 0) out vec4 outColor;
+layout(location = 1) out vec2 outUV;
+
+const vec2 corners[6] = vec2[](vec2(-1.0, -1.0), vec2(1.0, -1.0), vec2(1.0, 1.0),
+                               vec2(-1.0, -1.0), vec2(1.0, 1.0), vec2(-1.0, 1.0));
+
+void main() {
+  const Particle particle = particles[sortEntries[gl_InstanceIndex].y];
+
+  const float age  = particle.velocityAge.w / max(particle.velocityAge.w + particle.positionLife.w, 1e-5);
+  const float size = mix(particle.sizeSeed.x, particle.sizeSeed.y, age);
+
+  const float s = sin(particle.sizeSeed.z);
+  const float c = cos(particle.sizeSeed.z);
+  const vec2 corner = corners[gl_VertexIndex];
+  const vec2 rotated = vec2(corner.x * c - corner.y * s, corner.x * s + corner.y * c);
+
+  const vec3 right = vec3(params.view[0][0], params.view[1][0], params.view[2][0]);
+  const vec3 up    = vec3(params.view[0][1], params.view[1][1], params.view[2][1]);
+  const vec3 world = particle.positionLife.xyz + (right * rotated.x + up * rotated.y) * size;
+
+  gl_Position = params.viewProjection * vec4(world, 1.0);
+  outColor    = particle.color;
+  outUV       = corner * 0.5 + 0.5;
+}
@@ -0,0 +1,20 @@
+// Shared helpers for the post-processing passes. Every pass works on storage
+// images in GENERAL layout so nothing goes through the raster pipeline.
+
+#ifndef KST_POSTPROCESS_COMMON_GLSL
+#define KST_POSTPROCESS_COMMON_GLSL
+
+#define POST_GROUP_SIZE 8
+
+// Must match kst::renderer::PostEffect.
+#define EFFECT_NONE 0u
+#define EFFECT_BLOOM 1u
+#define EFFECT_TONEMAP 2u
+#define EFFECT_COLOR_GRADING 3u
+#define EFFECT_VIGNETTE 4u
+
+float luminance(vec3 color) {
+  return dot(color, vec3(0.2126, 0.7152, 0.0722));
+}
+
+#endif
@@ -0,0 +1,48 @@
+// Shared declarations for the terrain clipmap passes. Mirrors TerrainParams
+// and the block instance packing in source/renderer/Terrain/TerrainClipmap.cc.
+
+#ifndef KST_TERRAIN_COMMON_GLSL
+#define KST_TERRAIN_COMMON_GLSL
+
+#define TERRAIN_MAX_LEVELS 16
+#define TERRAIN_GROUP_SIZE 64
+
+layout(set = 0, binding = 0) uniform TerrainParams {
+  mat4 viewProjection;
+  vec4 frustumPlanes[6];
+  vec4 cameraPosition;               // xyz world-space camera position, w unused
+  vec4 sunDirection;                 // xyz towards the sun, w ambient
+  vec4 spacingHeight;                // x level 0 spacing, y min height, z max height, w morph quads
+  uvec4 counts;                      // x levels, y finest drawn level, z quads per side, w block quads
+  ivec4 origins[TERRAIN_MAX_LEVELS]; // xy first texel of each level window, zw unused
+}
+params;
+
+// One drawn block: level in bits 0-7, block x in 8-15, block z in 16-23
+uint terrainPackBlock(uint level, uvec2 block) {
+  return level | (block.x << 8) | (block.y << 16);
+}
+
+uint terrainBlockLevel(uint packed) {
+  return packed & 0xffu;
+}
+
+uvec2 terrainBlockCoord(uint packed) {
+  return uvec2((packed >> 8) & 0xffu, (packed >> 16) & 0xffu);
+}
+
+float terrainSpacing(uint level) {
+  return params.spacingHeight.x * float(1u << level);
+}
+
+// Window of the next finer level in this level's texels; empty for the
+// finest drawn level
+ivec4 terrainFinerRegion(uint level) {
+  if (level <= params.counts.y) {
+    return ivec4(0, 0, -1, -1);
+  }
+  const ivec2 first = params.origins[level - 1].xy / 2;
+  return ivec4(first, first + ivec2(params.counts.z / 2));
+}
+
+#endif
@@ -0,0 +1,23 @@
+#version 460
+#extension GL_GOOGLE_include_directive : require
+
+#include "terrain/common.glsl"
+
+layout(location = 0) in vec3 inWorldPosition;
+layout(location = 1) in vec3 inNormal;
+
+layout(location = 0) out vec4 outColor;
+
+void main() {
+  const vec3 normal = normalize(inNormal);
+  const float range = max(params.spacingHeight.z - params.spacingHeight.y, 1e-3);
+  const float t     = clamp((inWorldPosition.y - params.spacingHeight.y) / range, 0.0, 1.0);
+
+  // Grass in the valleys, rock on slopes, snow on the peaks
+  vec3 albedo = mix(vec3(0.22, 0.35, 0.14), vec3(0.45, 0.42, 0.38), smoothstep(0.3, 0.7, t));
+  albedo      = mix(albedo, vec3(0.4, 0.37, 0.33), smoothstep(0.55, 0.8, 1.0 - normal.y));
+  albedo      = mix(albedo, vec3(0.92), smoothstep(0.8, 0.9, t) * normal.y);
+
+  const float diffuse = max(dot(normal, normalize(params.sunDirection.xyz)), 0.0);
+  outColor            = vec4(albedo * (diffuse + params.sunDirection.w), 1.0);
+}
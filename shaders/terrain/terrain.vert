@@ -0,0 +1,79 @@
+#version 460
+#extension GL_GOOGLE_include_directive : require
+
+// Displaces the shared block grid. gl_VertexIndex addresses a vertex of the
+// (blockQuads + 1)^2 grid, gl_InstanceIndex a block written by select.comp.
+//
+// Near the outer edge of a level, odd vertices slide onto the next coarser
+// grid and blend to its heights, so the edge matches the coarser level
+// exactly. The part of a level covered by the next finer level is removed
+// with a clip distance, which keeps early depth testing unlike a discard.
+
+#include "terrain/common.glsl"
+
+layout(std430, set = 0, binding = 1) readonly buffer BlockBuffer {
+  uint blocks[];
+};
+
+layout(set = 0, binding = 2) uniform sampler2DArray heights;
+
+layout(location = 0) out vec3 outWorldPosition;
+layout(location = 1) out vec3 outNormal;
+
+out gl_PerVertex {
+  vec4 gl_Position;
+  float gl_ClipDistance[1];
+};
+
+// Level windows wrap toroidally inside their texture layer
+float fetchHeight(uint level, ivec2 texel) {
+  const int size = int(params.counts.z) + 1;
+  return texelFetch(heights, ivec3((texel % size + size) % size, level), 0).r;
+}
+
+float sampleHeight(uint level, vec2 texel) {
+  const ivec2 base = ivec2(floor(texel));
+  const vec2 f     = texel - vec2(base);
+  const float h00  = fetchHeight(level, base);
+  const float h10  = f.x > 0.0 ? fetchHeight(level, base + ivec2(1, 0)) : h00;
+  const float h01  = f.y > 0.0 ? fetchHeight(level, base + ivec2(0, 1)) : h00;
+  const float h11  = f.x > 0.0 && f.y > 0.0 ? fetchHeight(level, base + ivec2(1, 1)) : h00;
+  return mix(mix(h00, h10, f.x), mix(h01, h11, f.x), f.y);
+}
+
+void main() {
+  const uint packed   = blocks[gl_InstanceIndex];
+  const uint level    = terrainBlockLevel(packed);
+  const uint quads    = params.counts.w;
+  const ivec2 local   = ivec2(gl_VertexIndex % (quads + 1), gl_VertexIndex / (quads + 1));
+  const ivec2 origin  = params.origins[level].xy;
+  const ivec2 texel   = origin + ivec2(terrainBlockCoord(packed) * quads) + local;
+  const int size      = int(params.counts.z);
+  const bool coarsest = level + 1 >= params.counts.x;
+
+  // Quads to the nearest edge of the level window
+  const ivec2 fromEdge = min(texel - origin, origin + size - texel);
+  const float morph    = coarsest ? 0.0
+                                  : clamp(1.0 - float(min(fromEdge.x, fromEdge.y)) / params.spacingHeight.w, 0.0, 1.0);
+
+  const vec2 position = vec2(texel) - vec2(texel & 1) * morph;
+  float height        = sampleHeight(level, position);
+  if (morph > 0.0) {
+    height = mix(height, sampleHeight(level + 1, position * 0.5), morph);
+  }
+
+  // Central differences, one-sided on the window edge
+  const ivec2 lo      = max(texel - 1, origin);
+  const ivec2 hi      = min(texel + 1, origin + size);
+  const float spacing = terrainSpacing(level);
+  const float dx      = fetchHeight(level, ivec2(hi.x, texel.y)) - fetchHeight(level, ivec2(lo.x, texel.y));
+  const float dz      = fetchHeight(level, ivec2(texel.x, hi.y)) - fetchHeight(level, ivec2(texel.x, lo.y));
+  outNormal           = normalize(vec3(-dx / (float(hi.x - lo.x) * spacing), 1.0, -dz / (float(hi.y - lo.y) * spacing)));
+
+  const ivec4 finer  = terrainFinerRegion(level);
+  const ivec2 inside = max(finer.xy - texel, texel - finer.zw);
+  gl_ClipDistance[0] = float(max(inside.x, inside.y));
+
+  outWorldPosition = vec3(position.x * spacing, height, position.y * spacing);
+  gl_Position      = params.viewProjection * vec4(outWorldPosition, 1.0);
+}
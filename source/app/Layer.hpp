@@ -6,6 +6,10 @@
 #include <utility>
 #include <vector>
 
+namespace kst::core {
+  class StateArena;
+}
+
 namespace kst::app {
   class Context;
   class CommandQueueManager;
@@ -91,8 +95,19 @@ namespace kst::app {
 
     auto isEnabled() const -> bool { return m_enabled; }
 
+  protected:
+    /**
+     * @brief Arena for state that snapshots and rollback should cover
+     *
+     * Set by the LayerStack before onAttach; null when the stack has none
+     */
+    auto stateArena() const -> core::StateArena* { return m_stateArena; }
+
   private:
+    friend class LayerStack;
+
     std::string m_name;
     bool m_enabled{true};
+    core::StateArena* m_stateArena = nullptr;
   };
 } // namespace kst::app
@@ -3,6 +3,7 @@
 #include <algorithm>
 
 #include "Logger.hpp"
+#include "MemoryTracker.hpp"
 
 namespace kst::app {
   LayerStack::~LayerStack() {
@@ -13,15 +14,19 @@ namespace kst::app {
   }
 
   void LayerStack::pushLayer(std::shared_ptr<Layer> layer) {
+    KST_MEMORY_SCOPE(App);
     KST_INFO("Adding Layer: ", layer->getName());
     m_layers.emplace(m_layers.begin() + m_layerInsertIndex, layer);
     m_layerInsertIndex++;
+    layer->m_stateArena = m_stateArena;
     layer->onAttach();
   }
 
   void LayerStack::pushOverlay(std::shared_ptr<Layer> overlay) {
+    KST_MEMORY_SCOPE(App);
     KST_INFO("Adding Overlay: ", overlay->getName());
     m_layers.emplace_back(overlay);
+    overlay->m_stateArena = m_stateArena;
     overlay->onAttach();
   }
 
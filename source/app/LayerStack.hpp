@@ -51,6 +51,17 @@ namespace kst::app {
      */
     void popOverlay(std::shared_ptr<Layer> overlay);
 
+    /**
+     * @brief Arena handed to layers pushed from now on
+     * @param arena Simulation state arena, owned by the caller; may be null
+     *
+     * Layers keep their simulation state there so a snapshot of the arena
+     * captures the whole world. Set it before pushing layers.
+     */
+    void setStateArena(core::StateArena* arena) { m_stateArena = arena; }
+
+    auto getStateArena() const -> core::StateArena* { return m_stateArena; }
+
     // Iterator methods to allow range-based for loops and standard algorithms.
     // Forward iterators go from bottom to top layer (regular layers first, then overlays)
     auto begin() { return m_layers.begin(); };
@@ -77,5 +88,7 @@ namespace kst::app {
     // Regular layers: [0, m_layerInsertIndex)
     // Overlays: [m_layerInsertIndex, end)
     unsigned int m_layerInsertIndex = 0;
+
+    core::StateArena* m_stateArena = nullptr;
   };
 }; // namespace kst::app
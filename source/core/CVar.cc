@@ -0,0 +1,565 @@
+#include "CVar.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+#include "Logger.hpp"
+
+#if !defined(_WIN32)
+#  include <sys/socket.h>
+#  include <unistd.h>
+#endif
+#if defined(__linux__)
+#  include <sys/inotify.h>
+#endif
+
+namespace kst::core {
+  namespace {
+    // Console and file watch poll granularity; also bounds how long stop() waits
+    constexpr int kPollTimeoutMs = 100;
+
+    // Larger console lines are dropped instead of buffered without bound
+    constexpr size_t kMaxConsoleLine = 4096;
+
+    auto trim(std::string_view text) -> std::string_view {
+      const auto first = text.find_first_not_of(" \t\r\n");
+      if (first == std::string_view::npos) {
+        return {};
+      }
+      const auto last = text.find_last_not_of(" \t\r\n");
+      return text.substr(first, last - first + 1);
+    }
+
+    auto unquote(std::string_view text) -> std::string_view {
+      if (text.size() >= 2 && text.front() == '"' && text.back() == '"') {
+        return text.substr(1, text.size() - 2);
+      }
+      return text;
+    }
+
+    // "name=value" -> {name, value}; false without a '='
+    auto splitAssignment(std::string_view text, std::string_view& name, std::string_view& value)
+        -> bool {
+      const auto equals = text.find('=');
+      if (equals == std::string_view::npos) {
+        return false;
+      }
+      name  = trim(text.substr(0, equals));
+      value = unquote(trim(text.substr(equals + 1)));
+      return !name.empty();
+    }
+
+    auto sourceName(CVarSource source) -> const char* {
+      switch (source) {
+        case CVarSource::Default:
+          return "default";
+        case CVarSource::CommandLine:
+          return "command line";
+        case CVarSource::ConfigFile:
+          return "config file";
+        case CVarSource::Console:
+          return "console";
+        case CVarSource::Code:
+          return "code";
+      }
+      return "unknown";
+    }
+  } // namespace
+
+  namespace detail {
+    auto parseCVar(std::string_view text, bool& value) -> bool {
+      static constexpr std::string_view kTrue[]  = {"1", "true", "on", "yes"};
+      static constexpr std::string_view kFalse[] = {"0", "false", "off", "no"};
+      if (std::find(std::begin(kTrue), std::end(kTrue), text) != std::end(kTrue)) {
+        value = true;
+        return true;
+      }
+      if (std::find(std::begin(kFalse), std::end(kFalse), text) != std::end(kFalse)) {
+        value = false;
+        return true;
+      }
+      return false;
+    }
+
+    auto parseCVar(std::string_view text, float& value) -> bool {
+      const auto* end         = text.data() + text.size();
+      const auto [ptr, error] = std::from_chars(text.data(), end, value);
+      return error == std::errc() && ptr == end;
+    }
+
+    auto parseCVar(std::string_view text, double& value) -> bool {
+      const auto* end         = text.data() + text.size();
+      const auto [ptr, error] = std::from_chars(text.data(), end, value);
+      return error == std::errc() && ptr == end;
+    }
+
+    auto formatCVar(bool value) -> std::string {
+      return value ? "true" : "false";
+    }
+
+    auto formatCVar(double value) -> std::string {
+      char text[32];
+      std::snprintf(text, sizeof(text), "%.9g", value);
+      return text;
+    }
+  } // namespace detail
+
+  CVarBase::CVarBase(std::string_view name, std::string_view description, CVarFlags flags)
+      : m_name(name), m_description(description), m_flags(flags) {
+    CVarRegistry::instance().add(*this);
+  }
+
+  CVarBase::~CVarBase() {
+    CVarRegistry::instance().remove(*this);
+  }
+
+  void CVarBase::onChange(std::function<void()> callback) {
+    std::scoped_lock lock(m_writeMutex);
+    m_callbacks.push_back(std::move(callback));
+  }
+
+  auto CVarBase::changed(CVarSource source) -> Callbacks {
+    m_source.store(source, std::memory_order_release);
+    m_version.fetch_add(1, std::memory_order_acq_rel);
+    return m_callbacks;
+  }
+
+  auto CVarRegistry::instance() -> CVarRegistry& {
+    static CVarRegistry registry;
+    return registry;
+  }
+
+  void CVarRegistry::add(CVarBase& cvar) {
+    std::scoped_lock lock(m_mutex);
+    const auto [iter, inserted] = m_vars.try_emplace(cvar.name(), &cvar);
+    if (!inserted) {
+      // Two statics with one name would silently shadow each other
+      throw std::logic_error("cvar " + cvar.name() + " registered twice");
+    }
+  }
+
+  void CVarRegistry::remove(CVarBase& cvar) {
+    std::scoped_lock lock(m_mutex);
+    const auto iter = m_vars.find(cvar.name());
+    if (iter != m_vars.end() && iter->second == &cvar) {
+      m_vars.erase(iter);
+    }
+  }
+
+  auto CVarRegistry::find(std::string_view name) const -> CVarBase* {
+    std::scoped_lock lock(m_mutex);
+    const auto iter = m_vars.find(name);
+    return iter != m_vars.end() ? iter->second : nullptr;
+  }
+
+  auto CVarRegistry::set(std::string_view name, std::string_view value, CVarSource source)
+      -> Result<std::string> {
+    using SetResult = Result<std::string>;
+
+    // CVars are statics, so the pointer outlives the registry lock; not
+    // holding it lets change callbacks look up other variables
+    auto* found = find(name);
+    if (found == nullptr) {
+      return SetResult::error("unknown cvar " + std::string(name));
+    }
+    auto& cvar = *found;
+
+    CVarBase::Callbacks callbacks;
+    std::string current;
+    {
+      std::scoped_lock lock(cvar.m_writeMutex);
+      if (source == CVarSource::ConfigFile && (cvar.source() == CVarSource::CommandLine ||
+                                               cvar.source() == CVarSource::Console)) {
+        return SetResult::success(cvar.toString());
+      }
+      if (hasFlag(cvar.flags(), CVarFlags::Startup) &&
+          m_runtime.load(std::memory_order_acquire)) {
+        // Reloading a file that repeats the startup value is fine
+        current = cvar.toString();
+        if (current == value) {
+          return SetResult::success(current);
+        }
+        return SetResult::error(cvar.name() + " can only be set at startup");
+      }
+
+      auto assigned = cvar.assign(value);
+      if (assigned.hasError()) {
+        return SetResult::error(cvar.name() + ": " + assigned.error());
+      }
+      current = cvar.toString();
+      if (!assigned.value()) {
+        return SetResult::success(current);
+      }
+      callbacks = cvar.changed(source);
+    }
+
+    // Outside the write lock, so callbacks can't deadlock against setters
+    KST_CORE_INFO("cvar {} = {} ({})", cvar.name(), current, sourceName(source));
+    for (const auto& callback : callbacks) {
+      callback();
+    }
+    return SetResult::success(current);
+  }
+
+  auto CVarRegistry::reset(std::string_view name, CVarSource source) -> Result<std::string> {
+    const auto* cvar = find(name);
+    if (cvar == nullptr) {
+      return Result<std::string>::error("unknown cvar " + std::string(name));
+    }
+    return set(name, cvar->defaultString(), source);
+  }
+
+  auto CVarRegistry::applyCommandLine(int argc, const char* const* argv)
+      -> Result<std::vector<std::string>> {
+    using ArgsResult = Result<std::vector<std::string>>;
+
+    std::vector<std::string> remaining;
+    for (int i = 0; i < argc; ++i) {
+      const std::string_view arg = argv[i];
+      std::string_view assignment;
+      if (i > 0 && arg.starts_with('+')) {
+        assignment = arg.substr(1);
+      } else if (i > 0 && arg == "--cvar" && i + 1 < argc) {
+        assignment = argv[++i];
+      } else {
+        remaining.emplace_back(arg);
+        continue;
+      }
+
+      std::string_view name;
+      std::string_view value;
+      if (!splitAssignment(assignment, name, value)) {
+        return ArgsResult::error("expected name=value, got " + std::string(assignment));
+      }
+      auto result = set(name, value, CVarSource::CommandLine);
+      if (result.hasError()) {
+        return ArgsResult::error(result.error());
+      }
+    }
+    return ArgsResult::success(std::move(remaining));
+  }
+
+  auto CVarRegistry::loadFile(const std::filesystem::path& path) -> Result<size_t> {
+    std::ifstream file(path);
+    if (!file) {
+      return Result<size_t>::error("can't read cvar file " + path.string());
+    }
+
+    size_t changes = 0;
+    std::string section;
+    std::string line;
+    for (int lineNumber = 1; std::getline(file, line); ++lineNumber) {
+      const auto text = trim(line);
+      if (text.empty() || text.front() == '#' || text.front() == ';') {
+        continue;
+      }
+      if (text.front() == '[' && text.back() == ']') {
+        section = trim(text.substr(1, text.size() - 2));
+        continue;
+      }
+
+      std::string_view key;
+      std::string_view value;
+      if (!splitAssignment(text, key, value)) {
+        KST_CORE_WARN("{}:{}: expected key = value", path.string(), lineNumber);
+        continue;
+      }
+
+      const auto name     = section.empty() ? std::string(key) : section + "." + std::string(key);
+      const auto* cvar    = find(name);
+      const auto previous = cvar ? cvar->version() : 0;
+      auto result         = set(name, value, CVarSource::ConfigFile);
+      if (result.hasError()) {
+        KST_CORE_WARN("{}:{}: {}", path.string(), lineNumber, result.error());
+      } else if (cvar->version() != previous) {
+        ++changes;
+      }
+    }
+    return Result<size_t>::success(changes);
+  }
+
+  auto CVarRegistry::list(std::string_view prefix) const -> std::vector<CVarBase*> {
+    std::scoped_lock lock(m_mutex);
+    std::vector<CVarBase*> result;
+    for (auto iter = m_vars.lower_bound(prefix); iter != m_vars.end(); ++iter) {
+      if (!iter->first.starts_with(prefix)) {
+        break;
+      }
+      result.push_back(iter->second);
+    }
+    return result;
+  }
+
+  CVarServer::CVarServer(
+      CVarServerOptions options,
+      CVarRegistry& registry,
+      int watchFd,
+      UnixSocketListener listener
+  )
+      : m_options(std::move(options)),
+        m_registry(registry),
+        m_watchFd(watchFd),
+        m_listener(std::move(listener)) {
+    if (!m_options.configFile.empty()) {
+      std::error_code error;
+      m_lastWrite = std::filesystem::last_write_time(m_options.configFile, error);
+    }
+    m_thread = std::jthread([this](const std::stop_token& stopToken) { run(stopToken); });
+  }
+
+  CVarServer::~CVarServer() {
+    stop();
+  }
+
+  auto CVarServer::start(CVarServerOptions options, CVarRegistry& registry)
+      -> Result<std::unique_ptr<CVarServer>> {
+    using ServerResult = Result<std::unique_ptr<CVarServer>>;
+
+    if (options.configFile.empty() && options.socketPath.empty()) {
+      return ServerResult::error("cvar server needs a config file or a socket path");
+    }
+
+    // A missing file is fine: it is picked up once it gets created
+    if (!options.configFile.empty() && std::filesystem::exists(options.configFile)) {
+      auto loaded = registry.loadFile(options.configFile);
+      if (loaded.hasError()) {
+        return ServerResult::error(loaded.error());
+      }
+    }
+
+    UnixSocketListener listener;
+    if (!options.socketPath.empty()) {
+      auto listening = UnixSocketListener::listen(options.socketPath);
+      if (listening.hasError()) {
+        return ServerResult::error("cvar " + listening.error());
+      }
+      listener = std::move(listening.value());
+    }
+
+    int watchFd = -1;
+#if defined(__linux__)
+    if (!options.configFile.empty()) {
+      // Watch the directory: editors often save by writing a new file and
+      // renaming it over the old one, which a watch on the file itself misses
+      auto directory = options.configFile.parent_path();
+      if (directory.empty()) {
+        directory = ".";
+      }
+      watchFd = ::inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+      if (watchFd < 0 ||
+          ::inotify_add_watch(
+              watchFd, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE
+          ) < 0) {
+        const std::string error = std::strerror(errno);
+        if (watchFd >= 0) {
+          ::close(watchFd);
+        }
+        return ServerResult::error("watching " + directory.string() + ": " + error);
+      }
+    }
+#endif
+
+    return ServerResult::success(std::unique_ptr<CVarServer>(
+        new CVarServer(std::move(options), registry, watchFd, std::move(listener))
+    ));
+  }
+
+  void CVarServer::stop() {
+    if (!m_thread.joinable()) {
+      return;
+    }
+    m_thread.request_stop();
+    m_thread.join();
+
+    for (const auto& client : m_clients) {
+      closeSocket(client.fd);
+    }
+    m_clients.clear();
+    m_listener.close();
+#if !defined(_WIN32)
+    if (m_watchFd >= 0) {
+      ::close(m_watchFd);
+      m_watchFd = -1;
+    }
+#endif
+  }
+
+  void CVarServer::run(const std::stop_token& stopToken) {
+    while (!stopToken.stop_requested()) {
+      // Slot 0 is the inotify descriptor, 1 the listener, then the clients;
+      // negative descriptors are never ready
+      std::vector<int> fds = {m_watchFd, m_listener.fd()};
+      for (const auto& client : m_clients) {
+        fds.push_back(client.fd);
+      }
+
+      const auto ready = waitReadable(fds, kPollTimeoutMs);
+      if (m_watchFd < 0 || ready[0]) {
+        watchFile();
+      }
+
+      // Serve the clients polled above before accepting new ones; a hung up
+      // client reads as end of stream
+      size_t index = 2;
+      std::erase_if(m_clients, [&](Client& client) {
+        if (!ready[index++] || serveClient(client)) {
+          return false;
+        }
+        closeSocket(client.fd);
+        return true;
+      });
+      if (ready[1]) {
+        acceptClients();
+      }
+    }
+  }
+
+  void CVarServer::watchFile() {
+    if (m_options.configFile.empty()) {
+      return;
+    }
+
+#if defined(__linux__)
+    // Drain every queued event and reload once for the whole batch
+    const auto fileName = m_options.configFile.filename().string();
+    bool touched        = false;
+    alignas(inotify_event) char buffer[4096];
+    for (;;) {
+      const auto length = ::read(m_watchFd, buffer, sizeof(buffer));
+      if (length <= 0) {
+        break;
+      }
+      for (ssize_t offset = 0; offset < length;) {
+        const auto* event = reinterpret_cast<const inotify_event*>(buffer + offset);
+        if (event->len > 0 && fileName == event->name) {
+          touched = true;
+        }
+        offset += static_cast<ssize_t>(sizeof(inotify_event) + event->len);
+      }
+    }
+    if (touched) {
+      reload();
+    }
+#else
+    std::error_code error;
+    const auto lastWrite = std::filesystem::last_write_time(m_options.configFile, error);
+    if (!error && lastWrite != m_lastWrite) {
+      m_lastWrite = lastWrite;
+      reload();
+    }
+#endif
+  }
+
+  void CVarServer::reload() {
+    if (!std::filesystem::exists(m_options.configFile)) {
+      return;
+    }
+    auto loaded = m_registry.loadFile(m_options.configFile);
+    if (loaded.hasError()) {
+      KST_CORE_WARN("cvar reload failed: {}", loaded.error());
+    } else {
+      KST_CORE_INFO(
+          "Reloaded {} ({} cvars changed)", m_options.configFile.string(), loaded.value()
+      );
+    }
+  }
+
+  void CVarServer::acceptClients() {
+    for (int client; (client = m_listener.accept(true)) >= 0;) {
+      m_clients.push_back({.fd = client});
+    }
+  }
+
+  auto CVarServer::serveClient(Client& client) -> bool {
+#if defined(_WIN32)
+    return false;
+#else
+    char buffer[1024];
+    for (;;) {
+      const auto received = ::recv(client.fd, buffer, sizeof(buffer), 0);
+      if (received == 0) {
+        return false;
+      }
+      if (received < 0) {
+        return errno == EAGAIN || errno == EWOULDBLOCK;
+      }
+      client.pending.append(buffer, static_cast<size_t>(received));
+
+      size_t newline;
+      while ((newline = client.pending.find('\n')) != std::string::npos) {
+        const auto reply = execute(std::string_view(client.pending).substr(0, newline));
+        client.pending.erase(0, newline + 1);
+
+        // Answers are small; a client that doesn't read them gets cut off
+        if (!sendAll(client.fd, reply)) {
+          return false;
+        }
+      }
+      if (client.pending.size() > kMaxConsoleLine) {
+        return false;
+      }
+    }
+#endif
+  }
+
+  auto CVarServer::execute(std::string_view line) -> std::string {
+    line = trim(line);
+    const auto space   = line.find(' ');
+    const auto command = line.substr(0, space);
+    const auto args    = space == std::string_view::npos ? std::string_view{}
+                                                         : trim(line.substr(space + 1));
+
+    const auto answer = [](const Result<std::string>& result, std::string_view name) {
+      if (result.hasError()) {
+        return "error: " + result.error() + "\n";
+      }
+      return std::string(name) + " = " + result.value() + "\n";
+    };
+
+    if (command == "get") {
+      const auto* cvar = m_registry.find(args);
+      return cvar ? std::string(args) + " = " + cvar->toString() + "\n"
+                  : "error: unknown cvar " + std::string(args) + "\n";
+    }
+    if (command == "set") {
+      const auto nameEnd = args.find(' ');
+      if (nameEnd == std::string_view::npos) {
+        return "error: usage: set <name> <value>\n";
+      }
+      const auto name = args.substr(0, nameEnd);
+      return answer(
+          m_registry.set(name, unquote(trim(args.substr(nameEnd + 1))), CVarSource::Console),
+          name
+      );
+    }
+    if (command == "reset") {
+      return answer(m_registry.reset(args, CVarSource::Console), args);
+    }
+    if (command == "list") {
+      std::ostringstream out;
+      for (const auto* cvar : m_registry.list(args)) {
+        out << cvar->name() << " = " << cvar->toString() << "  # " << cvar->typeName() << ", "
+            << sourceName(cvar->source()) << ": " << cvar->description() << '\n';
+      }
+      return out.str();
+    }
+    if (command == "reload") {
+      if (m_options.configFile.empty()) {
+        return "error: no config file\n";
+      }
+      reload();
+      return "ok\n";
+    }
+    if (command.empty()) {
+      return {};
+    }
+    return "error: unknown command " + std::string(command) +
+           " (get, set, reset, list, reload)\n";
+  }
+
+} // namespace kst::core
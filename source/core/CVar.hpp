@@ -0,0 +1,434 @@
+#pragma once
+
+#include <atomic>
+#include <charconv>
+#include <concepts>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <limits>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include "Result.hpp"
+#include "UnixSocket.hpp"
+
+namespace kst::core {
+
+  enum class CVarFlags : uint32_t {
+    None = 0,
+    // Only settable until CVarRegistry::beginRuntime(): command line and the
+    // first config file load. For values consumed once at startup.
+    Startup = 1u << 0,
+  };
+
+  constexpr auto operator|(CVarFlags lhs, CVarFlags rhs) -> CVarFlags {
+    return static_cast<CVarFlags>(static_cast<uint32_t>(lhs) | static_cast<uint32_t>(rhs));
+  }
+
+  constexpr auto hasFlag(CVarFlags flags, CVarFlags flag) -> bool {
+    return (static_cast<uint32_t>(flags) & static_cast<uint32_t>(flag)) != 0;
+  }
+
+  // Where a variable's current value came from. Command-line and console
+  // values win over config file (re)loads; the console overrides everything.
+  enum class CVarSource : uint8_t {
+    Default,
+    CommandLine,
+    ConfigFile,
+    Console,
+    Code
+  };
+
+  /**
+   * @brief Type-erased part of a CVar: name, text conversion and bookkeeping
+   *
+   * Readers only ever touch the typed value through CVar<T>::get(); everything
+   * here is for the registry, the config loaders and the console.
+   */
+  class CVarBase {
+  public:
+    CVarBase(const CVarBase&)                    = delete;
+    auto operator=(const CVarBase&) -> CVarBase& = delete;
+
+    auto name() const -> const std::string& { return m_name; }
+
+    auto description() const -> const std::string& { return m_description; }
+
+    auto flags() const -> CVarFlags { return m_flags; }
+
+    auto source() const -> CVarSource { return m_source.load(std::memory_order_acquire); }
+
+    /**
+     * @brief Bumped on every change; cache derived state against it
+     */
+    auto version() const -> uint64_t { return m_version.load(std::memory_order_acquire); }
+
+    /**
+     * @brief Runs on the thread that changed the value, after the change
+     *
+     * No lock is held while it runs, so it may set other variables; another
+     * change may already have landed by then, so read the value with get().
+     */
+    void onChange(std::function<void()> callback);
+
+    virtual auto typeName() const -> std::string_view = 0;
+
+    virtual auto toString() const -> std::string = 0;
+
+    virtual auto defaultString() const -> std::string = 0;
+
+  protected:
+    CVarBase(std::string_view name, std::string_view description, CVarFlags flags);
+    virtual ~CVarBase();
+
+    // Parses text and stores it if it differs from the current value. Returns
+    // whether the value changed, or why the text was rejected.
+    virtual auto assign(std::string_view text) -> Result<bool> = 0;
+
+    using Callbacks = std::vector<std::function<void()>>;
+
+    // Called by the typed setters with m_writeMutex held. Returns the change
+    // callbacks, for the setter to run once it released the lock.
+    auto changed(CVarSource source) -> Callbacks;
+
+    std::mutex m_writeMutex;
+
+  private:
+    friend class CVarRegistry;
+
+    std::string m_name;
+    std::string m_description;
+    CVarFlags m_flags;
+    std::atomic<CVarSource> m_source{CVarSource::Default};
+    std::atomic<uint64_t> m_version{0};
+    Callbacks m_callbacks;
+  };
+
+  namespace detail {
+    template <typename T>
+    concept CVarArithmetic = std::is_arithmetic_v<T>;
+
+    template <typename T>
+    concept CVarValue = CVarArithmetic<T> || std::same_as<T, std::string>;
+
+    auto parseCVar(std::string_view text, bool& value) -> bool;
+    auto parseCVar(std::string_view text, float& value) -> bool;
+    auto parseCVar(std::string_view text, double& value) -> bool;
+
+    template <std::integral T>
+    auto parseCVar(std::string_view text, T& value) -> bool {
+      const auto* end         = text.data() + text.size();
+      const auto [ptr, error] = std::from_chars(text.data(), end, value);
+      return error == std::errc() && ptr == end;
+    }
+
+    auto formatCVar(bool value) -> std::string;
+    auto formatCVar(double value) -> std::string;
+
+    template <std::integral T>
+    auto formatCVar(T value) -> std::string {
+      return std::to_string(value);
+    }
+
+    template <typename T>
+    constexpr auto cvarTypeName() -> std::string_view {
+      if constexpr (std::same_as<T, bool>) {
+        return "bool";
+      } else if constexpr (std::floating_point<T>) {
+        return "float";
+      } else if constexpr (std::integral<T>) {
+        return std::is_signed_v<T> ? "int" : "uint";
+      } else {
+        return "string";
+      }
+    }
+  } // namespace detail
+
+  /**
+   * @brief Runtime-tunable variable, registered by name on construction
+   *
+   * Define CVars as statics next to the code that reads them; the name is
+   * dotted by subsystem. get() is a single atomic load for arithmetic types.
+   * Strings are published as immutable versions behind an atomic pointer, so
+   * reading one is lock-free as well; superseded versions are kept alive for
+   * the life of the variable, which is fine for values set by hand.
+   *
+   * @code
+   * static kst::core::CVar<uint32_t> maxSets(
+   *     "rhi.maxDescriptorSets", 12288, "Descriptor sets per pipeline pool", {}, 1, 1u << 20);
+   * poolInfo.maxSets = maxSets.get();
+   * @endcode
+   */
+  template <detail::CVarValue T>
+  class CVar final : public CVarBase {
+  public:
+    CVar(
+        std::string_view name,
+        T defaultValue,
+        std::string_view description,
+        CVarFlags flags = CVarFlags::None
+    )
+        requires std::same_as<T, std::string>
+        : CVarBase(name, description, flags), m_default(std::move(defaultValue)) {
+      m_versions.push_back(std::make_unique<const std::string>(m_default));
+      m_value.store(m_versions.back().get(), std::memory_order_release);
+    }
+
+    CVar(
+        std::string_view name,
+        T defaultValue,
+        std::string_view description,
+        CVarFlags flags = CVarFlags::None,
+        T min           = std::numeric_limits<T>::lowest(),
+        T max           = std::numeric_limits<T>::max()
+    )
+        requires detail::CVarArithmetic<T>
+        : CVarBase(name, description, flags),
+          m_default(defaultValue),
+          m_min(min),
+          m_max(max),
+          m_value(defaultValue) {}
+
+    ~CVar() override = default;
+
+    auto get() const -> T
+      requires detail::CVarArithmetic<T>
+    {
+      return m_value.load(std::memory_order_relaxed);
+    }
+
+    auto get() const -> const std::string&
+      requires std::same_as<T, std::string>
+    {
+      return *m_value.load(std::memory_order_acquire);
+    }
+
+    /**
+     * @brief Sets the value from code; false when it is out of range
+     */
+    auto set(T value) -> bool {
+      Callbacks callbacks;
+      {
+        std::scoped_lock lock(m_writeMutex);
+        if (!store(std::move(value))) {
+          return false;
+        }
+        callbacks = changed(CVarSource::Code);
+      }
+      for (const auto& callback : callbacks) {
+        callback();
+      }
+      return true;
+    }
+
+    auto defaultValue() const -> const T& { return m_default; }
+
+    auto typeName() const -> std::string_view override { return detail::cvarTypeName<T>(); }
+
+    auto toString() const -> std::string override {
+      if constexpr (std::same_as<T, std::string>) {
+        return get();
+      } else {
+        return detail::formatCVar(get());
+      }
+    }
+
+    auto defaultString() const -> std::string override {
+      if constexpr (std::same_as<T, std::string>) {
+        return m_default;
+      } else {
+        return detail::formatCVar(m_default);
+      }
+    }
+
+  protected:
+    auto assign(std::string_view text) -> Result<bool> override {
+      T value{};
+      if constexpr (std::same_as<T, std::string>) {
+        value = std::string(text);
+      } else if (!detail::parseCVar(text, value)) {
+        return Result<bool>::error(
+            "'" + std::string(text) + "' is not a valid " + std::string(typeName())
+        );
+      }
+
+      if constexpr (detail::CVarArithmetic<T>) {
+        if (value < m_min || value > m_max) {
+          return Result<bool>::error(
+              std::string(text) + " is outside [" + detail::formatCVar(m_min) + ", " +
+              detail::formatCVar(m_max) + "]"
+          );
+        }
+      }
+      if (value == get()) {
+        return Result<bool>::success(false);
+      }
+      store(std::move(value));
+      return Result<bool>::success(true);
+    }
+
+  private:
+    // Expects m_writeMutex to be held
+    auto store(T value) -> bool {
+      if constexpr (std::same_as<T, std::string>) {
+        m_versions.push_back(std::make_unique<const std::string>(std::move(value)));
+        m_value.store(m_versions.back().get(), std::memory_order_release);
+      } else {
+        if (value < m_min || value > m_max) {
+          return false;
+        }
+        m_value.store(value, std::memory_order_relaxed);
+      }
+      return true;
+    }
+
+    struct NoBounds {};
+    using Bounds  = std::conditional_t<detail::CVarArithmetic<T>, T, NoBounds>;
+    using Storage = std::
+        conditional_t<detail::CVarArithmetic<T>, std::atomic<T>, std::atomic<const std::string*>>;
+
+    T m_default;
+    [[no_unique_address]] Bounds m_min{};
+    [[no_unique_address]] Bounds m_max{};
+    Storage m_value{};
+    // Every string ever published, so readers never see a freed one
+    std::vector<std::unique_ptr<const std::string>> m_versions;
+  };
+
+  /**
+   * @brief Process-wide set of CVars, and the text front ends that set them
+   *
+   * Lookups and sets by name take a lock; reading a CVar you hold never does.
+   *
+   * Config files are INI (a TOML subset reads the same): `key = value` lines,
+   * `[section]` headers that prefix the following keys with `section.`,
+   * `#`/`;` comments and optionally double-quoted values. Unknown keys are
+   * reported and skipped so a typo doesn't hide the rest of the file.
+   */
+  class CVarRegistry {
+  public:
+    static auto instance() -> CVarRegistry&;
+
+    auto find(std::string_view name) const -> CVarBase*;
+
+    /**
+     * @brief Sets a variable from text; returns its value afterwards
+     *
+     * A config file value is ignored (not an error) when the command line or
+     * the console set the variable, so reloading a file never undoes either.
+     */
+    auto set(std::string_view name, std::string_view value, CVarSource source)
+        -> Result<std::string>;
+
+    auto reset(std::string_view name, CVarSource source) -> Result<std::string>;
+
+    /**
+     * @brief Applies `+name=value` and `--cvar name=value` arguments
+     *
+     * @return The remaining arguments (argv[0] included), or the first bad one
+     */
+    auto applyCommandLine(int argc, const char* const* argv)
+        -> Result<std::vector<std::string>>;
+
+    /**
+     * @brief Applies every key in the file; bad lines are logged and skipped
+     *
+     * @return Number of variables that changed
+     */
+    auto loadFile(const std::filesystem::path& path) -> Result<size_t>;
+
+    /**
+     * @brief Variables whose name starts with prefix, sorted by name
+     */
+    auto list(std::string_view prefix = {}) const -> std::vector<CVarBase*>;
+
+    /**
+     * @brief Freezes Startup variables; call once initialization is done
+     */
+    void beginRuntime() { m_runtime.store(true, std::memory_order_release); }
+
+  private:
+    friend class CVarBase;
+
+    void add(CVarBase& cvar);
+    void remove(CVarBase& cvar);
+
+    mutable std::mutex m_mutex;
+    std::map<std::string, CVarBase*, std::less<>> m_vars;
+    std::atomic<bool> m_runtime{false};
+  };
+
+  struct CVarServerOptions {
+    // Loaded on start and reloaded whenever it is rewritten; empty disables it
+    std::filesystem::path configFile;
+    // Line-based console (see CVarServer); empty disables it. Unix domain
+    // sockets are unavailable on Windows.
+    std::filesystem::path socketPath;
+  };
+
+  /**
+   * @brief Background thread that hot-reloads a config file and serves a console
+   *
+   * The file's directory is watched with inotify on Linux, so editors that
+   * save through a rename are seen too; other platforms poll the modification
+   * time. The console speaks one command per line and answers in text:
+   *
+   *   get <name> | set <name> <value> | reset <name> | list [prefix] | reload
+   *
+   * e.g. `echo "set rhi.maxDescriptorSets 4096" | socat - UNIX-CONNECT:<path>`.
+   * The socket is only as private as its path; put it in a directory only the
+   * user can reach.
+   */
+  class CVarServer {
+  public:
+    ~CVarServer();
+
+    CVarServer(const CVarServer&)                    = delete;
+    auto operator=(const CVarServer&) -> CVarServer& = delete;
+
+    static auto start(
+        CVarServerOptions options,
+        CVarRegistry& registry = CVarRegistry::instance()
+    ) -> Result<std::unique_ptr<CVarServer>>;
+
+    void stop();
+
+  private:
+    struct Client {
+      int fd = -1;
+      std::string pending;
+    };
+
+    CVarServer(
+        CVarServerOptions options,
+        CVarRegistry& registry,
+        int watchFd,
+        UnixSocketListener listener
+    );
+
+    void run(const std::stop_token& stopToken);
+    void reload();
+    void watchFile();
+    void acceptClients();
+    // Reads what a client sent; false once it hung up
+    auto serveClient(Client& client) -> bool;
+    // One console command in, the text answer out
+    auto execute(std::string_view line) -> std::string;
+
+    CVarServerOptions m_options;
+    CVarRegistry& m_registry;
+    int m_watchFd = -1;
+    UnixSocketListener m_listener;
+    std::vector<Client> m_clients;
+    std::filesystem::file_time_type m_lastWrite{};
+    std::jthread m_thread;
+  };
+
+} // namespace kst::core
@@ -1,12 +1,48 @@
 #include "Logger.hpp"
 
 #include <iostream>
+#include <mutex>
+
+#include "CVar.hpp"
 
 #include <spdlog/async.h>
 #include <spdlog/fmt/ostr.h>
 #include <spdlog/sinks/basic_file_sink.h>
 
 namespace kst::core {
+  namespace {
+    CVar<std::string> logLevel(
+        "log.level", "trace", "trace, debug, info, warn, error, critical or off"
+    );
+
+    auto parseLogLevel(std::string_view name, LogLevel& level) -> bool {
+      static constexpr std::pair<std::string_view, LogLevel> kLevels[] = {
+          {"trace", LogLevel::TRACE},
+          {"debug", LogLevel::DEBUG},
+          {"info", LogLevel::INFO},
+          {"warn", LogLevel::WARN},
+          {"error", LogLevel::ERROR},
+          {"critical", LogLevel::CRITICAL},
+          {"off", LogLevel::OFF},
+      };
+      for (const auto& [levelName, value] : kLevels) {
+        if (levelName == name) {
+          level = value;
+          return true;
+        }
+      }
+      return false;
+    }
+
+    void applyLogLevel() {
+      LogLevel level;
+      if (parseLogLevel(logLevel.get(), level)) {
+        Logger::setLevel(level);
+      } else {
+        KST_CORE_WARN("Unknown log.level '{}'", logLevel.get());
+      }
+    }
+  } // namespace
 
   std::shared_ptr<spdlog::logger> Logger::sCoreLogger;
   std::shared_ptr<spdlog::logger> Logger::sClientLogger;
@@ -17,6 +53,14 @@ namespace kst::core {
       return;
     }
 
+    // Process lifetime state, not owned by the logger: spdlog's registry and
+    // the log.level hook outlive shutdown(), so they stay out of the Logging
+    // tag the shutdown leak report checks
+    spdlog::details::registry::instance();
+    static std::once_flag logLevelHook;
+    std::call_once(logLevelHook, [] { logLevel.onChange(applyLogLevel); });
+
+    KST_MEMORY_SCOPE(Logging);
     try {
       // Set up async logging with a thread pool
       spdlog::init_thread_pool(8192, 1);
@@ -51,6 +95,9 @@ namespace kst::core {
 
       sInitialized = true;
 
+      // The command line may have set log.level before the loggers existed
+      applyLogLevel();
+
       // Log initialization
       sCoreLogger->info("Initialized logger");
     } catch (const spdlog::spdlog_ex& ex) {
@@ -64,11 +111,16 @@ namespace kst::core {
     }
 
     sCoreLogger->info("Shutting down logger");
-    spdlog::shutdown();
     sInitialized = false;
+    spdlog::shutdown();
+    sCoreLogger.reset();
+    sClientLogger.reset();
   }
 
   void Logger::setLevel(LogLevel level) {
+    if (!sInitialized) {
+      return;
+    }
     spdlog::level::level_enum spdlogLevel = toSpdLogLevel(level);
     sCoreLogger->set_level(spdlogLevel);
     sClientLogger->set_level(spdlogLevel);
@@ -10,6 +10,8 @@
 #include <spdlog/sinks/stdout_color_sinks.h>
 #include <spdlog/spdlog.h>
 
+#include "MemoryTracker.hpp"
+
 namespace kst::core {
 
   enum class LogLevel : std::uint8_t {
@@ -103,6 +105,8 @@ namespace kst::core {
 
       // Only log if level is sufficient
       if (logger->should_log(spdlogLevel)) {
+        KST_MEMORY_SCOPE(Logging);
+
         // Extract just the filename from the path
         const char* fileName  = location.file;
         const char* lastSlash = nullptr;
@@ -134,6 +138,8 @@ namespace kst::core {
 
       // Only log if level is sufficient
       if (logger->should_log(spdlogLevel)) {
+        KST_MEMORY_SCOPE(Logging);
+
         // Extract just the filename from the path
         const char* fileName  = location.file;
         const char* lastSlash = nullptr;
@@ -0,0 +1,320 @@
+#include "MemoryTracker.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+#include <tracy/Tracy.hpp>
+
+namespace kst::core {
+  namespace {
+    constexpr std::array<const char*, kMemoryTagCount> kTagNames = {
+        "untagged",
+        "app",
+        "rhi",
+        "assets",
+        "logging",
+    };
+
+    // Tracy keeps the plot name pointer, so these must be literals too
+    constexpr std::array<const char*, kMemoryTagCount> kPlotNames = {
+        "Memory: untagged",
+        "Memory: app",
+        "Memory: rhi",
+        "Memory: assets",
+        "Memory: logging",
+    };
+
+    // Published byte totals, one cache line per tag. Signed because a thread
+    // that frees another thread's blocks publishes a negative delta first.
+    struct alignas(64) TagBytes {
+      std::atomic<int64_t> current{0};
+      std::atomic<int64_t> peak{0};
+    };
+
+    // Counters written only by their owning thread, so the hot path does plain
+    // loads and stores instead of locked adds. Byte deltas are published to
+    // TagBytes once they pass kPublishBytes, which bounds the peak error.
+    struct TagCounts {
+      std::atomic<uint64_t> allocations{0};
+      std::atomic<uint64_t> frees{0};
+      std::atomic<int64_t> pendingBytes{0};
+    };
+
+    struct alignas(64) ThreadShard {
+      std::array<TagCounts, kMemoryTagCount> tags{};
+    };
+
+    constexpr int64_t kPublishBytes = 64 * 1024;
+
+    // Threads past the last exclusive shard share the final one and publish
+    // every allocation directly
+    constexpr uint32_t kShardCount = 64;
+
+    // constinit: static initializers in other translation units allocate
+    // before any dynamic initialization of this one could run
+    constinit std::array<TagBytes, kMemoryTagCount> gBytes{};
+    constinit std::array<ThreadShard, kShardCount> gShards{};
+    constinit std::atomic<uint32_t> gNextShard{0};
+    constinit std::array<std::atomic<uint64_t>, kMemoryTagCount> gAllocationsAtFrameStart{};
+    constinit std::array<std::atomic<uint64_t>, kMemoryTagCount> gLastFrameAllocations{};
+
+    constinit thread_local MemoryTag tCurrentTag = MemoryTag::Untagged;
+
+    struct TagTotals {
+      uint64_t currentBytes = 0;
+      uint64_t allocations  = 0;
+      uint64_t frees        = 0;
+    };
+
+    auto totals(MemoryTag tag) -> TagTotals {
+      const auto index = static_cast<size_t>(tag);
+      TagTotals result;
+      int64_t current = gBytes[index].current.load(std::memory_order_relaxed);
+      for (const auto& shard : gShards) {
+        const auto& counts = shard.tags[index];
+        result.allocations += counts.allocations.load(std::memory_order_relaxed);
+        result.frees += counts.frees.load(std::memory_order_relaxed);
+        current += counts.pendingBytes.load(std::memory_order_relaxed);
+      }
+      result.currentBytes = static_cast<uint64_t>(std::max<int64_t>(current, 0));
+      return result;
+    }
+  } // namespace
+
+  MemoryTagScope::MemoryTagScope(MemoryTag tag) : m_previous(tCurrentTag) {
+    tCurrentTag = tag;
+  }
+
+  MemoryTagScope::~MemoryTagScope() {
+    tCurrentTag = m_previous;
+  }
+
+  auto MemoryTracker::currentTag() -> MemoryTag {
+    return tCurrentTag;
+  }
+
+  auto MemoryTracker::tagName(MemoryTag tag) -> const char* {
+    return tag < MemoryTag::Count ? kTagNames[static_cast<size_t>(tag)] : "invalid";
+  }
+
+  auto MemoryTracker::stats(MemoryTag tag) -> MemoryTagStats {
+    // Shards are summed without a lock, so this is a near-consistent snapshot
+    // while other threads keep allocating
+    const auto sum  = totals(tag);
+    const auto peak = gBytes[static_cast<size_t>(tag)].peak.load(std::memory_order_relaxed);
+    return {
+        .currentBytes         = sum.currentBytes,
+        .peakBytes            = std::max(static_cast<uint64_t>(peak), sum.currentBytes),
+        .liveAllocations      = sum.allocations - std::min(sum.frees, sum.allocations),
+        .totalAllocations     = sum.allocations,
+        .lastFrameAllocations = gLastFrameAllocations[static_cast<size_t>(tag)].load(
+            std::memory_order_relaxed
+        ),
+    };
+  }
+
+  void MemoryTracker::endFrame() {
+    if constexpr (!enabled()) {
+      return;
+    }
+    for (size_t tag = 0; tag < kMemoryTagCount; ++tag) {
+      const auto sum = totals(static_cast<MemoryTag>(tag));
+      const auto previous =
+          gAllocationsAtFrameStart[tag].exchange(sum.allocations, std::memory_order_relaxed);
+      gLastFrameAllocations[tag].store(sum.allocations - previous, std::memory_order_relaxed);
+      TracyPlot(kPlotNames[tag], static_cast<int64_t>(sum.currentBytes));
+    }
+  }
+
+  auto MemoryTracker::reportLeaks(std::FILE* out) -> uint64_t {
+    if constexpr (!enabled()) {
+      return 0;
+    }
+
+    uint64_t leakedBytes = 0;
+    for (size_t tag = 1; tag < kMemoryTagCount; ++tag) {
+      const auto tagStats = stats(static_cast<MemoryTag>(tag));
+      if (tagStats.currentBytes == 0) {
+        continue;
+      }
+      std::fprintf(
+          out,
+          "[memory] leak: %-8s %12llu bytes in %llu allocations (peak %llu bytes)\n",
+          kTagNames[tag],
+          static_cast<unsigned long long>(tagStats.currentBytes),
+          static_cast<unsigned long long>(tagStats.liveAllocations),
+          static_cast<unsigned long long>(tagStats.peakBytes)
+      );
+      leakedBytes += tagStats.currentBytes;
+    }
+    if (leakedBytes == 0) {
+      std::fprintf(out, "[memory] no tagged allocations outstanding\n");
+    }
+    return leakedBytes;
+  }
+
+#if KST_MEMORY_TRACKING
+  namespace {
+    // Every block carries its size and tag right before the user pointer, so
+    // delete needs neither a lookup table nor the sized overloads
+    struct AllocationHeader {
+      uint64_t size;
+      MemoryTag tag;
+    };
+
+    constexpr size_t kHeaderSize = __STDCPP_DEFAULT_NEW_ALIGNMENT__;
+    static_assert(sizeof(AllocationHeader) <= kHeaderSize);
+
+    constinit thread_local uint32_t tShard = UINT32_MAX;
+
+    void publish(MemoryTag tag, int64_t delta) {
+      auto& total    = gBytes[static_cast<size_t>(tag)];
+      const auto now = total.current.fetch_add(delta, std::memory_order_relaxed) + delta;
+      auto peak      = total.peak.load(std::memory_order_relaxed);
+      while (now > peak &&
+             !total.peak.compare_exchange_weak(peak, now, std::memory_order_relaxed)) {
+      }
+    }
+
+    void record(MemoryTag tag, int64_t delta) {
+      if (tShard == UINT32_MAX) {
+        tShard = std::min(gNextShard.fetch_add(1, std::memory_order_relaxed), kShardCount - 1);
+      }
+      auto& counts = gShards[tShard].tags[static_cast<size_t>(tag)];
+      auto& count  = delta > 0 ? counts.allocations : counts.frees;
+
+      if (tShard == kShardCount - 1) {
+        count.fetch_add(1, std::memory_order_relaxed);
+        publish(tag, delta);
+        return;
+      }
+
+      count.store(count.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+      const auto pending = counts.pendingBytes.load(std::memory_order_relaxed) + delta;
+      if (pending >= kPublishBytes || pending <= -kPublishBytes) {
+        publish(tag, pending);
+        counts.pendingBytes.store(0, std::memory_order_relaxed);
+      } else {
+        counts.pendingBytes.store(pending, std::memory_order_relaxed);
+      }
+    }
+
+    auto header(void* user) -> AllocationHeader* {
+      return reinterpret_cast<AllocationHeader*>(static_cast<std::byte*>(user) - kHeaderSize);
+    }
+
+    void* systemAllocate(size_t size, size_t alignment) {
+      if (alignment <= kHeaderSize) {
+        return std::malloc(size);
+      }
+#  if defined(_WIN32)
+      return _aligned_malloc(size, alignment);
+#  else
+      return std::aligned_alloc(alignment, (size + alignment - 1) & ~(alignment - 1));
+#  endif
+    }
+
+    void systemFree(void* base, size_t alignment) {
+#  if defined(_WIN32)
+      if (alignment > kHeaderSize) {
+        _aligned_free(base);
+        return;
+      }
+#  endif
+      (void)alignment;
+      std::free(base);
+    }
+
+    void* trackedAllocate(size_t size, size_t alignment) {
+      // The header sits in the padding in front of over-aligned blocks
+      const size_t offset = std::max(alignment, kHeaderSize);
+      void* base          = systemAllocate(size + offset, alignment);
+      if (base == nullptr) {
+        return nullptr;
+      }
+
+      void* user     = static_cast<std::byte*>(base) + offset;
+      const auto tag = tCurrentTag;
+      *header(user)  = {.size = size, .tag = tag};
+
+      record(tag, static_cast<int64_t>(size));
+
+      TracySecureAllocN(user, size, kTagNames[static_cast<size_t>(tag)]);
+      return user;
+    }
+
+    void trackedFree(void* user, size_t alignment) {
+      if (user == nullptr) {
+        return;
+      }
+
+      const auto block = *header(user);
+      TracySecureFreeN(user, kTagNames[static_cast<size_t>(block.tag)]);
+
+      record(block.tag, -static_cast<int64_t>(block.size));
+
+      systemFree(static_cast<std::byte*>(user) - std::max(alignment, kHeaderSize), alignment);
+    }
+
+    void* allocateOrThrow(size_t size, size_t alignment) {
+      for (;;) {
+        if (void* user = trackedAllocate(size, alignment)) {
+          return user;
+        }
+        const auto handler = std::get_new_handler();
+        if (handler == nullptr) {
+          throw std::bad_alloc();
+        }
+        handler();
+      }
+    }
+
+    void* allocateNoThrow(size_t size, size_t alignment) noexcept {
+      try {
+        return allocateOrThrow(size, alignment);
+      } catch (...) {
+        return nullptr;
+      }
+    }
+
+    constexpr auto alignmentOf(std::align_val_t alignment) -> size_t {
+      return static_cast<size_t>(alignment);
+    }
+  } // namespace
+#endif
+} // namespace kst::core
+
+#if KST_MEMORY_TRACKING
+// clang-format off
+using kst::core::allocateNoThrow;
+using kst::core::allocateOrThrow;
+using kst::core::alignmentOf;
+using kst::core::trackedFree;
+constexpr size_t kDefaultAlignment = __STDCPP_DEFAULT_NEW_ALIGNMENT__;
+
+void* operator new(size_t size) { return allocateOrThrow(size, kDefaultAlignment); }
+void* operator new[](size_t size) { return allocateOrThrow(size, kDefaultAlignment); }
+void* operator new(size_t size, const std::nothrow_t&) noexcept { return allocateNoThrow(size, kDefaultAlignment); }
+void* operator new[](size_t size, const std::nothrow_t&) noexcept { return allocateNoThrow(size, kDefaultAlignment); }
+void* operator new(size_t size, std::align_val_t al) { return allocateOrThrow(size, alignmentOf(al)); }
+void* operator new[](size_t size, std::align_val_t al) { return allocateOrThrow(size, alignmentOf(al)); }
+void* operator new(size_t size, std::align_val_t al, const std::nothrow_t&) noexcept { return allocateNoThrow(size, alignmentOf(al)); }
+void* operator new[](size_t size, std::align_val_t al, const std::nothrow_t&) noexcept { return allocateNoThrow(size, alignmentOf(al)); }
+
+void operator delete(void* ptr) noexcept { trackedFree(ptr, kDefaultAlignment); }
+void operator delete[](void* ptr) noexcept { trackedFree(ptr, kDefaultAlignment); }
+void operator delete(void* ptr, size_t) noexcept { trackedFree(ptr, kDefaultAlignment); }
+void operator delete[](void* ptr, size_t) noexcept { trackedFree(ptr, kDefaultAlignment); }
+void operator delete(void* ptr, const std::nothrow_t&) noexcept { trackedFree(ptr, kDefaultAlignment); }
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept { trackedFree(ptr, kDefaultAlignment); }
+void operator delete(void* ptr, std::align_val_t al) noexcept { trackedFree(ptr, alignmentOf(al)); }
+void operator delete[](void* ptr, std::align_val_t al) noexcept { trackedFree(ptr, alignmentOf(al)); }
+void operator delete(void* ptr, size_t, std::align_val_t al) noexcept { trackedFree(ptr, alignmentOf(al)); }
+void operator delete[](void* ptr, size_t, std::align_val_t al) noexcept { trackedFree(ptr, alignmentOf(al)); }
+void operator delete(void* ptr, std::align_val_t al, const std::nothrow_t&) noexcept { trackedFree(ptr, alignmentOf(al)); }
+void operator delete[](void* ptr, std::align_val_t al, const std::nothrow_t&) noexcept { trackedFree(ptr, alignmentOf(al)); }
+// clang-format on
+#endif
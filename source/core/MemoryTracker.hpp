@@ -0,0 +1,99 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+
+// Set through the KST_MEMORY_TRACKING CMake option. When on, MemoryTracker.cc
+// replaces the global operator new/delete and attributes every allocation to
+// the calling thread's current MemoryTag.
+#ifndef KST_MEMORY_TRACKING
+#  define KST_MEMORY_TRACKING 0
+#endif
+
+namespace kst::core {
+
+  enum class MemoryTag : std::uint8_t {
+    Untagged,
+    App,
+    RHI,
+    Assets,
+    Logging,
+    Count
+  };
+
+  constexpr auto kMemoryTagCount = static_cast<std::size_t>(MemoryTag::Count);
+
+  struct MemoryTagStats {
+    uint64_t currentBytes         = 0;
+    uint64_t peakBytes            = 0;
+    uint64_t liveAllocations      = 0;
+    uint64_t totalAllocations     = 0;
+    uint64_t lastFrameAllocations = 0; // Allocations between the last two endFrame() calls
+  };
+
+  /**
+   * @brief Tags allocations made on this thread until the scope ends
+   *
+   * Scopes nest; the innermost tag wins. Use KST_MEMORY_SCOPE so the scope
+   * compiles away when tracking is off.
+   */
+  class MemoryTagScope {
+  public:
+    explicit MemoryTagScope(MemoryTag tag);
+    ~MemoryTagScope();
+
+    MemoryTagScope(const MemoryTagScope&)                    = delete;
+    MemoryTagScope(MemoryTagScope&&)                         = delete;
+    auto operator=(const MemoryTagScope&) -> MemoryTagScope& = delete;
+    auto operator=(MemoryTagScope&&) -> MemoryTagScope&      = delete;
+
+  private:
+    MemoryTag m_previous;
+  };
+
+  /**
+   * @brief Per-tag CPU allocation statistics fed by the global new/delete hooks
+   *
+   * All counters are zero unless the build has KST_MEMORY_TRACKING enabled.
+   * Memory obtained through malloc or custom allocators (VMA, stb, ...) is not
+   * seen. Current bytes are exact; peaks may undershoot by up to 64 KiB per
+   * allocating thread because threads publish their byte deltas in batches.
+   */
+  class MemoryTracker {
+  public:
+    static constexpr auto enabled() -> bool { return KST_MEMORY_TRACKING != 0; }
+
+    static auto currentTag() -> MemoryTag;
+
+    static auto tagName(MemoryTag tag) -> const char*;
+
+    static auto stats(MemoryTag tag) -> MemoryTagStats;
+
+    /**
+     * @brief Latches the per-frame allocation counts and plots per-tag bytes to Tracy
+     */
+    static void endFrame();
+
+    /**
+     * @brief Prints every tag that still owns memory and returns the leaked bytes
+     *
+     * Call at shutdown once subsystems are torn down. Untagged memory is left
+     * out: statics and third-party singletons are legitimately alive there.
+     */
+    static auto reportLeaks(std::FILE* out = stderr) -> uint64_t;
+  };
+
+} // namespace kst::core
+
+#define KST_MEMORY_CONCAT_IMPL(a, b) a##b
+#define KST_MEMORY_CONCAT(a, b) KST_MEMORY_CONCAT_IMPL(a, b)
+
+#if KST_MEMORY_TRACKING
+#  define KST_MEMORY_SCOPE(tag)                                                   \
+    const ::kst::core::MemoryTagScope KST_MEMORY_CONCAT(kstMemoryScope, __LINE__) { \
+      ::kst::core::MemoryTag::tag                                                \
+    }
+#else
+#  define KST_MEMORY_SCOPE(tag) static_cast<void>(0)
+#endif
@@ -0,0 +1,345 @@
+#include "Metrics.hpp"
+
+#include <bit>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+
+namespace kst::core {
+  namespace detail {
+    auto metricShard() -> size_t {
+      static std::atomic<size_t> nextShard{0};
+      thread_local const size_t shard =
+          nextShard.fetch_add(1, std::memory_order_relaxed) % kMetricShards;
+      return shard;
+    }
+  } // namespace detail
+
+  namespace {
+    constexpr std::array<double, 4> kExportedQuantiles = {0.5, 0.9, 0.99, 0.999};
+
+    // Prometheus poll granularity; also bounds how long stop() waits
+    constexpr int kPollTimeoutMs = 100;
+
+    void appendNumber(std::string& out, double value) {
+      char text[32];
+      std::snprintf(text, sizeof(text), "%.9g", value);
+      out += text;
+    }
+
+    void appendSeries(
+        std::string& out,
+        const std::string& name,
+        std::string_view suffix,
+        const std::string& labels,
+        std::string_view extraLabel,
+        double value
+    ) {
+      out += name;
+      out += suffix;
+      if (!labels.empty() || !extraLabel.empty()) {
+        out += '{';
+        out += labels;
+        if (!labels.empty() && !extraLabel.empty()) {
+          out += ',';
+        }
+        out += extraLabel;
+        out += '}';
+      }
+      out += ' ';
+      appendNumber(out, value);
+      out += '\n';
+    }
+
+    void updateMax(std::atomic<uint64_t>& max, uint64_t value) {
+      auto current = max.load(std::memory_order_relaxed);
+      while (value > current &&
+             !max.compare_exchange_weak(current, value, std::memory_order_relaxed)) {
+      }
+    }
+  } // namespace
+
+  auto Counter::value() const -> uint64_t {
+    uint64_t total = 0;
+    for (const auto& shard : m_shards) {
+      total += shard.value.load(std::memory_order_relaxed);
+    }
+    return total;
+  }
+
+  auto Histogram::bucketIndex(uint64_t value) -> uint32_t {
+    if (value < kSubBuckets) {
+      return static_cast<uint32_t>(value);
+    }
+    const auto exponent = static_cast<uint32_t>(std::bit_width(value)) - 1;
+    if (exponent >= kMaxExponent) {
+      return kBucketCount - 1;
+    }
+    const auto subBucket =
+        static_cast<uint32_t>(value >> (exponent - kSubBucketBits)) & (kSubBuckets - 1);
+    return (exponent - kSubBucketBits + 1) * kSubBuckets + subBucket;
+  }
+
+  auto Histogram::bucketLowerBound(uint32_t index) -> uint64_t {
+    if (index < kSubBuckets) {
+      return index;
+    }
+    const auto exponent  = index / kSubBuckets + kSubBucketBits - 1;
+    const auto subBucket = uint64_t{index % kSubBuckets};
+    return (kSubBuckets + subBucket) << (exponent - kSubBucketBits);
+  }
+
+  void Histogram::record(uint64_t value) {
+    auto& shard = m_shards[detail::metricShard()];
+    shard.count.fetch_add(1, std::memory_order_relaxed);
+    shard.sum.fetch_add(value, std::memory_order_relaxed);
+    shard.buckets[bucketIndex(value)].fetch_add(1, std::memory_order_relaxed);
+    updateMax(shard.max, value);
+  }
+
+  auto Histogram::snapshot() const -> HistogramSnapshot {
+    HistogramSnapshot result;
+    for (const auto& shard : m_shards) {
+      result.count += shard.count.load(std::memory_order_relaxed);
+      result.sum += shard.sum.load(std::memory_order_relaxed);
+      result.max = std::max(result.max, shard.max.load(std::memory_order_relaxed));
+      for (uint32_t i = 0; i < kBucketCount; ++i) {
+        result.buckets[i] += shard.buckets[i].load(std::memory_order_relaxed);
+      }
+    }
+    return result;
+  }
+
+  auto HistogramSnapshot::quantile(double q) const -> uint64_t {
+    // Summing shards races with writers, so trust the buckets over `count`
+    uint64_t total = 0;
+    for (const auto bucket : buckets) {
+      total += bucket;
+    }
+    if (total == 0) {
+      return 0;
+    }
+
+    const auto rank = static_cast<uint64_t>(std::ceil(std::clamp(q, 0.0, 1.0) * total));
+    uint64_t seen   = 0;
+    for (uint32_t i = 0; i < Histogram::kBucketCount; ++i) {
+      seen += buckets[i];
+      if (seen >= std::max<uint64_t>(rank, 1)) {
+        // Report the bucket midpoint, but never beyond the largest sample
+        const auto lower = Histogram::bucketLowerBound(i);
+        const auto upper = i + 1 < Histogram::kBucketCount ? Histogram::bucketLowerBound(i + 1)
+                                                           : max + 1;
+        return std::min(lower + (upper - lower) / 2, max);
+      }
+    }
+    return max;
+  }
+
+  auto MetricsRegistry::instance() -> MetricsRegistry& {
+    static MetricsRegistry registry;
+    return registry;
+  }
+
+  auto MetricsRegistry::findOrInsert(
+      std::string_view name,
+      std::string_view help,
+      std::string_view labels,
+      MetricType type
+  ) -> Entry& {
+    auto [iter, inserted] = m_entries.try_emplace({std::string(name), std::string(labels)});
+    auto& entry           = iter->second;
+    if (inserted) {
+      entry.name   = name;
+      entry.help   = help;
+      entry.labels = labels;
+      entry.type   = type;
+    } else if (entry.type != type) {
+      throw std::logic_error("metric " + entry.name + " registered with two different types");
+    }
+    return entry;
+  }
+
+  auto MetricsRegistry::counter(
+      std::string_view name,
+      std::string_view help,
+      std::string_view labels
+  ) -> Counter& {
+    std::scoped_lock lock(m_mutex);
+    auto& entry = findOrInsert(name, help, labels, MetricType::Counter);
+    if (!entry.counter) {
+      entry.counter = std::make_unique<Counter>();
+    }
+    return *entry.counter;
+  }
+
+  auto MetricsRegistry::gauge(std::string_view name, std::string_view help, std::string_view labels)
+      -> Gauge& {
+    std::scoped_lock lock(m_mutex);
+    auto& entry = findOrInsert(name, help, labels, MetricType::Gauge);
+    if (!entry.gauge) {
+      entry.gauge = std::make_unique<Gauge>();
+    }
+    return *entry.gauge;
+  }
+
+  auto MetricsRegistry::histogram(
+      std::string_view name,
+      std::string_view help,
+      std::string_view labels,
+      double exportScale
+  ) -> Histogram& {
+    std::scoped_lock lock(m_mutex);
+    auto& entry = findOrInsert(name, help, labels, MetricType::Histogram);
+    if (!entry.histogram) {
+      entry.histogram = std::make_unique<Histogram>(exportScale);
+    }
+    return *entry.histogram;
+  }
+
+  auto MetricsRegistry::prometheusText() const -> std::string {
+    std::scoped_lock lock(m_mutex);
+
+    std::string out;
+    const std::string* family = nullptr;
+    for (const auto& [key, entry] : m_entries) {
+      if (family == nullptr || *family != entry.name) {
+        family = &entry.name;
+        out += "# HELP " + entry.name + ' ' + entry.help + '\n';
+        out += "# TYPE " + entry.name;
+        switch (entry.type) {
+          case MetricType::Counter:
+            out += " counter\n";
+            break;
+          case MetricType::Gauge:
+            out += " gauge\n";
+            break;
+          case MetricType::Histogram:
+            out += " summary\n";
+            break;
+        }
+      }
+
+      switch (entry.type) {
+        case MetricType::Counter:
+          appendSeries(out, entry.name, {}, entry.labels, {}, entry.counter->value());
+          break;
+        case MetricType::Gauge:
+          appendSeries(out, entry.name, {}, entry.labels, {}, entry.gauge->value());
+          break;
+        case MetricType::Histogram: {
+          const auto scale    = entry.histogram->exportScale();
+          const auto snapshot = entry.histogram->snapshot();
+          for (const auto q : kExportedQuantiles) {
+            char label[32];
+            std::snprintf(label, sizeof(label), "quantile=\"%g\"", q);
+            appendSeries(
+                out, entry.name, {}, entry.labels, label, snapshot.quantile(q) * scale
+            );
+          }
+          // The exact maximum is kept alongside the buckets; quantile 1 exposes it
+          appendSeries(out, entry.name, {}, entry.labels, "quantile=\"1\"", snapshot.max * scale);
+          appendSeries(out, entry.name, "_sum", entry.labels, {}, snapshot.sum * scale);
+          appendSeries(out, entry.name, "_count", entry.labels, {}, snapshot.count);
+          break;
+        }
+      }
+    }
+    return out;
+  }
+
+  MetricsExporter::MetricsExporter(
+      MetricsExportOptions options,
+      MetricsRegistry& registry,
+      UnixSocketListener listener
+  )
+      : m_options(std::move(options)), m_registry(registry), m_listener(std::move(listener)) {
+    m_thread = std::jthread([this](const std::stop_token& stopToken) { run(stopToken); });
+  }
+
+  MetricsExporter::~MetricsExporter() {
+    stop();
+  }
+
+  auto MetricsExporter::start(MetricsExportOptions options, MetricsRegistry& registry)
+      -> Result<std::unique_ptr<MetricsExporter>> {
+    using ExporterResult = Result<std::unique_ptr<MetricsExporter>>;
+
+    if (options.file.empty() && options.socketPath.empty()) {
+      return ExporterResult::error("metrics export needs a file or a socket path");
+    }
+    if (options.interval <= std::chrono::milliseconds::zero()) {
+      return ExporterResult::error("metrics export interval must be positive");
+    }
+
+    UnixSocketListener listener;
+    if (!options.socketPath.empty()) {
+      auto listening = UnixSocketListener::listen(options.socketPath);
+      if (listening.hasError()) {
+        return ExporterResult::error("metrics " + listening.error());
+      }
+      listener = std::move(listening.value());
+    }
+
+    return ExporterResult::success(std::unique_ptr<MetricsExporter>(
+        new MetricsExporter(std::move(options), registry, std::move(listener))
+    ));
+  }
+
+  void MetricsExporter::stop() {
+    if (!m_thread.joinable()) {
+      return;
+    }
+    m_thread.request_stop();
+    m_thread.join();
+
+    writeFile();
+    m_listener.close();
+  }
+
+  void MetricsExporter::run(const std::stop_token& stopToken) {
+    auto nextWrite = std::chrono::steady_clock::now();
+    while (!stopToken.stop_requested()) {
+      const auto now = std::chrono::steady_clock::now();
+      if (now >= nextWrite) {
+        writeFile();
+        nextWrite = now + m_options.interval;
+      }
+
+      const int fds[] = {m_listener.fd()};
+      if (waitReadable(fds, kPollTimeoutMs)[0]) {
+        serveClients();
+      }
+    }
+  }
+
+  void MetricsExporter::writeFile() const {
+    if (m_options.file.empty()) {
+      return;
+    }
+
+    // Scrapers must never observe a half-written file, so write aside and rename
+    auto staging = m_options.file;
+    staging += ".tmp";
+    {
+      std::ofstream file(staging, std::ios::binary | std::ios::trunc);
+      if (!file) {
+        return;
+      }
+      file << m_registry.prometheusText();
+      if (!file) {
+        return;
+      }
+    }
+    std::error_code error;
+    std::filesystem::rename(staging, m_options.file, error);
+  }
+
+  void MetricsExporter::serveClients() const {
+    // Blocking connections: a snapshot can outgrow the socket buffer
+    for (int client; (client = m_listener.accept(false)) >= 0;) {
+      sendAll(client, m_registry.prometheusText());
+      closeSocket(client);
+    }
+  }
+} // namespace kst::core
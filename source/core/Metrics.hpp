@@ -0,0 +1,244 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+
+#include "Result.hpp"
+#include "UnixSocket.hpp"
+
+namespace kst::core {
+
+  // Hot metrics are split into this many cache lines; threads are spread over
+  // them round-robin so concurrent updates rarely touch the same line
+  constexpr size_t kMetricShards = 8;
+
+  namespace detail {
+    auto metricShard() -> size_t;
+  } // namespace detail
+
+  /**
+   * @brief Monotonic count, e.g. submits or uploaded bytes
+   */
+  class Counter {
+  public:
+    void add(uint64_t amount = 1) {
+      m_shards[detail::metricShard()].value.fetch_add(amount, std::memory_order_relaxed);
+    }
+
+    auto value() const -> uint64_t;
+
+  private:
+    struct alignas(64) Shard {
+      std::atomic<uint64_t> value{0};
+    };
+
+    std::array<Shard, kMetricShards> m_shards;
+  };
+
+  /**
+   * @brief Last-written value, e.g. swapchain image count or queue depth
+   */
+  class Gauge {
+  public:
+    void set(double value) { m_value.store(value, std::memory_order_relaxed); }
+
+    void add(double delta) { m_value.fetch_add(delta, std::memory_order_relaxed); }
+
+    auto value() const -> double { return m_value.load(std::memory_order_relaxed); }
+
+  private:
+    std::atomic<double> m_value{0.0};
+  };
+
+  struct HistogramSnapshot;
+
+  /**
+   * @brief Log-linear histogram over non-negative integers (HDR style)
+   *
+   * Values below 16 get exact buckets; above that every power of two is split
+   * into 16 linear sub-buckets, so any recorded value is known to within 6.25%
+   * up to 2^44. Larger values land in the last bucket. Record integers in the
+   * finest unit you have (nanoseconds, bytes); exportScale converts them to the
+   * Prometheus base unit on export.
+   */
+  class Histogram {
+  public:
+    static constexpr uint32_t kSubBucketBits = 4;
+    static constexpr uint32_t kSubBuckets    = 1u << kSubBucketBits;
+    static constexpr uint32_t kMaxExponent   = 44;
+    static constexpr uint32_t kBucketCount   = (kMaxExponent - kSubBucketBits + 1) * kSubBuckets;
+
+    explicit Histogram(double exportScale = 1.0) : m_exportScale(exportScale) {}
+
+    void record(uint64_t value);
+
+    void recordDuration(std::chrono::nanoseconds duration) {
+      record(static_cast<uint64_t>(std::max<int64_t>(duration.count(), 0)));
+    }
+
+    auto snapshot() const -> HistogramSnapshot;
+
+    auto exportScale() const -> double { return m_exportScale; }
+
+    static auto bucketIndex(uint64_t value) -> uint32_t;
+
+    /**
+     * @brief Smallest value that maps to the bucket
+     */
+    static auto bucketLowerBound(uint32_t index) -> uint64_t;
+
+  private:
+    struct alignas(64) Shard {
+      std::atomic<uint64_t> count{0};
+      std::atomic<uint64_t> sum{0};
+      std::atomic<uint64_t> max{0};
+      std::array<std::atomic<uint64_t>, kBucketCount> buckets{};
+    };
+
+    double m_exportScale;
+    std::array<Shard, kMetricShards> m_shards;
+  };
+
+  struct HistogramSnapshot {
+    uint64_t count = 0;
+    uint64_t sum   = 0;
+    uint64_t max   = 0;
+    std::array<uint64_t, Histogram::kBucketCount> buckets{};
+
+    /**
+     * @brief Value at quantile q in [0, 1], to within the bucket width (6.25%)
+     */
+    auto quantile(double q) const -> uint64_t;
+  };
+
+  /**
+   * @brief Process-wide set of named metrics
+   *
+   * Registration takes a lock and is meant for startup or a function-local
+   * static; the returned references stay valid for the life of the registry
+   * and updating through them never locks. Registering the same name and
+   * labels again returns the existing metric.
+   *
+   * @code
+   * static auto& submits = MetricsRegistry::instance().counter(
+   *     "kst_queue_submits_total", "Command buffers submitted", "queue=\"graphics\"");
+   * submits.add();
+   * @endcode
+   */
+  class MetricsRegistry {
+  public:
+    static auto instance() -> MetricsRegistry&;
+
+    /**
+     * @param labels Prometheus label pairs without braces, e.g. queue="compute"
+     */
+    auto counter(std::string_view name, std::string_view help, std::string_view labels = {})
+        -> Counter&;
+
+    auto gauge(std::string_view name, std::string_view help, std::string_view labels = {})
+        -> Gauge&;
+
+    /**
+     * @brief Exported as a Prometheus summary with 0.5/0.9/0.99/0.999/1 quantiles
+     */
+    auto histogram(
+        std::string_view name,
+        std::string_view help,
+        std::string_view labels = {},
+        double exportScale      = 1.0
+    ) -> Histogram&;
+
+    /**
+     * @brief Renders every metric in the Prometheus text exposition format
+     */
+    auto prometheusText() const -> std::string;
+
+  private:
+    enum class MetricType : uint8_t {
+      Counter,
+      Gauge,
+      Histogram
+    };
+
+    struct Entry {
+      std::string name;
+      std::string help;
+      std::string labels;
+      MetricType type;
+      std::unique_ptr<Counter> counter;
+      std::unique_ptr<Gauge> gauge;
+      std::unique_ptr<Histogram> histogram;
+    };
+
+    auto findOrInsert(
+        std::string_view name,
+        std::string_view help,
+        std::string_view labels,
+        MetricType type
+    ) -> Entry&;
+
+    mutable std::mutex m_mutex;
+    // Keyed by name then labels, so one family's series are adjacent on export
+    std::map<std::pair<std::string, std::string>, Entry> m_entries;
+  };
+
+  struct MetricsExportOptions {
+    // Rewritten atomically every interval; empty disables file export
+    std::filesystem::path file;
+    // Every connection receives one fresh snapshot, then the socket is closed;
+    // empty disables it. Unix domain sockets are unavailable on Windows.
+    std::filesystem::path socketPath;
+    std::chrono::milliseconds interval{1000};
+  };
+
+  /**
+   * @brief Background thread that publishes a registry in Prometheus format
+   *
+   * A file target suits node_exporter's textfile collector; a socket target
+   * suits `socat - UNIX-CONNECT:<path>` or a scraping sidecar. Stopping (or
+   * destroying) the exporter writes one last snapshot and removes the socket.
+   */
+  class MetricsExporter {
+  public:
+    ~MetricsExporter();
+
+    MetricsExporter(const MetricsExporter&)                    = delete;
+    auto operator=(const MetricsExporter&) -> MetricsExporter& = delete;
+
+    static auto start(
+        MetricsExportOptions options,
+        MetricsRegistry& registry = MetricsRegistry::instance()
+    ) -> Result<std::unique_ptr<MetricsExporter>>;
+
+    void stop();
+
+  private:
+    MetricsExporter(
+        MetricsExportOptions options,
+        MetricsRegistry& registry,
+        UnixSocketListener listener
+    );
+
+    void run(const std::stop_token& stopToken);
+    void writeFile() const;
+    void serveClients() const;
+
+    MetricsExportOptions m_options;
+    MetricsRegistry& m_registry;
+    UnixSocketListener m_listener;
+    std::jthread m_thread;
+  };
+
+} // namespace kst::core
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <utility>
+
+namespace kst::core {
+
+  /**
+   * @brief Bounded lock-free queue for many producers and one consumer
+   *
+   * Every slot carries a sequence number (Vyukov's bounded queue): producers
+   * claim a position with a CAS on the tail and publish the slot by bumping its
+   * sequence, the consumer reads slots in position order. Nothing allocates
+   * after construction. Elements must be default constructible and movable.
+   */
+  template <typename T, size_t Capacity>
+  class MpscQueue {
+    static_assert(std::has_single_bit(Capacity), "Capacity must be a power of two");
+
+  public:
+    MpscQueue() {
+      for (size_t i = 0; i < Capacity; ++i) {
+        m_cells[i].sequence.store(i, std::memory_order_relaxed);
+      }
+    }
+
+    MpscQueue(const MpscQueue&)                    = delete;
+    auto operator=(const MpscQueue&) -> MpscQueue& = delete;
+
+    /**
+     * @brief Safe from any thread
+     *
+     * @return Position of the element in push order, starting at 0, or nullopt
+     * when the queue is full
+     */
+    auto tryPush(T&& value) -> std::optional<uint64_t> {
+      uint64_t position = m_tail.load(std::memory_order_relaxed);
+      Cell* cell        = nullptr;
+      for (;;) {
+        cell                    = &m_cells[position & kMask];
+        const uint64_t sequence = cell->sequence.load(std::memory_order_acquire);
+        const auto difference   = static_cast<int64_t>(sequence - position);
+        if (difference == 0) {
+          if (m_tail.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+            break;
+          }
+        } else if (difference < 0) {
+          return std::nullopt;
+        } else {
+          position = m_tail.load(std::memory_order_relaxed);
+        }
+      }
+      cell->value = std::move(value);
+      cell->sequence.store(position + 1, std::memory_order_release);
+      return position;
+    }
+
+    /**
+     * @brief Consumer thread only
+     */
+    auto tryPop() -> std::optional<T> {
+      Cell& cell = m_cells[m_head & kMask];
+      if (cell.sequence.load(std::memory_order_acquire) != m_head + 1) {
+        return std::nullopt;
+      }
+      std::optional<T> value = std::move(cell.value);
+      cell.sequence.store(m_head + Capacity, std::memory_order_release);
+      ++m_head;
+      return value;
+    }
+
+  private:
+    static constexpr uint64_t kMask = Capacity - 1;
+
+    struct alignas(64) Cell {
+      std::atomic<uint64_t> sequence;
+      T value{};
+    };
+
+    std::array<Cell, Capacity> m_cells;
+    alignas(64) std::atomic<uint64_t> m_tail{0};
+    alignas(64) uint64_t m_head = 0;
+  };
+
+} // namespace kst::core
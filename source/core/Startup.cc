@@ -0,0 +1,333 @@
+#include "Startup.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <deque>
+#include <exception>
+#include <fstream>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+
+#include <tracy/Tracy.hpp>
+
+#include "Logger.hpp"
+#include "Metrics.hpp"
+
+namespace kst::core {
+  namespace {
+    using Clock = std::chrono::steady_clock;
+
+    auto millisecondsSince(Clock::time_point begin) -> double {
+      return std::chrono::duration<double, std::milli>(Clock::now() - begin).count();
+    }
+
+    void appendJsonString(std::string& out, std::string_view text) {
+      out += '"';
+      for (const char c : text) {
+        if (c == '"' || c == '\\') {
+          out += '\\';
+        }
+        out += c;
+      }
+      out += '"';
+    }
+  } // namespace
+
+  auto StartupTimeline::wallMs() const -> double {
+    double first = 0.0;
+    double last  = 0.0;
+    bool any     = false;
+    for (const auto& stage : m_stages) {
+      if (stage.skipped) {
+        continue;
+      }
+      first = any ? std::min(first, stage.startMs) : stage.startMs;
+      last  = std::max(last, stage.endMs);
+      any   = true;
+    }
+    return last - first;
+  }
+
+  auto StartupTimeline::serialMs() const -> double {
+    double total = 0.0;
+    for (const auto& stage : m_stages) {
+      total += stage.endMs - stage.startMs;
+    }
+    return total;
+  }
+
+  void StartupTimeline::log() const {
+    auto stages = m_stages;
+    std::stable_sort(stages.begin(), stages.end(), [](const auto& lhs, const auto& rhs) {
+      return lhs.startMs < rhs.startMs;
+    });
+
+    for (const auto& stage : stages) {
+      if (stage.skipped) {
+        KST_CORE_INFO("  {:<24} skipped", stage.name);
+        continue;
+      }
+      KST_CORE_INFO(
+          "  {:<24} {:>8.2f} .. {:>8.2f} ms  ({:>7.2f} ms, thread {}){}",
+          stage.name,
+          stage.startMs,
+          stage.endMs,
+          stage.endMs - stage.startMs,
+          stage.thread,
+          stage.failed ? " FAILED" : ""
+      );
+    }
+
+    const double wall   = wallMs();
+    const double serial = serialMs();
+    KST_CORE_INFO(
+        "Startup took {:.2f} ms for {:.2f} ms of stages ({:.2f}x overlap)",
+        wall,
+        serial,
+        wall > 0.0 ? serial / wall : 1.0
+    );
+  }
+
+  auto StartupTimeline::writeChromeTrace(const std::filesystem::path& path) const -> Result<void> {
+    // Complete ("X") events in microseconds, one track per thread
+    std::string out = "{\"traceEvents\":[";
+    bool first      = true;
+    for (const auto& stage : m_stages) {
+      if (stage.skipped) {
+        continue;
+      }
+      if (!first) {
+        out += ',';
+      }
+      first = false;
+
+      char timing[96];
+      std::snprintf(
+          timing,
+          sizeof(timing),
+          ",\"ph\":\"X\",\"ts\":%.1f,\"dur\":%.1f,\"pid\":0,\"tid\":%u",
+          stage.startMs * 1000.0,
+          (stage.endMs - stage.startMs) * 1000.0,
+          stage.thread
+      );
+      out += "{\"name\":";
+      appendJsonString(out, stage.name);
+      out += ",\"cat\":\"startup\"";
+      out += timing;
+      if (stage.failed) {
+        out += ",\"args\":{\"failed\":true}";
+      }
+      out += '}';
+    }
+    out += "]}\n";
+
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file || !file.write(out.data(), static_cast<std::streamsize>(out.size()))) {
+      return Result<void>::error("can't write startup trace " + path.string());
+    }
+    return Result<void>::success();
+  }
+
+  void StartupGraph::add(
+      std::string name,
+      std::vector<std::string> dependencies,
+      Task task,
+      StartupThread thread
+  ) {
+    m_nodes.push_back({
+        .name         = std::move(name),
+        .dependencies = std::move(dependencies),
+        .task         = std::move(task),
+        .thread       = thread,
+    });
+  }
+
+  auto StartupGraph::run(uint32_t workerCount) -> Result<void> {
+    const size_t count = m_nodes.size();
+
+    // Resolve names and reject graphs that could never finish before anything runs
+    std::unordered_map<std::string_view, size_t> indices;
+    for (size_t i = 0; i < count; ++i) {
+      if (!indices.emplace(m_nodes[i].name, i).second) {
+        return Result<void>::error("startup stage " + m_nodes[i].name + " added twice");
+      }
+    }
+    std::vector<std::vector<size_t>> dependents(count);
+    std::vector<uint32_t> pending(count, 0);
+    for (size_t i = 0; i < count; ++i) {
+      for (const auto& dependency : m_nodes[i].dependencies) {
+        const auto iter = indices.find(dependency);
+        if (iter == indices.end()) {
+          return Result<void>::error(
+              "startup stage " + m_nodes[i].name + " depends on unknown stage " + dependency
+          );
+        }
+        dependents[iter->second].push_back(i);
+        ++pending[i];
+      }
+    }
+    {
+      auto remaining = pending;
+      std::vector<size_t> ready;
+      for (size_t i = 0; i < count; ++i) {
+        if (remaining[i] == 0) {
+          ready.push_back(i);
+        }
+      }
+      size_t visited = 0;
+      while (!ready.empty()) {
+        const size_t node = ready.back();
+        ready.pop_back();
+        ++visited;
+        for (const size_t dependent : dependents[node]) {
+          if (--remaining[dependent] == 0) {
+            ready.push_back(dependent);
+          }
+        }
+      }
+      if (visited != count) {
+        return Result<void>::error("startup stages have a dependency cycle");
+      }
+    }
+
+    auto& stages = m_timeline.m_stages;
+    stages.assign(count, {});
+    for (size_t i = 0; i < count; ++i) {
+      stages[i].name = m_nodes[i].name;
+    }
+
+    const auto anyStages = static_cast<uint32_t>(
+        std::count_if(m_nodes.begin(), m_nodes.end(), [](const Node& node) {
+          return node.thread == StartupThread::Any;
+        })
+    );
+    if (workerCount == kAutoWorkers) {
+      const uint32_t hardwareThreads = std::max(std::thread::hardware_concurrency(), 2u);
+      workerCount                    = std::min(hardwareThreads - 1, anyStages);
+    }
+
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::deque<size_t> readyMain;
+    std::deque<size_t> readyAny;
+    std::vector<bool> poisoned(count, false);
+    size_t unfinished = count;
+    std::string firstError;
+
+    // Without workers the caller takes Any stages as well
+    const auto enqueue = [&](size_t node) {
+      if (m_nodes[node].thread == StartupThread::Main || workerCount == 0) {
+        readyMain.push_back(node);
+      } else {
+        readyAny.push_back(node);
+      }
+    };
+    for (size_t i = 0; i < count; ++i) {
+      if (pending[i] == 0) {
+        enqueue(i);
+      }
+    }
+
+    // Expects the lock to be held; skipped stages cascade to their dependents
+    const std::function<void(size_t, bool)> finish = [&](size_t node, bool succeeded) {
+      for (const size_t dependent : dependents[node]) {
+        poisoned[dependent] = poisoned[dependent] || !succeeded;
+        if (--pending[dependent] != 0) {
+          continue;
+        }
+        if (poisoned[dependent]) {
+          stages[dependent].skipped = true;
+          finish(dependent, false);
+        } else {
+          enqueue(dependent);
+        }
+      }
+      --unfinished;
+    };
+
+    const auto begin   = Clock::now();
+    const auto execute = [&](size_t node, uint32_t thread) {
+      auto& stage = stages[node];
+      ZoneTransientN(zone, stage.name.c_str(), true);
+
+      stage.thread  = thread;
+      stage.startMs = millisecondsSince(begin);
+      Result<void> result;
+      try {
+        result = m_nodes[node].task();
+      } catch (const std::exception& e) {
+        result = Result<void>::error(e.what());
+      }
+      stage.endMs  = millisecondsSince(begin);
+      stage.failed = result.hasError();
+      if (stage.failed) {
+        KST_CORE_ERROR("Startup stage {} failed: {}", stage.name, result.error());
+      }
+
+      std::scoped_lock lock(mutex);
+      if (stage.failed && firstError.empty()) {
+        firstError = stage.name + ": " + result.error();
+      }
+      finish(node, !stage.failed);
+      wake.notify_all();
+    };
+
+    const auto takeStage = [&](std::deque<size_t>& queue) {
+      const size_t node = queue.front();
+      queue.pop_front();
+      return node;
+    };
+
+    {
+      std::vector<std::jthread> workers;
+      workers.reserve(workerCount);
+      for (uint32_t worker = 1; worker <= workerCount; ++worker) {
+        workers.emplace_back([&, worker] {
+          for (;;) {
+            std::unique_lock lock(mutex);
+            wake.wait(lock, [&] { return !readyAny.empty() || unfinished == 0; });
+            if (readyAny.empty()) {
+              return;
+            }
+            const size_t node = takeStage(readyAny);
+            lock.unlock();
+            execute(node, worker);
+          }
+        });
+      }
+
+      for (;;) {
+        std::unique_lock lock(mutex);
+        wake.wait(lock, [&] { return !readyMain.empty() || unfinished == 0; });
+        if (readyMain.empty()) {
+          break;
+        }
+        const size_t node = takeStage(readyMain);
+        lock.unlock();
+        execute(node, 0);
+      }
+    }
+
+    auto& metrics = MetricsRegistry::instance();
+    metrics.gauge("kst_startup_seconds", "Wall time of the last startup graph run")
+        .set(m_timeline.wallMs() / 1000.0);
+    for (const auto& stage : stages) {
+      metrics
+          .gauge(
+              "kst_startup_stage_seconds",
+              "Duration of each startup stage",
+              "stage=\"" + stage.name + "\""
+          )
+          .set((stage.endMs - stage.startMs) / 1000.0);
+    }
+
+    if (!firstError.empty()) {
+      return Result<void>::error(firstError);
+    }
+    return Result<void>::success();
+  }
+
+} // namespace kst::core
@@ -0,0 +1,125 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "Result.hpp"
+
+namespace kst::core {
+
+  enum class StartupThread : uint8_t {
+    Any,
+    // For APIs bound to the thread that called main(), e.g. GLFW windowing
+    Main
+  };
+
+  struct StartupStage {
+    std::string name;
+    // Milliseconds since StartupGraph::run() began
+    double startMs = 0.0;
+    double endMs   = 0.0;
+    // 0 is the main thread, workers count up from 1
+    uint32_t thread = 0;
+    // Never ran because a dependency failed
+    bool skipped = false;
+    bool failed  = false;
+  };
+
+  /**
+   * @brief When every startup stage ran, and on which thread
+   */
+  class StartupTimeline {
+  public:
+    auto stages() const -> const std::vector<StartupStage>& { return m_stages; }
+
+    /**
+     * @brief Wall time from the first stage starting to the last one ending
+     */
+    auto wallMs() const -> double;
+
+    /**
+     * @brief Summed stage durations, i.e. what a serial startup would take
+     */
+    auto serialMs() const -> double;
+
+    /**
+     * @brief Logs one line per stage plus the totals
+     */
+    void log() const;
+
+    /**
+     * @brief Writes the Chrome trace event format (chrome://tracing, Perfetto)
+     */
+    auto writeChromeTrace(const std::filesystem::path& path) const -> Result<void>;
+
+  private:
+    friend class StartupGraph;
+
+    std::vector<StartupStage> m_stages;
+  };
+
+  /**
+   * @brief Runs initialization stages concurrently in dependency order
+   *
+   * Stages are added with the names of the stages they need; run() starts
+   * each one as soon as its dependencies finished, on a small worker pool or,
+   * for StartupThread::Main stages, on the calling thread. With no workers the
+   * calling thread runs everything in dependency order, which is the serial
+   * baseline to compare timelines against.
+   *
+   * A stage fails by returning an error or throwing; stages depending on it
+   * are skipped, independent ones still finish so whatever they own is in a
+   * consistent state. Stages publish their results through captured
+   * references; a dependency guarantees the writes are visible.
+   *
+   * @code
+   * StartupGraph startup;
+   * startup.add("window", {}, createWindow, StartupThread::Main);
+   * startup.add("loader", {}, preloadVulkan);
+   * startup.add("device", {"window", "loader"}, createDevice);
+   * auto result = startup.run();
+   * startup.timeline().log();
+   * @endcode
+   */
+  class StartupGraph {
+  public:
+    using Task = std::function<Result<void>()>;
+
+    static constexpr uint32_t kAutoWorkers = ~0u;
+
+    void add(
+        std::string name,
+        std::vector<std::string> dependencies,
+        Task task,
+        StartupThread thread = StartupThread::Any
+    );
+
+    /**
+     * @brief Runs every stage; returns once all of them finished or were skipped
+     *
+     * @param workerCount Worker threads; kAutoWorkers picks one per hardware
+     *                    thread beyond the caller, capped at the number of Any
+     *                    stages, and 0 runs serially on the caller
+     * @return The first failure, or an unknown dependency or cycle (in which
+     *         case nothing ran)
+     */
+    auto run(uint32_t workerCount = kAutoWorkers) -> Result<void>;
+
+    auto timeline() const -> const StartupTimeline& { return m_timeline; }
+
+  private:
+    struct Node {
+      std::string name;
+      std::vector<std::string> dependencies;
+      Task task;
+      StartupThread thread = StartupThread::Any;
+    };
+
+    std::vector<Node> m_nodes;
+    StartupTimeline m_timeline;
+  };
+
+} // namespace kst::core
@@ -0,0 +1,306 @@
+#include "StateArena.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+#include "Metrics.hpp"
+
+#if defined(_WIN32)
+#  define WIN32_LEAN_AND_MEAN
+#  define NOMINMAX
+#  include <windows.h>
+#else
+#  include <sys/mman.h>
+#endif
+
+namespace kst::core {
+  namespace {
+    constexpr size_t kWordsPerPage = StateArena::kPageSize / sizeof(uint64_t);
+
+    // Allocations start after the header so the cursor is part of the state
+    struct ArenaHeader {
+      uint64_t used;
+    };
+    constexpr size_t kFirstAllocation = 64;
+
+    // Zeroed, page-aligned and only backed by memory once touched
+    auto reserve(size_t size) -> std::byte* {
+#if defined(_WIN32)
+      void* memory = VirtualAlloc(nullptr, size, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+      if (memory == nullptr) {
+        throw std::bad_alloc();
+      }
+#else
+      void* memory =
+          ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+      if (memory == MAP_FAILED) {
+        throw std::bad_alloc();
+      }
+#endif
+      return static_cast<std::byte*>(memory);
+    }
+
+    void release(std::byte* memory, size_t size) {
+      if (memory == nullptr) {
+        return;
+      }
+#if defined(_WIN32)
+      (void)size;
+      VirtualFree(memory, 0, MEM_RELEASE);
+#else
+      ::munmap(memory, size);
+#endif
+    }
+
+    template <typename T>
+    void appendValue(std::vector<std::byte>& out, T value) {
+      const auto* bytes = reinterpret_cast<const std::byte*>(&value);
+      out.insert(out.end(), bytes, bytes + sizeof(T));
+    }
+
+    template <typename T>
+    auto readValue(const std::byte*& cursor) -> T {
+      T value;
+      std::memcpy(&value, cursor, sizeof(T));
+      cursor += sizeof(T);
+      return value;
+    }
+
+    // Worst case for encodePage: a run header per changed word
+    constexpr size_t kMaxEncodedPage = kWordsPerPage * (sizeof(uint64_t) + 2 * sizeof(uint16_t));
+
+    // XOR of a page against its previous contents as runs of
+    // (uint16 zero words, uint16 literal words, literal words...), bringing
+    // previous up to date on the way; returns the encoded size. out must hold
+    // kMaxEncodedPage bytes.
+    auto encodePage(std::byte* out, const uint64_t* current, uint64_t* previous) -> size_t {
+      std::byte* cursor = out;
+      const auto put    = [&cursor](auto value) {
+        std::memcpy(cursor, &value, sizeof(value));
+        cursor += sizeof(value);
+      };
+      size_t word = 0;
+      while (word < kWordsPerPage) {
+        const size_t zeroStart = word;
+        while (word < kWordsPerPage && current[word] == previous[word]) {
+          ++word;
+        }
+        if (word == kWordsPerPage) {
+          break;
+        }
+        const size_t literalStart = word;
+        while (word < kWordsPerPage && current[word] != previous[word]) {
+          ++word;
+        }
+        put(static_cast<uint16_t>(literalStart - zeroStart));
+        put(static_cast<uint16_t>(word - literalStart));
+        for (size_t i = literalStart; i < word; ++i) {
+          put(current[i] ^ previous[i]);
+          previous[i] = current[i];
+        }
+      }
+      return static_cast<size_t>(cursor - out);
+    }
+
+    // XORs an encoded page into every target; the same delta moves a page
+    // either way between its two states
+    void decodePage(
+        const std::byte* cursor,
+        const std::byte* end,
+        uint64_t* first,
+        uint64_t* second
+    ) {
+      size_t word = 0;
+      while (cursor < end) {
+        word += readValue<uint16_t>(cursor);
+        const auto literals = readValue<uint16_t>(cursor);
+        for (uint16_t i = 0; i < literals; ++i, ++word) {
+          const auto bits = readValue<uint64_t>(cursor);
+          first[word] ^= bits;
+          second[word] ^= bits;
+        }
+      }
+    }
+  } // namespace
+
+  StateArena::StateArena(size_t capacity, uint32_t snapshotCount)
+      : m_capacity((std::max(capacity, kPageSize) + kPageSize - 1) / kPageSize * kPageSize),
+        m_snapshotCount(std::max(snapshotCount, 1u)) {
+    m_base   = reserve(m_capacity);
+    m_shadow = reserve(m_capacity);
+    m_dirtyBits.resize((m_capacity / kPageSize + 63) / 64);
+    m_scratch.resize(kMaxEncodedPage);
+
+    // The shadow starts with the same header as the arena, so a snapshot
+    // taken right away is empty
+    auto* header = reinterpret_cast<ArenaHeader*>(m_base);
+    header->used = kFirstAllocation;
+    std::memcpy(m_shadow, m_base, sizeof(ArenaHeader));
+
+    m_snapshotBytes = &MetricsRegistry::instance().histogram(
+        "kst_state_snapshot_bytes", "Encoded size of each state arena snapshot"
+    );
+  }
+
+  StateArena::~StateArena() {
+    release(m_base, m_capacity);
+    release(m_shadow, m_capacity);
+  }
+
+  auto StateArena::usedBytes() const -> size_t {
+    return reinterpret_cast<const ArenaHeader*>(m_base)->used;
+  }
+
+  auto StateArena::allocate(size_t size, size_t alignment) -> void* {
+    auto* header       = reinterpret_cast<ArenaHeader*>(m_base);
+    const size_t start = (header->used + alignment - 1) / alignment * alignment;
+    if (start + size > m_capacity || start + size < start) {
+      throw std::bad_alloc();
+    }
+
+    // Memory freed by reset() or a restore may still hold old bytes
+    std::memset(m_base + start, 0, size);
+    markDirty(m_base + start, size);
+    markDirty(header, sizeof(ArenaHeader));
+    header->used = start + size;
+    return m_base + start;
+  }
+
+  void StateArena::markDirty(const void* address, size_t size) {
+    if (size == 0) {
+      return;
+    }
+    const auto offset = static_cast<size_t>(static_cast<const std::byte*>(address) - m_base);
+    for (size_t page = offset / kPageSize; page <= (offset + size - 1) / kPageSize; ++page) {
+      markPage(page);
+    }
+  }
+
+  void StateArena::markPage(size_t page) {
+    auto& word      = m_dirtyBits[page / 64];
+    const auto mask = uint64_t{1} << (page % 64);
+    if ((word & mask) == 0) {
+      word |= mask;
+      m_dirtyPages.push_back(static_cast<uint32_t>(page));
+    }
+  }
+
+  void StateArena::reset() {
+    auto* header = reinterpret_cast<ArenaHeader*>(m_base);
+    markDirty(header, sizeof(ArenaHeader));
+    header->used = kFirstAllocation;
+  }
+
+  auto StateArena::snapshot() -> uint64_t {
+    Delta delta;
+    if (!m_spareDeltas.empty()) {
+      delta = std::move(m_spareDeltas.back());
+      m_spareDeltas.pop_back();
+      delta.data.clear();
+    }
+    delta.id = ++m_latestId;
+
+    // Sorted so restores walk memory forwards. Only changed words are written
+    // to the shadow, so the cost is reading the dirty pages twice.
+    std::sort(m_dirtyPages.begin(), m_dirtyPages.end());
+    for (const uint32_t page : m_dirtyPages) {
+      auto* current  = reinterpret_cast<uint64_t*>(m_base + page * kPageSize);
+      auto* previous = reinterpret_cast<uint64_t*>(m_shadow + page * kPageSize);
+
+      const auto encoded = static_cast<uint32_t>(encodePage(m_scratch.data(), current, previous));
+      if (encoded != 0) {
+        appendValue(delta.data, page);
+        appendValue(delta.data, encoded);
+        delta.data.insert(delta.data.end(), m_scratch.begin(), m_scratch.begin() + encoded);
+      }
+
+      m_dirtyBits[page / 64] &= ~(uint64_t{1} << (page % 64));
+    }
+    m_dirtyPages.clear();
+    m_snapshotBytes->record(delta.data.size());
+
+    // Deltas lead from one snapshot to the next, so the ring holds one fewer
+    // than it keeps snapshots; the oldest delta's base state is dropped with it
+    m_deltas.push_back(std::move(delta));
+    if (m_deltas.size() >= m_snapshotCount) {
+      m_spareDeltas.push_back(std::move(m_deltas.front()));
+      m_deltas.pop_front();
+    }
+    return m_latestId;
+  }
+
+  auto StateArena::hasSnapshot(uint64_t id) const -> bool {
+    return id != 0 && id <= m_latestId && id + m_deltas.size() >= m_latestId;
+  }
+
+  auto StateArena::restore(uint64_t id) -> bool {
+    if (!hasSnapshot(id)) {
+      return false;
+    }
+
+    revertDirtyPages();
+    while (m_latestId > id) {
+      applyDelta(m_deltas.back());
+      m_spareDeltas.push_back(std::move(m_deltas.back()));
+      m_deltas.pop_back();
+      --m_latestId;
+    }
+    return true;
+  }
+
+  void StateArena::revertDirtyPages() {
+    for (const uint32_t page : m_dirtyPages) {
+      std::memcpy(m_base + page * kPageSize, m_shadow + page * kPageSize, kPageSize);
+      m_dirtyBits[page / 64] &= ~(uint64_t{1} << (page % 64));
+    }
+    m_dirtyPages.clear();
+  }
+
+  void StateArena::applyDelta(const Delta& delta) {
+    const std::byte* cursor = delta.data.data();
+    const std::byte* end    = cursor + delta.data.size();
+    while (cursor < end) {
+      const auto page    = readValue<uint32_t>(cursor);
+      const auto encoded = readValue<uint32_t>(cursor);
+      decodePage(
+          cursor,
+          cursor + encoded,
+          reinterpret_cast<uint64_t*>(m_base + page * kPageSize),
+          reinterpret_cast<uint64_t*>(m_shadow + page * kPageSize)
+      );
+      cursor += encoded;
+    }
+  }
+
+  auto StateArena::capture() const -> StateSnapshot {
+    StateSnapshot snapshot;
+    snapshot.bytes.assign(m_base, m_base + usedBytes());
+    return snapshot;
+  }
+
+  void StateArena::restore(const StateSnapshot& snapshot) {
+    if (snapshot.bytes.size() < kFirstAllocation) {
+      reset();
+      return;
+    }
+    const size_t used     = usedBytes();
+    const size_t restored = std::min(snapshot.bytes.size(), m_capacity);
+    std::memcpy(m_base, snapshot.bytes.data(), restored);
+    markDirty(m_base, restored);
+    // Allocations made after the capture are released; clear them so the
+    // arena matches what a fresh run would have
+    if (used > restored) {
+      std::memset(m_base + restored, 0, used - restored);
+      markDirty(m_base + restored, used - restored);
+    }
+  }
+
+  auto StateArena::snapshotBytes() const -> size_t {
+    size_t total = 0;
+    for (const auto& delta : m_deltas) {
+      total += delta.data.size();
+    }
+    return total;
+  }
+} // namespace kst::core
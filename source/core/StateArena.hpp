@@ -0,0 +1,165 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <new>
+#include <span>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace kst::core {
+  class Histogram;
+
+  /**
+   * @brief Full copy of a StateArena, e.g. the state at level start
+   */
+  struct StateSnapshot {
+    std::vector<std::byte> bytes;
+  };
+
+  /**
+   * @brief Simulation state in one contiguous block that can snapshot itself
+   *
+   * Layers allocate their state here instead of on the heap. Everything in the
+   * arena must be trivially copyable and may only point into the arena itself:
+   * the block never moves, so such pointers stay valid across restores.
+   *
+   * Writes have to be announced with write() or markDirty(); the arena tracks
+   * dirty pages from that. snapshot() then stores, per dirty page, the XOR
+   * against the page at the previous snapshot with zero runs elided, which for
+   * a page where a few objects moved is a few hundred bytes. A ring keeps the
+   * latest snapshots; restore() walks the deltas back to any of them, touching
+   * only pages that changed since. capture() and restore(StateSnapshot) copy
+   * the whole used range for points further back than the ring.
+   *
+   * The allocation cursor lives inside the arena, so restoring also undoes
+   * allocations. Not thread safe.
+   *
+   * @code
+   * auto* player = arena.create<PlayerState>();
+   * arena.write(player).health -= damage;
+   * const uint64_t frame = arena.snapshot();
+   * ...
+   * arena.restore(frame); // rollback
+   * @endcode
+   */
+  class StateArena {
+  public:
+    static constexpr size_t kPageSize = 4096;
+
+    /**
+     * @param capacity Bytes reserved up front; pages are committed on first touch
+     * @param snapshotCount Snapshots the ring keeps before dropping the oldest
+     */
+    explicit StateArena(size_t capacity, uint32_t snapshotCount = 8);
+    ~StateArena();
+
+    StateArena(const StateArena&)                    = delete;
+    auto operator=(const StateArena&) -> StateArena& = delete;
+
+    /**
+     * @brief Zeroed, dirty memory; throws std::bad_alloc when the arena is full
+     */
+    auto allocate(size_t size, size_t alignment = alignof(std::max_align_t)) -> void*;
+
+    template <typename T, typename... Args>
+    auto create(Args&&... args) -> T* {
+      static_assert(std::is_trivially_copyable_v<T>, "arena state is copied bytewise");
+      return new (allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+    }
+
+    template <typename T>
+    auto createArray(size_t count) -> std::span<T> {
+      static_assert(std::is_trivially_copyable_v<T>, "arena state is copied bytewise");
+      auto* data = static_cast<T*>(allocate(sizeof(T) * count, alignof(T)));
+      for (size_t i = 0; i < count; ++i) {
+        new (data + i) T();
+      }
+      return {data, count};
+    }
+
+    /**
+     * @brief Marks an object's pages dirty and returns it for writing
+     */
+    template <typename T>
+    auto write(T* object) -> T& {
+      markDirty(object, sizeof(T));
+      return *object;
+    }
+
+    template <typename T>
+    auto write(std::span<T> objects) -> std::span<T> {
+      markDirty(objects.data(), objects.size_bytes());
+      return objects;
+    }
+
+    void markDirty(const void* address, size_t size);
+
+    /**
+     * @brief Frees every allocation; snapshots are kept
+     */
+    void reset();
+
+    /**
+     * @brief Records the current state in the ring
+     *
+     * @return Id to pass to restore(); ids increase by one per snapshot
+     */
+    auto snapshot() -> uint64_t;
+
+    /**
+     * @brief Returns to a snapshot still in the ring, dropping newer ones
+     *
+     * Unsnapshotted writes are discarded too. False when id left the ring.
+     */
+    auto restore(uint64_t id) -> bool;
+
+    auto hasSnapshot(uint64_t id) const -> bool;
+
+    auto capture() const -> StateSnapshot;
+
+    /**
+     * @brief Overwrites the state with a capture; the ring stays usable
+     */
+    void restore(const StateSnapshot& snapshot);
+
+    auto usedBytes() const -> size_t;
+
+    auto capacity() const -> size_t { return m_capacity; }
+
+    auto dirtyPageCount() const -> size_t { return m_dirtyPages.size(); }
+
+    /**
+     * @brief Bytes held by the snapshot ring
+     */
+    auto snapshotBytes() const -> size_t;
+
+  private:
+    struct Delta {
+      uint64_t id = 0;
+      // Per page: uint32 page index, uint32 encoded bytes, then the encoding
+      std::vector<std::byte> data;
+    };
+
+    void markPage(size_t page);
+    void revertDirtyPages();
+    void applyDelta(const Delta& delta);
+
+    std::byte* m_base   = nullptr;
+    std::byte* m_shadow = nullptr; // the state at the latest snapshot
+    size_t m_capacity   = 0;
+    uint32_t m_snapshotCount;
+
+    std::vector<uint64_t> m_dirtyBits;
+    std::vector<uint32_t> m_dirtyPages;
+
+    std::deque<Delta> m_deltas;
+    std::vector<Delta> m_spareDeltas; // dropped deltas, kept for their capacity
+    std::vector<std::byte> m_scratch; // one encoded page
+    uint64_t m_latestId = 0;
+
+    Histogram* m_snapshotBytes = nullptr;
+  };
+} // namespace kst::core
@@ -0,0 +1,154 @@
+#include "UnixSocket.hpp"
+
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <utility>
+
+#if !defined(_WIN32)
+#  include <fcntl.h>
+#  include <poll.h>
+#  include <sys/socket.h>
+#  include <sys/un.h>
+#  include <unistd.h>
+#endif
+
+namespace kst::core {
+
+  UnixSocketListener::~UnixSocketListener() {
+    close();
+  }
+
+  UnixSocketListener::UnixSocketListener(UnixSocketListener&& other) noexcept
+      : m_path(std::move(other.m_path)), m_fd(std::exchange(other.m_fd, -1)) {}
+
+  auto UnixSocketListener::operator=(UnixSocketListener&& other) noexcept
+      -> UnixSocketListener& {
+    if (this != &other) {
+      close();
+      m_path = std::move(other.m_path);
+      m_fd   = std::exchange(other.m_fd, -1);
+    }
+    return *this;
+  }
+
+  auto UnixSocketListener::listen(const std::filesystem::path& path)
+      -> Result<UnixSocketListener> {
+    using ListenResult = Result<UnixSocketListener>;
+
+    const auto text = path.string();
+#if defined(_WIN32)
+    return ListenResult::error("socket " + text + ": Unix domain sockets are unavailable");
+#else
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    if (text.size() >= sizeof(address.sun_path)) {
+      return ListenResult::error("socket path too long: " + text);
+    }
+    std::memcpy(address.sun_path, text.c_str(), text.size() + 1);
+
+    UnixSocketListener listener;
+    listener.m_fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listener.m_fd < 0) {
+      return ListenResult::error("socket " + text + ": " + std::strerror(errno));
+    }
+    // A stale socket from a crashed run would make bind fail
+    ::unlink(text.c_str());
+    if (::bind(listener.m_fd, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) !=
+        0) {
+      return ListenResult::error("socket " + text + ": " + std::strerror(errno));
+    }
+    // The file exists from here on, so close() has to remove it
+    listener.m_path = path;
+    if (::listen(listener.m_fd, 4) != 0) {
+      return ListenResult::error("socket " + text + ": " + std::strerror(errno));
+    }
+    ::fcntl(listener.m_fd, F_SETFD, FD_CLOEXEC);
+    ::fcntl(listener.m_fd, F_SETFL, ::fcntl(listener.m_fd, F_GETFL) | O_NONBLOCK);
+    return ListenResult::success(std::move(listener));
+#endif
+  }
+
+  auto UnixSocketListener::accept(bool nonBlocking) const -> int {
+#if defined(_WIN32)
+    return -1;
+#else
+    if (m_fd < 0) {
+      return -1;
+    }
+    const int client = ::accept(m_fd, nullptr, nullptr);
+    if (client >= 0) {
+      ::fcntl(client, F_SETFD, FD_CLOEXEC);
+      if (nonBlocking) {
+        ::fcntl(client, F_SETFL, ::fcntl(client, F_GETFL) | O_NONBLOCK);
+      }
+    }
+    return client;
+#endif
+  }
+
+  void UnixSocketListener::close() {
+    if (m_fd < 0) {
+      return;
+    }
+#if !defined(_WIN32)
+    ::close(m_fd);
+    if (!m_path.empty()) {
+      ::unlink(m_path.c_str());
+    }
+#endif
+    m_fd = -1;
+    m_path.clear();
+  }
+
+  auto waitReadable(std::span<const int> fds, int timeoutMs) -> std::vector<bool> {
+    std::vector<bool> ready(fds.size(), false);
+#if defined(_WIN32)
+    std::this_thread::sleep_for(std::chrono::milliseconds(timeoutMs));
+#else
+    std::vector<pollfd> polled;
+    polled.reserve(fds.size());
+    for (const int fd : fds) {
+      polled.push_back({.fd = fd, .events = POLLIN, .revents = 0});
+    }
+    if (::poll(polled.data(), polled.size(), timeoutMs) > 0) {
+      for (size_t i = 0; i < polled.size(); ++i) {
+        ready[i] = polled[i].revents != 0;
+      }
+    }
+#endif
+    return ready;
+  }
+
+  auto sendAll(int fd, std::string_view text) -> bool {
+#if defined(_WIN32)
+    return false;
+#else
+#  if defined(MSG_NOSIGNAL)
+    constexpr int kSendFlags = MSG_NOSIGNAL;
+#  else
+    constexpr int kSendFlags = 0;
+#  endif
+    size_t written = 0;
+    while (written < text.size()) {
+      const auto sent = ::send(fd, text.data() + written, text.size() - written, kSendFlags);
+      if (sent <= 0) {
+        return false;
+      }
+      written += static_cast<size_t>(sent);
+    }
+    return true;
+#endif
+  }
+
+  void closeSocket(int fd) {
+#if !defined(_WIN32)
+    if (fd >= 0) {
+      ::close(fd);
+    }
+#endif
+  }
+
+} // namespace kst::core
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <filesystem>
+#include <span>
+#include <string_view>
+#include <vector>
+
+#include "Result.hpp"
+
+namespace kst::core {
+
+  /**
+   * @brief Listening Unix domain socket for the core's local text servers
+   *
+   * Owns the socket file: one left behind by a crashed run is replaced when
+   * listening starts, and close() removes the path again. The listener is
+   * non-blocking, so accept() drains waiting connections without stalling,
+   * and every descriptor is close-on-exec. Unix domain sockets are
+   * unavailable on Windows, where listen() always fails.
+   */
+  class UnixSocketListener {
+  public:
+    UnixSocketListener() = default;
+    ~UnixSocketListener();
+
+    UnixSocketListener(UnixSocketListener&& other) noexcept;
+    auto operator=(UnixSocketListener&& other) noexcept -> UnixSocketListener&;
+
+    UnixSocketListener(const UnixSocketListener&)                    = delete;
+    auto operator=(const UnixSocketListener&) -> UnixSocketListener& = delete;
+
+    static auto listen(const std::filesystem::path& path) -> Result<UnixSocketListener>;
+
+    /**
+     * @brief Descriptor to poll for waiting connections; -1 when closed
+     */
+    auto fd() const -> int { return m_fd; }
+
+    /**
+     * @brief Next waiting connection, or -1 once there is none
+     * @param nonBlocking Whether reads and writes on the connection return instead of waiting
+     */
+    auto accept(bool nonBlocking) const -> int;
+
+    void close();
+
+  private:
+    std::filesystem::path m_path;
+    int m_fd = -1;
+  };
+
+  /**
+   * @brief Waits up to timeoutMs for input on any of the descriptors
+   *
+   * Returns, per descriptor, whether it is readable or was hung up on;
+   * negative descriptors are skipped and never ready. Sleeps out the timeout
+   * on Windows.
+   */
+  auto waitReadable(std::span<const int> fds, int timeoutMs) -> std::vector<bool>;
+
+  /**
+   * @brief Writes all of text to a connection; false if it stopped short
+   *
+   * Never raises SIGPIPE. On a non-blocking connection a full send buffer
+   * stops the write as well.
+   */
+  auto sendAll(int fd, std::string_view text) -> bool;
+
+  void closeSocket(int fd);
+
+} // namespace kst::core
@@ -0,0 +1,68 @@
+#include "AnimationClip.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+namespace kst::renderer {
+  namespace {
+    struct KeySpan {
+      size_t first;
+      size_t second;
+      float alpha;
+    };
+
+    auto findKeys(const std::vector<float>& times, float time) -> KeySpan {
+      if (times.size() == 1 || time <= times.front()) {
+        return {0, 0, 0.0f};
+      }
+      if (time >= times.back()) {
+        return {times.size() - 1, times.size() - 1, 0.0f};
+      }
+
+      const auto upper    = std::upper_bound(times.begin(), times.end(), time);
+      const size_t second = static_cast<size_t>(upper - times.begin());
+      const size_t first  = second - 1;
+      const float span    = times[second] - times[first];
+      return {first, second, span > 0.0f ? (time - times[first]) / span : 0.0f};
+    }
+  } // namespace
+
+  AnimationClip::AnimationClip(std::string name, float duration, std::vector<JointTrack> tracks)
+      : m_name(std::move(name)), m_duration(duration), m_tracks(std::move(tracks)) {}
+
+  void AnimationClip::sample(float time, bool loop, Pose& pose) const {
+    if (m_duration > 0.0f) {
+      time = loop ? std::fmod(time, m_duration) : std::clamp(time, 0.0f, m_duration);
+      if (time < 0.0f) {
+        time += m_duration;
+      }
+    }
+
+    const size_t jointCount = std::min<size_t>(m_tracks.size(), pose.jointCount);
+    for (size_t joint = 0; joint < jointCount; ++joint) {
+      const JointTrack& track = m_tracks[joint];
+      const auto index        = static_cast<uint32_t>(joint);
+
+      if (!track.translations.empty()) {
+        const KeySpan keys = findKeys(track.translationTimes, time);
+        pose.setTranslation(
+            index,
+            glm::mix(track.translations[keys.first], track.translations[keys.second], keys.alpha)
+        );
+      }
+      if (!track.rotations.empty()) {
+        const KeySpan keys = findKeys(track.rotationTimes, time);
+        pose.setRotation(
+            index, glm::slerp(track.rotations[keys.first], track.rotations[keys.second], keys.alpha)
+        );
+      }
+      if (!track.scales.empty()) {
+        const KeySpan keys = findKeys(track.scaleTimes, time);
+        pose.setScale(
+            index, glm::mix(track.scales[keys.first], track.scales[keys.second], keys.alpha)
+        );
+      }
+    }
+  }
+} // namespace kst::renderer
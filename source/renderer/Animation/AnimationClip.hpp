@@ -0,0 +1,57 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include "Pose.hpp"
+
+namespace kst::renderer {
+  /**
+   * @brief Keyframes for one joint; times are in seconds and sorted ascending
+   *
+   * Any of the three channels may be empty, in which case sampling leaves that
+   * component of the pose untouched.
+   */
+  struct JointTrack {
+    std::vector<float> translationTimes;
+    std::vector<glm::vec3> translations;
+    std::vector<float> rotationTimes;
+    std::vector<glm::quat> rotations;
+    std::vector<float> scaleTimes;
+    std::vector<glm::vec3> scales;
+  };
+
+  class AnimationClip {
+  public:
+    /**
+     * @brief Creates a clip from per-joint tracks
+     * @param name Clip name, usually the source animation name
+     * @param duration Length in seconds
+     * @param tracks One track per skeleton joint, indexed by joint
+     */
+    AnimationClip(std::string name, float duration, std::vector<JointTrack> tracks);
+
+    /**
+     * @brief Samples the clip into a local-space pose
+     * @param time Time in seconds, wrapped when looping and clamped otherwise
+     * @param loop Whether time wraps around the clip duration
+     * @param pose Destination; joints without keys keep their existing values,
+     *             so callers initialise it from the skeleton's rest pose
+     */
+    void sample(float time, bool loop, Pose& pose) const;
+
+    auto name() const -> const std::string& { return m_name; }
+
+    auto duration() const -> float { return m_duration; }
+
+    auto trackCount() const -> size_t { return m_tracks.size(); }
+
+  private:
+    std::string m_name;
+    float m_duration = 0.0f;
+    std::vector<JointTrack> m_tracks;
+  };
+} // namespace kst::renderer
@@ -0,0 +1,235 @@
+#include "AnimationSystem.hpp"
+
+#include <algorithm>
+#include <utility>
+
+#include <tracy/Tracy.hpp>
+
+#include "VulkanBackend/VulkanCore/Utility.hpp"
+
+namespace kst::renderer {
+  namespace {
+    // Small enough to balance skeletons of very different sizes, large
+    // enough that the shared counter isn't contended.
+    constexpr uint32_t kInstancesPerBatch = 8;
+  } // namespace
+
+  AnimationSystem::AnimationSystem(uint32_t workerCount) : m_scratch(workerCount + 1) {
+    m_workers.reserve(workerCount);
+    for (uint32_t i = 0; i < workerCount; ++i) {
+      m_workers.emplace_back(&AnimationSystem::workerLoop, this, i);
+    }
+  }
+
+  AnimationSystem::~AnimationSystem() {
+    {
+      const std::lock_guard<std::mutex> lock(m_mutex);
+      m_stopping = true;
+    }
+    m_wakeCondition.notify_all();
+
+    for (auto& worker : m_workers) {
+      worker.join();
+    }
+  }
+
+  auto AnimationSystem::defaultWorkerCount() -> uint32_t {
+    const uint32_t hardwareThreads = std::thread::hardware_concurrency();
+    return hardwareThreads > 1 ? hardwareThreads - 1 : 0;
+  }
+
+  auto AnimationSystem::createInstance(std::shared_ptr<const Skeleton> skeleton)
+      -> InstanceHandle {
+    ASSERT(skeleton, "AnimationSystem instances need a skeleton");
+    const uint32_t jointCount = skeleton->jointCount();
+
+    // Reuse a freed slot whose palette range is large enough, otherwise grow.
+    const auto reusable = std::find_if(
+        m_freeInstances.begin(),
+        m_freeInstances.end(),
+        [&](InstanceHandle handle) { return m_instances[handle].paletteCapacity >= jointCount; }
+    );
+
+    InstanceHandle handle = kInvalidInstance;
+    if (reusable != m_freeInstances.end()) {
+      handle = *reusable;
+      m_freeInstances.erase(reusable);
+    } else {
+      handle = static_cast<InstanceHandle>(m_instances.size());
+
+      Instance& instance       = m_instances.emplace_back();
+      instance.paletteOffset   = m_paletteSize;
+      instance.paletteCapacity = jointCount;
+      m_paletteSize += jointCount;
+    }
+
+    Instance& instance = m_instances[handle];
+    instance.skeleton      = std::move(skeleton);
+    instance.current       = {};
+    instance.previous      = {};
+    instance.blendTime     = 0.0f;
+    instance.blendDuration = 0.0f;
+    instance.speed         = 1.0f;
+    instance.alive         = true;
+    return handle;
+  }
+
+  void AnimationSystem::destroyInstance(InstanceHandle instance) {
+    ASSERT(
+        instance < m_instances.size() && m_instances[instance].alive,
+        "AnimationSystem instance was never created or already destroyed"
+    );
+    m_instances[instance].alive = false;
+    m_instances[instance].skeleton.reset();
+    m_instances[instance].current  = {};
+    m_instances[instance].previous = {};
+    m_freeInstances.push_back(instance);
+  }
+
+  void AnimationSystem::play(
+      InstanceHandle instance,
+      std::shared_ptr<const AnimationClip> clip,
+      float blendDuration,
+      bool loop
+  ) {
+    Instance& target = m_instances[instance];
+
+    if (blendDuration > 0.0f && target.current.clip) {
+      target.previous      = std::move(target.current);
+      target.blendTime     = 0.0f;
+      target.blendDuration = blendDuration;
+    } else {
+      target.previous      = {};
+      target.blendDuration = 0.0f;
+    }
+    target.current = PlaybackLayer{.clip = std::move(clip), .time = 0.0f, .loop = loop};
+  }
+
+  void AnimationSystem::setSpeed(InstanceHandle instance, float speed) {
+    m_instances[instance].speed = speed;
+  }
+
+  auto AnimationSystem::paletteOffset(InstanceHandle instance) const -> uint32_t {
+    return m_instances[instance].paletteOffset;
+  }
+
+  void AnimationSystem::update(float deltaTime, std::span<SkinningMatrix> palette) {
+    ZoneScopedN("AnimationSystem: update");
+    ASSERT(palette.size() >= m_paletteSize, "Palette is too small for all instances");
+
+    m_deltaTime    = deltaTime;
+    m_framePalette = palette.data();
+    m_nextInstance.store(0, std::memory_order_relaxed);
+
+    if (!m_workers.empty()) {
+      {
+        const std::lock_guard<std::mutex> lock(m_mutex);
+        m_activeWorkers = static_cast<uint32_t>(m_workers.size());
+        ++m_generation;
+      }
+      m_wakeCondition.notify_all();
+    }
+
+    processInstances(static_cast<uint32_t>(m_workers.size()));
+
+    if (!m_workers.empty()) {
+      std::unique_lock<std::mutex> lock(m_mutex);
+      m_doneCondition.wait(lock, [this] { return m_activeWorkers == 0; });
+    }
+  }
+
+  void AnimationSystem::workerLoop(uint32_t workerIndex) {
+    uint64_t seenGeneration = 0;
+
+    while (true) {
+      {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_wakeCondition.wait(lock, [&] {
+          return m_stopping || m_generation != seenGeneration;
+        });
+        if (m_stopping) {
+          return;
+        }
+        seenGeneration = m_generation;
+      }
+
+      processInstances(workerIndex);
+
+      {
+        const std::lock_guard<std::mutex> lock(m_mutex);
+        if (--m_activeWorkers == 0) {
+          m_doneCondition.notify_one();
+        }
+      }
+    }
+  }
+
+  void AnimationSystem::processInstances(uint32_t workerIndex) {
+    ZoneScopedN("AnimationSystem: sample batch");
+    WorkerScratch& scratch   = m_scratch[workerIndex];
+    const auto instanceCount = static_cast<uint32_t>(m_instances.size());
+
+    while (true) {
+      const uint32_t begin =
+          m_nextInstance.fetch_add(kInstancesPerBatch, std::memory_order_relaxed);
+      if (begin >= instanceCount) {
+        return;
+      }
+
+      const uint32_t end = std::min(begin + kInstancesPerBatch, instanceCount);
+      for (uint32_t i = begin; i < end; ++i) {
+        if (m_instances[i].alive) {
+          evaluateInstance(m_instances[i], scratch);
+        }
+      }
+    }
+  }
+
+  void AnimationSystem::evaluateInstance(Instance& instance, WorkerScratch& scratch) {
+    const Skeleton& skeleton  = *instance.skeleton;
+    const uint32_t jointCount = skeleton.jointCount();
+    const float step          = m_deltaTime * instance.speed;
+
+    // Copy-assignment reuses the scratch streams' storage once warmed up.
+    scratch.current = skeleton.restPose;
+    if (instance.current.clip) {
+      instance.current.time += step;
+      instance.current.clip->sample(instance.current.time, instance.current.loop, scratch.current);
+    }
+
+    if (instance.previous.clip) {
+      instance.previous.time += step;
+      instance.blendTime += m_deltaTime;
+
+      if (instance.blendTime >= instance.blendDuration) {
+        instance.previous = {};
+      } else {
+        scratch.previous = skeleton.restPose;
+        instance.previous.clip->sample(
+            instance.previous.time, instance.previous.loop, scratch.previous
+        );
+        blendPoses(
+            scratch.previous,
+            scratch.current,
+            instance.blendTime / instance.blendDuration,
+            scratch.current
+        );
+      }
+    }
+
+    scratch.modelSpace.resize(jointCount);
+    SkinningMatrix* palette = m_framePalette + instance.paletteOffset;
+
+    for (uint32_t joint = 0; joint < jointCount; ++joint) {
+      const glm::mat4 local     = scratch.current.localMatrix(joint);
+      const int32_t parent      = skeleton.parents[joint];
+      scratch.modelSpace[joint] = parent < 0 ? local : scratch.modelSpace[parent] * local;
+
+      const glm::mat4 skin = scratch.modelSpace[joint] * skeleton.inverseBindMatrices[joint];
+      for (int row = 0; row < 3; ++row) {
+        palette[joint].rows[row] =
+            glm::vec4(skin[0][row], skin[1][row], skin[2][row], skin[3][row]);
+      }
+    }
+  }
+} // namespace kst::renderer
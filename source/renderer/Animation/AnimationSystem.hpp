@@ -0,0 +1,141 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <thread>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "AnimationClip.hpp"
+#include "Pose.hpp"
+#include "Skeleton.hpp"
+
+namespace kst::renderer {
+  /**
+   * @brief Samples, blends and resolves skinning palettes for animated instances
+   *
+   * Instances are evaluated in parallel on a small pool of persistent worker
+   * threads (the calling thread participates too). Each instance owns a fixed
+   * range of the palette, so workers write their results straight into the
+   * destination - typically a persistently mapped GPU buffer - without any
+   * synchronisation beyond the end-of-update join.
+   */
+  class AnimationSystem {
+  public:
+    using InstanceHandle = uint32_t;
+    static constexpr InstanceHandle kInvalidInstance = UINT32_MAX;
+
+    /**
+     * @brief Creates the system and spawns its worker threads
+     * @param workerCount Additional threads besides the caller; 0 runs everything inline
+     */
+    explicit AnimationSystem(uint32_t workerCount = defaultWorkerCount());
+    ~AnimationSystem();
+
+    AnimationSystem(const AnimationSystem&)                    = delete;
+    auto operator=(const AnimationSystem&) -> AnimationSystem& = delete;
+    AnimationSystem(AnimationSystem&&)                         = delete;
+    auto operator=(AnimationSystem&&) -> AnimationSystem&      = delete;
+
+    static auto defaultWorkerCount() -> uint32_t;
+
+    /**
+     * @brief Adds an animated instance of a skeleton
+     * @param skeleton Shared skeleton, must outlive the instance
+     * @return Handle used for playback control and palette lookup
+     */
+    auto createInstance(std::shared_ptr<const Skeleton> skeleton) -> InstanceHandle;
+
+    /**
+     * @brief Releases an instance; its palette range is reused by later instances
+     */
+    void destroyInstance(InstanceHandle instance);
+
+    /**
+     * @brief Starts playing a clip, cross-fading from the current one
+     * @param instance Target instance
+     * @param clip Clip to play, must target the instance's skeleton
+     * @param blendDuration Cross-fade length in seconds; 0 switches immediately
+     * @param loop Whether the clip wraps around
+     */
+    void play(
+        InstanceHandle instance,
+        std::shared_ptr<const AnimationClip> clip,
+        float blendDuration = 0.0f,
+        bool loop           = true
+    );
+
+    void setSpeed(InstanceHandle instance, float speed);
+
+    /**
+     * @brief First palette entry of an instance, in joints
+     */
+    auto paletteOffset(InstanceHandle instance) const -> uint32_t;
+
+    /**
+     * @brief Number of palette entries update() writes
+     */
+    auto paletteSize() const -> uint32_t { return m_paletteSize; }
+
+    /**
+     * @brief Advances playback and writes every instance's skinning matrices
+     * @param deltaTime Seconds since the last update
+     * @param palette Destination with at least paletteSize() entries
+     *
+     * Blocks until all workers are done.
+     */
+    void update(float deltaTime, std::span<SkinningMatrix> palette);
+
+  private:
+    struct PlaybackLayer {
+      std::shared_ptr<const AnimationClip> clip;
+      float time = 0.0f;
+      bool loop  = true;
+    };
+
+    struct Instance {
+      std::shared_ptr<const Skeleton> skeleton;
+      PlaybackLayer current;
+      PlaybackLayer previous;
+      float blendTime          = 0.0f;
+      float blendDuration      = 0.0f;
+      float speed              = 1.0f;
+      uint32_t paletteOffset   = 0;
+      uint32_t paletteCapacity = 0;
+      bool alive               = false;
+    };
+
+    // Per-thread scratch so sampling never allocates after warm-up.
+    struct WorkerScratch {
+      Pose current;
+      Pose previous;
+      std::vector<glm::mat4> modelSpace;
+    };
+
+    void workerLoop(uint32_t workerIndex);
+    void processInstances(uint32_t workerIndex);
+    void evaluateInstance(Instance& instance, WorkerScratch& scratch);
+
+    std::vector<Instance> m_instances;
+    std::vector<InstanceHandle> m_freeInstances;
+    uint32_t m_paletteSize = 0;
+
+    std::vector<WorkerScratch> m_scratch; // workers first, calling thread last
+    std::vector<std::thread> m_workers;
+    std::mutex m_mutex;
+    std::condition_variable m_wakeCondition;
+    std::condition_variable m_doneCondition;
+    uint64_t m_generation    = 0;
+    uint32_t m_activeWorkers = 0;
+    bool m_stopping          = false;
+
+    std::atomic<uint32_t> m_nextInstance{0};
+    float m_deltaTime              = 0.0f;
+    SkinningMatrix* m_framePalette = nullptr;
+  };
+} // namespace kst::renderer
@@ -0,0 +1,210 @@
+#include "Pose.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "VulkanBackend/VulkanCore/Utility.hpp"
+
+#if defined(__SSE2__) || defined(_M_X64)
+#define KST_POSE_SSE 1
+#include <emmintrin.h>
+#endif
+
+namespace kst::renderer {
+  void Pose::resize(uint32_t count) {
+    jointCount  = count;
+    paddedCount = (count + kLaneWidth - 1) / kLaneWidth * kLaneWidth;
+
+    for (auto& stream : translation) {
+      stream.assign(paddedCount, 0.0f);
+    }
+    for (auto& stream : rotation) {
+      stream.assign(paddedCount, 0.0f);
+    }
+    for (auto& stream : scale) {
+      stream.assign(paddedCount, 1.0f);
+    }
+    std::fill(rotation[3].begin(), rotation[3].end(), 1.0f);
+  }
+
+  void Pose::setIdentity() {
+    resize(jointCount);
+  }
+
+  void Pose::setJoint(
+      uint32_t joint,
+      const glm::vec3& jointTranslation,
+      const glm::quat& jointRotation,
+      const glm::vec3& jointScale
+  ) {
+    setTranslation(joint, jointTranslation);
+    setRotation(joint, jointRotation);
+    setScale(joint, jointScale);
+  }
+
+  void Pose::setTranslation(uint32_t joint, const glm::vec3& value) {
+    translation[0][joint] = value.x;
+    translation[1][joint] = value.y;
+    translation[2][joint] = value.z;
+  }
+
+  void Pose::setRotation(uint32_t joint, const glm::quat& value) {
+    rotation[0][joint] = value.x;
+    rotation[1][joint] = value.y;
+    rotation[2][joint] = value.z;
+    rotation[3][joint] = value.w;
+  }
+
+  void Pose::setScale(uint32_t joint, const glm::vec3& value) {
+    scale[0][joint] = value.x;
+    scale[1][joint] = value.y;
+    scale[2][joint] = value.z;
+  }
+
+  auto Pose::getTranslation(uint32_t joint) const -> glm::vec3 {
+    return {translation[0][joint], translation[1][joint], translation[2][joint]};
+  }
+
+  auto Pose::getRotation(uint32_t joint) const -> glm::quat {
+    // glm::quat's constructor takes w first
+    return {rotation[3][joint], rotation[0][joint], rotation[1][joint], rotation[2][joint]};
+  }
+
+  auto Pose::getScale(uint32_t joint) const -> glm::vec3 {
+    return {scale[0][joint], scale[1][joint], scale[2][joint]};
+  }
+
+  auto Pose::localMatrix(uint32_t joint) const -> glm::mat4 {
+    glm::mat4 matrix = glm::mat4_cast(getRotation(joint));
+    const glm::vec3 jointScale = getScale(joint);
+    matrix[0] *= jointScale.x;
+    matrix[1] *= jointScale.y;
+    matrix[2] *= jointScale.z;
+    matrix[3] = glm::vec4(getTranslation(joint), 1.0f);
+    return matrix;
+  }
+
+  namespace {
+    void lerpStream(const float* a, const float* b, float weight, float* out, uint32_t count) {
+#if defined(KST_POSE_SSE)
+      const __m128 w = _mm_set1_ps(weight);
+      for (uint32_t i = 0; i < count; i += Pose::kLaneWidth) {
+        const __m128 va = _mm_loadu_ps(a + i);
+        const __m128 vb = _mm_loadu_ps(b + i);
+        _mm_storeu_ps(out + i, _mm_add_ps(va, _mm_mul_ps(_mm_sub_ps(vb, va), w)));
+      }
+#else
+      for (uint32_t i = 0; i < count; ++i) {
+        out[i] = a[i] + (b[i] - a[i]) * weight;
+      }
+#endif
+    }
+
+    void nlerpRotations(const Pose& a, const Pose& b, float weight, Pose& out) {
+      const uint32_t count = a.paddedCount;
+      const float* ax      = a.rotation[0].data();
+      const float* ay      = a.rotation[1].data();
+      const float* az      = a.rotation[2].data();
+      const float* aw      = a.rotation[3].data();
+      const float* bx      = b.rotation[0].data();
+      const float* by      = b.rotation[1].data();
+      const float* bz      = b.rotation[2].data();
+      const float* bw      = b.rotation[3].data();
+      float* ox            = out.rotation[0].data();
+      float* oy            = out.rotation[1].data();
+      float* oz            = out.rotation[2].data();
+      float* ow            = out.rotation[3].data();
+
+#if defined(KST_POSE_SSE)
+      const __m128 w        = _mm_set1_ps(weight);
+      const __m128 zero     = _mm_setzero_ps();
+      const __m128 signMask = _mm_set1_ps(-0.0f);
+      const __m128 half     = _mm_set1_ps(0.5f);
+      const __m128 threeHalves = _mm_set1_ps(1.5f);
+
+      for (uint32_t i = 0; i < count; i += Pose::kLaneWidth) {
+        const __m128 qax = _mm_loadu_ps(ax + i);
+        const __m128 qay = _mm_loadu_ps(ay + i);
+        const __m128 qaz = _mm_loadu_ps(az + i);
+        const __m128 qaw = _mm_loadu_ps(aw + i);
+        __m128 qbx       = _mm_loadu_ps(bx + i);
+        __m128 qby       = _mm_loadu_ps(by + i);
+        __m128 qbz       = _mm_loadu_ps(bz + i);
+        __m128 qbw       = _mm_loadu_ps(bw + i);
+
+        // Take the shortest arc: flip b where dot(a, b) < 0.
+        const __m128 dot = _mm_add_ps(
+            _mm_add_ps(_mm_mul_ps(qax, qbx), _mm_mul_ps(qay, qby)),
+            _mm_add_ps(_mm_mul_ps(qaz, qbz), _mm_mul_ps(qaw, qbw))
+        );
+        const __m128 flip = _mm_and_ps(_mm_cmplt_ps(dot, zero), signMask);
+        qbx               = _mm_xor_ps(qbx, flip);
+        qby               = _mm_xor_ps(qby, flip);
+        qbz               = _mm_xor_ps(qbz, flip);
+        qbw               = _mm_xor_ps(qbw, flip);
+
+        const __m128 rx = _mm_add_ps(qax, _mm_mul_ps(_mm_sub_ps(qbx, qax), w));
+        const __m128 ry = _mm_add_ps(qay, _mm_mul_ps(_mm_sub_ps(qby, qay), w));
+        const __m128 rz = _mm_add_ps(qaz, _mm_mul_ps(_mm_sub_ps(qbz, qaz), w));
+        const __m128 rw = _mm_add_ps(qaw, _mm_mul_ps(_mm_sub_ps(qbw, qaw), w));
+
+        // rsqrt estimate refined with one Newton-Raphson step (~23 bits).
+        const __m128 lengthSq = _mm_add_ps(
+            _mm_add_ps(_mm_mul_ps(rx, rx), _mm_mul_ps(ry, ry)),
+            _mm_add_ps(_mm_mul_ps(rz, rz), _mm_mul_ps(rw, rw))
+        );
+        const __m128 halfLengthSq = _mm_mul_ps(half, lengthSq);
+        __m128 invLength          = _mm_rsqrt_ps(lengthSq);
+        invLength                 = _mm_mul_ps(
+            invLength,
+            _mm_sub_ps(threeHalves, _mm_mul_ps(halfLengthSq, _mm_mul_ps(invLength, invLength)))
+        );
+
+        _mm_storeu_ps(ox + i, _mm_mul_ps(rx, invLength));
+        _mm_storeu_ps(oy + i, _mm_mul_ps(ry, invLength));
+        _mm_storeu_ps(oz + i, _mm_mul_ps(rz, invLength));
+        _mm_storeu_ps(ow + i, _mm_mul_ps(rw, invLength));
+      }
+#else
+      for (uint32_t i = 0; i < count; ++i) {
+        const float dot  = ax[i] * bx[i] + ay[i] * by[i] + az[i] * bz[i] + aw[i] * bw[i];
+        const float sign = dot < 0.0f ? -1.0f : 1.0f;
+
+        const float rx = ax[i] + (sign * bx[i] - ax[i]) * weight;
+        const float ry = ay[i] + (sign * by[i] - ay[i]) * weight;
+        const float rz = az[i] + (sign * bz[i] - az[i]) * weight;
+        const float rw = aw[i] + (sign * bw[i] - aw[i]) * weight;
+
+        const float invLength = 1.0f / std::sqrt(rx * rx + ry * ry + rz * rz + rw * rw);
+        ox[i]                 = rx * invLength;
+        oy[i]                 = ry * invLength;
+        oz[i]                 = rz * invLength;
+        ow[i]                 = rw * invLength;
+      }
+#endif
+    }
+  } // namespace
+
+  void blendPoses(const Pose& a, const Pose& b, float weight, Pose& out) {
+    ASSERT(a.jointCount == b.jointCount, "Blended poses must share a skeleton");
+    if (out.paddedCount != a.paddedCount) {
+      out.resize(a.jointCount);
+    }
+
+    for (size_t axis = 0; axis < 3; ++axis) {
+      lerpStream(
+          a.translation[axis].data(),
+          b.translation[axis].data(),
+          weight,
+          out.translation[axis].data(),
+          a.paddedCount
+      );
+      lerpStream(
+          a.scale[axis].data(), b.scale[axis].data(), weight, out.scale[axis].data(), a.paddedCount
+      );
+    }
+    nlerpRotations(a, b, weight, out);
+  }
+} // namespace kst::renderer
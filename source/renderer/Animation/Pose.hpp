@@ -0,0 +1,64 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+namespace kst::renderer {
+  /**
+   * @brief Local-space joint transforms stored as structure-of-arrays
+   *
+   * Every component lives in its own float stream padded to a multiple of
+   * kLaneWidth joints, so blending can process four joints per SIMD register
+   * without a scalar tail. Padding joints hold the identity transform.
+   */
+  struct Pose {
+    static constexpr uint32_t kLaneWidth = 4;
+
+    uint32_t jointCount  = 0;
+    uint32_t paddedCount = 0;
+
+    std::array<std::vector<float>, 3> translation; // x, y, z
+    std::array<std::vector<float>, 4> rotation;    // x, y, z, w
+    std::array<std::vector<float>, 3> scale;       // x, y, z
+
+    Pose() = default;
+    explicit Pose(uint32_t count) { resize(count); }
+
+    void resize(uint32_t count);
+
+    void setIdentity();
+
+    void setJoint(
+        uint32_t joint,
+        const glm::vec3& jointTranslation,
+        const glm::quat& jointRotation,
+        const glm::vec3& jointScale
+    );
+
+    void setTranslation(uint32_t joint, const glm::vec3& value);
+    void setRotation(uint32_t joint, const glm::quat& value);
+    void setScale(uint32_t joint, const glm::vec3& value);
+
+    auto getTranslation(uint32_t joint) const -> glm::vec3;
+    auto getRotation(uint32_t joint) const -> glm::quat;
+    auto getScale(uint32_t joint) const -> glm::vec3;
+
+    auto localMatrix(uint32_t joint) const -> glm::mat4;
+  };
+
+  /**
+   * @brief Blends two poses component-wise: out = lerp(a, b, weight)
+   * @param a Pose at weight 0
+   * @param b Pose at weight 1, must have the same joint count as a
+   * @param weight Blend factor in [0, 1]
+   * @param out Destination, may alias a or b
+   *
+   * Rotations use normalized lerp with hemisphere correction. Uses SSE when
+   * available and falls back to a scalar loop otherwise.
+   */
+  void blendPoses(const Pose& a, const Pose& b, float weight, Pose& out);
+} // namespace kst::renderer
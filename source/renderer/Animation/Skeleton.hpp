@@ -0,0 +1,44 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "Pose.hpp"
+
+namespace kst::renderer {
+  /**
+   * @brief Joint hierarchy shared by every instance of a skinned model
+   *
+   * Joints are stored in an order where every parent precedes its children,
+   * so model-space transforms can be resolved in a single forward pass.
+   */
+  struct Skeleton {
+    std::vector<std::string> jointNames;
+    std::vector<int32_t> parents; // -1 for root joints
+    std::vector<glm::mat4> inverseBindMatrices;
+    Pose restPose;
+
+    auto jointCount() const -> uint32_t { return static_cast<uint32_t>(parents.size()); }
+
+    auto findJoint(std::string_view name) const -> int32_t {
+      const auto it = std::find(jointNames.begin(), jointNames.end(), name);
+      return it != jointNames.end() ? static_cast<int32_t>(it - jointNames.begin()) : -1;
+    }
+  };
+
+  /**
+   * @brief Per-joint skinning transform uploaded to the GPU
+   *
+   * The affine 3x4 part of (modelSpaceJoint * inverseBind), stored as rows so
+   * the shader can transform a point with three dot products.
+   */
+  struct SkinningMatrix {
+    glm::vec4 rows[3];
+  };
+  static_assert(sizeof(SkinningMatrix) == 48, "SkinningMatrix must match the shader layout");
+} // namespace kst::renderer
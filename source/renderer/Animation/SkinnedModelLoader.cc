@@ -0,0 +1,236 @@
+#include "SkinnedModelLoader.hpp"
+
+#include <unordered_map>
+#include <unordered_set>
+
+#include <assimp/Importer.hpp>
+#include <assimp/postprocess.h>
+#include <assimp/scene.h>
+#include <glm/gtc/quaternion.hpp>
+#include <tracy/Tracy.hpp>
+
+#include "core/MemoryTracker.hpp"
+
+namespace kst::renderer {
+  namespace {
+    constexpr uint32_t kMaxInfluences = 4;
+
+    // aiMatrix4x4 is row-major, glm is column-major.
+    auto toGlm(const aiMatrix4x4& m) -> glm::mat4 {
+      return glm::mat4(
+          m.a1, m.b1, m.c1, m.d1,
+          m.a2, m.b2, m.c2, m.d2,
+          m.a3, m.b3, m.c3, m.d3,
+          m.a4, m.b4, m.c4, m.d4
+      );
+    }
+
+    auto toGlm(const aiVector3D& v) -> glm::vec3 { return {v.x, v.y, v.z}; }
+
+    auto toGlm(const aiQuaternion& q) -> glm::quat { return {q.w, q.x, q.y, q.z}; }
+
+    // Marks every bone node and all of its ancestors as part of the skeleton.
+    auto collectSkeletonNodes(const aiScene* scene) -> std::unordered_set<const aiNode*> {
+      std::unordered_set<const aiNode*> nodes;
+      for (uint32_t m = 0; m < scene->mNumMeshes; ++m) {
+        const aiMesh* mesh = scene->mMeshes[m];
+        for (uint32_t b = 0; b < mesh->mNumBones; ++b) {
+          const aiNode* node = scene->mRootNode->FindNode(mesh->mBones[b]->mName);
+          while (node != nullptr && nodes.insert(node).second) {
+            node = node->mParent;
+          }
+        }
+      }
+      return nodes;
+    }
+
+    // Depth-first preorder keeps parents ahead of their children. Since
+    // skeletonNodes is closed over ancestors, the nearest joint above a node is
+    // always its direct parent.
+    void appendJoints(
+        const aiNode* node,
+        int32_t parent,
+        const std::unordered_set<const aiNode*>& skeletonNodes,
+        std::vector<const aiNode*>& joints,
+        std::vector<int32_t>& parents
+    ) {
+      if (skeletonNodes.contains(node)) {
+        parents.push_back(parent);
+        parent = static_cast<int32_t>(joints.size());
+        joints.push_back(node);
+      }
+      for (uint32_t i = 0; i < node->mNumChildren; ++i) {
+        appendJoints(node->mChildren[i], parent, skeletonNodes, joints, parents);
+      }
+    }
+
+    void addInfluence(SkinnedVertex& vertex, uint32_t joint, float weight) {
+      // Keep the strongest influences if the importer left more than four.
+      uint32_t slot = 0;
+      for (uint32_t i = 1; i < kMaxInfluences; ++i) {
+        if (vertex.weights[i] < vertex.weights[slot]) {
+          slot = i;
+        }
+      }
+      if (weight > vertex.weights[slot]) {
+        vertex.joints[slot]  = joint;
+        vertex.weights[slot] = weight;
+      }
+    }
+
+    auto loadMesh(
+        const aiMesh* mesh, const std::unordered_map<std::string, uint32_t>& jointIndices
+    ) -> SkinnedMesh {
+      SkinnedMesh result;
+      result.name          = mesh->mName.C_Str();
+      result.materialIndex = mesh->mMaterialIndex;
+      result.vertices.resize(mesh->mNumVertices);
+
+      for (uint32_t v = 0; v < mesh->mNumVertices; ++v) {
+        auto& vertex    = result.vertices[v];
+        vertex.position = toGlm(mesh->mVertices[v]);
+        if (mesh->HasNormals()) {
+          vertex.normal = toGlm(mesh->mNormals[v]);
+        }
+        if (mesh->HasTangentsAndBitangents()) {
+          const glm::vec3 tangent   = toGlm(mesh->mTangents[v]);
+          const glm::vec3 bitangent = toGlm(mesh->mBitangents[v]);
+          const float handedness =
+              glm::dot(glm::cross(vertex.normal, tangent), bitangent) < 0.0f ? -1.0f : 1.0f;
+          vertex.tangent = glm::vec4(tangent, handedness);
+        }
+        if (mesh->HasTextureCoords(0)) {
+          vertex.uvX = mesh->mTextureCoords[0][v].x;
+          vertex.uvY = mesh->mTextureCoords[0][v].y;
+        }
+      }
+
+      for (uint32_t b = 0; b < mesh->mNumBones; ++b) {
+        const aiBone* bone   = mesh->mBones[b];
+        const uint32_t joint = jointIndices.at(bone->mName.C_Str());
+        for (uint32_t w = 0; w < bone->mNumWeights; ++w) {
+          const aiVertexWeight& weight = bone->mWeights[w];
+          addInfluence(result.vertices[weight.mVertexId], joint, weight.mWeight);
+        }
+      }
+
+      for (auto& vertex : result.vertices) {
+        const float total = glm::dot(vertex.weights, glm::vec4(1.0f));
+        vertex.weights = total > 0.0f ? vertex.weights / total : glm::vec4(1.0f, 0.0f, 0.0f, 0.0f);
+      }
+
+      result.indices.reserve(static_cast<size_t>(mesh->mNumFaces) * 3);
+      for (uint32_t f = 0; f < mesh->mNumFaces; ++f) {
+        const aiFace& face = mesh->mFaces[f];
+        result.indices.insert(
+            result.indices.end(), face.mIndices, face.mIndices + face.mNumIndices
+        );
+      }
+      return result;
+    }
+
+    auto loadClip(
+        const aiAnimation* animation,
+        const std::unordered_map<std::string, uint32_t>& jointIndices,
+        uint32_t jointCount
+    ) -> std::shared_ptr<const AnimationClip> {
+      const double ticksPerSecond =
+          animation->mTicksPerSecond > 0.0 ? animation->mTicksPerSecond : 25.0;
+      auto seconds = [ticksPerSecond](double ticks) {
+        return static_cast<float>(ticks / ticksPerSecond);
+      };
+
+      std::vector<JointTrack> tracks(jointCount);
+      for (uint32_t c = 0; c < animation->mNumChannels; ++c) {
+        const aiNodeAnim* channel = animation->mChannels[c];
+        const auto it             = jointIndices.find(channel->mNodeName.C_Str());
+        if (it == jointIndices.end()) {
+          continue;
+        }
+
+        auto& track = tracks[it->second];
+        for (uint32_t k = 0; k < channel->mNumPositionKeys; ++k) {
+          track.translationTimes.push_back(seconds(channel->mPositionKeys[k].mTime));
+          track.translations.push_back(toGlm(channel->mPositionKeys[k].mValue));
+        }
+        for (uint32_t k = 0; k < channel->mNumRotationKeys; ++k) {
+          track.rotationTimes.push_back(seconds(channel->mRotationKeys[k].mTime));
+          track.rotations.push_back(toGlm(channel->mRotationKeys[k].mValue));
+        }
+        for (uint32_t k = 0; k < channel->mNumScalingKeys; ++k) {
+          track.scaleTimes.push_back(seconds(channel->mScalingKeys[k].mTime));
+          track.scales.push_back(toGlm(channel->mScalingKeys[k].mValue));
+        }
+      }
+
+      return std::make_shared<const AnimationClip>(
+          animation->mName.C_Str(), seconds(animation->mDuration), std::move(tracks)
+      );
+    }
+  } // namespace
+
+  auto loadSkinnedModel(const std::string& path) -> core::Result<SkinnedModel> {
+    ZoneScopedN("SkinnedModelLoader: load");
+    KST_MEMORY_SCOPE(Assets);
+
+    Assimp::Importer importer;
+    const aiScene* scene = importer.ReadFile(
+        path,
+        aiProcess_Triangulate | aiProcess_LimitBoneWeights | aiProcess_CalcTangentSpace |
+            aiProcess_GenSmoothNormals | aiProcess_JoinIdenticalVertices
+    );
+    if (scene == nullptr || scene->mRootNode == nullptr) {
+      return core::Result<SkinnedModel>::error(
+          "Failed to load skinned model " + path + ": " + importer.GetErrorString()
+      );
+    }
+
+    const auto skeletonNodes = collectSkeletonNodes(scene);
+    if (skeletonNodes.empty()) {
+      return core::Result<SkinnedModel>::error("Model " + path + " has no bones");
+    }
+
+    std::vector<const aiNode*> joints;
+    auto skeleton = std::make_shared<Skeleton>();
+    appendJoints(scene->mRootNode, -1, skeletonNodes, joints, skeleton->parents);
+
+    const auto jointCount = static_cast<uint32_t>(joints.size());
+    std::unordered_map<std::string, uint32_t> jointIndices;
+    skeleton->jointNames.reserve(jointCount);
+    skeleton->inverseBindMatrices.assign(jointCount, glm::mat4(1.0f));
+    skeleton->restPose.resize(jointCount);
+
+    for (uint32_t j = 0; j < jointCount; ++j) {
+      skeleton->jointNames.emplace_back(joints[j]->mName.C_Str());
+      jointIndices.emplace(skeleton->jointNames.back(), j);
+
+      aiVector3D scale;
+      aiQuaternion rotation;
+      aiVector3D translation;
+      joints[j]->mTransformation.Decompose(scale, rotation, translation);
+      skeleton->restPose.setJoint(j, toGlm(translation), toGlm(rotation), toGlm(scale));
+    }
+
+    // Non-bone ancestors keep the identity inverse bind; they only carry transforms.
+    for (uint32_t m = 0; m < scene->mNumMeshes; ++m) {
+      const aiMesh* mesh = scene->mMeshes[m];
+      for (uint32_t b = 0; b < mesh->mNumBones; ++b) {
+        skeleton->inverseBindMatrices[jointIndices.at(mesh->mBones[b]->mName.C_Str())] =
+            toGlm(mesh->mBones[b]->mOffsetMatrix);
+      }
+    }
+
+    SkinnedModel model;
+    for (uint32_t m = 0; m < scene->mNumMeshes; ++m) {
+      if (scene->mMeshes[m]->HasBones()) {
+        model.meshes.push_back(loadMesh(scene->mMeshes[m], jointIndices));
+      }
+    }
+    for (uint32_t a = 0; a < scene->mNumAnimations; ++a) {
+      model.clips.push_back(loadClip(scene->mAnimations[a], jointIndices, jointCount));
+    }
+    model.skeleton = std::move(skeleton);
+
+    return core::Result<SkinnedModel>::success(std::move(model));
+  }
+} // namespace kst::renderer
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "AnimationClip.hpp"
+#include "Skeleton.hpp"
+#include "SkinningPass.hpp"
+#include "core/Result.hpp"
+
+namespace kst::renderer {
+  struct SkinnedMesh {
+    std::string name;
+    std::vector<SkinnedVertex> vertices;
+    std::vector<uint32_t> indices;
+    uint32_t materialIndex = 0;
+  };
+
+  struct SkinnedModel {
+    std::shared_ptr<const Skeleton> skeleton;
+    std::vector<SkinnedMesh> meshes;
+    std::vector<std::shared_ptr<const AnimationClip>> clips;
+  };
+
+  /**
+   * @brief Loads a skinned model and its animations through assimp
+   * @param path Any format assimp can read that carries bones (glTF, FBX, ...)
+   *
+   * The skeleton contains every bone plus the nodes between bones and the
+   * scene root, so node transforms that are not bones still animate correctly.
+   */
+  auto loadSkinnedModel(const std::string& path) -> core::Result<SkinnedModel>;
+} // namespace kst::renderer
@@ -0,0 +1,281 @@
+#include "SkinningPass.hpp"
+
+#include <tracy/Tracy.hpp>
+
+#include "VulkanBackend/VulkanCore/Buffer.hpp"
+#include "VulkanBackend/VulkanCore/CommandQueueManager.hpp"
+#include "VulkanBackend/VulkanCore/Context.hpp"
+#include "VulkanBackend/VulkanCore/Pipeline.hpp"
+#include "VulkanBackend/VulkanCore/ShaderModule.hpp"
+
+namespace kst::renderer {
+  namespace {
+    constexpr uint32_t kWorkgroupSize = 64;
+
+    // GPU side of a job: the prefix sum replaces vertexCount so each thread
+    // can binary search for its job.
+    struct GPUSkinningJob {
+      uint32_t sourceOffset;
+      uint32_t outputOffset;
+      uint32_t paletteOffset;
+      uint32_t firstThread;
+    };
+
+    struct PushConstants {
+      uint32_t jobCount;
+      uint32_t totalVertices;
+    };
+
+    enum Binding : uint32_t {
+      SourceVertices = 0,
+      Palette        = 1,
+      Jobs           = 2,
+      OutputVertices = 3,
+    };
+  } // namespace
+
+  SkinningPass::SkinningPass(VulkanCore::Context& context, const Descriptor& descriptor)
+      : m_context(context), m_name(descriptor.name), m_descriptor(descriptor) {
+    ASSERT(m_descriptor.framesInFlight > 0, "SkinningPass needs at least one frame in flight");
+
+    m_sourceBuffer = m_context.createBuffer(
+        static_cast<size_t>(m_descriptor.maxSourceVertices) * sizeof(SkinnedVertex),
+        VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+        VMA_MEMORY_USAGE_GPU_ONLY,
+        "Skinning source vertices: " + m_name
+    );
+    m_outputBuffer = m_context.createBuffer(
+        static_cast<size_t>(m_descriptor.maxOutputVertices) * sizeof(MeshVertex),
+        VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
+        VMA_MEMORY_USAGE_GPU_ONLY,
+        "Skinning output vertices: " + m_name
+    );
+
+    for (uint32_t frame = 0; frame < m_descriptor.framesInFlight; ++frame) {
+      m_paletteBuffers.push_back(m_context.createPersistentBuffer(
+          static_cast<size_t>(m_descriptor.maxPaletteJoints) * sizeof(SkinningMatrix),
+          VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+          "Skinning palette " + std::to_string(frame) + ": " + m_name
+      ));
+      m_jobBuffers.push_back(m_context.createPersistentBuffer(
+          static_cast<size_t>(m_descriptor.maxJobs) * sizeof(GPUSkinningJob),
+          VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+          "Skinning jobs " + std::to_string(frame) + ": " + m_name
+      ));
+    }
+
+    m_shader = m_context.createShaderModule(
+        std::string(KST_SHADER_DIR) + "/animation/skinning.comp.spv",
+        VK_SHADER_STAGE_COMPUTE_BIT,
+        "Skinning: " + m_name
+    );
+
+    auto storageBinding = [](uint32_t binding) {
+      return VkDescriptorSetLayoutBinding{
+          .binding         = binding,
+          .descriptorType  = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+          .descriptorCount = 1,
+          .stageFlags      = VK_SHADER_STAGE_COMPUTE_BIT,
+      };
+    };
+
+    const VulkanCore::Pipeline::ComputePipelineDescriptor desc = {
+        .sets_ =
+            {
+                {
+                    .set_ = 0,
+                    .bindings_ =
+                        {
+                            storageBinding(Binding::SourceVertices),
+                            storageBinding(Binding::Palette),
+                            storageBinding(Binding::Jobs),
+                            storageBinding(Binding::OutputVertices),
+                        },
+                },
+            },
+        .computeShader_ = m_shader,
+        .pushConstants_ =
+            {
+                {
+                    .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT,
+                    .offset     = 0,
+                    .size       = sizeof(PushConstants),
+                },
+            },
+    };
+    m_pipeline = m_context.createComputePipeline(desc, "Skinning: " + m_name);
+
+    m_pipeline->allocateDescriptors({
+        {.set_ = 0, .count_ = m_descriptor.framesInFlight, .name_ = "Skinning"},
+    });
+    for (uint32_t frame = 0; frame < m_descriptor.framesInFlight; ++frame) {
+      m_pipeline->bindResource(
+          0,
+          Binding::SourceVertices,
+          frame,
+          m_sourceBuffer,
+          0,
+          m_sourceBuffer->size(),
+          VK_DESCRIPTOR_TYPE_STORAGE_BUFFER
+      );
+      m_pipeline->bindResource(
+          0,
+          Binding::Palette,
+          frame,
+          m_paletteBuffers[frame],
+          0,
+          m_paletteBuffers[frame]->size(),
+          VK_DESCRIPTOR_TYPE_STORAGE_BUFFER
+      );
+      m_pipeline->bindResource(
+          0,
+          Binding::Jobs,
+          frame,
+          m_jobBuffers[frame],
+          0,
+          m_jobBuffers[frame]->size(),
+          VK_DESCRIPTOR_TYPE_STORAGE_BUFFER
+      );
+      m_pipeline->bindResource(
+          0,
+          Binding::OutputVertices,
+          frame,
+          m_outputBuffer,
+          0,
+          m_outputBuffer->size(),
+          VK_DESCRIPTOR_TYPE_STORAGE_BUFFER
+      );
+    }
+  }
+
+  SkinningPass::~SkinningPass() = default;
+
+  auto SkinningPass::uploadMesh(
+      VulkanCore::CommandQueueManager& queueManager,
+      VkCommandBuffer commandBuffer,
+      std::span<const SkinnedVertex> vertices
+  ) -> uint32_t {
+    const auto vertexCount = static_cast<uint32_t>(vertices.size());
+    ASSERT(
+        m_sourceVertexCount + vertexCount <= m_descriptor.maxSourceVertices,
+        "SkinningPass source vertex buffer is full"
+    );
+
+    const uint32_t offset = m_sourceVertexCount;
+    m_context.uploadToGPUBuffer(
+        queueManager,
+        commandBuffer,
+        m_sourceBuffer.get(),
+        vertices.data(),
+        static_cast<long>(vertices.size_bytes()),
+        static_cast<uint64_t>(offset) * sizeof(SkinnedVertex)
+    );
+    m_sourceVertexCount += vertexCount;
+
+    const VkMemoryBarrier barrier = {
+        .sType         = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+        .srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+        .dstAccessMask = VK_ACCESS_SHADER_READ_BIT,
+    };
+    vkCmdPipelineBarrier(
+        commandBuffer,
+        VK_PIPELINE_STAGE_TRANSFER_BIT,
+        VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+        0,
+        1,
+        &barrier,
+        0,
+        nullptr,
+        0,
+        nullptr
+    );
+    return offset;
+  }
+
+  auto SkinningPass::allocateOutput(uint32_t vertexCount) -> uint32_t {
+    ASSERT(
+        m_outputVertexCount + vertexCount <= m_descriptor.maxOutputVertices,
+        "SkinningPass output vertex buffer is full"
+    );
+    const uint32_t offset = m_outputVertexCount;
+    m_outputVertexCount += vertexCount;
+    return offset;
+  }
+
+  auto SkinningPass::palette(uint32_t frameSlot) const -> std::span<SkinningMatrix> {
+    return {
+        static_cast<SkinningMatrix*>(m_paletteBuffers[frameSlot]->map()),
+        m_descriptor.maxPaletteJoints
+    };
+  }
+
+  void SkinningPass::addJob(const SkinningJob& job) {
+    ASSERT(m_jobs.size() < m_descriptor.maxJobs, "SkinningPass job table is full");
+    m_jobs.push_back(job);
+  }
+
+  void SkinningPass::dispatch(VkCommandBuffer commandBuffer, uint32_t frameSlot) {
+    ZoneScopedN("SkinningPass: dispatch");
+
+    if (m_jobs.empty()) {
+      return;
+    }
+
+    auto* gpuJobs          = static_cast<GPUSkinningJob*>(m_jobBuffers[frameSlot]->map());
+    uint32_t totalVertices = 0;
+    for (size_t i = 0; i < m_jobs.size(); ++i) {
+      gpuJobs[i] = {
+          .sourceOffset  = m_jobs[i].sourceOffset,
+          .outputOffset  = m_jobs[i].outputOffset,
+          .paletteOffset = m_jobs[i].paletteOffset,
+          .firstThread   = totalVertices,
+      };
+      totalVertices += m_jobs[i].vertexCount;
+    }
+
+    const PushConstants constants = {
+        .jobCount      = static_cast<uint32_t>(m_jobs.size()),
+        .totalVertices = totalVertices,
+    };
+    m_jobs.clear();
+
+    // The previous frame's draws may still be reading the output buffer.
+    vkCmdPipelineBarrier(
+        commandBuffer,
+        VK_PIPELINE_STAGE_VERTEX_INPUT_BIT,
+        VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+        0,
+        0,
+        nullptr,
+        0,
+        nullptr,
+        0,
+        nullptr
+    );
+
+    m_pipeline->bind(commandBuffer);
+    m_pipeline->bindDescriptorSets(commandBuffer, {{.set = 0, .bindIdx = frameSlot}});
+    m_pipeline->updatePushConstant(
+        commandBuffer, VK_SHADER_STAGE_COMPUTE_BIT, sizeof(constants), &constants
+    );
+    vkCmdDispatch(commandBuffer, (totalVertices + kWorkgroupSize - 1) / kWorkgroupSize, 1, 1);
+
+    const VkMemoryBarrier barrier = {
+        .sType         = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+        .srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT,
+        .dstAccessMask = VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT,
+    };
+    vkCmdPipelineBarrier(
+        commandBuffer,
+        VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+        VK_PIPELINE_STAGE_VERTEX_INPUT_BIT,
+        0,
+        1,
+        &barrier,
+        0,
+        nullptr,
+        0,
+        nullptr
+    );
+  }
+} // namespace kst::renderer
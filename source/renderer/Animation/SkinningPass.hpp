@@ -0,0 +1,137 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <string>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "Mesh/MeshVertex.hpp"
+#include "Skeleton.hpp"
+#include "VulkanBackend/VulkanCore/Common.hpp"
+
+namespace VulkanCore {
+  class Buffer;
+  class CommandQueueManager;
+  class Context;
+  class Pipeline;
+  class ShaderModule;
+} // namespace VulkanCore
+
+namespace kst::renderer {
+  /**
+   * @brief Bind-pose vertex with up to four joint influences
+   *
+   * Shares its first 48 bytes with MeshVertex so the skinning shader can pass
+   * uvs straight through.
+   */
+  struct SkinnedVertex {
+    glm::vec3 position{0.0f};
+    float uvX = 0.0f;
+    glm::vec3 normal{0.0f, 1.0f, 0.0f};
+    float uvY = 0.0f;
+    glm::vec4 tangent{1.0f, 0.0f, 0.0f, 1.0f};
+    glm::uvec4 joints{0};
+    glm::vec4 weights{0.0f};
+  };
+  static_assert(sizeof(SkinnedVertex) == 80, "SkinnedVertex must match the std430 shader layout");
+
+  /**
+   * @brief One skinned mesh instance to process this frame
+   */
+  struct SkinningJob {
+    uint32_t sourceOffset  = 0; // first vertex in the source vertex buffer
+    uint32_t outputOffset  = 0; // first vertex in the shared output buffer
+    uint32_t paletteOffset = 0; // first joint in this frame's palette
+    uint32_t vertexCount   = 0;
+  };
+
+  /**
+   * @brief GPU skinning of all animated meshes in one compute dispatch
+   *
+   * Bind-pose vertices of every skinned mesh live in one source buffer and all
+   * skinned results land in one shared output buffer laid out as MeshVertex,
+   * so skinned meshes are drawn with the static mesh pipeline by binding
+   * outputBuffer() as their vertex buffer with the job's output offset.
+   *
+   * Palettes and the job table are written through persistently mapped,
+   * per-frame buffers; AnimationSystem::update() can target palette() directly.
+   */
+  class SkinningPass {
+  public:
+    struct Descriptor {
+      uint32_t maxSourceVertices = 1u << 20;
+      uint32_t maxOutputVertices = 1u << 20;
+      uint32_t maxPaletteJoints  = 1u << 14;
+      uint32_t maxJobs           = 4096;
+      uint32_t framesInFlight    = 2;
+      std::string name           = "skinning";
+    };
+
+    SkinningPass(VulkanCore::Context& context, const Descriptor& descriptor);
+    ~SkinningPass();
+
+    SkinningPass(const SkinningPass&)                    = delete;
+    auto operator=(const SkinningPass&) -> SkinningPass& = delete;
+    SkinningPass(SkinningPass&&)                         = delete;
+    auto operator=(SkinningPass&&) -> SkinningPass&      = delete;
+
+    /**
+     * @brief Uploads bind-pose vertices of a skinned mesh
+     * @param queueManager Queue that owns commandBuffer, used to dispose the staging buffer
+     * @param commandBuffer Command buffer in the recording state
+     * @param vertices Source vertices
+     * @return Source offset to use in SkinningJob::sourceOffset
+     */
+    auto uploadMesh(
+        VulkanCore::CommandQueueManager& queueManager,
+        VkCommandBuffer commandBuffer,
+        std::span<const SkinnedVertex> vertices
+    ) -> uint32_t;
+
+    /**
+     * @brief Reserves a range of the shared output buffer for one instance
+     * @return Output offset to use in SkinningJob::outputOffset and as vertex offset when drawing
+     */
+    auto allocateOutput(uint32_t vertexCount) -> uint32_t;
+
+    /**
+     * @brief Persistently mapped palette for a frame slot
+     */
+    auto palette(uint32_t frameSlot) const -> std::span<SkinningMatrix>;
+
+    void addJob(const SkinningJob& job);
+
+    /**
+     * @brief Writes the job table and records the skinning dispatch
+     * @param commandBuffer Command buffer outside of a render pass
+     * @param frameSlot Frame slot whose palette was written this frame
+     *
+     * Ends with a barrier that makes the output visible to vertex input.
+     */
+    void dispatch(VkCommandBuffer commandBuffer, uint32_t frameSlot);
+
+    auto outputBuffer() const -> const std::shared_ptr<VulkanCore::Buffer>& {
+      return m_outputBuffer;
+    }
+
+  private:
+    VulkanCore::Context& m_context;
+    std::string m_name;
+    Descriptor m_descriptor;
+
+    uint32_t m_sourceVertexCount = 0;
+    uint32_t m_outputVertexCount = 0;
+    std::vector<SkinningJob> m_jobs;
+
+    std::shared_ptr<VulkanCore::Buffer> m_sourceBuffer;
+    std::shared_ptr<VulkanCore::Buffer> m_outputBuffer;
+    std::vector<std::shared_ptr<VulkanCore::Buffer>> m_paletteBuffers;
+    std::vector<std::shared_ptr<VulkanCore::Buffer>> m_jobBuffers;
+
+    std::shared_ptr<VulkanCore::ShaderModule> m_shader;
+    std::shared_ptr<VulkanCore::Pipeline> m_pipeline;
+  };
+} // namespace kst::renderer
@@ -0,0 +1,554 @@
+#include "FoliageScatter.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <numbers>
+
+#include <glm/gtc/matrix_access.hpp>
+#include <tracy/Tracy.hpp>
+
+#include "VulkanBackend/VulkanCore/Buffer.hpp"
+#include "VulkanBackend/VulkanCore/CommandQueueManager.hpp"
+#include "VulkanBackend/VulkanCore/Context.hpp"
+#include "VulkanBackend/VulkanCore/Pipeline.hpp"
+#include "VulkanBackend/VulkanCore/Sampler.hpp"
+#include "VulkanBackend/VulkanCore/ShaderModule.hpp"
+#include "VulkanBackend/VulkanCore/Texture.hpp"
+
+namespace kst::renderer {
+  namespace {
+    // Must match shaders/foliage/common.glsl
+    constexpr uint32_t kGroupSize    = 8;
+    constexpr uint32_t kMaxCellsSide = 1u << 14;
+
+    // Draw and the maps are only in the scatter set, Vertices only in the
+    // render set
+    enum Binding : uint32_t {
+      Params     = 0,
+      Instances  = 1,
+      Draws      = 2,
+      Vertices   = 2,
+      DensityMap = 3,
+      HeightMap  = 4,
+    };
+
+    struct FoliageParams {
+      glm::mat4 viewProjection;
+      std::array<glm::vec4, 6> frustumPlanes;
+      glm::vec4 cameraPosition;
+      glm::vec4 sunDirection;
+      glm::vec4 color;
+      glm::vec4 map;
+      glm::vec4 placement;
+      glm::vec4 scaleFade;
+      glm::vec4 lodDistances;
+      glm::uvec4 lodFirst;
+      glm::uvec4 lodCapacity;
+      glm::ivec4 grid;
+      glm::uvec4 seedChannel;
+    };
+    static_assert(sizeof(FoliageParams) == 336, "FoliageParams must match std140 layout");
+
+    struct FoliageInstance {
+      glm::vec4 positionScale;
+      glm::vec4 rotationTint;
+    };
+    static_assert(sizeof(FoliageInstance) == 32, "FoliageInstance must match std430 layout");
+
+    auto shaderPath(const std::string& fileName) -> std::string {
+      return std::string(KST_SHADER_DIR) + "/foliage/" + fileName + ".spv";
+    }
+
+    // Planes pointing inwards, for clip space with depth in [0, 1]
+    auto frustumPlanes(const glm::mat4& viewProjection) -> std::array<glm::vec4, 6> {
+      const glm::vec4 x = glm::row(viewProjection, 0);
+      const glm::vec4 y = glm::row(viewProjection, 1);
+      const glm::vec4 z = glm::row(viewProjection, 2);
+      const glm::vec4 w = glm::row(viewProjection, 3);
+      return {w + x, w - x, w + y, w - y, z, w - z};
+    }
+  } // namespace
+
+  FoliageScatter::FoliageScatter(VulkanCore::Context& context, Descriptor descriptor)
+      : m_context(context),
+        m_descriptor(std::move(descriptor)) {
+    const auto& lods = m_descriptor.lods;
+    ASSERT(!lods.empty() && lods.size() <= kMaxLods, "FoliageScatter supports 1 to 4 LODs");
+    for (size_t lod = 0; lod < lods.size(); ++lod) {
+      ASSERT(!lods[lod].indices.empty(), "FoliageScatter LOD mesh is empty");
+      ASSERT(
+          lod == 0 || lods[lod].maxDistance > lods[lod - 1].maxDistance,
+          "FoliageScatter LOD distances must increase"
+      );
+    }
+    ASSERT(
+        m_descriptor.densityMap && m_descriptor.heightMap,
+        "FoliageScatter needs a density and a height map"
+    );
+    ASSERT(m_descriptor.densityChannel < 4, "FoliageScatter density channel out of range");
+    ASSERT(m_descriptor.cellSize > 0.0f, "FoliageScatter cell size must be positive");
+    ASSERT(m_descriptor.fadeDistance > 0.0f, "FoliageScatter fade distance must be positive");
+    // Each LOD's draw starts at its instance range
+    ASSERT(
+        context.isDrawIndirectFirstInstanceEnabled(),
+        "FoliageScatter needs drawIndirectFirstInstance"
+    );
+
+    // Cells overlapping the disk the last LOD reaches, wherever the camera
+    // sits within its cell
+    const float maxDistance = lods.back().maxDistance;
+    m_cellsPerSide =
+        static_cast<uint32_t>(std::ceil(2.0f * maxDistance / m_descriptor.cellSize)) + 1;
+    ASSERT(m_cellsPerSide <= kMaxCellsSide, "FoliageScatter cells are too small for its reach");
+
+    // A LOD holds at most one instance per cell within its distance of the
+    // camera; horizontal distance never exceeds the distance used for LODs
+    uint32_t first = 0;
+    for (const FoliageLod& lod : lods) {
+      const double reach = lod.maxDistance / m_descriptor.cellSize + std::numbers::sqrt2;
+      const auto cells   = static_cast<uint64_t>(std::ceil(std::numbers::pi * reach * reach));
+      const auto capacity =
+          static_cast<uint32_t>(std::min(cells, uint64_t{m_cellsPerSide} * m_cellsPerSide));
+      m_lodFirst.push_back(first);
+      m_lodCapacity.push_back(capacity);
+      first += capacity;
+    }
+
+    for (const FoliageLod& lod : lods) {
+      for (const MeshVertex& vertex : lod.vertices) {
+        m_boundingRadius = std::max(m_boundingRadius, glm::length(vertex.position));
+      }
+    }
+
+    createBuffers();
+    createPipelines();
+  }
+
+  FoliageScatter::~FoliageScatter() = default;
+
+  void FoliageScatter::createBuffers() {
+    const std::string& name = m_descriptor.name;
+
+    m_mapSampler = m_context.createSampler(
+        VK_FILTER_LINEAR,
+        VK_FILTER_LINEAR,
+        VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE,
+        VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE,
+        VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE,
+        0.0f,
+        "Foliage map sampler: " + name
+    );
+
+    size_t vertices = 0;
+    size_t indices  = 0;
+    for (const FoliageLod& lod : m_descriptor.lods) {
+      vertices += lod.vertices.size();
+      indices += lod.indices.size();
+    }
+    m_vertexBuffer = m_context.createBuffer(
+        vertices * sizeof(MeshVertex),
+        VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+        VMA_MEMORY_USAGE_GPU_ONLY,
+        "Foliage vertices: " + name
+    );
+    m_indexBuffer = m_context.createBuffer(
+        indices * sizeof(uint32_t),
+        VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+        VMA_MEMORY_USAGE_GPU_ONLY,
+        "Foliage indices: " + name
+    );
+    m_instanceBuffer = m_context.createBuffer(
+        size_t{m_lodFirst.back() + m_lodCapacity.back()} * sizeof(FoliageInstance),
+        VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+        VMA_MEMORY_USAGE_GPU_ONLY,
+        "Foliage instances: " + name
+    );
+    m_drawBuffer = m_context.createBuffer(
+        m_descriptor.lods.size() * sizeof(VkDrawIndexedIndirectCommand),
+        VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT |
+            VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+        VMA_MEMORY_USAGE_GPU_ONLY,
+        "Foliage draws: " + name
+    );
+
+    for (uint32_t i = 0; i < m_descriptor.framesInFlight; ++i) {
+      m_uniformBuffers.push_back(m_context.createPersistentBuffer(
+          sizeof(FoliageParams),
+          VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
+          "Foliage params " + std::to_string(i) + ": " + name
+      ));
+    }
+  }
+
+  void FoliageScatter::createPipelines() {
+    const std::string& name = m_descriptor.name;
+
+    const auto binding = [](uint32_t index, VkDescriptorType type, VkShaderStageFlags stages) {
+      return VkDescriptorSetLayoutBinding{
+          .binding         = index,
+          .descriptorType  = type,
+          .descriptorCount = 1,
+          .stageFlags      = stages,
+      };
+    };
+
+    auto scatterShader = m_context.createShaderModule(
+        shaderPath("scatter.comp"), VK_SHADER_STAGE_COMPUTE_BIT, "Foliage scatter: " + name
+    );
+    m_shaders.push_back(scatterShader);
+
+    constexpr VkShaderStageFlags compute  = VK_SHADER_STAGE_COMPUTE_BIT;
+    constexpr VkDescriptorType sampledMap = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    const VulkanCore::Pipeline::ComputePipelineDescriptor scatterDesc = {
+        .sets_ =
+            {
+                {
+                    .set_ = 0,
+                    .bindings_ =
+                        {
+                            binding(Binding::Params, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, compute),
+                            binding(Binding::Instances, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, compute),
+                            binding(Binding::Draws, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, compute),
+                            binding(Binding::DensityMap, sampledMap, compute),
+                            binding(Binding::HeightMap, sampledMap, compute),
+                        },
+                },
+            },
+        .computeShader_ = scatterShader,
+    };
+    m_scatterPipeline = m_context.createComputePipeline(scatterDesc, "Foliage scatter: " + name);
+
+    auto vertexShader = m_context.createShaderModule(
+        shaderPath("foliage.vert"), VK_SHADER_STAGE_VERTEX_BIT, "Foliage vertex: " + name
+    );
+    auto fragmentShader = m_context.createShaderModule(
+        shaderPath("foliage.frag"), VK_SHADER_STAGE_FRAGMENT_BIT, "Foliage fragment: " + name
+    );
+    m_shaders.push_back(vertexShader);
+    m_shaders.push_back(fragmentShader);
+
+    constexpr VkShaderStageFlags vertex = VK_SHADER_STAGE_VERTEX_BIT;
+    const VkCullModeFlagBits cullMode =
+        m_descriptor.doubleSided ? VK_CULL_MODE_NONE : VK_CULL_MODE_BACK_BIT;
+    const VulkanCore::Pipeline::GraphicsPipelineDescriptor renderDesc = {
+        .sets_ =
+            {
+                {
+                    .set_ = 0,
+                    .bindings_ =
+                        {
+                            binding(
+                                Binding::Params,
+                                VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,
+                                vertex | VK_SHADER_STAGE_FRAGMENT_BIT
+                            ),
+                            binding(Binding::Instances, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, vertex),
+                            binding(Binding::Vertices, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, vertex),
+                        },
+                },
+            },
+        .vertexShader_        = vertexShader,
+        .fragmentShader_      = fragmentShader,
+        .dynamicStates_       = {VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR},
+        .useDynamicRendering_ = true,
+        .colorTextureFormats  = {m_descriptor.colorFormat},
+        .depthTextureFormat   = m_descriptor.depthFormat,
+        .cullMode             = cullMode,
+        .viewport             = VkExtent2D{1, 1},
+    };
+    m_renderPipeline =
+        m_context.createGraphicsPipeline(renderDesc, VK_NULL_HANDLE, "Foliage render: " + name);
+
+    m_scatterPipeline->allocateDescriptors({
+        {.set_ = 0, .count_ = m_descriptor.framesInFlight, .name_ = "Foliage scatter"},
+    });
+    m_renderPipeline->allocateDescriptors({
+        {.set_ = 0, .count_ = m_descriptor.framesInFlight, .name_ = "Foliage render"},
+    });
+    // The span overload binds for SHADER_READ_ONLY_OPTIMAL, where the maps live
+    std::array<std::shared_ptr<VulkanCore::Texture>, 1> densityMap = {m_descriptor.densityMap};
+    std::array<std::shared_ptr<VulkanCore::Texture>, 1> heightMap  = {m_descriptor.heightMap};
+    for (uint32_t frame = 0; frame < m_descriptor.framesInFlight; ++frame) {
+      for (const auto& pipeline : {m_scatterPipeline, m_renderPipeline}) {
+        pipeline->bindResource(
+            0,
+            Binding::Params,
+            frame,
+            m_uniformBuffers[frame],
+            0,
+            sizeof(FoliageParams),
+            VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER
+        );
+        pipeline->bindResource(
+            0,
+            Binding::Instances,
+            frame,
+            m_instanceBuffer,
+            0,
+            m_instanceBuffer->size(),
+            VK_DESCRIPTOR_TYPE_STORAGE_BUFFER
+        );
+      }
+      m_scatterPipeline->bindResource(
+          0,
+          Binding::Draws,
+          frame,
+          m_drawBuffer,
+          0,
+          m_drawBuffer->size(),
+          VK_DESCRIPTOR_TYPE_STORAGE_BUFFER
+      );
+      m_scatterPipeline->bindResource(
+          0, Binding::DensityMap, frame, std::span(densityMap), m_mapSampler
+      );
+      m_scatterPipeline->bindResource(
+          0, Binding::HeightMap, frame, std::span(heightMap), m_mapSampler
+      );
+      m_renderPipeline->bindResource(
+          0,
+          Binding::Vertices,
+          frame,
+          m_vertexBuffer,
+          0,
+          m_vertexBuffer->size(),
+          VK_DESCRIPTOR_TYPE_STORAGE_BUFFER
+      );
+    }
+    m_scatterPipeline->updateDescriptorSets();
+    m_renderPipeline->updateDescriptorSets();
+  }
+
+  void FoliageScatter::initialize(
+      VulkanCore::CommandQueueManager& queueManager,
+      VkCommandBuffer commandBuffer
+  ) {
+    ZoneScopedN("FoliageScatter: initialize");
+
+    // LOD meshes back to back; each draw carries its offsets and its
+    // instance range, only instanceCount changes from frame to frame
+    std::vector<MeshVertex> vertices;
+    std::vector<uint32_t> indices;
+    std::vector<VkDrawIndexedIndirectCommand> draws;
+    for (size_t lod = 0; lod < m_descriptor.lods.size(); ++lod) {
+      const FoliageLod& mesh = m_descriptor.lods[lod];
+      draws.push_back({
+          .indexCount    = static_cast<uint32_t>(mesh.indices.size()),
+          .instanceCount = 0,
+          .firstIndex    = static_cast<uint32_t>(indices.size()),
+          .vertexOffset  = static_cast<int32_t>(vertices.size()),
+          .firstInstance = m_lodFirst[lod],
+      });
+      vertices.insert(vertices.end(), mesh.vertices.begin(), mesh.vertices.end());
+      indices.insert(indices.end(), mesh.indices.begin(), mesh.indices.end());
+    }
+
+    m_context.uploadToGPUBuffer(
+        queueManager,
+        commandBuffer,
+        m_vertexBuffer.get(),
+        vertices.data(),
+        static_cast<long>(vertices.size() * sizeof(MeshVertex))
+    );
+    m_context.uploadToGPUBuffer(
+        queueManager,
+        commandBuffer,
+        m_indexBuffer.get(),
+        indices.data(),
+        static_cast<long>(indices.size() * sizeof(uint32_t))
+    );
+    m_context.uploadToGPUBuffer(
+        queueManager,
+        commandBuffer,
+        m_drawBuffer.get(),
+        draws.data(),
+        static_cast<long>(draws.size() * sizeof(VkDrawIndexedIndirectCommand))
+    );
+
+    const VkMemoryBarrier barrier = {
+        .sType         = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+        .srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+        .dstAccessMask = VK_ACCESS_INDEX_READ_BIT | VK_ACCESS_SHADER_READ_BIT |
+                         VK_ACCESS_SHADER_WRITE_BIT | VK_ACCESS_INDIRECT_COMMAND_READ_BIT,
+    };
+    vkCmdPipelineBarrier(
+        commandBuffer,
+        VK_PIPELINE_STAGE_TRANSFER_BIT,
+        VK_PIPELINE_STAGE_VERTEX_INPUT_BIT | VK_PIPELINE_STAGE_VERTEX_SHADER_BIT |
+            VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT,
+        0,
+        1,
+        &barrier,
+        0,
+        nullptr,
+        0,
+        nullptr
+    );
+  }
+
+  void FoliageScatter::update(VkCommandBuffer commandBuffer, const FoliageFrameInfo& frame) {
+    ZoneScopedN("FoliageScatter: update");
+
+    const uint32_t frameSlot = m_frameIndex % m_descriptor.framesInFlight;
+    const auto lodCount      = static_cast<uint32_t>(m_descriptor.lods.size());
+    const float maxDistance  = m_descriptor.lods.back().maxDistance;
+    const float cellSize     = m_descriptor.cellSize;
+
+    const glm::ivec2 firstCell(
+        static_cast<int32_t>(std::floor((frame.cameraPosition.x - maxDistance) / cellSize)),
+        static_cast<int32_t>(std::floor((frame.cameraPosition.z - maxDistance) / cellSize))
+    );
+
+    const glm::mat4 viewProjection = frame.projection * frame.view;
+    FoliageParams params           = {
+        .viewProjection = viewProjection,
+        .frustumPlanes  = frustumPlanes(viewProjection),
+        .cameraPosition = glm::vec4(frame.cameraPosition, 0.0f),
+        .sunDirection   = glm::vec4(glm::normalize(frame.sunDirection), frame.ambient),
+        .color          = glm::vec4(m_descriptor.color, m_descriptor.doubleSided ? 1.0f : 0.0f),
+        .map            = glm::vec4(m_descriptor.mapOrigin, 1.0f / m_descriptor.mapSize),
+        .placement =
+            {cellSize, m_descriptor.heightScale, m_descriptor.heightOffset, m_boundingRadius},
+        .scaleFade =
+            {m_descriptor.scaleRange.x,
+             m_descriptor.scaleRange.y,
+             std::max(maxDistance - m_descriptor.fadeDistance, 0.0f),
+             maxDistance},
+        .lodDistances = {},
+        .lodFirst     = {},
+        .lodCapacity  = {},
+        .grid         = glm::ivec4(firstCell, m_cellsPerSide, lodCount),
+        .seedChannel  = {m_descriptor.seed, m_descriptor.densityChannel, 0, 0},
+    };
+    for (uint32_t lod = 0; lod < lodCount; ++lod) {
+      params.lodDistances[lod] = m_descriptor.lods[lod].maxDistance;
+      params.lodFirst[lod]     = m_lodFirst[lod];
+      params.lodCapacity[lod]  = m_lodCapacity[lod];
+    }
+    m_uniformBuffers[frameSlot]->copyDataToBuffer(&params, sizeof(params));
+
+    m_context.beginDebugUtilsLabel(
+        commandBuffer, "Foliage: " + m_descriptor.name, {0.3f, 0.6f, 0.2f, 1.0f}
+    );
+
+    // Last frame's draws still read the instances and the instance counts
+    const VkMemoryBarrier drawDone = {
+        .sType         = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+        .srcAccessMask = 0,
+        .dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+    };
+    vkCmdPipelineBarrier(
+        commandBuffer,
+        VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT,
+        VK_PIPELINE_STAGE_TRANSFER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+        0,
+        1,
+        &drawDone,
+        0,
+        nullptr,
+        0,
+        nullptr
+    );
+    for (uint32_t lod = 0; lod < lodCount; ++lod) {
+      vkCmdFillBuffer(
+          commandBuffer,
+          m_drawBuffer->vkBuffer(),
+          lod * sizeof(VkDrawIndexedIndirectCommand) +
+              offsetof(VkDrawIndexedIndirectCommand, instanceCount),
+          sizeof(uint32_t),
+          0
+      );
+    }
+    const VkMemoryBarrier cleared = {
+        .sType         = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+        .srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+        .dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT,
+    };
+    vkCmdPipelineBarrier(
+        commandBuffer,
+        VK_PIPELINE_STAGE_TRANSFER_BIT,
+        VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+        0,
+        1,
+        &cleared,
+        0,
+        nullptr,
+        0,
+        nullptr
+    );
+
+    const uint32_t groups = (m_cellsPerSide + kGroupSize - 1) / kGroupSize;
+    m_scatterPipeline->bind(commandBuffer);
+    m_scatterPipeline->bindDescriptorSets(commandBuffer, {{.set = 0, .bindIdx = frameSlot}});
+    vkCmdDispatch(commandBuffer, groups, groups, 1);
+
+    const VkMemoryBarrier scattered = {
+        .sType         = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+        .srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT,
+        .dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_INDIRECT_COMMAND_READ_BIT,
+    };
+    vkCmdPipelineBarrier(
+        commandBuffer,
+        VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+        VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT,
+        0,
+        1,
+        &scattered,
+        0,
+        nullptr,
+        0,
+        nullptr
+    );
+
+    m_context.endDebugUtilsLabel(commandBuffer);
+    ++m_frameIndex;
+  }
+
+  void FoliageScatter::render(VkCommandBuffer commandBuffer, VkExtent2D extent) {
+    ZoneScopedN("FoliageScatter: render");
+
+    // update() has already advanced the frame, the matching uniforms are the
+    // previous slot
+    const uint32_t frameSlot =
+        (m_frameIndex + m_descriptor.framesInFlight - 1) % m_descriptor.framesInFlight;
+
+    const VkViewport viewport = {
+        .x        = 0.0f,
+        .y        = 0.0f,
+        .width    = static_cast<float>(extent.width),
+        .height   = static_cast<float>(extent.height),
+        .minDepth = 0.0f,
+        .maxDepth = 1.0f,
+    };
+    const VkRect2D scissor = {.offset = {0, 0}, .extent = extent};
+
+    m_renderPipeline->bind(commandBuffer);
+    vkCmdSetViewport(commandBuffer, 0, 1, &viewport);
+    vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
+    m_renderPipeline->bindDescriptorSets(commandBuffer, {{.set = 0, .bindIdx = frameSlot}});
+    m_renderPipeline->bindIndexBuffer(commandBuffer, m_indexBuffer->vkBuffer());
+
+    // Without multiDrawIndirect every LOD is its own call
+    const auto lodCount = static_cast<uint32_t>(m_descriptor.lods.size());
+    if (m_context.isMultiDrawIndirectEnabled()) {
+      vkCmdDrawIndexedIndirect(
+          commandBuffer,
+          m_drawBuffer->vkBuffer(),
+          0,
+          lodCount,
+          sizeof(VkDrawIndexedIndirectCommand)
+      );
+      return;
+    }
+    for (uint32_t lod = 0; lod < lodCount; ++lod) {
+      vkCmdDrawIndexedIndirect(
+          commandBuffer,
+          m_drawBuffer->vkBuffer(),
+          lod * sizeof(VkDrawIndexedIndirectCommand),
+          1,
+          sizeof(VkDrawIndexedIndirectCommand)
+      );
+    }
+  }
+} // namespace kst::renderer
@@ -0,0 +1,148 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "Mesh/MeshVertex.hpp"
+#include "VulkanBackend/VulkanCore/Common.hpp"
+
+namespace VulkanCore {
+  class Buffer;
+  class CommandQueueManager;
+  class Context;
+  class Pipeline;
+  class Sampler;
+  class ShaderModule;
+  class Texture;
+} // namespace VulkanCore
+
+namespace kst::renderer {
+  struct FoliageLod {
+    std::vector<MeshVertex> vertices;
+    std::vector<uint32_t> indices;
+    float maxDistance = 50.0f; // from the camera, increasing with each LOD
+  };
+
+  struct FoliageFrameInfo {
+    glm::mat4 view{1.0f};
+    glm::mat4 projection{1.0f};
+    glm::vec3 cameraPosition{0.0f};
+    glm::vec3 sunDirection{0.3f, 1.0f, 0.2f};
+    float ambient = 0.15f;
+  };
+
+  /**
+   * @brief Procedural instance scattering generated and drawn on the GPU
+   *
+   * Every frame a compute pass visits a grid of cells around the camera,
+   * cellSize apart and reaching the last LOD's maxDistance. Each cell holds
+   * at most one instance at a point jittered by a hash of the seed and the
+   * cell, kept with the probability read from one channel of the density
+   * map and placed on the height map; both maps cover the world rectangle
+   * [mapOrigin, mapOrigin + mapSize] on the XZ plane. Instances outside the
+   * frustum are dropped in the same pass and the rest are appended to the
+   * range of their LOD, one indexed indirect draw per LOD. Instance data is
+   * only ever written by the GPU, and since cells are fixed in world space
+   * the instances don't move as the camera does. Draws start at their LOD's
+   * instance range, which needs drawIndirectFirstInstance (see
+   * Context::enableIndirectRenderingFeature()).
+   *
+   * One FoliageScatter per kind of instance: grass and rocks would use two,
+   * with different meshes, seeds and density channels.
+   */
+  class FoliageScatter {
+  public:
+    static constexpr uint32_t kMaxLods = 4;
+
+    struct Descriptor {
+      std::vector<FoliageLod> lods;                    // nearest first, 1 to kMaxLods
+      std::shared_ptr<VulkanCore::Texture> densityMap; // [0, 1], shader read only layout
+      std::shared_ptr<VulkanCore::Texture> heightMap;  // R, shader read only layout
+      uint32_t densityChannel = 0;
+      glm::vec2 mapOrigin{0.0f};
+      glm::vec2 mapSize{1024.0f};
+      float heightScale  = 1.0f; // world height is R * heightScale + heightOffset
+      float heightOffset = 0.0f;
+      float cellSize     = 1.0f;
+      glm::vec2 scaleRange{0.8f, 1.2f};
+      float fadeDistance      = 10.0f; // density thins out over the last stretch
+      uint32_t seed           = 1;
+      glm::vec3 color         = {0.3f, 0.5f, 0.15f};
+      bool doubleSided        = false; // cards, lit from either side
+      uint32_t framesInFlight = 2;
+      VkFormat colorFormat    = VK_FORMAT_B8G8R8A8_UNORM;
+      VkFormat depthFormat    = VK_FORMAT_D32_SFLOAT;
+      std::string name        = "foliage";
+    };
+
+    FoliageScatter(VulkanCore::Context& context, Descriptor descriptor);
+    ~FoliageScatter();
+
+    FoliageScatter(const FoliageScatter&)                    = delete;
+    auto operator=(const FoliageScatter&) -> FoliageScatter& = delete;
+    FoliageScatter(FoliageScatter&&)                         = delete;
+    auto operator=(FoliageScatter&&) -> FoliageScatter&      = delete;
+
+    /**
+     * @brief Uploads the LOD meshes and the constant draw arguments
+     * @param queueManager Queue that owns commandBuffer, used to dispose staging buffers
+     * @param commandBuffer Command buffer in the recording state
+     *
+     * Must be recorded (and submitted) once before the first update().
+     */
+    void initialize(VulkanCore::CommandQueueManager& queueManager, VkCommandBuffer commandBuffer);
+
+    /**
+     * @brief Records the scatter pass for the camera
+     * @param commandBuffer Command buffer outside of a render pass
+     *
+     * Writes the uniform buffer of this frame's slot, so the frame that last
+     * used the slot must have finished.
+     */
+    void update(VkCommandBuffer commandBuffer, const FoliageFrameInfo& frame);
+
+    /**
+     * @brief Records one indexed indirect draw per LOD
+     * @param commandBuffer Command buffer inside dynamic rendering with the configured formats
+     * @param extent Render target extent for viewport and scissor
+     */
+    void render(VkCommandBuffer commandBuffer, VkExtent2D extent);
+
+    /**
+     * @brief Cells visited by every update()
+     */
+    auto candidateCount() const -> uint64_t { return uint64_t{m_cellsPerSide} * m_cellsPerSide; }
+
+    /**
+     * @brief Most instances a LOD can draw in one frame
+     */
+    auto lodCapacity(uint32_t lod) const -> uint32_t { return m_lodCapacity[lod]; }
+
+  private:
+    void createBuffers();
+    void createPipelines();
+
+    VulkanCore::Context& m_context;
+    Descriptor m_descriptor;
+    uint32_t m_cellsPerSide = 0;
+    float m_boundingRadius  = 0.0f;
+    std::vector<uint32_t> m_lodFirst;
+    std::vector<uint32_t> m_lodCapacity;
+    uint32_t m_frameIndex = 0;
+
+    std::shared_ptr<VulkanCore::Sampler> m_mapSampler;
+    std::shared_ptr<VulkanCore::Buffer> m_vertexBuffer;
+    std::shared_ptr<VulkanCore::Buffer> m_indexBuffer;
+    std::shared_ptr<VulkanCore::Buffer> m_instanceBuffer;
+    std::shared_ptr<VulkanCore::Buffer> m_drawBuffer;
+    std::vector<std::shared_ptr<VulkanCore::Buffer>> m_uniformBuffers;
+
+    std::vector<std::shared_ptr<VulkanCore::ShaderModule>> m_shaders;
+    std::shared_ptr<VulkanCore::Pipeline> m_scatterPipeline;
+    std::shared_ptr<VulkanCore::Pipeline> m_renderPipeline;
+  };
+} // namespace kst::renderer
@@ -0,0 +1,708 @@
+#include "GeometryPool.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <iterator>
+#include <limits>
+#include <string>
+
+#include <tracy/Tracy.hpp>
+
+#include "core/MemoryTracker.hpp"
+#include "core/Metrics.hpp"
+#include "VulkanBackend/VulkanCore/Buffer.hpp"
+#include "VulkanBackend/VulkanCore/Context.hpp"
+
+namespace kst::renderer {
+  namespace {
+    constexpr uint32_t kNoLocalIndex = 0xffffffffu;
+
+    // Table writes and cluster uploads recorded per update(); more wait for
+    // the next frame
+    constexpr uint32_t kMaxTableWritesPerFrame    = 4096;
+    constexpr uint32_t kMaxClusterUploadsPerFrame = 16384;
+
+    constexpr auto alignUp(uint32_t value, uint32_t alignment) -> uint32_t {
+      return (value + alignment - 1) / alignment * alignment;
+    }
+
+    // Vertices, then 8-bit local indices; 16-byte aligned so the next
+    // cluster's vertices stay vec4 aligned
+    constexpr auto clusterBytes(uint32_t vertexCount, uint32_t triangleCount) -> uint32_t {
+      return alignUp(vertexCount * sizeof(MeshVertex) + alignUp(triangleCount * 3, 4), 16);
+    }
+
+    constexpr uint32_t kMaxClusterBytes = clusterBytes(
+        GeometryPool::kMaxClusterVertices, GeometryPool::kMaxClusterTriangles
+    );
+
+    void pipelineBarrier(
+        VkCommandBuffer commandBuffer,
+        VkPipelineStageFlags srcStage,
+        VkAccessFlags srcAccess,
+        VkPipelineStageFlags dstStage,
+        VkAccessFlags dstAccess
+    ) {
+      const VkMemoryBarrier barrier = {
+          .sType         = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+          .srcAccessMask = srcAccess,
+          .dstAccessMask = dstAccess,
+      };
+      vkCmdPipelineBarrier(
+          commandBuffer, srcStage, dstStage, 0, 1, &barrier, 0, nullptr, 0, nullptr
+      );
+    }
+  } // namespace
+
+  auto GeometryPool::paginate(std::span<const GeometryLod> lods, uint32_t pageSize)
+      -> GeometryPages {
+    ASSERT(pageSize >= kMaxClusterBytes, "Geometry page can't hold a full cluster");
+
+    GeometryPages result;
+    std::vector<uint32_t> localIndex;
+    std::vector<uint32_t> clusterVertices;
+    std::vector<uint8_t> clusterIndices;
+
+    for (uint32_t lod = 0; lod < lods.size(); ++lod) {
+      const auto& source = lods[lod];
+      result.lodFirstCluster.push_back(static_cast<uint32_t>(result.clusters.size()));
+      result.lodFirstPage.push_back(static_cast<uint32_t>(result.pages.size()));
+      result.lodError.push_back(source.error);
+      localIndex.assign(source.vertices.size(), kNoLocalIndex);
+
+      GeometryPages::Page* page = nullptr;
+      const auto flush          = [&] {
+        if (clusterIndices.empty()) {
+          return;
+        }
+        const auto vertexCount   = static_cast<uint32_t>(clusterVertices.size());
+        const auto triangleCount = static_cast<uint32_t>(clusterIndices.size() / 3);
+        const uint32_t bytes     = clusterBytes(vertexCount, triangleCount);
+        if (page == nullptr || page->dataSize + bytes > pageSize) {
+          page = &result.pages.emplace_back(GeometryPages::Page{
+              .lod        = lod,
+              .dataOffset = static_cast<uint32_t>(result.data.size()),
+          });
+        }
+
+        GeometryCluster cluster;
+        glm::vec3 min(std::numeric_limits<float>::max());
+        glm::vec3 max(-std::numeric_limits<float>::max());
+        for (const uint32_t vertex : clusterVertices) {
+          min = glm::min(min, source.vertices[vertex].position);
+          max = glm::max(max, source.vertices[vertex].position);
+        }
+        cluster.center = (min + max) * 0.5f;
+        for (const uint32_t vertex : clusterVertices) {
+          const float distance = glm::length(source.vertices[vertex].position - cluster.center);
+          cluster.radius       = std::max(cluster.radius, distance);
+        }
+        cluster.virtualPage = static_cast<uint32_t>(result.pages.size() - 1);
+        cluster.pageOffset  = page->dataSize;
+        cluster.counts      = vertexCount | (triangleCount << 8);
+        cluster.error       = source.error;
+        result.clusters.push_back(cluster);
+
+        const size_t start = result.data.size();
+        result.data.resize(start + bytes);
+        auto* out          = reinterpret_cast<MeshVertex*>(result.data.data() + start);
+        for (uint32_t i = 0; i < vertexCount; ++i) {
+          out[i] = source.vertices[clusterVertices[i]];
+        }
+        std::memcpy(out + vertexCount, clusterIndices.data(), clusterIndices.size());
+        page->dataSize += bytes;
+
+        for (const uint32_t vertex : clusterVertices) {
+          localIndex[vertex] = kNoLocalIndex;
+        }
+        clusterVertices.clear();
+        clusterIndices.clear();
+      };
+
+      for (size_t first = 0; first + 2 < source.indices.size(); first += 3) {
+        const uint32_t* triangle = &source.indices[first];
+        uint32_t added           = 0;
+        for (int corner = 0; corner < 3; ++corner) {
+          ASSERT(triangle[corner] < source.vertices.size(), "Geometry index out of range");
+          const bool repeated = (corner > 0 && triangle[corner] == triangle[0]) ||
+                                (corner > 1 && triangle[corner] == triangle[1]);
+          if (localIndex[triangle[corner]] == kNoLocalIndex && !repeated) {
+            ++added;
+          }
+        }
+        if (clusterVertices.size() + added > kMaxClusterVertices ||
+            clusterIndices.size() / 3 + 1 > kMaxClusterTriangles) {
+          flush();
+        }
+        for (int corner = 0; corner < 3; ++corner) {
+          uint32_t& local = localIndex[triangle[corner]];
+          if (local == kNoLocalIndex) {
+            local = static_cast<uint32_t>(clusterVertices.size());
+            clusterVertices.push_back(triangle[corner]);
+          }
+          clusterIndices.push_back(static_cast<uint8_t>(local));
+        }
+      }
+      flush();
+    }
+    result.lodFirstCluster.push_back(static_cast<uint32_t>(result.clusters.size()));
+    result.lodFirstPage.push_back(static_cast<uint32_t>(result.pages.size()));
+    return result;
+  }
+
+  GeometryPool::GeometryPool(VulkanCore::Context& context, const Descriptor& descriptor)
+      : m_context(context), m_descriptor(descriptor), m_name(descriptor.name) {
+    ASSERT(m_descriptor.framesInFlight > 0, "GeometryPool needs at least one frame in flight");
+    ASSERT(
+        m_descriptor.pageSize >= kMaxClusterBytes && m_descriptor.pageSize % 16 == 0,
+        "Geometry page size must be a multiple of 16 that holds a full cluster"
+    );
+    m_descriptor.uploadBytesPerFrame =
+        std::max<uint64_t>(m_descriptor.uploadBytesPerFrame, m_descriptor.pageSize);
+    m_descriptor.maxVirtualPages = alignUp(m_descriptor.maxVirtualPages, 32);
+
+    m_pageBuffer = m_context.createBuffer(
+        static_cast<size_t>(m_descriptor.physicalPages) * m_descriptor.pageSize,
+        VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+        VMA_MEMORY_USAGE_GPU_ONLY,
+        "Geometry pages: " + m_name
+    );
+    m_clusterBuffer = m_context.createBuffer(
+        static_cast<size_t>(m_descriptor.maxClusters) * sizeof(GeometryCluster),
+        VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+        VMA_MEMORY_USAGE_GPU_ONLY,
+        "Geometry clusters: " + m_name
+    );
+    m_pageTableBuffer = m_context.createBuffer(
+        static_cast<size_t>(m_descriptor.maxVirtualPages) * sizeof(uint32_t),
+        VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+        VMA_MEMORY_USAGE_GPU_ONLY,
+        "Geometry page table: " + m_name
+    );
+    const size_t feedbackBytes = m_descriptor.maxVirtualPages / 8;
+    m_feedbackBuffer           = m_context.createBuffer(
+        feedbackBytes,
+        VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT |
+            VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+        VMA_MEMORY_USAGE_GPU_ONLY,
+        "Geometry feedback: " + m_name
+    );
+
+    const size_t stagingBytes = m_descriptor.uploadBytesPerFrame +
+                                kMaxTableWritesPerFrame * sizeof(uint32_t) +
+                                kMaxClusterUploadsPerFrame * sizeof(GeometryCluster);
+    for (uint32_t frame = 0; frame < m_descriptor.framesInFlight; ++frame) {
+      m_feedbackReadback.push_back(m_context.createReadbackBuffer(
+          feedbackBytes, "Geometry feedback readback " + std::to_string(frame) + ": " + m_name
+      ));
+      m_staging.push_back(m_context.createPersistentBuffer(
+          stagingBytes,
+          VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+          "Geometry staging " + std::to_string(frame) + ": " + m_name
+      ));
+    }
+    m_feedbackRecorded.assign(m_descriptor.framesInFlight, false);
+
+    m_freePhysical.resize(m_descriptor.physicalPages);
+    for (uint32_t page = 0; page < m_descriptor.physicalPages; ++page) {
+      // Popped from the back, so low pages fill first
+      m_freePhysical[page] = m_descriptor.physicalPages - 1 - page;
+    }
+
+    auto& metrics      = core::MetricsRegistry::instance();
+    const auto labels  = "pool=\"" + m_name + "\"";
+    m_residentGauge    = &metrics.gauge(
+        "kst_geometry_resident_pages", "Geometry pages resident in the pool", labels
+    );
+    m_uploadBytesTotal = &metrics.counter(
+        "kst_geometry_upload_bytes_total", "Geometry page bytes uploaded", labels
+    );
+    m_evictionsTotal = &metrics.counter(
+        "kst_geometry_evictions_total", "Geometry pages evicted", labels
+    );
+  }
+
+  GeometryPool::~GeometryPool() = default;
+
+  auto GeometryPool::RangeAllocator::allocate(uint32_t count, uint32_t limit) -> uint32_t {
+    if (count == 0) {
+      return 0;
+    }
+    for (auto range = free.begin(); range != free.end(); ++range) {
+      if (range->count >= count) {
+        const uint32_t first = range->first;
+        range->first += count;
+        range->count -= count;
+        if (range->count == 0) {
+          free.erase(range);
+        }
+        return first;
+      }
+    }
+    // The tail of the table is only free while it is past end
+    if (count > limit - end) {
+      return kInvalidPage;
+    }
+    end += count;
+    return end - count;
+  }
+
+  void GeometryPool::RangeAllocator::release(uint32_t first, uint32_t count) {
+    if (count == 0) {
+      return;
+    }
+    auto next = std::ranges::lower_bound(free, first, {}, &Range::first);
+    if (next != free.end() && first + count == next->first) {
+      next->first = first;
+      next->count += count;
+    } else {
+      next = free.insert(next, {.first = first, .count = count});
+    }
+    if (next != free.begin()) {
+      const auto previous = std::prev(next);
+      if (previous->first + previous->count == next->first) {
+        previous->count += next->count;
+        next = std::prev(free.erase(next));
+      }
+    }
+    // A free range reaching end gives the tail back
+    if (next->first + next->count == end) {
+      end = next->first;
+      free.erase(next);
+    }
+  }
+
+  auto GeometryPool::addMesh(std::span<const GeometryLod> lods) -> uint32_t {
+    KST_MEMORY_SCOPE(Assets);
+    auto pages = std::make_shared<const GeometryPages>(paginate(lods, m_descriptor.pageSize));
+    return addMesh(*pages, [pages](uint32_t page, std::span<std::byte> payload) {
+      const std::byte* data = pages->data.data() + pages->pages[page].dataOffset;
+      std::memcpy(payload.data(), data, payload.size());
+    });
+  }
+
+  auto GeometryPool::addMesh(const GeometryPages& pages, GeometryPageSource source)
+      -> uint32_t {
+    KST_MEMORY_SCOPE(Assets);
+    ASSERT(source, "GeometryPool meshes need a page source");
+    ASSERT(
+        pages.lodFirstPage.size() == pages.lodError.size() + 1 &&
+            pages.lodFirstCluster.size() == pages.lodFirstPage.size(),
+        "Geometry pages don't come from paginate()"
+    );
+
+    const auto pageCount    = static_cast<uint32_t>(pages.pages.size());
+    const auto clusterCount = static_cast<uint32_t>(pages.clusters.size());
+    const uint32_t pageBase =
+        m_virtualPageRanges.allocate(pageCount, m_descriptor.maxVirtualPages);
+    ASSERT(pageBase != kInvalidPage, "GeometryPool is out of virtual pages");
+    const uint32_t clusterBase = m_clusterRanges.allocate(clusterCount, m_descriptor.maxClusters);
+    ASSERT(clusterBase != kInvalidPage, "GeometryPool cluster table is full");
+
+    uint32_t meshId = static_cast<uint32_t>(m_meshes.size());
+    if (m_freeMeshes.empty()) {
+      m_meshes.emplace_back();
+    } else {
+      meshId = m_freeMeshes.back();
+      m_freeMeshes.pop_back();
+    }
+
+    if (m_pages.size() < m_virtualPageRanges.end) {
+      m_pages.resize(m_virtualPageRanges.end);
+    }
+    for (uint32_t page = 0; page < pageCount; ++page) {
+      m_pages[pageBase + page] = {
+          .mesh     = meshId,
+          .meshPage = page,
+          .dataSize = pages.pages[page].dataSize,
+          .lod      = pages.pages[page].lod,
+      };
+    }
+
+    if (clusterCount > 0) {
+      ClusterUpload& upload = m_clusterUploads.emplace_back(ClusterUpload{
+          .mesh         = meshId,
+          .firstCluster = clusterBase,
+          .clusters     = pages.clusters,
+      });
+      for (auto& cluster : upload.clusters) {
+        cluster.virtualPage += pageBase;
+      }
+    }
+
+    MeshEntry& entry      = m_meshes[meshId];
+    entry.source          = std::move(source);
+    entry.firstPage       = pageBase;
+    entry.pageCount       = pageCount;
+    entry.firstCluster    = clusterBase;
+    entry.clusterCount    = clusterCount;
+    entry.clustersPending = clusterCount > 0;
+    for (uint32_t lod = 0; lod < pages.lodError.size(); ++lod) {
+      entry.mesh.lods.push_back({
+          .firstCluster = clusterBase + pages.lodFirstCluster[lod],
+          .clusterCount = pages.lodFirstCluster[lod + 1] - pages.lodFirstCluster[lod],
+          .firstPage    = pageBase + pages.lodFirstPage[lod],
+          .pageCount    = pages.lodFirstPage[lod + 1] - pages.lodFirstPage[lod],
+          .error        = pages.lodError[lod],
+      });
+    }
+    return meshId;
+  }
+
+  void GeometryPool::removeMesh(uint32_t meshId) {
+    ASSERT(
+        meshId < m_meshes.size() && m_meshes[meshId].source,
+        "GeometryPool mesh was never added or already removed"
+    );
+    MeshEntry& entry = m_meshes[meshId];
+    const auto owned = [&](uint32_t page) {
+      return page >= entry.firstPage && page < entry.firstPage + entry.pageCount;
+    };
+
+    // Frames recorded so far may still read the physical pages; the page
+    // table entries are cleared by the next update()
+    for (uint32_t page = entry.firstPage; page < entry.firstPage + entry.pageCount; ++page) {
+      if (m_pages[page].physical != kInvalidPage) {
+        m_retired.push_back({.physical = m_pages[page].physical, .frame = m_frame});
+      }
+      m_pages[page] = {};
+    }
+    std::erase_if(m_residentPages, owned);
+    std::erase_if(m_requests, owned);
+    std::erase_if(m_clusterUploads, [meshId](const ClusterUpload& upload) {
+      return upload.mesh == meshId;
+    });
+
+    m_removed.push_back({
+        .firstPage    = entry.firstPage,
+        .pageCount    = entry.pageCount,
+        .firstCluster = entry.firstCluster,
+        .clusterCount = entry.clusterCount,
+    });
+    entry = {};
+    m_freeMeshes.push_back(meshId);
+  }
+
+  void GeometryPool::request(uint32_t meshId, uint32_t lod) {
+    const auto& range = m_meshes[meshId].mesh.lods[lod];
+    for (uint32_t page = range.firstPage; page < range.firstPage + range.pageCount; ++page) {
+      demand(page);
+    }
+  }
+
+  auto GeometryPool::isResident(uint32_t meshId, uint32_t lod) const -> bool {
+    const auto& range = m_meshes[meshId].mesh.lods[lod];
+    if (m_meshes[meshId].clustersPending) {
+      return false;
+    }
+    for (uint32_t page = range.firstPage; page < range.firstPage + range.pageCount; ++page) {
+      if (m_pages[page].physical == kInvalidPage) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  void GeometryPool::demand(uint32_t virtualPage) {
+    // Feedback from frames in flight can still name pages of removed meshes
+    if (virtualPage >= m_pages.size() || m_pages[virtualPage].mesh == kNoMesh) {
+      return;
+    }
+    VirtualPage& page = m_pages[virtualPage];
+    page.lastUsed     = m_frame;
+    if (page.physical == kInvalidPage && !page.requested) {
+      page.requested = true;
+      m_requests.push_back(virtualPage);
+    }
+  }
+
+  void GeometryPool::readFeedback(uint32_t frameSlot) {
+    if (!m_feedbackRecorded[frameSlot]) {
+      return;
+    }
+    m_feedbackRecorded[frameSlot] = false;
+
+    const auto& readback = m_feedbackReadback[frameSlot];
+    readback->invalidate();
+    const auto* words    = static_cast<const uint32_t*>(readback->map());
+    const uint32_t count = static_cast<uint32_t>(std::min<size_t>(
+        m_descriptor.maxVirtualPages / 32, (m_pages.size() + 31) / 32
+    ));
+    for (uint32_t word = 0; word < count; ++word) {
+      for (uint32_t bits = words[word]; bits != 0; bits &= bits - 1) {
+        demand(word * 32 + static_cast<uint32_t>(std::countr_zero(bits)));
+      }
+    }
+  }
+
+  auto GeometryPool::evictForRequests(size_t wanted, std::vector<TableWrite>& tableWrites)
+      -> uint32_t {
+    // Pages the latest feedback still saw are kept, or a view that needs more
+    // than the pool would evict its own pages every frame
+    std::vector<uint32_t> candidates;
+    for (const uint32_t page : m_residentPages) {
+      if (m_pages[page].lastUsed + m_descriptor.framesInFlight < m_frame) {
+        candidates.push_back(page);
+      }
+    }
+    const size_t count =
+        std::min({wanted, candidates.size(), size_t{kMaxTableWritesPerFrame / 2}});
+    std::ranges::partial_sort(candidates, candidates.begin() + count, {}, [this](uint32_t page) {
+      return m_pages[page].lastUsed;
+    });
+    candidates.resize(count);
+
+    for (const uint32_t virtualPage : candidates) {
+      VirtualPage& page = m_pages[virtualPage];
+      m_retired.push_back({.physical = page.physical, .frame = m_frame});
+      tableWrites.push_back({.virtualPage = virtualPage, .entry = kInvalidPage});
+      page.physical = kInvalidPage;
+    }
+    std::erase_if(m_residentPages, [this](uint32_t page) {
+      return m_pages[page].physical == kInvalidPage;
+    });
+    m_evictionsTotal->add(count);
+    return static_cast<uint32_t>(count);
+  }
+
+  void GeometryPool::update(VkCommandBuffer commandBuffer, uint32_t frameSlot) {
+    ZoneScopedN("GeometryPool: update");
+
+    ++m_frame;
+    m_stats.uploadedPages = 0;
+    m_stats.evictedPages  = 0;
+    m_stats.uploadedBytes = 0;
+
+    readFeedback(frameSlot);
+
+    // Physical pages unmapped framesInFlight frames ago are no longer read
+    std::erase_if(m_retired, [this](const RetiredPage& retired) {
+      if (retired.frame + m_descriptor.framesInFlight > m_frame) {
+        return false;
+      }
+      m_freePhysical.push_back(retired.physical);
+      return true;
+    });
+    std::erase_if(m_retiredRanges, [this](const RemovedRanges& removed) {
+      if (removed.frame + m_descriptor.framesInFlight > m_frame) {
+        return false;
+      }
+      m_virtualPageRanges.release(removed.firstPage, removed.pageCount);
+      m_clusterRanges.release(removed.firstCluster, removed.clusterCount);
+      return true;
+    });
+
+    // Coarse LODs first: they're the fallback while finer pages stream in
+    std::ranges::stable_sort(m_requests, std::greater{}, [this](uint32_t page) {
+      return m_pages[page].lod;
+    });
+
+    // Evicted pages free up framesInFlight frames from now; pages already
+    // retired count as on their way
+    std::vector<TableWrite> tableWrites;
+    const size_t available = m_freePhysical.size() + m_retired.size();
+    if (m_requests.size() > available) {
+      m_stats.evictedPages = evictForRequests(m_requests.size() - available, tableWrites);
+    }
+
+    auto* staging       = static_cast<std::byte*>(m_staging[frameSlot]->map());
+    uint64_t stagingEnd = 0;
+    std::vector<VkBufferCopy> pageCopies;
+    size_t served = 0;
+    for (; served < m_requests.size(); ++served) {
+      const uint32_t virtualPage = m_requests[served];
+      VirtualPage& page          = m_pages[virtualPage];
+      if (m_freePhysical.empty() || tableWrites.size() == kMaxTableWritesPerFrame ||
+          stagingEnd + page.dataSize > m_descriptor.uploadBytesPerFrame) {
+        break;
+      }
+      page.physical  = m_freePhysical.back();
+      page.requested = false;
+      m_freePhysical.pop_back();
+      m_residentPages.push_back(virtualPage);
+
+      const auto physicalOffset = static_cast<VkDeviceSize>(page.physical) * m_descriptor.pageSize;
+      m_meshes[page.mesh].source(page.meshPage, {staging + stagingEnd, page.dataSize});
+      pageCopies.push_back({
+          .srcOffset = stagingEnd,
+          .dstOffset = physicalOffset,
+          .size      = page.dataSize,
+      });
+      tableWrites.push_back({
+          .virtualPage = virtualPage,
+          .entry       = static_cast<uint32_t>(physicalOffset / sizeof(uint32_t)),
+      });
+      stagingEnd += alignUp(page.dataSize, 16);
+      m_stats.uploadedBytes += page.dataSize;
+      ++m_stats.uploadedPages;
+    }
+    m_requests.erase(m_requests.begin(), m_requests.begin() + static_cast<ptrdiff_t>(served));
+
+    // Page table entries go through staging as words, one copy region each
+    uint64_t stagingCursor = m_descriptor.uploadBytesPerFrame;
+    std::vector<VkBufferCopy> tableCopies;
+    for (const auto& write : tableWrites) {
+      std::memcpy(staging + stagingCursor, &write.entry, sizeof(uint32_t));
+      tableCopies.push_back({
+          .srcOffset = stagingCursor,
+          .dstOffset = static_cast<VkDeviceSize>(write.virtualPage) * sizeof(uint32_t),
+          .size      = sizeof(uint32_t),
+      });
+      stagingCursor += sizeof(uint32_t);
+    }
+
+    // Clusters of the oldest meshes first, one copy region per mesh
+    stagingCursor = m_descriptor.uploadBytesPerFrame + kMaxTableWritesPerFrame * sizeof(uint32_t);
+    std::vector<VkBufferCopy> clusterCopies;
+    uint32_t clusterBudget = kMaxClusterUploadsPerFrame;
+    for (auto& upload : m_clusterUploads) {
+      if (clusterBudget == 0) {
+        break;
+      }
+      const auto count = std::min(
+          clusterBudget, static_cast<uint32_t>(upload.clusters.size()) - upload.uploaded
+      );
+      const VkBufferCopy& copy = clusterCopies.emplace_back(VkBufferCopy{
+          .srcOffset = stagingCursor,
+          .dstOffset = static_cast<VkDeviceSize>(upload.firstCluster + upload.uploaded) *
+                       sizeof(GeometryCluster),
+          .size      = static_cast<VkDeviceSize>(count) * sizeof(GeometryCluster),
+      });
+      std::memcpy(staging + stagingCursor, upload.clusters.data() + upload.uploaded, copy.size);
+      stagingCursor += copy.size;
+      upload.uploaded += count;
+      clusterBudget -= count;
+    }
+    std::erase_if(m_clusterUploads, [this](const ClusterUpload& upload) {
+      if (upload.uploaded < upload.clusters.size()) {
+        return false;
+      }
+      m_meshes[upload.mesh].clustersPending = false;
+      return true;
+    });
+
+    m_stats.residentPages = static_cast<uint32_t>(m_residentPages.size());
+    m_stats.pendingPages  = static_cast<uint32_t>(m_requests.size());
+    m_residentGauge->set(static_cast<double>(m_stats.residentPages));
+    m_uploadBytesTotal->add(m_stats.uploadedBytes);
+
+    const bool firstUpdate = m_frame == 1;
+    if (!firstUpdate && pageCopies.empty() && tableCopies.empty() && clusterCopies.empty() &&
+        m_removed.empty()) {
+      return;
+    }
+
+    // Earlier frames may still read the table and the clusters being written
+    pipelineBarrier(
+        commandBuffer,
+        VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
+        VK_ACCESS_SHADER_READ_BIT,
+        VK_PIPELINE_STAGE_TRANSFER_BIT,
+        VK_ACCESS_TRANSFER_WRITE_BIT
+    );
+    if (firstUpdate) {
+      vkCmdFillBuffer(commandBuffer, m_pageTableBuffer->vkBuffer(), 0, VK_WHOLE_SIZE, kInvalidPage);
+      vkCmdFillBuffer(commandBuffer, m_feedbackBuffer->vkBuffer(), 0, VK_WHOLE_SIZE, 0);
+      // The fill and the table copies both write the table
+      pipelineBarrier(
+          commandBuffer,
+          VK_PIPELINE_STAGE_TRANSFER_BIT,
+          VK_ACCESS_TRANSFER_WRITE_BIT,
+          VK_PIPELINE_STAGE_TRANSFER_BIT,
+          VK_ACCESS_TRANSFER_WRITE_BIT
+      );
+    }
+
+    // Virtual pages of removed meshes are unmapped before anything reuses
+    // them; nothing else writes their entries this frame
+    for (auto& removed : m_removed) {
+      if (removed.pageCount > 0) {
+        vkCmdFillBuffer(
+            commandBuffer,
+            m_pageTableBuffer->vkBuffer(),
+            static_cast<VkDeviceSize>(removed.firstPage) * sizeof(uint32_t),
+            static_cast<VkDeviceSize>(removed.pageCount) * sizeof(uint32_t),
+            kInvalidPage
+        );
+      }
+      removed.frame = m_frame;
+      m_retiredRanges.push_back(removed);
+    }
+    m_removed.clear();
+
+    const VkBuffer stagingBuffer = m_staging[frameSlot]->vkBuffer();
+    if (!pageCopies.empty()) {
+      vkCmdCopyBuffer(
+          commandBuffer,
+          stagingBuffer,
+          m_pageBuffer->vkBuffer(),
+          static_cast<uint32_t>(pageCopies.size()),
+          pageCopies.data()
+      );
+    }
+    if (!tableCopies.empty()) {
+      vkCmdCopyBuffer(
+          commandBuffer,
+          stagingBuffer,
+          m_pageTableBuffer->vkBuffer(),
+          static_cast<uint32_t>(tableCopies.size()),
+          tableCopies.data()
+      );
+    }
+    if (!clusterCopies.empty()) {
+      vkCmdCopyBuffer(
+          commandBuffer,
+          stagingBuffer,
+          m_clusterBuffer->vkBuffer(),
+          static_cast<uint32_t>(clusterCopies.size()),
+          clusterCopies.data()
+      );
+    }
+
+    pipelineBarrier(
+        commandBuffer,
+        VK_PIPELINE_STAGE_TRANSFER_BIT,
+        VK_ACCESS_TRANSFER_WRITE_BIT,
+        VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
+        VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT
+    );
+  }
+
+  void GeometryPool::recordFeedback(VkCommandBuffer commandBuffer, uint32_t frameSlot) {
+    ZoneScopedN("GeometryPool: recordFeedback");
+
+    pipelineBarrier(
+        commandBuffer,
+        VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
+        VK_ACCESS_SHADER_WRITE_BIT,
+        VK_PIPELINE_STAGE_TRANSFER_BIT,
+        VK_ACCESS_TRANSFER_READ_BIT | VK_ACCESS_TRANSFER_WRITE_BIT
+    );
+    const VkBufferCopy copy = {.size = m_feedbackBuffer->size()};
+    vkCmdCopyBuffer(
+        commandBuffer,
+        m_feedbackBuffer->vkBuffer(),
+        m_feedbackReadback[frameSlot]->vkBuffer(),
+        1,
+        &copy
+    );
+    // Cleared for the next frame once the copy has read it
+    pipelineBarrier(
+        commandBuffer,
+        VK_PIPELINE_STAGE_TRANSFER_BIT,
+        VK_ACCESS_TRANSFER_READ_BIT,
+        VK_PIPELINE_STAGE_TRANSFER_BIT,
+        VK_ACCESS_TRANSFER_WRITE_BIT
+    );
+    vkCmdFillBuffer(commandBuffer, m_feedbackBuffer->vkBuffer(), 0, VK_WHOLE_SIZE, 0);
+    pipelineBarrier(
+        commandBuffer,
+        VK_PIPELINE_STAGE_TRANSFER_BIT,
+        VK_ACCESS_TRANSFER_WRITE_BIT,
+        VK_PIPELINE_STAGE_ALL_COMMANDS_BIT | VK_PIPELINE_STAGE_HOST_BIT,
+        VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT | VK_ACCESS_HOST_READ_BIT
+    );
+    m_feedbackRecorded[frameSlot] = true;
+  }
+} // namespace kst::renderer
@@ -0,0 +1,333 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <span>
+#include <string>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "MeshVertex.hpp"
+#include "VulkanBackend/VulkanCore/Common.hpp"
+
+namespace VulkanCore {
+  class Buffer;
+  class Context;
+} // namespace VulkanCore
+
+namespace kst::core {
+  class Counter;
+  class Gauge;
+} // namespace kst::core
+
+namespace kst::renderer {
+  /**
+   * @brief One level of detail handed to GeometryPool::addMesh()
+   */
+  struct GeometryLod {
+    std::span<const MeshVertex> vertices;
+    std::span<const uint32_t> indices;
+    float error = 0.0f; // object-space simplification error, 0 for the full mesh
+  };
+
+  /**
+   * @brief GPU side of a cluster, mirrored in shaders/mesh/geometry_pool.glsl
+   */
+  struct GeometryCluster {
+    glm::vec3 center{0.0f};
+    float radius         = 0.0f;
+    uint32_t virtualPage = 0;
+    uint32_t pageOffset  = 0; // bytes from the start of the page
+    uint32_t counts      = 0; // vertexCount | triangleCount << 8
+    float error          = 0.0f;
+  };
+  static_assert(sizeof(GeometryCluster) == 32, "GeometryCluster must match the std430 layout");
+
+  struct GeometryMeshLod {
+    uint32_t firstCluster = 0;
+    uint32_t clusterCount = 0;
+    uint32_t firstPage    = 0; // virtual pages, contiguous per LOD
+    uint32_t pageCount    = 0;
+    float error           = 0.0f;
+  };
+
+  struct GeometryMesh {
+    std::vector<GeometryMeshLod> lods; // finest first
+  };
+
+  /**
+   * @brief Clusters and page payloads of one mesh before it enters a pool
+   *
+   * Clusters hold at most kMaxClusterVertices vertices and
+   * kMaxClusterTriangles triangles with 8-bit local indices; a page packs
+   * whole clusters of one LOD, in index order, up to pageSize bytes.
+   */
+  struct GeometryPages {
+    struct Page {
+      uint32_t lod        = 0;
+      uint32_t dataOffset = 0; // into data
+      uint32_t dataSize   = 0;
+    };
+
+    std::vector<GeometryCluster> clusters; // virtualPage is relative to pages
+    std::vector<Page> pages;
+    std::vector<uint32_t> lodFirstCluster; // per LOD, plus one past the end
+    std::vector<uint32_t> lodFirstPage;
+    std::vector<float> lodError;
+    // Not needed by the pool once the payload lives elsewhere, e.g. on disk
+    std::vector<std::byte> data;
+  };
+
+  /**
+   * @brief Writes the payload of one of a mesh's pages
+   *
+   * Called by GeometryPool::update() every time the page is loaded, with the
+   * page's index into GeometryPages::pages and exactly its dataSize bytes of
+   * staging memory to fill. Runs on the thread recording the update, so it
+   * should read data that is already in memory or mapped.
+   */
+  using GeometryPageSource = std::function<void(uint32_t page, std::span<std::byte> payload)>;
+
+  /**
+   * @brief Mesh geometry paged into one fixed-size device buffer
+   *
+   * Every mesh is split into clusters and the clusters packed into
+   * fixed-size pages. The pool only keeps the small cluster table; a page's
+   * payload is fetched from the mesh's GeometryPageSource whenever the page
+   * is copied into a physical page of the one device-local buffer, so device
+   * memory for geometry is physicalPages * pageSize however large the world
+   * is. removeMesh() returns a mesh's virtual pages and clusters for reuse,
+   * which keeps a pool usable while a world streams through it.
+   *
+   * Shaders see four buffers (shaders/mesh/geometry_pool.glsl): the page
+   * buffer, the cluster table, the page table mapping virtual to physical
+   * pages, and a feedback bitmask. Looking up a page marks it in the
+   * feedback; recordFeedback() copies the mask back, and the next update() on
+   * that frame slot pages in missing pages and keeps used ones alive.
+   * Shaders fall back to a coarser LOD while the one they want is missing, so
+   * coarse pages are loaded first. request() adds demand from the CPU, e.g.
+   * for the coarsest LOD of everything nearby.
+   *
+   * Eviction is least recently used, and a physical page is reused only
+   * framesInFlight frames after it was unmapped, so frames still in flight
+   * never read a page being overwritten. Uploads per update() are capped by
+   * uploadBytesPerFrame.
+   *
+   * @code
+   * GeometryPool pool(context, {.physicalPages = 1024});
+   * const uint32_t rock = pool.addMesh(rockLods);
+   * // each frame, after the fence for frameSlot was waited on
+   * pool.update(commandBuffer, frameSlot);
+   * ... culling and draws read the pool ...
+   * pool.recordFeedback(commandBuffer, frameSlot);
+   * @endcode
+   */
+  class GeometryPool {
+  public:
+    static constexpr uint32_t kMaxClusterVertices  = 64;
+    static constexpr uint32_t kMaxClusterTriangles = 124;
+    static constexpr uint32_t kInvalidPage         = 0xffffffffu;
+
+    struct Descriptor {
+      uint32_t pageSize            = 64u << 10;
+      uint32_t physicalPages       = 1024;
+      uint32_t maxVirtualPages     = 1u << 20;
+      uint32_t maxClusters         = 1u << 19;
+      uint64_t uploadBytesPerFrame = 4ull << 20;
+      uint32_t framesInFlight      = 2;
+      std::string name             = "geometry";
+    };
+
+    struct Stats {
+      uint32_t residentPages = 0;
+      uint32_t pendingPages  = 0; // requested, not resident yet
+      uint32_t uploadedPages = 0; // by the last update()
+      uint32_t evictedPages  = 0; // by the last update()
+      uint64_t uploadedBytes = 0; // by the last update()
+    };
+
+    /**
+     * @brief Splits LODs into clusters and pages; no GPU work
+     */
+    static auto paginate(std::span<const GeometryLod> lods, uint32_t pageSize) -> GeometryPages;
+
+    GeometryPool(VulkanCore::Context& context, const Descriptor& descriptor);
+    ~GeometryPool();
+
+    GeometryPool(const GeometryPool&)                    = delete;
+    auto operator=(const GeometryPool&) -> GeometryPool& = delete;
+    GeometryPool(GeometryPool&&)                         = delete;
+    auto operator=(GeometryPool&&) -> GeometryPool&      = delete;
+
+    /**
+     * @brief Registers a mesh; its pages load when first requested
+     * @param lods Finest first
+     * @return Mesh id for mesh() and request()
+     *
+     * The payload stays in host memory until the mesh is removed.
+     */
+    auto addMesh(std::span<const GeometryLod> lods) -> uint32_t;
+
+    /**
+     * @brief Registers a mesh paginated with pageSize ahead of time
+     * @param pages Layout from paginate(); data is ignored
+     * @param source Fills page payloads when they load
+     * @return Mesh id for mesh() and request()
+     */
+    auto addMesh(const GeometryPages& pages, GeometryPageSource source) -> uint32_t;
+
+    /**
+     * @brief Frees a mesh's pages and clusters; its id may be handed out again
+     *
+     * Stop drawing the mesh first. Frames in flight may still read it: its
+     * virtual pages and clusters are reused framesInFlight updates later.
+     */
+    void removeMesh(uint32_t meshId);
+
+    auto mesh(uint32_t meshId) const -> const GeometryMesh& { return m_meshes[meshId].mesh; }
+
+    /**
+     * @brief Asks for every page of a mesh LOD by the next update()
+     */
+    void request(uint32_t meshId, uint32_t lod);
+
+    auto isResident(uint32_t meshId, uint32_t lod) const -> bool;
+
+    /**
+     * @brief Applies feedback and requests, then records evictions and uploads
+     * @param commandBuffer Command buffer outside of a render pass, recorded
+     * before anything in the frame reads the pool
+     * @param frameSlot Slot whose previous frame has finished on the GPU
+     */
+    void update(VkCommandBuffer commandBuffer, uint32_t frameSlot);
+
+    /**
+     * @brief Copies this frame's feedback for the slot's next update() and
+     * clears it; record after the last pass that reads the pool
+     */
+    void recordFeedback(VkCommandBuffer commandBuffer, uint32_t frameSlot);
+
+    auto stats() const -> const Stats& { return m_stats; }
+
+    auto descriptor() const -> const Descriptor& { return m_descriptor; }
+
+    auto pageBuffer() const -> const std::shared_ptr<VulkanCore::Buffer>& { return m_pageBuffer; }
+
+    auto clusterBuffer() const -> const std::shared_ptr<VulkanCore::Buffer>& {
+      return m_clusterBuffer;
+    }
+
+    auto pageTableBuffer() const -> const std::shared_ptr<VulkanCore::Buffer>& {
+      return m_pageTableBuffer;
+    }
+
+    auto feedbackBuffer() const -> const std::shared_ptr<VulkanCore::Buffer>& {
+      return m_feedbackBuffer;
+    }
+
+  private:
+    static constexpr uint32_t kNoMesh = 0xffffffffu;
+
+    struct MeshEntry {
+      GeometryMesh mesh;
+      GeometryPageSource source; // empty once removed
+      uint32_t firstPage    = 0;
+      uint32_t pageCount    = 0;
+      uint32_t firstCluster = 0;
+      uint32_t clusterCount = 0;
+      bool clustersPending  = false; // not all in the cluster table yet
+    };
+
+    struct VirtualPage {
+      uint32_t mesh     = kNoMesh; // kNoMesh while the page is free
+      uint32_t meshPage = 0;       // index for the mesh's page source
+      uint32_t dataSize = 0;
+      uint32_t lod      = 0;
+      uint32_t physical = kInvalidPage;
+      bool requested    = false;
+      uint64_t lastUsed = 0;
+    };
+
+    // First-fit free list over the indices of a table, growing it up to a limit
+    struct RangeAllocator {
+      struct Range {
+        uint32_t first;
+        uint32_t count;
+      };
+
+      // kInvalidPage when no range of count entries fits below limit
+      auto allocate(uint32_t count, uint32_t limit) -> uint32_t;
+      void release(uint32_t first, uint32_t count);
+
+      std::vector<Range> free; // sorted, never adjacent
+      uint32_t end = 0;
+    };
+
+    // Virtual pages and clusters of a removed mesh
+    struct RemovedRanges {
+      uint32_t firstPage;
+      uint32_t pageCount;
+      uint32_t firstCluster;
+      uint32_t clusterCount;
+      uint64_t frame = 0; // update that cleared the page table entries
+    };
+
+    struct ClusterUpload {
+      uint32_t mesh;
+      uint32_t firstCluster;
+      uint32_t uploaded = 0;
+      std::vector<GeometryCluster> clusters;
+    };
+
+    struct RetiredPage {
+      uint32_t physical;
+      uint64_t frame;
+    };
+
+    struct TableWrite {
+      uint32_t virtualPage;
+      uint32_t entry; // first word of the physical page, or kInvalidPage
+    };
+
+    void readFeedback(uint32_t frameSlot);
+    void demand(uint32_t virtualPage);
+    auto evictForRequests(size_t wanted, std::vector<TableWrite>& tableWrites) -> uint32_t;
+
+    VulkanCore::Context& m_context;
+    Descriptor m_descriptor;
+    std::string m_name;
+
+    std::vector<MeshEntry> m_meshes;
+    std::vector<uint32_t> m_freeMeshes;
+    std::vector<VirtualPage> m_pages;
+    RangeAllocator m_virtualPageRanges;
+    RangeAllocator m_clusterRanges;
+    std::vector<uint32_t> m_requests; // virtual pages, served coarse LODs first
+    std::vector<uint32_t> m_freePhysical;
+    std::vector<uint32_t> m_residentPages; // virtual pages with a physical page
+    std::vector<RetiredPage> m_retired;    // unmapped, maybe still read in flight
+    std::vector<RemovedRanges> m_removed;  // page table entries not cleared yet
+    std::vector<RemovedRanges> m_retiredRanges;
+
+    // Clusters from addMesh() not copied to the cluster table yet, oldest first
+    std::vector<ClusterUpload> m_clusterUploads;
+
+    uint64_t m_frame = 0;
+    Stats m_stats;
+
+    std::shared_ptr<VulkanCore::Buffer> m_pageBuffer;
+    std::shared_ptr<VulkanCore::Buffer> m_clusterBuffer;
+    std::shared_ptr<VulkanCore::Buffer> m_pageTableBuffer;
+    std::shared_ptr<VulkanCore::Buffer> m_feedbackBuffer;
+    std::vector<std::shared_ptr<VulkanCore::Buffer>> m_feedbackReadback;
+    std::vector<std::shared_ptr<VulkanCore::Buffer>> m_staging;
+    std::vector<bool> m_feedbackRecorded;
+
+    core::Gauge* m_residentGauge      = nullptr;
+    core::Counter* m_uploadBytesTotal = nullptr;
+    core::Counter* m_evictionsTotal   = nullptr;
+  };
+} // namespace kst::renderer
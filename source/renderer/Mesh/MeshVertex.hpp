@@ -0,0 +1,45 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+
+#include <glm/glm.hpp>
+
+#include "VulkanBackend/VulkanCore/Common.hpp"
+
+namespace kst::renderer {
+  /**
+   * @brief Vertex layout consumed by the static mesh pipeline
+   *
+   * Laid out so it can be written from compute shaders as a std430 struct
+   * (vec3 + float pairs pack to 16 bytes) and read back as a vertex buffer.
+   */
+  struct MeshVertex {
+    glm::vec3 position{0.0f};
+    float uvX = 0.0f;
+    glm::vec3 normal{0.0f, 1.0f, 0.0f};
+    float uvY = 0.0f;
+    glm::vec4 tangent{1.0f, 0.0f, 0.0f, 1.0f};
+
+    static auto bindingDescription(uint32_t binding = 0) -> VkVertexInputBindingDescription {
+      return {
+          .binding   = binding,
+          .stride    = sizeof(MeshVertex),
+          .inputRate = VK_VERTEX_INPUT_RATE_VERTEX,
+      };
+    }
+
+    static auto attributeDescriptions(uint32_t binding = 0)
+        -> std::array<VkVertexInputAttributeDescription, 5> {
+      // uv is split across the padding slots after position and normal
+      return {{
+          {0, binding, VK_FORMAT_R32G32B32_SFLOAT, offsetof(MeshVertex, position)},
+          {1, binding, VK_FORMAT_R32G32B32_SFLOAT, offsetof(MeshVertex, normal)},
+          {2, binding, VK_FORMAT_R32G32B32A32_SFLOAT, offsetof(MeshVertex, tangent)},
+          {3, binding, VK_FORMAT_R32_SFLOAT, offsetof(MeshVertex, uvX)},
+          {4, binding, VK_FORMAT_R32_SFLOAT, offsetof(MeshVertex, uvY)},
+      }};
+    }
+  };
+  static_assert(sizeof(MeshVertex) == 48, "MeshVertex must match the std430 layout used by compute");
+} // namespace kst::renderer
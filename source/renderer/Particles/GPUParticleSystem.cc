@@ -0,0 +1,624 @@
+#include "GPUParticleSystem.hpp"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cmath>
+#include <numeric>
+#include <span>
+
+#include <tracy/Tracy.hpp>
+
+#include "VulkanBackend/VulkanCore/Buffer.hpp"
+#include "VulkanBackend/VulkanCore/CommandQueueManager.hpp"
+#include "VulkanBackend/VulkanCore/Context.hpp"
+#include "VulkanBackend/VulkanCore/Pipeline.hpp"
+#include "VulkanBackend/VulkanCore/Sampler.hpp"
+#include "VulkanBackend/VulkanCore/ShaderModule.hpp"
+#include "VulkanBackend/VulkanCore/Texture.hpp"
+
+namespace kst::renderer {
+  namespace {
+    // Must match shaders/particles/common.glsl
+    constexpr uint32_t kParticleStride = sizeof(glm::vec4) * 4;
+    constexpr uint32_t kSortBlockSize  = 512;
+
+    constexpr VkDeviceSize kEmitDispatchOffset     = 0;
+    constexpr VkDeviceSize kSimulateDispatchOffset = 16;
+    constexpr VkDeviceSize kSortDispatchOffset     = 32;
+    constexpr VkDeviceSize kDrawArgsOffset         = 48;
+    constexpr VkDeviceSize kIndirectBufferSize     = 64;
+    constexpr VkDeviceSize kCounterBufferSize      = sizeof(uint32_t) * 4;
+
+    enum Binding : uint32_t {
+      Params       = 0,
+      Particles    = 1,
+      DeadList     = 2,
+      AliveCurrent = 3,
+      AliveNext    = 4,
+      Counters     = 5,
+      IndirectArgs = 6,
+      SortEntries  = 7,
+      SceneDepth   = 8,
+    };
+
+    enum SortMode : uint32_t {
+      LocalSort  = 0,
+      GlobalStep = 1,
+      LocalMerge = 2,
+    };
+
+    struct SimulationParams {
+      glm::mat4 viewProjection;
+      glm::mat4 inverseViewProjection;
+      glm::mat4 view;
+      glm::vec4 cameraPosition;
+      glm::vec4 emitterPositionRadius;
+      glm::vec4 emitterVelocitySpread;
+      glm::vec4 gravityDeltaTime;
+      glm::vec4 colorStart;
+      glm::vec4 colorEnd;
+      glm::vec4 lifeSize;
+      glm::vec4 noise;
+      glm::vec4 collision;
+      glm::uvec4 counts;
+    };
+    static_assert(sizeof(SimulationParams) == 352, "SimulationParams must match std140 layout");
+
+    struct PushConstants {
+      uint32_t currentList;
+      uint32_t sortMode;
+      uint32_t sortK;
+      uint32_t sortJ;
+    };
+
+    auto shaderPath(const std::string& fileName) -> std::string {
+      return std::string(KST_SHADER_DIR) + "/particles/" + fileName + ".spv";
+    }
+
+    void computeBarrier(
+        VkCommandBuffer commandBuffer,
+        VkPipelineStageFlags dstStage,
+        VkAccessFlags dstAccess
+    ) {
+      const VkMemoryBarrier barrier = {
+          .sType         = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+          .srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT,
+          .dstAccessMask = dstAccess,
+      };
+      vkCmdPipelineBarrier(
+          commandBuffer,
+          VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+          dstStage,
+          0,
+          1,
+          &barrier,
+          0,
+          nullptr,
+          0,
+          nullptr
+      );
+    }
+
+    auto storageBinding(uint32_t binding, VkShaderStageFlags stages)
+        -> VkDescriptorSetLayoutBinding {
+      return {
+          .binding         = binding,
+          .descriptorType  = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+          .descriptorCount = 1,
+          .stageFlags      = stages,
+      };
+    }
+  } // namespace
+
+  GPUParticleSystem::GPUParticleSystem(VulkanCore::Context& context, const Descriptor& descriptor)
+      : m_context(context),
+        m_name(descriptor.name),
+        m_maxParticles(descriptor.maxParticles),
+        m_sortCapacity(std::max(std::bit_ceil(descriptor.maxParticles), kSortBlockSize)),
+        m_framesInFlight(descriptor.framesInFlight),
+        m_colorFormat(descriptor.colorFormat),
+        m_depthFormat(descriptor.depthFormat) {
+    ASSERT(m_maxParticles > 0, "GPUParticleSystem needs a non-zero capacity");
+    ASSERT(m_framesInFlight > 0, "GPUParticleSystem needs at least one frame in flight");
+
+    createBuffers();
+    createPipelines();
+  }
+
+  GPUParticleSystem::~GPUParticleSystem() = default;
+
+  void GPUParticleSystem::createBuffers() {
+    constexpr VkBufferUsageFlags storageUsage =
+        VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+
+    m_particleBuffer = m_context.createBuffer(
+        static_cast<size_t>(m_maxParticles) * kParticleStride,
+        storageUsage,
+        VMA_MEMORY_USAGE_GPU_ONLY,
+        "Particles: " + m_name
+    );
+    m_deadListBuffer = m_context.createBuffer(
+        m_maxParticles * sizeof(uint32_t),
+        storageUsage,
+        VMA_MEMORY_USAGE_GPU_ONLY,
+        "Particle dead list: " + m_name
+    );
+    for (uint32_t i = 0; i < 2; ++i) {
+      m_aliveListBuffers[i] = m_context.createBuffer(
+          m_maxParticles * sizeof(uint32_t),
+          storageUsage,
+          VMA_MEMORY_USAGE_GPU_ONLY,
+          "Particle alive list " + std::to_string(i) + ": " + m_name
+      );
+    }
+    m_counterBuffer = m_context.createBuffer(
+        kCounterBufferSize, storageUsage, VMA_MEMORY_USAGE_GPU_ONLY, "Particle counters: " + m_name
+    );
+    m_indirectBuffer = m_context.createBuffer(
+        kIndirectBufferSize,
+        storageUsage | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT,
+        VMA_MEMORY_USAGE_GPU_ONLY,
+        "Particle indirect args: " + m_name
+    );
+    m_sortBuffer = m_context.createBuffer(
+        static_cast<size_t>(m_sortCapacity) * sizeof(glm::uvec2),
+        storageUsage,
+        VMA_MEMORY_USAGE_GPU_ONLY,
+        "Particle sort entries: " + m_name
+    );
+
+    m_uniformBuffers.reserve(m_framesInFlight);
+    for (uint32_t i = 0; i < m_framesInFlight; ++i) {
+      m_uniformBuffers.push_back(m_context.createPersistentBuffer(
+          sizeof(SimulationParams),
+          VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
+          "Particle params " + std::to_string(i) + ": " + m_name
+      ));
+    }
+
+    // The collision shader statically uses the depth binding, so it always
+    // needs something valid bound even while collisions are disabled.
+    m_fallbackDepthTexture = m_context.createTexture(
+        VK_IMAGE_TYPE_2D,
+        VK_FORMAT_R32_SFLOAT,
+        0,
+        VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT,
+        {1, 1, 1},
+        1,
+        1,
+        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+        false,
+        VK_SAMPLE_COUNT_1_BIT,
+        "Particle fallback depth: " + m_name
+    );
+    m_fallbackDepthSampler = m_context.createSampler(
+        VK_FILTER_NEAREST,
+        VK_FILTER_NEAREST,
+        VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE,
+        VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE,
+        VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE,
+        0.0f,
+        "Particle depth sampler: " + m_name
+    );
+  }
+
+  void GPUParticleSystem::createPipelines() {
+    constexpr VkShaderStageFlags compute = VK_SHADER_STAGE_COMPUTE_BIT;
+
+    const VulkanCore::Pipeline::SetDescriptor computeSet = {
+        .set_ = 0,
+        .bindings_ =
+            {
+                VkDescriptorSetLayoutBinding{
+                    .binding         = Binding::Params,
+                    .descriptorType  = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,
+                    .descriptorCount = 1,
+                    .stageFlags      = compute,
+                },
+                storageBinding(Binding::Particles, compute),
+                storageBinding(Binding::DeadList, compute),
+                storageBinding(Binding::AliveCurrent, compute),
+                storageBinding(Binding::AliveNext, compute),
+                storageBinding(Binding::Counters, compute),
+                storageBinding(Binding::IndirectArgs, compute),
+                storageBinding(Binding::SortEntries, compute),
+                VkDescriptorSetLayoutBinding{
+                    .binding         = Binding::SceneDepth,
+                    .descriptorType  = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+                    .descriptorCount = 1,
+                    .stageFlags      = compute,
+                },
+            },
+    };
+
+    const std::vector<VkPushConstantRange> pushConstants = {
+        {.stageFlags = compute, .offset = 0, .size = sizeof(PushConstants)},
+    };
+
+    auto makeComputePipeline = [&](const std::string& shader, const std::string& label) {
+      auto module = m_context.createShaderModule(
+          shaderPath(shader), VK_SHADER_STAGE_COMPUTE_BIT, label + ": " + m_name
+      );
+      m_shaders.push_back(module);
+
+      const VulkanCore::Pipeline::ComputePipelineDescriptor desc = {
+          .sets_          = {computeSet},
+          .computeShader_ = module,
+          .pushConstants_ = pushConstants,
+      };
+      auto pipeline = m_context.createComputePipeline(desc, label + ": " + m_name);
+
+      // One set per frame in flight and alive-list parity.
+      pipeline->allocateDescriptors({
+          {.set_ = 0, .count_ = m_framesInFlight * 2, .name_ = label},
+      });
+      bindComputeResources(*pipeline);
+      return pipeline;
+    };
+
+    m_preparePipeline  = makeComputePipeline("prepare.comp", "Particle prepare");
+    m_emitPipeline     = makeComputePipeline("emit.comp", "Particle emit");
+    m_simulatePipeline = makeComputePipeline("simulate.comp", "Particle simulate");
+    m_sortPipeline     = makeComputePipeline("sort.comp", "Particle sort");
+
+    constexpr VkShaderStageFlags vertex = VK_SHADER_STAGE_VERTEX_BIT;
+
+    auto vertexShader = m_context.createShaderModule(
+        shaderPath("particle.vert"), VK_SHADER_STAGE_VERTEX_BIT, "Particle vertex: " + m_name
+    );
+    auto fragmentShader = m_context.createShaderModule(
+        shaderPath("particle.frag"), VK_SHADER_STAGE_FRAGMENT_BIT, "Particle fragment: " + m_name
+    );
+    m_shaders.push_back(vertexShader);
+    m_shaders.push_back(fragmentShader);
+
+    const VulkanCore::Pipeline::GraphicsPipelineDescriptor renderDesc = {
+        .sets_ =
+            {
+                {
+                    .set_ = 0,
+                    .bindings_ =
+                        {
+                            VkDescriptorSetLayoutBinding{
+                                .binding         = 0,
+                                .descriptorType  = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,
+                                .descriptorCount = 1,
+                                .stageFlags      = vertex,
+                            },
+                            storageBinding(1, vertex),
+                            storageBinding(2, vertex),
+                        },
+                },
+            },
+        .vertexShader_        = vertexShader,
+        .fragmentShader_      = fragmentShader,
+        .dynamicStates_       = {VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR},
+        .useDynamicRendering_ = true,
+        .colorTextureFormats  = {m_colorFormat},
+        .depthTextureFormat   = m_depthFormat,
+        .cullMode             = VK_CULL_MODE_NONE,
+        .viewport             = VkExtent2D{1, 1},
+        .blendEnable          = true,
+        .depthTestEnable      = true,
+        .depthWriteEnable     = false,
+    };
+    m_renderPipeline =
+        m_context.createGraphicsPipeline(renderDesc, VK_NULL_HANDLE, "Particle render: " + m_name);
+
+    m_renderPipeline->allocateDescriptors({
+        {.set_ = 0, .count_ = m_framesInFlight, .name_ = "Particle render"},
+    });
+    for (uint32_t frame = 0; frame < m_framesInFlight; ++frame) {
+      m_renderPipeline->bindResource(
+          0,
+          0,
+          frame,
+          m_uniformBuffers[frame],
+          0,
+          sizeof(SimulationParams),
+          VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER
+      );
+      m_renderPipeline->bindResource(
+          0,
+          1,
+          frame,
+          m_particleBuffer,
+          0,
+          m_particleBuffer->size(),
+          VK_DESCRIPTOR_TYPE_STORAGE_BUFFER
+      );
+      m_renderPipeline->bindResource(
+          0, 2, frame, m_sortBuffer, 0, m_sortBuffer->size(), VK_DESCRIPTOR_TYPE_STORAGE_BUFFER
+      );
+    }
+  }
+
+  void GPUParticleSystem::bindComputeResources(VulkanCore::Pipeline& pipeline) {
+    const auto bindStorage = [&pipeline](
+                                 uint32_t binding,
+                                 uint32_t index,
+                                 const std::shared_ptr<VulkanCore::Buffer>& buffer
+                             ) {
+      pipeline.bindResource(
+          0, binding, index, buffer, 0, buffer->size(), VK_DESCRIPTOR_TYPE_STORAGE_BUFFER
+      );
+    };
+
+    for (uint32_t frame = 0; frame < m_framesInFlight; ++frame) {
+      for (uint32_t list = 0; list < 2; ++list) {
+        const uint32_t index = frame * 2 + list;
+
+        pipeline.bindResource(
+            0,
+            Binding::Params,
+            index,
+            m_uniformBuffers[frame],
+            0,
+            sizeof(SimulationParams),
+            VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER
+        );
+        bindStorage(Binding::Particles, index, m_particleBuffer);
+        bindStorage(Binding::DeadList, index, m_deadListBuffer);
+        bindStorage(Binding::AliveCurrent, index, m_aliveListBuffers[list]);
+        bindStorage(Binding::AliveNext, index, m_aliveListBuffers[1 - list]);
+        bindStorage(Binding::Counters, index, m_counterBuffer);
+        bindStorage(Binding::IndirectArgs, index, m_indirectBuffer);
+        bindStorage(Binding::SortEntries, index, m_sortBuffer);
+      }
+    }
+  }
+
+  void GPUParticleSystem::bindDepthResources() {
+    auto texture = m_depthTexture ? m_depthTexture : m_fallbackDepthTexture;
+    auto sampler = m_depthSampler ? m_depthSampler : m_fallbackDepthSampler;
+    std::array<std::shared_ptr<VulkanCore::Texture>, 1> textures = {texture};
+
+    for (const auto& pipeline :
+         {m_preparePipeline, m_emitPipeline, m_simulatePipeline, m_sortPipeline}) {
+      for (uint32_t index = 0; index < m_framesInFlight * 2; ++index) {
+        pipeline->bindResource(0, Binding::SceneDepth, index, std::span(textures), sampler);
+      }
+    }
+  }
+
+  void GPUParticleSystem::initialize(
+      VulkanCore::CommandQueueManager& queueManager,
+      VkCommandBuffer commandBuffer
+  ) {
+    ZoneScopedN("GPUParticleSystem: initialize");
+
+    // Every slot starts dead. Stored in reverse so the first pops hand out low
+    // indices, which keeps early particles packed at the front of the pool.
+    std::vector<uint32_t> deadIndices(m_maxParticles);
+    std::iota(deadIndices.rbegin(), deadIndices.rend(), 0u);
+    m_context.uploadToGPUBuffer(
+        queueManager,
+        commandBuffer,
+        m_deadListBuffer.get(),
+        deadIndices.data(),
+        static_cast<long>(deadIndices.size() * sizeof(uint32_t))
+    );
+
+    const std::array<uint32_t, 4> counters = {0, 0, m_maxParticles, 0};
+    m_context.uploadToGPUBuffer(
+        queueManager, commandBuffer, m_counterBuffer.get(), counters.data(), kCounterBufferSize
+    );
+
+    // Indirect args are overwritten by the prepare pass before use, but start
+    // from a zero draw so rendering before the first update is harmless.
+    const std::array<uint32_t, kIndirectBufferSize / sizeof(uint32_t)> indirect = {};
+    m_context.uploadToGPUBuffer(
+        queueManager, commandBuffer, m_indirectBuffer.get(), indirect.data(), kIndirectBufferSize
+    );
+
+    const VkMemoryBarrier barrier = {
+        .sType         = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+        .srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+        .dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT |
+                         VK_ACCESS_INDIRECT_COMMAND_READ_BIT,
+    };
+    vkCmdPipelineBarrier(
+        commandBuffer,
+        VK_PIPELINE_STAGE_TRANSFER_BIT,
+        VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT,
+        0,
+        1,
+        &barrier,
+        0,
+        nullptr,
+        0,
+        nullptr
+    );
+
+    m_fallbackDepthTexture->transitionImageLayout(
+        commandBuffer, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL
+    );
+    bindDepthResources();
+  }
+
+  void GPUParticleSystem::setDepthBuffer(
+      std::shared_ptr<VulkanCore::Texture> depth,
+      std::shared_ptr<VulkanCore::Sampler> sampler
+  ) {
+    m_hasDepthCollisions = depth != nullptr;
+    m_depthTexture       = std::move(depth);
+    m_depthSampler       = m_hasDepthCollisions ? std::move(sampler) : nullptr;
+    bindDepthResources();
+  }
+
+  void GPUParticleSystem::update(
+      VkCommandBuffer commandBuffer,
+      const ParticleEmitterSettings& emitter,
+      const ParticleFrameInfo& frame
+  ) {
+    ZoneScopedN("GPUParticleSystem: update");
+
+    const uint32_t frameSlot = m_frameIndex % m_framesInFlight;
+    const uint32_t setIndex  = frameSlot * 2 + m_currentList;
+
+    m_emitAccumulator += emitter.emitRate * frame.deltaTime;
+    const auto emitCount = static_cast<uint32_t>(
+        std::min(std::floor(m_emitAccumulator), static_cast<float>(m_maxParticles))
+    );
+    m_emitAccumulator -= static_cast<float>(emitCount);
+
+    const glm::mat4 viewProjection = frame.projection * frame.view;
+    const SimulationParams params  = {
+        .viewProjection        = viewProjection,
+        .inverseViewProjection = glm::inverse(viewProjection),
+        .view                  = frame.view,
+        .cameraPosition        = glm::vec4(frame.cameraPosition, 0.0f),
+        .emitterPositionRadius = glm::vec4(emitter.position, emitter.spawnRadius),
+        .emitterVelocitySpread = glm::vec4(emitter.velocity, emitter.velocitySpread),
+        .gravityDeltaTime      = glm::vec4(emitter.gravity, frame.deltaTime),
+        .colorStart            = emitter.colorStart,
+        .colorEnd              = emitter.colorEnd,
+        .lifeSize =
+            {emitter.minLifetime, emitter.maxLifetime, emitter.startSize, emitter.endSize},
+        .noise     = {emitter.noiseFrequency, emitter.noiseStrength, frame.time, 0.0f},
+        .collision = {emitter.restitution, emitter.collisionThickness, 0.0f, 0.0f},
+        .counts =
+            {emitCount,
+             m_maxParticles,
+             m_frameIndex,
+             emitter.depthCollision && m_hasDepthCollisions ? 1u : 0u},
+    };
+    m_uniformBuffers[frameSlot]->copyDataToBuffer(&params, sizeof(params));
+
+    // Last frame's draw still reads the particle, sort and indirect buffers.
+    vkCmdPipelineBarrier(
+        commandBuffer,
+        VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT,
+        VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+        0,
+        0,
+        nullptr,
+        0,
+        nullptr,
+        0,
+        nullptr
+    );
+
+    const PushConstants constants = {.currentList = m_currentList};
+    const VkBuffer indirectBuffer = m_indirectBuffer->vkBuffer();
+
+    m_context.beginDebugUtilsLabel(
+        commandBuffer, "Particles: " + m_name, {1.0f, 0.6f, 0.1f, 1.0f}
+    );
+
+    m_preparePipeline->bind(commandBuffer);
+    m_preparePipeline->bindDescriptorSets(commandBuffer, {{.set = 0, .bindIdx = setIndex}});
+    m_preparePipeline->updatePushConstant(
+        commandBuffer, VK_SHADER_STAGE_COMPUTE_BIT, sizeof(constants), &constants
+    );
+    vkCmdDispatch(commandBuffer, 1, 1, 1);
+    computeBarrier(
+        commandBuffer,
+        VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT,
+        VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT | VK_ACCESS_INDIRECT_COMMAND_READ_BIT
+    );
+
+    m_emitPipeline->bind(commandBuffer);
+    m_emitPipeline->bindDescriptorSets(commandBuffer, {{.set = 0, .bindIdx = setIndex}});
+    m_emitPipeline->updatePushConstant(
+        commandBuffer, VK_SHADER_STAGE_COMPUTE_BIT, sizeof(constants), &constants
+    );
+    vkCmdDispatchIndirect(commandBuffer, indirectBuffer, kEmitDispatchOffset);
+    computeBarrier(
+        commandBuffer,
+        VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+        VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT
+    );
+
+    m_simulatePipeline->bind(commandBuffer);
+    m_simulatePipeline->bindDescriptorSets(commandBuffer, {{.set = 0, .bindIdx = setIndex}});
+    m_simulatePipeline->updatePushConstant(
+        commandBuffer, VK_SHADER_STAGE_COMPUTE_BIT, sizeof(constants), &constants
+    );
+    vkCmdDispatchIndirect(commandBuffer, indirectBuffer, kSimulateDispatchOffset);
+    computeBarrier(
+        commandBuffer,
+        VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+        VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT
+    );
+
+    recordSort(commandBuffer, setIndex);
+
+    computeBarrier(
+        commandBuffer,
+        VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT,
+        VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_INDIRECT_COMMAND_READ_BIT
+    );
+
+    m_context.endDebugUtilsLabel(commandBuffer);
+
+    m_currentList = 1 - m_currentList;
+    ++m_frameIndex;
+  }
+
+  void GPUParticleSystem::recordSort(VkCommandBuffer commandBuffer, uint32_t setIndex) {
+    m_sortPipeline->bind(commandBuffer);
+    m_sortPipeline->bindDescriptorSets(commandBuffer, {{.set = 0, .bindIdx = setIndex}});
+
+    const VkBuffer indirectBuffer = m_indirectBuffer->vkBuffer();
+    const auto dispatch = [&](SortMode mode, uint32_t k, uint32_t j) {
+      const PushConstants constants = {
+          .currentList = m_currentList,
+          .sortMode    = mode,
+          .sortK       = k,
+          .sortJ       = j,
+      };
+      m_sortPipeline->updatePushConstant(
+          commandBuffer, VK_SHADER_STAGE_COMPUTE_BIT, sizeof(constants), &constants
+      );
+      vkCmdDispatchIndirect(commandBuffer, indirectBuffer, kSortDispatchOffset);
+      computeBarrier(
+          commandBuffer,
+          VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+          VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT
+      );
+    };
+
+    // Stages up to the block size run entirely in shared memory. Larger stages
+    // do their wide steps globally and finish the last log2(block) steps
+    // locally. Stages beyond the live element count early-out on the GPU.
+    dispatch(SortMode::LocalSort, kSortBlockSize, 0);
+    for (uint32_t k = kSortBlockSize << 1; k <= m_sortCapacity; k <<= 1) {
+      for (uint32_t j = k >> 1; j >= kSortBlockSize; j >>= 1) {
+        dispatch(SortMode::GlobalStep, k, j);
+      }
+      dispatch(SortMode::LocalMerge, k, 0);
+    }
+  }
+
+  void GPUParticleSystem::render(VkCommandBuffer commandBuffer, VkExtent2D extent) {
+    ZoneScopedN("GPUParticleSystem: render");
+
+    // update() has already advanced the frame, the matching uniforms are the
+    // previous slot.
+    const uint32_t frameSlot = (m_frameIndex + m_framesInFlight - 1) % m_framesInFlight;
+
+    const VkViewport viewport = {
+        .x        = 0.0f,
+        .y        = 0.0f,
+        .width    = static_cast<float>(extent.width),
+        .height   = static_cast<float>(extent.height),
+        .minDepth = 0.0f,
+        .maxDepth = 1.0f,
+    };
+    const VkRect2D scissor = {.offset = {0, 0}, .extent = extent};
+
+    m_renderPipeline->bind(commandBuffer);
+    vkCmdSetViewport(commandBuffer, 0, 1, &viewport);
+    vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
+    m_renderPipeline->bindDescriptorSets(commandBuffer, {{.set = 0, .bindIdx = frameSlot}});
+    vkCmdDrawIndirect(
+        commandBuffer,
+        m_indirectBuffer->vkBuffer(),
+        kDrawArgsOffset,
+        1,
+        sizeof(VkDrawIndirectCommand)
+    );
+  }
+} // namespace kst::renderer
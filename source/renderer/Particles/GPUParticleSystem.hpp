@@ -0,0 +1,172 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "VulkanBackend/VulkanCore/Common.hpp"
+
+namespace VulkanCore {
+  class Buffer;
+  class CommandQueueManager;
+  class Context;
+  class Pipeline;
+  class Sampler;
+  class ShaderModule;
+  class Texture;
+} // namespace VulkanCore
+
+namespace kst::renderer {
+  struct ParticleEmitterSettings {
+    glm::vec3 position{0.0f};
+    float spawnRadius = 0.25f;
+    glm::vec3 velocity{0.0f, 2.0f, 0.0f};
+    float velocitySpread = 0.5f;
+    glm::vec3 gravity{0.0f, -9.81f, 0.0f};
+    float emitRate = 1000.0f; // particles per second
+
+    glm::vec4 colorStart{1.0f};
+    glm::vec4 colorEnd{1.0f, 1.0f, 1.0f, 0.0f};
+    float minLifetime = 1.0f;
+    float maxLifetime = 3.0f;
+    float startSize   = 0.05f;
+    float endSize     = 0.01f;
+
+    float noiseFrequency = 0.5f;
+    float noiseStrength  = 1.0f;
+
+    bool depthCollision      = true;
+    float restitution        = 0.4f;
+    float collisionThickness = 0.5f; // world units behind the depth buffer surface
+  };
+
+  struct ParticleFrameInfo {
+    glm::mat4 view{1.0f};
+    glm::mat4 projection{1.0f};
+    glm::vec3 cameraPosition{0.0f};
+    float deltaTime = 0.0f;
+    float time      = 0.0f;
+  };
+
+  /**
+   * @brief Fully GPU-driven particle system
+   *
+   * Emission, simulation, stream compaction and sorting all run in compute;
+   * the draw is issued with vkCmdDrawIndirect from counts written on the GPU.
+   * The CPU records the same fixed set of commands every frame regardless of
+   * how many particles are alive, so CPU cost stays flat as counts grow.
+   *
+   * Per frame:
+   *   prepare  - one thread turns last frame's counters into indirect args
+   *   emit     - pops dead slots, appends to the current alive list
+   *   simulate - curl noise + depth-buffer collision, compacts survivors into
+   *              the next alive list and writes sort keys / draw count
+   *   sort     - bitonic sort by view distance for back-to-front blending
+   *   render   - indirect draw of camera-facing quads
+   */
+  class GPUParticleSystem {
+  public:
+    struct Descriptor {
+      uint32_t maxParticles   = 1u << 16;
+      uint32_t framesInFlight = 2;
+      VkFormat colorFormat    = VK_FORMAT_B8G8R8A8_UNORM;
+      VkFormat depthFormat    = VK_FORMAT_D32_SFLOAT;
+      std::string name        = "particles";
+    };
+
+    GPUParticleSystem(VulkanCore::Context& context, const Descriptor& descriptor);
+    ~GPUParticleSystem();
+
+    GPUParticleSystem(const GPUParticleSystem&)                    = delete;
+    auto operator=(const GPUParticleSystem&) -> GPUParticleSystem& = delete;
+    GPUParticleSystem(GPUParticleSystem&&)                         = delete;
+    auto operator=(GPUParticleSystem&&) -> GPUParticleSystem&      = delete;
+
+    /**
+     * @brief Seeds the dead list and counters on the GPU
+     * @param queueManager Queue that owns commandBuffer, used to dispose staging buffers
+     * @param commandBuffer Command buffer in the recording state
+     *
+     * Must be recorded (and submitted) once before the first update().
+     */
+    void initialize(VulkanCore::CommandQueueManager& queueManager, VkCommandBuffer commandBuffer);
+
+    /**
+     * @brief Sets the scene depth buffer used for particle collisions
+     * @param depth Depth texture, expected in SHADER_READ_ONLY_OPTIMAL when update() executes
+     * @param sampler Nearest sampler used to read it
+     *
+     * Passing nullptr disables depth collisions. Rewrites descriptor sets, so
+     * call it while no frame using this system is in flight (e.g. after a resize).
+     */
+    void setDepthBuffer(
+        std::shared_ptr<VulkanCore::Texture> depth,
+        std::shared_ptr<VulkanCore::Sampler> sampler
+    );
+
+    /**
+     * @brief Records emit, simulate, compaction and sort for this frame
+     * @param commandBuffer Command buffer outside of a render pass
+     * @param emitter Emitter settings for this frame
+     * @param frame Camera and timing information
+     */
+    void update(
+        VkCommandBuffer commandBuffer,
+        const ParticleEmitterSettings& emitter,
+        const ParticleFrameInfo& frame
+    );
+
+    /**
+     * @brief Records the indirect particle draw
+     * @param commandBuffer Command buffer inside dynamic rendering with the configured formats
+     * @param extent Render target extent for viewport and scissor
+     */
+    void render(VkCommandBuffer commandBuffer, VkExtent2D extent);
+
+    auto maxParticles() const -> uint32_t { return m_maxParticles; }
+
+  private:
+    void createBuffers();
+    void createPipelines();
+    void bindComputeResources(VulkanCore::Pipeline& pipeline);
+    void bindDepthResources();
+    void recordSort(VkCommandBuffer commandBuffer, uint32_t setIndex);
+
+    VulkanCore::Context& m_context;
+    std::string m_name;
+
+    uint32_t m_maxParticles   = 0;
+    uint32_t m_sortCapacity   = 0;
+    uint32_t m_framesInFlight = 0;
+    VkFormat m_colorFormat    = VK_FORMAT_UNDEFINED;
+    VkFormat m_depthFormat    = VK_FORMAT_UNDEFINED;
+
+    uint32_t m_frameIndex     = 0;
+    uint32_t m_currentList    = 0;
+    float m_emitAccumulator   = 0.0f;
+    bool m_hasDepthCollisions = false;
+
+    std::shared_ptr<VulkanCore::Buffer> m_particleBuffer;
+    std::shared_ptr<VulkanCore::Buffer> m_deadListBuffer;
+    std::shared_ptr<VulkanCore::Buffer> m_aliveListBuffers[2];
+    std::shared_ptr<VulkanCore::Buffer> m_counterBuffer;
+    std::shared_ptr<VulkanCore::Buffer> m_indirectBuffer;
+    std::shared_ptr<VulkanCore::Buffer> m_sortBuffer;
+    std::vector<std::shared_ptr<VulkanCore::Buffer>> m_uniformBuffers;
+
+    std::shared_ptr<VulkanCore::Texture> m_depthTexture;
+    std::shared_ptr<VulkanCore::Sampler> m_depthSampler;
+    std::shared_ptr<VulkanCore::Texture> m_fallbackDepthTexture;
+    std::shared_ptr<VulkanCore::Sampler> m_fallbackDepthSampler;
+
+    std::vector<std::shared_ptr<VulkanCore::ShaderModule>> m_shaders;
+    std::shared_ptr<VulkanCore::Pipeline> m_preparePipeline;
+    std::shared_ptr<VulkanCore::Pipeline> m_emitPipeline;
+    std::shared_ptr<VulkanCore::Pipeline> m_simulatePipeline;
+    std::shared_ptr<VulkanCore::Pipeline> m_sortPipeline;
+    std::shared_ptr<VulkanCore::Pipeline> m_renderPipeline;
+  };
+} // namespace kst::renderer
@@ -0,0 +1,477 @@
+#include "PostProcessChain.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+
+#include <tracy/Tracy.hpp>
+
+#include "VulkanBackend/VulkanCore/Buffer.hpp"
+#include "VulkanBackend/VulkanCore/Context.hpp"
+#include "VulkanBackend/VulkanCore/Pipeline.hpp"
+#include "VulkanBackend/VulkanCore/Sampler.hpp"
+#include "VulkanBackend/VulkanCore/ShaderModule.hpp"
+#include "VulkanBackend/VulkanCore/Texture.hpp"
+
+namespace kst::renderer {
+  namespace {
+    constexpr uint32_t kGroupSize     = 8;
+    constexpr VkFormat kHdrFormat     = VK_FORMAT_R16G16B16A16_SFLOAT;
+    constexpr VkFormat kOutputFormat  = VK_FORMAT_R8G8B8A8_UNORM;
+    constexpr uint32_t kBitsPerEffect = 4;
+
+    struct PostProcessParams {
+      glm::vec4 bloom;
+      glm::vec4 tonemap;
+      glm::vec4 grading;
+      glm::vec4 lift;
+      glm::vec4 gamma;
+      glm::vec4 gain;
+      glm::vec4 vignette;
+    };
+    static_assert(sizeof(PostProcessParams) == 112, "PostProcessParams must match std140 layout");
+
+    struct BloomConstants {
+      glm::vec2 sourceTexelSize;
+      float thresholdOrRadius;
+      float knee;
+      uint32_t prefilter;
+    };
+
+    // Layout of the fused shader's specialization constants (constant_id order).
+    struct FusedSpecialization {
+      uint32_t stageCount;
+      uint32_t stages[PostProcessChain::kMaxFusedEffects];
+      VkBool32 encodeSrgb;
+    };
+
+    enum FusedBinding : uint32_t {
+      HdrInput  = 0,
+      Bloom     = 1,
+      LdrOutput = 2,
+      Params    = 3,
+    };
+
+    auto shaderPath(const std::string& fileName) -> std::string {
+      return std::string(KST_SHADER_DIR) + "/postprocess/" + fileName + ".spv";
+    }
+
+    auto imageBinding(uint32_t binding, VkDescriptorType type) -> VkDescriptorSetLayoutBinding {
+      return {
+          .binding         = binding,
+          .descriptorType  = type,
+          .descriptorCount = 1,
+          .stageFlags      = VK_SHADER_STAGE_COMPUTE_BIT,
+      };
+    }
+
+    void computeBarrier(VkCommandBuffer commandBuffer) {
+      const VkMemoryBarrier barrier = {
+          .sType         = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+          .srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT,
+          .dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT,
+      };
+      vkCmdPipelineBarrier(
+          commandBuffer,
+          VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+          VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+          0,
+          1,
+          &barrier,
+          0,
+          nullptr,
+          0,
+          nullptr
+      );
+    }
+
+    auto groupCount(uint32_t size) -> uint32_t { return (size + kGroupSize - 1) / kGroupSize; }
+
+    auto levelExtent(VkExtent2D extent, uint32_t level) -> VkExtent2D {
+      return {
+          std::max(1u, extent.width >> (level + 1)),
+          std::max(1u, extent.height >> (level + 1)),
+      };
+    }
+  } // namespace
+
+  PostProcessChain::PostProcessChain(VulkanCore::Context& context, const Descriptor& descriptor)
+      : m_context(context),
+        m_name(descriptor.name),
+        m_extent(descriptor.extent),
+        m_bloomLevels(descriptor.bloomLevels),
+        m_framesInFlight(descriptor.framesInFlight),
+        m_encodeSrgb(descriptor.encodeSrgb) {
+    ASSERT(m_bloomLevels > 0, "PostProcessChain needs at least one bloom level");
+    ASSERT(m_framesInFlight > 0, "PostProcessChain needs at least one frame in flight");
+
+    m_linearSampler = m_context.createSampler(
+        VK_FILTER_LINEAR,
+        VK_FILTER_LINEAR,
+        VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE,
+        VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE,
+        VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE,
+        0.0f,
+        "Post process linear sampler: " + m_name
+    );
+
+    for (uint32_t i = 0; i < m_framesInFlight; ++i) {
+      m_uniformBuffers.push_back(m_context.createPersistentBuffer(
+          sizeof(PostProcessParams),
+          VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
+          "Post process params " + std::to_string(i) + ": " + m_name
+      ));
+    }
+
+    m_fusedShader = m_context.createShaderModule(
+        shaderPath("fused.comp"), VK_SHADER_STAGE_COMPUTE_BIT, "Post process fused: " + m_name
+    );
+
+    createTargets();
+    createBloomPipelines();
+
+    const PostEffect defaultEffects[] = {PostEffect::Bloom, PostEffect::Tonemap};
+    setEffects(defaultEffects);
+  }
+
+  PostProcessChain::~PostProcessChain() = default;
+
+  void PostProcessChain::createTargets() {
+    m_output = m_context.createTexture(
+        VK_IMAGE_TYPE_2D,
+        kOutputFormat,
+        0,
+        VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
+        {m_extent.width, m_extent.height, 1},
+        1,
+        1,
+        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+        false,
+        VK_SAMPLE_COUNT_1_BIT,
+        "Post process output: " + m_name
+    );
+
+    m_bloomTargets.clear();
+    for (uint32_t level = 0; level < m_bloomLevels; ++level) {
+      const VkExtent2D extent = levelExtent(m_extent, level);
+      m_bloomTargets.push_back(m_context.createTexture(
+          VK_IMAGE_TYPE_2D,
+          kHdrFormat,
+          0,
+          VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
+          {extent.width, extent.height, 1},
+          1,
+          1,
+          VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+          false,
+          VK_SAMPLE_COUNT_1_BIT,
+          "Bloom level " + std::to_string(level) + ": " + m_name
+      ));
+    }
+  }
+
+  void PostProcessChain::createBloomPipelines() {
+    const VulkanCore::Pipeline::SetDescriptor bloomSet = {
+        .set_ = 0,
+        .bindings_ =
+            {
+                imageBinding(0, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER),
+                imageBinding(1, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE),
+            },
+    };
+    const std::vector<VkPushConstantRange> pushConstants = {
+        {
+            .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT,
+            .offset     = 0,
+            .size       = sizeof(BloomConstants),
+        },
+    };
+
+    m_downsampleShader = m_context.createShaderModule(
+        shaderPath("bloom_downsample.comp"),
+        VK_SHADER_STAGE_COMPUTE_BIT,
+        "Bloom downsample: " + m_name
+    );
+    m_upsampleShader = m_context.createShaderModule(
+        shaderPath("bloom_upsample.comp"),
+        VK_SHADER_STAGE_COMPUTE_BIT,
+        "Bloom upsample: " + m_name
+    );
+
+    m_downsamplePipeline = m_context.createComputePipeline(
+        {
+            .sets_          = {bloomSet},
+            .computeShader_ = m_downsampleShader,
+            .pushConstants_ = pushConstants,
+        },
+        "Bloom downsample: " + m_name
+    );
+    m_upsamplePipeline = m_context.createComputePipeline(
+        {
+            .sets_          = {bloomSet},
+            .computeShader_ = m_upsampleShader,
+            .pushConstants_ = pushConstants,
+        },
+        "Bloom upsample: " + m_name
+    );
+
+    // One set per level: downsample i writes level i, upsample i writes level i
+    // from level i + 1.
+    m_downsamplePipeline->allocateDescriptors({
+        {.set_ = 0, .count_ = m_bloomLevels, .name_ = "Bloom downsample"},
+    });
+    if (m_bloomLevels > 1) {
+      m_upsamplePipeline->allocateDescriptors({
+          {.set_ = 0, .count_ = m_bloomLevels - 1, .name_ = "Bloom upsample"},
+      });
+    }
+  }
+
+  void PostProcessChain::bindBloomResources() {
+    for (uint32_t level = 0; level < m_bloomLevels; ++level) {
+      m_downsamplePipeline->bindResource(
+          0, 0, level, level == 0 ? m_input : m_bloomTargets[level - 1], m_linearSampler
+      );
+      m_downsamplePipeline->bindResource(
+          0, 1, level, m_bloomTargets[level], VK_DESCRIPTOR_TYPE_STORAGE_IMAGE
+      );
+    }
+    for (uint32_t level = 0; level + 1 < m_bloomLevels; ++level) {
+      m_upsamplePipeline->bindResource(0, 0, level, m_bloomTargets[level + 1], m_linearSampler);
+      m_upsamplePipeline->bindResource(
+          0, 1, level, m_bloomTargets[level], VK_DESCRIPTOR_TYPE_STORAGE_IMAGE
+      );
+    }
+  }
+
+  void PostProcessChain::bindFusedResources(VulkanCore::Pipeline& pipeline) {
+    for (uint32_t frame = 0; frame < m_framesInFlight; ++frame) {
+      pipeline.bindResource(
+          0, FusedBinding::HdrInput, frame, m_input, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE
+      );
+      pipeline.bindResource(0, FusedBinding::Bloom, frame, m_bloomTargets[0], m_linearSampler);
+      pipeline.bindResource(
+          0, FusedBinding::LdrOutput, frame, m_output, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE
+      );
+      pipeline.bindResource(
+          0,
+          FusedBinding::Params,
+          frame,
+          m_uniformBuffers[frame],
+          0,
+          sizeof(PostProcessParams),
+          VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER
+      );
+    }
+  }
+
+  auto PostProcessChain::fusedPipeline() -> VulkanCore::Pipeline& {
+    if (const auto it = m_fusedPipelines.find(m_effectsKey); it != m_fusedPipelines.end()) {
+      return *it->second;
+    }
+
+    ZoneScopedN("PostProcessChain: create fused pipeline");
+
+    FusedSpecialization specialization = {
+        .stageCount = static_cast<uint32_t>(m_effects.size()),
+        .stages     = {},
+        .encodeSrgb = m_encodeSrgb ? VK_TRUE : VK_FALSE,
+    };
+    for (size_t i = 0; i < m_effects.size(); ++i) {
+      specialization.stages[i] = static_cast<uint32_t>(m_effects[i]);
+    }
+
+    std::vector<VkSpecializationMapEntry> entries;
+    entries.push_back({.constantID = 0, .offset = 0, .size = sizeof(uint32_t)});
+    for (uint32_t i = 0; i < kMaxFusedEffects; ++i) {
+      const size_t offset = offsetof(FusedSpecialization, stages) + i * sizeof(uint32_t);
+      entries.push_back({
+          .constantID = i + 1,
+          .offset     = static_cast<uint32_t>(offset),
+          .size       = sizeof(uint32_t),
+      });
+    }
+    entries.push_back({
+        .constantID = kMaxFusedEffects + 1,
+        .offset     = offsetof(FusedSpecialization, encodeSrgb),
+        .size       = sizeof(VkBool32),
+    });
+
+    const VulkanCore::Pipeline::ComputePipelineDescriptor desc = {
+        .sets_ =
+            {
+                {
+                    .set_ = 0,
+                    .bindings_ =
+                        {
+                            imageBinding(FusedBinding::HdrInput, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE),
+                            imageBinding(
+                                FusedBinding::Bloom, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER
+                            ),
+                            imageBinding(FusedBinding::LdrOutput, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE),
+                            imageBinding(FusedBinding::Params, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER),
+                        },
+                },
+            },
+        .computeShader_        = m_fusedShader,
+        .specializationConsts_ = entries,
+        .specializationData_   = &specialization,
+    };
+
+    auto pipeline = m_context.createComputePipeline(
+        desc, "Post process fused " + std::to_string(m_effectsKey) + ": " + m_name
+    );
+    pipeline->allocateDescriptors({
+        {.set_ = 0, .count_ = m_framesInFlight, .name_ = "Post process fused"},
+    });
+    if (m_input) {
+      bindFusedResources(*pipeline);
+    }
+
+    return *m_fusedPipelines.emplace(m_effectsKey, std::move(pipeline)).first->second;
+  }
+
+  void PostProcessChain::setEffects(std::span<const PostEffect> effects) {
+    ASSERT(effects.size() <= kMaxFusedEffects, "Too many fused post effects");
+
+    m_effects.assign(effects.begin(), effects.end());
+    m_effectsKey   = 0;
+    m_bloomEnabled = false;
+    for (size_t i = 0; i < m_effects.size(); ++i) {
+      m_effectsKey |= static_cast<uint32_t>(m_effects[i]) << (i * kBitsPerEffect);
+      m_bloomEnabled |= m_effects[i] == PostEffect::Bloom;
+    }
+
+    // Build the variant now so switching chains does not hitch mid-frame later.
+    fusedPipeline();
+  }
+
+  void PostProcessChain::setInput(std::shared_ptr<VulkanCore::Texture> hdrColor) {
+    ASSERT(hdrColor != nullptr, "PostProcessChain needs an input texture");
+    ASSERT(hdrColor->vkFormat() == kHdrFormat, "PostProcessChain input must be RGBA16F");
+
+    m_input = std::move(hdrColor);
+    bindBloomResources();
+    for (auto& [key, pipeline] : m_fusedPipelines) {
+      bindFusedResources(*pipeline);
+    }
+  }
+
+  void PostProcessChain::resize(VkExtent2D extent) {
+    m_extent = extent;
+    m_input.reset();
+    createTargets();
+  }
+
+  void PostProcessChain::recordBloom(VkCommandBuffer commandBuffer, const BloomSettings& settings) {
+    m_context.beginDebugUtilsLabel(commandBuffer, "Bloom: " + m_name, {1.0f, 0.8f, 0.3f, 1.0f});
+
+    m_downsamplePipeline->bind(commandBuffer);
+    for (uint32_t level = 0; level < m_bloomLevels; ++level) {
+      const VkExtent3D source =
+          level == 0 ? m_input->vkExtents() : m_bloomTargets[level - 1]->vkExtents();
+      const VkExtent2D target        = levelExtent(m_extent, level);
+      const BloomConstants constants = {
+          .sourceTexelSize   = 1.0f / glm::vec2(source.width, source.height),
+          .thresholdOrRadius = settings.threshold,
+          .knee              = settings.knee,
+          .prefilter         = level == 0 ? 1u : 0u,
+      };
+
+      m_downsamplePipeline->bindDescriptorSets(commandBuffer, {{.set = 0, .bindIdx = level}});
+      m_downsamplePipeline->updatePushConstant(
+          commandBuffer, VK_SHADER_STAGE_COMPUTE_BIT, sizeof(constants), &constants
+      );
+      vkCmdDispatch(commandBuffer, groupCount(target.width), groupCount(target.height), 1);
+      computeBarrier(commandBuffer);
+    }
+
+    if (m_bloomLevels > 1) {
+      m_upsamplePipeline->bind(commandBuffer);
+      for (uint32_t level = m_bloomLevels - 1; level-- > 0;) {
+        const VkExtent2D source        = levelExtent(m_extent, level + 1);
+        const VkExtent2D target        = levelExtent(m_extent, level);
+        const BloomConstants constants = {
+            .sourceTexelSize   = 1.0f / glm::vec2(source.width, source.height),
+            .thresholdOrRadius = settings.radius,
+            .knee              = 0.0f,
+            .prefilter         = 0u,
+        };
+
+        m_upsamplePipeline->bindDescriptorSets(commandBuffer, {{.set = 0, .bindIdx = level}});
+        m_upsamplePipeline->updatePushConstant(
+            commandBuffer, VK_SHADER_STAGE_COMPUTE_BIT, sizeof(constants), &constants
+        );
+        vkCmdDispatch(commandBuffer, groupCount(target.width), groupCount(target.height), 1);
+        computeBarrier(commandBuffer);
+      }
+    }
+
+    m_context.endDebugUtilsLabel(commandBuffer);
+  }
+
+  void PostProcessChain::execute(
+      VkCommandBuffer commandBuffer,
+      const PostProcessSettings& settings,
+      uint32_t frameSlot
+  ) {
+    ZoneScopedN("PostProcessChain: execute");
+    ASSERT(m_input != nullptr, "PostProcessChain::setInput must be called before execute");
+
+    const auto& grading            = settings.colorGrading;
+    const PostProcessParams params = {
+        .bloom   = {settings.bloom.intensity, 0.0f, 0.0f, 0.0f},
+        .tonemap = {settings.exposure, 0.0f, 0.0f, 0.0f},
+        .grading = {grading.saturation, grading.contrast, 0.0f, 0.0f},
+        .lift    = glm::vec4(grading.lift, 0.0f),
+        .gamma   = glm::vec4(grading.gamma, 0.0f),
+        .gain    = glm::vec4(grading.gain, 0.0f),
+        .vignette =
+            {settings.vignette.intensity,
+             settings.vignette.radius,
+             settings.vignette.smoothness,
+             static_cast<float>(m_extent.width) / static_cast<float>(m_extent.height)},
+    };
+    std::memcpy(m_uniformBuffers[frameSlot]->map(), &params, sizeof(params));
+
+    // Everything stays in GENERAL; the leading barrier also orders this frame's
+    // writes after last frame's reads of the bloom targets and output.
+    m_input->transitionImageLayout(commandBuffer, VK_IMAGE_LAYOUT_GENERAL);
+    m_output->transitionImageLayout(commandBuffer, VK_IMAGE_LAYOUT_GENERAL);
+    for (auto& target : m_bloomTargets) {
+      target->transitionImageLayout(commandBuffer, VK_IMAGE_LAYOUT_GENERAL);
+    }
+    computeBarrier(commandBuffer);
+
+    if (m_bloomEnabled) {
+      recordBloom(commandBuffer, settings.bloom);
+    }
+
+    m_context.beginDebugUtilsLabel(
+        commandBuffer, "Post process fused: " + m_name, {0.8f, 0.5f, 1.0f, 1.0f}
+    );
+    auto& pipeline = fusedPipeline();
+    pipeline.bind(commandBuffer);
+    pipeline.bindDescriptorSets(commandBuffer, {{.set = 0, .bindIdx = frameSlot}});
+    vkCmdDispatch(commandBuffer, groupCount(m_extent.width), groupCount(m_extent.height), 1);
+    m_context.endDebugUtilsLabel(commandBuffer);
+
+    const VkMemoryBarrier barrier = {
+        .sType         = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+        .srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT,
+        .dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT | VK_ACCESS_SHADER_READ_BIT,
+    };
+    vkCmdPipelineBarrier(
+        commandBuffer,
+        VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+        VK_PIPELINE_STAGE_TRANSFER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+        0,
+        1,
+        &barrier,
+        0,
+        nullptr,
+        0,
+        nullptr
+    );
+  }
+} // namespace kst::renderer
@@ -0,0 +1,169 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "VulkanBackend/VulkanCore/Common.hpp"
+
+namespace VulkanCore {
+  class Buffer;
+  class Context;
+  class Pipeline;
+  class Sampler;
+  class ShaderModule;
+  class Texture;
+} // namespace VulkanCore
+
+namespace kst::renderer {
+  /**
+   * @brief Per-pixel effects that can be fused into the chain's single pass
+   *
+   * Values are shared with shaders/postprocess/common.glsl.
+   */
+  enum class PostEffect : uint32_t {
+    Bloom        = 1, // composite; the mip chain itself is built in separate passes
+    Tonemap      = 2,
+    ColorGrading = 3,
+    Vignette     = 4,
+  };
+
+  struct BloomSettings {
+    float threshold = 1.0f;
+    float knee      = 0.5f;
+    float intensity = 0.05f;
+    float radius    = 1.0f; // upsample filter radius in source texels
+  };
+
+  struct ColorGradingSettings {
+    float saturation = 1.0f;
+    float contrast   = 1.0f;
+    glm::vec3 lift{0.0f};
+    glm::vec3 gamma{1.0f};
+    glm::vec3 gain{1.0f};
+  };
+
+  struct VignetteSettings {
+    float intensity  = 0.3f;
+    float radius     = 0.9f;
+    float smoothness = 0.45f;
+  };
+
+  struct PostProcessSettings {
+    float exposure = 1.0f;
+    BloomSettings bloom;
+    ColorGradingSettings colorGrading;
+    VignetteSettings vignette;
+  };
+
+  /**
+   * @brief Compute-only post-processing chain
+   *
+   * The per-pixel effects set with setEffects() run as one compute pass: the
+   * effect order is specialised into a shared uber shader, so each distinct
+   * chain gets its own pipeline with the other effects compiled out. The HDR
+   * input is read once and the LDR output written once per pixel, instead of
+   * one full-screen render pass and image round trip per effect.
+   *
+   * Bloom needs its neighbourhood, so its downsample/upsample mip chain stays
+   * in separate passes on half-resolution and smaller targets; only the final
+   * composite is fused.
+   *
+   * All images are used in GENERAL layout as storage images. The output is
+   * left in GENERAL layout, ready to be blitted or copied to the swapchain.
+   */
+  class PostProcessChain {
+  public:
+    static constexpr uint32_t kMaxFusedEffects = 4;
+
+    struct Descriptor {
+      VkExtent2D extent       = {1, 1};
+      uint32_t bloomLevels    = 6;
+      uint32_t framesInFlight = 2;
+      bool encodeSrgb         = true; // the output is R8G8B8A8_UNORM, which may lack sRGB storage
+      std::string name        = "postprocess";
+    };
+
+    PostProcessChain(VulkanCore::Context& context, const Descriptor& descriptor);
+    ~PostProcessChain();
+
+    PostProcessChain(const PostProcessChain&)                    = delete;
+    auto operator=(const PostProcessChain&) -> PostProcessChain& = delete;
+    PostProcessChain(PostProcessChain&&)                         = delete;
+    auto operator=(PostProcessChain&&) -> PostProcessChain&      = delete;
+
+    /**
+     * @brief Sets the ordered list of fused effects
+     * @param effects Up to kMaxFusedEffects effects, applied in order
+     *
+     * The fused pipeline for an order is created on first use and cached.
+     */
+    void setEffects(std::span<const PostEffect> effects);
+
+    /**
+     * @brief Sets the HDR scene color read by the chain
+     * @param hdrColor R16G16B16A16_SFLOAT texture with STORAGE and SAMPLED usage
+     *
+     * Rewrites descriptor sets, so call it while no frame using this chain is in flight.
+     */
+    void setInput(std::shared_ptr<VulkanCore::Texture> hdrColor);
+
+    /**
+     * @brief Recreates the output and bloom targets
+     *
+     * Same restrictions as setInput(); set the new input afterwards.
+     */
+    void resize(VkExtent2D extent);
+
+    /**
+     * @brief Records the bloom passes (if enabled) and the fused pass
+     * @param commandBuffer Command buffer outside of a render pass
+     * @param settings Effect parameters for this frame
+     * @param frameSlot Frame in flight, selects the parameter buffer
+     */
+    void execute(
+        VkCommandBuffer commandBuffer,
+        const PostProcessSettings& settings,
+        uint32_t frameSlot
+    );
+
+    auto output() const -> const std::shared_ptr<VulkanCore::Texture>& { return m_output; }
+
+  private:
+    void createTargets();
+    void createBloomPipelines();
+    void bindBloomResources();
+    void bindFusedResources(VulkanCore::Pipeline& pipeline);
+    auto fusedPipeline() -> VulkanCore::Pipeline&;
+    void recordBloom(VkCommandBuffer commandBuffer, const BloomSettings& settings);
+
+    VulkanCore::Context& m_context;
+    std::string m_name;
+    VkExtent2D m_extent;
+    uint32_t m_bloomLevels;
+    uint32_t m_framesInFlight;
+    bool m_encodeSrgb;
+
+    std::vector<PostEffect> m_effects;
+    uint32_t m_effectsKey = 0;
+    bool m_bloomEnabled   = false;
+
+    std::shared_ptr<VulkanCore::Texture> m_input;
+    std::shared_ptr<VulkanCore::Texture> m_output;
+    std::vector<std::shared_ptr<VulkanCore::Texture>> m_bloomTargets;
+    std::shared_ptr<VulkanCore::Sampler> m_linearSampler;
+    std::vector<std::shared_ptr<VulkanCore::Buffer>> m_uniformBuffers;
+
+    std::shared_ptr<VulkanCore::ShaderModule> m_downsampleShader;
+    std::shared_ptr<VulkanCore::ShaderModule> m_upsampleShader;
+    std::shared_ptr<VulkanCore::ShaderModule> m_fusedShader;
+    std::shared_ptr<VulkanCore::Pipeline> m_downsamplePipeline;
+    std::shared_ptr<VulkanCore::Pipeline> m_upsamplePipeline;
+    std::unordered_map<uint32_t, std::shared_ptr<VulkanCore::Pipeline>> m_fusedPipelines;
+  };
+} // namespace kst::renderer
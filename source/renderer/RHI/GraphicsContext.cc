@@ -9,12 +9,18 @@
 #include "VulkanBackend/VulkanContext.hpp"
 
 namespace kst::renderer {
+  namespace {
+    auto toLower(std::string text) -> std::string {
+      std::ranges::transform(text, text.begin(), [](unsigned char cha) {
+        return std::tolower(cha);
+      });
+      return text;
+    }
+  } // namespace
+
   auto GraphicsContext::create(const std::string& backendType, const ContextOptions& options)
       -> std::shared_ptr<GraphicsContext> {
-    std::string lowerBackendType = backendType;
-    std::ranges::transform(lowerBackendType, lowerBackendType.begin(), [](unsigned char cha) {
-      return std::tolower(cha);
-    });
+    const std::string lowerBackendType = toLower(backendType);
 
     if (lowerBackendType == "vulkan") {
       KST_CORE_INFO("Creating Vulkan rendering context");
@@ -24,4 +30,10 @@ namespace kst::renderer {
     KST_CORE_ERROR("Unsupported rendering backend: {}", backendType);
     return nullptr;
   }
+
+  void GraphicsContext::preload(const std::string& backendType) {
+    if (toLower(backendType) == "vulkan") {
+      VulkanContext::preload();
+    }
+  }
 } // namespace kst::renderer
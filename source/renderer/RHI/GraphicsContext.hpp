@@ -27,6 +27,8 @@ namespace kst::renderer {
     void* window           = nullptr;  // Window handle (e.g., GLFWwindow*)
     uint32_t width         = 0;        // Window width
     uint32_t height        = 0;        // Window height
+    std::string captureFile;           // Records RHI commands for konstrukt_replay when set
+    bool submissionThread = false;     // Issues queue submits and presents from a dedicated thread
   };
 
   class GraphicsContext {
@@ -67,5 +69,9 @@ namespace kst::renderer {
 
     static auto create(const std::string& backendType, const ContextOptions& options = {})
         -> std::shared_ptr<GraphicsContext>;
+
+    // Does the window-independent part of create() ahead of time, from any
+    // thread, so it can overlap window creation. Optional.
+    static void preload(const std::string& backendType);
   };
 } // namespace kst::renderer
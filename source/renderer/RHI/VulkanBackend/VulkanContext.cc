@@ -3,17 +3,54 @@
 #include <cstdint>
 #include <string>
 
+#include "VulkanBackend/VulkanCore/CommandCapture.hpp"
 #include "VulkanBackend/VulkanCore/Context.hpp"
+#include "VulkanBackend/VulkanCore/SubmissionThread.hpp"
+#include "core/CVar.hpp"
 #include "core/Logger.hpp"
+#include "core/MemoryTracker.hpp"
 
 namespace kst::renderer {
+  namespace {
+    core::CVar<std::string> presentMode(
+        "r.presentMode",
+        "mailbox",
+        "Swapchain present mode: mailbox, fifo, fifo_relaxed or immediate; read when the "
+        "swapchain is created",
+        core::CVarFlags::Startup
+    );
+
+    auto toVkPresentMode(std::string_view name) -> VkPresentModeKHR {
+      if (name == "fifo") {
+        return VK_PRESENT_MODE_FIFO_KHR;
+      }
+      if (name == "fifo_relaxed") {
+        return VK_PRESENT_MODE_FIFO_RELAXED_KHR;
+      }
+      if (name == "immediate") {
+        return VK_PRESENT_MODE_IMMEDIATE_KHR;
+      }
+      if (name != "mailbox") {
+        KST_CORE_WARN("Unknown r.presentMode '{}', using mailbox", name);
+      }
+      return VK_PRESENT_MODE_MAILBOX_KHR;
+    }
+  } // namespace
+
   VulkanContext::VulkanContext(const ContextOptions& options) {
     initVulkan(options);
   }
 
   VulkanContext::~VulkanContext() {}
 
+  void VulkanContext::preload() {
+    KST_MEMORY_SCOPE(RHI);
+    VulkanCore::Context::preloadLoader();
+  }
+
   void VulkanContext::initVulkan(const ContextOptions& options) {
+    KST_MEMORY_SCOPE(RHI);
+
     std::vector<std::string> instanceExtensions;
     setupInstanceExtension(instanceExtensions, options);
 
@@ -32,6 +69,7 @@ namespace kst::renderer {
     VulkanCore::Context::enableBufferDeviceAddressFeature();
     VulkanCore::Context::enableDynamicRenderingFeature();
     VulkanCore::Context::enableSynchronization2Feature();
+    VulkanCore::Context::enableDeviceGeneratedCommandsFeature();
 
     m_context = std::make_unique<VulkanCore::Context>(
         options.window,
@@ -51,6 +89,16 @@ namespace kst::renderer {
         deviceExtensions.size(),
         validationLayers.size()
     );
+
+    if (!options.captureFile.empty()) {
+      m_context->beginCommandCapture(options.captureFile);
+      KST_CORE_INFO("Capturing RHI commands to {}", options.captureFile);
+    }
+
+    if (options.submissionThread) {
+      m_context->startSubmissionThread();
+      KST_CORE_INFO("Queue submits and presents run on a dedicated thread");
+    }
   }
 
   void VulkanContext::setupInstanceExtension(
@@ -91,6 +139,10 @@ namespace kst::renderer {
     extensions.emplace_back(VK_KHR_SYNCHRONIZATION_2_EXTENSION_NAME);
     extensions.emplace_back(VK_KHR_BUFFER_DEVICE_ADDRESS_EXTENSION_NAME);
 
+    // Optional; only used when the device exposes both
+    extensions.emplace_back(VK_KHR_MAINTENANCE_5_EXTENSION_NAME);
+    extensions.emplace_back(VK_EXT_DEVICE_GENERATED_COMMANDS_EXTENSION_NAME);
+
     // Ray tracing
     if (options.enableRayTracing) {
       extensions.emplace_back(VK_KHR_ACCELERATION_STRUCTURE_EXTENSION_NAME);
@@ -115,11 +167,12 @@ namespace kst::renderer {
       return false;
     }
 
+    KST_MEMORY_SCOPE(RHI);
     try {
       m_context->createSwapchain(
           VK_FORMAT_B8G8R8A8_SRGB,
           VK_COLOR_SPACE_SRGB_NONLINEAR_KHR,
-          VK_PRESENT_MODE_MAILBOX_KHR,
+          toVkPresentMode(presentMode.get()),
           {descriptor.width, descriptor.height}
       );
 
@@ -162,10 +215,20 @@ namespace kst::renderer {
     return 0;
   }
 
-  void VulkanContext::endFrame() {}
+  void VulkanContext::endFrame() {
+    KST_MEMORY_SCOPE(RHI);
+
+    // Presents delimit captured frames; offscreen rendering has to do it here
+    if (auto* capture = m_context->commandCapture(); capture && !m_context->swapchain()) {
+      capture->endFrame();
+    }
+  }
 
   void VulkanContext::waitIdle() {
     if (m_context) {
+      if (auto* submissionThread = m_context->submissionThread()) {
+        submissionThread->waitIdle();
+      }
       vkDeviceWaitIdle(m_context->device());
     }
   }
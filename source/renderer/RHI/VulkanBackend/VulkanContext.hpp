@@ -53,6 +53,8 @@ namespace kst::renderer {
 
     auto getImplementationName() const -> const char* override { return "Vulkan"; }
 
+    static void preload();
+
   private:
     void initVulkan(const ContextOptions& options);
     static void
@@ -0,0 +1,238 @@
+#include "AsyncCompute.hpp"
+
+#include <utility>
+#include <tracy/Tracy.hpp>
+
+#include "Buffer.hpp"
+#include "CommandQueueManager.hpp"
+#include "Context.hpp"
+#include "Texture.hpp"
+#include "core/Metrics.hpp"
+
+namespace VulkanCore {
+
+  AsyncComputeScheduler::AsyncComputeScheduler(
+      const Context& context,
+      const CommandQueueManager& graphicsQueue,
+      CommandQueueManager& computeQueue,
+      uint32_t framesInFlight,
+      const std::string& name
+  )
+      : context_(&context),
+        computeQueue_(&computeQueue),
+        name_(name),
+        graphicsFamily_(graphicsQueue.queueFamilyIndex()),
+        computeFamily_(computeQueue.queueFamilyIndex()),
+        computeTimer_(context, computeQueue.queueFamilyIndex(), framesInFlight, name) {
+    auto& metrics     = kst::core::MetricsRegistry::instance();
+    const auto labels = "scheduler=\"" + name + "\"";
+    workloadCounter_  = &metrics.counter(
+        "kst_async_compute_workloads_total",
+        "Workloads moved from the graphics queue to an async compute queue",
+        labels
+    );
+    transferCounter_ = &metrics.counter(
+        "kst_async_compute_ownership_transfers_total",
+        "Queue-family ownership transfers recorded for async compute resources",
+        labels
+    );
+  }
+
+  void AsyncComputeScheduler::enqueue(AsyncComputeWorkload&& workload) {
+    ASSERT(stage_ == Stage::Recording, "Workloads can't be added once the frame was released");
+    ASSERT(workload.record, "Async compute workload has nothing to record");
+    workloads_.push_back(std::move(workload));
+  }
+
+  VkSemaphore AsyncComputeScheduler::releaseToCompute(VkCommandBuffer graphicsCommandBuffer) {
+    ASSERT(stage_ == Stage::Recording, "releaseToCompute() called twice in a frame");
+    if (workloads_.empty()) {
+      return VK_NULL_HANDLE;
+    }
+
+    recordTransfer(graphicsCommandBuffer, true, false);
+    toCompute_ = context_->semaphorePool().acquire("Async compute: " + name_ + " (to compute)");
+    stage_     = Stage::Released;
+    return toCompute_;
+  }
+
+  void AsyncComputeScheduler::submit() {
+    ZoneScopedN("AsyncCompute: submit");
+    if (stage_ == Stage::Recording && workloads_.empty()) {
+      return;
+    }
+    ASSERT(stage_ == Stage::Released, "submit() needs releaseToCompute() first");
+
+    auto commandBuffer = computeQueue_->getCmdBufferToBegin();
+    computeTimer_.nextFrame();
+    computeTimer_.writeBegin(commandBuffer);
+
+    recordTransfer(commandBuffer, true, true);
+    for (const auto& workload : workloads_) {
+      context_->beginDebugUtilsLabel(commandBuffer, workload.name, {0.0f, 0.5f, 1.0f, 1.0f});
+      workload.record(commandBuffer);
+      context_->endDebugUtilsLabel(commandBuffer);
+    }
+    recordTransfer(commandBuffer, false, false);
+
+    computeTimer_.writeEnd(commandBuffer);
+    computeQueue_->endCmdBuffer(commandBuffer);
+
+    toGraphics_ = context_->semaphorePool().acquire("Async compute: " + name_ + " (to graphics)");
+    const VkPipelineStageFlags waitStage = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+    const VkSubmitInfo submitInfo        = {
+        .sType                = VK_STRUCTURE_TYPE_SUBMIT_INFO,
+        .waitSemaphoreCount   = 1,
+        .pWaitSemaphores      = &toCompute_,
+        .pWaitDstStageMask    = &waitStage,
+        .commandBufferCount   = 1,
+        .pCommandBuffers      = &commandBuffer,
+        .signalSemaphoreCount = 1,
+        .pSignalSemaphores    = &toGraphics_,
+    };
+    computeQueue_->submit(&submitInfo);
+    computeQueue_->goToNextCmdBuffer();
+
+    // The compute submit is the semaphore's last use
+    context_->semaphorePool().releaseWhenRetired(toCompute_);
+    toCompute_ = VK_NULL_HANDLE;
+
+    workloadCounter_->add(workloads_.size());
+    stage_ = Stage::Submitted;
+  }
+
+  AsyncComputeWait AsyncComputeScheduler::acquireFromCompute(
+      VkCommandBuffer graphicsCommandBuffer
+  ) {
+    if (stage_ == Stage::Recording && workloads_.empty()) {
+      return {};
+    }
+    ASSERT(stage_ == Stage::Submitted, "acquireFromCompute() needs submit() first");
+
+    recordTransfer(graphicsCommandBuffer, false, true);
+    const AsyncComputeWait wait = {
+        .semaphore = toGraphics_,
+        .stage     = graphicsStages(),
+    };
+
+    // Retires with the graphics submit being recorded, which waits on it
+    context_->semaphorePool().releaseWhenRetired(toGraphics_);
+    toGraphics_ = VK_NULL_HANDLE;
+
+    workloads_.clear();
+    stage_ = Stage::Recording;
+    return wait;
+  }
+
+  void AsyncComputeScheduler::recordTransfer(
+      VkCommandBuffer commandBuffer,
+      bool toCompute,
+      bool acquire
+  ) const {
+    if (!transfersOwnership()) {
+      return;
+    }
+
+    const uint32_t srcFamily = toCompute ? graphicsFamily_ : computeFamily_;
+    const uint32_t dstFamily = toCompute ? computeFamily_ : graphicsFamily_;
+    // Releasing to compute and acquiring from it happen on the graphics queue
+    const bool onCompute = toCompute == acquire;
+
+    // The release half only makes the source queue's writes available, the
+    // acquire half only makes them visible to the destination's accesses; the
+    // semaphore in between provides the execution dependency
+    const auto accesses = [&](VkAccessFlags graphicsAccess, VkAccessFlags computeAccess) {
+      const VkAccessFlags own = onCompute ? computeAccess : graphicsAccess;
+      return std::pair<VkAccessFlags, VkAccessFlags>{
+          acquire ? 0 : own,
+          acquire ? own : 0,
+      };
+    };
+    const auto ownStage = [&](VkPipelineStageFlags graphicsStage) {
+      return onCompute ? VkPipelineStageFlags(VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT) : graphicsStage;
+    };
+
+    VkPipelineStageFlags stages = 0;
+    std::vector<VkBufferMemoryBarrier> bufferBarriers;
+    std::vector<VkImageMemoryBarrier> imageBarriers;
+    for (const auto& workload : workloads_) {
+      for (const auto& use : workload.buffers) {
+        const auto [srcAccess, dstAccess] = accesses(use.graphicsAccess, use.computeAccess);
+        stages |= ownStage(use.graphicsStage);
+        bufferBarriers.push_back({
+            .sType               = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER,
+            .srcAccessMask       = srcAccess,
+            .dstAccessMask       = dstAccess,
+            .srcQueueFamilyIndex = srcFamily,
+            .dstQueueFamilyIndex = dstFamily,
+            .buffer              = use.buffer->vkBuffer(),
+            .offset              = 0,
+            .size                = VK_WHOLE_SIZE,
+        });
+      }
+      for (const auto& use : workload.images) {
+        const auto [srcAccess, dstAccess] = accesses(use.graphicsAccess, use.computeAccess);
+        stages |= ownStage(use.graphicsStage);
+
+        VkImageAspectFlags aspect = VK_IMAGE_ASPECT_COLOR_BIT;
+        if (use.texture->isDepth()) {
+          aspect = VK_IMAGE_ASPECT_DEPTH_BIT;
+          if (use.texture->isStencil()) {
+            aspect |= VK_IMAGE_ASPECT_STENCIL_BIT;
+          }
+        }
+        imageBarriers.push_back({
+            .sType               = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+            .srcAccessMask       = srcAccess,
+            .dstAccessMask       = dstAccess,
+            .oldLayout           = use.layout,
+            .newLayout           = use.layout,
+            .srcQueueFamilyIndex = srcFamily,
+            .dstQueueFamilyIndex = dstFamily,
+            .image               = use.texture->vkImage(),
+            .subresourceRange =
+                {
+                    .aspectMask     = aspect,
+                    .baseMipLevel   = 0,
+                    .levelCount     = VK_REMAINING_MIP_LEVELS,
+                    .baseArrayLayer = 0,
+                    .layerCount     = VK_REMAINING_ARRAY_LAYERS,
+                },
+        });
+      }
+    }
+    if (bufferBarriers.empty() && imageBarriers.empty()) {
+      return;
+    }
+
+    vkCmdPipelineBarrier(
+        commandBuffer,
+        acquire ? VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT : stages,
+        acquire ? stages : VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+        0,
+        0,
+        nullptr,
+        static_cast<uint32_t>(bufferBarriers.size()),
+        bufferBarriers.data(),
+        static_cast<uint32_t>(imageBarriers.size()),
+        imageBarriers.data()
+    );
+    transferCounter_->add(bufferBarriers.size() + imageBarriers.size());
+  }
+
+  VkPipelineStageFlags AsyncComputeScheduler::graphicsStages() const {
+    VkPipelineStageFlags stages = 0;
+    for (const auto& workload : workloads_) {
+      for (const auto& use : workload.buffers) {
+        stages |= use.graphicsStage;
+      }
+      for (const auto& use : workload.images) {
+        stages |= use.graphicsStage;
+      }
+    }
+    // Nothing on the graphics queue reads the results; the wait is only there
+    // to consume the semaphore
+    return stages != 0 ? stages : VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT;
+  }
+
+} // namespace VulkanCore
@@ -0,0 +1,143 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "Common.hpp"
+#include "QueueTimer.hpp"
+#include "Utility.hpp"
+
+namespace kst::core {
+  class Counter;
+} // namespace kst::core
+
+namespace VulkanCore {
+
+  class Buffer;
+  class CommandQueueManager;
+  class Context;
+  class Texture;
+
+  // A resource the graphics queue hands to an async workload and takes back
+  // afterwards. graphicsStage/graphicsAccess describe the last graphics use
+  // before the hand-off and the first one after it; computeAccess how the
+  // workload touches it.
+  struct AsyncBufferUse {
+    std::shared_ptr<Buffer> buffer;
+    VkPipelineStageFlags graphicsStage = VK_PIPELINE_STAGE_ALL_GRAPHICS_BIT;
+    VkAccessFlags graphicsAccess       = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+    VkAccessFlags computeAccess        = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+  };
+
+  // Images keep their layout across the hand-off, so it has to be one the
+  // compute queue can use (GENERAL or SHADER_READ_ONLY_OPTIMAL)
+  struct AsyncImageUse {
+    std::shared_ptr<Texture> texture;
+    VkImageLayout layout               = VK_IMAGE_LAYOUT_GENERAL;
+    VkPipelineStageFlags graphicsStage = VK_PIPELINE_STAGE_ALL_GRAPHICS_BIT;
+    VkAccessFlags graphicsAccess       = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+    VkAccessFlags computeAccess        = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+  };
+
+  struct AsyncComputeWorkload {
+    std::string name;
+    std::vector<AsyncBufferUse> buffers;
+    std::vector<AsyncImageUse> images;
+    // Records dispatches into a compute queue command buffer
+    std::function<void(VkCommandBuffer)> record;
+  };
+
+  // Semaphore the graphics submit that consumes async results has to wait on
+  struct AsyncComputeWait {
+    VkSemaphore semaphore      = VK_NULL_HANDLE;
+    VkPipelineStageFlags stage = VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT;
+  };
+
+  // Moves compute work tagged as async off the graphics queue and onto a
+  // compute CommandQueueManager, so it overlaps with rendering. One frame goes
+  //
+  //   graphics cmd A: ...produce inputs...  releaseToCompute(A)  -> signal S1
+  //   compute  cmd:   submit()          waits S1, runs workloads -> signal S2
+  //   graphics cmd B: acquireFromCompute(B)  waits S2 at the consuming stages
+  //
+  // Everything the graphics queue does between A and B runs alongside the
+  // compute work. When the two queues belong to different families the
+  // scheduler records the queue-family ownership transfers (release on the
+  // source queue, matching acquire on the destination) for every declared
+  // resource; on a shared family the semaphores alone order the accesses.
+  // Semaphores are binary and come from Context::semaphorePool(), so submits
+  // may go through the submission thread like any other.
+  //
+  // Workloads that touch no shared resource only cost the semaphores. The
+  // compute queue's GPU time per frame is exported through a QueueTimer named
+  // after the scheduler; pair it with a graphics QueueTimer to compare queues.
+  // Not thread safe: drive it from the thread that records the frame.
+  class AsyncComputeScheduler final {
+  public:
+    AsyncComputeScheduler(
+        const Context& context,
+        const CommandQueueManager& graphicsQueue,
+        CommandQueueManager& computeQueue,
+        uint32_t framesInFlight,
+        const std::string& name
+    );
+
+    AsyncComputeScheduler(const AsyncComputeScheduler&)            = delete;
+    AsyncComputeScheduler& operator=(const AsyncComputeScheduler&) = delete;
+
+    void enqueue(AsyncComputeWorkload&& workload);
+
+    bool empty() const { return workloads_.empty(); }
+
+    // Graphics side, last thing in the command buffer that produces the
+    // workloads' inputs. Returns the semaphore its submit has to signal, or
+    // VK_NULL_HANDLE when nothing is queued.
+    VkSemaphore releaseToCompute(VkCommandBuffer graphicsCommandBuffer);
+
+    // Records and submits the queued workloads on the compute queue. Call
+    // after the submit that signals the releaseToCompute() semaphore was
+    // handed to the driver, or the compute queue waits on nothing.
+    void submit();
+
+    // Graphics side, first thing in the command buffer that consumes the
+    // results. Its submit has to wait on the returned semaphore; the queued
+    // workloads are dropped afterwards.
+    AsyncComputeWait acquireFromCompute(VkCommandBuffer graphicsCommandBuffer);
+
+    bool transfersOwnership() const { return graphicsFamily_ != computeFamily_; }
+
+    QueueTimer& computeTimer() { return computeTimer_; }
+
+  private:
+    enum class Stage : uint8_t {
+      Recording,   // enqueue() and releaseToCompute() are valid
+      Released,    // waiting for submit()
+      Submitted,   // waiting for acquireFromCompute()
+    };
+
+    // Ownership transfer barriers for every declared resource. toCompute
+    // selects the direction, acquire whether this is the release half on the
+    // source queue or the acquire half on the destination.
+    void recordTransfer(VkCommandBuffer commandBuffer, bool toCompute, bool acquire) const;
+
+    VkPipelineStageFlags graphicsStages() const;
+
+  private:
+    const Context* context_            = nullptr;
+    CommandQueueManager* computeQueue_ = nullptr;
+    std::string name_;
+    uint32_t graphicsFamily_ = 0;
+    uint32_t computeFamily_  = 0;
+    Stage stage_             = Stage::Recording;
+    std::vector<AsyncComputeWorkload> workloads_;
+    VkSemaphore toCompute_  = VK_NULL_HANDLE;
+    VkSemaphore toGraphics_ = VK_NULL_HANDLE;
+    QueueTimer computeTimer_;
+    kst::core::Counter* workloadCounter_ = nullptr;
+    kst::core::Counter* transferCounter_ = nullptr;
+  };
+
+} // namespace VulkanCore
@@ -1,9 +1,11 @@
 #include "Buffer.hpp"
 
 #include <algorithm>
+#include <atomic>
 #include <cstring>
 #include <iostream>
 
+#include "CommandCapture.hpp"
 #include "Context.hpp"
 #include "Texture.hpp"
 
@@ -47,6 +49,10 @@ namespace VulkanCore {
     );
     vmaGetAllocationInfo(allocator_, allocation_, &allocationInfo_);
 
+    if (auto* capture = context->commandCapture()) {
+      capture->onBufferCreated(buffer_, createInfo, allocCreateInfo_);
+    }
+
     context->setVkObjectname(buffer_, VK_OBJECT_TYPE_BUFFER, "Staging Buffer: " + name);
   }
 
@@ -62,19 +68,48 @@ namespace VulkanCore {
     VK_CHECK(vmaCreateBuffer(allocator_, &createInfo, &allocInfo, &buffer_, &allocation_, nullptr));
     vmaGetAllocationInfo(allocator_, allocation_, &allocationInfo_);
 
+    // Queried once here so vkDeviceAddress() is a plain read from any thread
+    if (usage_ & VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT) {
+      const VkBufferDeviceAddressInfo bdAddressInfo = {
+          .sType  = VK_STRUCTURE_TYPE_BUFFER_DEVICE_ADDRESS_INFO,
+          .buffer = buffer_,
+      };
+      bufferDeviceAddress_ = vkGetBufferDeviceAddress(context->device(), &bdAddressInfo);
+    }
+
+    if (auto* capture = context->commandCapture()) {
+      capture->onBufferCreated(buffer_, createInfo, allocInfo);
+    }
+
     context->setVkObjectname(buffer_, VK_OBJECT_TYPE_BUFFER, "Buffer: " + name);
   }
 
   Buffer::~Buffer() {
-    if (mappedMemory_) {
-      vmaUnmapMemory(allocator_, allocation_);
+    if (auto* capture = context_->commandCapture()) {
+      capture->onDestroyed(CaptureObject::Buffer, (uint64_t)buffer_);
     }
 
+    std::vector<VkBufferView> bufferViews;
     for (auto& [bufferViewFormat, bufferView] : bufferViews_) {
-      vkDestroyBufferView(context_->device(), bufferView, nullptr);
+      bufferViews.push_back(bufferView);
     }
 
-    vmaDestroyBuffer(allocator_, buffer_, allocation_);
+    context_->deletionQueue().enqueue(
+        [device      = context_->device(),
+         allocator   = allocator_,
+         buffer      = buffer_,
+         allocation  = allocation_,
+         mapped      = mappedMemory_ != nullptr,
+         bufferViews = std::move(bufferViews)]() {
+          if (mapped) {
+            vmaUnmapMemory(allocator, allocation);
+          }
+          for (const auto bufferView : bufferViews) {
+            vkDestroyBufferView(device, bufferView, nullptr);
+          }
+          vmaDestroyBuffer(allocator, buffer, allocation);
+        }
+    );
   }
 
   VkDeviceSize Buffer::size() const {
@@ -108,10 +143,30 @@ namespace VulkanCore {
   }
 
   void Buffer::copyDataToBuffer(const void* data, size_t size) const {
+    memcpy(map(), data, size);
+  }
+
+  void* Buffer::map() const {
+    // Mapped once and never unmapped while alive, so only the first call locks
+    std::atomic_ref<void*> mapped(mappedMemory_);
+    if (void* memory = mapped.load(std::memory_order_acquire)) {
+      return memory;
+    }
+
+    std::unique_lock lock(*lazyStateMutex_);
     if (!mappedMemory_) {
-      VK_CHECK(vmaMapMemory(allocator_, allocation_, &mappedMemory_));
+      void* memory = nullptr;
+      VK_CHECK(vmaMapMemory(allocator_, allocation_, &memory));
+      if (auto* capture = context_->commandCapture()) {
+        capture->onBufferMapped(buffer_, memory, size_);
+      }
+      mapped.store(memory, std::memory_order_release);
     }
-    memcpy(mappedMemory_, data, size);
+    return mappedMemory_;
+  }
+
+  void Buffer::invalidate(VkDeviceSize offset, VkDeviceSize size) const {
+    VK_CHECK(vmaInvalidateAllocation(allocator_, allocation_, offset, size));
   }
 
   VkDeviceAddress Buffer::vkDeviceAddress() const {
@@ -119,21 +174,15 @@ namespace VulkanCore {
       return actualBufferIfStaging_->vkDeviceAddress();
     }
 
-#if defined(VK_KHR_buffer_device_address) && defined(_WIN32)
-    if (!bufferDeviceAddress_) {
-      const VkBufferDeviceAddressInfo bdAddressInfo = {
-          .sType  = VK_STRUCTURE_TYPE_BUFFER_DEVICE_ADDRESS_INFO,
-          .buffer = buffer_,
-      };
-      bufferDeviceAddress_ = vkGetBufferDeviceAddress(context_->device(), &bdAddressInfo);
-    }
+    ASSERT(
+        usage_ & VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT,
+        "Buffer was not created with VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT"
+    );
     return bufferDeviceAddress_;
-#else
-    return 0;
-#endif
   }
 
   VkBufferView Buffer::requestBufferView(VkFormat viewFormat) {
+    std::unique_lock lock(*lazyStateMutex_);
     auto itr = bufferViews_.find(viewFormat);
     if (itr != bufferViews_.end()) {
       return itr->second;
@@ -150,6 +199,9 @@ namespace VulkanCore {
     VkBufferView bufferView;
     VK_CHECK(vkCreateBufferView(context_->device(), &createInfo, nullptr, &bufferView));
     bufferViews_[viewFormat] = bufferView;
+    if (auto* capture = context_->commandCapture()) {
+      capture->onBufferViewCreated(bufferView, buffer_, viewFormat);
+    }
     return bufferView;
   }
 
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <memory>
+#include <mutex>
 #include <string>
 #include <unordered_map>
 #include <vector>
@@ -53,8 +54,15 @@ namespace VulkanCore {
 
     void copyDataToBuffer(const void* data, size_t size) const;
 
+    // Maps the allocation on first use; it stays mapped until the buffer is destroyed
+    void* map() const;
+
+    // Makes GPU writes visible to map() on non-coherent memory
+    void invalidate(VkDeviceSize offset = 0, VkDeviceSize size = VK_WHOLE_SIZE) const;
+
     VkBuffer vkBuffer() const { return buffer_; }
 
+    // Queried at creation for buffers with VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT
     VkDeviceAddress vkDeviceAddress() const;
 
     // managed by buffer
@@ -70,9 +78,13 @@ namespace VulkanCore {
     Buffer* actualBufferIfStaging_               = nullptr;
     VmaAllocation allocation_                    = nullptr;
     VmaAllocationInfo allocationInfo_            = {};
-    mutable VkDeviceAddress bufferDeviceAddress_ = 0;
+    VkDeviceAddress bufferDeviceAddress_         = 0;
     mutable void* mappedMemory_                  = nullptr;
     std::unordered_map<VkFormat, VkBufferView> bufferViews_;
+    // Guards the lazily created mapping and buffer views so threads sharing a
+    // buffer can call map() and requestBufferView() concurrently; boxed to keep
+    // Buffer movable
+    std::unique_ptr<std::mutex> lazyStateMutex_ = std::make_unique<std::mutex>();
   };
 
 } // namespace VulkanCore
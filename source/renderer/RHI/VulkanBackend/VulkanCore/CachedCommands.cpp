@@ -0,0 +1,175 @@
+#include "CachedCommands.hpp"
+
+#include <utility>
+#include <tracy/Tracy.hpp>
+
+#include "Buffer.hpp"
+#include "CommandQueueManager.hpp"
+#include "Context.hpp"
+#include "Pipeline.hpp"
+#include "Texture.hpp"
+#include "core/Metrics.hpp"
+
+namespace VulkanCore {
+
+  void CachedPassDependencies::use(const std::shared_ptr<Buffer>& buffer) {
+    tracked_.push_back({.object = buffer});
+  }
+
+  void CachedPassDependencies::use(const std::shared_ptr<Texture>& texture) {
+    tracked_.push_back({.object = texture});
+  }
+
+  void CachedPassDependencies::use(const std::shared_ptr<Pipeline>& pipeline) {
+    tracked_.push_back({
+        .object     = pipeline,
+        .pipeline   = pipeline.get(),
+        .generation = pipeline->descriptorGeneration(),
+    });
+  }
+
+  bool CachedPassDependencies::changed() const {
+    for (const auto& tracked : tracked_) {
+      // Holding the lock keeps the pipeline alive while its generation is read
+      const auto object = tracked.object.lock();
+      if (!object) {
+        return true;
+      }
+      if (tracked.pipeline && tracked.pipeline->descriptorGeneration() != tracked.generation) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  CachedCommandBuffer::CachedCommandBuffer(
+      const Context& context,
+      CommandQueueManager& queue,
+      CachedPassDescriptor desc,
+      const std::string& name
+  )
+      : context_(&context),
+        queue_(&queue),
+        device_(context.device()),
+        desc_(std::move(desc)),
+        name_(name) {
+    ASSERT(desc_.record, "Cached pass has nothing to record");
+
+    // Recordings are reset one at a time when they get reused
+    const VkCommandPoolCreateInfo poolInfo = {
+        .sType            = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
+        .flags            = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT,
+        .queueFamilyIndex = queue.queueFamilyIndex(),
+    };
+    VK_CHECK(vkCreateCommandPool(device_, &poolInfo, nullptr, &commandPool_));
+    context.setVkObjectname(
+        commandPool_, VK_OBJECT_TYPE_COMMAND_POOL, "Cached pass command pool: " + name
+    );
+
+    auto& metrics     = kst::core::MetricsRegistry::instance();
+    const auto labels = "pass=\"" + name + "\"";
+    recordCounter_    = &metrics.counter(
+        "kst_cached_pass_records_total", "Times a cached pass was (re-)recorded", labels
+    );
+    replayCounter_ = &metrics.counter(
+        "kst_cached_pass_replays_total", "Times a cached pass was replayed into a primary", labels
+    );
+  }
+
+  CachedCommandBuffer::~CachedCommandBuffer() {
+    // Destroying the pool frees every recording; in-flight frames may still
+    // replay them
+    context_->deletionQueue().enqueue([device = device_, commandPool = commandPool_]() {
+      vkDestroyCommandPool(device, commandPool, nullptr);
+    });
+  }
+
+  bool CachedCommandBuffer::isValid(uint64_t stateKey) const {
+    return valid_ && stateKey == stateKey_ && !dependencies_.changed();
+  }
+
+  void CachedCommandBuffer::execute(VkCommandBuffer primaryCommandBuffer, uint64_t stateKey) {
+    ZoneScopedN("CachedPass: execute");
+    if (!isValid(stateKey)) {
+      rerecord(stateKey);
+    }
+
+    vkCmdExecuteCommands(primaryCommandBuffer, 1, &current_.commandBuffer);
+    current_.lastUse = queue_->nextSubmitValue();
+    replayCounter_->add();
+  }
+
+  void CachedCommandBuffer::rerecord(uint64_t stateKey) {
+    ZoneScopedN("CachedPass: record");
+    if (current_.commandBuffer != VK_NULL_HANDLE) {
+      retired_.push_back(current_);
+    }
+    current_ = {.commandBuffer = acquireCommandBuffer()};
+
+    const VkCommandBufferInheritanceRenderingInfo renderingInfo = {
+        .sType                   = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_RENDERING_INFO,
+        .colorAttachmentCount    = static_cast<uint32_t>(desc_.colorFormats.size()),
+        .pColorAttachmentFormats = desc_.colorFormats.data(),
+        .depthAttachmentFormat   = desc_.depthFormat,
+        .stencilAttachmentFormat = desc_.stencilFormat,
+        .rasterizationSamples    = desc_.sampleCount,
+    };
+    const bool dynamicRendering = desc_.renderPass == VK_NULL_HANDLE &&
+                                  (!desc_.colorFormats.empty() ||
+                                   desc_.depthFormat != VK_FORMAT_UNDEFINED ||
+                                   desc_.stencilFormat != VK_FORMAT_UNDEFINED);
+    const bool insideRendering  = dynamicRendering || desc_.renderPass != VK_NULL_HANDLE;
+
+    const VkCommandBufferInheritanceInfo inheritanceInfo = {
+        .sType      = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO,
+        .pNext      = dynamicRendering ? &renderingInfo : nullptr,
+        .renderPass = desc_.renderPass,
+        .subpass    = desc_.subpass,
+    };
+    VkCommandBufferUsageFlags flags = VK_COMMAND_BUFFER_USAGE_SIMULTANEOUS_USE_BIT;
+    if (insideRendering) {
+      flags |= VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT;
+    }
+    const VkCommandBufferBeginInfo beginInfo = {
+        .sType            = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+        .flags            = flags,
+        .pInheritanceInfo = &inheritanceInfo,
+    };
+    VK_CHECK(vkBeginCommandBuffer(current_.commandBuffer, &beginInfo));
+
+    dependencies_.clear();
+    desc_.record(current_.commandBuffer, dependencies_);
+    VK_CHECK(vkEndCommandBuffer(current_.commandBuffer));
+
+    stateKey_ = stateKey;
+    valid_    = true;
+    recordCounter_->add();
+  }
+
+  VkCommandBuffer CachedCommandBuffer::acquireCommandBuffer() {
+    const uint64_t completed = queue_->completedSubmitValue();
+    for (auto it = retired_.begin(); it != retired_.end(); ++it) {
+      if (it->lastUse > completed) {
+        continue;
+      }
+      const VkCommandBuffer commandBuffer = it->commandBuffer;
+      retired_.erase(it);
+      VK_CHECK(vkResetCommandBuffer(commandBuffer, 0));
+      return commandBuffer;
+    }
+
+    const VkCommandBufferAllocateInfo allocateInfo = {
+        .sType              = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
+        .commandPool        = commandPool_,
+        .level              = VK_COMMAND_BUFFER_LEVEL_SECONDARY,
+        .commandBufferCount = 1,
+    };
+    VkCommandBuffer commandBuffer = VK_NULL_HANDLE;
+    VK_CHECK(vkAllocateCommandBuffers(device_, &allocateInfo, &commandBuffer));
+    context_->setVkObjectname(
+        commandBuffer, VK_OBJECT_TYPE_COMMAND_BUFFER, "Cached pass: " + name_
+    );
+    return commandBuffer;
+  }
+
+} // namespace VulkanCore
@@ -0,0 +1,132 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "Common.hpp"
+#include "Utility.hpp"
+
+namespace kst::core {
+  class Counter;
+} // namespace kst::core
+
+namespace VulkanCore {
+
+  class Buffer;
+  class CommandQueueManager;
+  class Context;
+  class Pipeline;
+  class Texture;
+
+  // Objects a cached recording references. Handed to the record callback,
+  // which declares everything it binds or draws from; the recording is
+  // re-recorded once any of them was destroyed (replacing a resource with a
+  // new one releases the old) or a pipeline's descriptor sets were rewritten.
+  class CachedPassDependencies final {
+  public:
+    void use(const std::shared_ptr<Buffer>& buffer);
+    void use(const std::shared_ptr<Texture>& texture);
+    void use(const std::shared_ptr<Pipeline>& pipeline);
+
+    bool changed() const;
+
+    void clear() { tracked_.clear(); }
+
+  private:
+    struct Tracked {
+      std::weak_ptr<const void> object;
+      const Pipeline* pipeline = nullptr; // only set for pipelines
+      uint64_t generation      = 0;
+    };
+    std::vector<Tracked> tracked_;
+  };
+
+  struct CachedPassDescriptor {
+    // Recorded inside a vkCmdBeginRendering() begun with
+    // VK_RENDERING_CONTENTS_SECONDARY_COMMAND_BUFFERS_BIT; the formats and
+    // samples have to match its attachments. Leave them empty for passes
+    // replayed outside rendering (copies, dispatches).
+    std::vector<VkFormat> colorFormats;
+    VkFormat depthFormat              = VK_FORMAT_UNDEFINED;
+    VkFormat stencilFormat            = VK_FORMAT_UNDEFINED;
+    VkSampleCountFlagBits sampleCount = VK_SAMPLE_COUNT_1_BIT;
+    // Render pass path instead, begun with VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS
+    VkRenderPass renderPass = VK_NULL_HANDLE;
+    uint32_t subpass        = 0;
+    // Secondaries inherit no state: the callback binds pipelines and
+    // descriptor sets and sets dynamic state (viewport, scissor) itself
+    std::function<void(VkCommandBuffer, CachedPassDependencies&)> record;
+  };
+
+  // A pass whose commands don't change from frame to frame (static shadow
+  // casters, sky, UI chrome), recorded once into a secondary command buffer
+  // and replayed with vkCmdExecuteCommands() instead of re-recording it into
+  // every frame's primary.
+  //
+  // execute() re-records only when a declared dependency changed, the
+  // caller's state key differs from the one the recording was made with
+  // (anything baked into the commands that isn't an object: extent, counts,
+  // toggles), or after invalidate(). Recordings are made with
+  // SIMULTANEOUS_USE so several frames in flight can replay the same one; a
+  // superseded recording is reset and reused once the queue retired its last
+  // replay.
+  //
+  // Inside dynamic rendering a render pass instance holds either secondaries
+  // or inline commands, so cached and per-frame passes need separate
+  // vkCmdBeginRendering() calls. The primary's bound state is undefined after
+  // the replay. Not thread safe; owns its command pool.
+  class CachedCommandBuffer final {
+  public:
+    CachedCommandBuffer(
+        const Context& context,
+        CommandQueueManager& queue,
+        CachedPassDescriptor desc,
+        const std::string& name
+    );
+
+    ~CachedCommandBuffer();
+
+    CachedCommandBuffer(const CachedCommandBuffer&)            = delete;
+    CachedCommandBuffer& operator=(const CachedCommandBuffer&) = delete;
+
+    // Records into primaryCommandBuffer, which has to come from the queue
+    // given at construction
+    void execute(VkCommandBuffer primaryCommandBuffer, uint64_t stateKey = 0);
+
+    // Forces a re-record at the next execute()
+    void invalidate() { valid_ = false; }
+
+    bool isValid(uint64_t stateKey = 0) const;
+
+  private:
+    struct Recording {
+      VkCommandBuffer commandBuffer = VK_NULL_HANDLE;
+      uint64_t lastUse              = 0; // submit value of the last replay
+    };
+
+    void rerecord(uint64_t stateKey);
+
+    VkCommandBuffer acquireCommandBuffer();
+
+  private:
+    const Context* context_     = nullptr;
+    CommandQueueManager* queue_ = nullptr;
+    VkDevice device_            = VK_NULL_HANDLE;
+    VkCommandPool commandPool_  = VK_NULL_HANDLE;
+    CachedPassDescriptor desc_;
+    std::string name_;
+
+    Recording current_;
+    std::vector<Recording> retired_;
+    CachedPassDependencies dependencies_;
+    uint64_t stateKey_ = 0;
+    bool valid_        = false;
+
+    kst::core::Counter* recordCounter_ = nullptr;
+    kst::core::Counter* replayCounter_ = nullptr;
+  };
+
+} // namespace VulkanCore
@@ -0,0 +1,313 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "Common.hpp"
+#include "Utility.hpp"
+
+namespace VulkanCore {
+
+  // Binary layout shared by CommandCapture and CommandReplay. A capture file is
+  // kCaptureMagic, kCaptureVersion, then a sequence of records framed as
+  // { uint16 op, uint32 payload bytes, payload }. Submit records embed the
+  // command buffer streams, which use the same framing.
+  //
+  // Vulkan PODs are stored verbatim, so captures are only portable between
+  // machines with the same ABI.
+  constexpr char kCaptureMagic[8]     = {'K', 'S', 'T', 'C', 'A', 'P', '\0', '\0'};
+  constexpr uint32_t kCaptureVersion  = 1;
+  constexpr uint32_t kCaptureNullId   = 0;
+  constexpr uint32_t kCaptureWholeMip = UINT32_MAX;
+
+  enum class CaptureOp : uint16_t {
+    // Global stream
+    CreateBuffer = 1,
+    CreateTexture,
+    CreateSampler,
+    CreateShaderModule,
+    CreateComputePipeline,
+    CreateGraphicsPipeline,
+    AllocateDescriptors,
+    UpdateDescriptors,
+    Destroy,
+    HostWrite,
+    Submit,
+    FrameEnd,
+
+    // Command buffer streams
+    BindPipeline = 64,
+    BindDescriptorSets,
+    PushConstants,
+    BindVertexBuffers,
+    BindIndexBuffer,
+    Draw,
+    DrawIndexed,
+    DrawIndirect,
+    DrawIndexedIndirect,
+    Dispatch,
+    DispatchIndirect,
+    PipelineBarrier,
+    PipelineBarrier2,
+    CopyBuffer,
+    FillBuffer,
+    CopyBufferToImage,
+    CopyImageToBuffer,
+    BlitImage,
+    BeginRendering,
+    EndRendering,
+    SetViewport,
+    SetScissor,
+  };
+
+  enum class CaptureObject : uint8_t { Buffer, Texture, Sampler, ShaderModule, Pipeline };
+
+  // How an image view referenced by a command relates to its texture
+  enum class CaptureViewKind : uint8_t {
+    Default,  // Texture::vkImageView()
+    MipChain, // Texture::vkImageView(mip): mips [0, mip], the framebuffer views
+    SingleMip // one entry of Texture::generateViewForEachMips()
+  };
+
+  // Fixed-size payload pieces; handles are replaced by capture ids
+
+  struct CaptureImageRef {
+    uint32_t texture = kCaptureNullId;
+    CaptureViewKind kind = CaptureViewKind::Default;
+    uint32_t mip         = kCaptureWholeMip;
+  };
+
+  struct CaptureDescriptorSetRef {
+    uint32_t pipeline;
+    uint32_t set;
+    uint32_t index;
+  };
+
+  struct CaptureDescriptorImage {
+    uint32_t sampler;
+    CaptureImageRef view;
+    VkImageLayout layout;
+  };
+
+  struct CaptureDescriptorBuffer {
+    uint32_t buffer;
+    VkDeviceSize offset;
+    VkDeviceSize range;
+  };
+
+  struct CaptureDescriptorTexel {
+    uint32_t buffer;
+    VkFormat format;
+  };
+
+  struct CaptureVertexBinding {
+    uint32_t buffer;
+    VkDeviceSize offset;
+  };
+
+  struct CaptureMemoryBarrier {
+    VkAccessFlags srcAccessMask;
+    VkAccessFlags dstAccessMask;
+  };
+
+  struct CaptureBufferBarrier {
+    VkAccessFlags srcAccessMask;
+    VkAccessFlags dstAccessMask;
+    uint32_t srcQueueFamilyIndex;
+    uint32_t dstQueueFamilyIndex;
+    uint32_t buffer;
+    VkDeviceSize offset;
+    VkDeviceSize size;
+  };
+
+  struct CaptureImageBarrier {
+    VkAccessFlags srcAccessMask;
+    VkAccessFlags dstAccessMask;
+    VkImageLayout oldLayout;
+    VkImageLayout newLayout;
+    uint32_t srcQueueFamilyIndex;
+    uint32_t dstQueueFamilyIndex;
+    uint32_t texture;
+    VkImageSubresourceRange subresourceRange;
+  };
+
+  struct CaptureMemoryBarrier2 {
+    VkPipelineStageFlags2 srcStageMask;
+    VkAccessFlags2 srcAccessMask;
+    VkPipelineStageFlags2 dstStageMask;
+    VkAccessFlags2 dstAccessMask;
+  };
+
+  struct CaptureBufferBarrier2 {
+    CaptureMemoryBarrier2 masks;
+    uint32_t srcQueueFamilyIndex;
+    uint32_t dstQueueFamilyIndex;
+    uint32_t buffer;
+    VkDeviceSize offset;
+    VkDeviceSize size;
+  };
+
+  struct CaptureImageBarrier2 {
+    CaptureMemoryBarrier2 masks;
+    VkImageLayout oldLayout;
+    VkImageLayout newLayout;
+    uint32_t srcQueueFamilyIndex;
+    uint32_t dstQueueFamilyIndex;
+    uint32_t texture;
+    VkImageSubresourceRange subresourceRange;
+  };
+
+  struct CaptureAttachment {
+    CaptureImageRef view;
+    VkImageLayout imageLayout;
+    VkResolveModeFlagBits resolveMode;
+    CaptureImageRef resolveView;
+    VkImageLayout resolveImageLayout;
+    VkAttachmentLoadOp loadOp;
+    VkAttachmentStoreOp storeOp;
+    VkClearValue clearValue;
+  };
+
+  struct CaptureTextureInfo {
+    VkImageType type;
+    VkFormat format;
+    VkImageCreateFlags flags;
+    VkImageUsageFlags usage;
+    VkExtent3D extents;
+    uint32_t mipLevels;
+    uint32_t layerCount;
+    VkMemoryPropertyFlags memoryFlags;
+    VkSampleCountFlagBits samples;
+    VkImageTiling tiling;
+    uint8_t multiview;
+    uint8_t external; // swapchain image; replayed as an offscreen texture
+  };
+
+  struct CaptureSamplerInfo {
+    VkFilter minFilter;
+    VkFilter magFilter;
+    VkSamplerAddressMode addressModeU;
+    VkSamplerAddressMode addressModeV;
+    VkSamplerAddressMode addressModeW;
+    float maxLod;
+    uint8_t compareEnable;
+    VkCompareOp compareOp;
+  };
+
+  class CaptureWriter {
+  public:
+    template <typename T>
+    void put(const T& value) {
+      static_assert(std::is_trivially_copyable_v<T>);
+      const auto* bytes = reinterpret_cast<const uint8_t*>(&value);
+      data_.insert(data_.end(), bytes, bytes + sizeof(T));
+    }
+
+    template <typename T>
+    void putArray(std::span<const T> values) {
+      put(static_cast<uint32_t>(values.size()));
+      putBytes(values.data(), values.size_bytes());
+    }
+
+    template <typename T>
+    void putArray(const T* values, uint32_t count) {
+      putArray(std::span<const T>(values, count));
+    }
+
+    void putBytes(const void* data, size_t size) {
+      const auto* bytes = static_cast<const uint8_t*>(data);
+      data_.insert(data_.end(), bytes, bytes + size);
+    }
+
+    void putBlob(const void* data, size_t size) {
+      put(static_cast<uint64_t>(size));
+      putBytes(data, size);
+    }
+
+    void putString(const std::string& value) { putBlob(value.data(), value.size()); }
+
+    // Starts a framed record; finish it with end()
+    size_t begin(CaptureOp op) {
+      put(op);
+      const size_t sizeOffset = data_.size();
+      put(uint32_t{0});
+      return sizeOffset;
+    }
+
+    void end(size_t sizeOffset) {
+      const auto size = static_cast<uint32_t>(data_.size() - sizeOffset - sizeof(uint32_t));
+      std::memcpy(data_.data() + sizeOffset, &size, sizeof(size));
+    }
+
+    const std::vector<uint8_t>& data() const { return data_; }
+    std::vector<uint8_t>& data() { return data_; }
+    void clear() { data_.clear(); }
+
+  private:
+    std::vector<uint8_t> data_;
+  };
+
+  class CaptureReader {
+  public:
+    CaptureReader() = default;
+    CaptureReader(const uint8_t* data, size_t size) : data_(data), size_(size) {}
+
+    template <typename T>
+    T get() {
+      static_assert(std::is_trivially_copyable_v<T>);
+      ASSERT(offset_ + sizeof(T) <= size_, "Capture stream is truncated");
+      T value;
+      std::memcpy(&value, data_ + offset_, sizeof(T));
+      offset_ += sizeof(T);
+      return value;
+    }
+
+    template <typename T>
+    std::vector<T> getArray() {
+      const auto count = get<uint32_t>();
+      std::vector<T> values(count);
+      const size_t bytes = sizeof(T) * count;
+      ASSERT(offset_ + bytes <= size_, "Capture stream is truncated");
+      std::memcpy(values.data(), data_ + offset_, bytes);
+      offset_ += bytes;
+      return values;
+    }
+
+    std::span<const uint8_t> getBlob() {
+      const auto size = static_cast<size_t>(get<uint64_t>());
+      ASSERT(offset_ + size <= size_, "Capture stream is truncated");
+      std::span<const uint8_t> blob(data_ + offset_, size);
+      offset_ += size;
+      return blob;
+    }
+
+    std::string getString() {
+      const auto blob = getBlob();
+      return std::string(reinterpret_cast<const char*>(blob.data()), blob.size());
+    }
+
+    // Reads one framed record header and returns a reader over its payload
+    CaptureReader nextRecord(CaptureOp& op) {
+      op              = get<CaptureOp>();
+      const auto size = get<uint32_t>();
+      ASSERT(offset_ + size <= size_, "Capture record is truncated");
+      CaptureReader payload(data_ + offset_, size);
+      offset_ += size;
+      return payload;
+    }
+
+    bool atEnd() const { return offset_ >= size_; }
+    size_t offset() const { return offset_; }
+    void seek(size_t offset) { offset_ = offset; }
+
+  private:
+    const uint8_t* data_ = nullptr;
+    size_t size_         = 0;
+    size_t offset_       = 0;
+  };
+
+} // namespace VulkanCore
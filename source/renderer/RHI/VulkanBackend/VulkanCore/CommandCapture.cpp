@@ -0,0 +1,1214 @@
+#include "CommandCapture.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <iostream>
+
+namespace VulkanCore {
+
+  namespace {
+    constexpr size_t kFlushThreshold = 8u << 20;
+
+    bool isImageDescriptor(VkDescriptorType type) {
+      return type == VK_DESCRIPTOR_TYPE_SAMPLER ||
+             type == VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER ||
+             type == VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE ||
+             type == VK_DESCRIPTOR_TYPE_STORAGE_IMAGE ||
+             type == VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT;
+    }
+
+    bool isTexelDescriptor(VkDescriptorType type) {
+      return type == VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER ||
+             type == VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER;
+    }
+
+    bool isBufferDescriptor(VkDescriptorType type) {
+      return type == VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER ||
+             type == VK_DESCRIPTOR_TYPE_STORAGE_BUFFER ||
+             type == VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC ||
+             type == VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC;
+    }
+  } // namespace
+
+// Entry points intercepted while a capture is alive: name in volk, hook below
+#define KST_CAPTURE_HOOKS(X)                           \
+  X(vkBeginCommandBuffer, beginCommandBuffer)          \
+  X(vkQueueSubmit, queueSubmit)                        \
+  X(vkQueuePresentKHR, queuePresent)                   \
+  X(vkUpdateDescriptorSets, updateDescriptorSets)      \
+  X(vkCmdBindPipeline, cmdBindPipeline)                \
+  X(vkCmdBindDescriptorSets, cmdBindDescriptorSets)    \
+  X(vkCmdPushConstants, cmdPushConstants)              \
+  X(vkCmdBindVertexBuffers, cmdBindVertexBuffers)      \
+  X(vkCmdBindIndexBuffer, cmdBindIndexBuffer)          \
+  X(vkCmdDraw, cmdDraw)                                \
+  X(vkCmdDrawIndexed, cmdDrawIndexed)                  \
+  X(vkCmdDrawIndirect, cmdDrawIndirect)                \
+  X(vkCmdDrawIndexedIndirect, cmdDrawIndexedIndirect)  \
+  X(vkCmdDispatch, cmdDispatch)                        \
+  X(vkCmdDispatchIndirect, cmdDispatchIndirect)        \
+  X(vkCmdPipelineBarrier, cmdPipelineBarrier)          \
+  X(vkCmdPipelineBarrier2, cmdPipelineBarrier2)        \
+  X(vkCmdCopyBuffer, cmdCopyBuffer)                    \
+  X(vkCmdFillBuffer, cmdFillBuffer)                    \
+  X(vkCmdCopyBufferToImage, cmdCopyBufferToImage)      \
+  X(vkCmdCopyImageToBuffer, cmdCopyImageToBuffer)      \
+  X(vkCmdBlitImage, cmdBlitImage)                      \
+  X(vkCmdBeginRendering, cmdBeginRendering)            \
+  X(vkCmdEndRendering, cmdEndRendering)                \
+  X(vkCmdSetViewport, cmdSetViewport)                  \
+  X(vkCmdSetScissor, cmdSetScissor)
+
+  struct CaptureHooks {
+    // Published after the hooks are in place and cleared before they are
+    // removed. Every hook loads it once and only forwards the call when it
+    // is null, e.g. when it raced with install() or uninstall().
+    static inline std::atomic<CommandCapture*> active{nullptr};
+
+#define KST_DECLARE_ORIGINAL(function, hook) static inline PFN_##function hook##Next = nullptr;
+    KST_CAPTURE_HOOKS(KST_DECLARE_ORIGINAL)
+#undef KST_DECLARE_ORIGINAL
+
+    // The volk entry points are process-global and swapped one by one without
+    // synchronization, so both may only run while no other thread calls into
+    // Vulkan (see Context::beginCommandCapture())
+    static void install(CommandCapture* capture) {
+      ASSERT(
+          active.load(std::memory_order_acquire) == nullptr,
+          "Only one CommandCapture can be active at a time"
+      );
+#define KST_INSTALL_HOOK(function, hook) \
+  hook##Next = function;                 \
+  if (function != nullptr) {             \
+    function = &hook;                    \
+  }
+      KST_CAPTURE_HOOKS(KST_INSTALL_HOOK)
+#undef KST_INSTALL_HOOK
+      active.store(capture, std::memory_order_release);
+    }
+
+    static void uninstall() {
+      active.store(nullptr, std::memory_order_release);
+#define KST_RESTORE_HOOK(function, hook) function = hook##Next;
+      KST_CAPTURE_HOOKS(KST_RESTORE_HOOK)
+#undef KST_RESTORE_HOOK
+    }
+
+    // Writes the capture id of handle; false if it was not captured
+    template <typename T>
+    static bool putId(
+        const CommandCapture& capture,
+        CaptureWriter& w,
+        const std::unordered_map<uint64_t, uint32_t>& map,
+        T h
+    ) {
+      const uint32_t id = capture.idLocked(map, CommandCapture::key(h));
+      w.put(id);
+      return id != kCaptureNullId;
+    }
+
+    static bool imageRef(const CommandCapture& capture, VkImageView view, CaptureImageRef& ref) {
+      ref = {};
+      if (view == VK_NULL_HANDLE) {
+        return true;
+      }
+      const auto itr = capture.imageViews_.find(CommandCapture::key(view));
+      if (itr == capture.imageViews_.end()) {
+        return false;
+      }
+      ref = itr->second;
+      return true;
+    }
+
+    static VKAPI_ATTR VkResult VKAPI_CALL
+    beginCommandBuffer(VkCommandBuffer commandBuffer, const VkCommandBufferBeginInfo* info) {
+      if (auto* const capture = active.load(std::memory_order_acquire)) {
+        std::unique_lock lock(capture->mutex_);
+        capture->commandStreams_[commandBuffer].clear();
+      }
+      return beginCommandBufferNext(commandBuffer, info);
+    }
+
+    static VKAPI_ATTR VkResult VKAPI_CALL
+    queueSubmit(VkQueue queue, uint32_t submitCount, const VkSubmitInfo* submits, VkFence fence) {
+      if (auto* const capture = active.load(std::memory_order_acquire)) {
+        capture->recordSubmit(submitCount, submits);
+      }
+      return queueSubmitNext(queue, submitCount, submits, fence);
+    }
+
+    static VKAPI_ATTR VkResult VKAPI_CALL
+    queuePresent(VkQueue queue, const VkPresentInfoKHR* presentInfo) {
+      if (auto* const capture = active.load(std::memory_order_acquire)) {
+        capture->endFrame();
+      }
+      return queuePresentNext(queue, presentInfo);
+    }
+
+    static VKAPI_ATTR void VKAPI_CALL updateDescriptorSets(
+        VkDevice device,
+        uint32_t writeCount,
+        const VkWriteDescriptorSet* writes,
+        uint32_t copyCount,
+        const VkCopyDescriptorSet* copies
+    ) {
+      if (auto* const capture = active.load(std::memory_order_acquire)) {
+        capture->recordDescriptorWrites(writeCount, writes);
+      }
+      updateDescriptorSetsNext(device, writeCount, writes, copyCount, copies);
+    }
+
+    static VKAPI_ATTR void VKAPI_CALL
+    cmdBindPipeline(VkCommandBuffer cb, VkPipelineBindPoint bindPoint, VkPipeline pipeline) {
+      auto* const capture = active.load(std::memory_order_acquire);
+      cmdBindPipelineNext(cb, bindPoint, pipeline);
+      if (capture == nullptr) {
+        return;
+      }
+      capture->recordCommand(cb, CaptureOp::BindPipeline, [&](CaptureWriter& w) {
+        w.put(bindPoint);
+        return putId(*capture, w, capture->pipelines_, pipeline);
+      });
+    }
+
+    static VKAPI_ATTR void VKAPI_CALL cmdBindDescriptorSets(
+        VkCommandBuffer cb,
+        VkPipelineBindPoint bindPoint,
+        VkPipelineLayout layout,
+        uint32_t firstSet,
+        uint32_t setCount,
+        const VkDescriptorSet* sets,
+        uint32_t dynamicOffsetCount,
+        const uint32_t* dynamicOffsets
+    ) {
+      auto* const capture = active.load(std::memory_order_acquire);
+      cmdBindDescriptorSetsNext(
+          cb, bindPoint, layout, firstSet, setCount, sets, dynamicOffsetCount, dynamicOffsets
+      );
+      if (capture == nullptr) {
+        return;
+      }
+      capture->recordCommand(cb, CaptureOp::BindDescriptorSets, [&](CaptureWriter& w) {
+        w.put(bindPoint);
+        if (!putId(*capture, w, capture->pipelineLayouts_, layout)) {
+          return false;
+        }
+        w.put(firstSet);
+        w.put(setCount);
+        for (uint32_t i = 0; i < setCount; ++i) {
+          const auto itr = capture->descriptorSets_.find(CommandCapture::key(sets[i]));
+          if (itr == capture->descriptorSets_.end()) {
+            return false;
+          }
+          w.put(itr->second);
+        }
+        w.putArray(dynamicOffsets, dynamicOffsetCount);
+        return true;
+      });
+    }
+
+    static VKAPI_ATTR void VKAPI_CALL cmdPushConstants(
+        VkCommandBuffer cb,
+        VkPipelineLayout layout,
+        VkShaderStageFlags stages,
+        uint32_t offset,
+        uint32_t size,
+        const void* values
+    ) {
+      auto* const capture = active.load(std::memory_order_acquire);
+      cmdPushConstantsNext(cb, layout, stages, offset, size, values);
+      if (capture == nullptr) {
+        return;
+      }
+      capture->recordCommand(cb, CaptureOp::PushConstants, [&](CaptureWriter& w) {
+        if (!putId(*capture, w, capture->pipelineLayouts_, layout)) {
+          return false;
+        }
+        w.put(stages);
+        w.put(offset);
+        w.putBlob(values, size);
+        return true;
+      });
+    }
+
+    static VKAPI_ATTR void VKAPI_CALL cmdBindVertexBuffers(
+        VkCommandBuffer cb,
+        uint32_t firstBinding,
+        uint32_t bindingCount,
+        const VkBuffer* buffers,
+        const VkDeviceSize* offsets
+    ) {
+      auto* const capture = active.load(std::memory_order_acquire);
+      cmdBindVertexBuffersNext(cb, firstBinding, bindingCount, buffers, offsets);
+      if (capture == nullptr) {
+        return;
+      }
+      capture->recordCommand(cb, CaptureOp::BindVertexBuffers, [&](CaptureWriter& w) {
+        w.put(firstBinding);
+        w.put(bindingCount);
+        for (uint32_t i = 0; i < bindingCount; ++i) {
+          const CaptureVertexBinding binding = {
+              .buffer = capture->idLocked(capture->buffers_, CommandCapture::key(buffers[i])),
+              .offset = offsets[i],
+          };
+          if (binding.buffer == kCaptureNullId) {
+            return false;
+          }
+          w.put(binding);
+        }
+        return true;
+      });
+    }
+
+    static VKAPI_ATTR void VKAPI_CALL
+    cmdBindIndexBuffer(VkCommandBuffer cb, VkBuffer buffer, VkDeviceSize offset, VkIndexType type) {
+      auto* const capture = active.load(std::memory_order_acquire);
+      cmdBindIndexBufferNext(cb, buffer, offset, type);
+      if (capture == nullptr) {
+        return;
+      }
+      capture->recordCommand(cb, CaptureOp::BindIndexBuffer, [&](CaptureWriter& w) {
+        w.put(offset);
+        w.put(type);
+        return putId(*capture, w, capture->buffers_, buffer);
+      });
+    }
+
+    static VKAPI_ATTR void VKAPI_CALL cmdDraw(
+        VkCommandBuffer cb,
+        uint32_t vertexCount,
+        uint32_t instanceCount,
+        uint32_t firstVertex,
+        uint32_t firstInstance
+    ) {
+      auto* const capture = active.load(std::memory_order_acquire);
+      cmdDrawNext(cb, vertexCount, instanceCount, firstVertex, firstInstance);
+      if (capture == nullptr) {
+        return;
+      }
+      capture->recordCommand(cb, CaptureOp::Draw, [&](CaptureWriter& w) {
+        w.put(vertexCount);
+        w.put(instanceCount);
+        w.put(firstVertex);
+        w.put(firstInstance);
+        return true;
+      });
+    }
+
+    static VKAPI_ATTR void VKAPI_CALL cmdDrawIndexed(
+        VkCommandBuffer cb,
+        uint32_t indexCount,
+        uint32_t instanceCount,
+        uint32_t firstIndex,
+        int32_t vertexOffset,
+        uint32_t firstInstance
+    ) {
+      auto* const capture = active.load(std::memory_order_acquire);
+      cmdDrawIndexedNext(cb, indexCount, instanceCount, firstIndex, vertexOffset, firstInstance);
+      if (capture == nullptr) {
+        return;
+      }
+      capture->recordCommand(cb, CaptureOp::DrawIndexed, [&](CaptureWriter& w) {
+        w.put(indexCount);
+        w.put(instanceCount);
+        w.put(firstIndex);
+        w.put(vertexOffset);
+        w.put(firstInstance);
+        return true;
+      });
+    }
+
+    static void recordIndirect(
+        CommandCapture& capture,
+        VkCommandBuffer cb,
+        CaptureOp op,
+        VkBuffer buffer,
+        VkDeviceSize offset,
+        uint32_t drawCount,
+        uint32_t stride
+    ) {
+      capture.recordCommand(cb, op, [&](CaptureWriter& w) {
+        w.put(offset);
+        w.put(drawCount);
+        w.put(stride);
+        return putId(capture, w, capture.buffers_, buffer);
+      });
+    }
+
+    static VKAPI_ATTR void VKAPI_CALL cmdDrawIndirect(
+        VkCommandBuffer cb,
+        VkBuffer buffer,
+        VkDeviceSize offset,
+        uint32_t drawCount,
+        uint32_t stride
+    ) {
+      auto* const capture = active.load(std::memory_order_acquire);
+      cmdDrawIndirectNext(cb, buffer, offset, drawCount, stride);
+      if (capture == nullptr) {
+        return;
+      }
+      recordIndirect(*capture, cb, CaptureOp::DrawIndirect, buffer, offset, drawCount, stride);
+    }
+
+    static VKAPI_ATTR void VKAPI_CALL cmdDrawIndexedIndirect(
+        VkCommandBuffer cb,
+        VkBuffer buffer,
+        VkDeviceSize offset,
+        uint32_t drawCount,
+        uint32_t stride
+    ) {
+      auto* const capture = active.load(std::memory_order_acquire);
+      cmdDrawIndexedIndirectNext(cb, buffer, offset, drawCount, stride);
+      if (capture == nullptr) {
+        return;
+      }
+      recordIndirect(
+          *capture, cb, CaptureOp::DrawIndexedIndirect, buffer, offset, drawCount, stride
+      );
+    }
+
+    static VKAPI_ATTR void VKAPI_CALL
+    cmdDispatch(VkCommandBuffer cb, uint32_t x, uint32_t y, uint32_t z) {
+      auto* const capture = active.load(std::memory_order_acquire);
+      cmdDispatchNext(cb, x, y, z);
+      if (capture == nullptr) {
+        return;
+      }
+      capture->recordCommand(cb, CaptureOp::Dispatch, [&](CaptureWriter& w) {
+        w.put(x);
+        w.put(y);
+        w.put(z);
+        return true;
+      });
+    }
+
+    static VKAPI_ATTR void VKAPI_CALL
+    cmdDispatchIndirect(VkCommandBuffer cb, VkBuffer buffer, VkDeviceSize offset) {
+      auto* const capture = active.load(std::memory_order_acquire);
+      cmdDispatchIndirectNext(cb, buffer, offset);
+      if (capture == nullptr) {
+        return;
+      }
+      recordIndirect(*capture, cb, CaptureOp::DispatchIndirect, buffer, offset, 1, 0);
+    }
+
+    static VKAPI_ATTR void VKAPI_CALL cmdPipelineBarrier(
+        VkCommandBuffer cb,
+        VkPipelineStageFlags srcStageMask,
+        VkPipelineStageFlags dstStageMask,
+        VkDependencyFlags dependencyFlags,
+        uint32_t memoryBarrierCount,
+        const VkMemoryBarrier* memoryBarriers,
+        uint32_t bufferBarrierCount,
+        const VkBufferMemoryBarrier* bufferBarriers,
+        uint32_t imageBarrierCount,
+        const VkImageMemoryBarrier* imageBarriers
+    ) {
+      auto* const capture = active.load(std::memory_order_acquire);
+      cmdPipelineBarrierNext(
+          cb,
+          srcStageMask,
+          dstStageMask,
+          dependencyFlags,
+          memoryBarrierCount,
+          memoryBarriers,
+          bufferBarrierCount,
+          bufferBarriers,
+          imageBarrierCount,
+          imageBarriers
+      );
+      if (capture == nullptr) {
+        return;
+      }
+      capture->recordCommand(cb, CaptureOp::PipelineBarrier, [&](CaptureWriter& w) {
+        w.put(srcStageMask);
+        w.put(dstStageMask);
+        w.put(dependencyFlags);
+
+        w.put(memoryBarrierCount);
+        for (uint32_t i = 0; i < memoryBarrierCount; ++i) {
+          w.put(CaptureMemoryBarrier{
+              .srcAccessMask = memoryBarriers[i].srcAccessMask,
+              .dstAccessMask = memoryBarriers[i].dstAccessMask,
+          });
+        }
+
+        w.put(bufferBarrierCount);
+        for (uint32_t i = 0; i < bufferBarrierCount; ++i) {
+          const auto& barrier = bufferBarriers[i];
+          const CaptureBufferBarrier captured = {
+              .srcAccessMask       = barrier.srcAccessMask,
+              .dstAccessMask       = barrier.dstAccessMask,
+              .srcQueueFamilyIndex = barrier.srcQueueFamilyIndex,
+              .dstQueueFamilyIndex = barrier.dstQueueFamilyIndex,
+              .buffer = capture->idLocked(capture->buffers_, CommandCapture::key(barrier.buffer)),
+              .offset = barrier.offset,
+              .size   = barrier.size,
+          };
+          if (captured.buffer == kCaptureNullId) {
+            return false;
+          }
+          w.put(captured);
+        }
+
+        w.put(imageBarrierCount);
+        for (uint32_t i = 0; i < imageBarrierCount; ++i) {
+          const auto& barrier = imageBarriers[i];
+          const CaptureImageBarrier captured = {
+              .srcAccessMask       = barrier.srcAccessMask,
+              .dstAccessMask       = barrier.dstAccessMask,
+              .oldLayout           = barrier.oldLayout,
+              .newLayout           = barrier.newLayout,
+              .srcQueueFamilyIndex = barrier.srcQueueFamilyIndex,
+              .dstQueueFamilyIndex = barrier.dstQueueFamilyIndex,
+              .texture = capture->idLocked(capture->textures_, CommandCapture::key(barrier.image)),
+              .subresourceRange = barrier.subresourceRange,
+          };
+          if (captured.texture == kCaptureNullId) {
+            return false;
+          }
+          w.put(captured);
+        }
+        return true;
+      });
+    }
+
+    static VKAPI_ATTR void VKAPI_CALL
+    cmdPipelineBarrier2(VkCommandBuffer cb, const VkDependencyInfo* info) {
+      auto* const capture = active.load(std::memory_order_acquire);
+      cmdPipelineBarrier2Next(cb, info);
+      if (capture == nullptr) {
+        return;
+      }
+      capture->recordCommand(cb, CaptureOp::PipelineBarrier2, [&](CaptureWriter& w) {
+        w.put(info->dependencyFlags);
+
+        w.put(info->memoryBarrierCount);
+        for (uint32_t i = 0; i < info->memoryBarrierCount; ++i) {
+          const auto& barrier = info->pMemoryBarriers[i];
+          w.put(CaptureMemoryBarrier2{
+              barrier.srcStageMask,
+              barrier.srcAccessMask,
+              barrier.dstStageMask,
+              barrier.dstAccessMask,
+          });
+        }
+
+        w.put(info->bufferMemoryBarrierCount);
+        for (uint32_t i = 0; i < info->bufferMemoryBarrierCount; ++i) {
+          const auto& barrier = info->pBufferMemoryBarriers[i];
+          const CaptureBufferBarrier2 captured = {
+              .masks =
+                  {barrier.srcStageMask,
+                   barrier.srcAccessMask,
+                   barrier.dstStageMask,
+                   barrier.dstAccessMask},
+              .srcQueueFamilyIndex = barrier.srcQueueFamilyIndex,
+              .dstQueueFamilyIndex = barrier.dstQueueFamilyIndex,
+              .buffer = capture->idLocked(capture->buffers_, CommandCapture::key(barrier.buffer)),
+              .offset = barrier.offset,
+              .size   = barrier.size,
+          };
+          if (captured.buffer == kCaptureNullId) {
+            return false;
+          }
+          w.put(captured);
+        }
+
+        w.put(info->imageMemoryBarrierCount);
+        for (uint32_t i = 0; i < info->imageMemoryBarrierCount; ++i) {
+          const auto& barrier = info->pImageMemoryBarriers[i];
+          const CaptureImageBarrier2 captured = {
+              .masks =
+                  {barrier.srcStageMask,
+                   barrier.srcAccessMask,
+                   barrier.dstStageMask,
+                   barrier.dstAccessMask},
+              .oldLayout           = barrier.oldLayout,
+              .newLayout           = barrier.newLayout,
+              .srcQueueFamilyIndex = barrier.srcQueueFamilyIndex,
+              .dstQueueFamilyIndex = barrier.dstQueueFamilyIndex,
+              .texture = capture->idLocked(capture->textures_, CommandCapture::key(barrier.image)),
+              .subresourceRange = barrier.subresourceRange,
+          };
+          if (captured.texture == kCaptureNullId) {
+            return false;
+          }
+          w.put(captured);
+        }
+        return true;
+      });
+    }
+
+    static VKAPI_ATTR void VKAPI_CALL cmdCopyBuffer(
+        VkCommandBuffer cb,
+        VkBuffer src,
+        VkBuffer dst,
+        uint32_t regionCount,
+        const VkBufferCopy* regions
+    ) {
+      auto* const capture = active.load(std::memory_order_acquire);
+      cmdCopyBufferNext(cb, src, dst, regionCount, regions);
+      if (capture == nullptr) {
+        return;
+      }
+      capture->recordCommand(cb, CaptureOp::CopyBuffer, [&](CaptureWriter& w) {
+        if (!putId(*capture, w, capture->buffers_, src) ||
+            !putId(*capture, w, capture->buffers_, dst)) {
+          return false;
+        }
+        w.putArray(regions, regionCount);
+        return true;
+      });
+    }
+
+    static VKAPI_ATTR void VKAPI_CALL cmdFillBuffer(
+        VkCommandBuffer cb,
+        VkBuffer dst,
+        VkDeviceSize offset,
+        VkDeviceSize size,
+        uint32_t data
+    ) {
+      auto* const capture = active.load(std::memory_order_acquire);
+      cmdFillBufferNext(cb, dst, offset, size, data);
+      if (capture == nullptr) {
+        return;
+      }
+      capture->recordCommand(cb, CaptureOp::FillBuffer, [&](CaptureWriter& w) {
+        w.put(offset);
+        w.put(size);
+        w.put(data);
+        return putId(*capture, w, capture->buffers_, dst);
+      });
+    }
+
+    static VKAPI_ATTR void VKAPI_CALL cmdCopyBufferToImage(
+        VkCommandBuffer cb,
+        VkBuffer src,
+        VkImage dst,
+        VkImageLayout layout,
+        uint32_t regionCount,
+        const VkBufferImageCopy* regions
+    ) {
+      auto* const capture = active.load(std::memory_order_acquire);
+      cmdCopyBufferToImageNext(cb, src, dst, layout, regionCount, regions);
+      if (capture == nullptr) {
+        return;
+      }
+      capture->recordCommand(cb, CaptureOp::CopyBufferToImage, [&](CaptureWriter& w) {
+        if (!putId(*capture, w, capture->buffers_, src) ||
+            !putId(*capture, w, capture->textures_, dst)) {
+          return false;
+        }
+        w.put(layout);
+        w.putArray(regions, regionCount);
+        return true;
+      });
+    }
+
+    static VKAPI_ATTR void VKAPI_CALL cmdCopyImageToBuffer(
+        VkCommandBuffer cb,
+        VkImage src,
+        VkImageLayout layout,
+        VkBuffer dst,
+        uint32_t regionCount,
+        const VkBufferImageCopy* regions
+    ) {
+      auto* const capture = active.load(std::memory_order_acquire);
+      cmdCopyImageToBufferNext(cb, src, layout, dst, regionCount, regions);
+      if (capture == nullptr) {
+        return;
+      }
+      capture->recordCommand(cb, CaptureOp::CopyImageToBuffer, [&](CaptureWriter& w) {
+        if (!putId(*capture, w, capture->textures_, src) ||
+            !putId(*capture, w, capture->buffers_, dst)) {
+          return false;
+        }
+        w.put(layout);
+        w.putArray(regions, regionCount);
+        return true;
+      });
+    }
+
+    static VKAPI_ATTR void VKAPI_CALL cmdBlitImage(
+        VkCommandBuffer cb,
+        VkImage src,
+        VkImageLayout srcLayout,
+        VkImage dst,
+        VkImageLayout dstLayout,
+        uint32_t regionCount,
+        const VkImageBlit* regions,
+        VkFilter filter
+    ) {
+      auto* const capture = active.load(std::memory_order_acquire);
+      cmdBlitImageNext(cb, src, srcLayout, dst, dstLayout, regionCount, regions, filter);
+      if (capture == nullptr) {
+        return;
+      }
+      capture->recordCommand(cb, CaptureOp::BlitImage, [&](CaptureWriter& w) {
+        if (!putId(*capture, w, capture->textures_, src) ||
+            !putId(*capture, w, capture->textures_, dst)) {
+          return false;
+        }
+        w.put(srcLayout);
+        w.put(dstLayout);
+        w.put(filter);
+        w.putArray(regions, regionCount);
+        return true;
+      });
+    }
+
+    static bool putAttachment(
+        const CommandCapture& capture,
+        CaptureWriter& w,
+        const VkRenderingAttachmentInfo* attachment
+    ) {
+      w.put(uint8_t{attachment != nullptr});
+      if (attachment == nullptr) {
+        return true;
+      }
+      CaptureAttachment captured = {
+          .imageLayout        = attachment->imageLayout,
+          .resolveMode        = attachment->resolveMode,
+          .resolveImageLayout = attachment->resolveImageLayout,
+          .loadOp             = attachment->loadOp,
+          .storeOp            = attachment->storeOp,
+          .clearValue         = attachment->clearValue,
+      };
+      if (!imageRef(capture, attachment->imageView, captured.view) ||
+          !imageRef(capture, attachment->resolveImageView, captured.resolveView)) {
+        return false;
+      }
+      w.put(captured);
+      return true;
+    }
+
+    static VKAPI_ATTR void VKAPI_CALL
+    cmdBeginRendering(VkCommandBuffer cb, const VkRenderingInfo* info) {
+      auto* const capture = active.load(std::memory_order_acquire);
+      cmdBeginRenderingNext(cb, info);
+      if (capture == nullptr) {
+        return;
+      }
+      capture->recordCommand(cb, CaptureOp::BeginRendering, [&](CaptureWriter& w) {
+        w.put(info->flags);
+        w.put(info->renderArea);
+        w.put(info->layerCount);
+        w.put(info->viewMask);
+        w.put(info->colorAttachmentCount);
+        for (uint32_t i = 0; i < info->colorAttachmentCount; ++i) {
+          if (!putAttachment(*capture, w, &info->pColorAttachments[i])) {
+            return false;
+          }
+        }
+        return putAttachment(*capture, w, info->pDepthAttachment) &&
+               putAttachment(*capture, w, info->pStencilAttachment);
+      });
+    }
+
+    static VKAPI_ATTR void VKAPI_CALL cmdEndRendering(VkCommandBuffer cb) {
+      auto* const capture = active.load(std::memory_order_acquire);
+      cmdEndRenderingNext(cb);
+      if (capture == nullptr) {
+        return;
+      }
+      capture->recordCommand(cb, CaptureOp::EndRendering, [](CaptureWriter&) { return true; });
+    }
+
+    static VKAPI_ATTR void VKAPI_CALL
+    cmdSetViewport(VkCommandBuffer cb, uint32_t first, uint32_t count, const VkViewport* viewports) {
+      auto* const capture = active.load(std::memory_order_acquire);
+      cmdSetViewportNext(cb, first, count, viewports);
+      if (capture == nullptr) {
+        return;
+      }
+      capture->recordCommand(cb, CaptureOp::SetViewport, [&](CaptureWriter& w) {
+        w.put(first);
+        w.putArray(viewports, count);
+        return true;
+      });
+    }
+
+    static VKAPI_ATTR void VKAPI_CALL
+    cmdSetScissor(VkCommandBuffer cb, uint32_t first, uint32_t count, const VkRect2D* scissors) {
+      auto* const capture = active.load(std::memory_order_acquire);
+      cmdSetScissorNext(cb, first, count, scissors);
+      if (capture == nullptr) {
+        return;
+      }
+      capture->recordCommand(cb, CaptureOp::SetScissor, [&](CaptureWriter& w) {
+        w.put(first);
+        w.putArray(scissors, count);
+        return true;
+      });
+    }
+  };
+
+#undef KST_CAPTURE_HOOKS
+
+  CommandCapture::CommandCapture(const std::string& filePath)
+      : file_(filePath, std::ios::binary | std::ios::trunc), filePath_(filePath) {
+    ASSERT(file_.is_open(), "Failed to open capture file " + filePath);
+    file_.write(kCaptureMagic, sizeof(kCaptureMagic));
+    file_.write(reinterpret_cast<const char*>(&kCaptureVersion), sizeof(kCaptureVersion));
+    CaptureHooks::install(this);
+  }
+
+  CommandCapture::~CommandCapture() {
+    CaptureHooks::uninstall();
+
+    std::unique_lock lock(mutex_);
+    flushLocked(true);
+    file_.close();
+
+    std::cout << "Command capture " << filePath_ << ": " << frames_ << " frames";
+    if (droppedCommands_ > 0) {
+      std::cout << ", " << droppedCommands_
+                << " commands dropped (they referenced objects created before the capture)";
+    }
+    std::cout << std::endl;
+  }
+
+  uint32_t CommandCapture::idLocked(
+      const std::unordered_map<uint64_t, uint32_t>& map,
+      uint64_t handle
+  ) const {
+    const auto itr = map.find(handle);
+    return itr != map.end() ? itr->second : kCaptureNullId;
+  }
+
+  uint32_t CommandCapture::newIdLocked(std::unordered_map<uint64_t, uint32_t>& map, uint64_t handle) {
+    const uint32_t id = nextId_++;
+    map[handle]       = id;
+    return id;
+  }
+
+  template <typename Fn>
+  void CommandCapture::recordCommand(VkCommandBuffer commandBuffer, CaptureOp op, Fn&& write) {
+    std::unique_lock lock(mutex_);
+    const auto itr = commandStreams_.find(commandBuffer);
+    if (itr == commandStreams_.end()) {
+      // Began before the capture started
+      ++droppedCommands_;
+      return;
+    }
+
+    CaptureWriter& w       = itr->second;
+    const size_t rollback  = w.data().size();
+    const size_t sizeField = w.begin(op);
+    if (write(w)) {
+      w.end(sizeField);
+    } else {
+      w.data().resize(rollback);
+      ++droppedCommands_;
+    }
+  }
+
+  void CommandCapture::onBufferCreated(
+      VkBuffer buffer,
+      const VkBufferCreateInfo& createInfo,
+      const VmaAllocationCreateInfo& allocInfo
+  ) {
+    std::unique_lock lock(mutex_);
+    const auto at = stream_.begin(CaptureOp::CreateBuffer);
+    stream_.put(newIdLocked(buffers_, key(buffer)));
+    stream_.put(createInfo.size);
+    stream_.put(createInfo.usage);
+    stream_.put(createInfo.flags);
+    stream_.put(allocInfo.flags);
+    stream_.put(allocInfo.usage);
+    stream_.put(allocInfo.requiredFlags);
+    stream_.put(allocInfo.preferredFlags);
+    stream_.end(at);
+  }
+
+  void CommandCapture::onBufferMapped(VkBuffer buffer, void* memory, VkDeviceSize size) {
+    std::unique_lock lock(mutex_);
+    const uint32_t id = idLocked(buffers_, key(buffer));
+    if (id == kCaptureNullId) {
+      return;
+    }
+    auto& mapped  = mappedBuffers_[id];
+    mapped.memory = static_cast<const uint8_t*>(memory);
+    mapped.shadow.resize(size);
+  }
+
+  void CommandCapture::onBufferViewCreated(VkBufferView view, VkBuffer buffer, VkFormat format) {
+    std::unique_lock lock(mutex_);
+    bufferViews_[key(view)] = {.buffer = idLocked(buffers_, key(buffer)), .format = format};
+  }
+
+  void CommandCapture::onTextureCreated(VkImage image, const CaptureTextureInfo& info) {
+    std::unique_lock lock(mutex_);
+    const auto at = stream_.begin(CaptureOp::CreateTexture);
+    stream_.put(newIdLocked(textures_, key(image)));
+    stream_.put(info);
+    stream_.end(at);
+  }
+
+  void CommandCapture::onImageViewCreated(
+      VkImageView view,
+      VkImage image,
+      CaptureViewKind kind,
+      uint32_t mip
+  ) {
+    std::unique_lock lock(mutex_);
+    imageViews_[key(view)] = {
+        .texture = idLocked(textures_, key(image)),
+        .kind    = kind,
+        .mip     = mip,
+    };
+  }
+
+  void CommandCapture::onSamplerCreated(VkSampler sampler, const CaptureSamplerInfo& info) {
+    std::unique_lock lock(mutex_);
+    const auto at = stream_.begin(CaptureOp::CreateSampler);
+    stream_.put(newIdLocked(samplers_, key(sampler)));
+    stream_.put(info);
+    stream_.end(at);
+  }
+
+  void CommandCapture::onShaderModuleCreated(
+      VkShaderModule module,
+      VkShaderStageFlagBits stage,
+      const std::string& entryPoint,
+      std::span<const char> spirv
+  ) {
+    std::unique_lock lock(mutex_);
+    const auto at = stream_.begin(CaptureOp::CreateShaderModule);
+    stream_.put(newIdLocked(shaderModules_, key(module)));
+    stream_.put(stage);
+    stream_.putString(entryPoint);
+    stream_.putBlob(spirv.data(), spirv.size());
+    stream_.end(at);
+  }
+
+  void CommandCapture::writeSetsLocked(const std::vector<Pipeline::SetDescriptor>& sets) {
+    stream_.put(static_cast<uint32_t>(sets.size()));
+    for (const auto& set : sets) {
+      stream_.put(set.set_);
+      stream_.put(static_cast<uint32_t>(set.bindings_.size()));
+      for (const auto& binding : set.bindings_) {
+        stream_.put(binding.binding);
+        stream_.put(binding.descriptorType);
+        stream_.put(binding.descriptorCount);
+        stream_.put(binding.stageFlags);
+      }
+    }
+  }
+
+  void CommandCapture::writePushConstantsLocked(const std::vector<VkPushConstantRange>& ranges) {
+    stream_.putArray(std::span<const VkPushConstantRange>(ranges));
+  }
+
+  void CommandCapture::writeSpecializationLocked(
+      const std::vector<VkSpecializationMapEntry>& entries,
+      const void* data
+  ) {
+    stream_.putArray(std::span<const VkSpecializationMapEntry>(entries));
+    size_t dataSize = 0;
+    for (const auto& entry : entries) {
+      dataSize = std::max(dataSize, entry.offset + entry.size);
+    }
+    stream_.putBlob(data, data != nullptr ? dataSize : 0);
+  }
+
+  void CommandCapture::onPipelineCreated(
+      VkPipeline pipeline,
+      VkPipelineLayout layout,
+      const Pipeline::ComputePipelineDescriptor& desc
+  ) {
+    const auto shader = desc.computeShader_.lock();
+
+    std::unique_lock lock(mutex_);
+    const uint32_t shaderId = shader ? idLocked(shaderModules_, key(shader->vkShaderModule()))
+                                     : kCaptureNullId;
+    if (shaderId == kCaptureNullId) {
+      ++droppedCommands_;
+      return;
+    }
+
+    const auto at     = stream_.begin(CaptureOp::CreateComputePipeline);
+    const uint32_t id = newIdLocked(pipelines_, key(pipeline));
+    pipelineLayouts_[key(layout)] = id;
+    stream_.put(id);
+    writeSetsLocked(desc.sets_);
+    stream_.put(shaderId);
+    writePushConstantsLocked(desc.pushConstants_);
+    writeSpecializationLocked(desc.specializationConsts_, desc.specializationData_);
+    stream_.end(at);
+  }
+
+  void CommandCapture::onPipelineCreated(
+      VkPipeline pipeline,
+      VkPipelineLayout layout,
+      const Pipeline::GraphicsPipelineDescriptor& desc
+  ) {
+    const auto vertexShader   = desc.vertexShader_.lock();
+    const auto fragmentShader = desc.fragmentShader_.lock();
+
+    std::unique_lock lock(mutex_);
+    const uint32_t vertexId =
+        vertexShader ? idLocked(shaderModules_, key(vertexShader->vkShaderModule()))
+                     : kCaptureNullId;
+    const uint32_t fragmentId =
+        fragmentShader ? idLocked(shaderModules_, key(fragmentShader->vkShaderModule()))
+                       : kCaptureNullId;
+    // Render pass pipelines would need the render pass captured as well
+    if (vertexId == kCaptureNullId || !desc.useDynamicRendering_ ||
+        (fragmentShader && fragmentId == kCaptureNullId)) {
+      ++droppedCommands_;
+      return;
+    }
+
+    const auto at     = stream_.begin(CaptureOp::CreateGraphicsPipeline);
+    const uint32_t id = newIdLocked(pipelines_, key(pipeline));
+    pipelineLayouts_[key(layout)] = id;
+    stream_.put(id);
+    writeSetsLocked(desc.sets_);
+    stream_.put(vertexId);
+    stream_.put(fragmentId);
+    writePushConstantsLocked(desc.pushConstants_);
+    stream_.putArray(std::span<const VkDynamicState>(desc.dynamicStates_));
+    stream_.putArray(std::span<const VkFormat>(desc.colorTextureFormats));
+    stream_.put(desc.depthTextureFormat);
+    stream_.put(desc.stencilTextureFormat);
+    stream_.put(desc.primitiveTopology);
+    stream_.put(desc.sampleCount);
+    stream_.put(desc.cullMode);
+    stream_.put(desc.frontFace);
+    stream_.put(Pipeline::ViewPort(desc.viewport).toVkViewPort());
+    stream_.put(uint8_t{desc.blendEnable});
+    stream_.put(desc.numberBlendAttachments);
+    stream_.put(uint8_t{desc.depthTestEnable});
+    stream_.put(uint8_t{desc.depthWriteEnable});
+    stream_.put(desc.depthCompareOperation);
+    const auto& vertexInput = desc.vertexInputCreateInfo;
+    stream_.putArray(
+        vertexInput.pVertexBindingDescriptions,
+        vertexInput.vertexBindingDescriptionCount
+    );
+    stream_.putArray(
+        vertexInput.pVertexAttributeDescriptions,
+        vertexInput.vertexAttributeDescriptionCount
+    );
+    writeSpecializationLocked(desc.vertexSpecConstants_, desc.vertexSpecializationData);
+    writeSpecializationLocked(desc.fragmentSpecConstants_, desc.fragmentSpecializationData);
+    stream_.putArray(
+        std::span<const VkPipelineColorBlendAttachmentState>(desc.blendAttachmentStates_)
+    );
+    stream_.end(at);
+  }
+
+  void CommandCapture::onDescriptorSetsAllocated(
+      VkPipeline pipeline,
+      uint32_t set,
+      uint32_t firstIndex,
+      std::span<const VkDescriptorSet> descriptorSets
+  ) {
+    std::unique_lock lock(mutex_);
+    const uint32_t pipelineId = idLocked(pipelines_, key(pipeline));
+    if (pipelineId == kCaptureNullId) {
+      return;
+    }
+
+    const auto at = stream_.begin(CaptureOp::AllocateDescriptors);
+    stream_.put(pipelineId);
+    stream_.put(set);
+    stream_.put(firstIndex);
+    stream_.put(static_cast<uint32_t>(descriptorSets.size()));
+    stream_.end(at);
+
+    for (uint32_t i = 0; i < descriptorSets.size(); ++i) {
+      descriptorSets_[key(descriptorSets[i])] = {
+          .pipeline = pipelineId,
+          .set      = set,
+          .index    = firstIndex + i,
+      };
+    }
+  }
+
+  void CommandCapture::onDestroyed(CaptureObject type, uint64_t handle) {
+    std::unique_lock lock(mutex_);
+    std::unordered_map<uint64_t, uint32_t>* map = nullptr;
+    switch (type) {
+      case CaptureObject::Buffer:
+        map = &buffers_;
+        break;
+      case CaptureObject::Texture:
+        map = &textures_;
+        break;
+      case CaptureObject::Sampler:
+        map = &samplers_;
+        break;
+      case CaptureObject::ShaderModule:
+        map = &shaderModules_;
+        break;
+      case CaptureObject::Pipeline:
+        map = &pipelines_;
+        break;
+    }
+
+    const auto itr = map->find(handle);
+    if (itr == map->end()) {
+      return;
+    }
+    const uint32_t id = itr->second;
+    map->erase(itr);
+    if (type == CaptureObject::Buffer) {
+      mappedBuffers_.erase(id);
+    } else if (type == CaptureObject::Pipeline) {
+      std::erase_if(pipelineLayouts_, [id](const auto& entry) { return entry.second == id; });
+      std::erase_if(descriptorSets_, [id](const auto& entry) {
+        return entry.second.pipeline == id;
+      });
+    }
+
+    const auto at = stream_.begin(CaptureOp::Destroy);
+    stream_.put(type);
+    stream_.put(id);
+    stream_.end(at);
+  }
+
+  void CommandCapture::endFrame() {
+    std::unique_lock lock(mutex_);
+    const auto at = stream_.begin(CaptureOp::FrameEnd);
+    stream_.end(at);
+    ++frames_;
+    flushLocked(false);
+  }
+
+  void CommandCapture::snapshotMappedBuffersLocked() {
+    for (auto& [id, mapped] : mappedBuffers_) {
+      const size_t size = mapped.shadow.size();
+      size_t first      = 0;
+      size_t last       = size;
+      if (mapped.captured) {
+        const auto mismatch =
+            std::mismatch(mapped.shadow.begin(), mapped.shadow.end(), mapped.memory);
+        first = static_cast<size_t>(mismatch.first - mapped.shadow.begin());
+        if (first == size) {
+          continue;
+        }
+        while (last > first && mapped.shadow[last - 1] == mapped.memory[last - 1]) {
+          --last;
+        }
+      }
+
+      const auto at = stream_.begin(CaptureOp::HostWrite);
+      stream_.put(id);
+      stream_.put(static_cast<VkDeviceSize>(first));
+      stream_.putBlob(mapped.memory + first, last - first);
+      stream_.end(at);
+
+      std::copy(mapped.memory + first, mapped.memory + last, mapped.shadow.begin() + first);
+      mapped.captured = true;
+    }
+  }
+
+  void CommandCapture::recordSubmit(uint32_t submitCount, const VkSubmitInfo* submits) {
+    std::unique_lock lock(mutex_);
+    snapshotMappedBuffersLocked();
+
+    for (uint32_t s = 0; s < submitCount; ++s) {
+      const auto& submit = submits[s];
+      if (submit.commandBufferCount == 0) {
+        continue;
+      }
+      const auto at = stream_.begin(CaptureOp::Submit);
+      stream_.put(submit.commandBufferCount);
+      for (uint32_t i = 0; i < submit.commandBufferCount; ++i) {
+        const auto itr = commandStreams_.find(submit.pCommandBuffers[i]);
+        if (itr == commandStreams_.end()) {
+          stream_.putBlob(nullptr, 0);
+          continue;
+        }
+        stream_.putBlob(itr->second.data().data(), itr->second.data().size());
+      }
+      stream_.end(at);
+    }
+  }
+
+  void CommandCapture::recordDescriptorWrites(
+      uint32_t writeCount,
+      const VkWriteDescriptorSet* writes
+  ) {
+    std::unique_lock lock(mutex_);
+    CaptureWriter captured;
+    uint32_t capturedCount = 0;
+
+    for (uint32_t i = 0; i < writeCount; ++i) {
+      const auto& write = writes[i];
+      const auto set    = descriptorSets_.find(key(write.dstSet));
+      if (set == descriptorSets_.end()) {
+        ++droppedCommands_;
+        continue;
+      }
+
+      const size_t rollback = captured.data().size();
+      captured.put(set->second);
+      captured.put(write.dstBinding);
+      captured.put(write.dstArrayElement);
+      captured.put(write.descriptorType);
+      captured.put(write.descriptorCount);
+
+      bool valid = true;
+      for (uint32_t d = 0; d < write.descriptorCount && valid; ++d) {
+        if (isImageDescriptor(write.descriptorType)) {
+          const auto& info = write.pImageInfo[d];
+          CaptureDescriptorImage image = {
+              .sampler = info.sampler != VK_NULL_HANDLE ? idLocked(samplers_, key(info.sampler))
+                                                        : kCaptureNullId,
+              .layout  = info.imageLayout,
+          };
+          valid = (info.sampler == VK_NULL_HANDLE || image.sampler != kCaptureNullId) &&
+                  CaptureHooks::imageRef(*this, info.imageView, image.view);
+          captured.put(image);
+        } else if (isBufferDescriptor(write.descriptorType)) {
+          const auto& info = write.pBufferInfo[d];
+          const CaptureDescriptorBuffer buffer = {
+              .buffer = idLocked(buffers_, key(info.buffer)),
+              .offset = info.offset,
+              .range  = info.range,
+          };
+          valid = buffer.buffer != kCaptureNullId;
+          captured.put(buffer);
+        } else if (isTexelDescriptor(write.descriptorType)) {
+          const auto view = bufferViews_.find(key(write.pTexelBufferView[d]));
+          valid           = view != bufferViews_.end() && view->second.buffer != kCaptureNullId;
+          if (valid) {
+            captured.put(view->second);
+          }
+        } else {
+          // Acceleration structures and inline uniform blocks are not captured
+          valid = false;
+        }
+      }
+
+      if (valid) {
+        ++capturedCount;
+      } else {
+        captured.data().resize(rollback);
+        ++droppedCommands_;
+      }
+    }
+
+    if (capturedCount == 0) {
+      return;
+    }
+    const auto at = stream_.begin(CaptureOp::UpdateDescriptors);
+    stream_.put(capturedCount);
+    stream_.putBytes(captured.data().data(), captured.data().size());
+    stream_.end(at);
+  }
+
+  void CommandCapture::flushLocked(bool force) {
+    if (!force && stream_.data().size() < kFlushThreshold) {
+      return;
+    }
+    file_.write(reinterpret_cast<const char*>(stream_.data().data()), stream_.data().size());
+    file_.flush();
+    stream_.clear();
+  }
+
+} // namespace VulkanCore
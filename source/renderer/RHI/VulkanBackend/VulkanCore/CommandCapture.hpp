@@ -0,0 +1,139 @@
+#pragma once
+
+#include <cstdint>
+#include <fstream>
+#include <mutex>
+#include <span>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "CaptureStream.hpp"
+#include "Common.hpp"
+#include "Pipeline.hpp"
+#include "Utility.hpp"
+#include "vk_mem_alloc.h"
+
+namespace VulkanCore {
+
+  // Records RHI activity into a binary stream that CommandReplay can play back
+  // without the application. Object creation is reported by the RHI classes;
+  // command recording, descriptor writes, submits and presents are intercepted
+  // by swapping the volk entry points while the capture is alive, so raw vkCmd*
+  // calls made by renderer features are captured too.
+  //
+  // Handles are translated to capture ids. Anything referencing an object that
+  // was created before the capture started is dropped and counted, so start
+  // capturing right after the Context is created. Host writes through
+  // Buffer::map() are picked up by diffing mapped buffers at every submit.
+  class CommandCapture final {
+  public:
+    explicit CommandCapture(const std::string& filePath);
+    ~CommandCapture();
+
+    CommandCapture(const CommandCapture&)            = delete;
+    CommandCapture& operator=(const CommandCapture&) = delete;
+
+    void onBufferCreated(
+        VkBuffer buffer,
+        const VkBufferCreateInfo& createInfo,
+        const VmaAllocationCreateInfo& allocInfo
+    );
+    void onBufferMapped(VkBuffer buffer, void* memory, VkDeviceSize size);
+    void onBufferViewCreated(VkBufferView view, VkBuffer buffer, VkFormat format);
+
+    void onTextureCreated(VkImage image, const CaptureTextureInfo& info);
+    void onImageViewCreated(VkImageView view, VkImage image, CaptureViewKind kind, uint32_t mip);
+
+    void onSamplerCreated(VkSampler sampler, const CaptureSamplerInfo& info);
+
+    void onShaderModuleCreated(
+        VkShaderModule module,
+        VkShaderStageFlagBits stage,
+        const std::string& entryPoint,
+        std::span<const char> spirv
+    );
+
+    void onPipelineCreated(
+        VkPipeline pipeline,
+        VkPipelineLayout layout,
+        const Pipeline::ComputePipelineDescriptor& desc
+    );
+    void onPipelineCreated(
+        VkPipeline pipeline,
+        VkPipelineLayout layout,
+        const Pipeline::GraphicsPipelineDescriptor& desc
+    );
+    void onDescriptorSetsAllocated(
+        VkPipeline pipeline,
+        uint32_t set,
+        uint32_t firstIndex,
+        std::span<const VkDescriptorSet> descriptorSets
+    );
+
+    void onDestroyed(CaptureObject type, uint64_t handle);
+
+    // Marks a frame boundary; presents do this automatically
+    void endFrame();
+
+    uint64_t frameCount() const { return frames_; }
+
+  private:
+    friend struct CaptureHooks;
+
+    // Host-visible buffer mapped through Buffer::map(); shadow holds the
+    // contents as of the last submit so only changed bytes are recorded
+    struct MappedBuffer {
+      const uint8_t* memory;
+      std::vector<uint8_t> shadow;
+      bool captured = false;
+    };
+
+    template <typename T>
+    static uint64_t key(T handle) {
+      return (uint64_t)handle;
+    }
+
+    // The *Locked helpers expect mutex_ to be held
+    uint32_t idLocked(const std::unordered_map<uint64_t, uint32_t>& map, uint64_t handle) const;
+    uint32_t newIdLocked(std::unordered_map<uint64_t, uint32_t>& map, uint64_t handle);
+    void writeSetsLocked(const std::vector<Pipeline::SetDescriptor>& sets);
+    void writePushConstantsLocked(const std::vector<VkPushConstantRange>& ranges);
+    void writeSpecializationLocked(
+        const std::vector<VkSpecializationMapEntry>& entries,
+        const void* data
+    );
+    void snapshotMappedBuffersLocked();
+    void flushLocked(bool force);
+
+    // Appends one command to commandBuffer's stream; write returns false when
+    // it met an unknown handle, in which case the command is dropped
+    template <typename Fn>
+    void recordCommand(VkCommandBuffer commandBuffer, CaptureOp op, Fn&& write);
+
+    void recordSubmit(uint32_t submitCount, const VkSubmitInfo* submits);
+    void recordDescriptorWrites(uint32_t writeCount, const VkWriteDescriptorSet* writes);
+
+    std::ofstream file_;
+    std::string filePath_;
+    mutable std::mutex mutex_;
+    CaptureWriter stream_;
+    std::unordered_map<VkCommandBuffer, CaptureWriter> commandStreams_;
+
+    uint32_t nextId_ = 1;
+    std::unordered_map<uint64_t, uint32_t> buffers_;
+    std::unordered_map<uint64_t, uint32_t> textures_;
+    std::unordered_map<uint64_t, uint32_t> samplers_;
+    std::unordered_map<uint64_t, uint32_t> shaderModules_;
+    std::unordered_map<uint64_t, uint32_t> pipelines_;
+    std::unordered_map<uint64_t, uint32_t> pipelineLayouts_;
+    std::unordered_map<uint64_t, CaptureImageRef> imageViews_;
+    std::unordered_map<uint64_t, CaptureDescriptorTexel> bufferViews_;
+    std::unordered_map<uint64_t, CaptureDescriptorSetRef> descriptorSets_;
+    std::unordered_map<uint32_t, MappedBuffer> mappedBuffers_;
+
+    uint64_t frames_          = 0;
+    uint64_t droppedCommands_ = 0;
+  };
+
+} // namespace VulkanCore
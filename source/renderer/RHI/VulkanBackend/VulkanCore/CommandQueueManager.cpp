@@ -1,10 +1,14 @@
 #include "CommandQueueManager.hpp"
 
 #include <algorithm>
+#include <chrono>
 #include <iostream>
+#include <utility>
 #include <tracy/Tracy.hpp>
 
 #include "Context.hpp"
+#include "SubmissionThread.hpp"
+#include "core/Metrics.hpp"
 
 namespace VulkanCore {
 
@@ -15,13 +19,26 @@ CommandQueueManager::CommandQueueManager(const Context& context, VkDevice device
                                          const std::string& name)
     : commandsInFlight_(concurrentNumCommands),
       queueFamilyIndex_(queueFamilyIndex),
+      context_(&context),
       queue_(queue),
-      device_(device) {
+      queueMutex_(&context.queueMutex(queue)),
+      device_(device),
+      deletionQueue_(&context.deletionQueue()),
+      timeline_(context.deletionQueue().registerQueue()) {
   fences_.reserve(commandsInFlight_);
   isSubmitted_.reserve(commandsInFlight_);
+  fenceSubmitValues_.resize(commandsInFlight_, 0);
   bufferToDispose_.resize(commandsInFlight_);
   deallocators_.resize(commandsInFlight_);
 
+  auto& metrics = kst::core::MetricsRegistry::instance();
+  const std::string queueLabel = "queue=\"" + (name.empty() ? "unnamed" : name) + "\"";
+  submitCounter_ = &metrics.counter("kst_queue_submits_total",
+                                    "Command buffers submitted to the queue", queueLabel);
+  fenceWaitHistogram_ =
+      &metrics.histogram("kst_queue_fence_wait_seconds",
+                         "CPU time spent blocked on submit fences", queueLabel, 1e-9);
+
   const VkCommandPoolCreateInfo commandPoolInfo = {
       .sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
       .flags = flags,
@@ -46,38 +63,133 @@ CommandQueueManager::CommandQueueManager(const Context& context, VkDevice device
     commandBuffers_.push_back(cmdBuffer);
   }
 
+  // Pooled fences start unsignaled; isSubmitted_ guards every wait on them
   for (size_t i = 0; i < commandsInFlight_; ++i) {
-    VkFence fence;
-    const VkFenceCreateInfo fenceInfo = {
-        .sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO,
-        .flags = VK_FENCE_CREATE_SIGNALED_BIT,
-    };
-    VK_CHECK(vkCreateFence(device, &fenceInfo, nullptr, &fence));
-
-    fences_.push_back(std::move(fence));
+    fences_.push_back(context.fencePool().acquire("Fence: " + name + " " + std::to_string(i)));
     isSubmitted_.push_back(false);
   }
 }
 
-CommandQueueManager::~CommandQueueManager() {
+CommandQueueManager::~CommandQueueManager() { destroy(); }
+
+CommandQueueManager::CommandQueueManager(CommandQueueManager&& other) noexcept
+    : commandsInFlight_(other.commandsInFlight_),
+      queueFamilyIndex_(other.queueFamilyIndex_),
+      context_(std::exchange(other.context_, nullptr)),
+      queue_(std::exchange(other.queue_, VK_NULL_HANDLE)),
+      queueMutex_(std::exchange(other.queueMutex_, nullptr)),
+      device_(std::exchange(other.device_, VK_NULL_HANDLE)),
+      commandPool_(std::exchange(other.commandPool_, VK_NULL_HANDLE)),
+      commandBuffers_(std::exchange(other.commandBuffers_, {})),
+      fences_(std::exchange(other.fences_, {})),
+      isSubmitted_(std::exchange(other.isSubmitted_, {})),
+      fenceSubmitValues_(std::exchange(other.fenceSubmitValues_, {})),
+      submitValue_(other.submitValue_),
+      completedSubmitValue_(other.completedSubmitValue_),
+      deletionQueue_(std::exchange(other.deletionQueue_, nullptr)),
+      timeline_(std::move(other.timeline_)),
+      fenceCurrentIndex_(other.fenceCurrentIndex_),
+      commandBufferCurrentIndex_(other.commandBufferCurrentIndex_),
+      bufferToDispose_(std::exchange(other.bufferToDispose_, {})),
+      deallocators_(std::exchange(other.deallocators_, {})),
+      submitCounter_(other.submitCounter_),
+      fenceWaitHistogram_(other.fenceWaitHistogram_) {}
+
+CommandQueueManager& CommandQueueManager::operator=(CommandQueueManager&& other) noexcept {
+  if (this != &other) {
+    destroy();
+    commandsInFlight_ = other.commandsInFlight_;
+    queueFamilyIndex_ = other.queueFamilyIndex_;
+    context_ = std::exchange(other.context_, nullptr);
+    queue_ = std::exchange(other.queue_, VK_NULL_HANDLE);
+    queueMutex_ = std::exchange(other.queueMutex_, nullptr);
+    device_ = std::exchange(other.device_, VK_NULL_HANDLE);
+    commandPool_ = std::exchange(other.commandPool_, VK_NULL_HANDLE);
+    commandBuffers_ = std::exchange(other.commandBuffers_, {});
+    fences_ = std::exchange(other.fences_, {});
+    isSubmitted_ = std::exchange(other.isSubmitted_, {});
+    fenceSubmitValues_ = std::exchange(other.fenceSubmitValues_, {});
+    submitValue_ = other.submitValue_;
+    completedSubmitValue_ = other.completedSubmitValue_;
+    deletionQueue_ = std::exchange(other.deletionQueue_, nullptr);
+    timeline_ = std::move(other.timeline_);
+    fenceCurrentIndex_ = other.fenceCurrentIndex_;
+    commandBufferCurrentIndex_ = other.commandBufferCurrentIndex_;
+    bufferToDispose_ = std::exchange(other.bufferToDispose_, {});
+    deallocators_ = std::exchange(other.deallocators_, {});
+    submitCounter_ = other.submitCounter_;
+    fenceWaitHistogram_ = other.fenceWaitHistogram_;
+  }
+  return *this;
+}
+
+void CommandQueueManager::destroy() {
+  // Moved from: the pool and fences belong to another manager now
+  if (commandPool_ == VK_NULL_HANDLE) {
+    return;
+  }
+
+  // Handed-off submits still reference the fences and command buffers
+  if (auto* submissionThread = context_->submissionThread()) {
+    submissionThread->waitIdle();
+  }
+
   deallocateResources();
+  deallocators_.clear();
 
-  for (size_t i = 0; i < commandsInFlight_; ++i) {
-    vkDestroyFence(device_, fences_[i], nullptr);
+  for (size_t i = 0; i < fences_.size(); ++i) {
+    if (isSubmitted_[i]) {
+      waitForFence(fences_[i]);
+    }
+    context_->fencePool().release(fences_[i]);
   }
+  fences_.clear();
+  isSubmitted_.clear();
 
   for (size_t i = 0; i < commandBuffers_.size(); ++i) {
     vkFreeCommandBuffers(device_, commandPool_, 1, &commandBuffers_[i]);
   }
+  commandBuffers_.clear();
+  bufferToDispose_.clear();
 
   vkDestroyCommandPool(device_, commandPool_, nullptr);
+  commandPool_ = VK_NULL_HANDLE;
+  timeline_.reset();
 }
 
 void CommandQueueManager::submit(const VkSubmitInfo* submitInfo) {
   ZoneScopedN("CmdMgr: submit");
   VK_CHECK(vkResetFences(device_, 1, &fences_[fenceCurrentIndex_]));
-  VK_CHECK(vkQueueSubmit(queue_, 1, submitInfo, fences_[fenceCurrentIndex_]));
+  auto* submissionThread = context_->submissionThread();
+  if (submissionThread && submitInfo->pNext == nullptr) {
+    submissionThread->submit(queue_, *submitInfo, fences_[fenceCurrentIndex_]);
+  } else {
+    // pNext chains can't be copied generically; drain the thread first so the
+    // queue still sees submits in order
+    if (submissionThread) {
+      submissionThread->waitIdle();
+    }
+    std::scoped_lock lock(*queueMutex_);
+    VK_CHECK(vkQueueSubmit(queue_, 1, submitInfo, fences_[fenceCurrentIndex_]));
+  }
   isSubmitted_[fenceCurrentIndex_] = true;
+  fenceSubmitValues_[fenceCurrentIndex_] = ++submitValue_;
+  timeline_->submitted.store(submitValue_, std::memory_order_release);
+  timeline_->recording.store(false, std::memory_order_release);
+  submitCounter_->add();
+}
+
+uint64_t CommandQueueManager::completedSubmitValue() {
+  // Everything older than the oldest unsignaled submit has retired.
+  uint64_t oldestPending = submitValue_ + 1;
+  for (size_t i = 0; i < fences_.size(); ++i) {
+    if (isSubmitted_[i] && vkGetFenceStatus(device_, fences_[i]) == VK_NOT_READY) {
+      oldestPending = std::min(oldestPending, fenceSubmitValues_[i]);
+    }
+  }
+  completedSubmitValue_ = std::max(completedSubmitValue_, oldestPending - 1);
+  timeline_->completed.store(completedSubmitValue_, std::memory_order_release);
+  return completedSubmitValue_;
 }
 
 void CommandQueueManager::goToNextCmdBuffer() {
@@ -93,8 +205,10 @@ void CommandQueueManager::waitUntilSubmitIsComplete() {
     return;
   }
 
+  const auto waitStart = std::chrono::steady_clock::now();
   const auto result =
       vkWaitForFences(device_, 1, &fences_[fenceCurrentIndex_], true, UINT32_MAX);
+  fenceWaitHistogram_->recordDuration(std::chrono::steady_clock::now() - waitStart);
   if (result == VK_TIMEOUT) {
     std::cerr << "Timeout!" << std::endl;
     vkDeviceWaitIdle(device_);
@@ -108,10 +222,13 @@ void CommandQueueManager::waitUntilSubmitIsComplete() {
 void CommandQueueManager::waitUntilAllSubmitsAreComplete() {
   ZoneScopedN("CmdMgr: waitUntilAllSubmitIscomplete");
   for (size_t index = 0; auto& fence : fences_) {
-    VK_CHECK(vkWaitForFences(device_, 1, &fence, true, UINT32_MAX));
-    VK_CHECK(vkResetFences(device_, 1, &fence));
+    if (isSubmitted_[index]) {
+      waitForFence(fence);
+    }
     isSubmitted_[index++] = false;
   }
+  completedSubmitValue_ = submitValue_;
+  timeline_->completed.store(completedSubmitValue_, std::memory_order_release);
   bufferToDispose_.clear();
   deallocateResources();
 }
@@ -129,7 +246,13 @@ void CommandQueueManager::disposeWhenSubmitCompletes(
 
 VkCommandBuffer CommandQueueManager::getCmdBufferToBegin() {
   ZoneScopedN("CmdMgr: getCmdBufferToBegin");
-  VK_CHECK(vkWaitForFences(device_, 1, &fences_[fenceCurrentIndex_], true, UINT32_MAX));
+  if (isSubmitted_[fenceCurrentIndex_]) {
+    waitForFence(fences_[fenceCurrentIndex_]);
+  }
+  completedSubmitValue();
+  deletionQueue_->collect();
+  timeline_->recording.store(true, std::memory_order_release);
+
   VK_CHECK(vkResetCommandBuffer(commandBuffers_[commandBufferCurrentIndex_],
                                 VK_COMMAND_BUFFER_RESET_RELEASE_RESOURCES_BIT));
 
@@ -161,6 +284,12 @@ void CommandQueueManager::endCmdBuffer(VkCommandBuffer cmdBuffer) {
   VK_CHECK(vkEndCommandBuffer(cmdBuffer));
 }
 
+void CommandQueueManager::waitForFence(VkFence fence) {
+  const auto waitStart = std::chrono::steady_clock::now();
+  VK_CHECK(vkWaitForFences(device_, 1, &fence, true, UINT32_MAX));
+  fenceWaitHistogram_->recordDuration(std::chrono::steady_clock::now() - waitStart);
+}
+
 void CommandQueueManager::deallocateResources() {
   for (auto& deallocators : deallocators_) {
     for (auto& deallocator : deallocators) {
@@ -1,13 +1,20 @@
 #pragma once
 
 #include <functional>
+#include <mutex>
 #include <string>
 #include <vector>
 
 #include "Buffer.hpp"
 #include "Common.hpp"
+#include "DeletionQueue.hpp"
 #include "Utility.hpp"
 
+namespace kst::core {
+class Counter;
+class Histogram;
+}  // namespace kst::core
+
 namespace VulkanCore {
 
 class Context;
@@ -31,6 +38,13 @@ class CommandQueueManager final {
 
   ~CommandQueueManager();
 
+  // The command pool and pooled fences have a single owner; a moved-from
+  // manager holds neither and its destructor does nothing
+  CommandQueueManager(const CommandQueueManager&) = delete;
+  CommandQueueManager& operator=(const CommandQueueManager&) = delete;
+  CommandQueueManager(CommandQueueManager&& other) noexcept;
+  CommandQueueManager& operator=(CommandQueueManager&& other) noexcept;
+
   void submit(const VkSubmitInfo* submitInfo);
 
   void goToNextCmdBuffer();
@@ -49,24 +63,47 @@ class CommandQueueManager final {
 
   uint32_t queueFamilyIndex() const { return queueFamilyIndex_; }
 
+  // Submits are numbered 1, 2, 3, ... Work recorded into the current command
+  // buffer has retired once completedSubmitValue() >= nextSubmitValue().
+  uint64_t nextSubmitValue() const { return submitValue_ + 1; }
+
+  // Polls the in-flight fences without blocking
+  uint64_t completedSubmitValue();
+
  private:
   void deallocateResources();
 
+  // Waits for outstanding submits, then frees the pool and returns the fences
+  void destroy();
+
+  // Blocks on a fence and records the wait in the fence wait histogram
+  void waitForFence(VkFence fence);
+
  private:
   uint32_t commandsInFlight_ = 2;
   uint32_t queueFamilyIndex_ = 0;
+  const Context* context_ = nullptr;
   VkQueue queue_ = VK_NULL_HANDLE;
+  // Shared by every manager that submits to queue_
+  std::mutex* queueMutex_ = nullptr;
   VkDevice device_ = VK_NULL_HANDLE;
   VkCommandPool commandPool_ = VK_NULL_HANDLE;
   std::vector<VkCommandBuffer> commandBuffers_;
   std::vector<VkFence> fences_;
   std::vector<bool> isSubmitted_;
+  std::vector<uint64_t> fenceSubmitValues_;
+  uint64_t submitValue_ = 0;
+  uint64_t completedSubmitValue_ = 0;
+  DeletionQueue* deletionQueue_ = nullptr;
+  std::shared_ptr<QueueTimeline> timeline_;
   uint32_t fenceCurrentIndex_ = 0;
   uint32_t commandBufferCurrentIndex_ = 0;
   std::vector<std::vector<std::shared_ptr<Buffer>>>
       bufferToDispose_;  // fenceIndex to list of buffers associated with that
                          // fence that needs to be released
   std::vector<std::vector<std::function<void()>>> deallocators_;
+  kst::core::Counter* submitCounter_ = nullptr;
+  kst::core::Histogram* fenceWaitHistogram_ = nullptr;
 };
 
 }  // namespace VulkanCore
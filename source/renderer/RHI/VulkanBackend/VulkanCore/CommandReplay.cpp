@@ -0,0 +1,936 @@
+#include "CommandReplay.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+#include "Buffer.hpp"
+#include "Context.hpp"
+#include "Pipeline.hpp"
+#include "Sampler.hpp"
+#include "ShaderModule.hpp"
+#include "Texture.hpp"
+
+namespace VulkanCore {
+
+  namespace {
+    constexpr uint32_t kReplayCommandBuffers = 3;
+
+    using Clock = std::chrono::steady_clock;
+
+    double elapsedMs(Clock::time_point start) {
+      return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    }
+
+    // The replay device has no swapchain
+    VkImageLayout replayLayout(VkImageLayout layout) {
+      return layout == VK_IMAGE_LAYOUT_PRESENT_SRC_KHR ? VK_IMAGE_LAYOUT_GENERAL : layout;
+    }
+
+    std::vector<Pipeline::SetDescriptor> readSets(CaptureReader& payload) {
+      std::vector<Pipeline::SetDescriptor> sets(payload.get<uint32_t>());
+      for (auto& set : sets) {
+        set.set_ = payload.get<uint32_t>();
+        set.bindings_.resize(payload.get<uint32_t>());
+        for (auto& binding : set.bindings_) {
+          binding.binding         = payload.get<uint32_t>();
+          binding.descriptorType  = payload.get<VkDescriptorType>();
+          binding.descriptorCount = payload.get<uint32_t>();
+          binding.stageFlags      = payload.get<VkShaderStageFlags>();
+        }
+      }
+      return sets;
+    }
+
+    void readSpecialization(
+        CaptureReader& payload,
+        std::vector<VkSpecializationMapEntry>& entries,
+        std::vector<uint8_t>& data
+    ) {
+      entries         = payload.getArray<VkSpecializationMapEntry>();
+      const auto blob = payload.getBlob();
+      data.assign(blob.begin(), blob.end());
+    }
+  } // namespace
+
+  CommandReplay::CommandReplay(Context& context, const std::string& filePath)
+      : context_(context),
+        queue_(context_.createGraphicsCommandQueue(
+            kReplayCommandBuffers,
+            kReplayCommandBuffers,
+            "Command replay"
+        )) {
+    std::ifstream file(filePath, std::ios::binary);
+    ASSERT(file.is_open(), "Failed to open capture file " + filePath);
+    data_.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+
+    constexpr size_t headerSize = sizeof(kCaptureMagic) + sizeof(kCaptureVersion);
+    ASSERT(
+        data_.size() >= headerSize && std::memcmp(data_.data(), kCaptureMagic, 8) == 0,
+        filePath + " is not a konstrukt capture"
+    );
+    uint32_t version = 0;
+    std::memcpy(&version, data_.data() + sizeof(kCaptureMagic), sizeof(version));
+    ASSERT(version == kCaptureVersion, "Unsupported capture version " + std::to_string(version));
+
+    // Split into frames and size the timestamp pool for the busiest one
+    CaptureReader reader(data_.data(), data_.size());
+    reader.seek(headerSize);
+    size_t frameBegin     = headerSize;
+    uint32_t frameSubmits = 0;
+    while (!reader.atEnd()) {
+      CaptureOp op;
+      auto payload = reader.nextRecord(op);
+      if (op == CaptureOp::Submit) {
+        frameSubmits += payload.get<uint32_t>();
+      } else if (op == CaptureOp::FrameEnd) {
+        frames_.push_back({frameBegin, reader.offset()});
+        maxSubmits_  = std::max(maxSubmits_, frameSubmits);
+        frameBegin   = reader.offset();
+        frameSubmits = 0;
+      }
+    }
+    // Captures that were not closed by a present or endFrame()
+    if (frameBegin < data_.size()) {
+      frames_.push_back({frameBegin, data_.size()});
+      maxSubmits_ = std::max(maxSubmits_, frameSubmits);
+    }
+
+    const VkQueryPoolCreateInfo queryPoolInfo = {
+        .sType      = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO,
+        .queryType  = VK_QUERY_TYPE_TIMESTAMP,
+        .queryCount = 2 * maxSubmits_,
+    };
+    VK_CHECK(vkCreateQueryPool(context_.device(), &queryPoolInfo, nullptr, &queryPool_));
+    context_.setVkObjectname(queryPool_, VK_OBJECT_TYPE_QUERY_POOL, "Command replay timestamps");
+
+    timestampPeriod_ = context_.physicalDevice().properties().properties.limits.timestampPeriod;
+  }
+
+  CommandReplay::~CommandReplay() {
+    drain();
+    vkDestroyQueryPool(context_.device(), queryPool_, nullptr);
+
+    for (const auto& [id, views] : mipViews_) {
+      for (const auto& view : views) {
+        vkDestroyImageView(context_.device(), *view, nullptr);
+      }
+    }
+  }
+
+  ReplayFrameTiming CommandReplay::replayFrame(size_t frame) {
+    ASSERT(frame < frames_.size(), "Frame index out of range");
+
+    ReplayFrameTiming timing;
+    CaptureReader reader(data_.data(), frames_[frame].end);
+    reader.seek(frames_[frame].begin);
+    while (!reader.atEnd()) {
+      CaptureOp op;
+      auto payload = reader.nextRecord(op);
+      execute(op, payload, timing);
+    }
+
+    drain();
+    if (timing.submits == 0) {
+      return timing;
+    }
+
+    std::vector<uint64_t> timestamps(2 * timing.submits);
+    VK_CHECK(vkGetQueryPoolResults(
+        context_.device(),
+        queryPool_,
+        0,
+        2 * timing.submits,
+        timestamps.size() * sizeof(uint64_t),
+        timestamps.data(),
+        sizeof(uint64_t),
+        VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WAIT_BIT
+    ));
+    for (uint32_t i = 0; i < timing.submits; ++i) {
+      timing.gpuMs += double(timestamps[2 * i + 1] - timestamps[2 * i]) * timestampPeriod_ * 1e-6;
+    }
+    return timing;
+  }
+
+  void CommandReplay::execute(CaptureOp op, CaptureReader& payload, ReplayFrameTiming& timing) {
+    if (op == CaptureOp::Submit) {
+      submit(payload, timing);
+      return;
+    }
+
+    const auto start = Clock::now();
+    switch (op) {
+      case CaptureOp::CreateBuffer:
+        createBuffer(payload);
+        break;
+      case CaptureOp::CreateTexture:
+        createTexture(payload);
+        break;
+      case CaptureOp::CreateSampler:
+        createSampler(payload);
+        break;
+      case CaptureOp::CreateShaderModule:
+        createShaderModule(payload);
+        break;
+      case CaptureOp::CreateComputePipeline:
+        createComputePipeline(payload);
+        break;
+      case CaptureOp::CreateGraphicsPipeline:
+        createGraphicsPipeline(payload);
+        break;
+      case CaptureOp::AllocateDescriptors:
+        allocateDescriptors(payload);
+        break;
+      case CaptureOp::UpdateDescriptors:
+        updateDescriptors(payload);
+        break;
+      case CaptureOp::Destroy:
+        destroy(payload);
+        break;
+      case CaptureOp::HostWrite:
+        hostWrite(payload);
+        break;
+      case CaptureOp::FrameEnd:
+        break;
+      default:
+        ASSERT(false, "Unexpected record in the global capture stream");
+        break;
+    }
+    timing.setupMs += elapsedMs(start);
+  }
+
+  void CommandReplay::createBuffer(CaptureReader& payload) {
+    const auto id = payload.get<uint32_t>();
+    if (buffers_.contains(id)) {
+      return;
+    }
+
+    VkBufferCreateInfo createInfo = {
+        .sType       = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+        .sharingMode = VK_SHARING_MODE_EXCLUSIVE,
+    };
+    createInfo.size  = payload.get<VkDeviceSize>();
+    createInfo.usage = payload.get<VkBufferUsageFlags>();
+    createInfo.flags = payload.get<VkBufferCreateFlags>();
+
+    VmaAllocationCreateInfo allocInfo = {};
+    allocInfo.flags                   = payload.get<VmaAllocationCreateFlags>();
+    allocInfo.usage                   = payload.get<VmaMemoryUsage>();
+    allocInfo.requiredFlags           = payload.get<VkMemoryPropertyFlags>();
+    allocInfo.preferredFlags          = payload.get<VkMemoryPropertyFlags>();
+
+    buffers_[id] = std::make_shared<Buffer>(
+        &context_,
+        context_.memoryAllocator(),
+        createInfo,
+        allocInfo,
+        "Replay buffer " + std::to_string(id)
+    );
+  }
+
+  void CommandReplay::createTexture(CaptureReader& payload) {
+    const auto id   = payload.get<uint32_t>();
+    const auto info = payload.get<CaptureTextureInfo>();
+    if (textures_.contains(id)) {
+      return;
+    }
+
+    textures_[id] = std::make_shared<Texture>(
+        context_,
+        info.type,
+        info.format,
+        info.flags,
+        info.usage,
+        info.extents,
+        info.mipLevels,
+        info.layerCount,
+        info.memoryFlags,
+        false,
+        info.samples,
+        (info.external ? "Replay swapchain image " : "Replay texture ") + std::to_string(id),
+        info.multiview != 0,
+        info.tiling
+    );
+  }
+
+  void CommandReplay::createSampler(CaptureReader& payload) {
+    const auto id   = payload.get<uint32_t>();
+    const auto info = payload.get<CaptureSamplerInfo>();
+    if (samplers_.contains(id)) {
+      return;
+    }
+
+    samplers_[id] = context_.createSampler(
+        info.minFilter,
+        info.magFilter,
+        info.addressModeU,
+        info.addressModeV,
+        info.addressModeW,
+        info.maxLod,
+        info.compareEnable != 0,
+        info.compareOp,
+        "Replay sampler " + std::to_string(id)
+    );
+  }
+
+  void CommandReplay::createShaderModule(CaptureReader& payload) {
+    const auto id         = payload.get<uint32_t>();
+    const auto stage      = payload.get<VkShaderStageFlagBits>();
+    const auto entryPoint = payload.getString();
+    const auto spirv      = payload.getBlob();
+    if (shaderModules_.contains(id)) {
+      return;
+    }
+
+    shaderModules_[id] = context_.createShaderModule(
+        std::vector<char>(spirv.begin(), spirv.end()),
+        entryPoint,
+        stage,
+        "Replay shader " + std::to_string(id)
+    );
+  }
+
+  void CommandReplay::createComputePipeline(CaptureReader& payload) {
+    const auto id = payload.get<uint32_t>();
+    if (pipelines_.contains(id)) {
+      return;
+    }
+
+    ReplayPipeline replayPipeline;
+    Pipeline::ComputePipelineDescriptor desc;
+    desc.sets_           = readSets(payload);
+    desc.computeShader_  = shaderModules_.at(payload.get<uint32_t>());
+    desc.pushConstants_  = payload.getArray<VkPushConstantRange>();
+    auto& specialization = replayPipeline.specializationData[0];
+    readSpecialization(payload, desc.specializationConsts_, specialization);
+    desc.specializationData_ = specialization.empty() ? nullptr : specialization.data();
+
+    replayPipeline.pipeline =
+        context_.createComputePipeline(desc, "Replay compute pipeline " + std::to_string(id));
+    pipelines_[id] = std::move(replayPipeline);
+  }
+
+  void CommandReplay::createGraphicsPipeline(CaptureReader& payload) {
+    const auto id = payload.get<uint32_t>();
+    if (pipelines_.contains(id)) {
+      return;
+    }
+
+    ReplayPipeline replayPipeline;
+    Pipeline::GraphicsPipelineDescriptor desc;
+    desc.sets_               = readSets(payload);
+    desc.vertexShader_       = shaderModules_.at(payload.get<uint32_t>());
+    const auto fragmentId    = payload.get<uint32_t>();
+    if (fragmentId != kCaptureNullId) {
+      desc.fragmentShader_ = shaderModules_.at(fragmentId);
+    }
+    desc.pushConstants_         = payload.getArray<VkPushConstantRange>();
+    desc.dynamicStates_         = payload.getArray<VkDynamicState>();
+    desc.useDynamicRendering_   = true;
+    desc.colorTextureFormats    = payload.getArray<VkFormat>();
+    desc.depthTextureFormat     = payload.get<VkFormat>();
+    desc.stencilTextureFormat   = payload.get<VkFormat>();
+    desc.primitiveTopology      = payload.get<VkPrimitiveTopology>();
+    desc.sampleCount            = payload.get<VkSampleCountFlagBits>();
+    desc.cullMode               = payload.get<VkCullModeFlagBits>();
+    desc.frontFace              = payload.get<VkFrontFace>();
+    desc.viewport               = payload.get<VkViewport>();
+    desc.blendEnable            = payload.get<uint8_t>() != 0;
+    desc.numberBlendAttachments = payload.get<uint32_t>();
+    desc.depthTestEnable        = payload.get<uint8_t>() != 0;
+    desc.depthWriteEnable       = payload.get<uint8_t>() != 0;
+    desc.depthCompareOperation  = payload.get<VkCompareOp>();
+
+    replayPipeline.vertexBindings   = payload.getArray<VkVertexInputBindingDescription>();
+    replayPipeline.vertexAttributes = payload.getArray<VkVertexInputAttributeDescription>();
+    auto& vertexInput               = desc.vertexInputCreateInfo;
+    vertexInput.vertexBindingDescriptionCount =
+        static_cast<uint32_t>(replayPipeline.vertexBindings.size());
+    vertexInput.pVertexBindingDescriptions = replayPipeline.vertexBindings.data();
+    vertexInput.vertexAttributeDescriptionCount =
+        static_cast<uint32_t>(replayPipeline.vertexAttributes.size());
+    vertexInput.pVertexAttributeDescriptions = replayPipeline.vertexAttributes.data();
+
+    auto& vertexData = replayPipeline.specializationData[0];
+    readSpecialization(payload, desc.vertexSpecConstants_, vertexData);
+    desc.vertexSpecializationData = vertexData.empty() ? nullptr : vertexData.data();
+    auto& fragmentData = replayPipeline.specializationData[1];
+    readSpecialization(payload, desc.fragmentSpecConstants_, fragmentData);
+    desc.fragmentSpecializationData = fragmentData.empty() ? nullptr : fragmentData.data();
+
+    desc.blendAttachmentStates_ = payload.getArray<VkPipelineColorBlendAttachmentState>();
+
+    replayPipeline.pipeline = context_.createGraphicsPipeline(
+        desc,
+        VK_NULL_HANDLE,
+        "Replay graphics pipeline " + std::to_string(id)
+    );
+    pipelines_[id] = std::move(replayPipeline);
+  }
+
+  void CommandReplay::allocateDescriptors(CaptureReader& payload) {
+    const auto pipelineId = payload.get<uint32_t>();
+    const auto set        = payload.get<uint32_t>();
+    const auto firstIndex = payload.get<uint32_t>();
+    const auto count      = payload.get<uint32_t>();
+
+    // Already allocated by an earlier loop
+    auto& target          = pipeline(pipelineId);
+    const uint32_t wanted = firstIndex + count;
+    const uint32_t have   = target.descriptorSetCount(set);
+    if (have < wanted) {
+      target.allocateDescriptors({{.set_ = set, .count_ = wanted - have, .name_ = "Replay"}});
+    }
+  }
+
+  void CommandReplay::updateDescriptors(CaptureReader& payload) {
+    const auto writeCount = payload.get<uint32_t>();
+
+    std::vector<VkWriteDescriptorSet> writes;
+    std::vector<std::vector<VkDescriptorImageInfo>> imageInfos;
+    std::vector<std::vector<VkDescriptorBufferInfo>> bufferInfos;
+    std::vector<std::vector<VkBufferView>> texelViews;
+    writes.reserve(writeCount);
+    imageInfos.reserve(writeCount);
+    bufferInfos.reserve(writeCount);
+    texelViews.reserve(writeCount);
+
+    for (uint32_t i = 0; i < writeCount; ++i) {
+      VkWriteDescriptorSet write = {
+          .sType  = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+          .dstSet = descriptorSet(payload.get<CaptureDescriptorSetRef>()),
+      };
+      write.dstBinding      = payload.get<uint32_t>();
+      write.dstArrayElement = payload.get<uint32_t>();
+      write.descriptorType  = payload.get<VkDescriptorType>();
+      write.descriptorCount = payload.get<uint32_t>();
+
+      auto& images  = imageInfos.emplace_back();
+      auto& buffers = bufferInfos.emplace_back();
+      auto& texels  = texelViews.emplace_back();
+      for (uint32_t d = 0; d < write.descriptorCount; ++d) {
+        switch (write.descriptorType) {
+          case VK_DESCRIPTOR_TYPE_SAMPLER:
+          case VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER:
+          case VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE:
+          case VK_DESCRIPTOR_TYPE_STORAGE_IMAGE:
+          case VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT: {
+            const auto image = payload.get<CaptureDescriptorImage>();
+            images.push_back({
+                .sampler = image.sampler != kCaptureNullId
+                               ? samplers_.at(image.sampler)->vkSampler()
+                               : VK_NULL_HANDLE,
+                .imageView   = imageView(image.view),
+                .imageLayout = replayLayout(image.layout),
+            });
+            break;
+          }
+          case VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER:
+          case VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER: {
+            const auto texel = payload.get<CaptureDescriptorTexel>();
+            texels.push_back(buffer(texel.buffer).requestBufferView(texel.format));
+            break;
+          }
+          default: {
+            const auto info = payload.get<CaptureDescriptorBuffer>();
+            buffers.push_back({
+                .buffer = buffer(info.buffer).vkBuffer(),
+                .offset = info.offset,
+                .range  = info.range,
+            });
+            break;
+          }
+        }
+      }
+      write.pImageInfo       = images.empty() ? nullptr : images.data();
+      write.pBufferInfo      = buffers.empty() ? nullptr : buffers.data();
+      write.pTexelBufferView = texels.empty() ? nullptr : texels.data();
+      writes.push_back(write);
+    }
+
+    vkUpdateDescriptorSets(
+        context_.device(),
+        static_cast<uint32_t>(writes.size()),
+        writes.data(),
+        0,
+        nullptr
+    );
+  }
+
+  void CommandReplay::destroy(CaptureReader& payload) {
+    const auto type = payload.get<CaptureObject>();
+    const auto id   = payload.get<uint32_t>();
+    switch (type) {
+      case CaptureObject::Buffer:
+        buffers_.erase(id);
+        break;
+      case CaptureObject::Texture:
+        if (const auto views = mipViews_.find(id); views != mipViews_.end()) {
+          std::vector<VkImageView> imageViews;
+          for (const auto& view : views->second) {
+            imageViews.push_back(*view);
+          }
+          context_.deletionQueue().enqueue(
+              [device = context_.device(), imageViews = std::move(imageViews)]() {
+                for (const auto view : imageViews) {
+                  vkDestroyImageView(device, view, nullptr);
+                }
+              }
+          );
+          mipViews_.erase(views);
+        }
+        textures_.erase(id);
+        break;
+      case CaptureObject::Sampler:
+        samplers_.erase(id);
+        break;
+      case CaptureObject::ShaderModule:
+        shaderModules_.erase(id);
+        break;
+      case CaptureObject::Pipeline:
+        pipelines_.erase(id);
+        break;
+    }
+  }
+
+  void CommandReplay::hostWrite(CaptureReader& payload) {
+    auto& target      = buffer(payload.get<uint32_t>());
+    const auto offset = payload.get<VkDeviceSize>();
+    const auto bytes  = payload.getBlob();
+    std::memcpy(static_cast<uint8_t*>(target.map()) + offset, bytes.data(), bytes.size());
+    target.upload(offset, bytes.size());
+  }
+
+  void CommandReplay::submit(CaptureReader& payload, ReplayFrameTiming& timing) {
+    const auto count = payload.get<uint32_t>();
+    for (uint32_t i = 0; i < count; ++i) {
+      const auto stream = payload.getBlob();
+      if (stream.empty()) {
+        continue;
+      }
+
+      const auto start  = Clock::now();
+      const auto query  = 2 * timing.submits;
+      auto commandBuffer = queue_.getCmdBufferToBegin();
+      vkCmdResetQueryPool(commandBuffer, queryPool_, query, 2);
+      vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, queryPool_, query);
+      recordCommands(commandBuffer, CaptureReader(stream.data(), stream.size()));
+      vkCmdWriteTimestamp(
+          commandBuffer,
+          VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+          queryPool_,
+          query + 1
+      );
+      queue_.endCmdBuffer(commandBuffer);
+
+      const VkSubmitInfo submitInfo = {
+          .sType              = VK_STRUCTURE_TYPE_SUBMIT_INFO,
+          .commandBufferCount = 1,
+          .pCommandBuffers    = &commandBuffer,
+      };
+      queue_.submit(&submitInfo);
+      queue_.goToNextCmdBuffer();
+
+      timing.cpuMs += elapsedMs(start);
+      ++timing.submits;
+    }
+  }
+
+  void CommandReplay::recordCommands(VkCommandBuffer cb, CaptureReader stream) {
+    while (!stream.atEnd()) {
+      CaptureOp op;
+      auto c = stream.nextRecord(op);
+      switch (op) {
+        case CaptureOp::BindPipeline: {
+          const auto bindPoint = c.get<VkPipelineBindPoint>();
+          vkCmdBindPipeline(cb, bindPoint, pipeline(c.get<uint32_t>()).vkPipeline());
+          break;
+        }
+        case CaptureOp::BindDescriptorSets: {
+          const auto bindPoint = c.get<VkPipelineBindPoint>();
+          const auto layout    = pipeline(c.get<uint32_t>()).vkPipelineLayout();
+          const auto firstSet  = c.get<uint32_t>();
+          std::vector<VkDescriptorSet> sets(c.get<uint32_t>());
+          for (auto& set : sets) {
+            set = descriptorSet(c.get<CaptureDescriptorSetRef>());
+          }
+          const auto dynamicOffsets = c.getArray<uint32_t>();
+          vkCmdBindDescriptorSets(
+              cb,
+              bindPoint,
+              layout,
+              firstSet,
+              static_cast<uint32_t>(sets.size()),
+              sets.data(),
+              static_cast<uint32_t>(dynamicOffsets.size()),
+              dynamicOffsets.data()
+          );
+          break;
+        }
+        case CaptureOp::PushConstants: {
+          const auto layout = pipeline(c.get<uint32_t>()).vkPipelineLayout();
+          const auto stages = c.get<VkShaderStageFlags>();
+          const auto offset = c.get<uint32_t>();
+          const auto values = c.getBlob();
+          vkCmdPushConstants(
+              cb,
+              layout,
+              stages,
+              offset,
+              static_cast<uint32_t>(values.size()),
+              values.data()
+          );
+          break;
+        }
+        case CaptureOp::BindVertexBuffers: {
+          const auto firstBinding = c.get<uint32_t>();
+          const auto count        = c.get<uint32_t>();
+          std::vector<VkBuffer> vertexBuffers(count);
+          std::vector<VkDeviceSize> offsets(count);
+          for (uint32_t i = 0; i < count; ++i) {
+            const auto binding = c.get<CaptureVertexBinding>();
+            vertexBuffers[i]   = buffer(binding.buffer).vkBuffer();
+            offsets[i]         = binding.offset;
+          }
+          vkCmdBindVertexBuffers(cb, firstBinding, count, vertexBuffers.data(), offsets.data());
+          break;
+        }
+        case CaptureOp::BindIndexBuffer: {
+          const auto offset = c.get<VkDeviceSize>();
+          const auto type   = c.get<VkIndexType>();
+          vkCmdBindIndexBuffer(cb, buffer(c.get<uint32_t>()).vkBuffer(), offset, type);
+          break;
+        }
+        case CaptureOp::Draw: {
+          const auto vertexCount   = c.get<uint32_t>();
+          const auto instanceCount = c.get<uint32_t>();
+          const auto firstVertex   = c.get<uint32_t>();
+          const auto firstInstance = c.get<uint32_t>();
+          vkCmdDraw(cb, vertexCount, instanceCount, firstVertex, firstInstance);
+          break;
+        }
+        case CaptureOp::DrawIndexed: {
+          const auto indexCount    = c.get<uint32_t>();
+          const auto instanceCount = c.get<uint32_t>();
+          const auto firstIndex    = c.get<uint32_t>();
+          const auto vertexOffset  = c.get<int32_t>();
+          const auto firstInstance = c.get<uint32_t>();
+          vkCmdDrawIndexed(cb, indexCount, instanceCount, firstIndex, vertexOffset, firstInstance);
+          break;
+        }
+        case CaptureOp::DrawIndirect:
+        case CaptureOp::DrawIndexedIndirect:
+        case CaptureOp::DispatchIndirect: {
+          const auto offset    = c.get<VkDeviceSize>();
+          const auto drawCount = c.get<uint32_t>();
+          const auto stride    = c.get<uint32_t>();
+          const auto indirect  = buffer(c.get<uint32_t>()).vkBuffer();
+          if (op == CaptureOp::DrawIndirect) {
+            vkCmdDrawIndirect(cb, indirect, offset, drawCount, stride);
+          } else if (op == CaptureOp::DrawIndexedIndirect) {
+            vkCmdDrawIndexedIndirect(cb, indirect, offset, drawCount, stride);
+          } else {
+            vkCmdDispatchIndirect(cb, indirect, offset);
+          }
+          break;
+        }
+        case CaptureOp::Dispatch: {
+          const auto x = c.get<uint32_t>();
+          const auto y = c.get<uint32_t>();
+          const auto z = c.get<uint32_t>();
+          vkCmdDispatch(cb, x, y, z);
+          break;
+        }
+        case CaptureOp::PipelineBarrier: {
+          const auto srcStageMask    = c.get<VkPipelineStageFlags>();
+          const auto dstStageMask    = c.get<VkPipelineStageFlags>();
+          const auto dependencyFlags = c.get<VkDependencyFlags>();
+
+          std::vector<VkMemoryBarrier> memoryBarriers(c.get<uint32_t>());
+          for (auto& barrier : memoryBarriers) {
+            const auto captured = c.get<CaptureMemoryBarrier>();
+            barrier             = {
+                            .sType         = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+                            .srcAccessMask = captured.srcAccessMask,
+                            .dstAccessMask = captured.dstAccessMask,
+            };
+          }
+          std::vector<VkBufferMemoryBarrier> bufferBarriers(c.get<uint32_t>());
+          for (auto& barrier : bufferBarriers) {
+            const auto captured = c.get<CaptureBufferBarrier>();
+            barrier             = {
+                            .sType               = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER,
+                            .srcAccessMask       = captured.srcAccessMask,
+                            .dstAccessMask       = captured.dstAccessMask,
+                            .srcQueueFamilyIndex = captured.srcQueueFamilyIndex,
+                            .dstQueueFamilyIndex = captured.dstQueueFamilyIndex,
+                            .buffer              = buffer(captured.buffer).vkBuffer(),
+                            .offset              = captured.offset,
+                            .size                = captured.size,
+            };
+          }
+          std::vector<VkImageMemoryBarrier> imageBarriers(c.get<uint32_t>());
+          for (auto& barrier : imageBarriers) {
+            const auto captured = c.get<CaptureImageBarrier>();
+            barrier             = {
+                            .sType               = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+                            .srcAccessMask       = captured.srcAccessMask,
+                            .dstAccessMask       = captured.dstAccessMask,
+                            .oldLayout           = replayLayout(captured.oldLayout),
+                            .newLayout           = replayLayout(captured.newLayout),
+                            .srcQueueFamilyIndex = captured.srcQueueFamilyIndex,
+                            .dstQueueFamilyIndex = captured.dstQueueFamilyIndex,
+                            .image               = texture(captured.texture).vkImage(),
+                            .subresourceRange    = captured.subresourceRange,
+            };
+          }
+          vkCmdPipelineBarrier(
+              cb,
+              srcStageMask,
+              dstStageMask,
+              dependencyFlags,
+              static_cast<uint32_t>(memoryBarriers.size()),
+              memoryBarriers.data(),
+              static_cast<uint32_t>(bufferBarriers.size()),
+              bufferBarriers.data(),
+              static_cast<uint32_t>(imageBarriers.size()),
+              imageBarriers.data()
+          );
+          break;
+        }
+        case CaptureOp::PipelineBarrier2: {
+          const auto dependencyFlags = c.get<VkDependencyFlags>();
+
+          std::vector<VkMemoryBarrier2> memoryBarriers(c.get<uint32_t>());
+          for (auto& barrier : memoryBarriers) {
+            const auto captured = c.get<CaptureMemoryBarrier2>();
+            barrier             = {
+                            .sType         = VK_STRUCTURE_TYPE_MEMORY_BARRIER_2,
+                            .srcStageMask  = captured.srcStageMask,
+                            .srcAccessMask = captured.srcAccessMask,
+                            .dstStageMask  = captured.dstStageMask,
+                            .dstAccessMask = captured.dstAccessMask,
+            };
+          }
+          std::vector<VkBufferMemoryBarrier2> bufferBarriers(c.get<uint32_t>());
+          for (auto& barrier : bufferBarriers) {
+            const auto captured = c.get<CaptureBufferBarrier2>();
+            barrier             = {
+                            .sType               = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER_2,
+                            .srcStageMask        = captured.masks.srcStageMask,
+                            .srcAccessMask       = captured.masks.srcAccessMask,
+                            .dstStageMask        = captured.masks.dstStageMask,
+                            .dstAccessMask       = captured.masks.dstAccessMask,
+                            .srcQueueFamilyIndex = captured.srcQueueFamilyIndex,
+                            .dstQueueFamilyIndex = captured.dstQueueFamilyIndex,
+                            .buffer              = buffer(captured.buffer).vkBuffer(),
+                            .offset              = captured.offset,
+                            .size                = captured.size,
+            };
+          }
+          std::vector<VkImageMemoryBarrier2> imageBarriers(c.get<uint32_t>());
+          for (auto& barrier : imageBarriers) {
+            const auto captured = c.get<CaptureImageBarrier2>();
+            barrier             = {
+                            .sType               = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2,
+                            .srcStageMask        = captured.masks.srcStageMask,
+                            .srcAccessMask       = captured.masks.srcAccessMask,
+                            .dstStageMask        = captured.masks.dstStageMask,
+                            .dstAccessMask       = captured.masks.dstAccessMask,
+                            .oldLayout           = replayLayout(captured.oldLayout),
+                            .newLayout           = replayLayout(captured.newLayout),
+                            .srcQueueFamilyIndex = captured.srcQueueFamilyIndex,
+                            .dstQueueFamilyIndex = captured.dstQueueFamilyIndex,
+                            .image               = texture(captured.texture).vkImage(),
+                            .subresourceRange    = captured.subresourceRange,
+            };
+          }
+          const VkDependencyInfo dependencyInfo = {
+              .sType                    = VK_STRUCTURE_TYPE_DEPENDENCY_INFO,
+              .dependencyFlags          = dependencyFlags,
+              .memoryBarrierCount       = static_cast<uint32_t>(memoryBarriers.size()),
+              .pMemoryBarriers          = memoryBarriers.data(),
+              .bufferMemoryBarrierCount = static_cast<uint32_t>(bufferBarriers.size()),
+              .pBufferMemoryBarriers    = bufferBarriers.data(),
+              .imageMemoryBarrierCount  = static_cast<uint32_t>(imageBarriers.size()),
+              .pImageMemoryBarriers     = imageBarriers.data(),
+          };
+          vkCmdPipelineBarrier2(cb, &dependencyInfo);
+          break;
+        }
+        case CaptureOp::CopyBuffer: {
+          const auto src     = buffer(c.get<uint32_t>()).vkBuffer();
+          const auto dst     = buffer(c.get<uint32_t>()).vkBuffer();
+          const auto regions = c.getArray<VkBufferCopy>();
+          vkCmdCopyBuffer(cb, src, dst, static_cast<uint32_t>(regions.size()), regions.data());
+          break;
+        }
+        case CaptureOp::FillBuffer: {
+          const auto offset = c.get<VkDeviceSize>();
+          const auto size   = c.get<VkDeviceSize>();
+          const auto value  = c.get<uint32_t>();
+          vkCmdFillBuffer(cb, buffer(c.get<uint32_t>()).vkBuffer(), offset, size, value);
+          break;
+        }
+        case CaptureOp::CopyBufferToImage: {
+          const auto src     = buffer(c.get<uint32_t>()).vkBuffer();
+          const auto dst     = texture(c.get<uint32_t>()).vkImage();
+          const auto layout  = replayLayout(c.get<VkImageLayout>());
+          const auto regions = c.getArray<VkBufferImageCopy>();
+          vkCmdCopyBufferToImage(
+              cb,
+              src,
+              dst,
+              layout,
+              static_cast<uint32_t>(regions.size()),
+              regions.data()
+          );
+          break;
+        }
+        case CaptureOp::CopyImageToBuffer: {
+          const auto src     = texture(c.get<uint32_t>()).vkImage();
+          const auto dst     = buffer(c.get<uint32_t>()).vkBuffer();
+          const auto layout  = replayLayout(c.get<VkImageLayout>());
+          const auto regions = c.getArray<VkBufferImageCopy>();
+          vkCmdCopyImageToBuffer(
+              cb,
+              src,
+              layout,
+              dst,
+              static_cast<uint32_t>(regions.size()),
+              regions.data()
+          );
+          break;
+        }
+        case CaptureOp::BlitImage: {
+          const auto src       = texture(c.get<uint32_t>()).vkImage();
+          const auto dst       = texture(c.get<uint32_t>()).vkImage();
+          const auto srcLayout = replayLayout(c.get<VkImageLayout>());
+          const auto dstLayout = replayLayout(c.get<VkImageLayout>());
+          const auto filter    = c.get<VkFilter>();
+          const auto regions   = c.getArray<VkImageBlit>();
+          vkCmdBlitImage(
+              cb,
+              src,
+              srcLayout,
+              dst,
+              dstLayout,
+              static_cast<uint32_t>(regions.size()),
+              regions.data(),
+              filter
+          );
+          break;
+        }
+        case CaptureOp::BeginRendering: {
+          VkRenderingInfo info = {
+              .sType      = VK_STRUCTURE_TYPE_RENDERING_INFO,
+              .flags      = c.get<VkRenderingFlags>(),
+              .renderArea = c.get<VkRect2D>(),
+              .layerCount = c.get<uint32_t>(),
+              .viewMask   = c.get<uint32_t>(),
+          };
+
+          const auto readAttachment = [&](VkRenderingAttachmentInfo& attachment) {
+            if (c.get<uint8_t>() == 0) {
+              return false;
+            }
+            const auto captured = c.get<CaptureAttachment>();
+            attachment          = {
+                         .sType              = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO,
+                         .imageView          = imageView(captured.view),
+                         .imageLayout        = replayLayout(captured.imageLayout),
+                         .resolveMode        = captured.resolveMode,
+                         .resolveImageView   = imageView(captured.resolveView),
+                         .resolveImageLayout = replayLayout(captured.resolveImageLayout),
+                         .loadOp             = captured.loadOp,
+                         .storeOp            = captured.storeOp,
+                         .clearValue         = captured.clearValue,
+            };
+            return true;
+          };
+
+          std::vector<VkRenderingAttachmentInfo> colorAttachments(c.get<uint32_t>());
+          for (auto& attachment : colorAttachments) {
+            readAttachment(attachment);
+          }
+          VkRenderingAttachmentInfo depthAttachment;
+          VkRenderingAttachmentInfo stencilAttachment;
+          info.colorAttachmentCount = static_cast<uint32_t>(colorAttachments.size());
+          info.pColorAttachments    = colorAttachments.data();
+          info.pDepthAttachment     = readAttachment(depthAttachment) ? &depthAttachment : nullptr;
+          info.pStencilAttachment =
+              readAttachment(stencilAttachment) ? &stencilAttachment : nullptr;
+          vkCmdBeginRendering(cb, &info);
+          break;
+        }
+        case CaptureOp::EndRendering:
+          vkCmdEndRendering(cb);
+          break;
+        case CaptureOp::SetViewport: {
+          const auto first     = c.get<uint32_t>();
+          const auto viewports = c.getArray<VkViewport>();
+          vkCmdSetViewport(cb, first, static_cast<uint32_t>(viewports.size()), viewports.data());
+          break;
+        }
+        case CaptureOp::SetScissor: {
+          const auto first    = c.get<uint32_t>();
+          const auto scissors = c.getArray<VkRect2D>();
+          vkCmdSetScissor(cb, first, static_cast<uint32_t>(scissors.size()), scissors.data());
+          break;
+        }
+        default:
+          ASSERT(false, "Unexpected record in a command buffer stream");
+          break;
+      }
+    }
+  }
+
+  void CommandReplay::drain() {
+    // Visits every slot once and ends on the one it started from
+    for (uint32_t i = 0; i < kReplayCommandBuffers; ++i) {
+      queue_.waitUntilSubmitIsComplete();
+      queue_.goToNextCmdBuffer();
+    }
+  }
+
+  Buffer& CommandReplay::buffer(uint32_t id) {
+    return *buffers_.at(id);
+  }
+
+  Texture& CommandReplay::texture(uint32_t id) {
+    return *textures_.at(id);
+  }
+
+  Pipeline& CommandReplay::pipeline(uint32_t id) {
+    return *pipelines_.at(id).pipeline;
+  }
+
+  VkImageView CommandReplay::imageView(const CaptureImageRef& ref) {
+    if (ref.texture == kCaptureNullId) {
+      return VK_NULL_HANDLE;
+    }
+
+    auto& target = texture(ref.texture);
+    switch (ref.kind) {
+      case CaptureViewKind::Default:
+        return target.vkImageView();
+      case CaptureViewKind::MipChain:
+        return target.vkImageView(ref.mip);
+      case CaptureViewKind::SingleMip: {
+        auto& views = mipViews_[ref.texture];
+        if (views.empty()) {
+          views = target.generateViewForEachMips();
+        }
+        return *views.at(ref.mip);
+      }
+    }
+    return VK_NULL_HANDLE;
+  }
+
+  VkDescriptorSet CommandReplay::descriptorSet(const CaptureDescriptorSetRef& ref) {
+    return pipeline(ref.pipeline).vkDescriptorSet(ref.set, ref.index);
+  }
+
+} // namespace VulkanCore
@@ -0,0 +1,105 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "CaptureStream.hpp"
+#include "CommandQueueManager.hpp"
+#include "Common.hpp"
+#include "Utility.hpp"
+
+namespace VulkanCore {
+
+  class Buffer;
+  class Context;
+  class Pipeline;
+  class Sampler;
+  class ShaderModule;
+  class Texture;
+
+  struct ReplayFrameTiming {
+    double cpuMs   = 0.0; // recording and vkQueueSubmit of the captured command buffers
+    double gpuMs   = 0.0; // sum of the timestamps around each replayed command buffer
+    double setupMs = 0.0; // object creation, host writes and descriptor updates
+    uint32_t submits = 0;
+  };
+
+  // Plays a CommandCapture file back on a headless Context. Every captured
+  // command buffer becomes one submit bracketed by timestamp queries; waits
+  // and signals on semaphores are not replayed since the frame is drained
+  // before its timings are read. Swapchain images are offscreen textures and
+  // PRESENT_SRC layouts are replaced with GENERAL.
+  //
+  // Objects live until the capture destroys them, so a frame can be replayed
+  // any number of times; creation records for ids that are still alive are
+  // skipped on later loops.
+  class CommandReplay final {
+  public:
+    explicit CommandReplay(Context& context, const std::string& filePath);
+    ~CommandReplay();
+
+    CommandReplay(const CommandReplay&)            = delete;
+    CommandReplay& operator=(const CommandReplay&) = delete;
+
+    size_t frameCount() const { return frames_.size(); }
+
+    // Replays one frame and waits for the GPU to finish it
+    ReplayFrameTiming replayFrame(size_t frame);
+
+  private:
+    struct Frame {
+      size_t begin;
+      size_t end;
+    };
+
+    // Arrays the pipeline descriptor points into
+    struct ReplayPipeline {
+      std::shared_ptr<Pipeline> pipeline;
+      std::vector<VkVertexInputBindingDescription> vertexBindings;
+      std::vector<VkVertexInputAttributeDescription> vertexAttributes;
+      std::vector<uint8_t> specializationData[2];
+    };
+
+    void execute(CaptureOp op, CaptureReader& payload, ReplayFrameTiming& timing);
+
+    void createBuffer(CaptureReader& payload);
+    void createTexture(CaptureReader& payload);
+    void createSampler(CaptureReader& payload);
+    void createShaderModule(CaptureReader& payload);
+    void createComputePipeline(CaptureReader& payload);
+    void createGraphicsPipeline(CaptureReader& payload);
+    void allocateDescriptors(CaptureReader& payload);
+    void updateDescriptors(CaptureReader& payload);
+    void destroy(CaptureReader& payload);
+    void hostWrite(CaptureReader& payload);
+    void submit(CaptureReader& payload, ReplayFrameTiming& timing);
+    void recordCommands(VkCommandBuffer commandBuffer, CaptureReader stream);
+    void drain();
+
+    Buffer& buffer(uint32_t id);
+    Texture& texture(uint32_t id);
+    Pipeline& pipeline(uint32_t id);
+    VkImageView imageView(const CaptureImageRef& ref);
+    VkDescriptorSet descriptorSet(const CaptureDescriptorSetRef& ref);
+
+    Context& context_;
+    std::vector<uint8_t> data_;
+    std::vector<Frame> frames_;
+
+    CommandQueueManager queue_;
+    VkQueryPool queryPool_  = VK_NULL_HANDLE;
+    uint32_t maxSubmits_    = 1;
+    double timestampPeriod_ = 1.0;
+
+    std::unordered_map<uint32_t, std::shared_ptr<Buffer>> buffers_;
+    std::unordered_map<uint32_t, std::shared_ptr<Texture>> textures_;
+    std::unordered_map<uint32_t, std::shared_ptr<Sampler>> samplers_;
+    std::unordered_map<uint32_t, std::shared_ptr<ShaderModule>> shaderModules_;
+    std::unordered_map<uint32_t, ReplayPipeline> pipelines_;
+    std::unordered_map<uint32_t, std::vector<std::shared_ptr<VkImageView>>> mipViews_;
+  };
+
+} // namespace VulkanCore
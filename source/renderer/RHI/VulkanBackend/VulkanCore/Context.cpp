@@ -12,10 +12,13 @@
 #define GLFW_INCLUDE_VULKAN
 #include <GLFW/glfw3.h>
 
+#include "CommandCapture.hpp"
 #include "Framebuffer.hpp"
 #include "RenderPass.hpp"
 #include "Sampler.hpp"
+#include "SubmissionThread.hpp"
 #include "Texture.hpp"
+#include "core/Metrics.hpp"
 
 constexpr bool DEBUG_SHADER_PRINTF_CALLBACK = false;
 
@@ -55,6 +58,34 @@ namespace {
     return VK_FALSE;
   }
 #endif
+
+  struct InstanceSupport {
+    std::vector<VkLayerProperties> layers;
+    std::vector<VkExtensionProperties> extensions;
+  };
+
+  // Loading the loader and letting it scan the driver and layer manifests is
+  // a large part of instance creation, and doesn't change while we run
+  const InstanceSupport& instanceSupport() {
+    static const InstanceSupport support = [] {
+      VK_CHECK(volkInitialize());
+
+      InstanceSupport loaded;
+      uint32_t count = 0;
+      VK_CHECK(vkEnumerateInstanceLayerProperties(&count, nullptr));
+      loaded.layers.resize(count);
+      VK_CHECK(vkEnumerateInstanceLayerProperties(&count, loaded.layers.data()));
+      loaded.layers.resize(count);
+
+      count = 0;
+      VK_CHECK(vkEnumerateInstanceExtensionProperties(nullptr, &count, nullptr));
+      loaded.extensions.resize(count);
+      VK_CHECK(vkEnumerateInstanceExtensionProperties(nullptr, &count, loaded.extensions.data()));
+      loaded.extensions.resize(count);
+      return loaded;
+    }();
+    return support;
+  }
 } // namespace
 
 namespace VulkanCore {
@@ -102,6 +133,14 @@ namespace VulkanCore {
           .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FRAGMENT_DENSITY_MAP_OFFSET_FEATURES_QCOM,
   };
 
+  VkPhysicalDeviceDeviceGeneratedCommandsFeaturesEXT Context::deviceGeneratedCommandsFeatures_ = {
+      .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DEVICE_GENERATED_COMMANDS_FEATURES_EXT,
+  };
+
+  VkPhysicalDeviceMaintenance5FeaturesKHR Context::maintenance5Features_ = {
+      .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MAINTENANCE_5_FEATURES_KHR,
+  };
+
   bool Context::enableMultiViewFlag_ = false;
 
   Context::Context(
@@ -115,7 +154,7 @@ namespace VulkanCore {
       const std::string& name
   )
       : printEnumerations_{printEnumerations} {
-    VK_CHECK(volkInitialize());
+    preloadLoader();
 
     enabledLayers_ = util::filterExtensions(enumerateInstanceLayers(), requestedLayers);
     enabledInstanceExtensions_ =
@@ -330,6 +369,11 @@ namespace VulkanCore {
         featureChain.pushBack(fragmentDensityMapOffsetFeatures_);
       }
 
+      if (physicalDevice_.isDeviceGeneratedCommandsSupported()) {
+        featureChain.pushBack(deviceGeneratedCommandsFeatures_);
+        featureChain.pushBack(maintenance5Features_);
+      }
+
       const VkDeviceCreateInfo dci = {
           .sType                   = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO,
           .pNext                   = featureChain.firstNextPtr(),
@@ -409,12 +453,16 @@ namespace VulkanCore {
       );
     }
 
+    createQueueMutexes();
+
     // Initialize volk for this device
     volkLoadDevice(device_);
 
     // Create the allocator
     createMemoryAllocator();
 
+    createSyncObjectPools();
+
     // Naming objects created before we had a device
     setVkObjectname(surface_, VK_OBJECT_TYPE_SURFACE_KHR, "Surface: " + name);
   } // namespace VulkanCore
@@ -427,7 +475,7 @@ namespace VulkanCore {
       const std::string& name
   )
       : applicationInfo_{appInfo}, printEnumerations_{printEnumerations} {
-    VK_CHECK(volkInitialize());
+    preloadLoader();
 
     enabledLayers_ = util::filterExtensions(enumerateInstanceLayers(), requestedLayers);
     enabledInstanceExtensions_ =
@@ -598,6 +646,11 @@ namespace VulkanCore {
         featureChain.pushBack(fragmentDensityMapOffsetFeatures_);
       }
 
+      if (physicalDevice_.isDeviceGeneratedCommandsSupported()) {
+        featureChain.pushBack(deviceGeneratedCommandsFeatures_);
+        featureChain.pushBack(maintenance5Features_);
+      }
+
       std::vector<const char*> instanceLayers(enabledLayers_.size());
       std::transform(
           enabledLayers_.begin(),
@@ -685,21 +738,37 @@ namespace VulkanCore {
       );
     }
 
+    createQueueMutexes();
+
     // Initialize volk for this device
     volkLoadDevice(device_);
 
     // Create the allocator
     createMemoryAllocator();
 
+    createSyncObjectPools();
+
     setVkObjectname(device_, VK_OBJECT_TYPE_DEVICE, "Device: " + name);
 
     setVkObjectname(instance_, VK_OBJECT_TYPE_INSTANCE, "Instance: " + name);
   }
 
   Context::~Context() {
+    submissionThread_.reset();
     vkDeviceWaitIdle(device_);
 
+    commandCapture_.reset();
+
     swapchain_.reset();
+    if (deletionQueue_) {
+      deletionQueue_->flush();
+    }
+    // After the flush, which returns objects released with releaseWhenRetired()
+    fencePool_.reset();
+    semaphorePool_.reset();
+    // Nothing may be deferred past this point: deleters need the device and
+    // the allocator
+    deletionQueue_.reset();
     vmaDestroyAllocator(allocator_);
     vkDestroyDevice(device_, nullptr);
     if (surface_ != VK_NULL_HANDLE) {
@@ -714,6 +783,38 @@ namespace VulkanCore {
     vkDestroyInstance(instance_, nullptr);
   }
 
+  void Context::beginCommandCapture(const std::string& filePath) {
+    ASSERT(device_ != VK_NULL_HANDLE, "Create the device before starting a capture");
+    ASSERT(commandCapture_ == nullptr, "A command capture is already running");
+    // The capture swaps volk's entry points, which no other thread may be
+    // calling through at the time
+    waitIdleForCapture();
+    commandCapture_ = std::make_unique<CommandCapture>(filePath);
+  }
+
+  void Context::endCommandCapture() {
+    waitIdleForCapture();
+    commandCapture_.reset();
+  }
+
+  void Context::waitIdleForCapture() const {
+    if (submissionThread_) {
+      submissionThread_->waitIdle();
+    }
+    VK_CHECK(vkDeviceWaitIdle(device_));
+  }
+
+  void Context::startSubmissionThread() {
+    ASSERT(device_ != VK_NULL_HANDLE, "Create the device before starting the submission thread");
+    if (!submissionThread_) {
+      submissionThread_ = std::make_unique<SubmissionThread>(*this);
+    }
+  }
+
+  void Context::stopSubmissionThread() {
+    submissionThread_.reset();
+  }
+
   void Context::enableDefaultFeatures() {
     // do we need these for defaults?
     enable12Features_.shaderSampledImageArrayNonUniformIndexing = VK_TRUE;
@@ -759,6 +860,10 @@ namespace VulkanCore {
     physicalDeviceFeatures_.independentBlend = VK_TRUE;
   }
 
+  void Context::enableClipDistanceFeature() {
+    physicalDeviceFeatures_.shaderClipDistance = VK_TRUE;
+  }
+
   void Context::enableMaintenance4Feature() {
     enable13Features_.maintenance4 = VK_TRUE;
   }
@@ -789,6 +894,12 @@ namespace VulkanCore {
     fragmentDensityMapOffsetFeatures_.fragmentDensityMapOffset = VK_TRUE;
   }
 
+  void Context::enableDeviceGeneratedCommandsFeature() {
+    deviceGeneratedCommandsFeatures_.deviceGeneratedCommands = VK_TRUE;
+    // Indirect-bindable pipelines are flagged through VkPipelineCreateFlags2
+    maintenance5Features_.maintenance5 = VK_TRUE;
+  }
+
   const PhysicalDevice& Context::physicalDevice() const {
     return physicalDevice_;
   }
@@ -898,6 +1009,30 @@ namespace VulkanCore {
     );
   }
 
+  std::shared_ptr<Buffer> Context::createReadbackBuffer(
+      VkDeviceSize size,
+      const std::string& name
+  ) const {
+    return std::make_shared<Buffer>(
+        this,
+        memoryAllocator(),
+        VkBufferCreateInfo{
+            .sType       = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+            .size        = size,
+            .usage       = VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+            .sharingMode = VK_SHARING_MODE_EXCLUSIVE,
+        },
+        VmaAllocationCreateInfo{
+            .flags =
+                VMA_ALLOCATION_CREATE_MAPPED_BIT | VMA_ALLOCATION_CREATE_HOST_ACCESS_RANDOM_BIT,
+            .usage          = VMA_MEMORY_USAGE_AUTO_PREFER_HOST,
+            .requiredFlags  = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT,
+            .preferredFlags = VK_MEMORY_PROPERTY_HOST_CACHED_BIT,
+        },
+        name
+    );
+  }
+
   std::shared_ptr<Buffer> Context::createStagingBuffer(
       VkDeviceSize size,
       VkBufferUsageFlags usage,
@@ -926,6 +1061,15 @@ namespace VulkanCore {
 
     stagingBuffer->uploadStagingBufferToGPU(commandBuffer, 0, gpuBufferOffset);
     queueMgr.disposeWhenSubmitCompletes(std::move(stagingBuffer));
+
+    static auto& metrics = kst::core::MetricsRegistry::instance();
+    static auto& uploads =
+        metrics.counter("kst_uploads_total", "Staged uploads recorded", "kind=\"buffer\"");
+    static auto& uploadBytes = metrics.counter(
+        "kst_upload_bytes_total", "Bytes copied through staging buffers", "kind=\"buffer\""
+    );
+    uploads.add();
+    uploadBytes.add(static_cast<uint64_t>(totalSize));
   }
 
   std::shared_ptr<Texture> Context::createTexture(
@@ -1051,6 +1195,33 @@ namespace VulkanCore {
     );
   }
 
+  VulkanCore::CommandQueueManager Context::createComputeCommandQueue(
+      uint32_t count,
+      uint32_t concurrentNumCommands,
+      const std::string& name,
+      int computeQueueIndex
+  ) {
+    if (!hasDedicatedComputeQueue()) {
+      return createGraphicsCommandQueue(count, concurrentNumCommands, name);
+    }
+    if (computeQueueIndex != -1) {
+      ASSERT(
+          computeQueueIndex < computeQueues_.size(),
+          "Don't have enough compute queue, specify smaller queue index"
+      );
+    }
+    return CommandQueueManager(
+        *this,
+        device_,
+        count,
+        concurrentNumCommands,
+        physicalDevice_.computeFamilyIndex().value(),
+        computeQueueIndex != -1 ? computeQueues_[computeQueueIndex] : computeQueues_[0],
+        VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT,
+        name
+    );
+  }
+
   std::shared_ptr<ShaderModule> Context::createShaderModule(
       const std::string& filePath,
       VkShaderStageFlagBits stages,
@@ -1159,6 +1330,29 @@ namespace VulkanCore {
 #endif
   }
 
+  void Context::createQueueMutexes() {
+    queueMutexes_.clear();
+    for (const auto* queues : {&graphicsQueues_, &computeQueues_, &transferQueues_, &sparseQueues_}) {
+      for (const auto queue : *queues) {
+        queueMutexes_.try_emplace(queue, std::make_unique<std::mutex>());
+      }
+    }
+    if (presentationQueue_ != VK_NULL_HANDLE) {
+      queueMutexes_.try_emplace(presentationQueue_, std::make_unique<std::mutex>());
+    }
+  }
+
+  void Context::createSyncObjectPools() {
+    fencePool_     = std::make_unique<FencePool>(*this);
+    semaphorePool_ = std::make_unique<SemaphorePool>(*this);
+  }
+
+  std::mutex& Context::queueMutex(VkQueue queue) const {
+    const auto itr = queueMutexes_.find(queue);
+    ASSERT(itr != queueMutexes_.end(), "Queue was not retrieved from this context");
+    return *itr->second;
+  }
+
   void Context::createMemoryAllocator() {
     const VmaVulkanFunctions vulkanFunctions = {
         .vkGetInstanceProcAddr               = vkGetInstanceProcAddr,
@@ -1218,11 +1412,13 @@ namespace VulkanCore {
     vmaFreeStatsString(allocator_, memoryStats);
   }
 
+  void Context::preloadLoader() {
+    instanceSupport();
+  }
+
   std::vector<std::string> Context::enumerateInstanceLayers(bool printEnumerations) {
-    uint32_t instanceLayerCount{0};
-    VK_CHECK(vkEnumerateInstanceLayerProperties(&instanceLayerCount, nullptr));
-    std::vector<VkLayerProperties> layers(instanceLayerCount);
-    VK_CHECK(vkEnumerateInstanceLayerProperties(&instanceLayerCount, layers.data()));
+    const auto& layers                = instanceSupport().layers;
+    const uint32_t instanceLayerCount = static_cast<uint32_t>(layers.size());
 
     std::vector<std::string> returnValues;
     std::transform(
@@ -1243,10 +1439,8 @@ namespace VulkanCore {
   }
 
   [[nodiscard]] std::vector<std::string> Context::enumerateInstanceExtensions() {
-    uint32_t extensionsCount{0};
-    vkEnumerateInstanceExtensionProperties(nullptr, &extensionsCount, nullptr);
-    std::vector<VkExtensionProperties> extensionProperties(extensionsCount);
-    vkEnumerateInstanceExtensionProperties(nullptr, &extensionsCount, extensionProperties.data());
+    const auto& extensionProperties = instanceSupport().extensions;
+    const uint32_t extensionsCount  = static_cast<uint32_t>(extensionProperties.size());
 
     std::vector<std::string> returnValues;
     std::transform(
@@ -3,7 +3,9 @@
 #include <any>
 #include <array>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <unordered_map>
 #include <unordered_set>
 #include <utility>
 #include <vector>
@@ -13,18 +15,22 @@
 #include "Buffer.hpp"
 #include "CommandQueueManager.hpp"
 #include "Common.hpp"
+#include "DeletionQueue.hpp"
 #include "PhysicalDevice.hpp"
 #include "Pipeline.hpp"
 #include "ShaderModule.hpp"
 #include "Swapchain.hpp"
+#include "SyncObjectPool.hpp"
 #include "Utility.hpp"
 #include "vk_mem_alloc.h"
 
 namespace VulkanCore {
 
+  class CommandCapture;
   class Framebuffer;
   class RenderPass;
   class Sampler;
+  class SubmissionThread;
   class Texture;
 
   template <size_t CHAIN_SIZE = 10>
@@ -54,6 +60,12 @@ namespace VulkanCore {
     void* firstNext_         = VK_NULL_HANDLE;
   };
 
+  // Once the device exists, the create*() methods, uploadToGPUBuffer() and
+  // object destruction may be called from any number of threads: VMA and the
+  // deletion queue synchronize internally and everything else they touch is
+  // per-object. Device setup, the static enable*() feature toggles, swapchain
+  // creation, command capture and submission thread control stay
+  // single-threaded.
   class Context final {
   public:
     MOVABLE_ONLY(Context);
@@ -86,6 +98,12 @@ namespace VulkanCore {
 
     ~Context();
 
+    // Loads the Vulkan loader and has it enumerate instance layers and
+    // extensions, which every Context reuses afterwards. Construction does
+    // this itself; calling it early from any thread lets the cost overlap
+    // other startup work (window creation).
+    static void preloadLoader();
+
     static void enableDefaultFeatures();
 
     static void enableScalarLayoutFeatures();
@@ -100,6 +118,8 @@ namespace VulkanCore {
 
     static void enableIndependentBlending();
 
+    static void enableClipDistanceFeature();
+
     static void enableMaintenance4Feature();
 
     static void enableSynchronization2Feature();
@@ -115,12 +135,44 @@ namespace VulkanCore {
 
     static void enableFragmentDensityMapOffsetFeatures();
 
+    // Takes effect only where PhysicalDevice::isDeviceGeneratedCommandsSupported()
+    static void enableDeviceGeneratedCommandsFeature();
+
+    bool isDeviceGeneratedCommandsEnabled() const {
+      return physicalDevice_.isDeviceGeneratedCommandsSupported() &&
+             deviceGeneratedCommandsFeatures_.deviceGeneratedCommands == VK_TRUE;
+    }
+
+    // Set by enableIndirectRenderingFeature(); draw counts above 1 need it
+    bool isMultiDrawIndirectEnabled() const {
+      return physicalDeviceFeatures_.multiDrawIndirect == VK_TRUE;
+    }
+
+    // Set by enableIndirectRenderingFeature(); indirect draws with a non-zero
+    // firstInstance need it
+    bool isDrawIndirectFirstInstanceEnabled() const {
+      return physicalDeviceFeatures_.drawIndirectFirstInstance == VK_TRUE;
+    }
+
+    bool isClipDistanceEnabled() const {
+      return physicalDeviceFeatures_.shaderClipDistance == VK_TRUE;
+    }
+
     VkDevice device() const { return device_; }
 
     VkInstance instance() const { return instance_; }
 
     [[nodiscard]] inline VmaAllocator memoryAllocator() const { return allocator_; }
 
+    // Device-wide deferred destruction used by RHI object destructors
+    DeletionQueue& deletionQueue() const { return *deletionQueue_; }
+
+    // Recycled fences and binary semaphores; prefer these over creating sync
+    // objects for per-frame or per-upload work
+    FencePool& fencePool() const { return *fencePool_; }
+
+    SemaphorePool& semaphorePool() const { return *semaphorePool_; }
+
     const PhysicalDevice& physicalDevice() const;
 
     void createSwapchain(
@@ -134,6 +186,11 @@ namespace VulkanCore {
 
     VkQueue graphicsQueue(int index = 0) const { return graphicsQueues_[index]; }
 
+    // vkQueueSubmit and vkQueuePresentKHR need their queue externally
+    // synchronized. Everything that submits through VulkanCore holds this
+    // mutex, so command queues sharing a VkQueue can live on different threads.
+    std::mutex& queueMutex(VkQueue queue) const;
+
     std::shared_ptr<Buffer> createBuffer(
         size_t size,
         VkBufferUsageFlags flags,
@@ -153,6 +210,11 @@ namespace VulkanCore {
         const std::string& name = ""
     ) const;
 
+    // Host-cached transfer destination for GPU -> CPU copies; call
+    // Buffer::invalidate() before reading it
+    std::shared_ptr<Buffer> createReadbackBuffer(VkDeviceSize size, const std::string& name = "")
+        const;
+
     std::shared_ptr<Buffer> createStagingBuffer(
         VkDeviceSize size,
         VkBufferUsageFlags usage,
@@ -254,6 +316,17 @@ namespace VulkanCore {
         int transferQueueIndex = -1
     );
 
+    // Uses the dedicated compute family when the device has one, otherwise
+    // falls back to the graphics queue
+    CommandQueueManager createComputeCommandQueue(
+        uint32_t count,
+        uint32_t concurrentNumCommands,
+        const std::string& name,
+        int computeQueueIndex = -1
+    );
+
+    bool hasDedicatedComputeQueue() const { return !computeQueues_.empty(); }
+
     std::shared_ptr<RenderPass> createRenderPass(
         const std::vector<std::shared_ptr<Texture>>& attachments,
         const std::vector<VkAttachmentLoadOp>& loadOp,
@@ -309,9 +382,41 @@ namespace VulkanCore {
 
     void endDebugUtilsLabel(VkCommandBuffer commandBuffer) const;
 
+    // Records every RHI object created from now on, and the commands that use
+    // them, into filePath for konstrukt_replay. Call right after the device is
+    // created; earlier objects are unknown to the capture.
+    //
+    // Starting and stopping swap volk's process-global entry points, so both
+    // drain the submission thread and wait for the device to go idle, and no
+    // other thread may record, submit or create objects while they run.
+    void beginCommandCapture(const std::string& filePath);
+
+    // Stops intercepting and writes the remainder of the capture
+    void endCommandCapture();
+
+    CommandCapture* commandCapture() const { return commandCapture_.get(); }
+
+    // Hands every CommandQueueManager submit and swapchain present to a
+    // dedicated thread from now on, so recording threads don't wait on the
+    // driver. Start it before the first submit.
+    void startSubmissionThread();
+
+    // Issues whatever is still queued and joins the thread
+    void stopSubmissionThread();
+
+    SubmissionThread* submissionThread() const { return submissionThread_.get(); }
+
   private:
     void createMemoryAllocator();
 
+    void createQueueMutexes();
+
+    void createSyncObjectPools();
+
+    // Drains the submission thread and waits for the device before the
+    // capture hooks are swapped
+    void waitIdleForCapture() const;
+
     [[nodiscard]] static std::vector<std::string>
     enumerateInstanceLayers(bool printEnumerations_ = false);
 
@@ -356,6 +461,8 @@ namespace VulkanCore {
     static VkPhysicalDeviceMultiviewFeatures multiviewFeatures_;
     static VkPhysicalDeviceFragmentDensityMapFeaturesEXT fragmentDensityMapFeatures_;
     static VkPhysicalDeviceFragmentDensityMapOffsetFeaturesQCOM fragmentDensityMapOffsetFeatures_;
+    static VkPhysicalDeviceDeviceGeneratedCommandsFeaturesEXT deviceGeneratedCommandsFeatures_;
+    static VkPhysicalDeviceMaintenance5FeaturesKHR maintenance5Features_;
 
     // these are extra queues which can be used for any other async stuff if
     // required, these won't contain above queues
@@ -363,8 +470,16 @@ namespace VulkanCore {
     std::vector<VkQueue> computeQueues_;
     std::vector<VkQueue> transferQueues_;
     std::vector<VkQueue> sparseQueues_;
+    // Filled when the device is created and read-only afterwards, so lookups
+    // need no lock of their own
+    std::unordered_map<VkQueue, std::unique_ptr<std::mutex>> queueMutexes_;
 
+    std::unique_ptr<DeletionQueue> deletionQueue_ = std::make_unique<DeletionQueue>();
+    std::unique_ptr<FencePool> fencePool_;
+    std::unique_ptr<SemaphorePool> semaphorePool_;
     std::unique_ptr<Swapchain> swapchain_;
+    std::unique_ptr<CommandCapture> commandCapture_;
+    std::unique_ptr<SubmissionThread> submissionThread_;
     std::unordered_set<std::string> enabledLayers_;
     std::unordered_set<std::string> enabledInstanceExtensions_;
 #if defined(VK_EXT_debug_utils)
@@ -0,0 +1,132 @@
+#include "DeletionQueue.hpp"
+
+#include <algorithm>
+#include <iterator>
+
+#include <tracy/Tracy.hpp>
+
+namespace VulkanCore {
+
+  DeletionQueue::~DeletionQueue() {
+    // The owner flushes while the device is still alive; a deleter run here
+    // would call into a destroyed device or allocator
+    ASSERT(pendingCount() == 0, "Flush the deletion queue before destroying the device");
+  }
+
+  std::shared_ptr<QueueTimeline> DeletionQueue::registerQueue() {
+    auto timeline = std::make_shared<QueueTimeline>();
+    std::unique_lock lock(timelinesMutex_);
+    timelines_.push_back(timeline);
+    return timeline;
+  }
+
+  void DeletionQueue::enqueue(std::function<void()>&& deleter) {
+    Entry entry{.deleter = std::move(deleter)};
+    {
+      std::shared_lock lock(timelinesMutex_);
+      entry.lastUse.reserve(timelines_.size());
+      for (const auto& weakTimeline : timelines_) {
+        const auto timeline = weakTimeline.lock();
+        entry.lastUse.push_back(timeline ? timeline->lastUseValue() : 0);
+      }
+    }
+
+    auto& shard = shards_[util::threadShard(kShardCount)];
+    std::unique_lock<std::mutex> lock(shard.mutex);
+    shard.entries.push_back(std::move(entry));
+  }
+
+  bool DeletionQueue::isRetired(const Entry& entry) const {
+    for (size_t i = 0; i < entry.lastUse.size(); ++i) {
+      const auto timeline = timelines_[i].lock();
+      if (timeline && timeline->completed.load(std::memory_order_acquire) < entry.lastUse[i]) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  void DeletionQueue::collect() {
+    ZoneScopedN("DeletionQueue: collect");
+
+    // Tags only grow per queue, so retired entries almost always form a prefix
+    // of each shard; a thread preempted between tagging and pushing can only
+    // delay its neighbours. Deleters run outside the locks since they may
+    // release further objects.
+    std::vector<std::function<void()>> retired;
+    bool hasExpired = false;
+    {
+      std::shared_lock timelinesLock(timelinesMutex_);
+      for (auto& shard : shards_) {
+        std::unique_lock<std::mutex> lock(shard.mutex);
+        while (!shard.entries.empty() && isRetired(shard.entries.front())) {
+          retired.push_back(std::move(shard.entries.front().deleter));
+          shard.entries.pop_front();
+        }
+      }
+      hasExpired = std::any_of(timelines_.begin(), timelines_.end(), [](const auto& timeline) {
+        return timeline.expired();
+      });
+    }
+    if (hasExpired) {
+      pruneExpiredTimelines();
+    }
+
+    for (auto& deleter : retired) {
+      deleter();
+    }
+  }
+
+  void DeletionQueue::flush() {
+    ZoneScopedN("DeletionQueue: flush");
+
+    // Deleters can release objects that enqueue again, so drain until empty.
+    std::deque<Entry> entries;
+    while (true) {
+      for (auto& shard : shards_) {
+        std::unique_lock<std::mutex> lock(shard.mutex);
+        std::move(shard.entries.begin(), shard.entries.end(), std::back_inserter(entries));
+        shard.entries.clear();
+      }
+      if (entries.empty()) {
+        pruneExpiredTimelines();
+        return;
+      }
+
+      for (auto& entry : entries) {
+        entry.deleter();
+      }
+      entries.clear();
+    }
+  }
+
+  void DeletionQueue::pruneExpiredTimelines() {
+    std::unique_lock timelinesLock(timelinesMutex_);
+    // Walk backwards so erasing a slot doesn't shift the ones still to visit
+    for (size_t i = timelines_.size(); i-- > 0;) {
+      if (!timelines_[i].expired()) {
+        continue;
+      }
+      // Entries tagged before the queue registered have no slot for it
+      for (auto& shard : shards_) {
+        std::unique_lock<std::mutex> lock(shard.mutex);
+        for (auto& entry : shard.entries) {
+          if (i < entry.lastUse.size()) {
+            entry.lastUse.erase(entry.lastUse.begin() + static_cast<ptrdiff_t>(i));
+          }
+        }
+      }
+      timelines_.erase(timelines_.begin() + static_cast<ptrdiff_t>(i));
+    }
+  }
+
+  size_t DeletionQueue::pendingCount() const {
+    size_t count = 0;
+    for (const auto& shard : shards_) {
+      std::unique_lock<std::mutex> lock(shard.mutex);
+      count += shard.entries.size();
+    }
+    return count;
+  }
+
+} // namespace VulkanCore
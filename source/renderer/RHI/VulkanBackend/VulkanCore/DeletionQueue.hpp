@@ -0,0 +1,85 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <vector>
+
+#include "Utility.hpp"
+
+namespace VulkanCore {
+
+  // Submit progress of one queue, shared between its CommandQueueManager and
+  // the DeletionQueue so the manager can be moved or destroyed freely.
+  struct QueueTimeline {
+    std::atomic<uint64_t> submitted{0};
+    std::atomic<uint64_t> completed{0};
+    std::atomic<bool> recording{false};
+
+    // Value that has to retire before anything referenced so far is unused:
+    // the submit being recorded, or the last one if the queue is idle.
+    uint64_t lastUseValue() const {
+      const uint64_t value = submitted.load(std::memory_order_acquire);
+      return recording.load(std::memory_order_acquire) ? value + 1 : value;
+    }
+  };
+
+  // Device-wide deferred destruction. RHI objects hand their vkDestroy* calls
+  // to enqueue(), which tags them with the last-use value of every registered
+  // queue; collect() runs them in batches once all of those values have
+  // retired. Safe to call from any thread; entries are sharded by thread so
+  // loader threads releasing objects concurrently rarely share a lock.
+  class DeletionQueue final {
+  public:
+    DeletionQueue() = default;
+    ~DeletionQueue();
+
+    DeletionQueue(const DeletionQueue&)            = delete;
+    DeletionQueue& operator=(const DeletionQueue&) = delete;
+
+    // Queues hold on to the returned timeline; once it expires the queue is
+    // treated as fully retired
+    std::shared_ptr<QueueTimeline> registerQueue();
+
+    void enqueue(std::function<void()>&& deleter);
+
+    // Runs every deleter whose queues have retired its tag
+    void collect();
+
+    // Runs everything; only valid once the device is idle. The queue has to
+    // be empty by the time it is destroyed.
+    void flush();
+
+    size_t pendingCount() const;
+
+  private:
+    struct Entry {
+      std::vector<uint64_t> lastUse; // indexed like timelines_
+      std::function<void()> deleter;
+    };
+
+    struct alignas(64) Shard {
+      mutable std::mutex mutex;
+      std::deque<Entry> entries;
+    };
+
+    static constexpr size_t kShardCount = 8;
+
+    // Expects timelinesMutex_ to be held, shared or exclusive
+    bool isRetired(const Entry& entry) const;
+
+    // Drops the timelines of destroyed queues along with their slot in every
+    // entry's lastUse
+    void pruneExpiredTimelines();
+
+    mutable std::shared_mutex timelinesMutex_;
+    std::vector<std::weak_ptr<QueueTimeline>> timelines_;
+    std::array<Shard, kShardCount> shards_;
+  };
+
+} // namespace VulkanCore
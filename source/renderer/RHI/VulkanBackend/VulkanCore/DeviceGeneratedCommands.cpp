@@ -0,0 +1,537 @@
+#include "DeviceGeneratedCommands.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <numeric>
+#include <tracy/Tracy.hpp>
+
+#include "Buffer.hpp"
+#include "Context.hpp"
+#include "Pipeline.hpp"
+#include "core/Metrics.hpp"
+
+namespace VulkanCore {
+
+  namespace {
+    constexpr uint32_t alignUp(uint32_t value, uint32_t alignment) {
+      return (value + alignment - 1) & ~(alignment - 1);
+    }
+
+    GeneratedDrawStreamLayout makeStreamLayout(const GeneratedDrawsDescriptor& desc) {
+      GeneratedDrawStreamLayout layout;
+      uint32_t offset       = sizeof(uint32_t);
+      layout.pipelineOffset = 0;
+      if (desc.pushConstants.size > 0) {
+        layout.pushConstantOffset = offset;
+        offset += desc.pushConstants.size;
+      }
+      // Buffer addresses are 64-bit
+      offset = alignUp(offset, 8);
+      if (desc.perDrawIndexBuffer) {
+        layout.indexBufferOffset = offset;
+        offset += sizeof(VkBindIndexBufferIndirectCommandEXT);
+      }
+      if (desc.perDrawVertexBuffer) {
+        layout.vertexBufferOffset = offset;
+        offset += sizeof(VkBindVertexBufferIndirectCommandEXT);
+      }
+      layout.drawOffset = offset;
+      offset += desc.indexed ? sizeof(VkDrawIndexedIndirectCommand) : sizeof(VkDrawIndirectCommand);
+      layout.stride = alignUp(offset, 8);
+      return layout;
+    }
+  } // namespace
+
+  DeviceGeneratedDraws::DeviceGeneratedDraws(
+      const Context& context,
+      const GeneratedDrawsDescriptor& desc,
+      const std::string& name
+  )
+      : context_(&context),
+        device_(context.device()),
+        desc_(desc),
+        streamLayout_(makeStreamLayout(desc)) {
+    ASSERT(!desc_.pipelines.empty(), "Generated draws need at least one pipeline");
+    ASSERT(desc_.maxSequences > 0, "Generated draws need a non-zero sequence count");
+    ASSERT(desc_.framesInFlight > 0, "Generated draws need at least one frame in flight");
+
+    auto& metrics = kst::core::MetricsRegistry::instance();
+
+    const auto& properties = context.physicalDevice().deviceGeneratedCommandsProperties();
+    const bool allBindable = std::all_of(
+        desc_.pipelines.begin(),
+        desc_.pipelines.end(),
+        [](const auto& pipeline) { return pipeline->isIndirectBindable(); }
+    );
+    const bool useExtension =
+        context.isDeviceGeneratedCommandsEnabled() && allBindable &&
+        desc_.pipelines.size() <= properties.maxIndirectPipelineCount &&
+        desc_.maxSequences <= properties.maxIndirectSequenceCount &&
+        streamLayout_.stride <= properties.maxIndirectCommandsIndirectStride &&
+        (properties.supportedIndirectCommandsShaderStagesPipelineBinding & shaderStages_) ==
+            shaderStages_;
+
+    const VkDeviceSize fallbackStride =
+        desc_.indexed ? sizeof(VkDrawIndexedIndirectCommand) : sizeof(VkDrawIndirectCommand);
+    slotBytes_  = VkDeviceSize(desc_.maxSequences) *
+                 (useExtension ? VkDeviceSize(streamLayout_.stride) : fallbackStride);
+    hostStream_ = context.createPersistentBuffer(
+        slotBytes_ * desc_.framesInFlight,
+        VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT |
+            (useExtension ? VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT : 0),
+        "Generated draws: " + name
+    );
+
+    if (useExtension) {
+      createExtensionObjects(name);
+      hostStreamAddress_ = hostStream_->vkDeviceAddress();
+    }
+
+    const std::string labels = useExtension ? "path=\"device\"" : "path=\"cpu\"";
+    drawCounter_             = &metrics.counter(
+        "kst_generated_draws_total", "Draws recorded through DeviceGeneratedDraws", labels
+    );
+    callCounter_ = &metrics.counter(
+        "kst_generated_draw_calls_total",
+        "Draw and execute calls DeviceGeneratedDraws recorded for those draws",
+        labels
+    );
+  }
+
+  DeviceGeneratedDraws::~DeviceGeneratedDraws() {
+    if (!usesExtension()) {
+      return;
+    }
+    context_->deletionQueue().enqueue(
+        [device = device_, executionSet = executionSet_, commandsLayout = commandsLayout_]() {
+          vkDestroyIndirectCommandsLayoutEXT(device, commandsLayout, nullptr);
+          vkDestroyIndirectExecutionSetEXT(device, executionSet, nullptr);
+        }
+    );
+  }
+
+  void DeviceGeneratedDraws::createExtensionObjects(const std::string& name) {
+    const VkIndirectExecutionSetPipelineInfoEXT pipelineInfo = {
+        .sType            = VK_STRUCTURE_TYPE_INDIRECT_EXECUTION_SET_PIPELINE_INFO_EXT,
+        .initialPipeline  = desc_.pipelines.front()->vkPipeline(),
+        .maxPipelineCount = static_cast<uint32_t>(desc_.pipelines.size()),
+    };
+    const VkIndirectExecutionSetCreateInfoEXT setInfo = {
+        .sType = VK_STRUCTURE_TYPE_INDIRECT_EXECUTION_SET_CREATE_INFO_EXT,
+        .type  = VK_INDIRECT_EXECUTION_SET_INFO_TYPE_PIPELINES_EXT,
+        .info  = {.pPipelineInfo = &pipelineInfo},
+    };
+    VK_CHECK(vkCreateIndirectExecutionSetEXT(device_, &setInfo, nullptr, &executionSet_));
+    context_->setVkObjectname(
+        executionSet_, VK_OBJECT_TYPE_INDIRECT_EXECUTION_SET_EXT, "Execution set: " + name
+    );
+
+    // The initial pipeline already sits at index 0
+    std::vector<VkWriteIndirectExecutionSetPipelineEXT> writes;
+    for (uint32_t index = 1; index < desc_.pipelines.size(); ++index) {
+      writes.push_back({
+          .sType    = VK_STRUCTURE_TYPE_WRITE_INDIRECT_EXECUTION_SET_PIPELINE_EXT,
+          .index    = index,
+          .pipeline = desc_.pipelines[index]->vkPipeline(),
+      });
+    }
+    if (!writes.empty()) {
+      vkUpdateIndirectExecutionSetPipelineEXT(
+          device_, executionSet_, static_cast<uint32_t>(writes.size()), writes.data()
+      );
+    }
+
+    // Tokens in stream order: execution set first, the draw last
+    const VkIndirectCommandsExecutionSetTokenEXT executionSetToken = {
+        .type         = VK_INDIRECT_EXECUTION_SET_INFO_TYPE_PIPELINES_EXT,
+        .shaderStages = shaderStages_,
+    };
+    const VkIndirectCommandsPushConstantTokenEXT pushConstantToken = {
+        .updateRange = desc_.pushConstants,
+    };
+    const VkIndirectCommandsIndexBufferTokenEXT indexBufferToken = {
+        .mode = VK_INDIRECT_COMMANDS_INPUT_MODE_VULKAN_INDEX_BUFFER_EXT,
+    };
+    const VkIndirectCommandsVertexBufferTokenEXT vertexBufferToken = {
+        .vertexBindingUnit = 0,
+    };
+
+    std::vector<VkIndirectCommandsLayoutTokenEXT> tokens;
+    tokens.push_back({
+        .sType  = VK_STRUCTURE_TYPE_INDIRECT_COMMANDS_LAYOUT_TOKEN_EXT,
+        .type   = VK_INDIRECT_COMMANDS_TOKEN_TYPE_EXECUTION_SET_EXT,
+        .data   = {.pExecutionSet = &executionSetToken},
+        .offset = streamLayout_.pipelineOffset,
+    });
+    if (desc_.pushConstants.size > 0) {
+      tokens.push_back({
+          .sType  = VK_STRUCTURE_TYPE_INDIRECT_COMMANDS_LAYOUT_TOKEN_EXT,
+          .type   = VK_INDIRECT_COMMANDS_TOKEN_TYPE_PUSH_CONSTANT_EXT,
+          .data   = {.pPushConstant = &pushConstantToken},
+          .offset = streamLayout_.pushConstantOffset,
+      });
+    }
+    if (desc_.perDrawIndexBuffer) {
+      tokens.push_back({
+          .sType  = VK_STRUCTURE_TYPE_INDIRECT_COMMANDS_LAYOUT_TOKEN_EXT,
+          .type   = VK_INDIRECT_COMMANDS_TOKEN_TYPE_INDEX_BUFFER_EXT,
+          .data   = {.pIndexBuffer = &indexBufferToken},
+          .offset = streamLayout_.indexBufferOffset,
+      });
+    }
+    if (desc_.perDrawVertexBuffer) {
+      tokens.push_back({
+          .sType  = VK_STRUCTURE_TYPE_INDIRECT_COMMANDS_LAYOUT_TOKEN_EXT,
+          .type   = VK_INDIRECT_COMMANDS_TOKEN_TYPE_VERTEX_BUFFER_EXT,
+          .data   = {.pVertexBuffer = &vertexBufferToken},
+          .offset = streamLayout_.vertexBufferOffset,
+      });
+    }
+    tokens.push_back({
+        .sType  = VK_STRUCTURE_TYPE_INDIRECT_COMMANDS_LAYOUT_TOKEN_EXT,
+        .type   = desc_.indexed ? VK_INDIRECT_COMMANDS_TOKEN_TYPE_DRAW_INDEXED_EXT
+                                : VK_INDIRECT_COMMANDS_TOKEN_TYPE_DRAW_EXT,
+        .offset = streamLayout_.drawOffset,
+    });
+
+    const VkIndirectCommandsLayoutCreateInfoEXT layoutInfo = {
+        .sType          = VK_STRUCTURE_TYPE_INDIRECT_COMMANDS_LAYOUT_CREATE_INFO_EXT,
+        .shaderStages   = shaderStages_,
+        .indirectStride = streamLayout_.stride,
+        .pipelineLayout = desc_.pipelines.front()->vkPipelineLayout(),
+        .tokenCount     = static_cast<uint32_t>(tokens.size()),
+        .pTokens        = tokens.data(),
+    };
+    VK_CHECK(vkCreateIndirectCommandsLayoutEXT(device_, &layoutInfo, nullptr, &commandsLayout_));
+    context_->setVkObjectname(
+        commandsLayout_,
+        VK_OBJECT_TYPE_INDIRECT_COMMANDS_LAYOUT_EXT,
+        "Indirect commands layout: " + name
+    );
+
+    const VkGeneratedCommandsMemoryRequirementsInfoEXT requirementsInfo = {
+        .sType                  = VK_STRUCTURE_TYPE_GENERATED_COMMANDS_MEMORY_REQUIREMENTS_INFO_EXT,
+        .indirectExecutionSet   = executionSet_,
+        .indirectCommandsLayout = commandsLayout_,
+        .maxSequenceCount       = desc_.maxSequences,
+        .maxDrawCount           = 0,
+    };
+    VkMemoryRequirements2 requirements = {.sType = VK_STRUCTURE_TYPE_MEMORY_REQUIREMENTS_2};
+    vkGetGeneratedCommandsMemoryRequirementsEXT(device_, &requirementsInfo, &requirements);
+
+    const VkDeviceSize alignment =
+        std::max<VkDeviceSize>(requirements.memoryRequirements.alignment, 1);
+    preprocessSize_ =
+        (requirements.memoryRequirements.size + alignment - 1) / alignment * alignment;
+    if (preprocessSize_ == 0) {
+      return;
+    }
+
+    // The preprocess usage bit only exists as a VkBufferUsageFlags2 bit
+    const VkBufferUsageFlags2CreateInfoKHR usage2 = {
+        .sType = VK_STRUCTURE_TYPE_BUFFER_USAGE_FLAGS_2_CREATE_INFO_KHR,
+        .usage = VK_BUFFER_USAGE_2_PREPROCESS_BUFFER_BIT_EXT |
+                 VK_BUFFER_USAGE_2_SHADER_DEVICE_ADDRESS_BIT_KHR,
+    };
+    preprocessBuffer_ = std::make_shared<Buffer>(
+        context_,
+        context_->memoryAllocator(),
+        VkBufferCreateInfo{
+            .sType       = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+            .pNext       = &usage2,
+            .size        = preprocessSize_ * desc_.framesInFlight,
+            .usage       = VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT,
+            .sharingMode = VK_SHARING_MODE_EXCLUSIVE,
+        },
+        VmaAllocationCreateInfo{
+            .usage = VMA_MEMORY_USAGE_GPU_ONLY,
+        },
+        "Generated commands preprocess: " + name
+    );
+    preprocessAddress_ = preprocessBuffer_->vkDeviceAddress();
+  }
+
+  void DeviceGeneratedDraws::addDraw(const GeneratedDraw& draw, const void* pushConstants) {
+    ASSERT(draw.pipeline < desc_.pipelines.size(), "Generated draw selects an unknown pipeline");
+    ASSERT(
+        !desc_.perDrawVertexBuffer || draw.vertexBuffer, "Generated draw lacks its vertex buffer"
+    );
+    ASSERT(!desc_.perDrawIndexBuffer || draw.indexBuffer, "Generated draw lacks its index buffer");
+    ASSERT(
+        desc_.pushConstants.size == 0 || pushConstants,
+        "Generated draw lacks its push constants"
+    );
+    ASSERT(draws_.size() < desc_.maxSequences, "More generated draws than maxSequences");
+
+    draws_.push_back(draw);
+    if (desc_.pushConstants.size > 0) {
+      const auto* bytes = static_cast<const uint8_t*>(pushConstants);
+      pushConstantData_.insert(pushConstantData_.end(), bytes, bytes + desc_.pushConstants.size);
+    }
+  }
+
+  void DeviceGeneratedDraws::record(VkCommandBuffer commandBuffer, uint32_t slot) {
+    ZoneScopedN("GeneratedDraws: record");
+    ASSERT(slot < desc_.framesInFlight, "Frame-in-flight slot out of range");
+    if (draws_.empty()) {
+      return;
+    }
+
+    if (usesExtension()) {
+      writeSequences(slot);
+      executeStream(
+          commandBuffer,
+          hostStreamAddress_ + slot * slotBytes_,
+          static_cast<uint32_t>(draws_.size()),
+          0,
+          slot
+      );
+    } else {
+      recordBuckets(commandBuffer, slot);
+    }
+
+    drawCounter_->add(draws_.size());
+    draws_.clear();
+    pushConstantData_.clear();
+  }
+
+  void DeviceGeneratedDraws::execute(
+      VkCommandBuffer commandBuffer,
+      const Buffer& stream,
+      uint32_t maxSequences,
+      const Buffer* countBuffer,
+      uint32_t slot
+  ) {
+    ASSERT(usesExtension(), "GPU-written streams need VK_EXT_device_generated_commands");
+    ASSERT(maxSequences <= desc_.maxSequences, "More sequences than the preprocess buffer holds");
+    ASSERT(slot < desc_.framesInFlight, "Frame-in-flight slot out of range");
+    executeStream(
+        commandBuffer,
+        stream.vkDeviceAddress(),
+        maxSequences,
+        countBuffer ? countBuffer->vkDeviceAddress() : 0,
+        slot
+    );
+  }
+
+  void DeviceGeneratedDraws::streamBarrier(VkCommandBuffer commandBuffer) {
+    const VkMemoryBarrier barrier = {
+        .sType         = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+        .srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT,
+        .dstAccessMask = VK_ACCESS_INDIRECT_COMMAND_READ_BIT |
+                         VK_ACCESS_COMMAND_PREPROCESS_READ_BIT_EXT,
+    };
+    vkCmdPipelineBarrier(
+        commandBuffer,
+        VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+        VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_COMMAND_PREPROCESS_BIT_EXT,
+        0,
+        1,
+        &barrier,
+        0,
+        nullptr,
+        0,
+        nullptr
+    );
+  }
+
+  void DeviceGeneratedDraws::executeStream(
+      VkCommandBuffer commandBuffer,
+      VkDeviceAddress stream,
+      uint32_t sequences,
+      VkDeviceAddress countAddress,
+      uint32_t slot
+  ) {
+    // The execution set switches away from this as the stream dictates
+    desc_.pipelines.front()->bind(commandBuffer);
+
+    const VkGeneratedCommandsInfoEXT info = {
+        .sType                  = VK_STRUCTURE_TYPE_GENERATED_COMMANDS_INFO_EXT,
+        .shaderStages           = shaderStages_,
+        .indirectExecutionSet   = executionSet_,
+        .indirectCommandsLayout = commandsLayout_,
+        .indirectAddress        = stream,
+        .indirectAddressSize    = VkDeviceSize(sequences) * streamLayout_.stride,
+        .preprocessAddress      = preprocessSize_ > 0 ? preprocessAddress_ + slot * preprocessSize_
+                                                      : 0,
+        .preprocessSize         = preprocessSize_,
+        .maxSequenceCount       = sequences,
+        .sequenceCountAddress   = countAddress,
+        .maxDrawCount           = 0,
+    };
+    vkCmdExecuteGeneratedCommandsEXT(commandBuffer, VK_FALSE, &info);
+    callCounter_->add();
+  }
+
+  void DeviceGeneratedDraws::writeSequences(uint32_t slot) {
+    auto* base = static_cast<uint8_t*>(hostStream_->map()) + slot * slotBytes_;
+
+    for (size_t i = 0; i < draws_.size(); ++i) {
+      const auto& draw = draws_[i];
+      uint8_t* sequence = base + i * streamLayout_.stride;
+
+      std::memcpy(sequence + streamLayout_.pipelineOffset, &draw.pipeline, sizeof(uint32_t));
+      if (desc_.pushConstants.size > 0) {
+        std::memcpy(
+            sequence + streamLayout_.pushConstantOffset,
+            pushConstantsOf(i),
+            desc_.pushConstants.size
+        );
+      }
+      if (desc_.perDrawIndexBuffer) {
+        const VkBindIndexBufferIndirectCommandEXT command = {
+            .bufferAddress = draw.indexBuffer->vkDeviceAddress(),
+            .size          = static_cast<uint32_t>(draw.indexBuffer->size()),
+            .indexType     = draw.indexType,
+        };
+        std::memcpy(sequence + streamLayout_.indexBufferOffset, &command, sizeof(command));
+      }
+      if (desc_.perDrawVertexBuffer) {
+        const VkBindVertexBufferIndirectCommandEXT command = {
+            .bufferAddress = draw.vertexBuffer->vkDeviceAddress(),
+            .size          = static_cast<uint32_t>(draw.vertexBuffer->size()),
+            .stride        = draw.vertexStride,
+        };
+        std::memcpy(sequence + streamLayout_.vertexBufferOffset, &command, sizeof(command));
+      }
+      if (desc_.indexed) {
+        std::memcpy(sequence + streamLayout_.drawOffset, &draw.draw, sizeof(draw.draw));
+      } else {
+        const VkDrawIndirectCommand command = {
+            .vertexCount   = draw.draw.indexCount,
+            .instanceCount = draw.draw.instanceCount,
+            .firstVertex   = draw.draw.firstIndex,
+            .firstInstance = draw.draw.firstInstance,
+        };
+        std::memcpy(sequence + streamLayout_.drawOffset, &command, sizeof(command));
+      }
+    }
+  }
+
+  void DeviceGeneratedDraws::recordBuckets(VkCommandBuffer commandBuffer, uint32_t slot) {
+    const size_t count = draws_.size();
+    order_.resize(count);
+    std::iota(order_.begin(), order_.end(), 0u);
+
+    // Stable, so draws keep their order within a bucket
+    std::stable_sort(order_.begin(), order_.end(), [this](uint32_t a, uint32_t b) {
+      const auto& lhs = draws_[a];
+      const auto& rhs = draws_[b];
+      if (lhs.pipeline != rhs.pipeline) {
+        return lhs.pipeline < rhs.pipeline;
+      }
+      if (lhs.indexBuffer != rhs.indexBuffer) {
+        return std::less<>()(lhs.indexBuffer, rhs.indexBuffer);
+      }
+      return std::less<>()(lhs.vertexBuffer, rhs.vertexBuffer);
+    });
+
+    const uint32_t pushConstantSize = desc_.pushConstants.size;
+    const auto sameState            = [&](uint32_t a, uint32_t b) {
+      const auto& lhs = draws_[a];
+      const auto& rhs = draws_[b];
+      return lhs.pipeline == rhs.pipeline && lhs.indexBuffer == rhs.indexBuffer &&
+             lhs.indexType == rhs.indexType && lhs.vertexBuffer == rhs.vertexBuffer &&
+             (pushConstantSize == 0 ||
+              std::memcmp(pushConstantsOf(a), pushConstantsOf(b), pushConstantSize) == 0);
+    };
+
+    const bool multiDraw = context_->isMultiDrawIndirectEnabled();
+    const VkDeviceSize commandSize =
+        desc_.indexed ? sizeof(VkDrawIndexedIndirectCommand) : sizeof(VkDrawIndirectCommand);
+    auto* commands = static_cast<uint8_t*>(hostStream_->map()) + slot * slotBytes_;
+    VkDeviceSize written = 0;
+
+    uint32_t calls = 0;
+    size_t first   = 0;
+    while (first < count) {
+      const auto& draw = draws_[order_[first]];
+      if (first == 0 || draw.pipeline != draws_[order_[first - 1]].pipeline) {
+        desc_.pipelines[draw.pipeline]->bind(commandBuffer);
+      }
+      if (desc_.perDrawIndexBuffer) {
+        vkCmdBindIndexBuffer(commandBuffer, draw.indexBuffer->vkBuffer(), 0, draw.indexType);
+      }
+      if (desc_.perDrawVertexBuffer) {
+        const VkBuffer vertexBuffer = draw.vertexBuffer->vkBuffer();
+        const VkDeviceSize offset   = 0;
+        vkCmdBindVertexBuffers(commandBuffer, 0, 1, &vertexBuffer, &offset);
+      }
+      if (pushConstantSize > 0) {
+        vkCmdPushConstants(
+            commandBuffer,
+            desc_.pipelines[draw.pipeline]->vkPipelineLayout(),
+            desc_.pushConstants.stageFlags,
+            desc_.pushConstants.offset,
+            pushConstantSize,
+            pushConstantsOf(order_[first])
+        );
+      }
+
+      size_t last = first + 1;
+      while (last < count && sameState(order_[first], order_[last])) {
+        ++last;
+      }
+      const auto run = static_cast<uint32_t>(last - first);
+
+      if (run == 1 || !multiDraw) {
+        for (size_t i = first; i < last; ++i) {
+          const auto& command = draws_[order_[i]].draw;
+          if (desc_.indexed) {
+            vkCmdDrawIndexed(
+                commandBuffer,
+                command.indexCount,
+                command.instanceCount,
+                command.firstIndex,
+                command.vertexOffset,
+                command.firstInstance
+            );
+          } else {
+            vkCmdDraw(
+                commandBuffer,
+                command.indexCount,
+                command.instanceCount,
+                command.firstIndex,
+                command.firstInstance
+            );
+          }
+          ++calls;
+        }
+      } else {
+        const VkDeviceSize offset = slot * slotBytes_ + written;
+        for (size_t i = first; i < last; ++i) {
+          const auto& command = draws_[order_[i]].draw;
+          if (desc_.indexed) {
+            std::memcpy(commands + written, &command, sizeof(command));
+          } else {
+            const VkDrawIndirectCommand indirect = {
+                .vertexCount   = command.indexCount,
+                .instanceCount = command.instanceCount,
+                .firstVertex   = command.firstIndex,
+                .firstInstance = command.firstInstance,
+            };
+            std::memcpy(commands + written, &indirect, sizeof(indirect));
+          }
+          written += commandSize;
+        }
+        if (desc_.indexed) {
+          vkCmdDrawIndexedIndirect(
+              commandBuffer, hostStream_->vkBuffer(), offset, run, uint32_t(commandSize)
+          );
+        } else {
+          vkCmdDrawIndirect(
+              commandBuffer, hostStream_->vkBuffer(), offset, run, uint32_t(commandSize)
+          );
+        }
+        ++calls;
+      }
+      first = last;
+    }
+    callCounter_->add(calls);
+  }
+
+  const uint8_t* DeviceGeneratedDraws::pushConstantsOf(size_t draw) const {
+    return pushConstantData_.data() + draw * desc_.pushConstants.size;
+  }
+
+} // namespace VulkanCore
@@ -0,0 +1,165 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "Common.hpp"
+#include "Utility.hpp"
+
+namespace kst::core {
+  class Counter;
+} // namespace kst::core
+
+namespace VulkanCore {
+
+  class Buffer;
+  class Context;
+  class Pipeline;
+
+  struct GeneratedDrawsDescriptor {
+    // Pipelines a draw selects by index. They must share one pipeline layout
+    // and be created with GraphicsPipelineDescriptor::indirectBindable.
+    std::vector<std::shared_ptr<Pipeline>> pipelines;
+    // Range rewritten by every draw; size 0 leaves push constants alone
+    VkPushConstantRange pushConstants = {};
+    // Per-draw vertex buffer (binding 0) and index buffer. Without them the
+    // buffers bound before record()/execute() stay in use.
+    bool perDrawVertexBuffer = false;
+    bool perDrawIndexBuffer  = false;
+    // vkCmdDrawIndexed rather than vkCmdDraw
+    bool indexed            = false;
+    uint32_t maxSequences   = 0;
+    uint32_t framesInFlight = 1;
+  };
+
+  // Byte offsets of one sequence in an indirect commands stream; a compute
+  // shader generating the stream writes sequences of this layout
+  struct GeneratedDrawStreamLayout {
+    uint32_t stride             = 0;
+    uint32_t pipelineOffset     = 0; // uint32_t index into the pipelines
+    uint32_t pushConstantOffset = 0; // the push constant range's bytes
+    uint32_t indexBufferOffset  = 0; // VkBindIndexBufferIndirectCommandEXT
+    uint32_t vertexBufferOffset = 0; // VkBindVertexBufferIndirectCommandEXT
+    uint32_t drawOffset         = 0; // VkDrawIndexedIndirectCommand or VkDrawIndirectCommand
+  };
+
+  // A draw added on the CPU. Non-indexed draws read indexCount, firstIndex
+  // and firstInstance as vertex count, first vertex and first instance.
+  struct GeneratedDraw {
+    uint32_t pipeline                 = 0;
+    const Buffer* vertexBuffer        = nullptr;
+    uint32_t vertexStride             = 0;
+    const Buffer* indexBuffer         = nullptr;
+    VkIndexType indexType             = VK_INDEX_TYPE_UINT32;
+    VkDrawIndexedIndirectCommand draw = {};
+  };
+
+  // Draws whose pipeline, push constants and vertex/index buffers change per
+  // draw, recorded without a CPU-side bind per material.
+  //
+  // With VK_EXT_device_generated_commands the pipelines go into an indirect
+  // execution set and every draw becomes one sequence of an indirect commands
+  // stream (see streamLayout()): the GPU switches pipelines itself and a whole
+  // material-heterogeneous pass is a single vkCmdExecuteGeneratedCommandsEXT.
+  // The stream may come from a compute shader (execute()) or from draws added
+  // on the CPU (addDraw() + record()).
+  //
+  // Without the extension record() buckets the CPU-side draws by pipeline,
+  // then by buffers and push constants, so each pipeline is bound once and
+  // runs of draws sharing all state collapse into one multi-draw indirect
+  // call. GPU-written streams need the extension; check usesExtension().
+  //
+  // Descriptor sets and dynamic state have to be bound before recording, with
+  // any of the pipelines' (identical) layouts.
+  class DeviceGeneratedDraws final {
+  public:
+    DeviceGeneratedDraws(
+        const Context& context,
+        const GeneratedDrawsDescriptor& desc,
+        const std::string& name
+    );
+
+    ~DeviceGeneratedDraws();
+
+    DeviceGeneratedDraws(const DeviceGeneratedDraws&)            = delete;
+    DeviceGeneratedDraws& operator=(const DeviceGeneratedDraws&) = delete;
+
+    bool usesExtension() const { return executionSet_ != VK_NULL_HANDLE; }
+
+    const GeneratedDrawStreamLayout& streamLayout() const { return streamLayout_; }
+
+    // pushConstants points at desc.pushConstants.size bytes, or is null when
+    // the range is empty
+    void addDraw(const GeneratedDraw& draw, const void* pushConstants = nullptr);
+
+    uint32_t pendingDraws() const { return static_cast<uint32_t>(draws_.size()); }
+
+    // Records the draws added since the last call and forgets them. slot is
+    // the frame in flight whose previous use of this object has retired.
+    void record(VkCommandBuffer commandBuffer, uint32_t slot);
+
+    // Executes a GPU-written stream of up to maxSequences sequences; the
+    // actual count is read from countBuffer when given. The stream needs
+    // INDIRECT_BUFFER and SHADER_DEVICE_ADDRESS usage, and the writes have to
+    // be made visible with streamBarrier() first.
+    void execute(
+        VkCommandBuffer commandBuffer,
+        const Buffer& stream,
+        uint32_t maxSequences,
+        const Buffer* countBuffer,
+        uint32_t slot
+    );
+
+    // Orders compute shader writes to a stream before the generated commands
+    // read it
+    static void streamBarrier(VkCommandBuffer commandBuffer);
+
+  private:
+    void createExtensionObjects(const std::string& name);
+
+    void executeStream(
+        VkCommandBuffer commandBuffer,
+        VkDeviceAddress stream,
+        uint32_t sequences,
+        VkDeviceAddress countAddress,
+        uint32_t slot
+    );
+
+    void recordBuckets(VkCommandBuffer commandBuffer, uint32_t slot);
+
+    void writeSequences(uint32_t slot);
+
+    const uint8_t* pushConstantsOf(size_t draw) const;
+
+  private:
+    const Context* context_ = nullptr;
+    VkDevice device_        = VK_NULL_HANDLE;
+    GeneratedDrawsDescriptor desc_;
+    GeneratedDrawStreamLayout streamLayout_;
+    VkShaderStageFlags shaderStages_ =
+        VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT;
+
+    // Extension path
+    VkIndirectExecutionSetEXT executionSet_     = VK_NULL_HANDLE;
+    VkIndirectCommandsLayoutEXT commandsLayout_ = VK_NULL_HANDLE;
+    VkDeviceSize preprocessSize_                = 0; // per slot
+    VkDeviceAddress preprocessAddress_          = 0;
+    std::shared_ptr<Buffer> preprocessBuffer_;
+    // Per-slot streams for CPU-added draws on the extension path, per-slot
+    // VkDraw*IndirectCommand arrays for the fallback
+    std::shared_ptr<Buffer> hostStream_;
+    VkDeviceAddress hostStreamAddress_ = 0;
+    VkDeviceSize slotBytes_            = 0;
+
+    std::vector<GeneratedDraw> draws_;
+    std::vector<uint8_t> pushConstantData_;
+    // Fallback scratch, kept to avoid reallocating every frame
+    std::vector<uint32_t> order_;
+
+    kst::core::Counter* drawCounter_ = nullptr;
+    kst::core::Counter* callCounter_ = nullptr;
+  };
+
+} // namespace VulkanCore
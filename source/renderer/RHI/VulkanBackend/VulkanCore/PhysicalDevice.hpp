@@ -34,6 +34,10 @@ class PhysicalDevice final {
   [[nodiscard]] std::optional<uint32_t> sparseFamilyIndex() const;
   [[nodiscard]] std::optional<uint32_t> presentationFamilyIndex() const;
 
+  [[nodiscard]] const std::vector<VkQueueFamilyProperties>& queueFamilyProperties() const {
+    return queueFamilyProperties_;
+  }
+
   [[nodiscard]] uint32_t graphicsFamilyCount() const { return graphicsQueueCount_; }
   [[nodiscard]] uint32_t computeFamilyCount() const { return computeQueueCount_; }
   [[nodiscard]] uint32_t transferFamilyCount() const { return transferQueueCount_; }
@@ -83,6 +87,21 @@ class PhysicalDevice final {
     return fragmentDensityMapOffsetFeature_.fragmentDensityMapOffset == VK_TRUE;
   }
 
+  // Needs VK_EXT_device_generated_commands and VK_KHR_maintenance5 among the
+  // requested extensions; the feature bits alone may be set by drivers that
+  // were not asked for the extension
+  bool isDeviceGeneratedCommandsSupported() const {
+    return deviceGeneratedCommandsFeature_.deviceGeneratedCommands == VK_TRUE &&
+           maintenance5Feature_.maintenance5 == VK_TRUE &&
+           enabledExtensions_.contains(VK_EXT_DEVICE_GENERATED_COMMANDS_EXTENSION_NAME) &&
+           enabledExtensions_.contains(VK_KHR_MAINTENANCE_5_EXTENSION_NAME);
+  }
+
+  const VkPhysicalDeviceDeviceGeneratedCommandsPropertiesEXT&
+  deviceGeneratedCommandsProperties() const {
+    return deviceGeneratedCommandsProperties_;
+  }
+
  private:
   void enumerateSurfaceFormats(VkSurfaceKHR surface);
   void enumerateSurfaceCapabilities(VkSurfaceKHR surface);
@@ -92,11 +111,16 @@ class PhysicalDevice final {
   VkPhysicalDevice physicalDevice_ = VK_NULL_HANDLE;
   std::vector<std::string> extensions_;
 
+  VkPhysicalDeviceDeviceGeneratedCommandsPropertiesEXT deviceGeneratedCommandsProperties_{
+      .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DEVICE_GENERATED_COMMANDS_PROPERTIES_EXT,
+      .pNext = nullptr,
+  };
+
   VkPhysicalDeviceFragmentDensityMapOffsetPropertiesQCOM
       fragmentDensityMapOffsetProperties_{
           .sType =
               VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FRAGMENT_DENSITY_MAP_OFFSET_PROPERTIES_QCOM,
-          .pNext = nullptr,
+          .pNext = &deviceGeneratedCommandsProperties_,
       };
 
   VkPhysicalDeviceFragmentDensityMapPropertiesEXT fragmentDensityMapProperties_{
@@ -115,11 +139,21 @@ class PhysicalDevice final {
   };
 
   // Features
+  VkPhysicalDeviceMaintenance5FeaturesKHR maintenance5Feature_ = {
+      .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MAINTENANCE_5_FEATURES_KHR,
+      .pNext = nullptr,
+  };
+
+  VkPhysicalDeviceDeviceGeneratedCommandsFeaturesEXT deviceGeneratedCommandsFeature_ = {
+      .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DEVICE_GENERATED_COMMANDS_FEATURES_EXT,
+      .pNext = &maintenance5Feature_,
+  };
+
   VkPhysicalDeviceFragmentDensityMapOffsetFeaturesQCOM fragmentDensityMapOffsetFeature_ =
       {
           .sType =
               VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FRAGMENT_DENSITY_MAP_OFFSET_FEATURES_QCOM,
-          .pNext = nullptr,
+          .pNext = &deviceGeneratedCommandsFeature_,
   };
 
   VkPhysicalDeviceFragmentDensityMapFeaturesEXT fragmentDensityMapFeature_ = {
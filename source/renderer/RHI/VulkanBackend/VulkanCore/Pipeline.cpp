@@ -1,14 +1,33 @@
 #include "Pipeline.hpp"
 
 #include "Buffer.hpp"
+#include "CommandCapture.hpp"
 #include "Context.hpp"
 #include "RenderPass.hpp"
 #include "Sampler.hpp"
 #include "Texture.hpp"
+#include "core/CVar.hpp"
+#include "core/Metrics.hpp"
 
 namespace VulkanCore {
 
-static constexpr int MAX_DESCRIPTOR_SETS = 4096 * 3;
+// Read when a pipeline creates its pool, so a change applies to pipelines
+// created afterwards
+static kst::core::CVar<uint32_t> maxDescriptorSets(
+    "rhi.maxDescriptorSets", 4096 * 3,
+    "Descriptor sets (and descriptors per binding) in each pipeline's pool", {}, 1, 1u << 20);
+
+namespace {
+void writeDescriptorSets(VkDevice device, const std::vector<VkWriteDescriptorSet>& writes,
+                         std::atomic<uint64_t>& generation) {
+  static auto& descriptorWrites = kst::core::MetricsRegistry::instance().counter(
+      "kst_descriptor_writes_total", "Descriptor set writes passed to vkUpdateDescriptorSets");
+  vkUpdateDescriptorSets(device, static_cast<uint32_t>(writes.size()), writes.data(), 0,
+                         nullptr);
+  descriptorWrites.add(writes.size());
+  generation.fetch_add(1, std::memory_order_release);
+}
+}  // namespace
 
 Pipeline::Pipeline(const Context* context, const GraphicsPipelineDescriptor& desc,
                    VkRenderPass renderPass, const std::string& name)
@@ -18,6 +37,10 @@ Pipeline::Pipeline(const Context* context, const GraphicsPipelineDescriptor& des
       vkRenderPass_(renderPass),
       name_{name} {
   createGraphicsPipeline();
+
+  if (auto* capture = context_->commandCapture()) {
+    capture->onPipelineCreated(vkPipeline_, vkPipelineLayout_, graphicsPipelineDesc_);
+  }
 }
 
 Pipeline::Pipeline(const Context* context, const ComputePipelineDescriptor& desc,
@@ -27,6 +50,10 @@ Pipeline::Pipeline(const Context* context, const ComputePipelineDescriptor& desc
       bindPoint_(VK_PIPELINE_BIND_POINT_COMPUTE),
       name_{name} {
   createComputePipeline();
+
+  if (auto* capture = context_->commandCapture()) {
+    capture->onPipelineCreated(vkPipeline_, vkPipelineLayout_, computePipelineDesc_);
+  }
 }
 
 Pipeline::Pipeline(const Context* context, const RayTracingPipelineDescriptor& desc,
@@ -39,15 +66,26 @@ Pipeline::Pipeline(const Context* context, const RayTracingPipelineDescriptor& d
 }
 
 Pipeline::~Pipeline() {
-  const auto device = context_->device();
-
-  vkDestroyPipeline(device, vkPipeline_, nullptr);
-  vkDestroyPipelineLayout(device, vkPipelineLayout_, nullptr);
-  vkDestroyDescriptorPool(device, vkDescriptorPool_, nullptr);
+  if (auto* capture = context_->commandCapture()) {
+    capture->onDestroyed(CaptureObject::Pipeline, (uint64_t)vkPipeline_);
+  }
 
+  std::vector<VkDescriptorSetLayout> setLayouts;
   for (const auto& set : descriptorSets_) {
-    vkDestroyDescriptorSetLayout(device, set.second.vkLayout_, nullptr);
+    setLayouts.push_back(set.second.vkLayout_);
   }
+
+  // Descriptor sets die with the pool, so they are covered as well.
+  context_->deletionQueue().enqueue(
+      [device = context_->device(), pipeline = vkPipeline_, layout = vkPipelineLayout_,
+       pool = vkDescriptorPool_, setLayouts = std::move(setLayouts)]() {
+        vkDestroyPipeline(device, pipeline, nullptr);
+        vkDestroyPipelineLayout(device, layout, nullptr);
+        vkDestroyDescriptorPool(device, pool, nullptr);
+        for (const auto setLayout : setLayouts) {
+          vkDestroyDescriptorSetLayout(device, setLayout, nullptr);
+        }
+      });
 }
 
 VkPipeline Pipeline::vkPipeline() const { return vkPipeline_; }
@@ -81,22 +119,40 @@ void Pipeline::allocateDescriptors(const std::vector<SetAndCount>& setAndCount)
         .pSetLayouts = &descriptorSets_[set.set_].vkLayout_,
     };
 
+    auto& vkSets = descriptorSets_[set.set_].vkSets_;
+    const auto firstIndex = static_cast<uint32_t>(vkSets.size());
     for (size_t i = 0; i < set.count_; ++i) {
       VkDescriptorSet descriptorSet{VK_NULL_HANDLE};
       VK_CHECK(vkAllocateDescriptorSets(context_->device(), &allocInfo, &descriptorSet));
-      descriptorSets_[set.set_].vkSets_.push_back(descriptorSet);
+      vkSets.push_back(descriptorSet);
 
       context_->setVkObjectname(descriptorSet, VK_OBJECT_TYPE_DESCRIPTOR_SET,
                                 "Descriptor set: " + set.name_ + " " + std::to_string(i));
     }
+
+    if (auto* capture = context_->commandCapture()) {
+      capture->onDescriptorSetsAllocated(
+          vkPipeline_, set.set_, firstIndex,
+          std::span<const VkDescriptorSet>(vkSets).subspan(firstIndex));
+    }
   }
 }
 
+uint32_t Pipeline::descriptorSetCount(uint32_t set) const {
+  const auto itr = descriptorSets_.find(set);
+  return itr != descriptorSets_.end() ? static_cast<uint32_t>(itr->second.vkSets_.size()) : 0;
+}
+
+VkDescriptorSet Pipeline::vkDescriptorSet(uint32_t set, uint32_t index) const {
+  ASSERT(index < descriptorSetCount(set), "Descriptor set index out of range");
+  return descriptorSets_.at(set).vkSets_[index];
+}
+
 void Pipeline::bindDescriptorSets(VkCommandBuffer commandBuffer,
                                   const std::vector<SetAndBindingIndex>& sets) {
   for (const auto& set : sets) {
     vkCmdBindDescriptorSets(commandBuffer, bindPoint_, vkPipelineLayout_, set.set, 1u,
-                            &descriptorSets_[set.set].vkSets_[set.bindIdx], 0, nullptr);
+                            &descriptorSets_.at(set.set).vkSets_[set.bindIdx], 0, nullptr);
   }
 }
 
@@ -117,7 +173,7 @@ void Pipeline::updateSamplersDescriptorSets(uint32_t set, uint32_t index,
     }
     const VkWriteDescriptorSet writeDescSet = {
         .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
-        .dstSet = descriptorSets_[set].vkSets_[index],
+        .dstSet = vkDescriptorSet(set, index),
         .dstBinding = binding.binding_,
         .dstArrayElement = 0,
         .descriptorCount = static_cast<uint32_t>(samplerInfo[idx].size()),
@@ -130,8 +186,7 @@ void Pipeline::updateSamplersDescriptorSets(uint32_t set, uint32_t index,
     ++idx;
   }
 
-  vkUpdateDescriptorSets(context_->device(), writeDescSets.size(), writeDescSets.data(),
-                         0, nullptr);
+  writeDescriptorSets(context_->device(), writeDescSets, descriptorGeneration_);
 }
 
 void Pipeline::updateTexturesDescriptorSets(uint32_t set, uint32_t index,
@@ -152,7 +207,7 @@ void Pipeline::updateTexturesDescriptorSets(uint32_t set, uint32_t index,
     }
     const VkWriteDescriptorSet writeDescSet = {
         .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
-        .dstSet = descriptorSets_[set].vkSets_[index],
+        .dstSet = vkDescriptorSet(set, index),
         .dstBinding = binding.binding_,
         .dstArrayElement = 0,
         .descriptorCount = static_cast<uint32_t>(imageInfo[idx].size()),
@@ -165,8 +220,7 @@ void Pipeline::updateTexturesDescriptorSets(uint32_t set, uint32_t index,
     ++idx;
   }
 
-  vkUpdateDescriptorSets(context_->device(), writeDescSets.size(), writeDescSets.data(),
-                         0, nullptr);
+  writeDescriptorSets(context_->device(), writeDescSets, descriptorGeneration_);
 }
 
 void Pipeline::updateBuffersDescriptorSets(uint32_t set, uint32_t index,
@@ -184,7 +238,7 @@ void Pipeline::updateBuffersDescriptorSets(uint32_t set, uint32_t index,
 
     const VkWriteDescriptorSet writeDescSet = {
         .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
-        .dstSet = descriptorSets_[set].vkSets_[index],
+        .dstSet = vkDescriptorSet(set, index),
         .dstBinding = binding.binding_,
         .dstArrayElement = 0,
         .descriptorCount = 1,
@@ -196,42 +250,44 @@ void Pipeline::updateBuffersDescriptorSets(uint32_t set, uint32_t index,
     writeDescSets.emplace_back(writeDescSet);
   }
 
-  vkUpdateDescriptorSets(context_->device(), writeDescSets.size(), writeDescSets.data(),
-                         0, nullptr);
+  writeDescriptorSets(context_->device(), writeDescSets, descriptorGeneration_);
 }
 
 void Pipeline::updateDescriptorSets() {
-  if (!writeDescSets_.empty()) {
-    std::unique_lock<std::mutex> mlock(mutex_);
-    vkUpdateDescriptorSets(context_->device(), writeDescSets_.size(),
-                           writeDescSets_.data(), 0, nullptr);
-    writeDescSets_.clear();
-    bufferInfo_.clear();
-
-    bufferViewInfo_.clear();
-    imageInfo_.clear();
-    accelerationStructInfo_.clear();
+  for (auto& pending : pendingWrites_) {
+    std::unique_lock<std::mutex> mlock(pending.mutex);
+    if (pending.writes.empty()) {
+      continue;
+    }
+    writeDescriptorSets(context_->device(), pending.writes, descriptorGeneration_);
+    pending.writes.clear();
+    pending.bufferInfo.clear();
+    pending.bufferViews.clear();
+    pending.imageInfo.clear();
+    pending.accelerationStructInfo.clear();
   }
 }
 
 void Pipeline::bindResource(uint32_t set, uint32_t binding, uint32_t index,
                             std::shared_ptr<Buffer> buffer, uint32_t offset,
                             uint32_t size, VkDescriptorType type, VkFormat format) {
-  bufferInfo_.emplace_back(std::vector<VkDescriptorBufferInfo>{VkDescriptorBufferInfo{
+  auto& pending = pendingWrites();
+  std::unique_lock<std::mutex> mlock(pending.mutex);
+  pending.bufferInfo.emplace_back(std::vector<VkDescriptorBufferInfo>{VkDescriptorBufferInfo{
       .buffer = buffer->vkBuffer(), .offset = offset, .range = size}});
 
   if (type == VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER ||
       type == VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER) {
     ASSERT(format != VK_FORMAT_UNDEFINED, "format must be specified");
-    bufferViewInfo_.emplace_back(buffer->requestBufferView(format));
+    pending.bufferViews.emplace_back(buffer->requestBufferView(format));
   }
 
-  ASSERT(descriptorSets_[set].vkSets_[index] != VK_NULL_HANDLE,
+  ASSERT(vkDescriptorSet(set, index) != VK_NULL_HANDLE,
          "Did you allocate the descriptor set before binding to it?");
 
   const VkWriteDescriptorSet writeDescSet = {
       .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
-      .dstSet = descriptorSets_[set].vkSets_[index],
+      .dstSet = vkDescriptorSet(set, index),
       .dstBinding = binding,
       .dstArrayElement = 0,
       .descriptorCount = 1,
@@ -240,14 +296,14 @@ void Pipeline::bindResource(uint32_t set, uint32_t binding, uint32_t index,
       .pBufferInfo = (type == VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER ||
                       type == VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER)
                          ? VK_NULL_HANDLE
-                         : bufferInfo_.back().data(),
+                         : pending.bufferInfo.back().data(),
       .pTexelBufferView = (type == VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER ||
                            type == VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER)
-                              ? &bufferViewInfo_.back()
+                              ? &pending.bufferViews.back()
                               : VK_NULL_HANDLE,
   };
 
-  writeDescSets_.emplace_back(std::move(writeDescSet));
+  pending.writes.emplace_back(std::move(writeDescSet));
 }
 
 void Pipeline::bindResource(uint32_t set, uint32_t binding, uint32_t index,
@@ -257,13 +313,14 @@ void Pipeline::bindResource(uint32_t set, uint32_t binding, uint32_t index,
     return;
   }
 
-  std::unique_lock<std::mutex> mlock(mutex_);
+  auto& pending = pendingWrites();
+  std::unique_lock<std::mutex> mlock(pending.mutex);
 
-  imageInfo_.push_back(std::vector<VkDescriptorImageInfo>());
-  imageInfo_.back().reserve(textures.size());
+  pending.imageInfo.push_back(std::vector<VkDescriptorImageInfo>());
+  pending.imageInfo.back().reserve(textures.size());
   for (const auto& texture : textures) {
     if (texture) {
-      imageInfo_.back().emplace_back(VkDescriptorImageInfo{
+      pending.imageInfo.back().emplace_back(VkDescriptorImageInfo{
           .sampler = sampler ? sampler->vkSampler() : VK_NULL_HANDLE,
           .imageView = texture->vkImageView(),
           .imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
@@ -271,58 +328,62 @@ void Pipeline::bindResource(uint32_t set, uint32_t binding, uint32_t index,
     }
   }
 
-  if (imageInfo_.back().size() == 0) {
+  if (pending.imageInfo.back().size() == 0) {
     return;
   }
 
-  ASSERT(descriptorSets_[set].vkSets_[index] != VK_NULL_HANDLE,
+  ASSERT(vkDescriptorSet(set, index) != VK_NULL_HANDLE,
          "Did you allocate the descriptor set before binding to it?");
 
   const VkWriteDescriptorSet writeDescSet = {
       .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
-      .dstSet = descriptorSets_[set].vkSets_[index],
+      .dstSet = vkDescriptorSet(set, index),
       .dstBinding = binding,
       .dstArrayElement = dstArrayElement,
-      .descriptorCount = static_cast<uint32_t>(imageInfo_.back().size()),
+      .descriptorCount = static_cast<uint32_t>(pending.imageInfo.back().size()),
       .descriptorType = sampler ? VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER
                                 : VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE,
-      .pImageInfo = imageInfo_.back().data(),
+      .pImageInfo = pending.imageInfo.back().data(),
       .pBufferInfo = nullptr,
   };
 
-  writeDescSets_.emplace_back(std::move(writeDescSet));
+  pending.writes.emplace_back(std::move(writeDescSet));
 }
 
 void Pipeline::bindResource(uint32_t set, uint32_t binding, uint32_t index,
                             std::span<std::shared_ptr<Sampler>> samplers) {
-  imageInfo_.push_back(std::vector<VkDescriptorImageInfo>());
-  imageInfo_.back().reserve(samplers.size());
+  auto& pending = pendingWrites();
+  std::unique_lock<std::mutex> mlock(pending.mutex);
+  pending.imageInfo.push_back(std::vector<VkDescriptorImageInfo>());
+  pending.imageInfo.back().reserve(samplers.size());
   for (const auto& sampler : samplers) {
-    imageInfo_.back().emplace_back(VkDescriptorImageInfo{
+    pending.imageInfo.back().emplace_back(VkDescriptorImageInfo{
         .sampler = sampler->vkSampler(),
     });
   }
 
-  ASSERT(descriptorSets_[set].vkSets_[index] != VK_NULL_HANDLE,
+  ASSERT(vkDescriptorSet(set, index) != VK_NULL_HANDLE,
          "Did you allocate the descriptor set before binding to it?");
 
   const VkWriteDescriptorSet writeDescSet = {
       .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
-      .dstSet = descriptorSets_[set].vkSets_[index],
+      .dstSet = vkDescriptorSet(set, index),
       .dstBinding = binding,
       .dstArrayElement = 0,
-      .descriptorCount = static_cast<uint32_t>(imageInfo_.back().size()),
+      .descriptorCount = static_cast<uint32_t>(pending.imageInfo.back().size()),
       .descriptorType = VK_DESCRIPTOR_TYPE_SAMPLER,
-      .pImageInfo = imageInfo_.back().data(),
+      .pImageInfo = pending.imageInfo.back().data(),
       .pBufferInfo = nullptr,
   };
 
-  writeDescSets_.emplace_back(writeDescSet);
+  pending.writes.emplace_back(writeDescSet);
 }
 
 void Pipeline::bindResource(uint32_t set, uint32_t binding, uint32_t index,
                             std::vector<std::shared_ptr<Buffer>> buffers,
                             VkDescriptorType type) {
+  auto& pending = pendingWrites();
+  std::unique_lock<std::mutex> mlock(pending.mutex);
   std::vector<VkDescriptorBufferInfo> bufferInfos;
 
   for (auto& buffer : buffers) {
@@ -333,128 +394,140 @@ void Pipeline::bindResource(uint32_t set, uint32_t binding, uint32_t index,
     });
   }
 
-  bufferInfo_.emplace_back(bufferInfos);
+  pending.bufferInfo.emplace_back(bufferInfos);
 
-  ASSERT(descriptorSets_[set].vkSets_[index] != VK_NULL_HANDLE,
+  ASSERT(vkDescriptorSet(set, index) != VK_NULL_HANDLE,
          "Did you allocate the descriptor set before binding to it?");
 
   const VkWriteDescriptorSet writeDescSet = {
       .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
-      .dstSet = descriptorSets_[set].vkSets_[index],
+      .dstSet = vkDescriptorSet(set, index),
       .dstBinding = binding,
       .dstArrayElement = 0,
       .descriptorCount = uint32_t(bufferInfos.size()),
       .descriptorType = type,
       .pImageInfo = nullptr,
-      .pBufferInfo = bufferInfo_.back().data(),
+      .pBufferInfo = pending.bufferInfo.back().data(),
   };
 
-  writeDescSets_.emplace_back(std::move(writeDescSet));
+  pending.writes.emplace_back(std::move(writeDescSet));
 }
 
 void Pipeline::bindResource(uint32_t set, uint32_t binding, uint32_t index,
                             std::shared_ptr<Texture> texture, VkDescriptorType type) {
-  imageInfo_.push_back(std::vector<VkDescriptorImageInfo>());
-  imageInfo_.back().push_back(VkDescriptorImageInfo{
+  auto& pending = pendingWrites();
+  std::unique_lock<std::mutex> mlock(pending.mutex);
+  pending.imageInfo.push_back(std::vector<VkDescriptorImageInfo>());
+  pending.imageInfo.back().push_back(VkDescriptorImageInfo{
       .imageView = texture->vkImageView(),
       .imageLayout = VK_IMAGE_LAYOUT_GENERAL,
   });
 
-  ASSERT(descriptorSets_[set].vkSets_[index] != VK_NULL_HANDLE,
+  ASSERT(vkDescriptorSet(set, index) != VK_NULL_HANDLE,
          "Did you allocate the descriptor set before binding to it?");
 
   const VkWriteDescriptorSet writeDescSet = {
       .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
-      .dstSet = descriptorSets_[set].vkSets_[index],
+      .dstSet = vkDescriptorSet(set, index),
       .dstBinding = binding,
       .dstArrayElement = 0,
-      .descriptorCount = static_cast<uint32_t>(imageInfo_.back().size()),
+      .descriptorCount = static_cast<uint32_t>(pending.imageInfo.back().size()),
       .descriptorType = type,
-      .pImageInfo = imageInfo_.back().data(),
+      .pImageInfo = pending.imageInfo.back().data(),
       .pBufferInfo = nullptr,
   };
 
-  writeDescSets_.emplace_back(writeDescSet);
+  pending.writes.emplace_back(writeDescSet);
 }
 
 void Pipeline::bindResource(uint32_t set, uint32_t binding, uint32_t index,
                             std::span<std::shared_ptr<VkImageView>> imageViews,
                             VkDescriptorType type) {
-  imageInfo_.push_back(std::vector<VkDescriptorImageInfo>());
-  imageInfo_.back().reserve(imageViews.size());
+  auto& pending = pendingWrites();
+  std::unique_lock<std::mutex> mlock(pending.mutex);
+  pending.imageInfo.push_back(std::vector<VkDescriptorImageInfo>());
+  pending.imageInfo.back().reserve(imageViews.size());
   for (const auto& imview : imageViews) {
-    imageInfo_.back().emplace_back(VkDescriptorImageInfo{
+    pending.imageInfo.back().emplace_back(VkDescriptorImageInfo{
         .imageView = *imview,
         .imageLayout = VK_IMAGE_LAYOUT_GENERAL,
     });
   }
 
-  ASSERT(descriptorSets_[set].vkSets_[index] != VK_NULL_HANDLE,
+  ASSERT(vkDescriptorSet(set, index) != VK_NULL_HANDLE,
          "Did you allocate the descriptor set before binding to it?");
 
   const VkWriteDescriptorSet writeDescSet = {
       .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
-      .dstSet = descriptorSets_[set].vkSets_[index],
+      .dstSet = vkDescriptorSet(set, index),
       .dstBinding = binding,
       .dstArrayElement = 0,
-      .descriptorCount = static_cast<uint32_t>(imageInfo_.back().size()),
+      .descriptorCount = static_cast<uint32_t>(pending.imageInfo.back().size()),
       .descriptorType = type,
-      .pImageInfo = imageInfo_.back().data(),
+      .pImageInfo = pending.imageInfo.back().data(),
       .pBufferInfo = nullptr,
   };
 
-  writeDescSets_.emplace_back(writeDescSet);
+  pending.writes.emplace_back(writeDescSet);
 }
 
 void Pipeline::bindResource(uint32_t set, uint32_t binding, uint32_t index,
                             std::shared_ptr<Texture> texture,
                             std::shared_ptr<Sampler> sampler, VkDescriptorType type) {
-  imageInfo_.push_back(std::vector<VkDescriptorImageInfo>());
-  imageInfo_.back().push_back(VkDescriptorImageInfo{
+  auto& pending = pendingWrites();
+  std::unique_lock<std::mutex> mlock(pending.mutex);
+  pending.imageInfo.push_back(std::vector<VkDescriptorImageInfo>());
+  pending.imageInfo.back().push_back(VkDescriptorImageInfo{
       .sampler = sampler->vkSampler(),
       .imageView = texture->vkImageView(),
       .imageLayout = VK_IMAGE_LAYOUT_GENERAL,
   });
 
-  ASSERT(descriptorSets_[set].vkSets_[index] != VK_NULL_HANDLE,
+  ASSERT(vkDescriptorSet(set, index) != VK_NULL_HANDLE,
          "Did you allocate the descriptor set before binding to it?");
 
   const VkWriteDescriptorSet writeDescSet = {
       .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
-      .dstSet = descriptorSets_[set].vkSets_[index],
+      .dstSet = vkDescriptorSet(set, index),
       .dstBinding = binding,
       .dstArrayElement = 0,
-      .descriptorCount = static_cast<uint32_t>(imageInfo_.back().size()),
+      .descriptorCount = static_cast<uint32_t>(pending.imageInfo.back().size()),
       .descriptorType = type,
-      .pImageInfo = imageInfo_.back().data(),
+      .pImageInfo = pending.imageInfo.back().data(),
       .pBufferInfo = nullptr,
   };
 
-  writeDescSets_.emplace_back(writeDescSet);
+  pending.writes.emplace_back(writeDescSet);
 }
 
 void Pipeline::bindResource(uint32_t set, uint32_t binding, uint32_t index,
                             VkAccelerationStructureKHR* accelStructHandle) {
-  accelerationStructInfo_.push_back(VkWriteDescriptorSetAccelerationStructureKHR{
+  auto& pending = pendingWrites();
+  std::unique_lock<std::mutex> mlock(pending.mutex);
+  pending.accelerationStructInfo.push_back(VkWriteDescriptorSetAccelerationStructureKHR{
       .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET_ACCELERATION_STRUCTURE_KHR,
       .accelerationStructureCount = 1,
       .pAccelerationStructures = accelStructHandle,
   });
 
-  ASSERT(descriptorSets_[set].vkSets_[index] != VK_NULL_HANDLE,
+  ASSERT(vkDescriptorSet(set, index) != VK_NULL_HANDLE,
          "Did you allocate the descriptor set before binding to it?");
 
   const VkWriteDescriptorSet writeDescSet = {
       .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
-      .pNext = &accelerationStructInfo_.back(),
-      .dstSet = descriptorSets_[set].vkSets_[index],
+      .pNext = &pending.accelerationStructInfo.back(),
+      .dstSet = vkDescriptorSet(set, index),
       .dstBinding = binding,
       .dstArrayElement = 0,
       .descriptorCount = 1u,
       .descriptorType = VK_DESCRIPTOR_TYPE_ACCELERATION_STRUCTURE_KHR,
   };
 
-  writeDescSets_.emplace_back(writeDescSet);
+  pending.writes.emplace_back(writeDescSet);
+}
+
+Pipeline::PendingWrites& Pipeline::pendingWrites() {
+  return pendingWrites_[util::threadShard(kPendingWriteShards)];
 }
 
 void Pipeline::bindVertexBuffer(VkCommandBuffer commandBuffer, VkBuffer vertexBuffer) {
@@ -651,10 +724,23 @@ void Pipeline::createGraphicsPipeline() {
       .stencilAttachmentFormat = graphicsPipelineDesc_.stencilTextureFormat,
   };
 
-  const VkGraphicsPipelineCreateInfo pipelineInfo = {
-      .sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO,
+  const bool indirectBindable = graphicsPipelineDesc_.indirectBindable &&
+                                context_->isDeviceGeneratedCommandsEnabled();
+  const VkPipelineCreateFlags2CreateInfoKHR createFlags2 = {
+      .sType = VK_STRUCTURE_TYPE_PIPELINE_CREATE_FLAGS_2_CREATE_INFO_KHR,
       .pNext = graphicsPipelineDesc_.useDynamicRendering_ ? &pipelineRenderingCreateInfo
                                                           : nullptr,
+      .flags = VK_PIPELINE_CREATE_2_INDIRECT_BINDABLE_BIT_EXT,
+  };
+  const void* pipelineInfoNext = createFlags2.pNext;
+  if (indirectBindable) {
+    pipelineInfoNext = &createFlags2;
+  }
+  indirectBindable_ = indirectBindable;
+
+  const VkGraphicsPipelineCreateInfo pipelineInfo = {
+      .sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO,
+      .pNext = pipelineInfoNext,
       .stageCount = uint32_t(shaderStages.size()),
       .pStages = shaderStages.data(),
       .pVertexInputState = &graphicsPipelineDesc_.vertexInputCreateInfo,
@@ -710,6 +796,9 @@ void Pipeline::createComputePipeline() {
       .stage = computeShader->vkShaderStageFlags(),
       .module = computeShader->vkShaderModule(),
       .pName = computeShader->entryPoint().c_str(),
+      .pSpecializationInfo = !computePipelineDesc_.specializationConsts_.empty()
+                                 ? &specializationInfo
+                                 : nullptr,
   };
 
   VkComputePipelineCreateInfo computePipelineCreateInfo{
@@ -859,10 +948,11 @@ void Pipeline::initDescriptorPool() {
     sets = rayTracingPipelineDesc_.sets_;
   }
 
+  const uint32_t maxSets = maxDescriptorSets.get();
   std::vector<VkDescriptorPoolSize> poolSizes;
   for (size_t setIndex = 0; const auto& set : sets) {
     for (const auto& binding : set.bindings_) {
-      poolSizes.push_back({binding.descriptorType, MAX_DESCRIPTOR_SETS});
+      poolSizes.push_back({binding.descriptorType, maxSets});
     }
   }
 
@@ -870,7 +960,7 @@ void Pipeline::initDescriptorPool() {
       .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO,
       .flags = VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT |
                VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT,
-      .maxSets = MAX_DESCRIPTOR_SETS,
+      .maxSets = maxSets,
       .poolSizeCount = static_cast<uint32_t>(poolSizes.size()),
       .pPoolSizes = poolSizes.data(),
   };
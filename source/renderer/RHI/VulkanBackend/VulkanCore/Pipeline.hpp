@@ -1,5 +1,7 @@
 #pragma once
 
+#include <array>
+#include <atomic>
 #include <list>
 #include <memory>
 #include <mutex>
@@ -100,6 +102,11 @@ class Pipeline final {
     void* fragmentSpecializationData = nullptr;
 
     std::vector<VkPipelineColorBlendAttachmentState> blendAttachmentStates_;
+
+    // Lets the pipeline be placed in an indirect execution set, see
+    // DeviceGeneratedCommands.hpp. Ignored unless the context enabled
+    // device-generated commands.
+    bool indirectBindable = false;
   };
 
   struct ComputePipelineDescriptor {
@@ -137,6 +144,10 @@ class Pipeline final {
 
   VkPipelineLayout vkPipelineLayout() const;
 
+  // Whether the pipeline can go into an indirect execution set; false when
+  // requested but device-generated commands aren't enabled
+  bool isIndirectBindable() const { return indirectBindable_; }
+
   void updatePushConstant(VkCommandBuffer commandBuffer, VkShaderStageFlags flags,
                           uint32_t size, const void* data);
 
@@ -153,6 +164,11 @@ class Pipeline final {
   };
   void allocateDescriptors(const std::vector<SetAndCount>& setAndCount);
 
+  // Number of descriptor sets allocated so far for the set index
+  uint32_t descriptorSetCount(uint32_t set) const;
+
+  VkDescriptorSet vkDescriptorSet(uint32_t set, uint32_t index) const;
+
   struct SetAndBindingIndex {
     uint32_t set;
     uint32_t bindIdx;
@@ -179,8 +195,18 @@ class Pipeline final {
                                     const std::vector<SetBindings>& bindings);
   void updateBuffersDescriptorSets(uint32_t set, uint32_t index, VkDescriptorType type,
                                    const std::vector<SetBindings>& bindings);
+  // Flushes the writes queued by bindResource() from every thread. bindResource()
+  // and updateDescriptorSets() may be called concurrently once the descriptor
+  // sets are allocated; writes to the same set from two threads are the
+  // caller's to order.
   void updateDescriptorSets();
 
+  // Bumped by every descriptor write. Command buffers that bound one of the
+  // pipeline's sets are invalid once it changes (see CachedCommands.hpp).
+  uint64_t descriptorGeneration() const {
+    return descriptorGeneration_.load(std::memory_order_acquire);
+  }
+
   /// @brief Assigns the resource to a position in the resource array specific
   /// to te resource's type
   void bindResource(uint32_t set, uint32_t binding, uint32_t index,
@@ -225,6 +251,10 @@ class Pipeline final {
   void initDescriptorPool();
   void initDescriptorLayout();
 
+  // This thread's shard of pendingWrites_; lock its mutex before touching it
+  struct PendingWrites;
+  PendingWrites& pendingWrites();
+
  private:
   const Context* context_ = nullptr;
   std::string name_;
@@ -235,6 +265,7 @@ class Pipeline final {
   VkPipeline vkPipeline_ = VK_NULL_HANDLE;
   VkPipelineLayout vkPipelineLayout_ = VK_NULL_HANDLE;
   VkRenderPass vkRenderPass_ = VK_NULL_HANDLE;
+  bool indirectBindable_ = false;
 
   struct DescriptorSet {
     std::vector<VkDescriptorSet> vkSets_;
@@ -242,14 +273,22 @@ class Pipeline final {
   };
   std::unordered_map<uint32_t, DescriptorSet> descriptorSets_;
   VkDescriptorPool vkDescriptorPool_ = VK_NULL_HANDLE;
+  std::atomic<uint64_t> descriptorGeneration_{0};
   std::vector<VkPushConstantRange> pushConsts_;  // IDK
 
-  std::list<std::vector<VkDescriptorBufferInfo>> bufferInfo_;
-  std::list<VkBufferView> bufferViewInfo_;
-  std::list<std::vector<VkDescriptorImageInfo>> imageInfo_;
-  std::vector<VkWriteDescriptorSetAccelerationStructureKHR> accelerationStructInfo_;
-  std::vector<VkWriteDescriptorSet> writeDescSets_;
-  std::mutex mutex_;
+  // Writes queued by bindResource() until updateDescriptorSets(), sharded by
+  // thread so loader threads binding into one pipeline rarely share a lock.
+  // Lists keep the info structs the writes point into at stable addresses.
+  struct PendingWrites {
+    std::mutex mutex;
+    std::list<std::vector<VkDescriptorBufferInfo>> bufferInfo;
+    std::list<VkBufferView> bufferViews;
+    std::list<std::vector<VkDescriptorImageInfo>> imageInfo;
+    std::list<VkWriteDescriptorSetAccelerationStructureKHR> accelerationStructInfo;
+    std::vector<VkWriteDescriptorSet> writes;
+  };
+  static constexpr size_t kPendingWriteShards = 4;
+  std::array<PendingWrites, kPendingWriteShards> pendingWrites_;
 };
 
 }  // namespace VulkanCore
@@ -0,0 +1,121 @@
+#include "QueueTimer.hpp"
+
+#include <array>
+
+#include "Context.hpp"
+#include "core/Metrics.hpp"
+
+namespace VulkanCore {
+
+  QueueTimer::QueueTimer(
+      const Context& context,
+      uint32_t queueFamilyIndex,
+      uint32_t framesInFlight,
+      const std::string& name
+  )
+      : context_(&context),
+        device_(context.device()),
+        framesInFlight_(framesInFlight),
+        pending_(framesInFlight, false) {
+    ASSERT(framesInFlight > 0, "A queue timer needs at least one frame in flight");
+
+    const auto& families = context.physicalDevice().queueFamilyProperties();
+    ASSERT(queueFamilyIndex < families.size(), "Queue family index out of range");
+    const uint32_t validBits = families[queueFamilyIndex].timestampValidBits;
+    if (validBits == 0) {
+      return;
+    }
+    timestampMask_ = validBits >= 64 ? ~0ull : (1ull << validBits) - 1;
+    periodNs_      = context.physicalDevice().properties().properties.limits.timestampPeriod;
+
+    const VkQueryPoolCreateInfo queryPoolInfo = {
+        .sType      = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO,
+        .queryType  = VK_QUERY_TYPE_TIMESTAMP,
+        .queryCount = 2 * framesInFlight,
+    };
+    VK_CHECK(vkCreateQueryPool(device_, &queryPoolInfo, nullptr, &queryPool_));
+    context.setVkObjectname(queryPool_, VK_OBJECT_TYPE_QUERY_POOL, "Queue timer: " + name);
+
+    gpuTime_ = &kst::core::MetricsRegistry::instance().histogram(
+        "kst_queue_gpu_time_seconds",
+        "GPU time per frame between the first and last timestamp on a queue",
+        "queue=\"" + name + "\"",
+        1e-9
+    );
+  }
+
+  QueueTimer::~QueueTimer() {
+    if (queryPool_ != VK_NULL_HANDLE) {
+      vkDestroyQueryPool(device_, queryPool_, nullptr);
+    }
+  }
+
+  std::optional<QueueTimer::Interval> QueueTimer::nextFrame() {
+    if (!supported()) {
+      return std::nullopt;
+    }
+    slot_ = (slot_ + 1) % framesInFlight_;
+    last_.reset();
+    if (!pending_[slot_]) {
+      return last_;
+    }
+    pending_[slot_] = false;
+
+    last_ = read(slot_);
+    if (last_) {
+      gpuTime_->record(last_->endNs - last_->beginNs);
+    }
+    return last_;
+  }
+
+  void QueueTimer::writeBegin(VkCommandBuffer commandBuffer) {
+    if (!supported()) {
+      return;
+    }
+    vkCmdResetQueryPool(commandBuffer, queryPool_, 2 * slot_, 2);
+    vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, queryPool_, 2 * slot_);
+    pending_[slot_] = true;
+  }
+
+  void QueueTimer::writeEnd(VkCommandBuffer commandBuffer) {
+    if (!supported()) {
+      return;
+    }
+    ASSERT(pending_[slot_], "writeEnd() without writeBegin() in this frame");
+    vkCmdWriteTimestamp(
+        commandBuffer,
+        VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+        queryPool_,
+        2 * slot_ + 1
+    );
+  }
+
+  std::optional<QueueTimer::Interval> QueueTimer::read(uint32_t slot) const {
+    // Value and availability for each of the two queries
+    std::array<uint64_t, 4> results{};
+    const VkResult result = vkGetQueryPoolResults(
+        device_,
+        queryPool_,
+        2 * slot,
+        2,
+        sizeof(results),
+        results.data(),
+        2 * sizeof(uint64_t),
+        VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WITH_AVAILABILITY_BIT
+    );
+    if (result != VK_SUCCESS || results[1] == 0 || results[3] == 0) {
+      return std::nullopt;
+    }
+
+    const uint64_t begin = results[0] & timestampMask_;
+    const uint64_t end   = results[2] & timestampMask_;
+    if (end < begin) {
+      return std::nullopt;
+    }
+    return Interval{
+        .beginNs = static_cast<uint64_t>(static_cast<double>(begin) * periodNs_),
+        .endNs   = static_cast<uint64_t>(static_cast<double>(end) * periodNs_),
+    };
+  }
+
+} // namespace VulkanCore
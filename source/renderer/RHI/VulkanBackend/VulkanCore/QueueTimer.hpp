@@ -0,0 +1,82 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "Common.hpp"
+#include "Utility.hpp"
+
+namespace kst::core {
+  class Histogram;
+} // namespace kst::core
+
+namespace VulkanCore {
+
+  class Context;
+
+  // GPU time one queue spends on a frame, bracketed by a timestamp at the start
+  // of the frame's first command buffer on that queue and one at the end of its
+  // last. Each frame in flight owns a pair of queries, so results are read back
+  // without stalling once the slot comes round again, and every interval is
+  // recorded into kst_queue_gpu_time_seconds{queue=...}. Timestamps are only
+  // guaranteed comparable within one queue, so only an interval's length is
+  // meaningful; don't line up intervals from timers on different queues.
+  class QueueTimer final {
+  public:
+    struct Interval {
+      uint64_t beginNs = 0;
+      uint64_t endNs   = 0;
+
+      double milliseconds() const { return static_cast<double>(endNs - beginNs) * 1e-6; }
+    };
+
+    QueueTimer(
+        const Context& context,
+        uint32_t queueFamilyIndex,
+        uint32_t framesInFlight,
+        const std::string& name
+    );
+
+    ~QueueTimer();
+
+    QueueTimer(const QueueTimer&)            = delete;
+    QueueTimer& operator=(const QueueTimer&) = delete;
+
+    // False when the queue family has no timestamp support; every other call
+    // is then a no-op
+    bool supported() const { return queryPool_ != VK_NULL_HANDLE; }
+
+    // Moves to the next slot and returns the interval it recorded
+    // framesInFlight frames ago, if the GPU has finished it. Call once per
+    // frame, after the fence guarding that slot's command buffers was waited
+    // on (e.g. after getCmdBufferToBegin()).
+    std::optional<Interval> nextFrame();
+
+    // What the last nextFrame() returned
+    const std::optional<Interval>& lastInterval() const { return last_; }
+
+    void writeBegin(VkCommandBuffer commandBuffer);
+
+    void writeEnd(VkCommandBuffer commandBuffer);
+
+  private:
+    std::optional<Interval> read(uint32_t slot) const;
+
+  private:
+    const Context* context_  = nullptr;
+    VkDevice device_         = VK_NULL_HANDLE;
+    VkQueryPool queryPool_   = VK_NULL_HANDLE;
+    uint32_t framesInFlight_ = 0;
+    uint32_t slot_           = 0;
+    // Set once a slot's queries were written and not read back yet; reading a
+    // query that was never reset is undefined
+    std::vector<bool> pending_;
+    std::optional<Interval> last_;
+    double periodNs_               = 1.0;
+    uint64_t timestampMask_        = ~0ull;
+    kst::core::Histogram* gpuTime_ = nullptr;
+  };
+
+} // namespace VulkanCore
@@ -0,0 +1,239 @@
+#include "ReadbackManager.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <tracy/Tracy.hpp>
+
+#include "Buffer.hpp"
+#include "CommandQueueManager.hpp"
+#include "Context.hpp"
+#include "Texture.hpp"
+
+namespace VulkanCore {
+
+  namespace {
+    constexpr VkDeviceSize kMinReadbackSize = 256;
+
+    VkDeviceSize bucketSize(VkDeviceSize size) {
+      return std::bit_ceil(std::max(size, kMinReadbackSize));
+    }
+
+    void transferToHostBarrier(VkCommandBuffer commandBuffer) {
+      const VkMemoryBarrier barrier = {
+          .sType         = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+          .srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+          .dstAccessMask = VK_ACCESS_HOST_READ_BIT,
+      };
+      vkCmdPipelineBarrier(
+          commandBuffer,
+          VK_PIPELINE_STAGE_TRANSFER_BIT,
+          VK_PIPELINE_STAGE_HOST_BIT,
+          0,
+          1,
+          &barrier,
+          0,
+          nullptr,
+          0,
+          nullptr
+      );
+    }
+  } // namespace
+
+  ReadbackManager::ReadbackManager(
+      const Context& context,
+      CommandQueueManager& queueManager,
+      const std::string& name
+  )
+      : context_(context), queueManager_(queueManager), name_(name) {}
+
+  ReadbackManager::~ReadbackManager() = default;
+
+  std::shared_ptr<Buffer> ReadbackManager::acquireBuffer(VkDeviceSize size) {
+    const VkDeviceSize bucket = bucketSize(size);
+    auto& freeList            = freeBuffers_[bucket];
+    if (!freeList.empty()) {
+      auto buffer = std::move(freeList.back());
+      freeList.pop_back();
+      return buffer;
+    }
+
+    return context_.createReadbackBuffer(
+        bucket, "Readback " + std::to_string(buffersCreated_++) + ": " + name_
+    );
+  }
+
+  void ReadbackManager::enqueue(
+      std::shared_ptr<Buffer> buffer,
+      VkDeviceSize size,
+      Callback&& callback
+  ) {
+    pending_.push_back({
+        .submitValue = queueManager_.nextSubmitValue(),
+        .buffer      = std::move(buffer),
+        .size        = size,
+        .callback    = std::move(callback),
+    });
+  }
+
+  void ReadbackManager::readBuffer(
+      VkCommandBuffer commandBuffer,
+      const Buffer& buffer,
+      VkDeviceSize offset,
+      VkDeviceSize size,
+      Callback callback
+  ) {
+    ZoneScopedN("Readback: readBuffer");
+    ASSERT(offset + size <= buffer.size(), "Readback range exceeds the source buffer");
+
+    auto readback = acquireBuffer(size);
+
+    // The source may have just been written by a shader or a transfer.
+    const VkMemoryBarrier barrier = {
+        .sType         = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+        .srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT | VK_ACCESS_TRANSFER_WRITE_BIT,
+        .dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT,
+    };
+    vkCmdPipelineBarrier(
+        commandBuffer,
+        VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
+        VK_PIPELINE_STAGE_TRANSFER_BIT,
+        0,
+        1,
+        &barrier,
+        0,
+        nullptr,
+        0,
+        nullptr
+    );
+
+    const VkBufferCopy region = {.srcOffset = offset, .dstOffset = 0, .size = size};
+    vkCmdCopyBuffer(commandBuffer, buffer.vkBuffer(), readback->vkBuffer(), 1, &region);
+    transferToHostBarrier(commandBuffer);
+
+    enqueue(std::move(readback), size, std::move(callback));
+  }
+
+  void ReadbackManager::readTexture(
+      VkCommandBuffer commandBuffer,
+      Texture& texture,
+      Callback callback,
+      uint32_t mipLevel,
+      uint32_t layer,
+      VkOffset3D offset,
+      VkExtent3D extent
+  ) {
+    ZoneScopedN("Readback: readTexture");
+    ASSERT(mipLevel < texture.numMipLevels(), "Invalid mip level for readback");
+
+    if (extent.width == 0 || extent.height == 0 || extent.depth == 0) {
+      const VkExtent3D full = texture.vkExtents();
+      extent                = {
+          std::max(1u, full.width >> mipLevel),
+          std::max(1u, full.height >> mipLevel),
+          std::max(1u, full.depth >> mipLevel),
+      };
+    }
+
+    const VkDeviceSize size = static_cast<VkDeviceSize>(extent.width) * extent.height *
+                              extent.depth * texture.pixelSizeInBytes();
+    auto readback = acquireBuffer(size);
+
+    const VkImageLayout previousLayout = texture.vkLayout();
+    texture.transitionImageLayout(commandBuffer, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL);
+
+    const VkImageAspectFlags aspect =
+        texture.isDepth() ? VK_IMAGE_ASPECT_DEPTH_BIT : VK_IMAGE_ASPECT_COLOR_BIT;
+    const VkBufferImageCopy region = {
+        .bufferOffset      = 0,
+        .bufferRowLength   = 0,
+        .bufferImageHeight = 0,
+        .imageSubresource =
+            {
+                .aspectMask     = aspect,
+                .mipLevel       = mipLevel,
+                .baseArrayLayer = layer,
+                .layerCount     = 1,
+            },
+        .imageOffset = offset,
+        .imageExtent = extent,
+    };
+    vkCmdCopyImageToBuffer(
+        commandBuffer,
+        texture.vkImage(),
+        VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+        readback->vkBuffer(),
+        1,
+        &region
+    );
+    transferToHostBarrier(commandBuffer);
+
+    if (previousLayout != VK_IMAGE_LAYOUT_UNDEFINED) {
+      texture.transitionImageLayout(commandBuffer, previousLayout);
+    }
+
+    enqueue(std::move(readback), size, std::move(callback));
+  }
+
+  void ReadbackManager::readQueryResults(
+      VkCommandBuffer commandBuffer,
+      VkQueryPool queryPool,
+      uint32_t firstQuery,
+      uint32_t queryCount,
+      Callback callback,
+      VkQueryResultFlags flags
+  ) {
+    ZoneScopedN("Readback: readQueryResults");
+
+    const VkDeviceSize stride =
+        (flags & VK_QUERY_RESULT_64_BIT) ? sizeof(uint64_t) : sizeof(uint32_t);
+    const VkDeviceSize valuesPerQuery = (flags & VK_QUERY_RESULT_WITH_AVAILABILITY_BIT) ? 2 : 1;
+    const VkDeviceSize size           = queryCount * stride * valuesPerQuery;
+    auto readback                     = acquireBuffer(size);
+
+    vkCmdCopyQueryPoolResults(
+        commandBuffer,
+        queryPool,
+        firstQuery,
+        queryCount,
+        readback->vkBuffer(),
+        0,
+        stride * valuesPerQuery,
+        flags
+    );
+    transferToHostBarrier(commandBuffer);
+
+    enqueue(std::move(readback), size, std::move(callback));
+  }
+
+  void ReadbackManager::update() {
+    ZoneScopedN("Readback: update");
+
+    if (pending_.empty()) {
+      return;
+    }
+
+    // Requests are queued in submit order, so stop at the first one still in flight.
+    const uint64_t completed = queueManager_.completedSubmitValue();
+    while (!pending_.empty() && pending_.front().submitValue <= completed) {
+      PendingReadback readback = std::move(pending_.front());
+      pending_.pop_front();
+
+      readback.buffer->invalidate(0, VK_WHOLE_SIZE);
+      const auto* data = static_cast<const std::byte*>(readback.buffer->map());
+      if (readback.callback) {
+        readback.callback({data, static_cast<size_t>(readback.size)});
+      }
+
+      freeBuffers_[bucketSize(readback.size)].push_back(std::move(readback.buffer));
+    }
+  }
+
+  size_t ReadbackManager::pooledBufferCount() const {
+    size_t count = 0;
+    for (const auto& [bucket, buffers] : freeBuffers_) {
+      count += buffers.size();
+    }
+    return count;
+  }
+
+} // namespace VulkanCore
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <span>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "Common.hpp"
+#include "Utility.hpp"
+
+namespace VulkanCore {
+
+  class Buffer;
+  class CommandQueueManager;
+  class Context;
+  class Texture;
+
+  // Asynchronous GPU -> CPU readback. Copies are recorded into the caller's
+  // command buffer targeting pooled host-cached buffers; update() polls the
+  // queue's fences and hands the data to the callback once the submit that
+  // carried the copy has retired, typically framesInFlight frames later. No
+  // call in here waits on the GPU.
+  class ReadbackManager final {
+  public:
+    MOVABLE_ONLY(ReadbackManager);
+
+    // The data span is only valid for the duration of the callback
+    using Callback = std::function<void(std::span<const std::byte> data)>;
+
+    explicit ReadbackManager(
+        const Context& context,
+        CommandQueueManager& queueManager,
+        const std::string& name = ""
+    );
+
+    ~ReadbackManager();
+
+    // Records a copy of [offset, offset + size) of a buffer with TRANSFER_SRC usage
+    void readBuffer(
+        VkCommandBuffer commandBuffer,
+        const Buffer& buffer,
+        VkDeviceSize offset,
+        VkDeviceSize size,
+        Callback callback
+    );
+
+    // Records a copy of a whole mip/layer, or of the region given by offset and extent.
+    // The texture is transitioned to TRANSFER_SRC_OPTIMAL and back to its previous layout.
+    void readTexture(
+        VkCommandBuffer commandBuffer,
+        Texture& texture,
+        Callback callback,
+        uint32_t mipLevel   = 0,
+        uint32_t layer      = 0,
+        VkOffset3D offset   = {0, 0, 0},
+        VkExtent3D extent   = {0, 0, 0}
+    );
+
+    // Records vkCmdCopyQueryPoolResults with VK_QUERY_RESULT_64_BIT; the query pool
+    // must be reset and all queries written in this or an earlier submit
+    void readQueryResults(
+        VkCommandBuffer commandBuffer,
+        VkQueryPool queryPool,
+        uint32_t firstQuery,
+        uint32_t queryCount,
+        Callback callback,
+        VkQueryResultFlags flags = VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WAIT_BIT
+    );
+
+    // Delivers completed readbacks and recycles their buffers; call once per frame
+    void update();
+
+    size_t pendingCount() const { return pending_.size(); }
+
+    size_t pooledBufferCount() const;
+
+  private:
+    struct PendingReadback {
+      uint64_t submitValue = 0;
+      std::shared_ptr<Buffer> buffer;
+      VkDeviceSize size = 0;
+      Callback callback;
+    };
+
+    std::shared_ptr<Buffer> acquireBuffer(VkDeviceSize size);
+
+    void enqueue(std::shared_ptr<Buffer> buffer, VkDeviceSize size, Callback&& callback);
+
+    const Context& context_;
+    CommandQueueManager& queueManager_;
+    std::string name_;
+    // Buffers are bucketed by power-of-two size so requests of similar size share them
+    std::unordered_map<VkDeviceSize, std::vector<std::shared_ptr<Buffer>>> freeBuffers_;
+    std::deque<PendingReadback> pending_;
+    uint32_t buffersCreated_ = 0;
+  };
+
+} // namespace VulkanCore
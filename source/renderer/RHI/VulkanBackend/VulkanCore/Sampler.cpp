@@ -1,12 +1,13 @@
 #include "Sampler.hpp"
 
+#include "CommandCapture.hpp"
 #include "Context.hpp"
 
 namespace VulkanCore {
 Sampler::Sampler(const Context& context, VkFilter minFilter, VkFilter magFilter,
                  VkSamplerAddressMode addressModeU, VkSamplerAddressMode addressModeV,
                  VkSamplerAddressMode addressModeW, float maxLod, const std::string& name)
-    : device_{context.device()} {
+    : context_{&context}, device_{context.device()}, deletionQueue_{&context.deletionQueue()} {
   const VkSamplerCreateInfo samplerInfo = {
       .sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO,
       .magFilter = minFilter,
@@ -23,13 +24,18 @@ Sampler::Sampler(const Context& context, VkFilter minFilter, VkFilter magFilter,
   };
   VK_CHECK(vkCreateSampler(device_, &samplerInfo, nullptr, &sampler_));
   context.setVkObjectname(sampler_, VK_OBJECT_TYPE_SAMPLER, "Sampler: " + name);
+
+  if (auto* capture = context.commandCapture()) {
+    capture->onSamplerCreated(sampler_, {minFilter, magFilter, addressModeU, addressModeV,
+                                         addressModeW, maxLod, false, VK_COMPARE_OP_NEVER});
+  }
 };
 
 Sampler::Sampler(const Context& context, VkFilter minFilter, VkFilter magFilter,
                  VkSamplerAddressMode addressModeU, VkSamplerAddressMode addressModeV,
                  VkSamplerAddressMode addressModeW, float maxLod, bool compareEnable,
                  VkCompareOp compareOp, const std::string& name /*= ""*/)
-    : device_{context.device()} {
+    : context_{&context}, device_{context.device()}, deletionQueue_{&context.deletionQueue()} {
   const VkSamplerCreateInfo samplerInfo = {
       .sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO,
       .magFilter = minFilter,
@@ -48,6 +54,19 @@ Sampler::Sampler(const Context& context, VkFilter minFilter, VkFilter magFilter,
   };
   VK_CHECK(vkCreateSampler(device_, &samplerInfo, nullptr, &sampler_));
   context.setVkObjectname(sampler_, VK_OBJECT_TYPE_SAMPLER, "Sampler: " + name);
+
+  if (auto* capture = context.commandCapture()) {
+    capture->onSamplerCreated(sampler_, {minFilter, magFilter, addressModeU, addressModeV,
+                                         addressModeW, maxLod, compareEnable, compareOp});
+  }
+}
+
+Sampler::~Sampler() {
+  if (auto* capture = context_->commandCapture()) {
+    capture->onDestroyed(CaptureObject::Sampler, (uint64_t)sampler_);
+  }
+  deletionQueue_->enqueue(
+      [device = device_, sampler = sampler_]() { vkDestroySampler(device, sampler, nullptr); });
 }
 
 }  // namespace VulkanCore
@@ -8,6 +8,7 @@
 namespace VulkanCore {
 
 class Context;
+class DeletionQueue;
 
 class Sampler final {
  public:
@@ -23,12 +24,14 @@ class Sampler final {
                    VkSamplerAddressMode addressModeW, float maxLod, bool compareEnable,
                    VkCompareOp compareOp, const std::string &name = "");
 
-  ~Sampler() { vkDestroySampler(device_, sampler_, nullptr); };
+  ~Sampler();
 
   VkSampler vkSampler() const { return sampler_; }
 
  private:
+  const Context* context_ = nullptr;
   VkDevice device_ = VK_NULL_HANDLE;
+  DeletionQueue* deletionQueue_ = nullptr;
   VkSampler sampler_ = VK_NULL_HANDLE;
 };
 
@@ -15,6 +15,7 @@
 #include <iostream>
 #include <sstream>
 
+#include "CommandCapture.hpp"
 #include "Context.hpp"
 
 #ifdef _WIN32
@@ -102,6 +103,9 @@ namespace VulkanCore {
       : ShaderModule(context, filePath, "main", stages, name) {}
 
   ShaderModule::~ShaderModule() {
+    if (auto* capture = context_->commandCapture()) {
+      capture->onDestroyed(CaptureObject::ShaderModule, (uint64_t)vkShaderModule_);
+    }
     vkDestroyShaderModule(context_->device(), vkShaderModule_, nullptr);
   }
 
@@ -189,12 +193,9 @@ namespace VulkanCore {
       const std::string& shaderDir,
       const char* entryPoint
   ) {
-    static bool glslangInitialized = false;
-
-    if (!glslangInitialized) {
-      glslang::InitializeProcess();
-      glslangInitialized = true;
-    }
+    // Shaders may be compiled from several threads at once
+    static const bool glslangInitialized = glslang::InitializeProcess();
+    static_cast<void>(glslangInitialized);
 
     glslang::TShader tshadertemp(shaderStage);
     const char* glslCStr = data.data();
@@ -348,6 +349,10 @@ namespace VulkanCore {
     );
     context_
         ->setVkObjectname(vkShaderModule_, VK_OBJECT_TYPE_SHADER_MODULE, "Shader Module: " + name);
+
+    if (auto* capture = context_->commandCapture()) {
+      capture->onShaderModuleCreated(vkShaderModule_, vkStageFlags_, entryPoint, spirv);
+    }
   }
 
 } // namespace VulkanCore
@@ -0,0 +1,166 @@
+#include "SubmissionThread.hpp"
+
+#include <algorithm>
+#include <tracy/Tracy.hpp>
+
+#include "Context.hpp"
+#include "core/Metrics.hpp"
+
+namespace VulkanCore {
+
+  SubmissionThread::SubmissionThread(const Context& context)
+      : context_(&context), queue_(std::make_unique<kst::core::MpscQueue<Work, 256>>()) {
+    auto& metrics   = kst::core::MetricsRegistry::instance();
+    fullStalls_     = &metrics.counter(
+        "kst_submission_thread_full_stalls_total",
+        "Hand-offs that found the submission queue full and had to spin"
+    );
+    handOffLatency_ = &metrics.histogram(
+        "kst_submission_thread_latency_seconds",
+        "Time from hand-off until the submit or present returned",
+        {},
+        1e-9
+    );
+    thread_ = std::jthread([this](const std::stop_token& stopToken) { run(stopToken); });
+  }
+
+  SubmissionThread::~SubmissionThread() {
+    thread_.request_stop();
+    pushed_.fetch_add(1, std::memory_order_release);
+    pushed_.notify_one();
+    thread_.join();
+  }
+
+  uint64_t SubmissionThread::submit(
+      VkQueue queue,
+      const VkSubmitInfo& submitInfo,
+      VkFence fence
+  ) {
+    ASSERT(submitInfo.pNext == nullptr, "Submits with a pNext chain can't be handed off");
+    ASSERT(
+        submitInfo.commandBufferCount <= kMaxCommandBuffers &&
+            submitInfo.waitSemaphoreCount <= kMaxSemaphores &&
+            submitInfo.signalSemaphoreCount <= kMaxSemaphores,
+        "Too many command buffers or semaphores for one hand-off"
+    );
+
+    Submit work = {
+        .queue                = queue,
+        .fence                = fence,
+        .commandBufferCount   = submitInfo.commandBufferCount,
+        .waitSemaphoreCount   = submitInfo.waitSemaphoreCount,
+        .signalSemaphoreCount = submitInfo.signalSemaphoreCount,
+    };
+    std::copy_n(
+        submitInfo.pCommandBuffers, submitInfo.commandBufferCount, work.commandBuffers.begin()
+    );
+    std::copy_n(
+        submitInfo.pWaitSemaphores, submitInfo.waitSemaphoreCount, work.waitSemaphores.begin()
+    );
+    std::copy_n(
+        submitInfo.pWaitDstStageMask, submitInfo.waitSemaphoreCount, work.waitStages.begin()
+    );
+    std::copy_n(
+        submitInfo.pSignalSemaphores,
+        submitInfo.signalSemaphoreCount,
+        work.signalSemaphores.begin()
+    );
+    return push({.payload = work, .handedOff = std::chrono::steady_clock::now()});
+  }
+
+  uint64_t SubmissionThread::present(
+      VkQueue queue,
+      VkSwapchainKHR swapchain,
+      uint32_t imageIndex,
+      VkSemaphore waitSemaphore
+  ) {
+    const Present work = {
+        .queue         = queue,
+        .swapchain     = swapchain,
+        .imageIndex    = imageIndex,
+        .waitSemaphore = waitSemaphore,
+    };
+    return push({.payload = work, .handedOff = std::chrono::steady_clock::now()});
+  }
+
+  void SubmissionThread::waitFor(uint64_t ticket) const {
+    ZoneScopedN("SubmissionThread: waitFor");
+    // Tickets this thread never handed out (e.g. from a previous thread) count as issued
+    ticket = std::min(ticket, lastTicket_.load(std::memory_order_acquire));
+    for (auto issued = issued_.load(std::memory_order_acquire); issued < ticket;
+         issued      = issued_.load(std::memory_order_acquire)) {
+      issued_.wait(issued, std::memory_order_acquire);
+    }
+  }
+
+  void SubmissionThread::waitIdle() const {
+    waitFor(lastTicket_.load(std::memory_order_acquire));
+  }
+
+  uint64_t SubmissionThread::push(Work&& work) {
+    std::optional<uint64_t> position;
+    while (!(position = queue_->tryPush(std::move(work)))) {
+      // The thread is 256 items behind; the driver is the bottleneck anyway
+      fullStalls_->add();
+      std::this_thread::yield();
+    }
+    const uint64_t ticket = *position + 1;
+    auto lastTicket       = lastTicket_.load(std::memory_order_relaxed);
+    while (lastTicket < ticket &&
+           !lastTicket_.compare_exchange_weak(lastTicket, ticket, std::memory_order_release)) {
+    }
+
+    pushed_.fetch_add(1, std::memory_order_release);
+    pushed_.notify_one();
+    return ticket;
+  }
+
+  void SubmissionThread::run(const std::stop_token& stopToken) {
+    tracy::SetThreadName("Submission");
+    auto seen = pushed_.load(std::memory_order_acquire);
+    for (;;) {
+      while (auto work = queue_->tryPop()) {
+        std::visit([this](const auto& payload) { issue(payload); }, work->payload);
+        handOffLatency_->recordDuration(std::chrono::steady_clock::now() - work->handedOff);
+        issued_.fetch_add(1, std::memory_order_release);
+        issued_.notify_all();
+      }
+      if (stopToken.stop_requested()) {
+        break;
+      }
+      pushed_.wait(seen, std::memory_order_acquire);
+      seen = pushed_.load(std::memory_order_acquire);
+    }
+  }
+
+  void SubmissionThread::issue(const Submit& submit) const {
+    ZoneScopedN("SubmissionThread: submit");
+    const VkSubmitInfo submitInfo = {
+        .sType                = VK_STRUCTURE_TYPE_SUBMIT_INFO,
+        .waitSemaphoreCount   = submit.waitSemaphoreCount,
+        .pWaitSemaphores      = submit.waitSemaphores.data(),
+        .pWaitDstStageMask    = submit.waitStages.data(),
+        .commandBufferCount   = submit.commandBufferCount,
+        .pCommandBuffers      = submit.commandBuffers.data(),
+        .signalSemaphoreCount = submit.signalSemaphoreCount,
+        .pSignalSemaphores    = submit.signalSemaphores.data(),
+    };
+    std::scoped_lock lock(context_->queueMutex(submit.queue));
+    VK_CHECK(vkQueueSubmit(submit.queue, 1, &submitInfo, submit.fence));
+  }
+
+  void SubmissionThread::issue(const Present& present) const {
+    ZoneScopedN("SubmissionThread: present");
+    const VkPresentInfoKHR presentInfo = {
+        .sType              = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR,
+        .waitSemaphoreCount = present.waitSemaphore != VK_NULL_HANDLE ? 1u : 0u,
+        .pWaitSemaphores    = &present.waitSemaphore,
+        .swapchainCount     = 1,
+        .pSwapchains        = &present.swapchain,
+        .pImageIndices      = &present.imageIndex,
+    };
+    std::scoped_lock lock(context_->queueMutex(present.queue));
+    VK_CHECK(vkQueuePresentKHR(present.queue, &presentInfo));
+  }
+
+} // namespace VulkanCore
@@ -0,0 +1,112 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <variant>
+
+#include "Common.hpp"
+#include "Utility.hpp"
+#include "core/MpscQueue.hpp"
+
+namespace kst::core {
+  class Counter;
+  class Histogram;
+} // namespace kst::core
+
+namespace VulkanCore {
+
+  class Context;
+
+  // Takes vkQueueSubmit and vkQueuePresentKHR off the recording threads.
+  // Producers copy the submit (command buffers, semaphores, fence) into a
+  // lock-free MPSC queue and return at once; one thread issues the work in
+  // hand-off order, holding the queue's mutex like any other submitter.
+  // Fences need no special care: waiting on a fence whose submit has not been
+  // issued yet simply waits longer.
+  //
+  // Every hand-off returns a ticket; waitFor(ticket) blocks until that item,
+  // and everything handed off before it, has been issued to the driver.
+  class SubmissionThread final {
+  public:
+    static constexpr uint32_t kMaxCommandBuffers = 8;
+    static constexpr uint32_t kMaxSemaphores     = 4;
+
+    explicit SubmissionThread(const Context& context);
+
+    // Issues everything still queued, then joins
+    ~SubmissionThread();
+
+    SubmissionThread(const SubmissionThread&)            = delete;
+    SubmissionThread& operator=(const SubmissionThread&) = delete;
+
+    // submitInfo must not carry a pNext chain; the arrays it points to are
+    // copied, so they only need to live until this returns
+    uint64_t submit(VkQueue queue, const VkSubmitInfo& submitInfo, VkFence fence);
+
+    uint64_t present(
+        VkQueue queue,
+        VkSwapchainKHR swapchain,
+        uint32_t imageIndex,
+        VkSemaphore waitSemaphore
+    );
+
+    // Ticket 0 and tickets from another SubmissionThread return immediately
+    void waitFor(uint64_t ticket) const;
+
+    // Blocks until everything handed off so far has been issued
+    void waitIdle() const;
+
+  private:
+    // No default member initializers: Work's variant needs these default
+    // constructible before SubmissionThread is complete. Both are always
+    // built with designated initializers, which zero the rest.
+    struct Submit {
+      VkQueue queue;
+      VkFence fence;
+      uint32_t commandBufferCount;
+      uint32_t waitSemaphoreCount;
+      uint32_t signalSemaphoreCount;
+      std::array<VkCommandBuffer, kMaxCommandBuffers> commandBuffers;
+      std::array<VkSemaphore, kMaxSemaphores> waitSemaphores;
+      std::array<VkPipelineStageFlags, kMaxSemaphores> waitStages;
+      std::array<VkSemaphore, kMaxSemaphores> signalSemaphores;
+    };
+
+    struct Present {
+      VkQueue queue;
+      VkSwapchainKHR swapchain;
+      uint32_t imageIndex;
+      VkSemaphore waitSemaphore;
+    };
+
+    struct Work {
+      std::variant<Submit, Present> payload;
+      std::chrono::steady_clock::time_point handedOff;
+    };
+
+    uint64_t push(Work&& work);
+
+    void run(const std::stop_token& stopToken);
+
+    void issue(const Submit& submit) const;
+    void issue(const Present& present) const;
+
+  private:
+    const Context* context_ = nullptr;
+    std::unique_ptr<kst::core::MpscQueue<Work, 256>> queue_;
+    // Bumped after every push (and on stop) so the thread can sleep on it
+    std::atomic<uint64_t> pushed_{0};
+    // Highest ticket handed out so far
+    std::atomic<uint64_t> lastTicket_{0};
+    // Tickets are queue positions + 1; everything up to issued_ has been issued
+    std::atomic<uint64_t> issued_{0};
+    kst::core::Counter* fullStalls_       = nullptr;
+    kst::core::Histogram* handOffLatency_ = nullptr;
+    std::jthread thread_;
+  };
+
+} // namespace VulkanCore
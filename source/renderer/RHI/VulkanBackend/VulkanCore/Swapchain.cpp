@@ -8,15 +8,43 @@
 #include "Context.hpp"
 #include "Framebuffer.hpp"
 #include "PhysicalDevice.hpp"
+#include "SubmissionThread.hpp"
 #include "Texture.hpp"
+#include "core/Metrics.hpp"
 
 namespace VulkanCore {
 
+namespace {
+struct SwapchainMetrics {
+  kst::core::Counter& presents;
+  kst::core::Histogram& acquireWait;
+  kst::core::Histogram& frameTime;
+  kst::core::Gauge& images;
+};
+
+SwapchainMetrics& swapchainMetrics() {
+  auto& registry = kst::core::MetricsRegistry::instance();
+  static SwapchainMetrics metrics{
+      .presents = registry.counter("kst_swapchain_presents_total", "Images presented"),
+      .acquireWait = registry.histogram("kst_swapchain_acquire_wait_seconds",
+                                        "CPU time spent acquiring the next image", {}, 1e-9),
+      .frameTime = registry.histogram("kst_frame_time_seconds",
+                                      "Interval between consecutive presents", {}, 1e-9),
+      .images = registry.gauge("kst_swapchain_images", "Images in the swapchain"),
+  };
+  return metrics;
+}
+}  // namespace
+
 Swapchain::Swapchain(const Context& context, const PhysicalDevice& physicalDevice,
                      VkSurfaceKHR surface, VkQueue presentQueue, VkFormat imageFormat,
                      VkColorSpaceKHR imageClorSpace, VkPresentModeKHR presentMode,
                      VkExtent2D extent, const std::string& name)
-    : device_{context.device()}, presentQueue_{presentQueue}, extent_{extent} {
+    : context_{&context},
+      device_{context.device()},
+      presentQueue_{presentQueue},
+      presentQueueMutex_{&context.queueMutex(presentQueue)},
+      extent_{extent} {
   const uint32_t numImages =
       std::clamp(physicalDevice.surfaceCapabilities().minImageCount + 1,
                  physicalDevice.surfaceCapabilities().minImageCount,
@@ -54,32 +82,43 @@ Swapchain::Swapchain(const Context& context, const PhysicalDevice& physicalDevic
   context.setVkObjectname(swapchain_, VK_OBJECT_TYPE_SWAPCHAIN_KHR, "Swapchain: " + name);
 
   createTextures(context, imageFormat, extent);
+  swapchainMetrics().images.set(static_cast<double>(images_.size()));
 
   createSemaphores(context);
 
-  const VkFenceCreateInfo fenceci = {
-      .sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO,
-      .flags = VK_FENCE_CREATE_SIGNALED_BIT,
-  };
-  VK_CHECK(vkCreateFence(device_, &fenceci, nullptr, &acquireFence_));
+  acquireFence_ = context.fencePool().acquire("Fence: swapchain acquire");
 }
 
 Swapchain::~Swapchain() {
-  VK_CHECK(vkWaitForFences(device_, 1, &acquireFence_, VK_TRUE, UINT64_MAX));
-  vkDestroyFence(device_, acquireFence_, nullptr);
-  vkDestroySemaphore(device_, imageRendered_, nullptr);
-  vkDestroySemaphore(device_, imageAvailable_, nullptr);
+  if (auto* submissionThread = context_ ? context_->submissionThread() : nullptr) {
+    submissionThread->waitFor(presentTicket_);
+  }
+  if (acquirePending_) {
+    VK_CHECK(vkWaitForFences(device_, 1, &acquireFence_, VK_TRUE, UINT64_MAX));
+  }
+  context_->fencePool().release(acquireFence_);
+  // Recreating the swapchain picks these up again once the last frame retired
+  context_->semaphorePool().releaseWhenRetired(imageRendered_);
+  context_->semaphorePool().releaseWhenRetired(imageAvailable_);
   vkDestroySwapchainKHR(device_, swapchain_, nullptr);
 }
 
 std::shared_ptr<Texture> Swapchain::acquireImage() {
   ZoneScopedN("Swapchain: acquireImage");
 
-  VK_CHECK(vkWaitForFences(device_, 1, &acquireFence_, VK_TRUE, UINT64_MAX));
-  VK_CHECK(vkResetFences(device_, 1, &acquireFence_));
+  const auto waitStart = std::chrono::steady_clock::now();
+  if (auto* submissionThread = context_->submissionThread()) {
+    submissionThread->waitFor(presentTicket_);
+  }
+  if (acquirePending_) {
+    VK_CHECK(vkWaitForFences(device_, 1, &acquireFence_, VK_TRUE, UINT64_MAX));
+    VK_CHECK(vkResetFences(device_, 1, &acquireFence_));
+  }
 
   VK_CHECK(vkAcquireNextImageKHR(device_, swapchain_, UINT64_MAX, imageAvailable_,
                                  acquireFence_, &imageIndex_));
+  acquirePending_ = true;
+  swapchainMetrics().acquireWait.recordDuration(std::chrono::steady_clock::now() - waitStart);
   return images_[imageIndex_];
 }
 
@@ -110,7 +149,21 @@ void Swapchain::present() const {
       .pSwapchains = &swapchain_,
       .pImageIndices = &imageIndex_,
   };
-  VK_CHECK(vkQueuePresentKHR(presentQueue_, &presentInfo));
+  if (auto* submissionThread = context_->submissionThread()) {
+    presentTicket_ =
+        submissionThread->present(presentQueue_, swapchain_, imageIndex_, imageRendered_);
+  } else {
+    std::scoped_lock lock(*presentQueueMutex_);
+    VK_CHECK(vkQueuePresentKHR(presentQueue_, &presentInfo));
+  }
+
+  auto& metrics = swapchainMetrics();
+  const auto now = std::chrono::steady_clock::now();
+  if (lastPresent_ != std::chrono::steady_clock::time_point{}) {
+    metrics.frameTime.recordDuration(now - lastPresent_);
+  }
+  lastPresent_ = now;
+  metrics.presents.add();
 }
 
 void Swapchain::createTextures(const Context& context, VkFormat imageFormat,
@@ -135,16 +188,10 @@ void Swapchain::createTextures(const Context& context, VkFormat imageFormat,
 }
 
 void Swapchain::createSemaphores(const Context& context) {
-  const VkSemaphoreCreateInfo semaphoreInfo{
-      .sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO,
-  };
-  VK_CHECK(vkCreateSemaphore(device_, &semaphoreInfo, nullptr, &imageAvailable_));
-  context.setVkObjectname(imageAvailable_, VK_OBJECT_TYPE_SEMAPHORE,
-                          "Semaphore: swapchain image available semaphore");
-
-  VK_CHECK(vkCreateSemaphore(device_, &semaphoreInfo, nullptr, &imageRendered_));
-  context.setVkObjectname(imageRendered_, VK_OBJECT_TYPE_SEMAPHORE,
-                          "Semaphore: swapchain image presented semaphore");
+  imageAvailable_ =
+      context.semaphorePool().acquire("Semaphore: swapchain image available semaphore");
+  imageRendered_ =
+      context.semaphorePool().acquire("Semaphore: swapchain image presented semaphore");
 }
 
 }  // namespace VulkanCore
@@ -1,6 +1,8 @@
 #pragma once
 
+#include <chrono>
 #include <memory>
+#include <mutex>
 #include <vector>
 
 #include "Common.hpp"
@@ -37,6 +39,9 @@ class Swapchain final {
 
   VkExtent2D extent() const { return extent_; }
 
+  // With a submission thread the present is only handed off. The swapchain
+  // and its semaphores are shared with it, so the next acquireImage() waits
+  // until it has been issued; do the CPU work of the next frame before that.
   void present() const;
 
   VkSubmitInfo createSubmitInfo(const VkCommandBuffer* buffer,
@@ -57,9 +62,11 @@ class Swapchain final {
   void createSemaphores(const Context& context);
 
  private:
+  const Context* context_ = nullptr;
   VkDevice device_ = VK_NULL_HANDLE;
   VkSwapchainKHR swapchain_ = VK_NULL_HANDLE;
   VkQueue presentQueue_ = VK_NULL_HANDLE;
+  std::mutex* presentQueueMutex_ = nullptr;
   std::vector<std::shared_ptr<Texture>> images_;
   VkSemaphore imageAvailable_ = VK_NULL_HANDLE;
   VkSemaphore imageRendered_ = VK_NULL_HANDLE;
@@ -67,6 +74,12 @@ class Swapchain final {
   VkExtent2D extent_;
   VkFormat imageFormat_;
   VkFence acquireFence_ = VK_NULL_HANDLE;
+  // Pooled fences start unsignaled, so the first acquire has nothing to wait for
+  bool acquirePending_ = false;
+  // Present-to-present interval feeds the frame time histogram
+  mutable std::chrono::steady_clock::time_point lastPresent_;
+  // Submission thread ticket of the last handed-off present
+  mutable uint64_t presentTicket_ = 0;
 };
 
 }  // namespace VulkanCore
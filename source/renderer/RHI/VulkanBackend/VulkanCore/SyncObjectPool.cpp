@@ -0,0 +1,150 @@
+#include "SyncObjectPool.hpp"
+
+#include <type_traits>
+#include <tracy/Tracy.hpp>
+
+#include "Context.hpp"
+#include "core/Metrics.hpp"
+
+namespace VulkanCore {
+
+  namespace {
+    template <typename Handle>
+    constexpr const char* poolLabel() {
+      return std::is_same_v<Handle, VkFence> ? "pool=\"fence\"" : "pool=\"semaphore\"";
+    }
+
+    template <typename Handle>
+    constexpr VkObjectType objectType() {
+      return std::is_same_v<Handle, VkFence> ? VK_OBJECT_TYPE_FENCE : VK_OBJECT_TYPE_SEMAPHORE;
+    }
+  } // namespace
+
+  template <typename Handle>
+  SyncObjectPool<Handle>::SyncObjectPool(const Context& context)
+      : context_(&context), device_(context.device()) {
+    auto& metrics     = kst::core::MetricsRegistry::instance();
+    const auto labels = std::string(poolLabel<Handle>());
+    hitCounter_       = &metrics.counter(
+        "kst_sync_pool_acquires_total",
+        "Fences and semaphores handed out by the pools",
+        labels + ",result=\"hit\""
+    );
+    missCounter_ = &metrics.counter(
+        "kst_sync_pool_acquires_total",
+        "Fences and semaphores handed out by the pools",
+        labels + ",result=\"miss\""
+    );
+    objectGauge_ = &metrics.gauge(
+        "kst_sync_pool_objects", "Fences and semaphores created by the pools", labels
+    );
+  }
+
+  template <typename Handle>
+  SyncObjectPool<Handle>::~SyncObjectPool() {
+    ASSERT(available_.size() == stats_.created, "Sync objects are still in use");
+    for (const auto handle : available_) {
+      destroy(handle);
+    }
+    objectGauge_->add(-static_cast<double>(available_.size()));
+  }
+
+  template <typename Handle>
+  Handle SyncObjectPool<Handle>::acquire(const std::string& name) {
+    Handle handle = VK_NULL_HANDLE;
+    {
+      std::scoped_lock lock(mutex_);
+      if (!available_.empty()) {
+        handle = available_.back();
+        available_.pop_back();
+        ++stats_.hits;
+      } else {
+        ++stats_.misses;
+        ++stats_.created;
+      }
+    }
+
+    if (handle != VK_NULL_HANDLE) {
+      hitCounter_->add();
+    } else {
+      ZoneScopedN("SyncObjectPool: create");
+      handle = create();
+      missCounter_->add();
+      objectGauge_->add(1.0);
+    }
+    if (!name.empty()) {
+      context_->setVkObjectname(handle, objectType<Handle>(), name);
+    }
+    return handle;
+  }
+
+  template <typename Handle>
+  void SyncObjectPool<Handle>::release(Handle handle) {
+    if (handle == VK_NULL_HANDLE) {
+      return;
+    }
+    reset(handle);
+    std::scoped_lock lock(mutex_);
+    available_.push_back(handle);
+  }
+
+  template <typename Handle>
+  void SyncObjectPool<Handle>::releaseWhenRetired(Handle handle) {
+    if (handle == VK_NULL_HANDLE) {
+      return;
+    }
+    context_->deletionQueue().enqueue([this, handle]() { release(handle); });
+  }
+
+  template <typename Handle>
+  SyncPoolStats SyncObjectPool<Handle>::stats() const {
+    std::scoped_lock lock(mutex_);
+    auto stats      = stats_;
+    stats.available = available_.size();
+    return stats;
+  }
+
+  template <>
+  VkFence SyncObjectPool<VkFence>::create() const {
+    const VkFenceCreateInfo fenceInfo = {
+        .sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO,
+    };
+    VkFence fence = VK_NULL_HANDLE;
+    VK_CHECK(vkCreateFence(device_, &fenceInfo, nullptr, &fence));
+    return fence;
+  }
+
+  template <>
+  void SyncObjectPool<VkFence>::reset(VkFence fence) const {
+    VK_CHECK(vkResetFences(device_, 1, &fence));
+  }
+
+  template <>
+  void SyncObjectPool<VkFence>::destroy(VkFence fence) const {
+    vkDestroyFence(device_, fence, nullptr);
+  }
+
+  template <>
+  VkSemaphore SyncObjectPool<VkSemaphore>::create() const {
+    const VkSemaphoreCreateInfo semaphoreInfo = {
+        .sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO,
+    };
+    VkSemaphore semaphore = VK_NULL_HANDLE;
+    VK_CHECK(vkCreateSemaphore(device_, &semaphoreInfo, nullptr, &semaphore));
+    return semaphore;
+  }
+
+  template <>
+  void SyncObjectPool<VkSemaphore>::reset(VkSemaphore) const {
+    // Binary semaphores are unsignaled again once their signal was waited on
+  }
+
+  template <>
+  void SyncObjectPool<VkSemaphore>::destroy(VkSemaphore semaphore) const {
+    vkDestroySemaphore(device_, semaphore, nullptr);
+  }
+
+  template class SyncObjectPool<VkFence>;
+  template class SyncObjectPool<VkSemaphore>;
+
+} // namespace VulkanCore
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "Common.hpp"
+#include "Utility.hpp"
+
+namespace kst::core {
+  class Counter;
+  class Gauge;
+} // namespace kst::core
+
+namespace VulkanCore {
+
+  class Context;
+
+  struct SyncPoolStats {
+    uint64_t hits      = 0; // acquire() served from the free list
+    uint64_t misses    = 0; // acquire() had to create a new object
+    uint64_t created   = 0;
+    uint64_t available = 0;
+
+    double hitRate() const {
+      const uint64_t total = hits + misses;
+      return total == 0 ? 1.0 : static_cast<double>(hits) / static_cast<double>(total);
+    }
+  };
+
+  // Recycles VkFences or binary VkSemaphores so steady-state frames create no
+  // sync objects. acquire() hands out an unsignaled object; give it back with
+  // release() once nothing on the GPU can touch it anymore (a fence that was
+  // waited on, or never submitted), or with releaseWhenRetired() to have the
+  // deletion queue return it once the work recorded so far has retired, the
+  // usual way for per-frame objects. Fences are reset on the way back in; a
+  // semaphore must come back unsignaled, i.e. every signal has been waited on.
+  // Safe to use from any thread. Hit rates are exported as
+  // kst_sync_pool_acquires_total{pool, result}.
+  template <typename Handle>
+  class SyncObjectPool final {
+  public:
+    explicit SyncObjectPool(const Context& context);
+
+    // Destroys the pooled objects; everything acquired must be back by now
+    ~SyncObjectPool();
+
+    SyncObjectPool(const SyncObjectPool&)            = delete;
+    SyncObjectPool& operator=(const SyncObjectPool&) = delete;
+
+    Handle acquire(const std::string& name = "");
+
+    void release(Handle handle);
+
+    void releaseWhenRetired(Handle handle);
+
+    SyncPoolStats stats() const;
+
+  private:
+    Handle create() const;
+    void reset(Handle handle) const;
+    void destroy(Handle handle) const;
+
+  private:
+    const Context* context_ = nullptr;
+    VkDevice device_        = VK_NULL_HANDLE;
+    mutable std::mutex mutex_;
+    std::vector<Handle> available_;
+    SyncPoolStats stats_;
+    // Process-wide series shared by every pool of this kind
+    kst::core::Counter* hitCounter_  = nullptr;
+    kst::core::Counter* missCounter_ = nullptr;
+    kst::core::Gauge* objectGauge_   = nullptr;
+  };
+
+  using FencePool     = SyncObjectPool<VkFence>;
+  using SemaphorePool = SyncObjectPool<VkSemaphore>;
+
+} // namespace VulkanCore
@@ -5,7 +5,9 @@
 #endif
 
 #include "Buffer.hpp"
+#include "CommandCapture.hpp"
 #include "Context.hpp"
+#include "core/Metrics.hpp"
 
 namespace VulkanCore {
 
@@ -82,6 +84,26 @@ Texture::Texture(const Context& context, VkImageType type, VkFormat format,
 
   imageView_ =
       createImageView(context, imageViewType, format_, mipLevels_, layerCount, name);
+
+  if (auto* capture = context.commandCapture()) {
+    const CaptureTextureInfo info = {
+        .type = type,
+        .format = format,
+        .flags = flags,
+        .usage = usageFlags,
+        .extents = extents,
+        .mipLevels = mipLevels_,
+        .layerCount = layerCount,
+        .memoryFlags = memoryFlags,
+        .samples = msaaSamples_,
+        .tiling = imageTiling_,
+        .multiview = multiview_,
+        .external = false,
+    };
+    capture->onTextureCreated(image_, info);
+    capture->onImageViewCreated(imageView_, image_, CaptureViewKind::Default,
+                                kCaptureWholeMip);
+  }
 }
 
 Texture::Texture(const Context& context, VkDevice device, VkImage image, VkFormat format,
@@ -100,18 +122,51 @@ Texture::Texture(const Context& context, VkDevice device, VkImage image, VkForma
   imageView_ = createImageView(
       context, !multiview_ ? VK_IMAGE_VIEW_TYPE_2D : VK_IMAGE_VIEW_TYPE_2D_ARRAY, format,
       1, layerCount_, name);
+
+  // Swapchain images are replayed as offscreen textures
+  if (auto* capture = context.commandCapture()) {
+    const CaptureTextureInfo info = {
+        .type = VK_IMAGE_TYPE_2D,
+        .format = format,
+        .flags = 0,
+        .usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT |
+                 VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
+        .extents = extents,
+        .mipLevels = 1,
+        .layerCount = layerCount_,
+        .memoryFlags = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+        .samples = VK_SAMPLE_COUNT_1_BIT,
+        .tiling = VK_IMAGE_TILING_OPTIMAL,
+        .multiview = multiview_,
+        .external = true,
+    };
+    capture->onTextureCreated(image_, info);
+    capture->onImageViewCreated(imageView_, image_, CaptureViewKind::Default,
+                                kCaptureWholeMip);
+  }
 }
 
 Texture::~Texture() {
-  for (const auto imageView : imageViewFramebuffers_) {
-    vkDestroyImageView(context_.device(), imageView.second, nullptr);
+  if (auto* capture = context_.commandCapture()) {
+    capture->onDestroyed(CaptureObject::Texture, (uint64_t)image_);
   }
 
-  vkDestroyImageView(context_.device(), imageView_, nullptr);
-
-  if (ownsVkImage_) {
-    vmaDestroyImage(vmaAllocator_, image_, vmaAllocation_);
+  std::vector<VkImageView> imageViews{imageView_};
+  for (const auto imageView : imageViewFramebuffers_) {
+    imageViews.push_back(imageView.second);
   }
+
+  context_.deletionQueue().enqueue(
+      [device = context_.device(), allocator = vmaAllocator_, image = image_,
+       allocation = vmaAllocation_, ownsImage = ownsVkImage_,
+       imageViews = std::move(imageViews)]() {
+        for (const auto imageView : imageViews) {
+          vkDestroyImageView(device, imageView, nullptr);
+        }
+        if (ownsImage) {
+          vmaDestroyImage(allocator, image, allocation);
+        }
+      });
 }
 
 VkImageView Texture::vkImageView(uint32_t mipLevel) {
@@ -128,6 +183,10 @@ VkImageView Texture::vkImageView(uint32_t mipLevel) {
     imageViewFramebuffers_[mipLevel] =
         createImageView(context_, imageViewType, format_, 1, VK_REMAINING_ARRAY_LAYERS,
                         "Image View for Framebuffer: " + debugName_);
+    if (auto* capture = context_.commandCapture()) {
+      capture->onImageViewCreated(imageViewFramebuffers_[mipLevel], image_,
+                                  CaptureViewKind::MipChain, mipLevel);
+    }
   }
 
   return imageViewFramebuffers_[mipLevel];
@@ -151,8 +210,16 @@ void Texture::uploadOnly(VkCommandBuffer cmdBuffer, const Buffer* stagingBuffer,
                          void* data, uint32_t layer) {
   context_.beginDebugUtilsLabel(cmdBuffer, "Uploading image", {1.0f, 0.0f, 0.0f, 1.0f});
 
-  stagingBuffer->copyDataToBuffer(
-      data, pixelSizeInBytes() * extents_.width * extents_.height * extents_.depth);
+  const size_t uploadSize =
+      pixelSizeInBytes() * extents_.width * extents_.height * extents_.depth;
+  stagingBuffer->copyDataToBuffer(data, uploadSize);
+
+  static auto& uploads = kst::core::MetricsRegistry::instance().counter(
+      "kst_uploads_total", "Staged uploads recorded", "kind=\"texture\"");
+  static auto& uploadBytes = kst::core::MetricsRegistry::instance().counter(
+      "kst_upload_bytes_total", "Bytes copied through staging buffers", "kind=\"texture\"");
+  uploads.add();
+  uploadBytes.add(uploadSize);
 
   if (layout_ == VK_IMAGE_LAYOUT_UNDEFINED) {
     transitionImageLayout(cmdBuffer, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
@@ -555,6 +622,9 @@ std::vector<std::shared_ptr<VkImageView>> Texture::generateViewForEachMips() {
     VK_CHECK(vkCreateImageView(context_.device(), &imageViewInfo, nullptr,
                                output.back().get()));
     context_.setVkObjectname(imageView_, VK_OBJECT_TYPE_IMAGE_VIEW, "Image view per mip");
+    if (auto* capture = context_.commandCapture()) {
+      capture->onImageViewCreated(*output.back(), image_, CaptureViewKind::SingleMip, i);
+    }
   }
   return output;
 }
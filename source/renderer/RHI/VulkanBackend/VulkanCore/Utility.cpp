@@ -1,6 +1,7 @@
 #include "Utility.hpp"
 
 #include <algorithm>
+#include <atomic>
 #include <cstring>
 #include <fstream>
 
@@ -18,6 +19,12 @@ uint32_t fnv_hash(const void* key, int len) {
   return h;
 }
 
+size_t threadShard(size_t shardCount) {
+  static std::atomic<size_t> nextThread{0};
+  thread_local const size_t thread = nextThread.fetch_add(1, std::memory_order_relaxed);
+  return thread % shardCount;
+}
+
 void writeFile(const std::string& filePath,
                const std::vector<char>& fileContents, bool isBinary) {
   if (isBinary) {
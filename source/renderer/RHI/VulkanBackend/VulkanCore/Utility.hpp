@@ -34,6 +34,10 @@ namespace util {
 
   int endsWith(const char* s, const char* part);
 
+  // Stable per-thread index in [0, shardCount). Threads are numbered in the
+  // order they first ask, so N threads spread evenly over N or more shards.
+  size_t threadShard(size_t shardCount);
+
   std::unordered_set<std::string> filterExtensions(
       std::vector<std::string> availableExtensions,
       std::vector<std::string> requestedExtensions
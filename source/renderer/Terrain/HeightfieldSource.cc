@@ -0,0 +1,56 @@
+#include "HeightfieldSource.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#include "VulkanBackend/VulkanCore/Utility.hpp"
+
+namespace kst::renderer {
+  HeightfieldSource::HeightfieldSource(
+      uint32_t width,
+      uint32_t depth,
+      std::vector<float> heights,
+      float sampleSpacing
+  )
+      : m_width(width),
+        m_depth(depth),
+        m_heights(std::move(heights)),
+        m_inverseSpacing(1.0f / sampleSpacing) {
+    ASSERT(width > 0 && depth > 0, "Heightfield can't be empty");
+    ASSERT(m_heights.size() == size_t{width} * depth, "Heightfield size doesn't match");
+  }
+
+  auto HeightfieldSource::height(float x, float z) const -> float {
+    const float u = std::clamp(x * m_inverseSpacing, 0.0f, static_cast<float>(m_width - 1));
+    const float v = std::clamp(z * m_inverseSpacing, 0.0f, static_cast<float>(m_depth - 1));
+
+    const auto x0 = static_cast<uint32_t>(u);
+    const auto z0 = static_cast<uint32_t>(v);
+    const auto x1 = std::min(x0 + 1, m_width - 1);
+    const auto z1 = std::min(z0 + 1, m_depth - 1);
+    const float fx = u - static_cast<float>(x0);
+    const float fz = v - static_cast<float>(z0);
+
+    const float* row0 = m_heights.data() + size_t{z0} * m_width;
+    const float* row1 = m_heights.data() + size_t{z1} * m_width;
+    const float near  = row0[x0] + (row0[x1] - row0[x0]) * fx;
+    const float far   = row1[x0] + (row1[x1] - row1[x0]) * fx;
+    return near + (far - near) * fz;
+  }
+
+  void HeightfieldSource::read(
+      glm::ivec2 first,
+      glm::uvec2 extent,
+      float spacing,
+      std::span<float> heights
+  ) {
+    ASSERT(heights.size() >= size_t{extent.x} * extent.y, "Height span too small");
+    float* out = heights.data();
+    for (uint32_t z = 0; z < extent.y; ++z) {
+      const float worldZ = static_cast<float>(first.y + static_cast<int32_t>(z)) * spacing;
+      for (uint32_t x = 0; x < extent.x; ++x) {
+        *out++ = height(static_cast<float>(first.x + static_cast<int32_t>(x)) * spacing, worldZ);
+      }
+    }
+  }
+} // namespace kst::renderer
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <vector>
+
+#include "TerrainClipmap.hpp"
+
+namespace kst::renderer {
+  /**
+   * @brief TerrainHeightSource over a heightfield held in memory
+   *
+   * Samples are sampleSpacing apart starting at world (0, 0), bilinearly
+   * interpolated and clamped to the edge outside the field. Point sampling
+   * means levels much coarser than the field alias; a streamed source would
+   * read prefiltered tiles instead.
+   */
+  class HeightfieldSource : public TerrainHeightSource {
+  public:
+    HeightfieldSource(
+        uint32_t width,
+        uint32_t depth,
+        std::vector<float> heights,
+        float sampleSpacing = 1.0f
+    );
+
+    void
+    read(glm::ivec2 first, glm::uvec2 extent, float spacing, std::span<float> heights) override;
+
+    auto height(float x, float z) const -> float;
+
+  private:
+    uint32_t m_width = 0;
+    uint32_t m_depth = 0;
+    std::vector<float> m_heights;
+    float m_inverseSpacing = 1.0f;
+  };
+} // namespace kst::renderer
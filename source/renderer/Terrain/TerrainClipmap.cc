@@ -0,0 +1,607 @@
+#include "TerrainClipmap.hpp"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cmath>
+
+#include <glm/gtc/matrix_access.hpp>
+#include <tracy/Tracy.hpp>
+
+#include "core/Metrics.hpp"
+#include "VulkanBackend/VulkanCore/Buffer.hpp"
+#include "VulkanBackend/VulkanCore/CommandQueueManager.hpp"
+#include "VulkanBackend/VulkanCore/Context.hpp"
+#include "VulkanBackend/VulkanCore/Pipeline.hpp"
+#include "VulkanBackend/VulkanCore/Sampler.hpp"
+#include "VulkanBackend/VulkanCore/ShaderModule.hpp"
+#include "VulkanBackend/VulkanCore/Texture.hpp"
+
+namespace kst::renderer {
+  namespace {
+    // Must match shaders/terrain/common.glsl
+    constexpr uint32_t kGroupSize    = 64;
+    constexpr uint32_t kMaxBlockSide = 256; // 8 bits per block coordinate
+
+    // Draw is only in the select set and Heights only in the render set
+    enum Binding : uint32_t {
+      Params  = 0,
+      Blocks  = 1,
+      Draw    = 2,
+      Heights = 2,
+    };
+
+    struct TerrainParams {
+      glm::mat4 viewProjection;
+      std::array<glm::vec4, 6> frustumPlanes;
+      glm::vec4 cameraPosition;
+      glm::vec4 sunDirection;
+      glm::vec4 spacingHeight;
+      glm::uvec4 counts;
+      std::array<glm::ivec4, TerrainClipmap::kMaxLevels> origins;
+    };
+    static_assert(sizeof(TerrainParams) == 480, "TerrainParams must match std140 layout");
+
+    auto shaderPath(const std::string& fileName) -> std::string {
+      return std::string(KST_SHADER_DIR) + "/terrain/" + fileName + ".spv";
+    }
+
+    // Planes pointing inwards, for clip space with depth in [0, 1]
+    auto frustumPlanes(const glm::mat4& viewProjection) -> std::array<glm::vec4, 6> {
+      const glm::vec4 x = glm::row(viewProjection, 0);
+      const glm::vec4 y = glm::row(viewProjection, 1);
+      const glm::vec4 z = glm::row(viewProjection, 2);
+      const glm::vec4 w = glm::row(viewProjection, 3);
+      return {w + x, w - x, w + y, w - y, z, w - z};
+    }
+
+    // Splits [first, first + extent) where it wraps around a window of size
+    auto wrapSpans(int32_t first, uint32_t extent, uint32_t size)
+        -> std::array<std::pair<uint32_t, uint32_t>, 2> {
+      const auto wrapped  = first % static_cast<int32_t>(size);
+      const auto start    = static_cast<uint32_t>(wrapped < 0 ? wrapped + size : wrapped);
+      const uint32_t head = std::min(extent, size - start);
+      return {{{start, head}, {0, extent - head}}};
+    }
+  } // namespace
+
+  TerrainClipmap::TerrainClipmap(
+      VulkanCore::Context& context,
+      TerrainHeightSource& source,
+      const Descriptor& descriptor
+  )
+      : m_context(context),
+        m_source(source),
+        m_descriptor(descriptor),
+        m_textureSize(descriptor.quadsPerSide + 1),
+        m_levels(descriptor.levels) {
+    ASSERT(
+        descriptor.levels > 0 && descriptor.levels <= kMaxLevels,
+        "TerrainClipmap supports 1 to 16 levels"
+    );
+    ASSERT(
+        std::has_single_bit(descriptor.quadsPerSide) && descriptor.quadsPerSide >= 16,
+        "TerrainClipmap quadsPerSide must be a power of two of at least 16"
+    );
+    ASSERT(
+        descriptor.blockQuads > 0 && descriptor.quadsPerSide % descriptor.blockQuads == 0,
+        "TerrainClipmap blockQuads must divide quadsPerSide"
+    );
+    ASSERT(
+        descriptor.uploadTexelsPerFrame >= uint64_t{m_textureSize} * m_textureSize,
+        "TerrainClipmap upload budget can't fit a whole level"
+    );
+    ASSERT(context.isClipDistanceEnabled(), "TerrainClipmap needs shaderClipDistance");
+
+    m_blocksPerSide = descriptor.quadsPerSide / descriptor.blockQuads;
+    ASSERT(m_blocksPerSide <= kMaxBlockSide, "TerrainClipmap has too many blocks per level");
+
+    m_uploadBytesTotal = &core::MetricsRegistry::instance().counter(
+        "kst_upload_bytes_total", "Bytes copied through staging buffers", "kind=\"terrain\""
+    );
+
+    createBuffers();
+    createPipelines();
+  }
+
+  TerrainClipmap::~TerrainClipmap() = default;
+
+  void TerrainClipmap::createBuffers() {
+    const std::string& name = m_descriptor.name;
+
+    // The multiview flag gives the default view the 2D array type over every layer
+    m_heights = std::make_shared<VulkanCore::Texture>(
+        m_context,
+        VK_IMAGE_TYPE_2D,
+        VK_FORMAT_R32_SFLOAT,
+        0,
+        VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT,
+        VkExtent3D{m_textureSize, m_textureSize, 1},
+        1,
+        m_descriptor.levels,
+        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+        false,
+        VK_SAMPLE_COUNT_1_BIT,
+        "Terrain heights: " + name,
+        true
+    );
+    // Only read with texelFetch, which wraps the windows itself
+    m_heightSampler = m_context.createSampler(
+        VK_FILTER_NEAREST,
+        VK_FILTER_NEAREST,
+        VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE,
+        VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE,
+        VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE,
+        0.0f,
+        "Terrain height sampler: " + name
+    );
+
+    const uint32_t blockIndices = m_descriptor.blockQuads * m_descriptor.blockQuads * 6;
+    m_indexBuffer               = m_context.createBuffer(
+        blockIndices * sizeof(uint32_t),
+        VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+        VMA_MEMORY_USAGE_GPU_ONLY,
+        "Terrain block indices: " + name
+    );
+    m_blockBuffer = m_context.createBuffer(
+        static_cast<size_t>(m_descriptor.levels) * m_blocksPerSide * m_blocksPerSide *
+            sizeof(uint32_t),
+        VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+        VMA_MEMORY_USAGE_GPU_ONLY,
+        "Terrain blocks: " + name
+    );
+    m_drawBuffer = m_context.createBuffer(
+        sizeof(VkDrawIndexedIndirectCommand),
+        VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT |
+            VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+        VMA_MEMORY_USAGE_GPU_ONLY,
+        "Terrain draw: " + name
+    );
+
+    for (uint32_t i = 0; i < m_descriptor.framesInFlight; ++i) {
+      m_uniformBuffers.push_back(m_context.createPersistentBuffer(
+          sizeof(TerrainParams),
+          VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
+          "Terrain params " + std::to_string(i) + ": " + name
+      ));
+      m_stagingBuffers.push_back(m_context.createPersistentBuffer(
+          m_descriptor.uploadTexelsPerFrame * sizeof(float),
+          VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+          "Terrain staging " + std::to_string(i) + ": " + name
+      ));
+    }
+  }
+
+  void TerrainClipmap::createPipelines() {
+    const std::string& name = m_descriptor.name;
+
+    const auto binding = [](uint32_t index, VkDescriptorType type, VkShaderStageFlags stages) {
+      return VkDescriptorSetLayoutBinding{
+          .binding         = index,
+          .descriptorType  = type,
+          .descriptorCount = 1,
+          .stageFlags      = stages,
+      };
+    };
+
+    auto selectShader = m_context.createShaderModule(
+        shaderPath("select.comp"), VK_SHADER_STAGE_COMPUTE_BIT, "Terrain select: " + name
+    );
+    m_shaders.push_back(selectShader);
+
+    constexpr VkShaderStageFlags compute = VK_SHADER_STAGE_COMPUTE_BIT;
+    const VulkanCore::Pipeline::ComputePipelineDescriptor selectDesc = {
+        .sets_ =
+            {
+                {
+                    .set_ = 0,
+                    .bindings_ =
+                        {
+                            binding(Binding::Params, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, compute),
+                            binding(Binding::Blocks, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, compute),
+                            binding(Binding::Draw, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, compute),
+                        },
+                },
+            },
+        .computeShader_ = selectShader,
+    };
+    m_selectPipeline = m_context.createComputePipeline(selectDesc, "Terrain select: " + name);
+
+    auto vertexShader = m_context.createShaderModule(
+        shaderPath("terrain.vert"), VK_SHADER_STAGE_VERTEX_BIT, "Terrain vertex: " + name
+    );
+    auto fragmentShader = m_context.createShaderModule(
+        shaderPath("terrain.frag"), VK_SHADER_STAGE_FRAGMENT_BIT, "Terrain fragment: " + name
+    );
+    m_shaders.push_back(vertexShader);
+    m_shaders.push_back(fragmentShader);
+
+    constexpr VkShaderStageFlags vertex = VK_SHADER_STAGE_VERTEX_BIT;
+    const VulkanCore::Pipeline::GraphicsPipelineDescriptor renderDesc = {
+        .sets_ =
+            {
+                {
+                    .set_ = 0,
+                    .bindings_ =
+                        {
+                            binding(
+                                Binding::Params,
+                                VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,
+                                vertex | VK_SHADER_STAGE_FRAGMENT_BIT
+                            ),
+                            binding(Binding::Blocks, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, vertex),
+                            binding(
+                                Binding::Heights, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, vertex
+                            ),
+                        },
+                },
+            },
+        .vertexShader_        = vertexShader,
+        .fragmentShader_      = fragmentShader,
+        .dynamicStates_       = {VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR},
+        .useDynamicRendering_ = true,
+        .colorTextureFormats  = {m_descriptor.colorFormat},
+        .depthTextureFormat   = m_descriptor.depthFormat,
+        .viewport             = VkExtent2D{1, 1},
+    };
+    m_renderPipeline =
+        m_context.createGraphicsPipeline(renderDesc, VK_NULL_HANDLE, "Terrain render: " + name);
+
+    m_selectPipeline->allocateDescriptors({
+        {.set_ = 0, .count_ = m_descriptor.framesInFlight, .name_ = "Terrain select"},
+    });
+    m_renderPipeline->allocateDescriptors({
+        {.set_ = 0, .count_ = m_descriptor.framesInFlight, .name_ = "Terrain render"},
+    });
+    // The span overload binds for SHADER_READ_ONLY_OPTIMAL, where the heights live
+    std::array<std::shared_ptr<VulkanCore::Texture>, 1> heights = {m_heights};
+    for (uint32_t frame = 0; frame < m_descriptor.framesInFlight; ++frame) {
+      for (const auto& pipeline : {m_selectPipeline, m_renderPipeline}) {
+        pipeline->bindResource(
+            0,
+            Binding::Params,
+            frame,
+            m_uniformBuffers[frame],
+            0,
+            sizeof(TerrainParams),
+            VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER
+        );
+        pipeline->bindResource(
+            0,
+            Binding::Blocks,
+            frame,
+            m_blockBuffer,
+            0,
+            m_blockBuffer->size(),
+            VK_DESCRIPTOR_TYPE_STORAGE_BUFFER
+        );
+      }
+      m_selectPipeline->bindResource(
+          0,
+          Binding::Draw,
+          frame,
+          m_drawBuffer,
+          0,
+          m_drawBuffer->size(),
+          VK_DESCRIPTOR_TYPE_STORAGE_BUFFER
+      );
+      m_renderPipeline->bindResource(
+          0, Binding::Heights, frame, std::span(heights), m_heightSampler
+      );
+    }
+    m_selectPipeline->updateDescriptorSets();
+    m_renderPipeline->updateDescriptorSets();
+  }
+
+  void TerrainClipmap::initialize(
+      VulkanCore::CommandQueueManager& queueManager,
+      VkCommandBuffer commandBuffer
+  ) {
+    ZoneScopedN("TerrainClipmap: initialize");
+
+    // Two triangles per quad of the (blockQuads + 1)^2 vertex grid; the
+    // vertex shader derives positions from gl_VertexIndex
+    const uint32_t quads = m_descriptor.blockQuads;
+    std::vector<uint32_t> indices;
+    indices.reserve(quads * quads * 6);
+    for (uint32_t z = 0; z < quads; ++z) {
+      for (uint32_t x = 0; x < quads; ++x) {
+        const uint32_t corner = z * (quads + 1) + x;
+        const uint32_t below  = corner + quads + 1;
+        indices.insert(indices.end(), {corner, below, corner + 1, corner + 1, below, below + 1});
+      }
+    }
+    m_context.uploadToGPUBuffer(
+        queueManager,
+        commandBuffer,
+        m_indexBuffer.get(),
+        indices.data(),
+        static_cast<long>(indices.size() * sizeof(uint32_t))
+    );
+
+    const VkDrawIndexedIndirectCommand draw = {
+        .indexCount = static_cast<uint32_t>(indices.size()),
+    };
+    m_context.uploadToGPUBuffer(
+        queueManager, commandBuffer, m_drawBuffer.get(), &draw, sizeof(draw)
+    );
+
+    const VkMemoryBarrier barrier = {
+        .sType         = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+        .srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+        .dstAccessMask = VK_ACCESS_INDEX_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT |
+                         VK_ACCESS_INDIRECT_COMMAND_READ_BIT,
+    };
+    vkCmdPipelineBarrier(
+        commandBuffer,
+        VK_PIPELINE_STAGE_TRANSFER_BIT,
+        VK_PIPELINE_STAGE_VERTEX_INPUT_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT |
+            VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT,
+        0,
+        1,
+        &barrier,
+        0,
+        nullptr,
+        0,
+        nullptr
+    );
+
+    m_heights->transitionImageLayout(commandBuffer, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+  }
+
+  auto TerrainClipmap::levelOrigin(uint32_t level, glm::vec3 cameraPosition) const
+      -> glm::ivec2 {
+    // Snapped to the next coarser grid, so the window starts on an even
+    // texel and its edges lie on coarser vertices
+    const float coarseSpacing = m_descriptor.baseSpacing * static_cast<float>(2u << level);
+    const glm::ivec2 coarse(
+        static_cast<int32_t>(std::floor(cameraPosition.x / coarseSpacing)),
+        static_cast<int32_t>(std::floor(cameraPosition.z / coarseSpacing))
+    );
+    return 2 * coarse - glm::ivec2(static_cast<int32_t>(m_descriptor.quadsPerSide / 2));
+  }
+
+  auto TerrainClipmap::changedRegions(const Level& level, glm::ivec2 origin) const
+      -> std::vector<Region> {
+    const auto size  = static_cast<int32_t>(m_textureSize);
+    const auto delta = origin - level.origin;
+    if (!level.valid || std::abs(delta.x) >= size || std::abs(delta.y) >= size) {
+      return {{origin, glm::uvec2(m_textureSize)}};
+    }
+
+    // Columns entering the window over its full height, then rows entering
+    // it over the columns that stayed
+    std::vector<Region> regions;
+    if (delta.x != 0) {
+      const int32_t first = delta.x > 0 ? level.origin.x + size : origin.x;
+      regions.push_back({
+          {first, origin.y},
+          {static_cast<uint32_t>(std::abs(delta.x)), m_textureSize},
+      });
+    }
+    if (delta.y != 0) {
+      const int32_t first = delta.y > 0 ? level.origin.y + size : origin.y;
+      regions.push_back({
+          {std::max(origin.x, level.origin.x), first},
+          {
+              static_cast<uint32_t>(size - std::abs(delta.x)),
+              static_cast<uint32_t>(std::abs(delta.y)),
+          },
+      });
+    }
+    return regions;
+  }
+
+  void TerrainClipmap::addCopies(uint32_t level, const Region& region, uint64_t stagingTexel) {
+    // A region wraps around the layer at most once per axis
+    const auto columns = wrapSpans(region.first.x, region.extent.x, m_textureSize);
+    const auto rows    = wrapSpans(region.first.y, region.extent.y, m_textureSize);
+
+    uint32_t rowOffset = 0;
+    for (const auto& [rowStart, rowCount] : rows) {
+      uint32_t columnOffset = 0;
+      for (const auto& [columnStart, columnCount] : columns) {
+        if (rowCount > 0 && columnCount > 0) {
+          const uint64_t texel =
+              stagingTexel + uint64_t{rowOffset} * region.extent.x + columnOffset;
+          m_copies.push_back({
+              .bufferOffset      = texel * sizeof(float),
+              .bufferRowLength   = region.extent.x,
+              .bufferImageHeight = region.extent.y,
+              .imageSubresource =
+                  {
+                      .aspectMask     = VK_IMAGE_ASPECT_COLOR_BIT,
+                      .mipLevel       = 0,
+                      .baseArrayLayer = level,
+                      .layerCount     = 1,
+                  },
+              .imageOffset = {static_cast<int32_t>(columnStart), static_cast<int32_t>(rowStart), 0},
+              .imageExtent = {columnCount, rowCount, 1},
+          });
+        }
+        columnOffset += columnCount;
+      }
+      rowOffset += rowCount;
+    }
+  }
+
+  void TerrainClipmap::update(VkCommandBuffer commandBuffer, const TerrainFrameInfo& frame) {
+    ZoneScopedN("TerrainClipmap: update");
+
+    const uint32_t frameSlot = m_frameIndex % m_descriptor.framesInFlight;
+    const auto& staging      = m_stagingBuffers[frameSlot];
+    auto* stagingTexels      = static_cast<float*>(staging->map());
+
+    // Coarse levels first: a finer level is only drawn once every coarser
+    // one is in place, so stop at the first level over the budget
+    m_stats = {.finestLevel = 0};
+    m_copies.clear();
+    uint64_t used = 0;
+    for (uint32_t level = m_descriptor.levels; level-- > 0;) {
+      Level& state            = m_levels[level];
+      const glm::ivec2 origin = levelOrigin(level, frame.cameraPosition);
+      if (state.valid && state.origin == origin) {
+        continue;
+      }
+
+      const auto regions = changedRegions(state, origin);
+      uint64_t texels    = 0;
+      for (const Region& region : regions) {
+        texels += uint64_t{region.extent.x} * region.extent.y;
+      }
+      if (used + texels > m_descriptor.uploadTexelsPerFrame) {
+        m_stats.finestLevel = level + 1;
+        break;
+      }
+
+      const float spacing = m_descriptor.baseSpacing * static_cast<float>(1u << level);
+      for (const Region& region : regions) {
+        const uint64_t count = uint64_t{region.extent.x} * region.extent.y;
+        m_source.read(region.first, region.extent, spacing, {stagingTexels + used, count});
+        addCopies(level, region, used);
+        used += count;
+      }
+      state = {.origin = origin, .valid = true};
+      ++m_stats.updatedLevels;
+    }
+    m_stats.uploadedTexels = used;
+
+    const glm::mat4 viewProjection = frame.projection * frame.view;
+    TerrainParams params           = {
+        .viewProjection = viewProjection,
+        .frustumPlanes  = frustumPlanes(viewProjection),
+        .cameraPosition = glm::vec4(frame.cameraPosition, 0.0f),
+        .sunDirection   = glm::vec4(glm::normalize(frame.sunDirection), frame.ambient),
+        .spacingHeight =
+            {m_descriptor.baseSpacing,
+             m_descriptor.minHeight,
+             m_descriptor.maxHeight,
+             static_cast<float>(m_descriptor.quadsPerSide / 8)},
+        .counts =
+            {m_descriptor.levels,
+             m_stats.finestLevel,
+             m_descriptor.quadsPerSide,
+             m_descriptor.blockQuads},
+        .origins = {},
+    };
+    for (uint32_t level = 0; level < m_descriptor.levels; ++level) {
+      params.origins[level] = glm::ivec4(m_levels[level].origin, 0, 0);
+    }
+    m_uniformBuffers[frameSlot]->copyDataToBuffer(&params, sizeof(params));
+
+    m_context.beginDebugUtilsLabel(
+        commandBuffer, "Terrain: " + m_descriptor.name, {0.4f, 0.7f, 0.3f, 1.0f}
+    );
+
+    if (!m_copies.empty()) {
+      m_uploadBytesTotal->add(used * sizeof(float));
+      m_heights->transitionImageLayout(commandBuffer, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
+      vkCmdCopyBufferToImage(
+          commandBuffer,
+          staging->vkBuffer(),
+          m_heights->vkImage(),
+          VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+          static_cast<uint32_t>(m_copies.size()),
+          m_copies.data()
+      );
+      m_heights->transitionImageLayout(commandBuffer, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+    }
+
+    // Last frame's draw still reads the block list and the instance count
+    const VkMemoryBarrier drawDone = {
+        .sType         = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+        .srcAccessMask = 0,
+        .dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+    };
+    vkCmdPipelineBarrier(
+        commandBuffer,
+        VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT,
+        VK_PIPELINE_STAGE_TRANSFER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+        0,
+        1,
+        &drawDone,
+        0,
+        nullptr,
+        0,
+        nullptr
+    );
+    vkCmdFillBuffer(
+        commandBuffer,
+        m_drawBuffer->vkBuffer(),
+        offsetof(VkDrawIndexedIndirectCommand, instanceCount),
+        sizeof(uint32_t),
+        0
+    );
+    const VkMemoryBarrier cleared = {
+        .sType         = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+        .srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+        .dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT,
+    };
+    vkCmdPipelineBarrier(
+        commandBuffer,
+        VK_PIPELINE_STAGE_TRANSFER_BIT,
+        VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+        0,
+        1,
+        &cleared,
+        0,
+        nullptr,
+        0,
+        nullptr
+    );
+
+    const uint32_t blocks = m_descriptor.levels * m_blocksPerSide * m_blocksPerSide;
+    m_selectPipeline->bind(commandBuffer);
+    m_selectPipeline->bindDescriptorSets(commandBuffer, {{.set = 0, .bindIdx = frameSlot}});
+    vkCmdDispatch(commandBuffer, (blocks + kGroupSize - 1) / kGroupSize, 1, 1);
+
+    const VkMemoryBarrier selected = {
+        .sType         = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+        .srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT,
+        .dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_INDIRECT_COMMAND_READ_BIT,
+    };
+    vkCmdPipelineBarrier(
+        commandBuffer,
+        VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+        VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT,
+        0,
+        1,
+        &selected,
+        0,
+        nullptr,
+        0,
+        nullptr
+    );
+
+    m_context.endDebugUtilsLabel(commandBuffer);
+    ++m_frameIndex;
+  }
+
+  void TerrainClipmap::render(VkCommandBuffer commandBuffer, VkExtent2D extent) {
+    ZoneScopedN("TerrainClipmap: render");
+
+    // update() has already advanced the frame, the matching uniforms are the
+    // previous slot
+    const uint32_t frameSlot =
+        (m_frameIndex + m_descriptor.framesInFlight - 1) % m_descriptor.framesInFlight;
+
+    const VkViewport viewport = {
+        .x        = 0.0f,
+        .y        = 0.0f,
+        .width    = static_cast<float>(extent.width),
+        .height   = static_cast<float>(extent.height),
+        .minDepth = 0.0f,
+        .maxDepth = 1.0f,
+    };
+    const VkRect2D scissor = {.offset = {0, 0}, .extent = extent};
+
+    m_renderPipeline->bind(commandBuffer);
+    vkCmdSetViewport(commandBuffer, 0, 1, &viewport);
+    vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
+    m_renderPipeline->bindDescriptorSets(commandBuffer, {{.set = 0, .bindIdx = frameSlot}});
+    m_renderPipeline->bindIndexBuffer(commandBuffer, m_indexBuffer->vkBuffer());
+    vkCmdDrawIndexedIndirect(
+        commandBuffer, m_drawBuffer->vkBuffer(), 0, 1, sizeof(VkDrawIndexedIndirectCommand)
+    );
+  }
+} // namespace kst::renderer
@@ -0,0 +1,188 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <string>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "VulkanBackend/VulkanCore/Common.hpp"
+
+namespace VulkanCore {
+  class Buffer;
+  class CommandQueueManager;
+  class Context;
+  class Pipeline;
+  class Sampler;
+  class ShaderModule;
+  class Texture;
+} // namespace VulkanCore
+
+namespace kst::core {
+  class Counter;
+} // namespace kst::core
+
+namespace kst::renderer {
+  /**
+   * @brief Heights fed to a TerrainClipmap as its levels move
+   *
+   * Texel (x, z) lies at world (x * spacing, z * spacing). Implementations
+   * sample the terrain at that point rather than filtering over the texel:
+   * the clipmap blends each level into the next coarser one, and relies on
+   * every even texel matching the coarser texel at the same position.
+   * Called on the thread recording TerrainClipmap::update().
+   */
+  class TerrainHeightSource {
+  public:
+    virtual ~TerrainHeightSource() = default;
+
+    /**
+     * @brief Fills heights, row-major, for texels [first, first + extent)
+     */
+    virtual void
+    read(glm::ivec2 first, glm::uvec2 extent, float spacing, std::span<float> heights) = 0;
+  };
+
+  struct TerrainFrameInfo {
+    glm::mat4 view{1.0f};
+    glm::mat4 projection{1.0f};
+    glm::vec3 cameraPosition{0.0f};
+    glm::vec3 sunDirection{0.3f, 1.0f, 0.2f};
+    float ambient = 0.15f;
+  };
+
+  /**
+   * @brief Geometry clipmap terrain drawn with one indirect draw
+   *
+   * Level L is a square window of quadsPerSide quads spaced baseSpacing *
+   * 2^L apart, centered on the camera. Its heights live in layer L of one
+   * R32 texture array and wrap toroidally: when the camera moves, only the
+   * rows and columns entering the window are read from the height source
+   * and copied, coarse levels first and within uploadTexelsPerFrame. A level
+   * that could not catch up is not drawn until it has, and neither is any
+   * finer level; the finest level drawn covers the center.
+   *
+   * Every level is drawn from the same block of blockQuads^2 quads, which
+   * the vertex shader displaces (shaders/terrain/). A compute pass picks the
+   * blocks to draw: blocks of levels not drawn, blocks fully covered by the
+   * next finer level and blocks outside the frustum are dropped, and the
+   * rest become instances of a single vkCmdDrawIndexedIndirect. The work is
+   * the same for every camera position, so terrain cost does not grow with
+   * view distance or terrain size.
+   *
+   * Needs Context::enableClipDistanceFeature() before device creation.
+   */
+  class TerrainClipmap {
+  public:
+    static constexpr uint32_t kMaxLevels = 16;
+
+    struct Descriptor {
+      uint32_t levels               = 8;
+      uint32_t quadsPerSide         = 256; // power of two
+      uint32_t blockQuads           = 32;  // divides quadsPerSide
+      float baseSpacing             = 1.0f;
+      float minHeight               = 0.0f; // bounds used for culling
+      float maxHeight               = 1000.0f;
+      uint64_t uploadTexelsPerFrame = 1ull << 18; // at least one whole level
+      uint32_t framesInFlight       = 2;
+      VkFormat colorFormat          = VK_FORMAT_B8G8R8A8_UNORM;
+      VkFormat depthFormat          = VK_FORMAT_D32_SFLOAT;
+      std::string name              = "terrain";
+    };
+
+    struct Stats {
+      uint32_t finestLevel    = 0; // levels when nothing is drawn yet
+      uint32_t updatedLevels  = 0; // by the last update()
+      uint64_t uploadedTexels = 0; // by the last update()
+    };
+
+    TerrainClipmap(
+        VulkanCore::Context& context,
+        TerrainHeightSource& source,
+        const Descriptor& descriptor
+    );
+    ~TerrainClipmap();
+
+    TerrainClipmap(const TerrainClipmap&)                    = delete;
+    auto operator=(const TerrainClipmap&) -> TerrainClipmap& = delete;
+    TerrainClipmap(TerrainClipmap&&)                         = delete;
+    auto operator=(TerrainClipmap&&) -> TerrainClipmap&      = delete;
+
+    /**
+     * @brief Uploads the shared block indices and the constant draw arguments
+     * @param queueManager Queue that owns commandBuffer, used to dispose staging buffers
+     * @param commandBuffer Command buffer in the recording state
+     *
+     * Must be recorded (and submitted) once before the first update().
+     */
+    void initialize(VulkanCore::CommandQueueManager& queueManager, VkCommandBuffer commandBuffer);
+
+    /**
+     * @brief Moves the levels to the camera and records block selection
+     * @param commandBuffer Command buffer outside of a render pass
+     *
+     * Writes the staging and uniform buffers of this frame's slot, so the
+     * frame that last used the slot must have finished.
+     */
+    void update(VkCommandBuffer commandBuffer, const TerrainFrameInfo& frame);
+
+    /**
+     * @brief Records the indirect terrain draw
+     * @param commandBuffer Command buffer inside dynamic rendering with the configured formats
+     * @param extent Render target extent for viewport and scissor
+     */
+    void render(VkCommandBuffer commandBuffer, VkExtent2D extent);
+
+    auto stats() const -> const Stats& { return m_stats; }
+
+    auto heights() const -> const std::shared_ptr<VulkanCore::Texture>& { return m_heights; }
+
+    /**
+     * @brief First texel of a level's window for a camera position
+     */
+    auto levelOrigin(uint32_t level, glm::vec3 cameraPosition) const -> glm::ivec2;
+
+  private:
+    struct Level {
+      glm::ivec2 origin{0};
+      bool valid = false;
+    };
+
+    struct Region {
+      glm::ivec2 first;
+      glm::uvec2 extent;
+    };
+
+    void createBuffers();
+    void createPipelines();
+    auto changedRegions(const Level& level, glm::ivec2 origin) const -> std::vector<Region>;
+    void addCopies(uint32_t level, const Region& region, uint64_t stagingTexel);
+
+    VulkanCore::Context& m_context;
+    TerrainHeightSource& m_source;
+    Descriptor m_descriptor;
+    uint32_t m_textureSize   = 0; // texels per side, quadsPerSide + 1
+    uint32_t m_blocksPerSide = 0;
+
+    std::vector<Level> m_levels;
+    std::vector<VkBufferImageCopy> m_copies;
+    uint32_t m_frameIndex = 0;
+    Stats m_stats;
+
+    std::shared_ptr<VulkanCore::Texture> m_heights;
+    std::shared_ptr<VulkanCore::Sampler> m_heightSampler;
+    std::shared_ptr<VulkanCore::Buffer> m_indexBuffer;
+    std::shared_ptr<VulkanCore::Buffer> m_blockBuffer;
+    std::shared_ptr<VulkanCore::Buffer> m_drawBuffer;
+    std::vector<std::shared_ptr<VulkanCore::Buffer>> m_uniformBuffers;
+    std::vector<std::shared_ptr<VulkanCore::Buffer>> m_stagingBuffers;
+
+    std::vector<std::shared_ptr<VulkanCore::ShaderModule>> m_shaders;
+    std::shared_ptr<VulkanCore::Pipeline> m_selectPipeline;
+    std::shared_ptr<VulkanCore::Pipeline> m_renderPipeline;
+
+    core::Counter* m_uploadBytesTotal = nullptr;
+  };
+} // namespace kst::renderer
@@ -0,0 +1,85 @@
+#include "SceneCellSource.hpp"
+
+#include <algorithm>
+#include <string>
+#include <system_error>
+
+namespace kst::scene {
+  namespace {
+    // Reads one byte per page so the kernel pulls the whole block in
+    template <typename T>
+    void touch(std::span<const T> block) {
+      const auto* bytes = reinterpret_cast<const volatile uint8_t*>(block.data());
+      for (size_t offset = 0; offset < block.size_bytes(); offset += kScenePageSize) {
+        (void)bytes[offset];
+      }
+    }
+  } // namespace
+
+  SceneCellSource::SceneCellSource(std::filesystem::path directory, UploadFn upload, EvictFn evict)
+      : m_directory(std::move(directory)), m_upload(std::move(upload)), m_evict(std::move(evict)) {}
+
+  auto SceneCellSource::cellPath(const std::filesystem::path& directory, CellCoord cell)
+      -> std::filesystem::path {
+    return directory /
+           ("cell_" + std::to_string(cell.x) + "_" + std::to_string(cell.z) + ".kscene");
+  }
+
+  auto SceneCellSource::read(CellCoord cell) -> core::Result<std::unique_ptr<CellData>> {
+    using ReadResult = core::Result<std::unique_ptr<CellData>>;
+
+    auto data       = std::make_unique<SceneCell>();
+    const auto path = cellPath(m_directory, cell);
+    std::error_code error;
+    if (!std::filesystem::exists(path, error)) {
+      return ReadResult::success(std::move(data));
+    }
+
+    auto scene = SceneFile::open(path);
+    if (scene.hasError()) {
+      return ReadResult::error(scene.error());
+    }
+    data->scene = std::move(scene.value());
+    for (uint32_t chunk = 0; chunk < data->scene->chunks().size(); ++chunk) {
+      data->scene->prefetch(chunk);
+    }
+    touch(data->scene->transforms());
+    touch(data->scene->objectBounds());
+    touch(data->scene->meshRefs());
+    touch(data->scene->materialRefs());
+
+    const uint64_t objects   = data->scene->objectCount();
+    data->residentBytes      = std::filesystem::file_size(path, error);
+    data->pendingUploadBytes = objects * kUploadBytesPerObject;
+    return ReadResult::success(std::move(data));
+  }
+
+  auto SceneCellSource::upload(CellCoord cell, CellData& data, uint64_t budget) -> uint64_t {
+    auto& sceneCell      = static_cast<SceneCell&>(data);
+    const auto remaining = static_cast<uint32_t>(
+        sceneCell.scene ? sceneCell.scene->objectCount() - sceneCell.uploadedObjects : 0
+    );
+    if (remaining == 0) {
+      sceneCell.pendingUploadBytes = 0;
+      return 0;
+    }
+
+    // At least one object, or a tiny budget would never finish the cell
+    const auto count = static_cast<uint32_t>(
+        std::clamp<uint64_t>(budget / kUploadBytesPerObject, 1, remaining)
+    );
+    m_upload(cell, *sceneCell.scene, sceneCell.uploadedObjects, count);
+    sceneCell.uploadedObjects += count;
+
+    const uint64_t bytes = count * kUploadBytesPerObject;
+    sceneCell.pendingUploadBytes -= std::min(sceneCell.pendingUploadBytes, bytes);
+    return bytes;
+  }
+
+  void SceneCellSource::evict(CellCoord cell, CellData& data) {
+    auto& sceneCell = static_cast<SceneCell&>(data);
+    if (sceneCell.scene && sceneCell.uploadedObjects > 0) {
+      m_evict(cell, *sceneCell.scene);
+    }
+  }
+} // namespace kst::scene
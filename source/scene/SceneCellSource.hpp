@@ -0,0 +1,55 @@
+#pragma once
+
+#include <filesystem>
+#include <functional>
+#include <memory>
+
+#include "SceneFile.hpp"
+#include "WorldStreamer.hpp"
+
+namespace kst::scene {
+  /**
+   * @brief CellSource over a directory of per-cell .kscene files
+   *
+   * Cell (x, z) is `<directory>/cell_<x>_<z>.kscene`; a missing file is an
+   * empty cell. The I/O thread maps the file and reads every page of its
+   * object blocks, so the main thread never waits on the disk. Uploads go
+   * through the callbacks in runs of whole objects sized to the frame budget.
+   */
+  class SceneCellSource : public CellSource {
+  public:
+    /**
+     * @brief Copies objects [firstObject, firstObject + count) of a cell
+     */
+    using UploadFn =
+        std::function<void(CellCoord cell, const SceneFile& scene, uint32_t first, uint32_t count)>;
+
+    using EvictFn = std::function<void(CellCoord cell, const SceneFile& scene)>;
+
+    // Bytes an object costs the upload budget: its transform, bounds and
+    // asset references
+    static constexpr uint64_t kUploadBytesPerObject =
+        sizeof(SceneTransform) + sizeof(SceneBounds) + 2 * sizeof(uint32_t);
+
+    SceneCellSource(std::filesystem::path directory, UploadFn upload, EvictFn evict);
+
+    static auto cellPath(const std::filesystem::path& directory, CellCoord cell)
+        -> std::filesystem::path;
+
+    auto read(CellCoord cell) -> core::Result<std::unique_ptr<CellData>> override;
+
+    auto upload(CellCoord cell, CellData& data, uint64_t budget) -> uint64_t override;
+
+    void evict(CellCoord cell, CellData& data) override;
+
+  private:
+    struct SceneCell : CellData {
+      std::unique_ptr<SceneFile> scene; // null for an empty cell
+      uint32_t uploadedObjects = 0;
+    };
+
+    std::filesystem::path m_directory;
+    UploadFn m_upload;
+    EvictFn m_evict;
+  };
+} // namespace kst::scene
@@ -0,0 +1,258 @@
+#include "SceneFile.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <string>
+
+#if defined(_WIN32)
+#  define WIN32_LEAN_AND_MEAN
+#  define NOMINMAX
+#  include <windows.h>
+#else
+#  include <cerrno>
+#  include <fcntl.h>
+#  include <sys/mman.h>
+#  include <sys/stat.h>
+#  include <unistd.h>
+#endif
+
+namespace kst::scene {
+  namespace {
+    using core::Result;
+
+    // Resolves a relative array against the mapping and checks it lies
+    // inside the file, aligned for T
+    template <typename T>
+    auto checkArray(
+        const uint8_t* base,
+        uint64_t size,
+        const RelativeArray<T>& array,
+        const char* what,
+        bool pageAligned
+    ) -> Result<void> {
+      if (array.count == 0) {
+        return Result<void>::success();
+      }
+      const auto field  = reinterpret_cast<const uint8_t*>(&array.data) - base;
+      const auto target = static_cast<int64_t>(field) + array.data.offset;
+      if (array.data.offset == 0 || target < 0 || static_cast<uint64_t>(target) > size) {
+        return Result<void>::error(std::string(what) + " points outside the file");
+      }
+      const auto start = static_cast<uint64_t>(target);
+      if (array.count > (size - start) / sizeof(T)) {
+        return Result<void>::error(std::string(what) + " runs past the end of the file");
+      }
+      const uint64_t alignment = pageAligned ? kScenePageSize : alignof(T);
+      if (start % alignment != 0) {
+        return Result<void>::error(std::string(what) + " is misaligned");
+      }
+      return Result<void>::success();
+    }
+
+    auto checkAssets(
+        const uint8_t* base,
+        uint64_t size,
+        const RelativeArray<SceneAssetRef>& table,
+        const char* what
+    ) -> Result<void> {
+      auto result = checkArray(base, size, table, what, false);
+      if (result.hasError()) {
+        return result;
+      }
+      for (const auto& asset : table.span()) {
+        result = checkArray(base, size, asset.name, what, false);
+        if (result.hasError()) {
+          return result;
+        }
+      }
+      return result;
+    }
+
+    auto validate(const uint8_t* data, uint64_t size) -> Result<void> {
+      if (size < sizeof(SceneHeader)) {
+        return Result<void>::error("file too small for a scene header");
+      }
+      const auto& header = *reinterpret_cast<const SceneHeader*>(data);
+      if (header.magic != kSceneMagic) {
+        return Result<void>::error("not a scene file");
+      }
+      if (header.version != kSceneVersion || header.headerSize != sizeof(SceneHeader)) {
+        return Result<void>::error(
+            "scene version " + std::to_string(header.version) + ", expected " +
+            std::to_string(kSceneVersion)
+        );
+      }
+      if (header.fileSize != size) {
+        return Result<void>::error("scene file truncated");
+      }
+
+      const uint64_t objects = header.objectCount;
+      if (header.transforms.count != objects || header.objectBounds.count != objects ||
+          header.meshRefs.count != objects || header.materialRefs.count != objects) {
+        return Result<void>::error("scene blocks disagree on the object count");
+      }
+
+      for (const auto& result : {
+               checkArray(data, size, header.chunks, "chunk index", true),
+               checkAssets(data, size, header.meshes, "mesh table"),
+               checkAssets(data, size, header.materials, "material table"),
+               checkArray(data, size, header.transforms, "transform block", true),
+               checkArray(data, size, header.objectBounds, "bounds block", true),
+               checkArray(data, size, header.meshRefs, "mesh reference block", true),
+               checkArray(data, size, header.materialRefs, "material reference block", true),
+           }) {
+        if (result.hasError()) {
+          return result;
+        }
+      }
+
+      uint64_t covered = 0;
+      for (const auto& chunk : header.chunks.span()) {
+        if (chunk.firstObject != covered || chunk.objectCount > objects - covered) {
+          return Result<void>::error("chunk index doesn't tile the objects");
+        }
+        covered += chunk.objectCount;
+      }
+      if (covered != objects) {
+        return Result<void>::error("chunk index doesn't tile the objects");
+      }
+      return Result<void>::success();
+    }
+
+    auto overlaps(const SceneBounds& lhs, const SceneBounds& rhs) -> bool {
+      for (int axis = 0; axis < 3; ++axis) {
+        if (lhs.max[axis] < rhs.min[axis] || rhs.max[axis] < lhs.min[axis]) {
+          return false;
+        }
+      }
+      return true;
+    }
+  } // namespace
+
+  SceneFile::SceneFile(const uint8_t* data, uint64_t size, void* mapping)
+      : m_data(data), m_size(size), m_mapping(mapping) {}
+
+  SceneFile::~SceneFile() {
+#if defined(_WIN32)
+    UnmapViewOfFile(m_data);
+    CloseHandle(static_cast<HANDLE>(m_mapping));
+#else
+    ::munmap(const_cast<uint8_t*>(m_data), m_size);
+#endif
+  }
+
+  auto SceneFile::open(const std::filesystem::path& path)
+      -> core::Result<std::unique_ptr<SceneFile>> {
+    using OpenResult = core::Result<std::unique_ptr<SceneFile>>;
+
+#if defined(_WIN32)
+    HANDLE file = CreateFileW(
+        path.c_str(),
+        GENERIC_READ,
+        FILE_SHARE_READ | FILE_SHARE_DELETE,
+        nullptr,
+        OPEN_EXISTING,
+        FILE_ATTRIBUTE_NORMAL,
+        nullptr
+    );
+    if (file == INVALID_HANDLE_VALUE) {
+      return OpenResult::error("can't open " + path.string());
+    }
+    LARGE_INTEGER fileSize{};
+    GetFileSizeEx(file, &fileSize);
+    const auto size = static_cast<uint64_t>(fileSize.QuadPart);
+    HANDLE mapping  = size ? CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr)
+                           : nullptr;
+    CloseHandle(file);
+    const auto* data =
+        mapping ? static_cast<const uint8_t*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0))
+                : nullptr;
+    if (!data) {
+      if (mapping) {
+        CloseHandle(mapping);
+      }
+      return OpenResult::error("can't map " + path.string());
+    }
+#else
+    const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+      return OpenResult::error("can't open " + path.string() + ": " + std::strerror(errno));
+    }
+    struct stat status{};
+    if (::fstat(fd, &status) != 0 || status.st_size == 0) {
+      ::close(fd);
+      return OpenResult::error("can't map empty scene " + path.string());
+    }
+    const auto size = static_cast<uint64_t>(status.st_size);
+    void* mapped    = ::mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+    // The mapping keeps the file alive
+    ::close(fd);
+    if (mapped == MAP_FAILED) {
+      return OpenResult::error("can't map " + path.string() + ": " + std::strerror(errno));
+    }
+    const auto* data    = static_cast<const uint8_t*>(mapped);
+    void* const mapping = nullptr;
+#endif
+
+    auto scene = std::unique_ptr<SceneFile>(new SceneFile(data, size, mapping));
+    auto valid = validate(data, size);
+    if (valid.hasError()) {
+      return OpenResult::error(path.string() + ": " + valid.error());
+    }
+    return OpenResult::success(std::move(scene));
+  }
+
+  auto SceneFile::chunksOverlapping(const SceneBounds& region) const -> std::vector<uint32_t> {
+    std::vector<uint32_t> result;
+    const auto all = chunks();
+    for (uint32_t chunk = 0; chunk < all.size(); ++chunk) {
+      if (overlaps(all[chunk].bounds, region)) {
+        result.push_back(chunk);
+      }
+    }
+    return result;
+  }
+
+  void SceneFile::prefetch(uint32_t chunk) const {
+#if defined(_WIN32)
+    (void)chunk;
+#else
+    const auto& range = chunks()[chunk];
+    const auto advise = [&](const void* block, size_t elementSize) {
+      // madvise wants a page-aligned start; blocks are, offsets inside aren't
+      const auto begin = reinterpret_cast<uintptr_t>(block) + range.firstObject * elementSize;
+      const auto first = begin & ~(kScenePageSize - 1);
+      const auto end   = begin + range.objectCount * elementSize;
+      ::madvise(reinterpret_cast<void*>(first), end - first, MADV_WILLNEED);
+    };
+    advise(transforms().data(), sizeof(SceneTransform));
+    advise(objectBounds().data(), sizeof(SceneBounds));
+    advise(meshRefs().data(), sizeof(uint32_t));
+    advise(materialRefs().data(), sizeof(uint32_t));
+#endif
+  }
+
+  auto SceneFile::verifyReferences() const -> core::Result<void> {
+    const auto meshCount     = static_cast<uint32_t>(meshes().size());
+    const auto materialCount = static_cast<uint32_t>(materials().size());
+    const auto badMesh =
+        std::ranges::find_if(meshRefs(), [&](uint32_t ref) { return ref >= meshCount; });
+    if (badMesh != meshRefs().end()) {
+      return core::Result<void>::error(
+          "object " + std::to_string(badMesh - meshRefs().begin()) + " references mesh " +
+          std::to_string(*badMesh) + " of " + std::to_string(meshCount)
+      );
+    }
+    const auto badMaterial = std::ranges::find_if(materialRefs(), [&](uint32_t ref) {
+      return ref >= materialCount;
+    });
+    if (badMaterial != materialRefs().end()) {
+      return core::Result<void>::error(
+          "object " + std::to_string(badMaterial - materialRefs().begin()) +
+          " references material " + std::to_string(*badMaterial) + " of " +
+          std::to_string(materialCount)
+      );
+    }
+    return core::Result<void>::success();
+  }
+} // namespace kst::scene
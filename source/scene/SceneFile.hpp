@@ -0,0 +1,110 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <span>
+#include <vector>
+
+#include "SceneFormat.hpp"
+#include "core/Result.hpp"
+
+namespace kst::scene {
+  /**
+   * @brief A .kscene file mapped read-only
+   *
+   * open() maps the file and checks the header, the chunk index and the asset
+   * tables, and that every block lies inside the file: work proportional to
+   * chunks and assets, never to objects. The per-object blocks are then used
+   * in place, so pages are only read when something touches them; see
+   * prefetch() to start that early for the chunks about to be needed.
+   *
+   * Runtime handles come from resolve(), once per asset table entry. An
+   * object's mesh handle is then `meshHandles[file.meshRefs()[object]]`.
+   *
+   * @code
+   * auto scene = SceneFile::open("level.kscene");
+   * for (const uint32_t chunk : scene.value()->chunksOverlapping(viewBounds)) {
+   *   scene.value()->prefetch(chunk);
+   * }
+   * auto meshes = SceneFile::resolve<MeshHandle>(scene.value()->meshes(), loadMesh);
+   * @endcode
+   */
+  class SceneFile {
+  public:
+    static auto open(const std::filesystem::path& path) -> core::Result<std::unique_ptr<SceneFile>>;
+
+    ~SceneFile();
+
+    SceneFile(const SceneFile&)                    = delete;
+    auto operator=(const SceneFile&) -> SceneFile& = delete;
+
+    auto objectCount() const -> uint64_t { return header().objectCount; }
+
+    auto bounds() const -> const SceneBounds& { return header().bounds; }
+
+    auto chunks() const -> std::span<const SceneChunk> { return header().chunks.span(); }
+
+    auto meshes() const -> std::span<const SceneAssetRef> { return header().meshes.span(); }
+
+    auto materials() const -> std::span<const SceneAssetRef> { return header().materials.span(); }
+
+    auto transforms() const -> std::span<const SceneTransform> {
+      return header().transforms.span();
+    }
+
+    auto objectBounds() const -> std::span<const SceneBounds> {
+      return header().objectBounds.span();
+    }
+
+    auto meshRefs() const -> std::span<const uint32_t> { return header().meshRefs.span(); }
+
+    auto materialRefs() const -> std::span<const uint32_t> { return header().materialRefs.span(); }
+
+    /**
+     * @brief Indices of the chunks whose bounds overlap region
+     */
+    auto chunksOverlapping(const SceneBounds& region) const -> std::vector<uint32_t>;
+
+    /**
+     * @brief Asks the OS to start reading a chunk's objects in every block
+     */
+    void prefetch(uint32_t chunk) const;
+
+    /**
+     * @brief Checks every object's mesh and material index against the tables
+     *
+     * The one pass over all objects, for tools and files from untrusted
+     * sources; open() trusts the references.
+     */
+    auto verifyReferences() const -> core::Result<void>;
+
+    /**
+     * @brief Maps each asset table entry to a runtime handle
+     *
+     * @param resolver Called once per entry with its name
+     */
+    template <typename Handle, typename Resolver>
+    static auto resolve(std::span<const SceneAssetRef> assets, Resolver&& resolver)
+        -> std::vector<Handle> {
+      std::vector<Handle> handles;
+      handles.reserve(assets.size());
+      for (const auto& asset : assets) {
+        handles.push_back(resolver(asset.view()));
+      }
+      return handles;
+    }
+
+  private:
+    SceneFile(const uint8_t* data, uint64_t size, void* mapping);
+
+    auto header() const -> const SceneHeader& {
+      return *reinterpret_cast<const SceneHeader*>(m_data);
+    }
+
+    const uint8_t* m_data = nullptr;
+    uint64_t m_size       = 0;
+    // File mapping object on Windows, unused elsewhere
+    void* m_mapping = nullptr;
+  };
+} // namespace kst::scene
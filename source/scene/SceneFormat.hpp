@@ -0,0 +1,115 @@
+#pragma once
+
+#include <bit>
+#include <cstdint>
+#include <span>
+#include <string_view>
+#include <type_traits>
+
+/**
+ * On-disk layout of .kscene files, shared by SceneWriter and SceneFile.
+ *
+ * A scene is read by mapping the file and casting: every structure here is
+ * trivially copyable with a fixed layout, and references inside the file are
+ * self-relative offsets, so the mapping can live at any address and nothing
+ * is rebuilt per object on load.
+ *
+ *   page 0       SceneHeader
+ *   page-aligned SceneChunk[chunkCount]                    (partial load index)
+ *   page-aligned SceneAssetRef[] meshes, materials + names (asset tables)
+ *   page-aligned SceneTransform[objectCount]              (one SoA block per
+ *   page-aligned SceneBounds[objectCount]                  attribute, indexed
+ *   page-aligned uint32_t meshRefs[objectCount]            by object)
+ *   page-aligned uint32_t materialRefs[objectCount]
+ *
+ * Objects are sorted spatially and cut into chunks of consecutive objects, so
+ * one chunk is a contiguous range in every block; loading part of a scene is
+ * picking chunks by bounds and touching only their ranges.
+ */
+namespace kst::scene {
+  static_assert(std::endian::native == std::endian::little, "scene files are little endian");
+
+  inline constexpr uint64_t kSceneMagic = 0x454e45435354534bull; // "KSTSCENE"
+
+  // Bumped on any layout change; older files are rejected, not converted
+  inline constexpr uint32_t kSceneVersion = 1;
+
+  // Blocks start on this boundary so each can be mapped, prefetched or
+  // evicted on its own
+  inline constexpr uint64_t kScenePageSize = 4096;
+
+  /**
+   * @brief Offset from this field's own address to the target; 0 is null
+   */
+  template <typename T>
+  struct RelativePtr {
+    int64_t offset = 0;
+
+    auto get() const -> const T* {
+      if (offset == 0) {
+        return nullptr;
+      }
+      return reinterpret_cast<const T*>(reinterpret_cast<const char*>(this) + offset);
+    }
+  };
+
+  template <typename T>
+  struct RelativeArray {
+    RelativePtr<T> data;
+    uint64_t count = 0;
+
+    auto span() const -> std::span<const T> { return {data.get(), count}; }
+  };
+
+  struct SceneTransform {
+    float position[3];
+    float rotation[4]; // quaternion, xyzw
+    float scale[3];
+  };
+
+  // Axis-aligned, world space
+  struct SceneBounds {
+    float min[3];
+    float max[3];
+  };
+
+  struct SceneChunk {
+    SceneBounds bounds;
+    uint32_t firstObject = 0;
+    uint32_t objectCount = 0;
+  };
+
+  // A mesh or material the loader resolves to a runtime handle once, however
+  // many objects reference it
+  struct SceneAssetRef {
+    RelativeArray<char> name;
+
+    auto view() const -> std::string_view { return {name.data.get(), name.count}; }
+  };
+
+  struct SceneHeader {
+    uint64_t magic       = kSceneMagic;
+    uint32_t version     = kSceneVersion;
+    uint32_t headerSize  = 0; // sizeof(SceneHeader) when written
+    uint64_t fileSize    = 0;
+    uint64_t objectCount = 0;
+    SceneBounds bounds{};
+
+    RelativeArray<SceneChunk> chunks;
+    RelativeArray<SceneAssetRef> meshes;
+    RelativeArray<SceneAssetRef> materials;
+
+    RelativeArray<SceneTransform> transforms;
+    RelativeArray<SceneBounds> objectBounds;
+    RelativeArray<uint32_t> meshRefs;
+    RelativeArray<uint32_t> materialRefs;
+  };
+
+  static_assert(std::is_trivially_copyable_v<SceneHeader>);
+  static_assert(sizeof(RelativeArray<char>) == 16);
+  static_assert(sizeof(SceneTransform) == 40);
+  static_assert(sizeof(SceneBounds) == 24);
+  static_assert(sizeof(SceneChunk) == 32);
+  static_assert(sizeof(SceneHeader) == 168);
+  static_assert(sizeof(SceneHeader) <= kScenePageSize);
+} // namespace kst::scene
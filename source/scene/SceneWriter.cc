@@ -0,0 +1,211 @@
+#include "SceneWriter.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <new>
+#include <numeric>
+#include <system_error>
+
+namespace kst::scene {
+  namespace {
+    auto alignUp(uint64_t value, uint64_t alignment) -> uint64_t {
+      return (value + alignment - 1) / alignment * alignment;
+    }
+
+    // Spreads the low 10 bits of value to every third bit
+    auto spreadBits(uint32_t value) -> uint32_t {
+      value &= 0x3ff;
+      value = (value | (value << 16)) & 0x030000ff;
+      value = (value | (value << 8)) & 0x0300f00f;
+      value = (value | (value << 4)) & 0x030c30c3;
+      value = (value | (value << 2)) & 0x09249249;
+      return value;
+    }
+
+    auto mortonCode(const SceneBounds& object, const SceneBounds& scene) -> uint32_t {
+      uint32_t code = 0;
+      for (int axis = 0; axis < 3; ++axis) {
+        const float extent = scene.max[axis] - scene.min[axis];
+        const float center = (object.min[axis] + object.max[axis]) * 0.5f;
+        const float unit   = extent > 0.0f ? (center - scene.min[axis]) / extent : 0.0f;
+        const auto cell    = static_cast<uint32_t>(std::clamp(unit, 0.0f, 1.0f) * 1023.0f);
+        code |= spreadBits(cell) << axis;
+      }
+      return code;
+    }
+
+    auto emptyBounds() -> SceneBounds {
+      constexpr float kMax = std::numeric_limits<float>::max();
+      return {{kMax, kMax, kMax}, {-kMax, -kMax, -kMax}};
+    }
+
+    void grow(SceneBounds& bounds, const SceneBounds& other) {
+      for (int axis = 0; axis < 3; ++axis) {
+        bounds.min[axis] = std::min(bounds.min[axis], other.min[axis]);
+        bounds.max[axis] = std::max(bounds.max[axis], other.max[axis]);
+      }
+    }
+
+    // Points field at the file offset target; both live in file
+    template <typename T>
+    void link(
+        const std::vector<uint8_t>& file,
+        RelativeArray<T>& field,
+        uint64_t target,
+        uint64_t count
+    ) {
+      const auto fieldOffset = reinterpret_cast<const uint8_t*>(&field.data) - file.data();
+      field.data.offset      = count ? static_cast<int64_t>(target) - fieldOffset : 0;
+      field.count            = count;
+    }
+  } // namespace
+
+  auto SceneWriter::AssetTable::add(std::string_view name) -> uint32_t {
+    const auto [iter, inserted] =
+        indices.try_emplace(std::string(name), static_cast<uint32_t>(names.size()));
+    if (inserted) {
+      names.emplace_back(name);
+    }
+    return iter->second;
+  }
+
+  SceneWriter::SceneWriter(uint32_t objectsPerChunk)
+      : m_objectsPerChunk(std::max(objectsPerChunk, 1u)) {}
+
+  auto SceneWriter::addMesh(std::string_view name) -> uint32_t {
+    return m_meshes.add(name);
+  }
+
+  auto SceneWriter::addMaterial(std::string_view name) -> uint32_t {
+    return m_materials.add(name);
+  }
+
+  auto SceneWriter::write(const std::filesystem::path& path) const -> core::Result<void> {
+    using core::Result;
+
+    const uint64_t objectCount = m_objects.size();
+    if (objectCount > std::numeric_limits<uint32_t>::max()) {
+      return Result<void>::error("too many objects for one scene");
+    }
+    for (const auto& object : m_objects) {
+      if (object.mesh >= m_meshes.names.size() || object.material >= m_materials.names.size()) {
+        return Result<void>::error("scene object references an asset that wasn't added");
+      }
+    }
+
+    SceneBounds sceneBounds = emptyBounds();
+    for (const auto& object : m_objects) {
+      grow(sceneBounds, object.bounds);
+    }
+    if (objectCount == 0) {
+      sceneBounds = {};
+    }
+
+    // Spatial order, so chunks are compact regions
+    std::vector<uint32_t> codes(objectCount);
+    for (size_t i = 0; i < objectCount; ++i) {
+      codes[i] = mortonCode(m_objects[i].bounds, sceneBounds);
+    }
+    std::vector<uint32_t> order(objectCount);
+    std::iota(order.begin(), order.end(), 0u);
+    std::stable_sort(order.begin(), order.end(), [&](uint32_t lhs, uint32_t rhs) {
+      return codes[lhs] < codes[rhs];
+    });
+
+    // Layout: header page, index and tables, then one page-aligned block per
+    // attribute
+    const auto blockAfter = [](uint64_t offset, uint64_t bytes) {
+      return alignUp(offset + bytes, kScenePageSize);
+    };
+    const uint64_t chunkCount     = (objectCount + m_objectsPerChunk - 1) / m_objectsPerChunk;
+    const uint64_t chunkOffset    = kScenePageSize;
+    const uint64_t meshOffset     = blockAfter(chunkOffset, chunkCount * sizeof(SceneChunk));
+    const uint64_t materialOffset = meshOffset + m_meshes.names.size() * sizeof(SceneAssetRef);
+    const uint64_t namesOffset =
+        materialOffset + m_materials.names.size() * sizeof(SceneAssetRef);
+    uint64_t namesSize = 0;
+    for (const auto* table : {&m_meshes, &m_materials}) {
+      for (const auto& name : table->names) {
+        namesSize += name.size();
+      }
+    }
+    const uint64_t transformOffset = blockAfter(namesOffset, namesSize);
+    const uint64_t boundsOffset =
+        blockAfter(transformOffset, objectCount * sizeof(SceneTransform));
+    const uint64_t meshRefOffset     = blockAfter(boundsOffset, objectCount * sizeof(SceneBounds));
+    const uint64_t materialRefOffset = blockAfter(meshRefOffset, objectCount * sizeof(uint32_t));
+    const uint64_t fileSize = blockAfter(materialRefOffset, objectCount * sizeof(uint32_t));
+
+    std::vector<uint8_t> file(fileSize, 0);
+    auto* header        = new (file.data()) SceneHeader{};
+    header->headerSize  = sizeof(SceneHeader);
+    header->fileSize    = fileSize;
+    header->objectCount = objectCount;
+    header->bounds      = sceneBounds;
+    link(file, header->chunks, chunkOffset, chunkCount);
+    link(file, header->meshes, meshOffset, m_meshes.names.size());
+    link(file, header->materials, materialOffset, m_materials.names.size());
+    link(file, header->transforms, transformOffset, objectCount);
+    link(file, header->objectBounds, boundsOffset, objectCount);
+    link(file, header->meshRefs, meshRefOffset, objectCount);
+    link(file, header->materialRefs, materialRefOffset, objectCount);
+
+    uint64_t nameCursor = namesOffset;
+    const auto writeTable = [&](const AssetTable& table, uint64_t offset) {
+      auto* refs = reinterpret_cast<SceneAssetRef*>(file.data() + offset);
+      for (size_t i = 0; i < table.names.size(); ++i) {
+        auto* ref        = new (&refs[i]) SceneAssetRef{};
+        const auto& name = table.names[i];
+        std::memcpy(file.data() + nameCursor, name.data(), name.size());
+        link(file, ref->name, nameCursor, name.size());
+        nameCursor += name.size();
+      }
+    };
+    writeTable(m_meshes, meshOffset);
+    writeTable(m_materials, materialOffset);
+
+    auto* transforms   = reinterpret_cast<SceneTransform*>(file.data() + transformOffset);
+    auto* bounds       = reinterpret_cast<SceneBounds*>(file.data() + boundsOffset);
+    auto* meshRefs     = reinterpret_cast<uint32_t*>(file.data() + meshRefOffset);
+    auto* materialRefs = reinterpret_cast<uint32_t*>(file.data() + materialRefOffset);
+    for (size_t slot = 0; slot < objectCount; ++slot) {
+      const auto& object = m_objects[order[slot]];
+      transforms[slot]   = object.transform;
+      bounds[slot]       = object.bounds;
+      meshRefs[slot]     = object.mesh;
+      materialRefs[slot] = object.material;
+    }
+
+    auto* chunks = reinterpret_cast<SceneChunk*>(file.data() + chunkOffset);
+    for (uint64_t chunk = 0; chunk < chunkCount; ++chunk) {
+      const auto first = static_cast<uint32_t>(chunk * m_objectsPerChunk);
+      const auto count = static_cast<uint32_t>(
+          std::min<uint64_t>(m_objectsPerChunk, objectCount - first)
+      );
+      SceneBounds chunkBounds = emptyBounds();
+      for (uint32_t slot = first; slot < first + count; ++slot) {
+        grow(chunkBounds, bounds[slot]);
+      }
+      chunks[chunk] = {.bounds = chunkBounds, .firstObject = first, .objectCount = count};
+    }
+
+    // Write aside and rename, so a reader never maps a half-written file
+    auto staging = path;
+    staging += ".tmp";
+    {
+      std::ofstream out(staging, std::ios::binary | std::ios::trunc);
+      const auto* bytes = reinterpret_cast<const char*>(file.data());
+      if (!out || !out.write(bytes, static_cast<std::streamsize>(file.size()))) {
+        return Result<void>::error("can't write " + staging.string());
+      }
+    }
+    std::error_code error;
+    std::filesystem::rename(staging, path, error);
+    if (error) {
+      return Result<void>::error("can't replace " + path.string() + ": " + error.message());
+    }
+    return Result<void>::success();
+  }
+} // namespace kst::scene
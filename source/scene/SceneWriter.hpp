@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "SceneFormat.hpp"
+#include "core/Result.hpp"
+
+namespace kst::scene {
+  struct SceneObject {
+    SceneTransform transform{};
+    SceneBounds bounds{};
+    uint32_t mesh     = 0; // from SceneWriter::addMesh()
+    uint32_t material = 0; // from SceneWriter::addMaterial()
+  };
+
+  /**
+   * @brief Builds .kscene files for SceneFile
+   *
+   * Objects are reordered along a Morton curve over their bounds' centers and
+   * cut into chunks of objectsPerChunk, so nearby objects share a chunk and
+   * the chunk index can answer region queries. Object order is therefore not
+   * preserved.
+   */
+  class SceneWriter {
+  public:
+    // ~40 KiB of transforms per chunk: small enough to load selectively,
+    // large enough that the index stays tiny
+    static constexpr uint32_t kDefaultObjectsPerChunk = 1024;
+
+    explicit SceneWriter(uint32_t objectsPerChunk = kDefaultObjectsPerChunk);
+
+    /**
+     * @brief Adds a mesh to the asset table; the same name returns the same index
+     */
+    auto addMesh(std::string_view name) -> uint32_t;
+
+    auto addMaterial(std::string_view name) -> uint32_t;
+
+    void reserve(size_t objectCount) { m_objects.reserve(objectCount); }
+
+    void addObject(const SceneObject& object) { m_objects.push_back(object); }
+
+    auto objectCount() const -> size_t { return m_objects.size(); }
+
+    /**
+     * @brief Writes the scene next to path and renames it into place
+     *
+     * Readers that still map the old file keep seeing it until they reopen.
+     */
+    auto write(const std::filesystem::path& path) const -> core::Result<void>;
+
+  private:
+    struct AssetTable {
+      std::vector<std::string> names;
+      std::unordered_map<std::string, uint32_t> indices;
+
+      auto add(std::string_view name) -> uint32_t;
+    };
+
+    uint32_t m_objectsPerChunk;
+    AssetTable m_meshes;
+    AssetTable m_materials;
+    std::vector<SceneObject> m_objects;
+  };
+} // namespace kst::scene
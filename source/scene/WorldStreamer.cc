@@ -0,0 +1,346 @@
+#include "WorldStreamer.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+#include "core/Logger.hpp"
+#include "core/Metrics.hpp"
+
+namespace kst::scene {
+  namespace {
+    // Distance from (x, z) to the segment a-b on the XZ plane
+    auto distanceToSegment(float x, float z, const float a[2], const float b[2]) -> float {
+      const float abX    = b[0] - a[0];
+      const float abZ    = b[1] - a[1];
+      const float length = abX * abX + abZ * abZ;
+      float t            = 0.0f;
+      if (length > 0.0f) {
+        t = std::clamp(((x - a[0]) * abX + (z - a[1]) * abZ) / length, 0.0f, 1.0f);
+      }
+      const float dx = x - (a[0] + abX * t);
+      const float dz = z - (a[1] + abZ * t);
+      return std::sqrt(dx * dx + dz * dz);
+    }
+  } // namespace
+
+  WorldStreamer::WorldStreamer(CellSource& source, StreamingConfig config)
+      : m_source(source), m_config(config) {
+    m_config.cellSize         = std::max(m_config.cellSize, 1e-3f);
+    m_config.unloadRadius     = std::max(m_config.unloadRadius, m_config.loadRadius);
+    m_config.maxInFlightReads = std::clamp(m_config.maxInFlightReads, 1u, kMaxInFlightReads);
+
+    auto& metrics        = core::MetricsRegistry::instance();
+    m_residentGauge      = &metrics.gauge("kst_stream_cells_resident", "World cells resident");
+    m_residentBytesGauge = &metrics.gauge(
+        "kst_stream_resident_bytes", "Memory held by loaded world cells"
+    );
+    m_inFlightGauge    = &metrics.gauge("kst_stream_reads_in_flight", "World cell reads running");
+    m_uploadBytesTotal = &metrics.counter(
+        "kst_stream_upload_bytes_total", "World cell bytes uploaded"
+    );
+    m_failuresTotal = &metrics.counter(
+        "kst_stream_failures_total", "World cell reads that failed"
+    );
+    m_loadLatency = &metrics.histogram(
+        "kst_stream_load_seconds",
+        "Time from requesting a world cell to it being resident",
+        {},
+        1e-9
+    );
+
+    const uint32_t threads = std::max(m_config.ioThreads, 1u);
+    for (uint32_t i = 0; i < threads; ++i) {
+      m_workers.emplace_back([this](std::stop_token stop) { ioWorker(stop); });
+    }
+  }
+
+  WorldStreamer::~WorldStreamer() {
+    // Workers drain the queue before they look at the stop token, so drop
+    // the reads that haven't started yet
+    {
+      std::scoped_lock lock(m_requestMutex);
+      m_requests.clear();
+    }
+    for (auto& worker : m_workers) {
+      worker.request_stop();
+    }
+    m_requestReady.notify_all();
+    m_workers.clear();
+
+    // Finished reads hold no GPU resources
+    while (m_completions.tryPop()) {
+    }
+    for (auto& [key, cell] : m_cells) {
+      if (cell.state == CellState::Uploading || cell.state == CellState::Resident) {
+        m_source.evict(cell.coord, *cell.data);
+      }
+    }
+    m_residentGauge->set(0.0);
+    m_residentBytesGauge->set(0.0);
+    m_inFlightGauge->set(0.0);
+  }
+
+  auto WorldStreamer::key(CellCoord cell) -> uint64_t {
+    return (uint64_t{static_cast<uint32_t>(cell.x)} << 32) | static_cast<uint32_t>(cell.z);
+  }
+
+  auto WorldStreamer::cellAt(float x, float z) const -> CellCoord {
+    return {
+        static_cast<int32_t>(std::floor(x / m_config.cellSize)),
+        static_cast<int32_t>(std::floor(z / m_config.cellSize)),
+    };
+  }
+
+  void WorldStreamer::ioWorker(std::stop_token stop) {
+    while (true) {
+      CellCoord coord;
+      {
+        std::unique_lock lock(m_requestMutex);
+        if (!m_requestReady.wait(lock, stop, [this] { return !m_requests.empty(); })) {
+          return;
+        }
+        coord = m_requests.front();
+        m_requests.pop_front();
+      }
+      // No more than maxInFlightReads reads are out at once, which the queue
+      // always has room for
+      [[maybe_unused]] const auto pushed = m_completions.tryPush({coord, m_source.read(coord)});
+      assert(pushed && "World cell completion queue overflowed");
+    }
+  }
+
+  void WorldStreamer::update(const StreamingViewer& viewer) {
+    m_uploadedBytes = 0;
+    drainCompletions();
+    refreshCells(viewer);
+    evictCells();
+    startReads();
+    uploadCells(m_config.uploadBytesPerFrame);
+    publishStats();
+  }
+
+  void WorldStreamer::loadAround(const StreamingViewer& viewer) {
+    m_uploadedBytes = 0;
+    drainCompletions();
+    refreshCells(viewer);
+    evictCells();
+    while (true) {
+      startReads();
+      uploadCells(UINT64_MAX);
+      // Cells still queued with nothing reading are held back by the memory
+      // budget and won't start
+      const bool uploading = std::ranges::any_of(m_cells, [](const auto& entry) {
+        return entry.second.state == CellState::Uploading;
+      });
+      if (m_inFlight == 0 && !uploading) {
+        break;
+      }
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+      drainCompletions();
+    }
+    publishStats();
+  }
+
+  void WorldStreamer::drainCompletions() {
+    while (auto completion = m_completions.tryPop()) {
+      --m_inFlight;
+      const auto found = m_cells.find(key(completion->coord));
+      if (found == m_cells.end()) {
+        continue;
+      }
+      Cell& cell = found->second;
+      if (cell.cancelled) {
+        m_cells.erase(found);
+        continue;
+      }
+      if (completion->data.hasValue() && !completion->data.value()) {
+        completion->data =
+            core::Result<std::unique_ptr<CellData>>::error("source returned no data");
+      }
+      if (completion->data.hasError()) {
+        KST_CORE_ERROR(
+            "Can't stream cell ({}, {}): {}", cell.coord.x, cell.coord.z, completion->data.error()
+        );
+        m_failuresTotal->add();
+        cell.state = CellState::Failed;
+        continue;
+      }
+      cell.data  = std::move(completion->data.value());
+      cell.state = CellState::Uploading;
+      m_residentBytes += cell.data->residentBytes;
+    }
+  }
+
+  void WorldStreamer::refreshCells(const StreamingViewer& viewer) {
+    const float from[2] = {viewer.position[0], viewer.position[2]};
+    const float to[2]   = {
+        viewer.position[0] + viewer.velocity[0] * m_config.predictionSeconds,
+        viewer.position[2] + viewer.velocity[2] * m_config.predictionSeconds,
+    };
+    const float size      = m_config.cellSize;
+    const auto distanceOf = [&](CellCoord coord) {
+      // Measured to the cell center, less half the diagonal, so a cell the
+      // path crosses counts as distance 0 whatever its size
+      const float x = (static_cast<float>(coord.x) + 0.5f) * size;
+      const float z = (static_cast<float>(coord.z) + 0.5f) * size;
+      return std::max(distanceToSegment(x, z, from, to) - size * 0.70710678f, 0.0f);
+    };
+
+    for (auto iter = m_cells.begin(); iter != m_cells.end();) {
+      Cell& cell        = iter->second;
+      cell.distance     = distanceOf(cell.coord);
+      cell.wanted       = cell.distance <= m_config.loadRadius;
+      const bool beyond = cell.distance > m_config.unloadRadius;
+      cell.cancelled    = cell.state == CellState::Reading && beyond;
+      // Unstarted cells go as soon as they're not wanted, failed ones past the
+      // unload radius; loaded ones wait for evictCells and its per-frame cap
+      if ((cell.state == CellState::Queued && !cell.wanted) ||
+          (cell.state == CellState::Failed && beyond)) {
+        iter = m_cells.erase(iter);
+      } else {
+        ++iter;
+      }
+    }
+
+    const float radius  = m_config.loadRadius + size;
+    const CellCoord min =
+        cellAt(std::min(from[0], to[0]) - radius, std::min(from[1], to[1]) - radius);
+    const CellCoord max =
+        cellAt(std::max(from[0], to[0]) + radius, std::max(from[1], to[1]) + radius);
+    const auto now = Clock::now();
+    for (int32_t z = min.z; z <= max.z; ++z) {
+      for (int32_t x = min.x; x <= max.x; ++x) {
+        const CellCoord coord{x, z};
+        const float distance = distanceOf(coord);
+        if (distance <= m_config.loadRadius) {
+          const auto [iter, inserted] = m_cells.try_emplace(key(coord));
+          if (inserted) {
+            iter->second.coord     = coord;
+            iter->second.distance  = distance;
+            iter->second.requested = now;
+          }
+        }
+      }
+    }
+  }
+
+  void WorldStreamer::startReads() {
+    if (m_inFlight >= m_config.maxInFlightReads || m_residentBytes >= m_config.memoryBudgetBytes) {
+      return;
+    }
+    std::vector<Cell*> queued;
+    for (auto& [key, cell] : m_cells) {
+      if (cell.state == CellState::Queued) {
+        queued.push_back(&cell);
+      }
+    }
+    const size_t count = std::min<size_t>(queued.size(), m_config.maxInFlightReads - m_inFlight);
+    if (count == 0) {
+      return;
+    }
+    std::ranges::partial_sort(queued, queued.begin() + count, {}, &Cell::distance);
+    {
+      std::scoped_lock lock(m_requestMutex);
+      for (size_t i = 0; i < count; ++i) {
+        queued[i]->state = CellState::Reading;
+        m_requests.push_back(queued[i]->coord);
+      }
+    }
+    m_inFlight += static_cast<uint32_t>(count);
+    m_requestReady.notify_all();
+  }
+
+  void WorldStreamer::uploadCells(uint64_t budget) {
+    std::vector<Cell*> uploading;
+    for (auto& [key, cell] : m_cells) {
+      if (cell.state == CellState::Uploading) {
+        uploading.push_back(&cell);
+      }
+    }
+    std::ranges::sort(uploading, {}, &Cell::distance);
+
+    const auto now = Clock::now();
+    for (Cell* cell : uploading) {
+      if (budget == 0) {
+        break;
+      }
+      if (cell->data->pendingUploadBytes > 0) {
+        const uint64_t uploaded =
+            std::min(m_source.upload(cell->coord, *cell->data, budget), budget);
+        budget -= uploaded;
+        m_uploadedBytes += uploaded;
+        m_uploadBytesTotal->add(uploaded);
+      }
+      if (cell->data->pendingUploadBytes == 0) {
+        cell->state = CellState::Resident;
+        m_loadLatency->recordDuration(now - cell->requested);
+      }
+    }
+  }
+
+  void WorldStreamer::evictCells() {
+    std::vector<Cell*> candidates;
+    for (auto& [key, cell] : m_cells) {
+      const bool loaded = cell.state == CellState::Uploading || cell.state == CellState::Resident;
+      const bool beyond = cell.distance > m_config.unloadRadius;
+      if (loaded && (beyond || (!cell.wanted && m_residentBytes > m_config.memoryBudgetBytes))) {
+        candidates.push_back(&cell);
+      }
+    }
+    std::ranges::sort(candidates, std::ranges::greater{}, &Cell::distance);
+
+    uint32_t evicted = 0;
+    for (Cell* cell : candidates) {
+      const bool beyond = cell->distance > m_config.unloadRadius;
+      if (evicted == m_config.maxEvictionsPerFrame ||
+          (!beyond && m_residentBytes <= m_config.memoryBudgetBytes)) {
+        break;
+      }
+      evict(*cell);
+      ++evicted;
+    }
+  }
+
+  void WorldStreamer::evict(Cell& cell) {
+    m_source.evict(cell.coord, *cell.data);
+    m_residentBytes -= std::min(m_residentBytes, cell.data->residentBytes);
+    m_cells.erase(key(cell.coord));
+  }
+
+  auto WorldStreamer::state(CellCoord cell) const -> std::optional<CellState> {
+    const auto found = m_cells.find(key(cell));
+    if (found == m_cells.end()) {
+      return std::nullopt;
+    }
+    return found->second.state;
+  }
+
+  auto WorldStreamer::data(CellCoord cell) const -> const CellData* {
+    const auto found = m_cells.find(key(cell));
+    return found == m_cells.end() ? nullptr : found->second.data.get();
+  }
+
+  auto WorldStreamer::stats() const -> StreamingStats {
+    StreamingStats stats;
+    for (const auto& [key, cell] : m_cells) {
+      switch (cell.state) {
+        case CellState::Queued:    ++stats.queued; break;
+        case CellState::Reading:   ++stats.reading; break;
+        case CellState::Uploading: ++stats.uploading; break;
+        case CellState::Resident:  ++stats.resident; break;
+        case CellState::Failed:    ++stats.failed; break;
+      }
+    }
+    stats.residentBytes = m_residentBytes;
+    stats.uploadedBytes = m_uploadedBytes;
+    return stats;
+  }
+
+  void WorldStreamer::publishStats() {
+    const auto current = stats();
+    m_residentGauge->set(static_cast<double>(current.resident));
+    m_residentBytesGauge->set(static_cast<double>(m_residentBytes));
+    m_inFlightGauge->set(static_cast<double>(m_inFlight));
+  }
+} // namespace kst::scene
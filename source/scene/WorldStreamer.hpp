@@ -0,0 +1,242 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "core/MpscQueue.hpp"
+#include "core/Result.hpp"
+
+namespace kst::core {
+  class Counter;
+  class Gauge;
+  class Histogram;
+} // namespace kst::core
+
+namespace kst::scene {
+  /**
+   * @brief Column of the world grid on the XZ plane
+   */
+  struct CellCoord {
+    int32_t x = 0;
+    int32_t z = 0;
+
+    auto operator==(const CellCoord&) const -> bool = default;
+  };
+
+  /**
+   * @brief What a CellSource read for one cell, subclassed by the source
+   */
+  struct CellData {
+    virtual ~CellData() = default;
+
+    // CPU and GPU memory the cell holds once uploaded, counted against the
+    // streamer's memory budget from the moment the read completes
+    uint64_t residentBytes = 0;
+
+    // Bytes still to upload; the cell becomes resident when this reaches 0
+    uint64_t pendingUploadBytes = 0;
+  };
+
+  /**
+   * @brief Loads and releases cells for a WorldStreamer
+   */
+  class CellSource {
+  public:
+    virtual ~CellSource() = default;
+
+    /**
+     * @brief Reads and decodes a cell on an I/O thread
+     *
+     * Called from several threads at once. Should leave the data ready to copy,
+     * so upload() doesn't stall the frame on I/O or page faults.
+     */
+    virtual auto read(CellCoord cell) -> core::Result<std::unique_ptr<CellData>> = 0;
+
+    /**
+     * @brief Uploads part of a cell on the main thread
+     *
+     * Should upload at most budget bytes and lower data.pendingUploadBytes by
+     * what it uploaded. Always given at least one byte of budget.
+     *
+     * @return Bytes uploaded
+     */
+    virtual auto upload(CellCoord cell, CellData& data, uint64_t budget) -> uint64_t = 0;
+
+    /**
+     * @brief Releases what upload() created; data is destroyed afterwards
+     */
+    virtual void evict(CellCoord cell, CellData& data) = 0;
+  };
+
+  struct StreamingConfig {
+    float cellSize = 64.0f;
+
+    // Cells within loadRadius of the viewer's path are requested; loaded
+    // cells are only dropped past unloadRadius, so walking along a cell edge
+    // doesn't load and unload the same cells every frame
+    float loadRadius   = 256.0f;
+    float unloadRadius = 320.0f;
+
+    // How far ahead the viewer's velocity is extrapolated
+    float predictionSeconds = 2.0f;
+
+    uint32_t ioThreads        = 2;
+    uint32_t maxInFlightReads = 8;
+
+    // GPU upload bytes spent per update(); a cell larger than this takes
+    // several frames
+    uint64_t uploadBytesPerFrame = 8ull << 20;
+
+    // Past this, cells outside the load radius are evicted farthest first and
+    // no new reads start
+    uint64_t memoryBudgetBytes = 1ull << 30;
+
+    // Evictions per update(), so leaving a dense area doesn't spike either
+    uint32_t maxEvictionsPerFrame = 4;
+  };
+
+  struct StreamingViewer {
+    float position[3] = {0.0f, 0.0f, 0.0f};
+    float velocity[3] = {0.0f, 0.0f, 0.0f};
+  };
+
+  enum class CellState : uint8_t {
+    Queued,
+    Reading,
+    Uploading,
+    Resident,
+    Failed,
+  };
+
+  struct StreamingStats {
+    uint32_t queued        = 0;
+    uint32_t reading       = 0;
+    uint32_t uploading     = 0;
+    uint32_t resident      = 0;
+    uint32_t failed        = 0;
+    uint64_t residentBytes = 0;
+    uint64_t uploadedBytes = 0; // by the last update()
+  };
+
+  /**
+   * @brief Streams world cells around a moving viewer
+   *
+   * The world is a grid of square cells on the XZ plane. Every update() finds
+   * the cells within the load radius of the segment from the viewer to where
+   * its velocity puts it predictionSeconds later, and ranks them by distance
+   * to that segment, so cells ahead of a fast viewer load before cells behind
+   * it. Reads run on a small I/O pool with a cap on reads in flight; finished
+   * reads are uploaded nearest first within a per-frame byte budget; cells
+   * past the unload radius, and over the memory budget the farthest ones not
+   * needed, are evicted a few per frame. Every cost on the main thread is
+   * bounded per frame, so traversal doesn't cause spikes.
+   *
+   * update(), loadAround() and the destructor run on the main thread, which
+   * is also where CellSource::upload() and evict() are called.
+   *
+   * @code
+   * WorldStreamer streamer(cells, {.cellSize = 128.0f, .loadRadius = 512.0f});
+   * streamer.loadAround(spawn);
+   * while (running) {
+   *   streamer.update({.position = {p.x, p.y, p.z}, .velocity = {v.x, v.y, v.z}});
+   * }
+   * @endcode
+   */
+  class WorldStreamer {
+  public:
+    explicit WorldStreamer(CellSource& source, StreamingConfig config = {});
+
+    /**
+     * @brief Waits for reads in flight, then evicts every loaded cell
+     */
+    ~WorldStreamer();
+
+    WorldStreamer(const WorldStreamer&)                    = delete;
+    auto operator=(const WorldStreamer&) -> WorldStreamer& = delete;
+
+    void update(const StreamingViewer& viewer);
+
+    /**
+     * @brief Blocks until every cell around the viewer is resident or failed
+     *
+     * Ignores the upload budget; for spawning and teleports behind a loading
+     * screen.
+     */
+    void loadAround(const StreamingViewer& viewer);
+
+    auto cellAt(float x, float z) const -> CellCoord;
+
+    auto state(CellCoord cell) const -> std::optional<CellState>;
+
+    /**
+     * @brief The data of an uploading or resident cell, null otherwise
+     */
+    auto data(CellCoord cell) const -> const CellData*;
+
+    auto stats() const -> StreamingStats;
+
+    auto config() const -> const StreamingConfig& { return m_config; }
+
+  private:
+    using Clock = std::chrono::steady_clock;
+
+    // Reads in flight never exceed this, so completions always fit
+    static constexpr uint32_t kMaxInFlightReads = 256;
+
+    struct Cell {
+      CellCoord coord;
+      CellState state = CellState::Queued;
+      float distance  = 0.0f; // to the viewer's predicted path
+      bool wanted     = true; // within the load radius this update
+      bool cancelled  = false; // left the unload radius while reading
+      std::unique_ptr<CellData> data;
+      Clock::time_point requested;
+    };
+
+    struct Completion {
+      CellCoord coord;
+      core::Result<std::unique_ptr<CellData>> data;
+    };
+
+    static auto key(CellCoord cell) -> uint64_t;
+
+    void ioWorker(std::stop_token stop);
+    void drainCompletions();
+    void refreshCells(const StreamingViewer& viewer);
+    void startReads();
+    void uploadCells(uint64_t budget);
+    void evictCells();
+    void evict(Cell& cell);
+    void publishStats();
+
+    CellSource& m_source;
+    StreamingConfig m_config;
+
+    std::unordered_map<uint64_t, Cell> m_cells;
+    uint64_t m_residentBytes = 0;
+    uint64_t m_uploadedBytes = 0;
+    uint32_t m_inFlight      = 0;
+
+    std::mutex m_requestMutex;
+    std::condition_variable_any m_requestReady;
+    std::deque<CellCoord> m_requests;
+    core::MpscQueue<Completion, kMaxInFlightReads> m_completions;
+    std::vector<std::jthread> m_workers;
+
+    core::Gauge* m_residentGauge      = nullptr;
+    core::Gauge* m_residentBytesGauge = nullptr;
+    core::Gauge* m_inFlightGauge      = nullptr;
+    core::Counter* m_uploadBytesTotal = nullptr;
+    core::Counter* m_failuresTotal    = nullptr;
+    core::Histogram* m_loadLatency    = nullptr;
+  };
+} // namespace kst::scene